@@ -7,9 +7,11 @@
 #include "spdk/config.h"
 
 #include "spdk/bdev.h"
+#include "spdk/env.h"
 #include "spdk/event.h"
 #include "spdk/fd.h"
 #include "spdk/string.h"
+#include "spdk/thread.h"
 #include "spdk/util.h"
 #include "spdk/vmd.h"
 
@@ -34,6 +36,7 @@ struct spdk_dd_opts {
 	int64_t		io_unit_size;
 	int64_t		io_unit_count;
 	uint32_t	queue_depth;
+	uint32_t	num_threads;
 	bool		aio;
 	bool		sparse;
 };
@@ -41,6 +44,7 @@ struct spdk_dd_opts {
 static struct spdk_dd_opts g_opts = {
 	.io_unit_size = 4096,
 	.queue_depth = 2,
+	.num_threads = 1,
 };
 
 enum dd_submit_type {
@@ -99,6 +103,38 @@ struct dd_target {
 	bool open;
 };
 
+struct dd_worker;
+
+struct dd_worker_io {
+	struct dd_worker		*worker;
+	uint64_t			src_offset_blocks;
+	uint64_t			dst_offset_blocks;
+	uint64_t			num_blocks;
+	void				*buf;
+	STAILQ_ENTRY(dd_worker_io)	link;
+};
+
+/* Copies between bdevs with the same block size are split into one range per worker thread */
+struct dd_worker {
+	struct spdk_thread		*thread;
+	struct spdk_io_channel		*input_ch;
+	struct spdk_io_channel		*output_ch;
+	struct dd_worker_io		*ios;
+
+	/* Next input block to copy and the end of the worker's range */
+	uint64_t			offset_blocks;
+	uint64_t			end_blocks;
+
+	/* End of the data extent starting at offset_blocks, only differs from end_blocks
+	 * with --sparse */
+	uint64_t			data_end_blocks;
+	bool				seeking;
+
+	uint32_t			outstanding;
+	STAILQ_HEAD(, dd_worker_io)	idle_ios;
+	int				rc;
+};
+
 struct dd_job {
 	struct dd_target	input;
 	struct dd_target	output;
@@ -127,6 +163,13 @@ struct dd_job {
 	uint64_t		total_bytes;
 	uint64_t		incremental_bytes;
 	struct spdk_poller	*status_poller;
+
+	struct spdk_thread	*main_thread;
+	struct dd_worker	*workers;
+	uint32_t		num_workers;
+	uint32_t		workers_running;
+	uint64_t		unit_blocks;
+	bool			copy_offload;
 };
 
 struct dd_flags {
@@ -227,9 +270,7 @@ dd_show_progress(bool finish)
 	uint64_t milliseconds;
 	uint64_t size, tmp_size;
 
-	size = g_job.incremental_bytes;
-
-	g_job.incremental_bytes = 0;
+	size = __atomic_exchange_n(&g_job.incremental_bytes, 0, __ATOMIC_RELAXED);
 	g_job.total_bytes += size;
 
 	if (finish) {
@@ -955,6 +996,369 @@ dd_open_bdev(struct dd_target *target, const char *bdev_name, uint64_t skip_bloc
 	return 0;
 }
 
+static bool
+dd_use_workers(void)
+{
+	return g_opts.input_bdev != NULL && g_opts.output_bdev != NULL &&
+	       g_job.input.block_size == g_job.output.block_size;
+}
+
+static void
+dd_worker_done(void *ctx)
+{
+	struct dd_worker *worker = ctx;
+
+	if (worker->rc != 0 && g_error == 0) {
+		g_error = worker->rc;
+	}
+
+	assert(g_job.workers_running > 0);
+	if (--g_job.workers_running > 0) {
+		return;
+	}
+
+	if (g_error == 0) {
+		dd_show_progress(true);
+		printf("\n\n");
+	}
+	dd_exit(g_error);
+}
+
+static void
+dd_worker_finish(struct dd_worker *worker)
+{
+	if (worker->input_ch) {
+		spdk_put_io_channel(worker->input_ch);
+	}
+
+	if (worker->output_ch) {
+		spdk_put_io_channel(worker->output_ch);
+	}
+
+	spdk_thread_send_msg(g_job.main_thread, dd_worker_done, worker);
+	spdk_thread_exit(worker->thread);
+}
+
+static void dd_worker_kick(struct dd_worker *worker);
+
+static void
+dd_worker_put_io(struct dd_worker_io *io, bool success)
+{
+	struct dd_worker *worker = io->worker;
+
+	assert(worker->outstanding > 0);
+	worker->outstanding--;
+
+	if (!success) {
+		SPDK_ERRLOG("Failed to copy %" PRIu64 " blocks at offset %" PRIu64 "\n",
+			    io->num_blocks, io->src_offset_blocks);
+		worker->rc = -EIO;
+	}
+
+	STAILQ_INSERT_HEAD(&worker->idle_ios, io, link);
+	dd_worker_kick(worker);
+}
+
+static void
+_dd_worker_write_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct dd_worker_io *io = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (success) {
+		__atomic_fetch_add(&g_job.incremental_bytes,
+				   io->num_blocks * g_job.input.block_size, __ATOMIC_RELAXED);
+	}
+
+	dd_worker_put_io(io, success);
+}
+
+static void
+_dd_worker_read_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct dd_worker_io *io = cb_arg;
+	struct dd_worker *worker = io->worker;
+	int rc;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success || worker->rc != 0 || g_interrupt) {
+		dd_worker_put_io(io, success);
+		return;
+	}
+
+	rc = spdk_bdev_write_blocks(g_job.output.u.bdev.desc, worker->output_ch, io->buf,
+				    io->dst_offset_blocks, io->num_blocks,
+				    _dd_worker_write_done, io);
+	if (rc != 0) {
+		SPDK_ERRLOG("%s\n", strerror(-rc));
+		worker->rc = rc;
+		dd_worker_put_io(io, true);
+	}
+}
+
+static int
+dd_worker_submit(struct dd_worker_io *io)
+{
+	struct dd_worker *worker = io->worker;
+
+	/* Let the backend copy the data itself if both ends are the same bdev. Otherwise the data
+	 * is read into the buffer of the I/O and written from the same buffer. */
+	if (g_job.copy_offload) {
+		return spdk_bdev_copy_blocks(g_job.output.u.bdev.desc, worker->output_ch,
+					     io->dst_offset_blocks, io->src_offset_blocks,
+					     io->num_blocks, _dd_worker_write_done, io);
+	}
+
+	return spdk_bdev_read_blocks(g_job.input.u.bdev.desc, worker->input_ch, io->buf,
+				     io->src_offset_blocks, io->num_blocks,
+				     _dd_worker_read_done, io);
+}
+
+static void
+_dd_worker_seek_hole_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct dd_worker *worker = cb_arg;
+	uint64_t next_hole_offset_blocks = spdk_bdev_io_get_seek_offset(bdev_io);
+
+	spdk_bdev_free_io(bdev_io);
+	worker->seeking = false;
+
+	if (!success) {
+		worker->rc = -EIO;
+	} else if (next_hole_offset_blocks <= worker->offset_blocks) {
+		/* Shouldn't happen right after seeking data, but make sure we move forward */
+		worker->data_end_blocks = spdk_min(worker->offset_blocks + g_job.unit_blocks,
+						   worker->end_blocks);
+	} else {
+		/* UINT64_MAX means there are no more holes */
+		worker->data_end_blocks = spdk_min(next_hole_offset_blocks, worker->end_blocks);
+	}
+
+	dd_worker_kick(worker);
+}
+
+static void
+_dd_worker_seek_data_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct dd_worker *worker = cb_arg;
+	uint64_t next_data_offset_blocks = spdk_bdev_io_get_seek_offset(bdev_io);
+	int rc;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		worker->rc = -EIO;
+	} else if (worker->rc == 0 && !g_interrupt) {
+		/* UINT64_MAX means there are no more data in the bdev */
+		if (next_data_offset_blocks >= worker->end_blocks) {
+			worker->offset_blocks = worker->end_blocks;
+			worker->data_end_blocks = worker->end_blocks;
+		} else {
+			worker->offset_blocks = spdk_max(worker->offset_blocks,
+							 next_data_offset_blocks);
+			rc = spdk_bdev_seek_hole(g_job.input.u.bdev.desc, worker->input_ch,
+						 worker->offset_blocks,
+						 _dd_worker_seek_hole_done, worker);
+			if (rc == 0) {
+				return;
+			}
+
+			SPDK_ERRLOG("%s\n", strerror(-rc));
+			worker->rc = rc;
+		}
+	}
+
+	worker->seeking = false;
+	dd_worker_kick(worker);
+}
+
+static void
+dd_worker_kick(struct dd_worker *worker)
+{
+	uint64_t input_start_blocks = g_job.input.pos / g_job.input.block_size;
+	uint64_t output_start_blocks = g_job.output.pos / g_job.output.block_size;
+	struct dd_worker_io *io;
+	int rc;
+
+	while (!STAILQ_EMPTY(&worker->idle_ios) && !worker->seeking) {
+		if (worker->rc != 0 || g_interrupt || worker->offset_blocks == worker->end_blocks) {
+			break;
+		}
+
+		/* Reached a hole, look for the next data extent of the range */
+		if (worker->offset_blocks == worker->data_end_blocks) {
+			worker->seeking = true;
+			rc = spdk_bdev_seek_data(g_job.input.u.bdev.desc, worker->input_ch,
+						 worker->offset_blocks,
+						 _dd_worker_seek_data_done, worker);
+			if (rc != 0) {
+				SPDK_ERRLOG("%s\n", strerror(-rc));
+				worker->seeking = false;
+				worker->rc = rc;
+			}
+			break;
+		}
+
+		io = STAILQ_FIRST(&worker->idle_ios);
+		io->src_offset_blocks = worker->offset_blocks;
+		io->dst_offset_blocks = io->src_offset_blocks - input_start_blocks +
+					output_start_blocks;
+		io->num_blocks = spdk_min(g_job.unit_blocks,
+					  worker->data_end_blocks - worker->offset_blocks);
+
+		rc = dd_worker_submit(io);
+		if (rc != 0) {
+			SPDK_ERRLOG("%s\n", strerror(-rc));
+			worker->rc = rc;
+			break;
+		}
+
+		STAILQ_REMOVE_HEAD(&worker->idle_ios, link);
+		worker->offset_blocks += io->num_blocks;
+		worker->outstanding++;
+	}
+
+	if (worker->outstanding == 0 && !worker->seeking) {
+		dd_worker_finish(worker);
+	}
+}
+
+static void
+dd_worker_start(void *ctx)
+{
+	struct dd_worker *worker = ctx;
+
+	worker->input_ch = spdk_bdev_get_io_channel(g_job.input.u.bdev.desc);
+	worker->output_ch = spdk_bdev_get_io_channel(g_job.output.u.bdev.desc);
+	if (worker->input_ch == NULL || worker->output_ch == NULL) {
+		SPDK_ERRLOG("Could not get I/O channel: %s\n", strerror(ENOMEM));
+		worker->rc = -ENOMEM;
+		dd_worker_finish(worker);
+		return;
+	}
+
+	dd_worker_kick(worker);
+}
+
+static int
+dd_worker_init(struct dd_worker *worker, uint32_t core)
+{
+	struct spdk_cpuset cpumask;
+	char name[32];
+	int32_t numa_id = spdk_env_get_numa_id(core);
+	uint32_t i;
+
+	STAILQ_INIT(&worker->idle_ios);
+
+	worker->ios = calloc(g_opts.queue_depth, sizeof(struct dd_worker_io));
+	if (worker->ios == NULL) {
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < g_opts.queue_depth; i++) {
+		worker->ios[i].worker = worker;
+		if (!g_job.copy_offload) {
+			worker->ios[i].buf = spdk_malloc(g_opts.io_unit_size, 0x1000, NULL, numa_id,
+							 SPDK_MALLOC_DMA);
+			if (worker->ios[i].buf == NULL) {
+				return -ENOMEM;
+			}
+		}
+		STAILQ_INSERT_TAIL(&worker->idle_ios, &worker->ios[i], link);
+	}
+
+	spdk_cpuset_zero(&cpumask);
+	spdk_cpuset_set_cpu(&cpumask, core, true);
+	snprintf(name, sizeof(name), "dd_worker%" PRIu32, (uint32_t)(worker - g_job.workers));
+
+	worker->thread = spdk_thread_create(name, &cpumask);
+	if (worker->thread == NULL) {
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static int
+dd_start_workers(void)
+{
+	uint64_t start_blocks = g_job.input.pos / g_job.input.block_size;
+	uint64_t num_blocks = g_job.copy_size / g_job.input.block_size;
+	uint64_t num_units, range_blocks;
+	struct dd_worker *worker;
+	uint32_t i, core;
+	int rc;
+
+	g_job.main_thread = spdk_get_thread();
+	g_job.unit_blocks = g_opts.io_unit_size / g_job.input.block_size;
+	g_job.copy_offload = strcmp(g_opts.input_bdev, g_opts.output_bdev) == 0 &&
+			     spdk_bdev_io_type_supported(g_job.output.u.bdev.bdev,
+					     SPDK_BDEV_IO_TYPE_COPY);
+
+	/* Each worker copies a contiguous range made of whole I/O units */
+	num_units = SPDK_CEIL_DIV(num_blocks, g_job.unit_blocks);
+	g_job.num_workers = spdk_max(spdk_min(g_opts.num_threads, num_units), 1);
+
+	/* Workers would overwrite the input of each other if the ranges overlap */
+	if (strcmp(g_opts.input_bdev, g_opts.output_bdev) == 0 &&
+	    g_job.input.pos < g_job.output.pos + g_job.copy_size &&
+	    g_job.output.pos < g_job.input.pos + g_job.copy_size && g_job.num_workers > 1) {
+		SPDK_NOTICELOG("Input and output ranges overlap, copying with a single thread\n");
+		g_job.num_workers = 1;
+	}
+	range_blocks = SPDK_CEIL_DIV(num_units, g_job.num_workers) * g_job.unit_blocks;
+
+	g_job.workers = calloc(g_job.num_workers, sizeof(struct dd_worker));
+	if (g_job.workers == NULL) {
+		return -ENOMEM;
+	}
+
+	core = spdk_env_get_first_core();
+	for (i = 0; i < g_job.num_workers; i++) {
+		worker = &g_job.workers[i];
+		worker->offset_blocks = start_blocks + spdk_min(i * range_blocks, num_blocks);
+		worker->end_blocks = start_blocks + spdk_min((i + 1) * range_blocks, num_blocks);
+		worker->data_end_blocks = g_opts.sparse ? worker->offset_blocks :
+					  worker->end_blocks;
+
+		rc = dd_worker_init(worker, core);
+		if (rc != 0) {
+			return rc;
+		}
+
+		g_job.workers_running++;
+		spdk_thread_send_msg(worker->thread, dd_worker_start, worker);
+
+		core = spdk_env_get_next_core(core);
+		if (core == UINT32_MAX) {
+			core = spdk_env_get_first_core();
+		}
+	}
+
+	return 0;
+}
+
+static void
+dd_free_workers(void)
+{
+	uint32_t i, j;
+
+	for (i = 0; i < g_job.num_workers; i++) {
+		if (g_job.workers[i].ios == NULL) {
+			continue;
+		}
+
+		for (j = 0; j < g_opts.queue_depth; j++) {
+			spdk_free(g_job.workers[i].ios[j].buf);
+		}
+		free(g_job.workers[i].ios);
+	}
+
+	free(g_job.workers);
+}
+
 static void
 dd_finish(void)
 {
@@ -1169,6 +1573,31 @@ dd_run(void *arg1)
 		return;
 	}
 
+	if (dd_use_workers()) {
+		clock_gettime(CLOCK_REALTIME, &g_job.start_time);
+
+		g_job.status_poller = SPDK_POLLER_REGISTER(dd_status_poller, NULL,
+				      STATUS_POLLER_PERIOD_SEC * SPDK_SEC_TO_USEC);
+
+		rc = dd_start_workers();
+		if (rc != 0) {
+			SPDK_ERRLOG("Could not start copy threads: %s\n", strerror(-rc));
+			g_error = rc;
+			/* Workers that were already started stop at their next I/O */
+			g_interrupt = true;
+			if (g_job.workers_running == 0) {
+				dd_exit(rc);
+			}
+		}
+		return;
+	}
+
+	if (g_opts.num_threads > 1) {
+		SPDK_ERRLOG("--threads requires input and output bdevs with the same block size\n");
+		dd_exit(-EINVAL);
+		return;
+	}
+
 	g_job.ios = calloc(g_opts.queue_depth, sizeof(struct dd_io));
 	if (g_job.ios == NULL) {
 		SPDK_ERRLOG("%s\n", strerror(ENOMEM));
@@ -1261,6 +1690,7 @@ enum dd_cmdline_opts {
 	DD_OPTION_COUNT,
 	DD_OPTION_AIO,
 	DD_OPTION_SPARSE,
+	DD_OPTION_THREADS,
 };
 
 static struct option g_cmdline_opts[] = {
@@ -1342,6 +1772,12 @@ static struct option g_cmdline_opts[] = {
 		.flag = NULL,
 		.val = DD_OPTION_SPARSE,
 	},
+	{
+		.name = "threads",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = DD_OPTION_THREADS,
+	},
 	{
 		.name = NULL
 	}
@@ -1364,6 +1800,9 @@ usage(void)
 	printf(" --seek Skip this many I/O units at start of output. (default: 0)\n");
 	printf(" --aio Force usage of AIO. (by default io_uring is used if available)\n");
 	printf(" --sparse Enable hole skipping in input target\n");
+	printf(" --threads Number of threads, spread over the cores of the core mask, splitting\n");
+	printf("           a copy between bdevs of the same block size. (default: %d)\n",
+	       g_opts.num_threads);
 	printf(" Available iflag and oflag values:\n");
 	printf("  append - append mode\n");
 	printf("  direct - use direct I/O for data\n");
@@ -1419,6 +1858,9 @@ parse_args(int argc, char *argv)
 	case DD_OPTION_SPARSE:
 		g_opts.sparse = true;
 		break;
+	case DD_OPTION_THREADS:
+		g_opts.num_threads = spdk_strtol(optarg, 10);
+		break;
 	default:
 		usage();
 		return 1;
@@ -1460,6 +1902,8 @@ dd_free(void)
 
 		free(g_job.ios);
 	}
+
+	dd_free_workers();
 }
 
 int
@@ -1517,6 +1961,12 @@ main(int argc, char **argv)
 		goto end;
 	}
 
+	if ((int32_t)g_opts.num_threads <= 0) {
+		SPDK_ERRLOG("Invalid --threads value\n");
+		rc = EINVAL;
+		goto end;
+	}
+
 	if (g_opts.output_file == NULL && g_opts.output_file_flags != NULL) {
 		SPDK_ERRLOG("--oflags may be used only with --of\n");
 		rc = EINVAL;
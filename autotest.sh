@@ -296,6 +296,7 @@ if [ $SPDK_RUN_FUNCTIONAL_TEST -eq 1 ]; then
 			examples/blob/hello_world/hello_blob.json
 		run_test "lvol" $rootdir/test/lvol/lvol.sh
 		run_test "blob_io_wait" $rootdir/test/blobstore/blob_io_wait/blob_io_wait.sh
+		run_test "blob_first_write" $rootdir/test/blobstore/blob_first_write/blob_first_write.sh
 	fi
 
 	if [ $SPDK_TEST_VHOST_INIT -eq 1 ]; then
@@ -25,8 +25,11 @@
 #define BDEVPERF_CONFIG_MAX_FILENAME 1024
 #define BDEVPERF_CONFIG_UNDEFINED -1
 #define BDEVPERF_CONFIG_ERROR -2
-#define PATTERN_TYPES_STR "(read, write, randread, randwrite, rw, randrw, verify, reset, unmap, flush, write_zeroes)"
+#define PATTERN_TYPES_STR "(read, write, randread, randwrite, rw, randrw, verify, reset, unmap, flush, write_zeroes, replay)"
 #define BDEVPERF_MAX_COREMASK_STRING 64
+#define BDEVPERF_MAX_RATE_STEPS 32
+#define BDEVPERF_TRACE_MAGIC "BDPTRACE"
+#define BDEVPERF_TRACE_VERSION 1
 
 struct bdevperf_task {
 	struct iovec			iov;
@@ -37,6 +40,10 @@ struct bdevperf_task {
 	void				*md_buf;
 	void				*verify_md_buf;
 	uint64_t			offset_blocks;
+	uint64_t			num_blocks;
+	/* Open-loop mode: the time the I/O was due to be submitted and its rate step */
+	uint64_t			submit_tsc;
+	uint32_t			step;
 	struct bdevperf_task		*task_to_abort;
 	enum spdk_bdev_io_type		io_type;
 	TAILQ_ENTRY(bdevperf_task)	link;
@@ -78,6 +85,12 @@ static bool g_random_map = false;
 static bool g_unique_writes = false;
 static bool g_hide_metadata = false;
 static bool g_nohuge_alloc = false;
+static char *g_rate_iops = NULL;
+static char *g_arrival = NULL;
+static uint32_t g_num_rate_steps = 1;
+static const char *g_replay_file = NULL;
+/* Negative means not specified, replay at the speed of the trace then */
+static double g_replay_speed = -1;
 
 static struct spdk_cpuset g_all_cpuset;
 static struct spdk_poller *g_perf_timer = NULL;
@@ -121,6 +134,73 @@ struct latency_info {
 	uint64_t	total;
 };
 
+struct latency_percentile {
+	double		cutoff;
+	uint64_t	value;
+};
+
+/* Percentiles reported for each step of the open-loop mode */
+static const double g_rate_percentiles[] = {
+	0.50,
+	0.90,
+	0.99,
+	0.999,
+	0.9999,
+};
+
+enum bdevperf_arrival {
+	BDEVPERF_ARRIVAL_POISSON = 0,
+	BDEVPERF_ARRIVAL_CONSTANT,
+};
+
+/* Statistics of a single rate of the open-loop mode */
+struct bdevperf_rate_step {
+	uint64_t			target_iops;
+	uint64_t			io_completed;
+	uint64_t			io_failed;
+	/* Arrivals that were due, but not submitted by the end of the step */
+	uint64_t			io_missed;
+	uint64_t			start_tsc;
+	uint64_t			end_tsc;
+	/* Latency measured from the time the I/O was due, not when it was submitted */
+	struct spdk_histogram_data	*histogram;
+};
+
+/* I/O trace replayed by the replay workload, as written by bdevperf_trace.py.  The header is
+ * followed by entries sorted by time.  All fields are little endian.
+ */
+struct bdevperf_trace_header {
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	entry_size;
+};
+SPDK_STATIC_ASSERT(sizeof(struct bdevperf_trace_header) == 16, "Incorrect size");
+
+struct bdevperf_trace_entry {
+	/* Time since the first I/O of the trace */
+	uint64_t	time_ns;
+	uint64_t	offset;
+	uint32_t	length;
+	/* enum spdk_bdev_io_type */
+	uint8_t		type;
+	uint8_t		reserved[3];
+};
+SPDK_STATIC_ASSERT(sizeof(struct bdevperf_trace_entry) == 24, "Incorrect size");
+
+struct bdevperf_trace {
+	char					*path;
+	void					*map;
+	size_t					map_size;
+	const struct bdevperf_trace_entry	*entries;
+	uint64_t				num_entries;
+	uint64_t				duration_ns;
+	uint32_t				max_length;
+	/* Mask of the I/O types in the trace */
+	uint32_t				io_types;
+	TAILQ_ENTRY(bdevperf_trace)		link;
+};
+
+static TAILQ_HEAD(, bdevperf_trace) g_traces = TAILQ_HEAD_INITIALIZER(g_traces);
 
 enum job_config_rw {
 	JOB_CONFIG_RW_READ = 0,
@@ -134,6 +214,7 @@ enum job_config_rw {
 	JOB_CONFIG_RW_UNMAP,
 	JOB_CONFIG_RW_FLUSH,
 	JOB_CONFIG_RW_WRITE_ZEROES,
+	JOB_CONFIG_RW_REPLAY,
 };
 
 struct bdevperf_job {
@@ -186,6 +267,36 @@ struct bdevperf_job {
 
 	/* counter used for generating unique write data (-U option) */
 	uint32_t			write_io_count;
+
+	/* Open-loop mode (-I option): I/O is submitted at these rates, one after another, instead
+	 * of keeping queue_depth I/O outstanding.  queue_depth only limits outstanding I/O then.
+	 */
+	uint64_t			rate_iops[BDEVPERF_MAX_RATE_STEPS];
+	uint32_t			num_rates;
+	enum bdevperf_arrival		arrival;
+	struct bdevperf_rate_step	*steps;
+	uint32_t			num_steps;
+	uint32_t			step;
+	uint32_t			rate_queue_depth;
+	uint64_t			rate_seed;
+	uint32_t			rate_periods;
+	/* Mean number of ticks between arrivals and the time the next I/O is due */
+	double				rate_interval;
+	double				rate_next_tsc;
+	struct spdk_poller		*rate_poller;
+
+	/* Trace replay (replay workload).  The next I/O of the trace within the job's LBA range
+	 * is kept mapped onto the bdev.  The trace starts over when it ends.
+	 */
+	struct bdevperf_trace		*trace;
+	double				replay_speed;
+	uint64_t			replay_index;
+	uint64_t			replay_loop_ns;
+	uint64_t			replay_start_tsc;
+	uint64_t			replay_time_ns;
+	uint64_t			replay_offset_blocks;
+	uint64_t			replay_num_blocks;
+	enum spdk_bdev_io_type		replay_io_type;
 };
 
 struct spdk_bdevperf {
@@ -210,6 +321,11 @@ struct job_config {
 	int64_t				offset;
 	uint64_t			length;
 	enum job_config_rw		rw;
+	uint64_t			rate_iops[BDEVPERF_MAX_RATE_STEPS];
+	uint32_t			num_rates;
+	enum bdevperf_arrival		arrival;
+	const char			*replay_file;
+	double				replay_speed;
 	TAILQ_ENTRY(job_config)	link;
 };
 
@@ -274,6 +390,8 @@ parse_workload_type(enum job_config_rw ret)
 		return "rw";
 	case JOB_CONFIG_RW_RANDRW:
 		return "randrw";
+	case JOB_CONFIG_RW_REPLAY:
+		return "replay";
 	default:
 		fprintf(stderr, "wrong workload_type code\n");
 	}
@@ -281,6 +399,19 @@ parse_workload_type(enum job_config_rw ret)
 	return NULL;
 }
 
+static const char *
+parse_arrival_type(enum bdevperf_arrival arrival)
+{
+	switch (arrival) {
+	case BDEVPERF_ARRIVAL_POISSON:
+		return "poisson";
+	case BDEVPERF_ARRIVAL_CONSTANT:
+		return "constant";
+	default:
+		return "unknown";
+	}
+}
+
 static void *
 bdevperf_alloc(size_t size, size_t alignment, uint32_t node_id)
 {
@@ -380,6 +511,58 @@ get_avg_latency(void *ctx, uint64_t start, uint64_t end, uint64_t count,
 	}
 }
 
+static void
+get_percentile(void *ctx, uint64_t start, uint64_t end, uint64_t count,
+	       uint64_t total, uint64_t so_far)
+{
+	struct latency_percentile *percentile = ctx;
+
+	if (count == 0 || percentile->value != 0) {
+		return;
+	}
+
+	if ((double)so_far / total >= percentile->cutoff) {
+		percentile->value = end;
+	}
+}
+
+static double
+bdevperf_rate_step_get_percentile(struct bdevperf_rate_step *step, double cutoff)
+{
+	struct latency_percentile percentile = { .cutoff = cutoff };
+
+	spdk_histogram_data_iterate(step->histogram, get_percentile, &percentile);
+
+	return (double)percentile.value * SPDK_SEC_TO_USEC / spdk_get_ticks_hz();
+}
+
+static void
+bdevperf_rate_step_get_latency(struct bdevperf_rate_step *step, double *average_latency,
+			       double *max_latency)
+{
+	struct latency_info latency_info = {};
+	uint64_t tsc_rate = spdk_get_ticks_hz();
+
+	spdk_histogram_data_iterate(step->histogram, get_avg_latency, &latency_info);
+
+	*average_latency = 0.0;
+	if (step->io_completed != 0) {
+		*average_latency = (double)latency_info.total / step->io_completed *
+				   SPDK_SEC_TO_USEC / tsc_rate;
+	}
+	*max_latency = (double)latency_info.max * SPDK_SEC_TO_USEC / tsc_rate;
+}
+
+static double
+bdevperf_rate_step_get_iops(struct bdevperf_rate_step *step)
+{
+	if (step->end_tsc <= step->start_tsc) {
+		return 0.0;
+	}
+
+	return (double)step->io_completed * spdk_get_ticks_hz() / (step->end_tsc - step->start_tsc);
+}
+
 static void
 bdevperf_job_stats_accumulate(struct bdevperf_stats *aggr_stats,
 			      struct bdevperf_stats *job_stats)
@@ -482,6 +665,95 @@ performance_dump_job_stdout(struct bdevperf_job *job,
 	       job_stats->max_latency);
 }
 
+static void
+performance_dump_rate_steps_stdout(struct bdevperf_job *job)
+{
+	struct bdevperf_rate_step *step;
+	double average_latency, max_latency, percentile;
+	char name[16];
+	uint32_t i, j;
+
+	if (job->trace != NULL) {
+		printf("\n Job: %s (Core Mask 0x%s, replay: %s, speed: %g)\n", job->name,
+		       spdk_cpuset_fmt(spdk_thread_get_cpumask(job->thread)),
+		       job->trace->path, job->replay_speed);
+	} else {
+		printf("\n Job: %s (Core Mask 0x%s, arrival: %s)\n", job->name,
+		       spdk_cpuset_fmt(spdk_thread_get_cpumask(job->thread)),
+		       parse_arrival_type(job->arrival));
+	}
+	printf(" %12s %12s %10s %10s", "Target IOPS", "IOPS", "Missed", "Average");
+	for (j = 0; j < SPDK_COUNTOF(g_rate_percentiles); j++) {
+		snprintf(name, sizeof(name), "p%g", g_rate_percentiles[j] * 100);
+		printf(" %10s", name);
+	}
+	printf(" %10s\n", "max");
+
+	for (i = 0; i < job->num_steps; i++) {
+		step = &job->steps[i];
+		if (step->start_tsc == 0) {
+			break;
+		}
+
+		bdevperf_rate_step_get_latency(step, &average_latency, &max_latency);
+		if (job->trace != NULL) {
+			printf(" %12s", "trace");
+		} else {
+			printf(" %12" PRIu64, step->target_iops);
+		}
+		printf(" %12.2f %10" PRIu64 " %10.2f", bdevperf_rate_step_get_iops(step),
+		       step->io_missed, average_latency);
+		for (j = 0; j < SPDK_COUNTOF(g_rate_percentiles); j++) {
+			percentile = bdevperf_rate_step_get_percentile(step, g_rate_percentiles[j]);
+			printf(" %10.2f", percentile);
+		}
+		printf(" %10.2f\n", max_latency);
+	}
+}
+
+static void
+performance_dump_rate_steps_json(struct bdevperf_job *job, struct spdk_json_write_ctx *w)
+{
+	struct bdevperf_rate_step *step;
+	double average_latency, max_latency, percentile, runtime;
+	char name[16];
+	uint32_t i, j;
+
+	if (job->trace == NULL) {
+		spdk_json_write_named_string(w, "arrival", parse_arrival_type(job->arrival));
+	}
+	spdk_json_write_named_array_begin(w, "rate_steps");
+	for (i = 0; i < job->num_steps; i++) {
+		step = &job->steps[i];
+		if (step->start_tsc == 0) {
+			break;
+		}
+
+		bdevperf_rate_step_get_latency(step, &average_latency, &max_latency);
+		spdk_json_write_object_begin(w);
+		if (job->trace == NULL) {
+			spdk_json_write_named_uint64(w, "target_iops", step->target_iops);
+		}
+		runtime = (double)(step->end_tsc - step->start_tsc) / spdk_get_ticks_hz();
+		spdk_json_write_named_double(w, "runtime", runtime);
+		spdk_json_write_named_double(w, "iops", bdevperf_rate_step_get_iops(step));
+		spdk_json_write_named_uint64(w, "io_completed", step->io_completed);
+		spdk_json_write_named_uint64(w, "io_failed", step->io_failed);
+		spdk_json_write_named_uint64(w, "io_missed", step->io_missed);
+		spdk_json_write_named_double(w, "avg_latency_us", average_latency);
+		spdk_json_write_named_double(w, "max_latency_us", max_latency);
+		spdk_json_write_named_object_begin(w, "latency_percentiles_us");
+		for (j = 0; j < SPDK_COUNTOF(g_rate_percentiles); j++) {
+			snprintf(name, sizeof(name), "p%g", g_rate_percentiles[j] * 100);
+			percentile = bdevperf_rate_step_get_percentile(step, g_rate_percentiles[j]);
+			spdk_json_write_named_double(w, name, percentile);
+		}
+		spdk_json_write_object_end(w);
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+}
+
 static void
 performance_dump_job_json(struct bdevperf_job *job,
 			  struct spdk_json_write_ctx *w,
@@ -499,6 +771,11 @@ performance_dump_job_json(struct bdevperf_job *job,
 		spdk_json_write_named_uint32(w, "percentage", job->rw_percentage);
 	}
 
+	if (job->trace != NULL) {
+		spdk_json_write_named_string(w, "replay", job->trace->path);
+		spdk_json_write_named_double(w, "replay_speed", job->replay_speed);
+	}
+
 	if (g_shutdown) {
 		spdk_json_write_named_string(w, "status", "terminated");
 	} else if (job->io_failed > 0 && !job->reset && !job->continue_on_failure) {
@@ -524,6 +801,10 @@ performance_dump_job_json(struct bdevperf_job *job,
 	spdk_json_write_named_double(w, "avg_latency_us", job_stats->average_latency);
 	spdk_json_write_named_double(w, "min_latency_us", job_stats->min_latency);
 	spdk_json_write_named_double(w, "max_latency_us", job_stats->max_latency);
+
+	if (job->steps != NULL) {
+		performance_dump_rate_steps_json(job, w);
+	}
 }
 
 static void
@@ -671,10 +952,18 @@ free_job_config(void)
 static void
 bdevperf_job_free(struct bdevperf_job *job)
 {
+	uint32_t i;
+
 	if (job->bdev_desc != NULL) {
 		spdk_bdev_close(job->bdev_desc);
 	}
 
+	if (job->steps != NULL) {
+		for (i = 0; i < job->num_steps; i++) {
+			spdk_histogram_data_free(job->steps[i].histogram);
+		}
+		free(job->steps);
+	}
 	spdk_histogram_data_free(job->histogram);
 	spdk_bit_array_free(&job->outstanding);
 	spdk_bit_array_free(&job->random_map);
@@ -740,6 +1029,7 @@ bdevperf_test_done(void *ctx)
 	struct spdk_json_write_ctx *w = NULL;
 	struct bdevperf_stats job_stats = {0};
 	struct spdk_cpuset cpu_mask;
+	bool rate_header_printed = false;
 
 	if (g_time_in_usec) {
 		g_stats.total.io_time_in_usec = g_time_in_usec;
@@ -808,6 +1098,18 @@ bdevperf_test_done(void *ctx)
 	printf(" %10.2f %10.2f %10.2f\n", average_latency, g_stats.total.min_latency,
 	       g_stats.total.max_latency);
 
+	TAILQ_FOREACH(job, &g_bdevperf.jobs, link) {
+		if (job->steps == NULL) {
+			continue;
+		}
+
+		if (!rate_header_printed) {
+			printf("\n Open-loop latency(us), measured from the time I/O was due\n");
+			rate_header_printed = true;
+		}
+		performance_dump_rate_steps_stdout(job);
+	}
+
 	if (g_latency_display_level == 0 || g_stats.total.total_io_completed == 0) {
 		goto clean;
 	}
@@ -915,12 +1217,20 @@ static void
 bdevperf_job_empty(struct bdevperf_job *job)
 {
 	uint64_t end_tsc = 0;
+	uint32_t i;
 
 	end_tsc = spdk_get_ticks() - g_start_tsc;
 	job->run_time_in_usec = end_tsc * SPDK_SEC_TO_USEC / spdk_get_ticks_hz();
-	/* keep histogram info before channel is destroyed */
-	spdk_bdev_channel_get_histogram(job->ch, bdevperf_channel_get_histogram_cb,
-					job->histogram);
+	if (job->steps != NULL) {
+		/* In open-loop mode, report the latency from the time I/O was due */
+		for (i = 0; i < job->num_steps; i++) {
+			spdk_histogram_data_merge(job->histogram, job->steps[i].histogram);
+		}
+	} else {
+		/* keep histogram info before channel is destroyed */
+		spdk_bdev_channel_get_histogram(job->ch, bdevperf_channel_get_histogram_cb,
+						job->histogram);
+	}
 	spdk_put_io_channel(job->ch);
 	spdk_thread_send_msg(g_main_thread, bdevperf_job_end, job);
 }
@@ -949,6 +1259,137 @@ bdevperf_queue_io_wait_with_cb(struct bdevperf_task *task, spdk_bdev_io_wait_cb
 	spdk_bdev_queue_io_wait(job->bdev, job->ch, &task->bdev_io_wait);
 }
 
+/* Map an I/O of the trace onto the bdev.  Offsets beyond the end of the bdev wrap around and
+ * a zero-length flush covers the job's LBA range.  Returns whether the I/O belongs to the job.
+ */
+static bool
+bdevperf_job_replay_map(struct bdevperf_job *job, const struct bdevperf_trace_entry *entry,
+			uint64_t *offset_blocks, uint64_t *num_blocks)
+{
+	uint32_t data_block_size = spdk_bdev_get_data_block_size(job->bdev);
+	uint64_t bdev_blocks = spdk_bdev_get_num_blocks(job->bdev);
+	uint64_t range_start = job->ios_base * job->io_size_blocks;
+	uint64_t range_end = range_start + job->size_in_ios * job->io_size_blocks;
+
+	*num_blocks = SPDK_CEIL_DIV(from_le32(&entry->length), data_block_size);
+	*offset_blocks = from_le64(&entry->offset) / data_block_size;
+
+	if (*num_blocks == 0) {
+		assert(entry->type == SPDK_BDEV_IO_TYPE_FLUSH);
+		*offset_blocks = range_start;
+		*num_blocks = range_end - range_start;
+		return true;
+	}
+
+	if (*num_blocks > bdev_blocks) {
+		return false;
+	}
+
+	if (*offset_blocks + *num_blocks > bdev_blocks) {
+		*offset_blocks %= bdev_blocks - *num_blocks + 1;
+	}
+
+	return *offset_blocks >= range_start && *offset_blocks < range_end;
+}
+
+/* Move on to the next I/O of the trace within the job's LBA range */
+static void
+bdevperf_job_replay_next(struct bdevperf_job *job)
+{
+	const struct bdevperf_trace *trace = job->trace;
+	const struct bdevperf_trace_entry *entry;
+	uint64_t i;
+
+	/* The job was checked to have at least one I/O of the trace when constructed */
+	for (i = 0; i <= trace->num_entries; i++) {
+		if (job->replay_index == trace->num_entries) {
+			/* Start over, leaving the average gap between two I/O of the trace */
+			job->replay_index = 0;
+			job->replay_loop_ns += trace->duration_ns;
+			job->replay_loop_ns += trace->duration_ns / trace->num_entries;
+		}
+
+		entry = &trace->entries[job->replay_index++];
+		if (bdevperf_job_replay_map(job, entry, &job->replay_offset_blocks,
+					    &job->replay_num_blocks)) {
+			job->replay_time_ns = job->replay_loop_ns + from_le64(&entry->time_ns);
+			job->replay_io_type = entry->type;
+			return;
+		}
+	}
+
+	assert(false);
+}
+
+static double
+bdevperf_job_replay_due_tsc(struct bdevperf_job *job)
+{
+	return job->replay_start_tsc + (double)job->replay_time_ns * spdk_get_ticks_hz() /
+	       SPDK_SEC_TO_NSEC / job->replay_speed;
+}
+
+/* Count the I/O of the trace due by now, at most as many as the trace has */
+static uint64_t
+bdevperf_job_replay_count_due(struct bdevperf_job *job, uint64_t now)
+{
+	uint64_t index = job->replay_index;
+	uint64_t loop_ns = job->replay_loop_ns;
+	uint64_t time_ns = job->replay_time_ns;
+	uint64_t offset_blocks = job->replay_offset_blocks;
+	uint64_t num_blocks = job->replay_num_blocks;
+	enum spdk_bdev_io_type io_type = job->replay_io_type;
+	uint64_t count = 0;
+
+	while (count < job->trace->num_entries && bdevperf_job_replay_due_tsc(job) <= now) {
+		bdevperf_job_replay_next(job);
+		count++;
+	}
+
+	job->replay_index = index;
+	job->replay_loop_ns = loop_ns;
+	job->replay_time_ns = time_ns;
+	job->replay_offset_blocks = offset_blocks;
+	job->replay_num_blocks = num_blocks;
+	job->replay_io_type = io_type;
+
+	return count;
+}
+
+static void
+bdevperf_job_start_step(struct bdevperf_job *job, uint64_t now)
+{
+	struct bdevperf_rate_step *step = &job->steps[job->step];
+
+	step->start_tsc = now;
+	if (job->trace != NULL) {
+		job->replay_start_tsc = now;
+		job->rate_next_tsc = bdevperf_job_replay_due_tsc(job);
+		return;
+	}
+
+	step->target_iops = job->rate_iops[job->step];
+	job->rate_interval = (double)spdk_get_ticks_hz() / step->target_iops;
+	job->rate_next_tsc = now;
+}
+
+static void
+bdevperf_job_end_step(struct bdevperf_job *job, uint64_t now)
+{
+	struct bdevperf_rate_step *step = &job->steps[job->step];
+
+	if (step->start_tsc == 0 || step->end_tsc != 0) {
+		return;
+	}
+
+	step->end_tsc = now;
+	/* The arrivals still due couldn't be submitted as queue_depth I/O were outstanding */
+	if (job->trace != NULL) {
+		step->io_missed = bdevperf_job_replay_count_due(job, now);
+	} else if (job->rate_next_tsc <= now) {
+		step->io_missed = (now - job->rate_next_tsc) / job->rate_interval + 1;
+	}
+}
+
 static int
 bdevperf_job_drain(void *ctx)
 {
@@ -958,6 +1399,10 @@ bdevperf_job_drain(void *ctx)
 	if (job->reset) {
 		spdk_poller_unregister(&job->reset_timer);
 	}
+	if (job->steps != NULL) {
+		spdk_poller_unregister(&job->rate_poller);
+		bdevperf_job_end_step(job, spdk_get_ticks());
+	}
 
 	job->is_draining = true;
 
@@ -968,6 +1413,19 @@ static int
 bdevperf_job_drain_timer(void *ctx)
 {
 	struct bdevperf_job *job = ctx;
+	uint64_t now;
+
+	/* In open-loop mode the timer fires at the end of each rate step */
+	if (job->num_rates != 0 && ++job->rate_periods < g_num_rate_steps) {
+		if (job->step + 1 < job->num_rates) {
+			now = spdk_get_ticks();
+			bdevperf_job_end_step(job, now);
+			job->step++;
+			bdevperf_job_start_step(job, now);
+		}
+
+		return SPDK_POLLER_BUSY;
+	}
 
 	bdevperf_job_drain(ctx);
 	if (job->current_queue_depth == 0) {
@@ -1025,14 +1483,14 @@ bdevperf_verify_dif(struct bdevperf_task *task)
 	}
 
 	if (spdk_bdev_is_md_interleaved(bdev)) {
-		rc = spdk_dif_verify(&task->iov, 1, job->io_size_blocks, &dif_ctx, &err_blk);
+		rc = spdk_dif_verify(&task->iov, 1, task->num_blocks, &dif_ctx, &err_blk);
 	} else {
 		struct iovec md_iov = {
 			.iov_base	= task->md_buf,
-			.iov_len	= spdk_bdev_get_md_size(bdev) * job->io_size_blocks,
+			.iov_len	= spdk_bdev_get_md_size(bdev) * task->num_blocks,
 		};
 
-		rc = spdk_dix_verify(&task->iov, 1, &md_iov, job->io_size_blocks, &dif_ctx, &err_blk);
+		rc = spdk_dix_verify(&task->iov, 1, &md_iov, task->num_blocks, &dif_ctx, &err_blk);
 	}
 
 	if (rc != 0) {
@@ -1043,6 +1501,22 @@ bdevperf_verify_dif(struct bdevperf_task *task)
 	return rc;
 }
 
+static void
+bdevperf_job_rate_complete(struct bdevperf_job *job, struct bdevperf_task *task, bool success)
+{
+	struct bdevperf_rate_step *step = &job->steps[task->step];
+
+	assert(job->rate_queue_depth > 0);
+	job->rate_queue_depth--;
+
+	if (success) {
+		step->io_completed++;
+		spdk_histogram_data_tally(step->histogram, spdk_get_ticks() - task->submit_tsc);
+	} else {
+		step->io_failed++;
+	}
+}
+
 static void
 bdevperf_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 {
@@ -1109,6 +1583,12 @@ bdevperf_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 
 	spdk_bdev_free_io(bdev_io);
 
+	if (job->steps != NULL) {
+		bdevperf_job_rate_complete(job, task, success);
+		bdevperf_end_task(task);
+		return;
+	}
+
 	/*
 	 * is_draining indicates when time has expired for the test run
 	 * and we are just waiting for the previously submitted I/O
@@ -1196,14 +1676,14 @@ bdevperf_generate_dif(struct bdevperf_task *task)
 	}
 
 	if (spdk_bdev_desc_is_md_interleaved(desc)) {
-		rc = spdk_dif_generate(&task->iov, 1, job->io_size_blocks, &dif_ctx);
+		rc = spdk_dif_generate(&task->iov, 1, task->num_blocks, &dif_ctx);
 	} else {
 		struct iovec md_iov = {
 			.iov_base	= task->md_buf,
-			.iov_len	= spdk_bdev_desc_get_md_size(desc) * job->io_size_blocks,
+			.iov_len	= spdk_bdev_desc_get_md_size(desc) * task->num_blocks,
 		};
 
-		rc = spdk_dix_generate(&task->iov, 1, &md_iov, job->io_size_blocks, &dif_ctx);
+		rc = spdk_dix_generate(&task->iov, 1, &md_iov, task->num_blocks, &dif_ctx);
 	}
 
 	if (rc != 0) {
@@ -1242,32 +1722,33 @@ bdevperf_submit_task(void *arg)
 				rc = spdk_bdev_writev_blocks_with_md(desc, ch, &task->iov, 1,
 								     task->md_buf,
 								     task->offset_blocks,
-								     job->io_size_blocks,
+								     task->num_blocks,
 								     cb_fn, task);
 			}
 		}
 		break;
 	case SPDK_BDEV_IO_TYPE_FLUSH:
 		rc = spdk_bdev_flush_blocks(desc, ch, task->offset_blocks,
-					    job->io_size_blocks, bdevperf_complete, task);
+					    task->num_blocks, bdevperf_complete, task);
 		break;
 	case SPDK_BDEV_IO_TYPE_UNMAP:
 		rc = spdk_bdev_unmap_blocks(desc, ch, task->offset_blocks,
-					    job->io_size_blocks, bdevperf_complete, task);
+					    task->num_blocks, bdevperf_complete, task);
 		break;
 	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
 		rc = spdk_bdev_write_zeroes_blocks(desc, ch, task->offset_blocks,
-						   job->io_size_blocks, bdevperf_complete, task);
+						   task->num_blocks, bdevperf_complete, task);
 		break;
 	case SPDK_BDEV_IO_TYPE_READ:
 		if (g_zcopy) {
-			rc = spdk_bdev_zcopy_start(desc, ch, NULL, 0, task->offset_blocks, job->io_size_blocks,
+			rc = spdk_bdev_zcopy_start(desc, ch, NULL, 0, task->offset_blocks,
+						   task->num_blocks,
 						   true, bdevperf_zcopy_populate_complete, task);
 		} else {
 			rc = spdk_bdev_readv_blocks_with_md(desc, ch, &task->iov, 1,
 							    task->md_buf,
 							    task->offset_blocks,
-							    job->io_size_blocks,
+							    task->num_blocks,
 							    bdevperf_complete, task);
 		}
 		break;
@@ -1345,7 +1826,7 @@ bdevperf_prep_zcopy_write_task(void *arg)
 	int			rc;
 
 	rc = spdk_bdev_zcopy_start(job->bdev_desc, job->ch, NULL, 0,
-				   task->offset_blocks, job->io_size_blocks,
+				   task->offset_blocks, task->num_blocks,
 				   false, bdevperf_zcopy_get_buf_complete, task);
 	if (rc != 0) {
 		assert(rc == -ENOMEM);
@@ -1374,10 +1855,22 @@ bdevperf_job_get_task(struct bdevperf_job *job)
 static void
 bdevperf_submit_single(struct bdevperf_job *job, struct bdevperf_task *task)
 {
+	uint32_t block_size = spdk_bdev_desc_get_block_size(job->bdev_desc);
 	uint64_t offset_in_ios;
 	uint64_t rand_value;
 	uint32_t first_clear;
 
+	if (job->trace != NULL) {
+		task->offset_blocks = job->replay_offset_blocks;
+		task->num_blocks = job->replay_num_blocks;
+		task->io_type = job->replay_io_type;
+		task->iov.iov_base = task->buf;
+		task->iov.iov_len = task->num_blocks * block_size;
+		bdevperf_job_replay_next(job);
+		bdevperf_submit_task(task);
+		return;
+	}
+
 	if (job->zipf) {
 		offset_in_ios = spdk_zipf_generate(job->zipf);
 	} else if (job->is_random) {
@@ -1436,6 +1929,7 @@ bdevperf_submit_single(struct bdevperf_job *job, struct bdevperf_task *task)
 	 * is absolute (entire bdev LBA range).
 	 */
 	task->offset_blocks = (offset_in_ios + job->ios_base) * job->io_size_blocks;
+	task->num_blocks = job->io_size_blocks;
 
 	if (job->flush) {
 		task->io_type = SPDK_BDEV_IO_TYPE_FLUSH;
@@ -1536,23 +2030,81 @@ bdevperf_timeout_cb(void *cb_arg, struct spdk_bdev_io *bdev_io)
 	bdevperf_submit_task(task);
 }
 
+static double
+bdevperf_job_next_interval(struct bdevperf_job *job)
+{
+	double u;
+
+	if (job->arrival == BDEVPERF_ARRIVAL_CONSTANT) {
+		return job->rate_interval;
+	}
+
+	/* Exponentially distributed interarrival times make a Poisson process. u is in (0, 1]. */
+	u = (double)((spdk_rand_xorshift64(&job->rate_seed) >> 11) + 1) / (1ULL << 53);
+
+	return -log(u) * job->rate_interval;
+}
+
+static int
+bdevperf_job_rate_poll(void *ctx)
+{
+	struct bdevperf_job *job = ctx;
+	struct bdevperf_task *task;
+	uint64_t now;
+	int count = 0;
+
+	now = spdk_get_ticks();
+	while (job->rate_next_tsc <= now && job->rate_queue_depth < job->queue_depth &&
+	       !job->is_draining) {
+		task = bdevperf_job_get_task(job);
+		/* Latency is measured from the time the I/O was due, so that I/O delayed by the
+		 * outstanding I/O limit or by this poller isn't reported as faster than it was.
+		 */
+		task->submit_tsc = job->rate_next_tsc;
+		task->step = job->step;
+		job->rate_queue_depth++;
+		bdevperf_submit_single(job, task);
+		if (job->trace != NULL) {
+			job->rate_next_tsc = bdevperf_job_replay_due_tsc(job);
+		} else {
+			job->rate_next_tsc += bdevperf_job_next_interval(job);
+		}
+		count++;
+	}
+
+	return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
 static void
 bdevperf_job_run(void *ctx)
 {
 	struct bdevperf_job *job = ctx;
 	struct bdevperf_task *task;
+	uint64_t run_time_in_usec;
 	uint32_t i;
 
 	/* Submit initial I/O for this job. Each time one
 	 * completes, another will be submitted. */
 
-	/* Start a timer to stop this I/O chain when the run is over */
-	job->run_timer = SPDK_POLLER_REGISTER(bdevperf_job_drain_timer, job, g_time_in_usec);
+	/* Start a timer to stop this I/O chain when the run is over.  Jobs sweeping
+	 * open-loop rates get it every rate step instead.
+	 */
+	run_time_in_usec = g_time_in_usec;
+	if (job->num_rates == 0) {
+		run_time_in_usec *= g_num_rate_steps;
+	}
+	job->run_timer = SPDK_POLLER_REGISTER(bdevperf_job_drain_timer, job, run_time_in_usec);
 	if (job->reset) {
 		job->reset_timer = SPDK_POLLER_REGISTER(reset_job, job,
 							10 * SPDK_SEC_TO_USEC);
 	}
 
+	if (job->steps != NULL) {
+		bdevperf_job_start_step(job, spdk_get_ticks());
+		job->rate_poller = SPDK_POLLER_REGISTER(bdevperf_job_rate_poll, job, 0);
+		return;
+	}
+
 	for (i = 0; i < job->queue_depth; i++) {
 		task = bdevperf_job_get_task(job);
 		bdevperf_submit_single(job, task);
@@ -1672,7 +2224,8 @@ bdevperf_test(void)
 		return;
 	}
 
-	printf("Running I/O for %" PRIu64 " seconds...\n", g_time_in_usec / (uint64_t)SPDK_SEC_TO_USEC);
+	printf("Running I/O for %" PRIu64 " seconds...\n",
+	       g_time_in_usec * g_num_rate_steps / (uint64_t)SPDK_SEC_TO_USEC);
 	fflush(stdout);
 
 	/* Start a timer to dump performance numbers */
@@ -1906,9 +2459,196 @@ job_init_rw(struct bdevperf_job *job, enum job_config_rw rw)
 	case JOB_CONFIG_RW_WRITE_ZEROES:
 		job->write_zeroes = true;
 		break;
+	case JOB_CONFIG_RW_REPLAY:
+		/* I/O types come from the trace */
+		break;
 	}
 }
 
+static void
+bdevperf_trace_free(struct bdevperf_trace *trace)
+{
+	if (trace->map != NULL) {
+		munmap(trace->map, trace->map_size);
+	}
+	free(trace->path);
+	free(trace);
+}
+
+/* Load a trace to replay.  Jobs replaying the same file share it. */
+static struct bdevperf_trace *
+bdevperf_trace_get(const char *path)
+{
+	struct bdevperf_trace *trace;
+	const struct bdevperf_trace_header *hdr;
+	const struct bdevperf_trace_entry *entry;
+	struct stat st;
+	uint64_t i, time_ns = 0;
+	uint32_t length;
+	void *map;
+	int fd;
+
+	TAILQ_FOREACH(trace, &g_traces, link) {
+		if (strcmp(trace->path, path) == 0) {
+			return trace;
+		}
+	}
+
+	trace = calloc(1, sizeof(*trace));
+	if (trace == NULL) {
+		fprintf(stderr, "Unable to allocate memory for trace %s\n", path);
+		return NULL;
+	}
+
+	trace->path = strdup(path);
+	if (trace->path == NULL) {
+		fprintf(stderr, "Unable to allocate memory for trace %s\n", path);
+		goto error;
+	}
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Could not open trace %s: %s\n", path, spdk_strerror(errno));
+		goto error;
+	}
+
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(*hdr)) {
+		fprintf(stderr, "Trace %s is truncated\n", path);
+		close(fd);
+		goto error;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "Could not map trace %s: %s\n", path, spdk_strerror(errno));
+		goto error;
+	}
+
+	trace->map = map;
+	trace->map_size = st.st_size;
+
+	hdr = trace->map;
+	if (memcmp(hdr->magic, BDEVPERF_TRACE_MAGIC, sizeof(hdr->magic)) != 0 ||
+	    from_le32(&hdr->version) != BDEVPERF_TRACE_VERSION ||
+	    from_le32(&hdr->entry_size) != sizeof(*entry)) {
+		fprintf(stderr, "%s is not a bdevperf trace, see bdevperf_trace.py\n", path);
+		goto error;
+	}
+
+	trace->entries = (const struct bdevperf_trace_entry *)(hdr + 1);
+	trace->num_entries = (trace->map_size - sizeof(*hdr)) / sizeof(*entry);
+	if (trace->num_entries == 0) {
+		fprintf(stderr, "Trace %s has no I/O\n", path);
+		goto error;
+	}
+
+	for (i = 0; i < trace->num_entries; i++) {
+		entry = &trace->entries[i];
+		length = from_le32(&entry->length);
+
+		if (from_le64(&entry->time_ns) < time_ns) {
+			fprintf(stderr, "I/O %"PRIu64" of trace %s is out of order\n", i, path);
+			goto error;
+		}
+		time_ns = from_le64(&entry->time_ns);
+
+		switch (entry->type) {
+		case SPDK_BDEV_IO_TYPE_READ:
+		case SPDK_BDEV_IO_TYPE_WRITE:
+			trace->max_length = spdk_max(trace->max_length, length);
+		/* fallthrough */
+		case SPDK_BDEV_IO_TYPE_UNMAP:
+		case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+			if (length == 0) {
+				fprintf(stderr, "I/O %"PRIu64" of trace %s has no data\n", i, path);
+				goto error;
+			}
+			break;
+		case SPDK_BDEV_IO_TYPE_FLUSH:
+			break;
+		default:
+			fprintf(stderr, "I/O %"PRIu64" of trace %s has unsupported type %u\n",
+				i, path, entry->type);
+			goto error;
+		}
+
+		trace->io_types |= 1u << entry->type;
+	}
+
+	trace->duration_ns = time_ns;
+	TAILQ_INSERT_TAIL(&g_traces, trace, link);
+
+	return trace;
+error:
+	bdevperf_trace_free(trace);
+	return NULL;
+}
+
+static int
+bdevperf_job_init_replay(struct bdevperf_job *job, struct job_config *config)
+{
+	struct bdevperf_trace *trace;
+	uint32_t data_block_size = spdk_bdev_get_data_block_size(job->bdev);
+	uint64_t offset_blocks, num_blocks, max_blocks;
+	uint64_t i, num_entries = 0, data_blocks = 0;
+	int type;
+
+	if (config->replay_file == NULL) {
+		fprintf(stderr, "Job %s has no trace to replay\n", job->name);
+		return -EINVAL;
+	}
+
+	if (g_zcopy || config->num_rates != 0) {
+		fprintf(stderr, "Trace replay can't be combined with zcopy or rate_iops\n");
+		return -EINVAL;
+	}
+
+	trace = bdevperf_trace_get(config->replay_file);
+	if (trace == NULL) {
+		return -EINVAL;
+	}
+
+	for (type = 0; type < SPDK_BDEV_NUM_IO_TYPES; type++) {
+		if ((trace->io_types & (1u << type)) &&
+		    !spdk_bdev_io_type_supported(job->bdev, type)) {
+			printf("Skipping %s because it does not support the I/O of the trace\n",
+			       spdk_bdev_get_name(job->bdev));
+			return -ENOTSUP;
+		}
+	}
+
+	job->trace = trace;
+	job->replay_speed = config->replay_speed;
+
+	for (i = 0; i < trace->num_entries; i++) {
+		if (bdevperf_job_replay_map(job, &trace->entries[i], &offset_blocks, &num_blocks)) {
+			num_entries++;
+			if (trace->entries[i].type != SPDK_BDEV_IO_TYPE_FLUSH) {
+				data_blocks += num_blocks;
+			}
+		}
+	}
+
+	if (num_entries == 0) {
+		fprintf(stderr, "No I/O of trace %s is within the LBA range of job %s\n",
+			trace->path, job->name);
+		return -EINVAL;
+	}
+
+	/* Report the average I/O size of the trace so that MiB/s holds */
+	job->io_size = data_blocks / num_entries * data_block_size;
+
+	max_blocks = SPDK_CEIL_DIV(trace->max_length, data_block_size);
+	max_blocks = spdk_max(max_blocks, job->io_size_blocks);
+	job->buf_size = max_blocks * spdk_bdev_desc_get_block_size(job->bdev_desc);
+	job->md_buf_size = max_blocks * spdk_bdev_get_md_size(job->bdev);
+
+	bdevperf_job_replay_next(job);
+
+	return 0;
+}
+
 static int
 bdevperf_construct_job(struct spdk_bdev *bdev, struct job_config *config,
 		       struct spdk_thread *thread)
@@ -1995,6 +2735,14 @@ bdevperf_construct_job(struct spdk_bdev *bdev, struct job_config *config,
 		job->ios_base = 0;
 	}
 
+	if (config->rw == JOB_CONFIG_RW_REPLAY) {
+		rc = bdevperf_job_init_replay(job, config);
+		if (rc != 0) {
+			bdevperf_job_free(job);
+			return rc;
+		}
+	}
+
 	if (job->is_random && g_zipf_theta > 0) {
 		job->zipf = spdk_zipf_create(job->size_in_ios, g_zipf_theta, 0);
 	}
@@ -2028,6 +2776,32 @@ bdevperf_construct_job(struct spdk_bdev *bdev, struct job_config *config,
 		return -ENOMEM;
 	}
 
+	if (config->num_rates != 0 || (job->trace != NULL && job->replay_speed > 0)) {
+		/* A timed replay is a single open-loop step */
+		job->num_steps = spdk_max(config->num_rates, 1);
+		job->steps = calloc(job->num_steps, sizeof(*job->steps));
+		if (job->steps == NULL) {
+			fprintf(stderr, "Failed to allocate rate steps\n");
+			bdevperf_job_free(job);
+			return -ENOMEM;
+		}
+
+		for (n = 0; n < (int)job->num_steps; n++) {
+			job->steps[n].histogram = spdk_histogram_data_alloc();
+			if (job->steps[n].histogram == NULL) {
+				fprintf(stderr, "Failed to allocate histogram\n");
+				bdevperf_job_free(job);
+				return -ENOMEM;
+			}
+		}
+
+		job->num_rates = config->num_rates;
+		memcpy(job->rate_iops, config->rate_iops, sizeof(job->rate_iops));
+		job->arrival = config->arrival;
+		job->rate_seed = spdk_rand_xorshift64_seed();
+		g_num_rate_steps = spdk_max(g_num_rate_steps, job->num_rates);
+	}
+
 	TAILQ_INIT(&job->task_list);
 
 	if (g_random_map) {
@@ -2152,6 +2926,8 @@ parse_rw(const char *str, enum job_config_rw ret)
 		ret = JOB_CONFIG_RW_RW;
 	} else if (!strcmp(str, "randrw")) {
 		ret = JOB_CONFIG_RW_RANDRW;
+	} else if (!strcmp(str, "replay")) {
+		ret = JOB_CONFIG_RW_REPLAY;
 	} else {
 		fprintf(stderr, "rw must be one of\n"
 			PATTERN_TYPES_STR "\n");
@@ -2161,6 +2937,74 @@ parse_rw(const char *str, enum job_config_rw ret)
 	return ret;
 }
 
+static int
+parse_arrival(const char *str, enum bdevperf_arrival ret)
+{
+	if (str == NULL) {
+		return ret;
+	}
+
+	if (!strcmp(str, "poisson")) {
+		ret = BDEVPERF_ARRIVAL_POISSON;
+	} else if (!strcmp(str, "constant")) {
+		ret = BDEVPERF_ARRIVAL_CONSTANT;
+	} else {
+		fprintf(stderr, "arrival must be one of (poisson, constant)\n");
+		ret = BDEVPERF_CONFIG_ERROR;
+	}
+
+	return ret;
+}
+
+/* Parse a comma separated list of rates to run at, one after another */
+static int
+parse_rate_iops(const char *str, struct job_config *config)
+{
+	char *rates, *rate, *sp = NULL;
+	long long tmp;
+	int rc = 0;
+
+	config->num_rates = 0;
+	if (str == NULL) {
+		return 0;
+	}
+
+	rates = strdup(str);
+	if (rates == NULL) {
+		return -ENOMEM;
+	}
+
+	for (rate = strtok_r(rates, ",", &sp); rate != NULL; rate = strtok_r(NULL, ",", &sp)) {
+		if (config->num_rates == BDEVPERF_MAX_RATE_STEPS) {
+			fprintf(stderr, "At most %d rates can be specified\n",
+				BDEVPERF_MAX_RATE_STEPS);
+			rc = -E2BIG;
+			break;
+		}
+
+		tmp = spdk_strtoll(rate, 10);
+		if (tmp <= 0) {
+			fprintf(stderr, "Invalid rate: %s\n", rate);
+			rc = -EINVAL;
+			break;
+		}
+
+		config->rate_iops[config->num_rates++] = tmp;
+	}
+
+	if (rc == 0 && config->num_rates == 0) {
+		fprintf(stderr, "Invalid rate: %s\n", str);
+		rc = -EINVAL;
+	}
+
+	free(rates);
+	if (rc != 0) {
+		config->num_rates = 0;
+	}
+
+	return rc;
+}
+
 static const char *
 config_filename_next(const char *filename, char *out)
 {
@@ -2301,6 +3145,14 @@ make_cli_job_config(const char *filename, int64_t offset, uint64_t range)
 		free(config);
 		return -EINVAL;
 	}
+	config->arrival = parse_arrival(g_arrival, BDEVPERF_ARRIVAL_POISSON);
+	if ((int)config->arrival == BDEVPERF_CONFIG_ERROR ||
+	    parse_rate_iops(g_rate_iops, config) != 0) {
+		free(config);
+		return -EINVAL;
+	}
+	config->replay_file = g_replay_file;
+	config->replay_speed = g_replay_speed < 0 ? 1.0 : g_replay_speed;
 
 	TAILQ_INSERT_TAIL(&job_config_list, config, link);
 	return 0;
@@ -2474,6 +3326,38 @@ config_set_cli_args(struct job_config *config)
 	if (g_workload_type) {
 		config->rw = parse_rw(g_workload_type, config->rw);
 	}
+	if (g_rate_iops) {
+		/* Already validated when parsing the arguments */
+		parse_rate_iops(g_rate_iops, config);
+	}
+	if (g_arrival) {
+		config->arrival = parse_arrival(g_arrival, config->arrival);
+	}
+	if (g_replay_file) {
+		config->replay_file = g_replay_file;
+	}
+	if (g_replay_speed >= 0) {
+		config->replay_speed = g_replay_speed;
+	}
+}
+
+static int
+parse_replay_speed(const char *str, double *speed)
+{
+	char *endptr;
+
+	if (str == NULL) {
+		return 0;
+	}
+
+	errno = 0;
+	*speed = strtod(str, &endptr);
+	if (errno || str == endptr || *endptr != '\0' || *speed < 0) {
+		fprintf(stderr, "Illegal replay speed %s\n", str);
+		return -EINVAL;
+	}
+
+	return 0;
 }
 
 static int
@@ -2485,6 +3369,9 @@ read_job_config(void)
 	struct job_config *config = NULL;
 	const char *cpumask;
 	const char *rw;
+	const char *rate_iops;
+	const char *arrival;
+	const char *replay_speed;
 	bool is_global;
 	int n = 0;
 	int val;
@@ -2519,9 +3406,15 @@ read_job_config(void)
 	/* length 0 means 100% */
 	global_default_config.length = 0;
 	global_default_config.rw = BDEVPERF_CONFIG_UNDEFINED;
+	/* no rates means closed-loop */
+	global_default_config.num_rates = 0;
+	global_default_config.arrival = BDEVPERF_ARRIVAL_POISSON;
+	global_default_config.replay_file = NULL;
+	global_default_config.replay_speed = 1.0;
 	config_set_cli_args(&global_default_config);
 
-	if ((int)global_default_config.rw == BDEVPERF_CONFIG_ERROR) {
+	if ((int)global_default_config.rw == BDEVPERF_CONFIG_ERROR ||
+	    (int)global_default_config.arrival == BDEVPERF_CONFIG_ERROR) {
 		return 1;
 	}
 
@@ -2619,6 +3512,35 @@ read_job_config(void)
 			goto error;
 		}
 
+		rate_iops = spdk_conf_section_get_val(s, "rate_iops");
+		if (rate_iops == NULL) {
+			memcpy(config->rate_iops, global_config.rate_iops,
+			       sizeof(config->rate_iops));
+			config->num_rates = global_config.num_rates;
+		} else if (parse_rate_iops(rate_iops, config) != 0) {
+			fprintf(stderr, "Job '%s' has bad 'rate_iops' value\n", config->name);
+			goto error;
+		}
+
+		arrival = spdk_conf_section_get_val(s, "arrival");
+		config->arrival = parse_arrival(arrival, global_config.arrival);
+		if ((int)config->arrival == BDEVPERF_CONFIG_ERROR) {
+			fprintf(stderr, "Job '%s' has bad 'arrival' value\n", config->name);
+			goto error;
+		}
+
+		config->replay_file = spdk_conf_section_get_val(s, "replay");
+		if (config->replay_file == NULL) {
+			config->replay_file = global_config.replay_file;
+		}
+
+		replay_speed = spdk_conf_section_get_val(s, "replay_speed");
+		config->replay_speed = global_config.replay_speed;
+		if (parse_replay_speed(replay_speed, &config->replay_speed) != 0) {
+			fprintf(stderr, "Job '%s' has bad 'replay_speed' value\n", config->name);
+			goto error;
+		}
+
 		if (is_global) {
 			config_set_cli_args(config);
 			global_config = *config;
@@ -2676,6 +3598,9 @@ rpc_perform_tests_reset(void)
 
 	/* Reset g_show_performance_period_num to 0 for the next test run. */
 	g_show_performance_period_num = 0;
+
+	/* The number of rate steps is recalculated when the jobs are constructed. */
+	g_num_rate_steps = 1;
 }
 
 static void
@@ -2699,6 +3624,8 @@ struct rpc_bdevperf_params {
 	uint32_t	queue_depth;
 	char		*io_size;
 	int		rw_percentage;
+	char		*rate_iops;
+	char		*arrival;
 };
 
 static const struct spdk_json_object_decoder rpc_bdevperf_params_decoders[] = {
@@ -2707,6 +3634,8 @@ static const struct spdk_json_object_decoder rpc_bdevperf_params_decoders[] = {
 	{"queue_depth", offsetof(struct rpc_bdevperf_params, queue_depth), spdk_json_decode_uint32, true},
 	{"io_size", offsetof(struct rpc_bdevperf_params, io_size), spdk_json_decode_string, true},
 	{"rw_percentage", offsetof(struct rpc_bdevperf_params, rw_percentage), spdk_json_decode_int32, true},
+	{"rate_iops", offsetof(struct rpc_bdevperf_params, rate_iops), spdk_json_decode_string, true},
+	{"arrival", offsetof(struct rpc_bdevperf_params, arrival), spdk_json_decode_string, true},
 };
 
 static void
@@ -2732,6 +3661,14 @@ rpc_apply_bdevperf_params(struct rpc_bdevperf_params *params)
 	} else {
 		g_mix_specified = false;
 	}
+	if (params->rate_iops) {
+		free(g_rate_iops);
+		g_rate_iops = strdup(params->rate_iops);
+	}
+	if (params->arrival) {
+		free(g_arrival);
+		g_arrival = strdup(params->arrival);
+	}
 }
 
 static void
@@ -2766,11 +3703,19 @@ rpc_perform_tests(struct spdk_jsonrpc_request *request, const struct spdk_json_v
 		}
 		backup.time_in_sec = g_time_in_sec;
 		backup.rw_percentage = g_rw_percentage;
+		if (g_rate_iops) {
+			backup.rate_iops = strdup(g_rate_iops);
+		}
+		if (g_arrival) {
+			backup.arrival = strdup(g_arrival);
+		}
 
 		rpc_apply_bdevperf_params(&req);
 
 		free(req.workload_type);
 		free(req.io_size);
+		free(req.rate_iops);
+		free(req.arrival);
 	}
 
 	rc = verify_test_params();
@@ -2795,6 +3740,8 @@ rpc_perform_tests(struct spdk_jsonrpc_request *request, const struct spdk_json_v
 rpc_error:
 	free(backup.io_size);
 	free(backup.workload_type);
+	free(backup.rate_iops);
+	free(backup.arrival);
 }
 SPDK_RPC_REGISTER("perform_tests", rpc_perform_tests, SPDK_RPC_RUNTIME)
 
@@ -2867,6 +3814,26 @@ bdevperf_parse_arg(int ch, char *arg)
 		g_unique_writes = true;
 	} else if (ch == 'N') {
 		g_hide_metadata = true;
+	} else if (ch == 'I') {
+		struct job_config config;
+
+		if (parse_rate_iops(arg, &config) != 0) {
+			return -EINVAL;
+		}
+		free(g_rate_iops);
+		g_rate_iops = strdup(arg);
+	} else if (ch == 'a') {
+		if ((int)parse_arrival(arg, BDEVPERF_ARRIVAL_POISSON) == BDEVPERF_CONFIG_ERROR) {
+			return -EINVAL;
+		}
+		free(g_arrival);
+		g_arrival = strdup(arg);
+	} else if (ch == 'Y') {
+		g_replay_file = arg;
+	} else if (ch == 'y') {
+		if (parse_replay_speed(arg, &g_replay_speed) != 0) {
+			return -EINVAL;
+		}
 	} else {
 		tmp = spdk_strtoll(arg, 10);
 		if (tmp < 0) {
@@ -2935,13 +3902,31 @@ bdevperf_usage(void)
 	printf(" -U                        generate unique data for each write I/O, has no effect on non-write I/O\n");
 	printf(" -N                        Enable hide_metadata option to each bdev\n");
 	printf(" -H                        allocate non-huge data buffers\n");
+	printf(" -I <iops>[,<iops>...]     open-loop mode: submit I/O at the given rate per job instead of keeping\n");
+	printf("                           <depth> I/O outstanding, which then limits the outstanding I/O. Latency\n");
+	printf("                           is measured from the time I/O was due. Several rates are run one after\n");
+	printf("                           another for <time> seconds each.\n");
+	printf(" -a <arrival>              arrival process of the open-loop mode: poisson (default) or constant\n");
+	printf(" -Y <file>                 trace to replay with the replay workload, see bdevperf_trace.py\n");
+	printf(" -y <speed>                replay speed factor of the trace (default 1.0). 0 replays it as fast as\n");
+	printf("                           <depth> outstanding I/O allow, otherwise latency is measured from the\n");
+	printf("                           time I/O was due.\n");
 }
 
 static void
 bdevperf_fini(void)
 {
+	struct bdevperf_trace *trace;
+
 	free_job_config();
 	free(g_workload_type);
+	free(g_rate_iops);
+	free(g_arrival);
+
+	while ((trace = TAILQ_FIRST(&g_traces)) != NULL) {
+		TAILQ_REMOVE(&g_traces, trace, link);
+		bdevperf_trace_free(trace);
+	}
 
 	if (g_rpc_log_file != NULL) {
 		fclose(g_rpc_log_file);
@@ -2952,6 +3937,8 @@ bdevperf_fini(void)
 static int
 verify_test_params(void)
 {
+	struct job_config config;
+
 	if (!g_bdevperf_conf_file && g_queue_depth == 0) {
 		goto out;
 	}
@@ -2978,6 +3965,11 @@ verify_test_params(void)
 		printf("Timeout must be set for abort option, Ignoring g_abort\n");
 	}
 
+	if (parse_rate_iops(g_rate_iops, &config) != 0 ||
+	    (int)parse_arrival(g_arrival, BDEVPERF_ARRIVAL_POISSON) == BDEVPERF_CONFIG_ERROR) {
+		goto out;
+	}
+
 	if (g_show_performance_ema_period > 0 && g_summarize_performance) {
 		fprintf(stderr, "-P option must be specified with -S option\n");
 		return 1;
@@ -2995,6 +3987,11 @@ verify_test_params(void)
 		return 0;
 	}
 
+	if (!strcmp(g_workload_type, "replay") && g_replay_file == NULL) {
+		fprintf(stderr, "-Y must be specified for replay.\n");
+		return 1;
+	}
+
 	if (!strcmp(g_workload_type, "verify") ||
 	    !strcmp(g_workload_type, "reset")) {
 		g_rw_percentage = 50;
@@ -3012,7 +4009,8 @@ verify_test_params(void)
 	    !strcmp(g_workload_type, "reset") ||
 	    !strcmp(g_workload_type, "unmap") ||
 	    !strcmp(g_workload_type, "write_zeroes") ||
-	    !strcmp(g_workload_type, "flush")) {
+	    !strcmp(g_workload_type, "flush") ||
+	    !strcmp(g_workload_type, "replay")) {
 		if (g_mix_specified) {
 			fprintf(stderr, "Ignoring -M option... Please use -M option"
 				" only when using rw or randrw.\n");
@@ -3058,7 +4056,7 @@ main(int argc, char **argv)
 	opts.rpc_addr = NULL;
 	opts.shutdown_cb = spdk_bdevperf_shutdown_cb;
 
-	if ((rc = spdk_app_parse_args(argc, argv, &opts, "Zzfq:o:t:w:k:CEF:HJ:M:P:S:T:Xlj:DUN", NULL,
+	if ((rc = spdk_app_parse_args(argc, argv, &opts, "Zzfq:o:t:w:k:CEF:HI:J:M:P:S:T:Xa:lj:DUNY:y:", NULL,
 				      bdevperf_parse_arg, bdevperf_usage)) !=
 	    SPDK_APP_PARSE_ARGS_SUCCESS) {
 		return rc;
@@ -21,7 +21,7 @@ except ImportError:
 
 
 PATTERN_TYPES_STR = ("read", "write", "randread", "randwrite", "rw", "randrw", "verify", "reset",
-                     "unmap", "flush", "write_zeroes")
+                     "unmap", "flush", "write_zeroes", "replay")
 
 
 def perform_tests_func(args):
@@ -34,7 +34,8 @@ def perform_tests_func(args):
         On success, 0 is returned. On error, -1 is returned.
     """
     client = args.client
-    param_names = ['queue_depth', 'time_in_sec', 'workload_type', 'io_size', 'rw_percentage']
+    param_names = ['queue_depth', 'time_in_sec', 'workload_type', 'io_size', 'rw_percentage',
+                   'rate_iops', 'arrival']
     params = {name: getattr(args, name) for name in param_names if getattr(args, name, None)}
     return client.call('perform_tests', params)
 
@@ -73,6 +74,10 @@ if __name__ == "__main__":
                    type=int, choices=range(0, 101), metavar="[0-100]")
     p.add_argument('-w', dest="workload_type", choices=PATTERN_TYPES_STR, type=str.lower,
                    help=f'io pattern type, must be one of {PATTERN_TYPES_STR}',)
+    p.add_argument('-I', dest="rate_iops", type=str,
+                   help='Open-loop mode: comma separated I/O rates per job, run one after another')
+    p.add_argument('-a', dest="arrival", choices=['poisson', 'constant'],
+                   help='Arrival process of the open-loop mode')
     p.set_defaults(func=perform_tests)
 
     def call_rpc_func(args):
@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+#  SPDX-License-Identifier: BSD-3-Clause
+#  Copyright (C) 2026 Intel Corporation.
+#  All rights reserved.
+#
+
+"""Convert I/O traces into the format replayed by bdevperf's replay workload (-w replay -Y).
+
+The file starts with a header (magic "BDPTRACE", version, entry size) followed by one entry per
+I/O sorted by time: time in ns since the first I/O, offset and length in bytes and the
+spdk_bdev_io_type of the I/O.  All fields are little endian.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+TRACE_MAGIC = b'BDPTRACE'
+TRACE_VERSION = 1
+HEADER = struct.Struct('<8sII')
+ENTRY = struct.Struct('<QQIB3x')
+
+# enum spdk_bdev_io_type
+IO_TYPES = {1: 'read', 2: 'write', 3: 'unmap', 4: 'flush', 9: 'write_zeroes'}
+IO_TYPE_READ = 1
+IO_TYPE_WRITE = 2
+IO_TYPE_UNMAP = 3
+IO_TYPE_FLUSH = 4
+
+# struct blk_io_trace from linux/blktrace_api.h
+BLK_IO_TRACE = struct.Struct('IIQQIIIIHHH')
+BLK_IO_TRACE_MAGIC = 0x65617400
+BLK_TA_QUEUE = 1
+BLK_TA_ISSUE = 7
+BLK_TC_WRITE = 1 << 1
+BLK_TC_FLUSH = 1 << 2
+BLK_TC_PC = 1 << 9
+BLK_TC_NOTIFY = 1 << 10
+BLK_TC_DISCARD = 1 << 13
+
+
+def write_trace(path, ios):
+    ios.sort(key=lambda io: io[0])
+    if not ios:
+        sys.exit('No I/O found in the input trace')
+
+    start = ios[0][0]
+    with open(path, 'wb') as f:
+        f.write(HEADER.pack(TRACE_MAGIC, TRACE_VERSION, ENTRY.size))
+        for time_ns, offset, length, io_type in ios:
+            f.write(ENTRY.pack(time_ns - start, offset, length, io_type))
+
+    print(f'Wrote {len(ios)} I/O to {path}')
+
+
+def read_spdk(args):
+    """Read the JSON output of spdk_trace -j, using the BDEV_IO_START tracepoints."""
+    with open(args.input, 'r') as f:
+        trace = json.load(f)
+
+    tsc_rate = trace['tsc_rate']
+    tpoints = {tp['name']: tp for tp in trace['tpoints']}
+    if 'BDEV_IO_START' not in tpoints:
+        sys.exit('The trace has no BDEV_IO_START tracepoint, was the bdev tpoint group enabled?')
+    tpoint = tpoints['BDEV_IO_START']
+    arg_names = [arg['name'] for arg in tpoint['args']]
+
+    ios = []
+    for entry in trace['entries']:
+        if entry['tpoint'] != tpoint['id']:
+            continue
+        if args.owner is not None and entry.get('poller') != args.owner:
+            continue
+
+        entry_args = dict(zip(arg_names, entry['args']))
+        io_type = entry_args['type']
+        if io_type not in IO_TYPES:
+            continue
+
+        time_ns = entry['tsc'] * 10**9 // tsc_rate
+        ios.append((time_ns, entry_args['offset'] * args.block_size,
+                    entry.get('size', 0) * args.block_size, io_type))
+
+    return ios
+
+
+def blktrace_records(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    fmt = None
+    pos = 0
+    while pos + BLK_IO_TRACE.size <= len(data):
+        if fmt is None:
+            for order in '<>':
+                if struct.unpack_from(order + 'I', data, pos)[0] & 0xffffff00 == BLK_IO_TRACE_MAGIC:
+                    fmt = struct.Struct(order + BLK_IO_TRACE.format)
+                    break
+            else:
+                sys.exit(f'{path} is not a binary blktrace file')
+
+        (magic, _, time, sector, length, action, _, _, _, _, pdu_len) = fmt.unpack_from(data, pos)
+        if magic & 0xffffff00 != BLK_IO_TRACE_MAGIC:
+            sys.exit(f'{path} is corrupted at offset {pos}')
+
+        pos += fmt.size + pdu_len
+        yield time, sector, length, action
+
+
+def read_blktrace(args):
+    """Read the binary per-CPU files written by blktrace for a single device."""
+    event = BLK_TA_ISSUE if args.event == 'issue' else BLK_TA_QUEUE
+
+    ios = []
+    for path in args.input:
+        for time, sector, length, action in blktrace_records(path):
+            category = action >> 16
+            if action & 0xffff != event or category & (BLK_TC_NOTIFY | BLK_TC_PC):
+                continue
+
+            if category & BLK_TC_DISCARD:
+                io_type = IO_TYPE_UNMAP
+            elif category & BLK_TC_WRITE:
+                io_type = IO_TYPE_WRITE
+            elif category & BLK_TC_FLUSH and length == 0:
+                io_type = IO_TYPE_FLUSH
+            else:
+                io_type = IO_TYPE_READ
+
+            if length == 0 and io_type != IO_TYPE_FLUSH:
+                continue
+
+            ios.append((time, sector * 512, length, io_type))
+
+    return ios
+
+
+def info(args):
+    with open(args.input, 'rb') as f:
+        data = f.read()
+
+    magic, version, entry_size = HEADER.unpack_from(data)
+    if magic != TRACE_MAGIC or version != TRACE_VERSION or entry_size != ENTRY.size:
+        sys.exit(f'{args.input} is not a bdevperf trace')
+
+    count = {}
+    length = {}
+    time_ns = 0
+    max_offset = 0
+    num_entries = (len(data) - HEADER.size) // ENTRY.size
+    for time_ns, offset, size, io_type in ENTRY.iter_unpack(data[HEADER.size:HEADER.size +
+                                                                 num_entries * ENTRY.size]):
+        name = IO_TYPES.get(io_type, str(io_type))
+        count[name] = count.get(name, 0) + 1
+        length[name] = length.get(name, 0) + size
+        max_offset = max(max_offset, offset + size)
+
+    print(f'I/O: {num_entries}')
+    print(f'Duration: {time_ns / 10**9:.3f} s')
+    if time_ns > 0:
+        print(f'Rate: {num_entries * 10**9 / time_ns:.2f} IOPS')
+    print(f'Highest offset: {max_offset}')
+    for name in sorted(count):
+        print(f'{name}: {count[name]} I/O, {length[name] // count[name]} bytes average')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert I/O traces for bdevperf\'s replay workload')
+    subparsers = parser.add_subparsers(dest='command', required=True)
+
+    p = subparsers.add_parser('spdk', help='Convert the JSON output of spdk_trace -j')
+    p.add_argument('input', help='Output of spdk_trace -j')
+    p.add_argument('output', help='bdevperf trace to write')
+    p.add_argument('-b', '--block-size', type=int, default=512,
+                   help='Block size of the traced bdev (default: %(default)s)')
+    p.add_argument('-o', '--owner', help='Only convert I/O of the given owner, e.g. b01')
+    p.set_defaults(func=lambda args: write_trace(args.output, read_spdk(args)))
+
+    p = subparsers.add_parser('blktrace', help='Convert the binary files written by blktrace')
+    p.add_argument('input', nargs='+', help='blktrace files of the device, e.g. sda.blktrace.*')
+    p.add_argument('-w', '--output', required=True, help='bdevperf trace to write')
+    p.add_argument('-e', '--event', choices=['queue', 'issue'], default='queue',
+                   help='Event timing the I/O: queued by the application or issued to the '
+                        'device (default: %(default)s)')
+    p.set_defaults(func=lambda args: write_trace(args.output, read_blktrace(args)))
+
+    p = subparsers.add_parser('info', help='Show a summary of a bdevperf trace')
+    p.add_argument('input', help='bdevperf trace')
+    p.set_defaults(func=info)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == '__main__':
+    main()
@@ -865,6 +865,76 @@ void spdk_bdev_get_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits);
 void spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 				   void (*cb_fn)(void *cb_arg, int status), void *cb_arg);
 
+/**
+ * Create a QoS group. The bdevs added to the group share its rate limits in proportion to
+ * their weights. The share of the bdevs which don't use it is given to the others.
+ *
+ * This function must be called from the app thread.
+ *
+ * \param name Name of the group.
+ * \param limits Rate limits of the group, in the units used by spdk_bdev_set_qos_rate_limits().
+ * At least one of them must be set, 0 or UINT64_MAX means not limited.
+ * \param latency_target_us If not 0, the limits are lowered while more than 1% of the I/Os
+ * to the group's bdevs take longer than this to complete.
+ *
+ * \return 0 on success, negative errno on failure.
+ *
+ * The limits are ordered based on the @ref spdk_bdev_qos_rate_limit_type enum.
+ */
+int spdk_bdev_qos_group_create(const char *name, const uint64_t *limits,
+			       uint64_t latency_target_us);
+
+/**
+ * Delete a QoS group. The group must not have any bdevs.
+ *
+ * This function must be called from the app thread.
+ *
+ * \param name Name of the group.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_bdev_qos_group_delete(const char *name);
+
+/**
+ * Add a bdev to a QoS group.
+ *
+ * This function must be called from the app thread.
+ *
+ * \param group_name Name of the group.
+ * \param bdev_name Name of the bdev.
+ * \param weight Weight of the bdev, from 1 to 10000.
+ * \param min_limits Rates guaranteed to the bdev, in the units used by
+ * spdk_bdev_set_qos_rate_limits(), or NULL. 0 or UINT64_MAX means no guarantee.
+ * \param cb_fn Callback function to be called when the bdev has been added.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void spdk_bdev_qos_group_add_bdev(const char *group_name, const char *bdev_name, uint32_t weight,
+				  const uint64_t *min_limits,
+				  void (*cb_fn)(void *cb_arg, int status), void *cb_arg);
+
+/**
+ * Remove a bdev from a QoS group. The bdev's own rate limits, if any, remain in effect.
+ *
+ * This function must be called from the app thread.
+ *
+ * \param group_name Name of the group.
+ * \param bdev_name Name of the bdev.
+ * \param cb_fn Callback function to be called when the bdev has been removed.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void spdk_bdev_qos_group_remove_bdev(const char *group_name, const char *bdev_name,
+				     void (*cb_fn)(void *cb_arg, int status), void *cb_arg);
+
+/**
+ * Write an array describing the QoS groups, including the rates currently assigned to and used
+ * by their bdevs, to a JSON context.
+ *
+ * This function must be called from the app thread.
+ *
+ * \param w JSON write context.
+ */
+void spdk_bdev_qos_groups_dump_info_json(struct spdk_json_write_ctx *w);
+
 /**
  * Get minimum I/O buffer address alignment for a bdev.
  *
@@ -987,7 +987,8 @@ struct spdk_bdev_io_internal_fields {
 			/** Whether the I/O is a sub-I/O of a split parent I/O */
 			uint8_t child_io		: 1;
 
-			uint8_t reserved			: 1;
+			/** Whether the I/O was queued due to QoS rate limits */
+			uint8_t qos_queued			: 1;
 		};
 		uint8_t raw;
 	} f;
@@ -315,8 +315,18 @@ struct spdk_bs_opts {
 	 * Context to pass with esnap_bs_dev_create.
 	 */
 	void *esnap_ctx;
+
+	/**
+	 * Number of clusters each I/O channel reserves at once for the first writes to
+	 * unallocated clusters of thin provisioned blobs. Clusters are then allocated from the
+	 * channel's reservation without taking the blobstore-wide allocation lock. Reservations
+	 * are only made while the blobstore has at least 64 times this many free clusters, and
+	 * clusters reserved by a channel are not available to other channels until they are
+	 * returned when the channel is destroyed. 0 disables the reservations.
+	 */
+	uint32_t cluster_reserve_batch;
 } __attribute__((packed));
-SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_opts) == 88, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_opts) == 92, "Incorrect size");
 
 /**
  * Initialize a spdk_bs_opts structure to the default blobstore option values.
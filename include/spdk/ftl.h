@@ -70,10 +70,52 @@ struct ftl_stats {
 	uint64_t		io_activity_total;
 
 	struct ftl_stats_entry	entries[FTL_STATS_TYPE_MAX];
+
+	/* Bands chosen by GC and the number of their valid and invalid blocks at that time */
+	struct {
+		uint64_t bands;
+		uint64_t valid_blocks;
+		uint64_t invalid_blocks;
+	} gc;
+
+	/* L2P cache page lookups done when pinning LBAs and pages evicted to fit l2p_dram_limit */
+	struct {
+		uint64_t hits;
+		uint64_t misses;
+		uint64_t evictions;
+	} l2p_cache;
 };
 
 typedef void (*spdk_ftl_stats_fn)(struct ftl_stats *stats, void *cb_arg);
 
+enum spdk_ftl_recovery_state {
+	/* No dirty shutdown recovery, or the L2P was recovered from shared memory */
+	SPDK_FTL_RECOVERY_STATE_NONE,
+	/* L2P is being rebuilt from the P2L maps of bands and NV cache chunks */
+	SPDK_FTL_RECOVERY_STATE_RUNNING,
+	/* L2P rebuild is finished, the rest of the startup may still be in progress */
+	SPDK_FTL_RECOVERY_STATE_DONE,
+};
+
+/* Progress of the L2P rebuild done when loading FTL after a dirty shutdown */
+struct spdk_ftl_recovery_progress {
+	enum spdk_ftl_recovery_state	state;
+
+	/* L2P is rebuilt in iterations, each recovering the part of it which fits l2p_dram_limit */
+	uint32_t			iteration;
+	uint32_t			iterations;
+
+	/* P2L maps applied to the L2P, counted over all the iterations */
+	uint64_t			p2l_maps_done;
+	uint64_t			p2l_maps_total;
+
+	/* Number of threads applying the P2L maps */
+	uint32_t			num_threads;
+
+	/* Time spent rebuilding the L2P */
+	uint64_t			elapsed_us;
+};
+
 /*
  * FTL configuration.
  *
@@ -92,7 +134,7 @@ struct spdk_ftl_conf {
 	/* l2p cache size that could reside in DRAM (in MiB) */
 	size_t					l2p_dram_limit;
 
-	/* Core mask - core thread plus additional relocation threads */
+	/* Core mask - core thread on the first core plus IO threads on the remaining ones */
 	char					*core_mask;
 
 	/* IO pool size per user thread */
@@ -369,6 +411,22 @@ int spdk_ftl_get_properties(struct spdk_ftl_dev *dev, struct spdk_jsonrpc_reques
 int spdk_ftl_set_property(struct spdk_ftl_dev *dev, const char *property, const char *value,
 			  size_t value_size, spdk_ftl_fn cb_fn, void *cb_arg);
 
+/**
+ * Gets the progress of the dirty shutdown recovery of the specified device.
+ *
+ * The device is looked up by name, so the progress is also available while the device is
+ * still being loaded. It's read without synchronization with the recovery and is only meant
+ * for monitoring.
+ *
+ * \param name Name of the FTL device
+ * \param progress Progress structure to fill
+ * \param progress_size Must be set to sizeof(struct spdk_ftl_recovery_progress)
+ *
+ * \return 0 on success, -ENODEV if there's no device with the given name.
+ */
+int spdk_ftl_get_recovery_progress(const char *name, struct spdk_ftl_recovery_progress *progress,
+				   size_t progress_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -71,6 +71,9 @@ struct spdk_nvmf_target_opts {
 	uint32_t	discovery_filter;
 	uint32_t	dhchap_digests;
 	uint32_t	dhchap_dhgroups;
+	/* Difference in busy percentage between poll groups that makes the busiest one migrate
+	 * its qpairs to the least busy one.  0 disables the migration. */
+	uint32_t	qpair_balance_threshold;
 };
 
 struct spdk_nvmf_transport_opts {
@@ -184,6 +187,8 @@ struct spdk_nvmf_poll_group_stat {
 	uint64_t pending_bdev_io;
 	/* NVMe IO commands completed (excludes admin commands) */
 	uint64_t completed_nvme_io;
+	/* Bytes transferred by the completed NVMe IO commands */
+	uint64_t completed_nvme_bytes;
 };
 
 /**
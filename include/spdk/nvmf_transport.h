@@ -185,6 +185,14 @@ struct spdk_nvmf_qpair {
 		uint32_t			id_valid : 1;
 		int32_t				id : 31;
 	} numa;
+
+	/* NVMe IO commands completed since the poll group started looking for a qpair to migrate */
+	uint32_t				balance_io;
+
+	/* Set from the moment the qpair leaves its poll group until it's attached to the new one */
+	bool					migrating;
+	/* A disconnect requested before the qpair was attached, done once it is */
+	bool					disconnect_deferred;
 };
 
 static inline int32_t
@@ -203,6 +211,19 @@ struct spdk_nvmf_transport_poll_group {
 	TAILQ_ENTRY(spdk_nvmf_transport_poll_group)			link;
 };
 
+/* Load of a poll group measured over the last sampling period.  It is written by the poll
+ * group's thread and read without locking by the threads placing and migrating qpairs. */
+struct spdk_nvmf_poll_group_load {
+	uint64_t					iops;
+	uint64_t					bytes_per_sec;
+	/* Percentage of the period the poll group's thread spent doing work */
+	uint32_t					busy_pct;
+	/* NUMA node of the core running the poll group */
+	int32_t						numa_id;
+	/* Qpairs placed on the poll group since the last sample, not reflected in the load yet */
+	uint32_t					new_qpairs;
+};
+
 struct spdk_nvmf_poll_group {
 	struct spdk_thread				*thread;
 
@@ -232,6 +253,29 @@ struct spdk_nvmf_poll_group {
 	TAILQ_ENTRY(spdk_nvmf_poll_group)		link;
 
 	pthread_mutex_t					mutex;
+
+	struct spdk_nvmf_poll_group_load		load;
+	struct spdk_poller				*load_poller;
+
+	/* Counters at the previous load sample */
+	struct {
+		uint64_t				tsc;
+		uint64_t				busy_tsc;
+		uint64_t				idle_tsc;
+		uint64_t				completed_nvme_io;
+		uint64_t				completed_nvme_bytes;
+	} load_sample;
+
+	/* Number of consecutive samples this poll group was overloaded compared to the others */
+	uint32_t					overload_periods;
+
+	/* Qpair being migrated to another poll group */
+	struct {
+		struct spdk_nvmf_qpair			*qpair;
+		struct spdk_nvmf_poll_group		*dst;
+		struct spdk_poller			*poller;
+		uint64_t				timeout_tsc;
+	} migration;
 };
 
 struct spdk_nvmf_listener {
@@ -498,6 +542,22 @@ struct spdk_nvmf_transport_ops {
 	void (*subsystem_dump_host)(struct spdk_nvmf_transport *transport,
 				    const struct spdk_nvmf_subsystem *subsystem,
 				    const char *hostnqn, struct spdk_json_write_ctx *w);
+
+	/*
+	 * Detach a qpair from its poll group so that it can be attached to the poll group of
+	 * another thread.  The qpair has no outstanding requests, but the transport may still
+	 * be working on it, in which case it returns -EBUSY and the qpair stays in the group.
+	 * This callback is optional, qpairs of transports not implementing it are not migrated.
+	 */
+	int (*poll_group_detach)(struct spdk_nvmf_transport_poll_group *group,
+				 struct spdk_nvmf_qpair *qpair);
+
+	/*
+	 * Attach a qpair detached by poll_group_detach to a poll group.  Called on the thread of
+	 * the new poll group.
+	 */
+	int (*poll_group_attach)(struct spdk_nvmf_transport_poll_group *group,
+				 struct spdk_nvmf_qpair *qpair);
 };
 
 /**
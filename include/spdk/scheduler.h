@@ -175,6 +175,8 @@ struct spdk_scheduler_thread_info {
 	struct spdk_thread_stats total_stats;
 	/* stats during the last scheduling period */
 	struct spdk_thread_stats current_stats;
+	/* NUMA node of the resources served by the thread, see spdk_thread_get_numa_id() */
+	int32_t numa_id;
 };
 
 /**
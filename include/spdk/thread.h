@@ -589,6 +589,34 @@ void spdk_thread_set_interrupt_mode(bool enable_interrupt);
  */
 uint16_t spdk_thread_get_trace_id(struct spdk_thread *thread);
 
+/**
+ * Take a reference on a NUMA node for the current thread.
+ *
+ * Libraries take one for each resource the thread serves that is local to a NUMA node, e.g. a
+ * bdev I/O channel or an NVMe-oF queue pair.  Schedulers may use it to keep the thread on cores
+ * of that node.
+ *
+ * \param numa_id NUMA node ID.  SPDK_ENV_NUMA_ID_ANY is ignored.
+ */
+void spdk_thread_get_numa_ref(int32_t numa_id);
+
+/**
+ * Release a reference taken by spdk_thread_get_numa_ref() on the current thread.
+ *
+ * \param numa_id NUMA node ID.  SPDK_ENV_NUMA_ID_ANY is ignored.
+ */
+void spdk_thread_put_numa_ref(int32_t numa_id);
+
+/**
+ * Get the NUMA node of the resources served by a thread.
+ *
+ * \param thread Thread to query.
+ *
+ * \return NUMA node ID the thread holds the most references on, or SPDK_ENV_NUMA_ID_ANY if the
+ * thread holds none.
+ */
+int32_t spdk_thread_get_numa_id(struct spdk_thread *thread);
+
 /**
  * Register a poller on the current thread.
  *
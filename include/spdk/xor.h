@@ -28,6 +28,37 @@ extern "C" {
  */
 int spdk_xor_gen(void *dest, void **sources, uint32_t n, uint32_t len);
 
+/**
+ * Generate the RAID-6 P and Q syndromes from multiple source buffers.
+ *
+ * P is the XOR of the sources and Q is the sum of g^i * sources[i] in GF(2^8) with the
+ * generator polynomial 0x11d and g = 2.
+ *
+ * \param p Destination buffer for P.
+ * \param q Destination buffer for Q.
+ * \param sources Array of source buffers.
+ * \param n Number of source buffers in the array, at most 255.
+ * \param len Length of each buffer in bytes.
+ * \return 0 on success, negative error code otherwise.
+ */
+int spdk_xor_gen_pq(void *p, void *q, void **sources, uint32_t n, uint32_t len);
+
+/**
+ * Recover up to two failed buffers of a RAID-6 stripe.
+ *
+ * The contents of the failed buffers are ignored and overwritten with the recovered data.
+ *
+ * \param buffers Array of n + 2 buffers: the n data buffers followed by the P and Q buffers
+ * as generated by spdk_xor_gen_pq().
+ * \param n Number of data buffers, at most 255.
+ * \param len Length of each buffer in bytes.
+ * \param failed Array of indexes of the failed buffers in the buffers array.
+ * \param num_failed Number of failed buffers, 1 or 2.
+ * \return 0 on success, negative error code otherwise.
+ */
+int spdk_xor_recover_pq(void **buffers, uint32_t n, uint32_t len, const uint32_t *failed,
+			uint32_t num_failed);
+
 /**
  * Get the optimal buffer alignment for XOR functions.
  *
@@ -50,4 +50,8 @@ void _accel_crypto_keys_dump_param(struct spdk_json_write_ctx *w);
 typedef void (*accel_get_stats_cb)(struct accel_stats *stats, void *cb_arg);
 int accel_get_stats(accel_get_stats_cb cb_fn, void *cb_arg);
 
+/* Software module: execute large operations on num_workers dedicated threads */
+int accel_sw_set_workers(uint32_t num_workers, const char *cpumask);
+int accel_sw_set_offload_threshold(enum spdk_accel_opcode opcode, uint64_t threshold);
+
 #endif
@@ -463,3 +463,83 @@ rpc_accel_get_stats(struct spdk_jsonrpc_request *request, const struct spdk_json
 	}
 }
 SPDK_RPC_REGISTER("accel_get_stats", rpc_accel_get_stats, SPDK_RPC_RUNTIME)
+
+struct rpc_accel_sw_set_options {
+	uint32_t	num_workers;
+	char		*cpumask;
+};
+
+static const struct spdk_json_object_decoder rpc_accel_sw_set_options_decoders[] = {
+	{"num_workers", offsetof(struct rpc_accel_sw_set_options, num_workers), spdk_json_decode_uint32},
+	{"cpumask", offsetof(struct rpc_accel_sw_set_options, cpumask), spdk_json_decode_string, true},
+};
+
+static void
+rpc_accel_sw_set_options(struct spdk_jsonrpc_request *request, const struct spdk_json_val *params)
+{
+	struct rpc_accel_sw_set_options req = {};
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_accel_sw_set_options_decoders,
+				    SPDK_COUNTOF(rpc_accel_sw_set_options_decoders), &req)) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_PARSE_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = accel_sw_set_workers(req.num_workers, req.cpumask);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+cleanup:
+	free(req.cpumask);
+}
+SPDK_RPC_REGISTER("accel_sw_set_options", rpc_accel_sw_set_options, SPDK_RPC_STARTUP)
+
+struct rpc_accel_sw_set_offload_threshold {
+	char		*opname;
+	uint64_t	threshold;
+};
+
+static const struct spdk_json_object_decoder rpc_accel_sw_set_offload_threshold_decoders[] = {
+	{"opname", offsetof(struct rpc_accel_sw_set_offload_threshold, opname), spdk_json_decode_string},
+	{"threshold", offsetof(struct rpc_accel_sw_set_offload_threshold, threshold), spdk_json_decode_uint64},
+};
+
+static void
+rpc_accel_sw_set_offload_threshold(struct spdk_jsonrpc_request *request,
+				   const struct spdk_json_val *params)
+{
+	struct rpc_accel_sw_set_offload_threshold req = {};
+	enum spdk_accel_opcode opcode;
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_accel_sw_set_offload_threshold_decoders,
+				    SPDK_COUNTOF(rpc_accel_sw_set_offload_threshold_decoders), &req)) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_PARSE_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	for (opcode = 0; opcode < SPDK_ACCEL_OPC_LAST; opcode++) {
+		if (strcmp(spdk_accel_get_opcode_name(opcode), req.opname) == 0) {
+			break;
+		}
+	}
+
+	rc = accel_sw_set_offload_threshold(opcode, req.threshold);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response_fmt(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						     "Invalid operation name: %s", req.opname);
+		goto cleanup;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+cleanup:
+	free(req.opname);
+}
+SPDK_RPC_REGISTER("accel_sw_set_offload_threshold", rpc_accel_sw_set_offload_threshold,
+		  SPDK_RPC_STARTUP | SPDK_RPC_RUNTIME)
@@ -9,6 +9,7 @@
 #include "spdk/accel_module.h"
 #include "accel_internal.h"
 
+#include "spdk/cpuset.h"
 #include "spdk/env.h"
 #include "spdk/likely.h"
 #include "spdk/log.h"
@@ -44,6 +45,12 @@
 
 #define COMP_DEFLATE_LEVEL_NUM (COMP_DEFLATE_MAX_LEVEL + 1)
 
+/* Size of the ring of tasks waiting for a worker thread */
+#define ACCEL_SW_WORKER_RING_SIZE	4096
+/* Maximum number of tasks of a channel executed on the worker threads at a time */
+#define ACCEL_SW_COMPLETION_RING_SIZE	1024
+#define ACCEL_SW_BATCH_SIZE		32
+
 struct comp_deflate_level_buf {
 	uint32_t size;
 	uint8_t  *buf;
@@ -66,6 +73,60 @@ struct sw_accel_io_channel {
 #endif
 	struct spdk_poller		*completion_poller;
 	STAILQ_HEAD(, spdk_accel_task)	tasks_to_complete;
+	/* Tasks executed by the worker threads, in the order they were completed */
+	struct spdk_ring		*offload_completions;
+	uint32_t			num_offloaded;
+	uint32_t			next_worker;
+};
+
+struct sw_accel_task {
+	struct spdk_accel_task		task;
+	/* Channel the task was submitted on */
+	struct sw_accel_io_channel	*sw_ch;
+};
+
+struct sw_accel_worker {
+	struct spdk_thread		*thread;
+	/* Tasks to execute, enqueued by any thread */
+	struct spdk_ring		*ring;
+	/* The worker's own channel, for the compression state */
+	struct spdk_io_channel		*ch;
+	struct spdk_poller		*poller;
+	bool				running;
+};
+
+static uint32_t g_sw_num_workers;
+static struct spdk_cpuset g_sw_worker_cpumask;
+static bool g_sw_worker_cpumask_set;
+static struct sw_accel_worker *g_sw_workers;
+static uint32_t g_sw_num_running_workers;
+static struct spdk_thread *g_sw_fini_thread;
+
+/*
+ * Operations of at least this many bytes are executed on the worker threads, if there are any.
+ * 0 means that the operation is always executed inline. Memory bound operations are not worth
+ * the extra cache misses of moving them to another core.
+ */
+#define ACCEL_SW_DEFAULT_OFFLOAD_THRESHOLDS \
+	[SPDK_ACCEL_OPC_CRC32C] = 64 * 1024, \
+	[SPDK_ACCEL_OPC_COPY_CRC32C] = 64 * 1024, \
+	[SPDK_ACCEL_OPC_COMPRESS] = 16 * 1024, \
+	[SPDK_ACCEL_OPC_DECOMPRESS] = 16 * 1024, \
+	[SPDK_ACCEL_OPC_ENCRYPT] = 32 * 1024, \
+	[SPDK_ACCEL_OPC_DECRYPT] = 32 * 1024, \
+	[SPDK_ACCEL_OPC_XOR] = 64 * 1024, \
+	[SPDK_ACCEL_OPC_DIF_VERIFY] = 64 * 1024, \
+	[SPDK_ACCEL_OPC_DIF_GENERATE] = 64 * 1024, \
+	[SPDK_ACCEL_OPC_DIF_GENERATE_COPY] = 64 * 1024, \
+	[SPDK_ACCEL_OPC_DIF_VERIFY_COPY] = 64 * 1024, \
+	[SPDK_ACCEL_OPC_DIX_GENERATE] = 64 * 1024, \
+	[SPDK_ACCEL_OPC_DIX_VERIFY] = 64 * 1024,
+
+static const uint64_t g_sw_default_offload_threshold[SPDK_ACCEL_OPC_LAST] = {
+	ACCEL_SW_DEFAULT_OFFLOAD_THRESHOLDS
+};
+static uint64_t g_sw_offload_threshold[SPDK_ACCEL_OPC_LAST] = {
+	ACCEL_SW_DEFAULT_OFFLOAD_THRESHOLDS
 };
 
 typedef int (*sw_accel_crypto_op)(const uint8_t *k2, const uint8_t *k1,
@@ -678,6 +739,94 @@ _sw_accel_dix_verify(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *
 			       accel_task->dif.err);
 }
 
+static int
+sw_accel_execute_task(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	int rc = 0;
+
+	switch (accel_task->op_code) {
+	case SPDK_ACCEL_OPC_COPY:
+		_sw_accel_copy_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
+				    accel_task->s.iovs, accel_task->s.iovcnt);
+		break;
+	case SPDK_ACCEL_OPC_FILL:
+		rc = _sw_accel_fill(accel_task->d.iovs, accel_task->d.iovcnt,
+				    accel_task->fill_pattern);
+		break;
+	case SPDK_ACCEL_OPC_DUALCAST:
+		rc = _sw_accel_dualcast_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
+					     accel_task->d2.iovs, accel_task->d2.iovcnt,
+					     accel_task->s.iovs, accel_task->s.iovcnt);
+		break;
+	case SPDK_ACCEL_OPC_COMPARE:
+		rc = _sw_accel_compare(accel_task->s.iovs, accel_task->s.iovcnt,
+				       accel_task->s2.iovs, accel_task->s2.iovcnt);
+		break;
+	case SPDK_ACCEL_OPC_CRC32C:
+		_sw_accel_crc32cv(accel_task->crc_dst, accel_task->s.iovs, accel_task->s.iovcnt, accel_task->seed);
+		break;
+	case SPDK_ACCEL_OPC_COPY_CRC32C:
+		_sw_accel_copy_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
+				    accel_task->s.iovs, accel_task->s.iovcnt);
+		_sw_accel_crc32cv(accel_task->crc_dst, accel_task->s.iovs,
+				  accel_task->s.iovcnt, accel_task->seed);
+		break;
+	case SPDK_ACCEL_OPC_COMPRESS:
+		rc = _sw_accel_compress(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DECOMPRESS:
+		rc = _sw_accel_decompress(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_XOR:
+		rc = _sw_accel_xor(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_ENCRYPT:
+		rc = _sw_accel_encrypt(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DECRYPT:
+		rc = _sw_accel_decrypt(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIF_VERIFY:
+		rc = _sw_accel_dif_verify(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
+		rc = _sw_accel_dif_verify_copy(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIF_GENERATE:
+		rc = _sw_accel_dif_generate(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIF_GENERATE_COPY:
+		rc = _sw_accel_dif_generate_copy(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIX_GENERATE:
+		rc = _sw_accel_dix_generate(sw_ch, accel_task);
+		break;
+	case SPDK_ACCEL_OPC_DIX_VERIFY:
+		rc = _sw_accel_dix_verify(sw_ch, accel_task);
+		break;
+	default:
+		assert(false);
+		break;
+	}
+
+	return rc;
+}
+
+static void
+sw_accel_offload_complete(struct sw_accel_io_channel *sw_ch)
+{
+	struct spdk_accel_task *tasks[ACCEL_SW_BATCH_SIZE];
+	size_t i, count;
+
+	count = spdk_ring_dequeue(sw_ch->offload_completions, (void **)tasks, SPDK_COUNTOF(tasks));
+	assert(count <= sw_ch->num_offloaded);
+	sw_ch->num_offloaded -= count;
+
+	for (i = 0; i < count; i++) {
+		STAILQ_INSERT_TAIL(&sw_ch->tasks_to_complete, tasks[i], link);
+	}
+}
+
 static int
 accel_comp_poll(void *arg)
 {
@@ -685,6 +834,10 @@ accel_comp_poll(void *arg)
 	STAILQ_HEAD(, spdk_accel_task)	tasks_to_complete;
 	struct spdk_accel_task		*accel_task;
 
+	if (sw_ch->num_offloaded != 0) {
+		sw_accel_offload_complete(sw_ch);
+	}
+
 	if (STAILQ_EMPTY(&sw_ch->tasks_to_complete)) {
 		return SPDK_POLLER_IDLE;
 	}
@@ -700,12 +853,79 @@ accel_comp_poll(void *arg)
 	return SPDK_POLLER_BUSY;
 }
 
+static int
+sw_accel_worker_poll(void *arg)
+{
+	struct sw_accel_worker *worker = arg;
+	struct sw_accel_io_channel *worker_ch = spdk_io_channel_get_ctx(worker->ch);
+	struct spdk_accel_task *tasks[ACCEL_SW_BATCH_SIZE];
+	struct sw_accel_task *sw_task;
+	size_t i, count;
+	size_t rc __attribute__((unused));
+
+	count = spdk_ring_dequeue(worker->ring, (void **)tasks, SPDK_COUNTOF(tasks));
+	if (count == 0) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	for (i = 0; i < count; i++) {
+		sw_task = SPDK_CONTAINEROF(tasks[i], struct sw_accel_task, task);
+		tasks[i]->status = sw_accel_execute_task(worker_ch, tasks[i]);
+		/* The submitting channel never has more tasks offloaded than its ring can hold */
+		rc = spdk_ring_enqueue(sw_task->sw_ch->offload_completions, (void **)&tasks[i], 1, NULL);
+		assert(rc == 1);
+	}
+
+	return SPDK_POLLER_BUSY;
+}
+
+/* Hand the task over to a worker thread, if it's big enough to be worth it. */
+static bool
+sw_accel_offload_task(struct sw_accel_io_channel *sw_ch, struct spdk_accel_task *accel_task)
+{
+	struct sw_accel_task *sw_task = SPDK_CONTAINEROF(accel_task, struct sw_accel_task, task);
+	struct sw_accel_worker *worker;
+	uint64_t threshold;
+
+	if (g_sw_num_running_workers == 0) {
+		return false;
+	}
+
+	threshold = g_sw_offload_threshold[accel_task->op_code];
+	if (threshold == 0 || accel_task->nbytes < threshold ||
+	    sw_ch->num_offloaded == ACCEL_SW_COMPLETION_RING_SIZE) {
+		return false;
+	}
+
+	if (spdk_unlikely(sw_ch->offload_completions == NULL)) {
+		sw_ch->offload_completions = spdk_ring_create(SPDK_RING_TYPE_MP_SC,
+					     ACCEL_SW_COMPLETION_RING_SIZE,
+					     SPDK_ENV_NUMA_ID_ANY);
+		if (sw_ch->offload_completions == NULL) {
+			return false;
+		}
+	}
+
+	worker = &g_sw_workers[sw_ch->next_worker++ % g_sw_num_workers];
+	if (!worker->running) {
+		return false;
+	}
+
+	sw_task->sw_ch = sw_ch;
+	if (spdk_ring_enqueue(worker->ring, (void **)&accel_task, 1, NULL) != 1) {
+		return false;
+	}
+	sw_ch->num_offloaded++;
+
+	return true;
+}
+
 static int
 sw_accel_submit_tasks(struct spdk_io_channel *ch, struct spdk_accel_task *accel_task)
 {
 	struct sw_accel_io_channel *sw_ch = spdk_io_channel_get_ctx(ch);
 	struct spdk_accel_task *tmp;
-	int rc = 0;
+	int rc;
 
 	/*
 	 * Lazily initialize our completion poller. We don't want to complete
@@ -716,74 +936,12 @@ sw_accel_submit_tasks(struct spdk_io_channel *ch, struct spdk_accel_task *accel_
 	}
 
 	do {
-		switch (accel_task->op_code) {
-		case SPDK_ACCEL_OPC_COPY:
-			_sw_accel_copy_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
-					    accel_task->s.iovs, accel_task->s.iovcnt);
-			break;
-		case SPDK_ACCEL_OPC_FILL:
-			rc = _sw_accel_fill(accel_task->d.iovs, accel_task->d.iovcnt,
-					    accel_task->fill_pattern);
-			break;
-		case SPDK_ACCEL_OPC_DUALCAST:
-			rc = _sw_accel_dualcast_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
-						     accel_task->d2.iovs, accel_task->d2.iovcnt,
-						     accel_task->s.iovs, accel_task->s.iovcnt);
-			break;
-		case SPDK_ACCEL_OPC_COMPARE:
-			rc = _sw_accel_compare(accel_task->s.iovs, accel_task->s.iovcnt,
-					       accel_task->s2.iovs, accel_task->s2.iovcnt);
-			break;
-		case SPDK_ACCEL_OPC_CRC32C:
-			_sw_accel_crc32cv(accel_task->crc_dst, accel_task->s.iovs, accel_task->s.iovcnt, accel_task->seed);
-			break;
-		case SPDK_ACCEL_OPC_COPY_CRC32C:
-			_sw_accel_copy_iovs(accel_task->d.iovs, accel_task->d.iovcnt,
-					    accel_task->s.iovs, accel_task->s.iovcnt);
-			_sw_accel_crc32cv(accel_task->crc_dst, accel_task->s.iovs,
-					  accel_task->s.iovcnt, accel_task->seed);
-			break;
-		case SPDK_ACCEL_OPC_COMPRESS:
-			rc = _sw_accel_compress(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DECOMPRESS:
-			rc = _sw_accel_decompress(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_XOR:
-			rc = _sw_accel_xor(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_ENCRYPT:
-			rc = _sw_accel_encrypt(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DECRYPT:
-			rc = _sw_accel_decrypt(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DIF_VERIFY:
-			rc = _sw_accel_dif_verify(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DIF_VERIFY_COPY:
-			rc = _sw_accel_dif_verify_copy(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DIF_GENERATE:
-			rc = _sw_accel_dif_generate(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DIF_GENERATE_COPY:
-			rc = _sw_accel_dif_generate_copy(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DIX_GENERATE:
-			rc = _sw_accel_dix_generate(sw_ch, accel_task);
-			break;
-		case SPDK_ACCEL_OPC_DIX_VERIFY:
-			rc = _sw_accel_dix_verify(sw_ch, accel_task);
-			break;
-		default:
-			assert(false);
-			break;
-		}
-
 		tmp = STAILQ_NEXT(accel_task, link);
 
-		_add_to_comp_list(sw_ch, accel_task, rc);
+		if (!sw_accel_offload_task(sw_ch, accel_task)) {
+			rc = sw_accel_execute_task(sw_ch, accel_task);
+			_add_to_comp_list(sw_ch, accel_task, rc);
+		}
 
 		accel_task = tmp;
 	} while (accel_task);
@@ -802,6 +960,9 @@ sw_accel_create_cb(void *io_device, void *ctx_buf)
 
 	STAILQ_INIT(&sw_ch->tasks_to_complete);
 	sw_ch->completion_poller = NULL;
+	sw_ch->offload_completions = NULL;
+	sw_ch->num_offloaded = 0;
+	sw_ch->next_worker = 0;
 
 #ifdef SPDK_CONFIG_HAVE_LZ4
 	sw_ch->lz4_stream = LZ4_createStream();
@@ -856,6 +1017,9 @@ sw_accel_destroy_cb(void *io_device, void *ctx_buf)
 	LZ4_freeStreamDecode(sw_ch->lz4_stream_decode);
 #endif
 	spdk_poller_unregister(&sw_ch->completion_poller);
+
+	assert(sw_ch->num_offloaded == 0);
+	spdk_ring_free(sw_ch->offload_completions);
 }
 
 static struct spdk_io_channel *
@@ -867,25 +1031,223 @@ sw_accel_get_io_channel(void)
 static size_t
 sw_accel_module_get_ctx_size(void)
 {
-	return sizeof(struct spdk_accel_task);
+	return sizeof(struct sw_accel_task);
+}
+
+static void
+sw_accel_worker_start(void *ctx)
+{
+	struct sw_accel_worker *worker = ctx;
+
+	worker->ch = spdk_get_io_channel(&g_sw_module);
+	if (worker->ch == NULL) {
+		SPDK_ERRLOG("Failed to get an io channel for worker %s\n",
+			    spdk_thread_get_name(worker->thread));
+		return;
+	}
+
+	worker->poller = SPDK_POLLER_REGISTER(sw_accel_worker_poll, worker, 0);
+	worker->running = true;
+}
+
+static void
+sw_accel_workers_free(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < g_sw_num_workers; i++) {
+		spdk_ring_free(g_sw_workers[i].ring);
+	}
+	free(g_sw_workers);
+	g_sw_workers = NULL;
+}
+
+static int
+sw_accel_workers_create(void)
+{
+	struct sw_accel_worker *worker;
+	char name[32];
+	uint32_t i;
+
+	g_sw_workers = calloc(g_sw_num_workers, sizeof(*g_sw_workers));
+	if (g_sw_workers == NULL) {
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < g_sw_num_workers; i++) {
+		worker = &g_sw_workers[i];
+		worker->ring = spdk_ring_create(SPDK_RING_TYPE_MP_SC, ACCEL_SW_WORKER_RING_SIZE,
+						SPDK_ENV_NUMA_ID_ANY);
+		if (worker->ring == NULL) {
+			SPDK_ERRLOG("Failed to create the ring of accel sw worker %u\n", i);
+			goto err;
+		}
+	}
+
+	for (i = 0; i < g_sw_num_workers; i++) {
+		worker = &g_sw_workers[i];
+		snprintf(name, sizeof(name), "accel_sw_worker_%u", i);
+		worker->thread = spdk_thread_create(name, g_sw_worker_cpumask_set ?
+						    &g_sw_worker_cpumask : NULL);
+		if (worker->thread == NULL) {
+			SPDK_ERRLOG("Failed to create accel sw worker thread %u\n", i);
+			break;
+		}
+		g_sw_num_running_workers++;
+		spdk_thread_send_msg(worker->thread, sw_accel_worker_start, worker);
+	}
+
+	if (g_sw_num_running_workers == 0) {
+		goto err;
+	}
+
+	/* Only the created workers are used */
+	for (i = g_sw_num_running_workers; i < g_sw_num_workers; i++) {
+		spdk_ring_free(g_sw_workers[i].ring);
+	}
+	g_sw_num_workers = g_sw_num_running_workers;
+
+	return 0;
+err:
+	sw_accel_workers_free();
+	return -ENOMEM;
 }
 
 static int
 sw_accel_module_init(void)
 {
+	int rc;
+
 	spdk_io_device_register(&g_sw_module, sw_accel_create_cb, sw_accel_destroy_cb,
 				sizeof(struct sw_accel_io_channel), "sw_accel_module");
 
+	if (g_sw_num_workers > 0) {
+		rc = sw_accel_workers_create();
+		if (rc != 0) {
+			spdk_io_device_unregister(&g_sw_module, NULL);
+			return rc;
+		}
+	}
+
 	return 0;
 }
 
 static void
-sw_accel_module_fini(void *ctxt)
+sw_accel_module_fini_done(void)
 {
+	sw_accel_workers_free();
 	spdk_io_device_unregister(&g_sw_module, NULL);
 	spdk_accel_module_finish();
 }
 
+static void
+sw_accel_worker_stopped(void *ctx)
+{
+	assert(g_sw_num_running_workers > 0);
+	if (--g_sw_num_running_workers == 0) {
+		sw_accel_module_fini_done();
+	}
+}
+
+static void
+sw_accel_worker_stop(void *ctx)
+{
+	struct sw_accel_worker *worker = ctx;
+
+	worker->running = false;
+	spdk_poller_unregister(&worker->poller);
+	if (worker->ch != NULL) {
+		spdk_put_io_channel(worker->ch);
+		worker->ch = NULL;
+	}
+	spdk_thread_exit(spdk_get_thread());
+
+	spdk_thread_send_msg(g_sw_fini_thread, sw_accel_worker_stopped, NULL);
+}
+
+static void
+sw_accel_module_fini(void *ctxt)
+{
+	uint32_t i;
+
+	if (g_sw_num_running_workers == 0) {
+		sw_accel_module_fini_done();
+		return;
+	}
+
+	g_sw_fini_thread = spdk_get_thread();
+	for (i = 0; i < g_sw_num_workers; i++) {
+		spdk_thread_send_msg(g_sw_workers[i].thread, sw_accel_worker_stop, &g_sw_workers[i]);
+	}
+}
+
+int
+accel_sw_set_workers(uint32_t num_workers, const char *cpumask)
+{
+	struct spdk_cpuset mask;
+
+	if (g_sw_workers != NULL) {
+		SPDK_ERRLOG("The accel sw workers are already running\n");
+		return -EBUSY;
+	}
+
+	if (cpumask != NULL) {
+		if (spdk_cpuset_parse(&mask, cpumask) != 0 || spdk_cpuset_count(&mask) == 0) {
+			SPDK_ERRLOG("Invalid cpumask %s\n", cpumask);
+			return -EINVAL;
+		}
+		spdk_cpuset_copy(&g_sw_worker_cpumask, &mask);
+		g_sw_worker_cpumask_set = true;
+	}
+
+	g_sw_num_workers = num_workers;
+
+	return 0;
+}
+
+int
+accel_sw_set_offload_threshold(enum spdk_accel_opcode opcode, uint64_t threshold)
+{
+	if (opcode >= SPDK_ACCEL_OPC_LAST || !sw_accel_supports_opcode(opcode)) {
+		return -EINVAL;
+	}
+
+	g_sw_offload_threshold[opcode] = threshold;
+
+	return 0;
+}
+
+static void
+sw_accel_write_config_json(struct spdk_json_write_ctx *w)
+{
+	int i;
+
+	if (g_sw_num_workers > 0) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "accel_sw_set_options");
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_uint32(w, "num_workers", g_sw_num_workers);
+		if (g_sw_worker_cpumask_set) {
+			spdk_json_write_named_string(w, "cpumask", spdk_cpuset_fmt(&g_sw_worker_cpumask));
+		}
+		spdk_json_write_object_end(w);
+		spdk_json_write_object_end(w);
+	}
+
+	for (i = 0; i < SPDK_ACCEL_OPC_LAST; i++) {
+		if (g_sw_offload_threshold[i] == g_sw_default_offload_threshold[i]) {
+			continue;
+		}
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "accel_sw_set_offload_threshold");
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_string(w, "opname", spdk_accel_get_opcode_name(i));
+		spdk_json_write_named_uint64(w, "threshold", g_sw_offload_threshold[i]);
+		spdk_json_write_object_end(w);
+		spdk_json_write_object_end(w);
+	}
+}
+
 static int
 sw_accel_create_aes_xts(struct spdk_accel_crypto_key *key)
 {
@@ -1008,7 +1370,7 @@ sw_accel_get_operation_info(enum spdk_accel_opcode opcode,
 static struct spdk_accel_module_if g_sw_module = {
 	.module_init			= sw_accel_module_init,
 	.module_fini			= sw_accel_module_fini,
-	.write_config_json		= NULL,
+	.write_config_json		= sw_accel_write_config_json,
 	.get_ctx_size			= sw_accel_module_get_ctx_size,
 	.name				= "software",
 	.priority			= SPDK_ACCEL_SW_PRIORITY,
@@ -50,6 +50,12 @@ int __itt_init_ittlib(const char *, __itt_group_id);
 #define SPDK_BDEV_QOS_MIN_BYTES_PER_SEC		(1024 * 1024)
 #define SPDK_BDEV_QOS_MAX_MBYTES_PER_SEC	(UINT64_MAX / (1024 * 1024))
 #define SPDK_BDEV_QOS_LIMIT_NOT_DEFINED		UINT64_MAX
+#define SPDK_BDEV_QOS_BORROWS_PER_TIMESLICE	4
+#define SPDK_BDEV_QOS_GROUP_PERIOD_IN_USEC	10000
+#define SPDK_BDEV_QOS_GROUP_SCALE_ONE		1024
+#define SPDK_BDEV_QOS_GROUP_SCALE_MIN		(SPDK_BDEV_QOS_GROUP_SCALE_ONE / 16)
+#define SPDK_BDEV_QOS_GROUP_LATENCY_MIN_IOS	100
+#define SPDK_BDEV_QOS_GROUP_MAX_WEIGHT		10000
 
 /* The maximum number of children requests for a UNMAP or WRITE ZEROES command
  * when splitting into children requests at a time.
@@ -78,6 +84,14 @@ static const char *qos_rpc_type[] = {"rw_ios_per_sec",
 				     "rw_mbytes_per_sec", "r_mbytes_per_sec", "w_mbytes_per_sec"
 				    };
 
+static const char *qos_min_rpc_type[] = {"min_rw_ios_per_sec", "min_rw_mbytes_per_sec",
+					 "min_r_mbytes_per_sec", "min_w_mbytes_per_sec"
+					};
+
+static const char *qos_stat_type[] = {"rw_ios_per_sec",
+				      "rw_bytes_per_sec", "r_bytes_per_sec", "w_bytes_per_sec"
+				     };
+
 TAILQ_HEAD(spdk_bdev_list, spdk_bdev);
 
 RB_HEAD(bdev_name_tree, spdk_bdev_name);
@@ -164,6 +178,11 @@ struct spdk_bdev_qos_limit {
 	/** IOs or bytes allowed per second (i.e., 1s). */
 	uint64_t limit;
 
+	/** IOs or bytes per second assigned by the QoS group the bdev belongs to, 0 if none.
+	 *  The lower of this and limit is enforced.
+	 */
+	uint64_t group_limit;
+
 	/** Remaining IOs or bytes allowed in current timeslice (e.g., 1ms).
 	 *  For remaining bytes, allowed to run negative if an I/O is submitted when
 	 *  some bytes are remaining, but the I/O is bigger than that amount. The
@@ -177,15 +196,29 @@ struct spdk_bdev_qos_limit {
 	/** Maximum allowed IOs or bytes to be issued in one timeslice (e.g., 1ms). */
 	uint32_t max_per_timeslice;
 
+	/** IOs or bytes a channel takes from remaining_this_timeslice at once.
+	 *  Depends on the number of channels, so that the quota taken but not used
+	 *  by the channels stays a small fraction of max_per_timeslice.
+	 */
+	uint32_t borrow_size;
+
+	/** Quota added to remaining_this_timeslice when it was last replenished. */
+	int64_t granted;
+
+	/** Total IOs or bytes taken from the quota, used by QoS groups to estimate demand. */
+	uint64_t taken;
+
 	/** Function to check whether to queue the IO.
-	 * If The IO is allowed to pass, the quota will be reduced correspondingly.
+	 * If The IO is allowed to pass, the channel's quota will be reduced correspondingly.
 	 */
-	bool (*queue_io)(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io);
+	bool (*queue_io)(struct spdk_bdev_qos_limit *limit, int64_t *quota,
+			 struct spdk_bdev_io *io);
 
 	/** Function to rewind the quota once the IO was allowed to be sent by this
 	 * limit but queued due to one of the further limits.
 	 */
-	void (*rewind_quota)(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io);
+	void (*rewind_quota)(struct spdk_bdev_qos_limit *limit, int64_t *quota,
+			     struct spdk_bdev_io *io);
 };
 
 struct spdk_bdev_qos {
@@ -204,6 +237,29 @@ struct spdk_bdev_qos {
 	/** Timestamp of start of last timeslice. */
 	uint64_t last_timeslice;
 
+	/** Incremented each time the quota is replenished. The channels give back the
+	 *  quota they took in earlier timeslices when they see it change.
+	 */
+	uint64_t timeslice_id;
+
+	/** Number of channels with QoS enabled. */
+	uint32_t num_channels;
+
+	/** Set when a channel has queued I/O, so the poller has to resubmit it. */
+	bool io_queued;
+
+	/** Number of timeslices in which I/O had to be queued. */
+	uint64_t throttled;
+
+	/** I/O latency target of the bdev's QoS group in ticks, 0 if none. */
+	uint64_t latency_target_ticks;
+
+	/** Number of I/Os completed and those exceeding latency_target_ticks. Only I/Os
+	 *  which weren't queued by QoS are counted and only if latency_target_ticks is set.
+	 */
+	uint64_t ios_completed;
+	uint64_t ios_over_target;
+
 	/** Poller that processes queued I/O commands each time slice. */
 	struct spdk_poller *poller;
 };
@@ -329,6 +385,19 @@ struct spdk_bdev_channel {
 
 	/** List of I/Os queued by QoS. */
 	bdev_io_tailq_t		qos_queued_io;
+
+	/**
+	 * IOs or bytes taken from the QoS rate limits' quota and not used yet. It allows
+	 * the I/O to be accounted on the channel without touching the shared counters.
+	 */
+	int64_t			qos_quota[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+
+	/** QoS timeslice the quota was taken in. */
+	uint64_t		qos_timeslice_id;
+
+	/** I/O completions not yet added to the QoS latency statistics. */
+	uint32_t		qos_ios_completed;
+	uint32_t		qos_ios_over_target;
 };
 
 struct media_event_entry {
@@ -414,6 +483,8 @@ static void bdev_write_zero_buffer(void *bdev_io);
 static void bdev_enable_qos_msg(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
 				struct spdk_io_channel *ch, void *_ctx);
 static void bdev_enable_qos_done(struct spdk_bdev *bdev, void *_ctx, int status);
+static void bdev_qos_groups_config_json(struct spdk_json_write_ctx *w);
+static void bdev_qos_group_members_config_json(struct spdk_json_write_ctx *w);
 
 static int bdev_readv_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 				     struct iovec *iov, int iovcnt, void *md_buf, uint64_t offset_blocks,
@@ -2099,6 +2170,16 @@ bdev_qos_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
 	}
 
 	spdk_bdev_get_qos_rate_limits(bdev, limits);
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (limits[i] > 0) {
+			break;
+		}
+	}
+
+	if (i == SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES) {
+		/* Only limited by its QoS group */
+		return;
+	}
 
 	spdk_json_write_object_begin(w);
 	spdk_json_write_named_string(w, "method", "bdev_set_qos_limit");
@@ -2137,6 +2218,7 @@ spdk_bdev_subsystem_config_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_object_end(w);
 
 	bdev_examine_allowlist_config_json(w);
+	bdev_qos_groups_config_json(w);
 
 	TAILQ_FOREACH(bdev_module, &g_bdev_mgr.bdev_modules, internal.tailq) {
 		if (bdev_module->config_json) {
@@ -2157,11 +2239,15 @@ spdk_bdev_subsystem_config_json(struct spdk_json_write_ctx *w)
 
 	spdk_spin_unlock(&g_bdev_mgr.spinlock);
 
-	/* This has to be last RPC in array to make sure all bdevs finished examine */
+	/* This has to be the last RPC in array to make sure all bdevs finished examine. Only
+	 * the QoS groups' bdevs follow, as they may be created by examine (e.g. lvols).
+	 */
 	spdk_json_write_object_begin(w);
 	spdk_json_write_named_string(w, "method", "bdev_wait_for_examine");
 	spdk_json_write_object_end(w);
 
+	bdev_qos_group_members_config_json(w);
+
 	spdk_json_write_array_end(w);
 }
 
@@ -2660,12 +2746,15 @@ bdev_finish_wait_for_examine_done(void *cb_arg)
 }
 
 static void bdev_open_async_fini(void);
+static void bdev_qos_groups_fini(void);
 
 static void
 bdev_finish_wait_for_examine(void *not_used)
 {
 	int rc;
 
+	bdev_qos_groups_fini();
+
 	rc = spdk_bdev_wait_for_examine(bdev_finish_wait_for_examine_done, NULL);
 	if (rc != 0) {
 		SPDK_ERRLOG("wait_for_examine failed: %s\n", spdk_strerror(-rc));
@@ -2840,24 +2929,37 @@ bdev_get_io_size_in_byte(struct spdk_bdev_io *bdev_io)
 }
 
 static inline bool
-bdev_qos_rw_queue_io(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io, uint64_t delta)
+bdev_qos_rw_queue_io(struct spdk_bdev_qos_limit *limit, int64_t *quota, struct spdk_bdev_io *io,
+		     uint64_t delta)
 {
-	int64_t remaining_this_timeslice;
+	int64_t remaining_this_timeslice, borrow;
 
 	if (!limit->max_per_timeslice) {
 		/* The QoS is disabled */
 		return false;
 	}
 
-	remaining_this_timeslice = __atomic_sub_fetch(&limit->remaining_this_timeslice, delta,
+	if (spdk_likely(*quota >= (int64_t)delta)) {
+		/* The channel still has enough quota for this delta */
+		*quota -= delta;
+		return false;
+	}
+
+	/* Take a batch of quota from the limit shared by all channels, so that most IOs can be
+	 * accounted without touching it.
+	 */
+	borrow = spdk_max((int64_t)__atomic_load_n(&limit->borrow_size, __ATOMIC_RELAXED),
+			  (int64_t)delta - *quota);
+	remaining_this_timeslice = __atomic_sub_fetch(&limit->remaining_this_timeslice, borrow,
 				   __ATOMIC_RELAXED);
-	if (remaining_this_timeslice + (int64_t)delta > 0) {
-		/* There was still a quota for this delta -> the IO shouldn't be queued
+	if (remaining_this_timeslice + borrow > 0) {
+		/* There was still a quota -> the IO shouldn't be queued
 		 *
 		 * We allow a slight quota overrun here so an IO bigger than the per-timeslice
 		 * quota can be allowed once a while. Such overrun then taken into account in
 		 * the QoS poller, where the next timeslice quota is calculated.
 		 */
+		*quota += borrow - delta;
 		return false;
 	}
 
@@ -2866,74 +2968,93 @@ bdev_qos_rw_queue_io(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io,
 	 * amount of IOs or bytes allowed.
 	 */
 	__atomic_add_fetch(
-		&limit->remaining_this_timeslice, delta, __ATOMIC_RELAXED);
+		&limit->remaining_this_timeslice, borrow, __ATOMIC_RELAXED);
 	return true;
 }
 
 static inline void
-bdev_qos_rw_rewind_io(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io, uint64_t delta)
+bdev_qos_rw_rewind_io(struct spdk_bdev_qos_limit *limit, int64_t *quota, struct spdk_bdev_io *io,
+		      uint64_t delta)
 {
-	__atomic_add_fetch(&limit->remaining_this_timeslice, delta, __ATOMIC_RELAXED);
+	*quota += delta;
 }
 
 static bool
-bdev_qos_rw_iops_queue(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io)
+bdev_qos_rw_iops_queue(struct spdk_bdev_qos_limit *limit, int64_t *quota, struct spdk_bdev_io *io)
 {
-	return bdev_qos_rw_queue_io(limit, io, 1);
+	return bdev_qos_rw_queue_io(limit, quota, io, 1);
 }
 
 static void
-bdev_qos_rw_iops_rewind_quota(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io)
+bdev_qos_rw_iops_rewind_quota(struct spdk_bdev_qos_limit *limit, int64_t *quota,
+			      struct spdk_bdev_io *io)
 {
-	bdev_qos_rw_rewind_io(limit, io, 1);
+	bdev_qos_rw_rewind_io(limit, quota, io, 1);
 }
 
 static bool
-bdev_qos_rw_bps_queue(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io)
+bdev_qos_rw_bps_queue(struct spdk_bdev_qos_limit *limit, int64_t *quota, struct spdk_bdev_io *io)
 {
-	return bdev_qos_rw_queue_io(limit, io, bdev_get_io_size_in_byte(io));
+	return bdev_qos_rw_queue_io(limit, quota, io, bdev_get_io_size_in_byte(io));
 }
 
 static void
-bdev_qos_rw_bps_rewind_quota(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io)
+bdev_qos_rw_bps_rewind_quota(struct spdk_bdev_qos_limit *limit, int64_t *quota,
+			     struct spdk_bdev_io *io)
 {
-	bdev_qos_rw_rewind_io(limit, io, bdev_get_io_size_in_byte(io));
+	bdev_qos_rw_rewind_io(limit, quota, io, bdev_get_io_size_in_byte(io));
 }
 
 static bool
-bdev_qos_r_bps_queue(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io)
+bdev_qos_r_bps_queue(struct spdk_bdev_qos_limit *limit, int64_t *quota, struct spdk_bdev_io *io)
 {
 	if (bdev_is_read_io(io) == false) {
 		return false;
 	}
 
-	return bdev_qos_rw_bps_queue(limit, io);
+	return bdev_qos_rw_bps_queue(limit, quota, io);
 }
 
 static void
-bdev_qos_r_bps_rewind_quota(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io)
+bdev_qos_r_bps_rewind_quota(struct spdk_bdev_qos_limit *limit, int64_t *quota,
+			    struct spdk_bdev_io *io)
 {
 	if (bdev_is_read_io(io) != false) {
-		bdev_qos_rw_rewind_io(limit, io, bdev_get_io_size_in_byte(io));
+		bdev_qos_rw_rewind_io(limit, quota, io, bdev_get_io_size_in_byte(io));
 	}
 }
 
 static bool
-bdev_qos_w_bps_queue(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io)
+bdev_qos_w_bps_queue(struct spdk_bdev_qos_limit *limit, int64_t *quota, struct spdk_bdev_io *io)
 {
 	if (bdev_is_read_io(io) == true) {
 		return false;
 	}
 
-	return bdev_qos_rw_bps_queue(limit, io);
+	return bdev_qos_rw_bps_queue(limit, quota, io);
 }
 
 static void
-bdev_qos_w_bps_rewind_quota(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_io *io)
+bdev_qos_w_bps_rewind_quota(struct spdk_bdev_qos_limit *limit, int64_t *quota,
+			    struct spdk_bdev_io *io)
 {
 	if (bdev_is_read_io(io) != true) {
-		bdev_qos_rw_rewind_io(limit, io, bdev_get_io_size_in_byte(io));
+		bdev_qos_rw_rewind_io(limit, quota, io, bdev_get_io_size_in_byte(io));
+	}
+}
+
+static uint64_t
+bdev_qos_limit_get_effective(const struct spdk_bdev_qos_limit *limit)
+{
+	if (limit->group_limit == 0) {
+		return limit->limit;
+	}
+
+	if (limit->limit == 0 || limit->limit == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+		return limit->group_limit;
 	}
+
+	return spdk_min(limit->limit, limit->group_limit);
 }
 
 static void
@@ -2942,7 +3063,8 @@ bdev_qos_set_ops(struct spdk_bdev_qos *qos)
 	int i;
 
 	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
-		if (qos->rate_limits[i].limit == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+		if (bdev_qos_limit_get_effective(&qos->rate_limits[i]) ==
+		    SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
 			qos->rate_limits[i].queue_io = NULL;
 			continue;
 		}
@@ -3024,25 +3146,67 @@ bdev_io_do_submit(struct spdk_bdev_channel *bdev_ch, struct spdk_bdev_io *bdev_i
 	}
 }
 
+static void
+bdev_qos_return_quota(struct spdk_bdev_qos *qos, struct spdk_bdev_channel *ch)
+{
+	struct spdk_bdev_qos_limit *limit;
+	int64_t quota;
+	int i;
+
+	/* The quota a channel took but didn't use was accounted as used when the timeslice
+	 * ended, so it's added to the current one for the other channels to use it. It's
+	 * bounded by the borrow size, in case the limits were lowered in between.
+	 */
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		limit = &qos->rate_limits[i];
+		quota = spdk_min(ch->qos_quota[i],
+				 (int64_t)__atomic_load_n(&limit->borrow_size, __ATOMIC_RELAXED));
+		if (quota > 0 && limit->max_per_timeslice) {
+			__atomic_add_fetch(&limit->remaining_this_timeslice, quota,
+					   __ATOMIC_RELAXED);
+		}
+		ch->qos_quota[i] = 0;
+	}
+}
+
 static bool
 bdev_qos_queue_io(struct spdk_bdev_qos *qos, struct spdk_bdev_io *bdev_io)
 {
+	struct spdk_bdev_channel *ch = bdev_io->internal.ch;
+	uint64_t timeslice_id;
 	int i;
 
 	if (bdev_qos_io_to_limit(bdev_io) == true) {
+		timeslice_id = __atomic_load_n(&qos->timeslice_id, __ATOMIC_ACQUIRE);
+		if (spdk_unlikely(ch->qos_timeslice_id != timeslice_id)) {
+			/* The quota was replenished, return what's left from the earlier timeslice */
+			bdev_qos_return_quota(qos, ch);
+			ch->qos_timeslice_id = timeslice_id;
+
+			if (ch->qos_ios_completed != 0) {
+				__atomic_add_fetch(&qos->ios_completed, ch->qos_ios_completed,
+						   __ATOMIC_RELAXED);
+				__atomic_add_fetch(&qos->ios_over_target, ch->qos_ios_over_target,
+						   __ATOMIC_RELAXED);
+				ch->qos_ios_completed = 0;
+				ch->qos_ios_over_target = 0;
+			}
+		}
+
 		for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
 			if (!qos->rate_limits[i].queue_io) {
 				continue;
 			}
 
-			if (qos->rate_limits[i].queue_io(&qos->rate_limits[i],
+			if (qos->rate_limits[i].queue_io(&qos->rate_limits[i], &ch->qos_quota[i],
 							 bdev_io) == true) {
 				for (i -= 1; i >= 0 ; i--) {
 					if (!qos->rate_limits[i].queue_io) {
 						continue;
 					}
 
-					qos->rate_limits[i].rewind_quota(&qos->rate_limits[i], bdev_io);
+					qos->rate_limits[i].rewind_quota(&qos->rate_limits[i], &ch->qos_quota[i],
+									 bdev_io);
 				}
 				return true;
 			}
@@ -3064,6 +3228,8 @@ bdev_qos_io_submit(struct spdk_bdev_channel *ch, struct spdk_bdev_qos *qos)
 			bdev_io_do_submit(ch, bdev_io);
 
 			submitted_ios++;
+		} else {
+			bdev_io->internal.f.qos_queued = true;
 		}
 	}
 
@@ -3759,8 +3925,13 @@ _bdev_io_submit(struct spdk_bdev_io *bdev_io)
 		    bdev_abort_queued_io(&bdev_ch->qos_queued_io, bdev_io->u.abort.bio_to_abort)) {
 			_bdev_io_complete_in_submit(bdev_ch, bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
 		} else {
+			struct spdk_bdev_qos *qos = bdev->internal.qos;
+
 			TAILQ_INSERT_TAIL(&bdev_ch->qos_queued_io, bdev_io, internal.link);
-			bdev_qos_io_submit(bdev_ch, bdev->internal.qos);
+			bdev_qos_io_submit(bdev_ch, qos);
+			if (!TAILQ_EMPTY(&bdev_ch->qos_queued_io)) {
+				__atomic_store_n(&qos->io_queued, true, __ATOMIC_RELEASE);
+			}
 		}
 	} else {
 		SPDK_ERRLOG("unknown bdev_ch flag %x found\n", bdev_ch->flags);
@@ -4199,29 +4370,47 @@ spdk_bdev_dump_info_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
 	return 0;
 }
 
+static void
+bdev_qos_update_borrow_size(struct spdk_bdev_qos *qos)
+{
+	uint32_t borrows, borrow_size;
+	int i;
+
+	borrows = spdk_max(qos->num_channels, 1) * SPDK_BDEV_QOS_BORROWS_PER_TIMESLICE;
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		borrow_size = spdk_max(qos->rate_limits[i].max_per_timeslice / borrows, 1);
+		__atomic_store_n(&qos->rate_limits[i].borrow_size, borrow_size, __ATOMIC_RELAXED);
+	}
+}
+
 static void
 bdev_qos_update_max_quota_per_timeslice(struct spdk_bdev_qos *qos)
 {
 	uint32_t max_per_timeslice = 0;
+	uint64_t limit;
 	int i;
 
 	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
-		if (qos->rate_limits[i].limit == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+		limit = bdev_qos_limit_get_effective(&qos->rate_limits[i]);
+		if (limit == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
 			qos->rate_limits[i].max_per_timeslice = 0;
 			continue;
 		}
 
-		max_per_timeslice = qos->rate_limits[i].limit *
-				    SPDK_BDEV_QOS_TIMESLICE_IN_USEC / SPDK_SEC_TO_USEC;
+		max_per_timeslice = limit * SPDK_BDEV_QOS_TIMESLICE_IN_USEC / SPDK_SEC_TO_USEC;
 
 		qos->rate_limits[i].max_per_timeslice = spdk_max(max_per_timeslice,
 							qos->rate_limits[i].min_per_timeslice);
 
+		qos->rate_limits[i].granted = qos->rate_limits[i].max_per_timeslice;
 		__atomic_store_n(&qos->rate_limits[i].remaining_this_timeslice,
 				 qos->rate_limits[i].max_per_timeslice, __ATOMIC_RELEASE);
 	}
 
+	bdev_qos_update_borrow_size(qos);
 	bdev_qos_set_ops(qos);
+	/* Make the channels give back the quota taken under the previous limits */
+	__atomic_add_fetch(&qos->timeslice_id, 1, __ATOMIC_RELEASE);
 }
 
 static void
@@ -4236,6 +4425,10 @@ bdev_channel_submit_qos_io(struct spdk_bdev_channel_iter *i, struct spdk_bdev *b
 	/* if all IOs were sent then continue the iteration, otherwise - stop it */
 	/* TODO: channels round robing */
 	status = TAILQ_EMPTY(&bdev_ch->qos_queued_io) ? 0 : 1;
+	if (status != 0) {
+		/* Retry in the next timeslice */
+		__atomic_store_n(&bdev->internal.qos->io_queued, true, __ATOMIC_RELEASE);
+	}
 
 	spdk_bdev_for_each_channel_continue(i, status);
 }
@@ -4279,6 +4472,12 @@ bdev_channel_poll_qos(void *arg)
 		 */
 		remaining_last_timeslice = __atomic_exchange_n(&qos->rate_limits[i].remaining_this_timeslice,
 					   0, __ATOMIC_RELAXED);
+		if (qos->rate_limits[i].granted > remaining_last_timeslice) {
+			__atomic_store_n(&qos->rate_limits[i].taken, qos->rate_limits[i].taken +
+					 qos->rate_limits[i].granted - remaining_last_timeslice,
+					 __ATOMIC_RELAXED);
+		}
+		qos->rate_limits[i].granted = spdk_min(remaining_last_timeslice, 0);
 		if (remaining_last_timeslice < 0) {
 			/* There could be a race condition here as both bdev_qos_rw_queue_io() and bdev_channel_poll_qos()
 			 * potentially use 2 atomic ops each, so they can intertwine.
@@ -4294,9 +4493,22 @@ bdev_channel_poll_qos(void *arg)
 		for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
 			__atomic_add_fetch(&qos->rate_limits[i].remaining_this_timeslice,
 					   qos->rate_limits[i].max_per_timeslice, __ATOMIC_RELAXED);
+			qos->rate_limits[i].granted += qos->rate_limits[i].max_per_timeslice;
 		}
 	}
 
+	/* Make the channels give back the quota they still hold, so it isn't lost */
+	__atomic_add_fetch(&qos->timeslice_id, 1, __ATOMIC_RELEASE);
+
+	/* I/O is submitted on the channels' threads, only those queued due to lack of quota
+	 * need to be resubmitted here.
+	 */
+	if (!__atomic_exchange_n(&qos->io_queued, false, __ATOMIC_ACQ_REL)) {
+		return SPDK_POLLER_BUSY;
+	}
+
+	__atomic_store_n(&qos->throttled, qos->throttled + 1, __ATOMIC_RELAXED);
+
 	spdk_bdev_for_each_channel(bdev, bdev_channel_submit_qos_io, qos,
 				   bdev_channel_submit_qos_io_done);
 
@@ -4388,7 +4600,12 @@ bdev_enable_qos(struct spdk_bdev *bdev, struct spdk_bdev_channel *ch)
 							   SPDK_BDEV_QOS_TIMESLICE_IN_USEC);
 		}
 
-		ch->flags |= BDEV_CH_QOS_ENABLED;
+		if (!(ch->flags & BDEV_CH_QOS_ENABLED)) {
+			ch->flags |= BDEV_CH_QOS_ENABLED;
+			memset(ch->qos_quota, 0, sizeof(ch->qos_quota));
+			qos->num_channels++;
+			bdev_qos_update_borrow_size(qos);
+		}
 	}
 }
 
@@ -4649,6 +4866,8 @@ bdev_channel_create(void *io_device, void *ctx_buf)
 
 	spdk_spin_unlock(&bdev->internal.spinlock);
 
+	spdk_thread_get_numa_ref(spdk_bdev_get_numa_id(bdev));
+
 	return 0;
 }
 
@@ -5055,6 +5274,11 @@ bdev_channel_destroy(void *io_device, void *ctx_buf)
 	/* This channel is going away, so add its statistics into the bdev so that they don't get lost. */
 	spdk_spin_lock(&ch->bdev->internal.spinlock);
 	spdk_bdev_add_io_stat(ch->bdev->internal.stat, ch->stat);
+	if ((ch->flags & BDEV_CH_QOS_ENABLED) && ch->bdev->internal.qos != NULL) {
+		assert(ch->bdev->internal.qos->num_channels > 0);
+		ch->bdev->internal.qos->num_channels--;
+		bdev_qos_update_borrow_size(ch->bdev->internal.qos);
+	}
 	spdk_spin_unlock(&ch->bdev->internal.spinlock);
 
 	bdev_channel_abort_queued_ios(ch);
@@ -5063,6 +5287,8 @@ bdev_channel_destroy(void *io_device, void *ctx_buf)
 		spdk_histogram_data_free(ch->histogram);
 	}
 
+	spdk_thread_put_numa_ref(spdk_bdev_get_numa_id(ch->bdev));
+
 	bdev_channel_destroy_resource(ch);
 }
 
@@ -7925,6 +8151,24 @@ _bdev_io_complete(void *ctx)
 			     bdev_io->internal.caller_ctx);
 }
 
+static void
+bdev_qos_io_complete(struct spdk_bdev_channel *bdev_ch, struct spdk_bdev_io *bdev_io,
+		     uint64_t tsc_diff)
+{
+	struct spdk_bdev_qos *qos = bdev_io->bdev->internal.qos;
+
+	if (qos == NULL || qos->latency_target_ticks == 0 || bdev_io->internal.f.qos_queued ||
+	    !bdev_qos_io_to_limit(bdev_io)) {
+		/* Time spent in the QoS queue doesn't tell anything about the device's latency */
+		return;
+	}
+
+	bdev_ch->qos_ios_completed++;
+	if (tsc_diff > qos->latency_target_ticks) {
+		bdev_ch->qos_ios_over_target++;
+	}
+}
+
 static inline void
 bdev_io_complete(void *ctx)
 {
@@ -7959,6 +8203,10 @@ bdev_io_complete(void *ctx)
 		}
 	}
 
+	if (spdk_unlikely(bdev_ch->flags & BDEV_CH_QOS_ENABLED)) {
+		bdev_qos_io_complete(bdev_ch, bdev_io, tsc_diff);
+	}
+
 	bdev_io_update_io_stat(bdev_io, tsc_diff);
 	_bdev_io_complete(bdev_io);
 }
@@ -10234,23 +10482,49 @@ bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits)
 	}
 }
 
-void
-spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
-			      void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
+static void
+bdev_set_qos_group_limits(struct spdk_bdev *bdev, const uint64_t *group_limits)
 {
-	struct set_qos_limit_ctx	*ctx;
-	uint32_t			limit_set_complement;
-	uint64_t			min_limit_per_sec;
-	int				i;
-	bool				disable_rate_limit = true;
+	int i;
+
+	assert(bdev->internal.qos != NULL);
 
 	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
-		if (limits[i] == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
-			continue;
+		bdev->internal.qos->rate_limits[i].group_limit = group_limits[i];
+	}
+}
+
+static bool
+bdev_qos_has_group_limits(struct spdk_bdev_qos *qos, const uint64_t *group_limits)
+{
+	int i;
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (group_limits != NULL) {
+			if (group_limits[i] != 0) {
+				return true;
+			}
+		} else if (qos != NULL && qos->rate_limits[i].group_limit != 0) {
+			return true;
 		}
+	}
 
-		if (limits[i] > 0) {
-			disable_rate_limit = false;
+	return false;
+}
+
+/* Converts the limits from the units used by the RPCs (i.e. megabytes per second for the
+ * bandwidth limits) to IOs or bytes per second.
+ */
+static void
+bdev_qos_convert_rate_limits(uint64_t *limits)
+{
+	uint32_t	limit_set_complement;
+	uint64_t	min_limit_per_sec;
+	int		i;
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (limits[i] == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+			continue;
 		}
 
 		if (bdev_qos_is_iops_rate_limit(i) == true) {
@@ -10274,6 +10548,24 @@ spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 			SPDK_ERRLOG("Round up the rate limit to %" PRIu64 "\n", limits[i]);
 		}
 	}
+}
+
+/* Sets the user's rate limits, ignoring the NOT_DEFINED ones, and, if group_limits isn't
+ * NULL, the limits assigned by the bdev's QoS group.
+ */
+static void
+bdev_set_qos_limits(struct spdk_bdev *bdev, uint64_t *limits, const uint64_t *group_limits,
+		    void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
+{
+	struct set_qos_limit_ctx	*ctx;
+	int				i;
+	bool				disable_rate_limit = true;
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (limits[i] != SPDK_BDEV_QOS_LIMIT_NOT_DEFINED && limits[i] > 0) {
+			disable_rate_limit = false;
+		}
+	}
 
 	ctx = calloc(1, sizeof(*ctx));
 	if (ctx == NULL) {
@@ -10310,6 +10602,11 @@ spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 		}
 	}
 
+	if (disable_rate_limit == true &&
+	    bdev_qos_has_group_limits(bdev->internal.qos, group_limits)) {
+		disable_rate_limit = false;
+	}
+
 	if (disable_rate_limit == false) {
 		if (bdev->internal.qos == NULL) {
 			bdev->internal.qos = calloc(1, sizeof(*bdev->internal.qos));
@@ -10321,6 +10618,10 @@ spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 			}
 		}
 
+		if (group_limits != NULL) {
+			bdev_set_qos_group_limits(bdev, group_limits);
+		}
+
 		if (bdev->internal.qos->thread == NULL) {
 			/* Enabling */
 			bdev_set_qos_rate_limits(bdev, limits);
@@ -10337,6 +10638,9 @@ spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 	} else {
 		if (bdev->internal.qos != NULL) {
 			bdev_set_qos_rate_limits(bdev, limits);
+			if (group_limits != NULL) {
+				bdev_set_qos_group_limits(bdev, group_limits);
+			}
 
 			/* Disabling */
 			spdk_bdev_for_each_channel(bdev, bdev_disable_qos_msg, ctx,
@@ -10351,6 +10655,867 @@ spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 	spdk_spin_unlock(&bdev->internal.spinlock);
 }
 
+void
+spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
+			      void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
+{
+	bdev_qos_convert_rate_limits(limits);
+	bdev_set_qos_limits(bdev, limits, NULL, cb_fn, cb_arg);
+}
+
+struct bdev_qos_group;
+
+struct bdev_qos_group_member {
+	struct bdev_qos_group		*group;
+	struct spdk_bdev_desc		*desc;
+	uint32_t			weight;
+
+	/** Guaranteed IOs or bytes per second, 0 if none. */
+	uint64_t			min_limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+
+	/** IOs or bytes per second currently assigned to the bdev. */
+	uint64_t			limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+
+	/** IOs or bytes per second the bdev is expected to use in the next period. */
+	uint64_t			demand[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+
+	/** IOs or bytes per second taken in the last period. */
+	uint64_t			usage[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+
+	/** Values of the bdev's QoS counters in the last period. */
+	uint64_t			last_taken[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+	uint64_t			last_throttled;
+	uint64_t			last_ios_completed;
+	uint64_t			last_ios_over_target;
+
+	/** Number of periods in which the bdev's I/O had to be queued. */
+	uint64_t			throttled_periods;
+
+	bool				throttled;
+	bool				active;
+	bool				hot_removed;
+
+	/** Callback of the pending add or remove operation. */
+	void				(*cb_fn)(void *cb_arg, int status);
+	void				*cb_arg;
+
+	TAILQ_ENTRY(bdev_qos_group_member) link;
+};
+
+struct bdev_qos_group {
+	char				*name;
+
+	/** IOs or bytes per second shared by the members, 0 if not limited. */
+	uint64_t			limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+
+	uint64_t			latency_target_us;
+
+	/** Fraction of the limits handed out to the members, in SPDK_BDEV_QOS_GROUP_SCALE_ONE
+	 *  units. Lowered when the members' I/O latency exceeds latency_target_us.
+	 */
+	uint32_t			scale;
+
+	/** Latency samples collected since the scale was last adjusted. */
+	uint64_t			ios_completed;
+	uint64_t			ios_over_target;
+
+	struct spdk_poller		*poller;
+	TAILQ_HEAD(, bdev_qos_group_member) members;
+	TAILQ_ENTRY(bdev_qos_group)	link;
+};
+
+static TAILQ_HEAD(, bdev_qos_group) g_bdev_qos_groups = TAILQ_HEAD_INITIALIZER(g_bdev_qos_groups);
+
+static struct bdev_qos_group *
+bdev_qos_group_get_by_name(const char *name)
+{
+	struct bdev_qos_group *group;
+
+	TAILQ_FOREACH(group, &g_bdev_qos_groups, link) {
+		if (strcmp(group->name, name) == 0) {
+			return group;
+		}
+	}
+
+	return NULL;
+}
+
+static struct bdev_qos_group_member *
+bdev_qos_group_get_member(struct bdev_qos_group *group, struct spdk_bdev *bdev)
+{
+	struct bdev_qos_group_member *member;
+
+	TAILQ_FOREACH(member, &group->members, link) {
+		if (spdk_bdev_desc_get_bdev(member->desc) == bdev) {
+			return member;
+		}
+	}
+
+	return NULL;
+}
+
+static const char *
+bdev_qos_group_member_name(struct bdev_qos_group_member *member)
+{
+	return spdk_bdev_get_name(spdk_bdev_desc_get_bdev(member->desc));
+}
+
+static uint64_t
+bdev_qos_group_get_capacity(struct bdev_qos_group *group, int type)
+{
+	return group->limits[type] * group->scale / SPDK_BDEV_QOS_GROUP_SCALE_ONE;
+}
+
+static void
+bdev_qos_group_sample(struct bdev_qos_group *group, struct bdev_qos_group_member *member)
+{
+	struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(member->desc);
+	struct spdk_bdev_qos *qos;
+	uint64_t taken, throttled, ios_completed, ios_over_target;
+	int i;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	qos = bdev->internal.qos;
+	member->active = qos != NULL && !bdev->internal.qos_mod_in_progress;
+	if (!member->active) {
+		spdk_spin_unlock(&bdev->internal.spinlock);
+		return;
+	}
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		taken = __atomic_load_n(&qos->rate_limits[i].taken, __ATOMIC_RELAXED);
+		member->usage[i] = (taken - member->last_taken[i]) * SPDK_SEC_TO_USEC /
+				   SPDK_BDEV_QOS_GROUP_PERIOD_IN_USEC;
+		member->last_taken[i] = taken;
+	}
+
+	throttled = __atomic_load_n(&qos->throttled, __ATOMIC_RELAXED);
+	member->throttled = throttled != member->last_throttled;
+	member->last_throttled = throttled;
+	if (member->throttled) {
+		member->throttled_periods++;
+	}
+
+	ios_completed = __atomic_load_n(&qos->ios_completed, __ATOMIC_RELAXED);
+	ios_over_target = __atomic_load_n(&qos->ios_over_target, __ATOMIC_RELAXED);
+	group->ios_completed += ios_completed - member->last_ios_completed;
+	group->ios_over_target += ios_over_target - member->last_ios_over_target;
+	member->last_ios_completed = ios_completed;
+	member->last_ios_over_target = ios_over_target;
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (group->limits[i] == 0) {
+			continue;
+		}
+
+		/* A bdev which was throttled wants as much as it can get. Otherwise, leave it
+		 * enough room to double its usage, or ramp up if it's been idle.
+		 */
+		if (member->throttled) {
+			member->demand[i] = UINT64_MAX;
+		} else {
+			member->demand[i] = spdk_max(member->usage[i] * 2, member->min_limits[i]);
+		}
+
+		/* There's no point in assigning more than the user's own limit of the bdev */
+		if (qos->rate_limits[i].limit != 0 &&
+		    qos->rate_limits[i].limit != SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+			member->demand[i] = spdk_min(member->demand[i], qos->rate_limits[i].limit);
+		}
+	}
+	spdk_spin_unlock(&bdev->internal.spinlock);
+}
+
+/* Lowers the group's capacity when the latency target is missed by more than 1% of the I/Os
+ * and raises it back when it's met and some bdevs ask for more.
+ */
+static void
+bdev_qos_group_update_scale(struct bdev_qos_group *group, bool throttled)
+{
+	if (group->latency_target_us == 0) {
+		return;
+	}
+
+	if (group->ios_completed >= SPDK_BDEV_QOS_GROUP_LATENCY_MIN_IOS) {
+		if (group->ios_over_target * 100 > group->ios_completed) {
+			group->scale = spdk_max(group->scale * 7 / 8,
+						SPDK_BDEV_QOS_GROUP_SCALE_MIN);
+			group->ios_completed = 0;
+			group->ios_over_target = 0;
+			return;
+		}
+
+		group->ios_completed = 0;
+		group->ios_over_target = 0;
+	}
+
+	if (throttled) {
+		group->scale = spdk_min(group->scale + SPDK_BDEV_QOS_GROUP_SCALE_ONE / 32,
+					SPDK_BDEV_QOS_GROUP_SCALE_ONE);
+	}
+}
+
+/* Weighted max-min fair share of a limit: each bdev gets its guaranteed minimum, then the rest
+ * is split by weight among the bdevs which want more. The share left over by those which don't
+ * need it is redistributed to the others, and what nobody needs is split by weight to allow
+ * the usage to grow.
+ */
+static void
+bdev_qos_group_share(struct bdev_qos_group *group, int type)
+{
+	struct bdev_qos_group_member *member;
+	uint64_t capacity, remaining, min_total = 0, weights, share, given;
+	bool satisfied;
+
+	capacity = bdev_qos_group_get_capacity(group, type);
+
+	TAILQ_FOREACH(member, &group->members, link) {
+		min_total += member->min_limits[type];
+	}
+
+	remaining = capacity;
+	TAILQ_FOREACH(member, &group->members, link) {
+		if (min_total > capacity) {
+			member->limits[type] = member->min_limits[type] * capacity / min_total;
+		} else {
+			member->limits[type] = member->min_limits[type];
+		}
+		remaining -= member->limits[type];
+	}
+
+	do {
+		weights = 0;
+		TAILQ_FOREACH(member, &group->members, link) {
+			if (member->limits[type] < member->demand[type]) {
+				weights += member->weight;
+			}
+		}
+
+		if (weights == 0) {
+			break;
+		}
+
+		/* Give each bdev its share, stopping at its demand. If any bdev stopped, the
+		 * share it didn't take is split among the others in the next round.
+		 */
+		satisfied = false;
+		given = 0;
+		TAILQ_FOREACH(member, &group->members, link) {
+			if (member->limits[type] >= member->demand[type]) {
+				continue;
+			}
+
+			share = remaining * member->weight / weights;
+			if (share >= member->demand[type] - member->limits[type]) {
+				share = member->demand[type] - member->limits[type];
+				satisfied = true;
+			}
+
+			member->limits[type] += share;
+			given += share;
+		}
+		remaining -= given;
+	} while (satisfied && remaining > 0);
+
+	if (remaining > 0) {
+		weights = 0;
+		TAILQ_FOREACH(member, &group->members, link) {
+			weights += member->weight;
+		}
+
+		TAILQ_FOREACH(member, &group->members, link) {
+			member->limits[type] += remaining * member->weight / weights;
+		}
+	}
+
+	TAILQ_FOREACH(member, &group->members, link) {
+		/* A zero limit would mean no limit at all */
+		member->limits[type] = spdk_max(member->limits[type], 1);
+	}
+}
+
+static void
+bdev_qos_group_apply(struct bdev_qos_group_member *member)
+{
+	struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(member->desc);
+	struct spdk_bdev_qos *qos;
+	struct spdk_bdev_qos_limit *limit;
+	uint64_t max_per_timeslice;
+	int i;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	qos = bdev->internal.qos;
+	if (qos == NULL || bdev->internal.qos_mod_in_progress) {
+		spdk_spin_unlock(&bdev->internal.spinlock);
+		return;
+	}
+
+	bdev_set_qos_group_limits(bdev, member->limits);
+	if (qos->thread != NULL) {
+		/* Only adjust the quota of the next timeslices, the group's limits stay defined,
+		 * so the set of enforced limits doesn't change.
+		 */
+		for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+			limit = &qos->rate_limits[i];
+			if (limit->group_limit == 0) {
+				continue;
+			}
+
+			max_per_timeslice = bdev_qos_limit_get_effective(limit) *
+					    SPDK_BDEV_QOS_TIMESLICE_IN_USEC / SPDK_SEC_TO_USEC;
+			limit->max_per_timeslice = spdk_max(max_per_timeslice,
+							    limit->min_per_timeslice);
+		}
+		bdev_qos_update_borrow_size(qos);
+	}
+	spdk_spin_unlock(&bdev->internal.spinlock);
+}
+
+static int
+bdev_qos_group_poll(void *arg)
+{
+	struct bdev_qos_group *group = arg;
+	struct bdev_qos_group_member *member;
+	bool throttled = false;
+	int i;
+
+	TAILQ_FOREACH(member, &group->members, link) {
+		if (member->cb_fn != NULL) {
+			/* An add or remove is in progress, keep the assigned limits */
+			member->active = false;
+			continue;
+		}
+
+		bdev_qos_group_sample(group, member);
+		throttled |= member->active && member->throttled;
+	}
+
+	if (TAILQ_EMPTY(&group->members)) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	bdev_qos_group_update_scale(group, throttled);
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (group->limits[i] != 0) {
+			bdev_qos_group_share(group, i);
+		}
+	}
+
+	TAILQ_FOREACH(member, &group->members, link) {
+		if (member->active) {
+			bdev_qos_group_apply(member);
+		}
+	}
+
+	return SPDK_POLLER_BUSY;
+}
+
+int
+spdk_bdev_qos_group_create(const char *name, const uint64_t *limits, uint64_t latency_target_us)
+{
+	struct bdev_qos_group *group;
+	bool limited = false;
+	int i;
+
+	assert(spdk_thread_is_app_thread(NULL));
+
+	if (bdev_qos_group_get_by_name(name) != NULL) {
+		SPDK_ERRLOG("QoS group %s already exists\n", name);
+		return -EEXIST;
+	}
+
+	group = calloc(1, sizeof(*group));
+	if (group == NULL) {
+		return -ENOMEM;
+	}
+
+	group->name = strdup(name);
+	if (group->name == NULL) {
+		free(group);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		group->limits[i] = limits[i];
+		if (limits[i] == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+			group->limits[i] = 0;
+		}
+		limited |= group->limits[i] != 0;
+	}
+
+	if (!limited) {
+		SPDK_ERRLOG("No rate limits specified for QoS group %s\n", name);
+		free(group->name);
+		free(group);
+		return -EINVAL;
+	}
+
+	bdev_qos_convert_rate_limits(group->limits);
+
+	group->latency_target_us = latency_target_us;
+	group->scale = SPDK_BDEV_QOS_GROUP_SCALE_ONE;
+	TAILQ_INIT(&group->members);
+
+	group->poller = SPDK_POLLER_REGISTER(bdev_qos_group_poll, group,
+					     SPDK_BDEV_QOS_GROUP_PERIOD_IN_USEC);
+	if (group->poller == NULL) {
+		free(group->name);
+		free(group);
+		return -ENOMEM;
+	}
+
+	TAILQ_INSERT_TAIL(&g_bdev_qos_groups, group, link);
+
+	return 0;
+}
+
+static void
+bdev_qos_group_free(struct bdev_qos_group *group)
+{
+	TAILQ_REMOVE(&g_bdev_qos_groups, group, link);
+	spdk_poller_unregister(&group->poller);
+	free(group->name);
+	free(group);
+}
+
+int
+spdk_bdev_qos_group_delete(const char *name)
+{
+	struct bdev_qos_group *group;
+
+	assert(spdk_thread_is_app_thread(NULL));
+
+	group = bdev_qos_group_get_by_name(name);
+	if (group == NULL) {
+		return -ENODEV;
+	}
+
+	if (!TAILQ_EMPTY(&group->members)) {
+		SPDK_ERRLOG("QoS group %s still has bdevs\n", name);
+		return -EBUSY;
+	}
+
+	bdev_qos_group_free(group);
+
+	return 0;
+}
+
+static void
+bdev_qos_group_member_free(struct bdev_qos_group_member *member)
+{
+	TAILQ_REMOVE(&member->group->members, member, link);
+	spdk_bdev_close(member->desc);
+	free(member);
+}
+
+static void
+bdev_qos_group_member_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
+			       void *event_ctx)
+{
+	struct bdev_qos_group_member *member = event_ctx;
+
+	if (type != SPDK_BDEV_EVENT_REMOVE) {
+		return;
+	}
+
+	if (member->cb_fn != NULL) {
+		/* Let the add or remove in progress finish first */
+		member->hot_removed = true;
+		return;
+	}
+
+	bdev_qos_group_member_free(member);
+}
+
+static void
+bdev_qos_group_set_latency_target(struct spdk_bdev *bdev, uint64_t latency_target_us)
+{
+	spdk_spin_lock(&bdev->internal.spinlock);
+	if (bdev->internal.qos != NULL) {
+		bdev->internal.qos->latency_target_ticks =
+			latency_target_us * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+	}
+	spdk_spin_unlock(&bdev->internal.spinlock);
+}
+
+static void
+bdev_qos_group_init_counters(struct bdev_qos_group_member *member)
+{
+	struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(member->desc);
+	struct spdk_bdev_qos *qos;
+	int i;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	qos = bdev->internal.qos;
+	if (qos != NULL) {
+		qos->latency_target_ticks = member->group->latency_target_us * spdk_get_ticks_hz() /
+					    SPDK_SEC_TO_USEC;
+		for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+			member->last_taken[i] = qos->rate_limits[i].taken;
+		}
+		member->last_throttled = qos->throttled;
+		member->last_ios_completed = qos->ios_completed;
+		member->last_ios_over_target = qos->ios_over_target;
+	}
+	spdk_spin_unlock(&bdev->internal.spinlock);
+}
+
+static void
+bdev_qos_group_add_done(void *cb_arg, int status)
+{
+	struct bdev_qos_group_member *member = cb_arg;
+	void (*cb_fn)(void *cb_arg, int status) = member->cb_fn;
+	void *ctx = member->cb_arg;
+
+	member->cb_fn = NULL;
+	member->cb_arg = NULL;
+
+	if (status != 0) {
+		bdev_qos_group_member_free(member);
+	} else {
+		bdev_qos_group_init_counters(member);
+		if (member->hot_removed) {
+			bdev_qos_group_member_free(member);
+			status = -ENODEV;
+		}
+	}
+
+	cb_fn(ctx, status);
+}
+
+void
+spdk_bdev_qos_group_add_bdev(const char *group_name, const char *bdev_name, uint32_t weight,
+			     const uint64_t *min_limits,
+			     void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
+{
+	struct bdev_qos_group *group, *tmp;
+	struct bdev_qos_group_member *member, *other;
+	uint64_t limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+	uint64_t min_total, weights;
+	int i, rc;
+
+	assert(spdk_thread_is_app_thread(NULL));
+
+	group = bdev_qos_group_get_by_name(group_name);
+	if (group == NULL) {
+		cb_fn(cb_arg, -ENODEV);
+		return;
+	}
+
+	if (weight == 0 || weight > SPDK_BDEV_QOS_GROUP_MAX_WEIGHT) {
+		SPDK_ERRLOG("QoS group weight must be between 1 and %u\n",
+			    SPDK_BDEV_QOS_GROUP_MAX_WEIGHT);
+		cb_fn(cb_arg, -EINVAL);
+		return;
+	}
+
+	member = calloc(1, sizeof(*member));
+	if (member == NULL) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	rc = spdk_bdev_open_ext(bdev_name, false, bdev_qos_group_member_event_cb, member,
+				&member->desc);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to open bdev %s: %s\n", bdev_name, spdk_strerror(-rc));
+		free(member);
+		cb_fn(cb_arg, rc);
+		return;
+	}
+
+	TAILQ_FOREACH(tmp, &g_bdev_qos_groups, link) {
+		if (bdev_qos_group_get_member(tmp, spdk_bdev_desc_get_bdev(member->desc)) != NULL) {
+			SPDK_ERRLOG("Bdev %s already belongs to QoS group %s\n", bdev_name,
+				    tmp->name);
+			rc = -EEXIST;
+			goto err;
+		}
+	}
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		limits[i] = min_limits != NULL ? min_limits[i] : 0;
+	}
+	bdev_qos_convert_rate_limits(limits);
+
+	weights = weight;
+	TAILQ_FOREACH(other, &group->members, link) {
+		weights += other->weight;
+	}
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (limits[i] == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+			limits[i] = 0;
+		}
+
+		if (limits[i] != 0 && group->limits[i] == 0) {
+			SPDK_ERRLOG("QoS group %s doesn't have a %s limit\n", group->name,
+				    qos_rpc_type[i]);
+			rc = -EINVAL;
+			goto err;
+		}
+
+		min_total = limits[i];
+		TAILQ_FOREACH(other, &group->members, link) {
+			min_total += other->min_limits[i];
+		}
+
+		if (min_total > group->limits[i]) {
+			SPDK_ERRLOG("Guaranteed %s of QoS group %s would exceed its limit\n",
+				    qos_rpc_type[i], group->name);
+			rc = -EINVAL;
+			goto err;
+		}
+
+		member->min_limits[i] = limits[i];
+
+		/* Start with the bdev's fair share, the next rebalancing adjusts it */
+		if (group->limits[i] != 0) {
+			member->limits[i] = bdev_qos_group_get_capacity(group, i) * weight /
+					    weights;
+			member->limits[i] = spdk_max(member->limits[i], member->min_limits[i]);
+			member->limits[i] = spdk_max(member->limits[i], 1);
+		}
+
+		/* Leave the user's limits unchanged */
+		limits[i] = SPDK_BDEV_QOS_LIMIT_NOT_DEFINED;
+	}
+
+	member->group = group;
+	member->weight = weight;
+	member->cb_fn = cb_fn;
+	member->cb_arg = cb_arg;
+	TAILQ_INSERT_TAIL(&group->members, member, link);
+
+	bdev_set_qos_limits(spdk_bdev_desc_get_bdev(member->desc), limits, member->limits,
+			    bdev_qos_group_add_done, member);
+	return;
+err:
+	spdk_bdev_close(member->desc);
+	free(member);
+	cb_fn(cb_arg, rc);
+}
+
+static void
+bdev_qos_group_remove_done(void *cb_arg, int status)
+{
+	struct bdev_qos_group_member *member = cb_arg;
+	void (*cb_fn)(void *cb_arg, int status) = member->cb_fn;
+	void *ctx = member->cb_arg;
+
+	member->cb_fn = NULL;
+	member->cb_arg = NULL;
+
+	if (status != 0 && !member->hot_removed) {
+		bdev_qos_group_set_latency_target(spdk_bdev_desc_get_bdev(member->desc),
+						  member->group->latency_target_us);
+	} else {
+		bdev_qos_group_member_free(member);
+		status = 0;
+	}
+
+	cb_fn(ctx, status);
+}
+
+void
+spdk_bdev_qos_group_remove_bdev(const char *group_name, const char *bdev_name,
+				void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
+{
+	struct bdev_qos_group *group;
+	struct bdev_qos_group_member *member;
+	struct spdk_bdev *bdev;
+	uint64_t limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+	uint64_t group_limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES] = {};
+	int i;
+
+	assert(spdk_thread_is_app_thread(NULL));
+
+	group = bdev_qos_group_get_by_name(group_name);
+	if (group == NULL) {
+		cb_fn(cb_arg, -ENODEV);
+		return;
+	}
+
+	bdev = spdk_bdev_get_by_name(bdev_name);
+	if (bdev == NULL) {
+		cb_fn(cb_arg, -ENODEV);
+		return;
+	}
+
+	member = bdev_qos_group_get_member(group, bdev);
+	if (member == NULL) {
+		SPDK_ERRLOG("Bdev %s doesn't belong to QoS group %s\n", bdev_name, group_name);
+		cb_fn(cb_arg, -ENOENT);
+		return;
+	}
+
+	if (member->cb_fn != NULL) {
+		cb_fn(cb_arg, -EBUSY);
+		return;
+	}
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		limits[i] = SPDK_BDEV_QOS_LIMIT_NOT_DEFINED;
+	}
+
+	member->cb_fn = cb_fn;
+	member->cb_arg = cb_arg;
+	bdev_qos_group_set_latency_target(bdev, 0);
+	bdev_set_qos_limits(bdev, limits, group_limits, bdev_qos_group_remove_done, member);
+}
+
+static void
+bdev_qos_group_write_limits(struct spdk_json_write_ctx *w, const uint64_t *limits)
+{
+	int i;
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (limits[i] == 0) {
+			continue;
+		}
+
+		if (bdev_qos_is_iops_rate_limit(i) == true) {
+			spdk_json_write_named_uint64(w, qos_rpc_type[i], limits[i]);
+		} else {
+			spdk_json_write_named_uint64(w, qos_rpc_type[i], limits[i] / 1024 / 1024);
+		}
+	}
+}
+
+static void
+bdev_qos_group_write_stats(struct spdk_json_write_ctx *w, const char *name,
+			   struct bdev_qos_group *group, const uint64_t *values)
+{
+	int i;
+
+	spdk_json_write_named_object_begin(w, name);
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (group->limits[i] != 0) {
+			spdk_json_write_named_uint64(w, qos_stat_type[i], values[i]);
+		}
+	}
+	spdk_json_write_object_end(w);
+}
+
+void
+spdk_bdev_qos_groups_dump_info_json(struct spdk_json_write_ctx *w)
+{
+	struct bdev_qos_group *group;
+	struct bdev_qos_group_member *member;
+	uint64_t capacity[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+	int i;
+
+	assert(spdk_thread_is_app_thread(NULL));
+
+	spdk_json_write_array_begin(w);
+	TAILQ_FOREACH(group, &g_bdev_qos_groups, link) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "name", group->name);
+		bdev_qos_group_write_limits(w, group->limits);
+		if (group->latency_target_us != 0) {
+			spdk_json_write_named_uint64(w, "latency_target_us",
+						     group->latency_target_us);
+		}
+
+		for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+			capacity[i] = bdev_qos_group_get_capacity(group, i);
+		}
+		bdev_qos_group_write_stats(w, "capacity", group, capacity);
+
+		spdk_json_write_named_array_begin(w, "bdevs");
+		TAILQ_FOREACH(member, &group->members, link) {
+			spdk_json_write_object_begin(w);
+			spdk_json_write_named_string(w, "name", bdev_qos_group_member_name(member));
+			spdk_json_write_named_uint32(w, "weight", member->weight);
+			bdev_qos_group_write_stats(w, "min", group, member->min_limits);
+			bdev_qos_group_write_stats(w, "assigned", group, member->limits);
+			bdev_qos_group_write_stats(w, "usage", group, member->usage);
+			spdk_json_write_named_uint64(w, "throttled_periods",
+						     member->throttled_periods);
+			spdk_json_write_object_end(w);
+		}
+		spdk_json_write_array_end(w);
+
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+}
+
+static void
+bdev_qos_groups_config_json(struct spdk_json_write_ctx *w)
+{
+	struct bdev_qos_group *group;
+
+	TAILQ_FOREACH(group, &g_bdev_qos_groups, link) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_qos_group_create");
+
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_string(w, "name", group->name);
+		bdev_qos_group_write_limits(w, group->limits);
+		if (group->latency_target_us != 0) {
+			spdk_json_write_named_uint64(w, "latency_target_us",
+						     group->latency_target_us);
+		}
+		spdk_json_write_object_end(w);
+
+		spdk_json_write_object_end(w);
+	}
+}
+
+static void
+bdev_qos_group_members_config_json(struct spdk_json_write_ctx *w)
+{
+	struct bdev_qos_group *group;
+	struct bdev_qos_group_member *member;
+	int i;
+
+	TAILQ_FOREACH(group, &g_bdev_qos_groups, link) {
+		TAILQ_FOREACH(member, &group->members, link) {
+			spdk_json_write_object_begin(w);
+			spdk_json_write_named_string(w, "method", "bdev_qos_group_add_bdev");
+
+			spdk_json_write_named_object_begin(w, "params");
+			spdk_json_write_named_string(w, "group", group->name);
+			spdk_json_write_named_string(w, "name", bdev_qos_group_member_name(member));
+			spdk_json_write_named_uint32(w, "weight", member->weight);
+			for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+				if (member->min_limits[i] == 0) {
+					continue;
+				}
+
+				spdk_json_write_named_uint64(w, qos_min_rpc_type[i],
+							     bdev_qos_is_iops_rate_limit(i) ?
+							     member->min_limits[i] :
+							     member->min_limits[i] / 1024 / 1024);
+			}
+			spdk_json_write_object_end(w);
+
+			spdk_json_write_object_end(w);
+		}
+	}
+}
+
+static void
+bdev_qos_groups_fini(void)
+{
+	struct bdev_qos_group *group, *tmp_group;
+	struct bdev_qos_group_member *member, *tmp_member;
+
+	TAILQ_FOREACH_SAFE(group, &g_bdev_qos_groups, link, tmp_group) {
+		TAILQ_FOREACH_SAFE(member, &group->members, link, tmp_member) {
+			if (member->cb_fn == NULL) {
+				bdev_qos_group_member_free(member);
+			}
+		}
+
+		if (TAILQ_EMPTY(&group->members)) {
+			bdev_qos_group_free(group);
+		}
+	}
+}
+
 struct spdk_bdev_histogram_ctx {
 	spdk_bdev_histogram_status_cb cb_fn;
 	void *cb_arg;
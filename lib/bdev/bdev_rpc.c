@@ -1020,6 +1020,230 @@ cleanup:
 
 SPDK_RPC_REGISTER("bdev_set_qos_limit", rpc_bdev_set_qos_limit, SPDK_RPC_RUNTIME)
 
+struct rpc_bdev_qos_group_create {
+	char		*name;
+	uint64_t	limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+	uint64_t	latency_target_us;
+};
+
+static const struct spdk_json_object_decoder rpc_bdev_qos_group_create_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_qos_group_create, name), spdk_json_decode_string},
+	{
+		"rw_ios_per_sec", offsetof(struct rpc_bdev_qos_group_create,
+					   limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT]),
+		spdk_json_decode_uint64, true
+	},
+	{
+		"rw_mbytes_per_sec", offsetof(struct rpc_bdev_qos_group_create,
+					      limits[SPDK_BDEV_QOS_RW_BPS_RATE_LIMIT]),
+		spdk_json_decode_uint64, true
+	},
+	{
+		"r_mbytes_per_sec", offsetof(struct rpc_bdev_qos_group_create,
+					     limits[SPDK_BDEV_QOS_R_BPS_RATE_LIMIT]),
+		spdk_json_decode_uint64, true
+	},
+	{
+		"w_mbytes_per_sec", offsetof(struct rpc_bdev_qos_group_create,
+					     limits[SPDK_BDEV_QOS_W_BPS_RATE_LIMIT]),
+		spdk_json_decode_uint64, true
+	},
+	{
+		"latency_target_us", offsetof(struct rpc_bdev_qos_group_create, latency_target_us),
+		spdk_json_decode_uint64, true
+	},
+};
+
+static void
+rpc_bdev_qos_group_create(struct spdk_jsonrpc_request *request,
+			  const struct spdk_json_val *params)
+{
+	struct rpc_bdev_qos_group_create req = {};
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_qos_group_create_decoders,
+				    SPDK_COUNTOF(rpc_bdev_qos_group_create_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = spdk_bdev_qos_group_create(req.name, req.limits, req.latency_target_us);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+
+cleanup:
+	free(req.name);
+}
+SPDK_RPC_REGISTER("bdev_qos_group_create", rpc_bdev_qos_group_create, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_qos_group_delete {
+	char *name;
+};
+
+static const struct spdk_json_object_decoder rpc_bdev_qos_group_delete_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_qos_group_delete, name), spdk_json_decode_string},
+};
+
+static void
+rpc_bdev_qos_group_delete(struct spdk_jsonrpc_request *request,
+			  const struct spdk_json_val *params)
+{
+	struct rpc_bdev_qos_group_delete req = {};
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_qos_group_delete_decoders,
+				    SPDK_COUNTOF(rpc_bdev_qos_group_delete_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = spdk_bdev_qos_group_delete(req.name);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+
+cleanup:
+	free(req.name);
+}
+SPDK_RPC_REGISTER("bdev_qos_group_delete", rpc_bdev_qos_group_delete, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_qos_group_add_bdev {
+	char		*group;
+	char		*name;
+	uint32_t	weight;
+	uint64_t	min_limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+};
+
+static const struct spdk_json_object_decoder rpc_bdev_qos_group_add_bdev_decoders[] = {
+	{"group", offsetof(struct rpc_bdev_qos_group_add_bdev, group), spdk_json_decode_string},
+	{"name", offsetof(struct rpc_bdev_qos_group_add_bdev, name), spdk_json_decode_string},
+	{
+		"weight", offsetof(struct rpc_bdev_qos_group_add_bdev, weight),
+		spdk_json_decode_uint32, true
+	},
+	{
+		"min_rw_ios_per_sec", offsetof(struct rpc_bdev_qos_group_add_bdev,
+					       min_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT]),
+		spdk_json_decode_uint64, true
+	},
+	{
+		"min_rw_mbytes_per_sec", offsetof(struct rpc_bdev_qos_group_add_bdev,
+						  min_limits[SPDK_BDEV_QOS_RW_BPS_RATE_LIMIT]),
+		spdk_json_decode_uint64, true
+	},
+	{
+		"min_r_mbytes_per_sec", offsetof(struct rpc_bdev_qos_group_add_bdev,
+						 min_limits[SPDK_BDEV_QOS_R_BPS_RATE_LIMIT]),
+		spdk_json_decode_uint64, true
+	},
+	{
+		"min_w_mbytes_per_sec", offsetof(struct rpc_bdev_qos_group_add_bdev,
+						 min_limits[SPDK_BDEV_QOS_W_BPS_RATE_LIMIT]),
+		spdk_json_decode_uint64, true
+	},
+};
+
+static void
+rpc_bdev_qos_group_complete(void *cb_arg, int status)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+
+	if (status != 0) {
+		spdk_jsonrpc_send_error_response(request, status, spdk_strerror(-status));
+		return;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+}
+
+static void
+rpc_bdev_qos_group_add_bdev(struct spdk_jsonrpc_request *request,
+			    const struct spdk_json_val *params)
+{
+	struct rpc_bdev_qos_group_add_bdev req = {.weight = 1};
+
+	if (spdk_json_decode_object(params, rpc_bdev_qos_group_add_bdev_decoders,
+				    SPDK_COUNTOF(rpc_bdev_qos_group_add_bdev_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	spdk_bdev_qos_group_add_bdev(req.group, req.name, req.weight, req.min_limits,
+				     rpc_bdev_qos_group_complete, request);
+
+cleanup:
+	free(req.group);
+	free(req.name);
+}
+SPDK_RPC_REGISTER("bdev_qos_group_add_bdev", rpc_bdev_qos_group_add_bdev, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_qos_group_remove_bdev {
+	char *group;
+	char *name;
+};
+
+static const struct spdk_json_object_decoder rpc_bdev_qos_group_remove_bdev_decoders[] = {
+	{"group", offsetof(struct rpc_bdev_qos_group_remove_bdev, group), spdk_json_decode_string},
+	{"name", offsetof(struct rpc_bdev_qos_group_remove_bdev, name), spdk_json_decode_string},
+};
+
+static void
+rpc_bdev_qos_group_remove_bdev(struct spdk_jsonrpc_request *request,
+			       const struct spdk_json_val *params)
+{
+	struct rpc_bdev_qos_group_remove_bdev req = {};
+
+	if (spdk_json_decode_object(params, rpc_bdev_qos_group_remove_bdev_decoders,
+				    SPDK_COUNTOF(rpc_bdev_qos_group_remove_bdev_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	spdk_bdev_qos_group_remove_bdev(req.group, req.name, rpc_bdev_qos_group_complete, request);
+
+cleanup:
+	free(req.group);
+	free(req.name);
+}
+SPDK_RPC_REGISTER("bdev_qos_group_remove_bdev", rpc_bdev_qos_group_remove_bdev, SPDK_RPC_RUNTIME)
+
+static void
+rpc_bdev_qos_get_groups(struct spdk_jsonrpc_request *request,
+			const struct spdk_json_val *params)
+{
+	struct spdk_json_write_ctx *w;
+
+	if (params != NULL) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 "bdev_qos_get_groups requires no parameters");
+		return;
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_bdev_qos_groups_dump_info_json(w);
+	spdk_jsonrpc_end_result(request, w);
+}
+SPDK_RPC_REGISTER("bdev_qos_get_groups", rpc_bdev_qos_get_groups, SPDK_RPC_RUNTIME)
+
 /* SPDK_RPC_ENABLE_BDEV_HISTOGRAM */
 
 struct rpc_bdev_enable_histogram_request {
@@ -124,6 +124,8 @@ bs_release_md_page(struct spdk_blob_store *bs, uint32_t page)
 	spdk_bit_array_clear(bs->used_md_pages, page);
 }
 
+static void bs_reclaim_reserved_clusters(struct spdk_blob_store *bs);
+
 static uint32_t
 bs_claim_cluster(struct spdk_blob_store *bs)
 {
@@ -131,6 +133,10 @@ bs_claim_cluster(struct spdk_blob_store *bs)
 
 	assert(spdk_spin_held(&bs->used_lock));
 
+	if (bs->num_free_clusters == 0) {
+		bs_reclaim_reserved_clusters(bs);
+	}
+
 	cluster_num = spdk_bit_pool_allocate_bit(bs->used_clusters);
 	if (cluster_num == UINT32_MAX) {
 		return UINT32_MAX;
@@ -156,17 +162,472 @@ bs_release_cluster(struct spdk_blob_store *bs, uint32_t cluster_num)
 	bs->num_free_clusters++;
 }
 
+static inline uint64_t
+bs_reserved_range(uint32_t first, uint32_t count)
+{
+	return ((uint64_t)first << 32) | count;
+}
+
+static inline uint32_t
+bs_reserved_range_first(uint64_t range)
+{
+	return range >> 32;
+}
+
+static inline uint32_t
+bs_reserved_range_count(uint64_t range)
+{
+	return (uint32_t)range;
+}
+
+static inline uint32_t
+bs_channel_num_reserved_clusters(struct spdk_bs_channel *ch)
+{
+	return bs_reserved_range_count(__atomic_load_n(&ch->reserved_range, __ATOMIC_ACQUIRE));
+}
+
+static void
+bs_channel_reserve_clusters_locked(struct spdk_bs_channel *ch)
+{
+	struct spdk_blob_store *bs = ch->bs;
+	uint64_t min_free_clusters;
+	uint32_t cluster_num, first, count;
+
+	assert(spdk_spin_held(&bs->used_lock));
+
+	/* Channels created while an unload had the reservation disabled have no array */
+	if (ch->reserved_clusters == NULL) {
+		return;
+	}
+
+	/* Only the channel's thread adds clusters and other threads need used_lock to take them */
+	first = bs_reserved_range_first(ch->reserved_range);
+	count = bs_reserved_range_count(ch->reserved_range);
+	if (first != 0) {
+		memmove(ch->reserved_clusters, &ch->reserved_clusters[first],
+			count * sizeof(*ch->reserved_clusters));
+	}
+
+	min_free_clusters = (uint64_t)bs->cluster_reserve_batch * SPDK_BS_CLUSTER_RESERVE_MIN_FREE_RATIO;
+	while (count < bs->cluster_reserve_batch && bs->num_free_clusters >= min_free_clusters) {
+		cluster_num = bs_claim_cluster(bs);
+		assert(cluster_num != UINT32_MAX);
+		ch->reserved_clusters[count++] = cluster_num;
+		__atomic_fetch_add(&bs->num_reserved_clusters, 1, __ATOMIC_RELAXED);
+	}
+
+	__atomic_store_n(&ch->reserved_range, bs_reserved_range(0, count), __ATOMIC_RELEASE);
+}
+
+/* Take a cluster from the front of the channel's reservation, called on the channel's thread */
+static bool
+bs_channel_take_reserved_cluster(struct spdk_bs_channel *ch, uint64_t *cluster)
+{
+	uint64_t range, new_range;
+	uint32_t first, count;
+
+	range = __atomic_load_n(&ch->reserved_range, __ATOMIC_ACQUIRE);
+	do {
+		first = bs_reserved_range_first(range);
+		count = bs_reserved_range_count(range);
+		if (count == 0) {
+			return false;
+		}
+		new_range = bs_reserved_range(first + 1, count - 1);
+	} while (!__atomic_compare_exchange_n(&ch->reserved_range, &range, new_range, false,
+					      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+	*cluster = ch->reserved_clusters[first];
+	__atomic_fetch_sub(&ch->bs->num_reserved_clusters, 1, __ATOMIC_RELAXED);
+
+	return true;
+}
+
+/* Return all the clusters reserved by the channel to the blobstore, on any thread */
+static void
+bs_channel_release_reserved_clusters_locked(struct spdk_bs_channel *ch)
+{
+	struct spdk_blob_store *bs = ch->bs;
+	uint64_t range;
+	uint32_t i, first, count;
+
+	assert(spdk_spin_held(&bs->used_lock));
+
+	range = __atomic_load_n(&ch->reserved_range, __ATOMIC_ACQUIRE);
+	do {
+		first = bs_reserved_range_first(range);
+		count = bs_reserved_range_count(range);
+		if (count == 0) {
+			return;
+		}
+	} while (!__atomic_compare_exchange_n(&ch->reserved_range, &range,
+					      bs_reserved_range(first, 0), false,
+					      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+	for (i = 0; i < count; i++) {
+		bs_release_cluster(bs, ch->reserved_clusters[first + i]);
+	}
+	__atomic_fetch_sub(&bs->num_reserved_clusters, count, __ATOMIC_RELAXED);
+}
+
+/*
+ * Take back the clusters reserved by all the channels, so that the blobstore doesn't run out of
+ * space while some is still held in the reservations.
+ */
+static void
+bs_reclaim_reserved_clusters(struct spdk_blob_store *bs)
+{
+	struct spdk_bs_channel *ch;
+
+	assert(spdk_spin_held(&bs->used_lock));
+
+	TAILQ_FOREACH(ch, &bs->channels, link) {
+		bs_channel_release_reserved_clusters_locked(ch);
+	}
+}
+
+/*
+ * Number of free clusters, including the ones reserved by the channels. If there are fewer than
+ * needed in the blobstore itself, the reservations are taken back, so they can be claimed.
+ */
+static uint64_t
+bs_num_free_clusters_locked(struct spdk_blob_store *bs, uint64_t needed)
+{
+	assert(spdk_spin_held(&bs->used_lock));
+
+	if (bs->num_free_clusters < needed) {
+		bs_reclaim_reserved_clusters(bs);
+	}
+
+	return bs->num_free_clusters;
+}
+
+static void
+bs_channel_reserve_clusters_msg(void *ctx)
+{
+	struct spdk_io_channel *_ch = ctx;
+	struct spdk_bs_channel *ch = spdk_io_channel_get_ctx(_ch);
+
+	ch->reserve_clusters_pending = false;
+
+	spdk_spin_lock(&ch->bs->used_lock);
+	bs_channel_reserve_clusters_locked(ch);
+	spdk_spin_unlock(&ch->bs->used_lock);
+
+	spdk_put_io_channel(_ch);
+}
+
+static void
+bs_channel_reserve_clusters_async(struct spdk_bs_channel *ch)
+{
+	struct spdk_io_channel *_ch;
+
+	if (ch->reserve_clusters_pending) {
+		return;
+	}
+
+	/* Hold a reference to the channel until the reservation is done */
+	_ch = spdk_get_io_channel(ch->bs);
+	if (_ch == NULL) {
+		return;
+	}
+	assert(spdk_io_channel_get_ctx(_ch) == ch);
+
+	if (spdk_thread_send_msg(spdk_get_thread(), bs_channel_reserve_clusters_msg, _ch) != 0) {
+		spdk_put_io_channel(_ch);
+		return;
+	}
+
+	ch->reserve_clusters_pending = true;
+}
+
+static inline uint64_t
+blob_cluster_chunk_count(uint64_t num_clusters)
+{
+	return spdk_divide_round_up(num_clusters, SPDK_BLOB_CLUSTER_CHUNK_SIZE);
+}
+
+/*
+ * Large thin provisioned blobs with few allocated clusters keep a sparse cluster map, so that
+ * unallocated clusters do not take any memory. Dense maps stay flat for the fastest lookup.
+ */
+static bool
+blob_clusters_want_sparse(struct spdk_blob *blob, uint64_t num_clusters,
+			  uint64_t num_allocated_clusters)
+{
+	return spdk_blob_is_thin_provisioned(blob) &&
+	       num_clusters >= SPDK_BLOB_SPARSE_MIN_CLUSTERS &&
+	       num_allocated_clusters < num_clusters / 2;
+}
+
+static void
+blob_clusters_free(struct spdk_blob_mut_data *data)
+{
+	uint64_t i;
+
+	if (data->cluster_chunks != NULL) {
+		for (i = 0; i < blob_cluster_chunk_count(data->cluster_array_size); i++) {
+			free(data->cluster_chunks[i]);
+		}
+		free(data->cluster_chunks);
+		data->cluster_chunks = NULL;
+	}
+
+	free(data->clusters);
+	data->clusters = NULL;
+	data->cluster_array_size = 0;
+}
+
+/* Mark all clusters in the cluster map as unallocated. */
+static void
+blob_clusters_clear(struct spdk_blob_mut_data *data)
+{
+	uint64_t i;
+
+	if (data->cluster_chunks == NULL) {
+		if (data->cluster_array_size != 0) {
+			memset(data->clusters, 0, data->cluster_array_size * sizeof(*data->clusters));
+		}
+		return;
+	}
+
+	for (i = 0; i < blob_cluster_chunk_count(data->cluster_array_size); i++) {
+		free(data->cluster_chunks[i]);
+		data->cluster_chunks[i] = NULL;
+	}
+}
+
+/* Get the cluster map entry for a cluster, allocating its chunk if needed. */
+static uint64_t *
+blob_cluster_lba_ptr(struct spdk_blob_mut_data *data, uint64_t cluster_num)
+{
+	uint64_t **chunk;
+
+	assert(cluster_num < data->cluster_array_size);
+	if (data->cluster_chunks == NULL) {
+		return &data->clusters[cluster_num];
+	}
+
+	chunk = &data->cluster_chunks[cluster_num >> SPDK_BLOB_CLUSTER_CHUNK_SHIFT];
+	if (*chunk == NULL) {
+		*chunk = calloc(SPDK_BLOB_CLUSTER_CHUNK_SIZE, sizeof(**chunk));
+		if (*chunk == NULL) {
+			return NULL;
+		}
+	}
+
+	return &(*chunk)[cluster_num & (SPDK_BLOB_CLUSTER_CHUNK_SIZE - 1)];
+}
+
+static int
+blob_set_cluster_lba(struct spdk_blob_mut_data *data, uint64_t cluster_num, uint64_t lba)
+{
+	uint64_t *cluster_lba;
+
+	if (lba == 0 && data->cluster_chunks != NULL &&
+	    data->cluster_chunks[cluster_num >> SPDK_BLOB_CLUSTER_CHUNK_SHIFT] == NULL) {
+		return 0;
+	}
+
+	cluster_lba = blob_cluster_lba_ptr(data, cluster_num);
+	if (cluster_lba == NULL) {
+		return -ENOMEM;
+	}
+	*cluster_lba = lba;
+
+	return 0;
+}
+
+/*
+ * Change the size of the cluster map. Entries added to the map are zeroed. Shrinking
+ * the map never fails.
+ */
+static int
+blob_clusters_resize(struct spdk_blob_mut_data *data, uint64_t size)
+{
+	uint64_t old_num_chunks, num_chunks, i;
+	uint64_t **chunks;
+	uint64_t *tmp;
+
+	if (data->cluster_chunks == NULL) {
+		if (size == 0) {
+			free(data->clusters);
+			data->clusters = NULL;
+		} else {
+			tmp = realloc(data->clusters, size * sizeof(*data->clusters));
+			if (tmp == NULL) {
+				if (size > data->cluster_array_size) {
+					return -ENOMEM;
+				}
+				/* Keep the larger array */
+				tmp = data->clusters;
+			}
+			if (size > data->cluster_array_size) {
+				memset(tmp + data->cluster_array_size, 0,
+				       (size - data->cluster_array_size) * sizeof(*tmp));
+			}
+			data->clusters = tmp;
+		}
+		data->cluster_array_size = size;
+		return 0;
+	}
+
+	old_num_chunks = blob_cluster_chunk_count(data->cluster_array_size);
+	num_chunks = blob_cluster_chunk_count(size);
+
+	if (num_chunks > old_num_chunks) {
+		chunks = realloc(data->cluster_chunks, num_chunks * sizeof(*chunks));
+		if (chunks == NULL) {
+			return -ENOMEM;
+		}
+		memset(chunks + old_num_chunks, 0, (num_chunks - old_num_chunks) * sizeof(*chunks));
+		data->cluster_chunks = chunks;
+	} else if (num_chunks < old_num_chunks) {
+		for (i = num_chunks; i < old_num_chunks; i++) {
+			free(data->cluster_chunks[i]);
+			data->cluster_chunks[i] = NULL;
+		}
+		/* An empty sparse map keeps its chunk table, so that it stays sparse */
+		if (num_chunks != 0) {
+			chunks = realloc(data->cluster_chunks, num_chunks * sizeof(*chunks));
+			if (chunks != NULL) {
+				data->cluster_chunks = chunks;
+			}
+		}
+	}
+
+	/* Clear the entries of the last chunk that are not part of the map any more, or were not yet */
+	i = spdk_min(size, data->cluster_array_size);
+	if (data->cluster_chunks != NULL && (i & (SPDK_BLOB_CLUSTER_CHUNK_SIZE - 1)) != 0) {
+		tmp = data->cluster_chunks[i >> SPDK_BLOB_CLUSTER_CHUNK_SHIFT];
+		if (tmp != NULL) {
+			memset(&tmp[i & (SPDK_BLOB_CLUSTER_CHUNK_SIZE - 1)], 0,
+			       (SPDK_BLOB_CLUSTER_CHUNK_SIZE - (i & (SPDK_BLOB_CLUSTER_CHUNK_SIZE - 1))) *
+			       sizeof(*tmp));
+		}
+	}
+
+	data->cluster_array_size = size;
+	return 0;
+}
+
+/*
+ * Make a copy of the first num_clusters entries of the cluster map in src, using
+ * the sparse representation if requested.
+ */
+static int
+blob_clusters_copy(struct spdk_blob_mut_data *dst, const struct spdk_blob_mut_data *src,
+		   uint64_t num_clusters, bool sparse)
+{
+	uint64_t i, j, num, lba;
+	uint64_t *cluster_lba;
+
+	assert(dst->clusters == NULL && dst->cluster_chunks == NULL);
+	assert(num_clusters <= src->cluster_array_size);
+
+	if (!sparse) {
+		if (num_clusters == 0) {
+			dst->cluster_array_size = 0;
+			return 0;
+		}
+		dst->clusters = calloc(num_clusters, sizeof(*dst->clusters));
+		if (dst->clusters == NULL) {
+			return -ENOMEM;
+		}
+		dst->cluster_array_size = num_clusters;
+		if (src->cluster_chunks == NULL) {
+			memcpy(dst->clusters, src->clusters, num_clusters * sizeof(*dst->clusters));
+			return 0;
+		}
+	} else {
+		/* The chunk table is allocated even for an empty map, it marks the map as sparse */
+		dst->cluster_chunks = calloc(spdk_max(blob_cluster_chunk_count(num_clusters), 1),
+					     sizeof(*dst->cluster_chunks));
+		if (dst->cluster_chunks == NULL) {
+			return -ENOMEM;
+		}
+		dst->cluster_array_size = num_clusters;
+	}
+
+	for (i = 0; i < num_clusters; i += SPDK_BLOB_CLUSTER_CHUNK_SIZE) {
+		if (src->cluster_chunks != NULL &&
+		    src->cluster_chunks[i >> SPDK_BLOB_CLUSTER_CHUNK_SHIFT] == NULL) {
+			/* Nothing allocated in this chunk */
+			continue;
+		}
+
+		num = spdk_min(SPDK_BLOB_CLUSTER_CHUNK_SIZE, num_clusters - i);
+		for (j = i; j < i + num; j++) {
+			lba = bs_blob_cluster_lba(src, j);
+			if (lba == 0) {
+				continue;
+			}
+			cluster_lba = blob_cluster_lba_ptr(dst, j);
+			if (cluster_lba == NULL) {
+				blob_clusters_free(dst);
+				return -ENOMEM;
+			}
+			*cluster_lba = lba;
+		}
+	}
+
+	return 0;
+}
+
+/* Switch the representation of the cluster map of the active data. */
+static int
+blob_clusters_set_sparse(struct spdk_blob *blob, bool sparse)
+{
+	struct spdk_blob_mut_data tmp = {};
+	int rc;
+
+	if ((blob->active.cluster_chunks != NULL) == sparse) {
+		return 0;
+	}
+
+	rc = blob_clusters_copy(&tmp, &blob->active, blob->active.cluster_array_size, sparse);
+	if (rc != 0) {
+		return rc;
+	}
+
+	blob_clusters_free(&blob->active);
+	blob->active.clusters = tmp.clusters;
+	blob->active.cluster_chunks = tmp.cluster_chunks;
+	blob->active.cluster_array_size = tmp.cluster_array_size;
+
+	return 0;
+}
+
+static inline bool
+blob_clusters_all_zero(const struct spdk_blob_mut_data *data)
+{
+	uint64_t i;
+
+	for (i = 0; i < data->num_clusters; i++) {
+		if (bs_blob_cluster_lba(data, i) != 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 static int
 blob_insert_cluster(struct spdk_blob *blob, uint32_t cluster_num, uint64_t cluster)
 {
-	uint64_t *cluster_lba = &blob->active.clusters[cluster_num];
+	uint64_t *cluster_lba;
 
 	blob_verify_md_op(blob);
 
-	if (*cluster_lba != 0) {
+	if (bs_blob_cluster_lba(&blob->active, cluster_num) != 0) {
 		return -EEXIST;
 	}
 
+	cluster_lba = blob_cluster_lba_ptr(&blob->active, cluster_num);
+	if (cluster_lba == NULL) {
+		return -ENOMEM;
+	}
+
 	*cluster_lba = bs_cluster_to_lba(blob->bs, cluster);
 	blob->active.num_allocated_clusters++;
 
@@ -219,6 +680,46 @@ bs_allocate_cluster(struct spdk_blob *blob, uint32_t cluster_num,
 	return 0;
 }
 
+/*
+ * Allocate a cluster for the first write to an unallocated cluster of a thin provisioned blob.
+ * The cluster is taken from the channel's reservation without taking used_lock, unless a new
+ * extent page is needed too.
+ */
+static int
+bs_channel_allocate_cluster(struct spdk_bs_channel *ch, struct spdk_blob *blob,
+			    uint32_t cluster_num, uint64_t *cluster, uint32_t *lowest_free_md_page)
+{
+	struct spdk_blob_store *bs = blob->bs;
+	bool need_extent_page;
+	int rc = 0;
+
+	need_extent_page = blob->use_extent_table && *bs_cluster_to_extent_page(blob, cluster_num) == 0;
+
+	if (need_extent_page || !bs_channel_take_reserved_cluster(ch, cluster)) {
+		spdk_spin_lock(&bs->used_lock);
+		if (ch->reserved_clusters != NULL && bs_channel_num_reserved_clusters(ch) == 0) {
+			bs_channel_reserve_clusters_locked(ch);
+			if (!need_extent_page && bs_channel_take_reserved_cluster(ch, cluster)) {
+				spdk_spin_unlock(&bs->used_lock);
+				goto reserved;
+			}
+		}
+		rc = bs_allocate_cluster(blob, cluster_num, cluster, lowest_free_md_page, false);
+		spdk_spin_unlock(&bs->used_lock);
+		return rc;
+	}
+
+reserved:
+	SPDK_DEBUGLOG(blob, "Claiming reserved cluster %" PRIu64 " for blob 0x%" PRIx64 "\n",
+		      *cluster, blob->id);
+
+	if (bs_channel_num_reserved_clusters(ch) < bs->cluster_reserve_batch / 2) {
+		bs_channel_reserve_clusters_async(ch);
+	}
+
+	return 0;
+}
+
 static void
 blob_xattrs_init(struct spdk_blob_xattr_opts *xattrs)
 {
@@ -360,8 +861,8 @@ blob_free(struct spdk_blob *blob)
 
 	free(blob->active.extent_pages);
 	free(blob->clean.extent_pages);
-	free(blob->active.clusters);
-	free(blob->clean.clusters);
+	blob_clusters_free(&blob->active);
+	blob_clusters_free(&blob->clean);
 	free(blob->active.pages);
 	free(blob->clean.pages);
 
@@ -574,8 +1075,10 @@ static int
 blob_mark_clean(struct spdk_blob *blob)
 {
 	uint32_t *extent_pages = NULL;
-	uint64_t *clusters = NULL;
+	struct spdk_blob_mut_data clusters = {};
 	uint32_t *pages = NULL;
+	bool sparse;
+	int rc;
 
 	assert(blob != NULL);
 
@@ -589,14 +1092,19 @@ blob_mark_clean(struct spdk_blob *blob)
 		       blob->active.num_extent_pages * sizeof(*extent_pages));
 	}
 
-	if (blob->active.num_clusters) {
-		assert(blob->active.clusters);
-		clusters = calloc(blob->active.num_clusters, sizeof(*blob->active.clusters));
-		if (!clusters) {
-			free(extent_pages);
-			return -ENOMEM;
-		}
-		memcpy(clusters, blob->active.clusters, blob->active.num_clusters * sizeof(*blob->active.clusters));
+	/*
+	 * The representation of the cluster map is chosen again on every copy. The active map
+	 * becomes the clean one, so it is converted first for both copies to use the same one.
+	 */
+	sparse = blob_clusters_want_sparse(blob, blob->active.num_clusters,
+					   blob->active.num_allocated_clusters);
+	rc = blob_clusters_set_sparse(blob, sparse);
+	if (rc == 0) {
+		rc = blob_clusters_copy(&clusters, &blob->active, blob->active.num_clusters, sparse);
+	}
+	if (rc != 0) {
+		free(extent_pages);
+		return rc;
 	}
 
 	if (blob->active.num_pages) {
@@ -604,26 +1112,30 @@ blob_mark_clean(struct spdk_blob *blob)
 		pages = calloc(blob->active.num_pages, sizeof(*blob->active.pages));
 		if (!pages) {
 			free(extent_pages);
-			free(clusters);
+			blob_clusters_free(&clusters);
 			return -ENOMEM;
 		}
 		memcpy(pages, blob->active.pages, blob->active.num_pages * sizeof(*blob->active.pages));
 	}
 
 	free(blob->clean.extent_pages);
-	free(blob->clean.clusters);
+	blob_clusters_free(&blob->clean);
 	free(blob->clean.pages);
 
 	blob->clean.num_extent_pages = blob->active.num_extent_pages;
 	blob->clean.extent_pages = blob->active.extent_pages;
 	blob->clean.num_clusters = blob->active.num_clusters;
 	blob->clean.clusters = blob->active.clusters;
+	blob->clean.cluster_chunks = blob->active.cluster_chunks;
+	blob->clean.cluster_array_size = blob->active.cluster_array_size;
 	blob->clean.num_allocated_clusters = blob->active.num_allocated_clusters;
 	blob->clean.num_pages = blob->active.num_pages;
 	blob->clean.pages = blob->active.pages;
 
 	blob->active.extent_pages = extent_pages;
-	blob->active.clusters = clusters;
+	blob->active.clusters = clusters.clusters;
+	blob->active.cluster_chunks = clusters.cluster_chunks;
+	blob->active.cluster_array_size = clusters.cluster_array_size;
 	blob->active.pages = pages;
 
 	/* If the metadata was dirtied again while the metadata was being written to disk,
@@ -685,6 +1197,7 @@ blob_parse_page(const struct spdk_blob_md_page *page, struct spdk_blob *blob)
 	struct spdk_blob_md_descriptor *desc;
 	size_t	cur_desc = 0;
 	void *tmp;
+	int rc;
 
 	desc = (struct spdk_blob_md_descriptor *)page->descriptors;
 	while (cur_desc < sizeof(page->descriptors)) {
@@ -761,21 +1274,30 @@ blob_parse_page(const struct spdk_blob_md_page *page, struct spdk_blob *blob)
 			if (cluster_count == 0) {
 				return -EINVAL;
 			}
-			tmp = realloc(blob->active.clusters, cluster_count * sizeof(*blob->active.clusters));
-			if (tmp == NULL) {
-				return -ENOMEM;
+			if (blob->active.num_clusters == 0 &&
+			    blob_clusters_want_sparse(blob, cluster_count, 0)) {
+				rc = blob_clusters_set_sparse(blob, true);
+				if (rc != 0) {
+					return rc;
+				}
+			}
+			rc = blob_clusters_resize(&blob->active, cluster_count);
+			if (rc != 0) {
+				return rc;
 			}
-			blob->active.clusters = tmp;
-			blob->active.cluster_array_size = cluster_count;
 
 			for (i = 0; i < desc_extent_rle->length / sizeof(desc_extent_rle->extents[0]); i++) {
 				for (j = 0; j < desc_extent_rle->extents[i].length; j++) {
 					if (desc_extent_rle->extents[i].cluster_idx != 0) {
-						blob->active.clusters[blob->active.num_clusters++] = bs_cluster_to_lba(blob->bs,
-								desc_extent_rle->extents[i].cluster_idx + j);
+						rc = blob_set_cluster_lba(&blob->active, blob->active.num_clusters++,
+									  bs_cluster_to_lba(blob->bs,
+											  desc_extent_rle->extents[i].cluster_idx + j));
+						if (rc != 0) {
+							return rc;
+						}
 						blob->active.num_allocated_clusters++;
 					} else if (spdk_blob_is_thin_provisioned(blob)) {
-						blob->active.clusters[blob->active.num_clusters++] = 0;
+						blob->active.num_clusters++;
 					} else {
 						return -EINVAL;
 					}
@@ -823,6 +1345,14 @@ blob_parse_page(const struct spdk_blob_md_page *page, struct spdk_blob *blob)
 
 			blob->remaining_clusters_in_et = desc_extent_table->num_clusters;
 
+			if (blob->active.num_clusters == 0 &&
+			    blob_clusters_want_sparse(blob, desc_extent_table->num_clusters, 0)) {
+				rc = blob_clusters_set_sparse(blob, true);
+				if (rc != 0) {
+					return rc;
+				}
+			}
+
 			/* Extent table entries contain md page numbers for extent pages.
 			 * Zeroes represent unallocated extent pages, those are run-length-encoded.
 			 */
@@ -879,21 +1409,21 @@ blob_parse_page(const struct spdk_blob_md_page *page, struct spdk_blob *blob)
 				return -EINVAL;
 			}
 
-			tmp = realloc(blob->active.clusters,
-				      (cluster_count + blob->active.num_clusters) * sizeof(*blob->active.clusters));
-			if (tmp == NULL) {
-				return -ENOMEM;
+			rc = blob_clusters_resize(&blob->active, cluster_count + blob->active.num_clusters);
+			if (rc != 0) {
+				return rc;
 			}
-			blob->active.clusters = tmp;
-			blob->active.cluster_array_size = (cluster_count + blob->active.num_clusters);
 
 			for (i = 0; i < cluster_idx_length / sizeof(desc_extent->cluster_idx[0]); i++) {
 				if (desc_extent->cluster_idx[i] != 0) {
-					blob->active.clusters[blob->active.num_clusters++] = bs_cluster_to_lba(blob->bs,
-							desc_extent->cluster_idx[i]);
+					rc = blob_set_cluster_lba(&blob->active, blob->active.num_clusters++,
+								  bs_cluster_to_lba(blob->bs, desc_extent->cluster_idx[i]));
+					if (rc != 0) {
+						return rc;
+					}
 					blob->active.num_allocated_clusters++;
 				} else if (spdk_blob_is_thin_provisioned(blob)) {
-					blob->active.clusters[blob->active.num_clusters++] = 0;
+					blob->active.num_clusters++;
 				} else {
 					return -EINVAL;
 				}
@@ -902,16 +1432,12 @@ blob_parse_page(const struct spdk_blob_md_page *page, struct spdk_blob *blob)
 			assert(blob->remaining_clusters_in_et >= cluster_count);
 			blob->remaining_clusters_in_et -= cluster_count;
 		} else if (desc->type == SPDK_MD_DESCRIPTOR_TYPE_XATTR) {
-			int rc;
-
 			rc = blob_deserialize_xattr(blob,
 						    (struct spdk_blob_md_descriptor_xattr *) desc, false);
 			if (rc != 0) {
 				return rc;
 			}
 		} else if (desc->type == SPDK_MD_DESCRIPTOR_TYPE_XATTR_INTERNAL) {
-			int rc;
-
 			rc = blob_deserialize_xattr(blob,
 						    (struct spdk_blob_md_descriptor_xattr *) desc, true);
 			if (rc != 0) {
@@ -965,7 +1491,7 @@ blob_parse(const struct spdk_blob_md_page *pages, uint32_t page_count,
 	assert(pages[0].sequence_num == 0);
 	assert(blob != NULL);
 	assert(blob->state == SPDK_BLOB_STATE_LOADING);
-	assert(blob->active.clusters == NULL);
+	assert(blob->active.clusters == NULL && blob->active.cluster_chunks == NULL);
 
 	/* The blobid provided doesn't match what's in the MD, this can
 	 * happen for example if a bogus blobid is passed in through open.
@@ -1002,7 +1528,9 @@ blob_parse(const struct spdk_blob_md_page *pages, uint32_t page_count,
 		}
 	}
 
-	return 0;
+	/* The flags may be parsed after the clusters, pick the representation with all known */
+	return blob_clusters_set_sparse(blob, blob_clusters_want_sparse(blob, blob->active.num_clusters,
+					blob->active.num_allocated_clusters));
 }
 
 static int
@@ -1174,7 +1702,7 @@ blob_serialize_extent_rle(const struct spdk_blob *blob,
 	struct spdk_blob_md_descriptor_extent_rle *desc_extent_rle;
 	size_t cur_sz;
 	uint64_t i, extent_idx;
-	uint64_t lba, lba_per_cluster, lba_count;
+	uint64_t lba, next_lba, lba_per_cluster, lba_count;
 
 	/* The buffer must have room for at least one extent */
 	cur_sz = sizeof(struct spdk_blob_md_descriptor) + sizeof(desc_extent_rle->extents[0]);
@@ -1190,15 +1718,16 @@ blob_serialize_extent_rle(const struct spdk_blob *blob,
 	/* Assert for scan-build false positive */
 	assert(lba_per_cluster > 0);
 
-	lba = blob->active.clusters[start_cluster];
+	lba = bs_blob_cluster_lba(&blob->active, start_cluster);
 	lba_count = lba_per_cluster;
 	extent_idx = 0;
 	for (i = start_cluster + 1; i < blob->active.num_clusters; i++) {
-		if ((lba + lba_count) == blob->active.clusters[i] && lba != 0) {
+		next_lba = bs_blob_cluster_lba(&blob->active, i);
+		if ((lba + lba_count) == next_lba && lba != 0) {
 			/* Run-length encode sequential non-zero LBA */
 			lba_count += lba_per_cluster;
 			continue;
-		} else if (lba == 0 && blob->active.clusters[i] == 0) {
+		} else if (lba == 0 && next_lba == 0) {
 			/* Run-length encode unallocated clusters */
 			lba_count += lba_per_cluster;
 			continue;
@@ -1215,7 +1744,7 @@ blob_serialize_extent_rle(const struct spdk_blob *blob,
 			break;
 		}
 
-		lba = blob->active.clusters[i];
+		lba = next_lba;
 		lba_count = lba_per_cluster;
 	}
 
@@ -1279,7 +1808,7 @@ blob_serialize_extent_page(const struct spdk_blob *blob,
 	desc_extent->start_cluster_idx = start_cluster_idx;
 	extent_idx = 0;
 	for (i = start_cluster_idx; i < blob->active.num_clusters; i++) {
-		lba = blob->active.clusters[i];
+		lba = bs_blob_cluster_lba(&blob->active, i);
 		desc_extent->cluster_idx[extent_idx++] = lba / lba_per_cluster;
 		if (extent_idx >= SPDK_EXTENTS_PER_EP) {
 			break;
@@ -1581,7 +2110,6 @@ blob_load_cpl_extents_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 	uint64_t			i;
 	uint32_t			crc;
 	uint64_t			lba;
-	void				*tmp;
 	uint64_t			sz;
 
 	if (bserrno) {
@@ -1641,15 +2169,11 @@ blob_load_cpl_extents_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 			assert(spdk_blob_is_thin_provisioned(blob));
 			assert(i + 1 < blob->active.num_extent_pages || blob->remaining_clusters_in_et == 0);
 
-			tmp = realloc(blob->active.clusters, blob->active.num_clusters * sizeof(*blob->active.clusters));
-			if (tmp == NULL) {
-				blob_load_final(ctx, -ENOMEM);
+			bserrno = blob_clusters_resize(&blob->active, blob->active.num_clusters);
+			if (bserrno != 0) {
+				blob_load_final(ctx, bserrno);
 				return;
 			}
-			memset(tmp + sizeof(*blob->active.clusters) * blob->active.cluster_array_size, 0,
-			       sizeof(*blob->active.clusters) * (blob->active.num_clusters - blob->active.cluster_array_size));
-			blob->active.clusters = tmp;
-			blob->active.cluster_array_size = blob->active.num_clusters;
 		}
 	}
 
@@ -1992,31 +2516,17 @@ blob_persist_clear_clusters_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserr
 	spdk_spin_lock(&bs->used_lock);
 	/* Release all clusters that were truncated */
 	for (i = blob->active.num_clusters; i < blob->active.cluster_array_size; i++) {
-		uint32_t cluster_num = bs_lba_to_cluster(bs, blob->active.clusters[i]);
+		uint64_t lba = bs_blob_cluster_lba(&blob->active, i);
 
 		/* Nothing to release if it was not allocated */
-		if (blob->active.clusters[i] != 0) {
-			bs_release_cluster(bs, cluster_num);
+		if (lba != 0) {
+			bs_release_cluster(bs, bs_lba_to_cluster(bs, lba));
 		}
 	}
 	spdk_spin_unlock(&bs->used_lock);
 
-	if (blob->active.num_clusters == 0) {
-		free(blob->active.clusters);
-		blob->active.clusters = NULL;
-		blob->active.cluster_array_size = 0;
-	} else if (blob->active.num_clusters != blob->active.cluster_array_size) {
-#ifndef __clang_analyzer__
-		void *tmp;
-
-		/* scan-build really can't figure reallocs, workaround it */
-		tmp = realloc(blob->active.clusters, sizeof(*blob->active.clusters) * blob->active.num_clusters);
-		assert(tmp != NULL);
-		blob->active.clusters = tmp;
-
-#endif
-		blob->active.cluster_array_size = blob->active.num_clusters;
-	}
+	/* Shrinking the cluster map never fails */
+	blob_clusters_resize(&blob->active, blob->active.num_clusters);
 
 	/* Move on to clearing extent pages */
 	blob_persist_clear_extents(seq, ctx);
@@ -2057,12 +2567,14 @@ blob_persist_clear_clusters(spdk_bs_sequence_t *seq, struct spdk_blob_persist_ct
 	lba = 0;
 	lba_count = 0;
 
-	if (blob->active.cluster_array_size > blob->active.num_clusters) {
+	/* Sparse cluster maps are not sorted, they are cleared in cluster order */
+	if (blob->active.cluster_array_size > blob->active.num_clusters &&
+	    blob->active.cluster_chunks == NULL) {
 		qsort(&blob->active.clusters[blob->active.num_clusters],
 		      blob->active.cluster_array_size - blob->active.num_clusters, sizeof(uint64_t), lba_cmp);
 	}
 	for (i = blob->active.num_clusters; i < blob->active.cluster_array_size; i++) {
-		uint64_t next_lba = blob->active.clusters[i];
+		uint64_t next_lba = bs_blob_cluster_lba(&blob->active, i);
 		uint64_t next_lba_count = bs_cluster_to_lba(bs, 1);
 
 		if (next_lba > 0 && (lba + lba_count) == next_lba) {
@@ -2246,7 +2758,6 @@ static int
 blob_resize(struct spdk_blob *blob, uint64_t sz)
 {
 	uint64_t	i;
-	uint64_t	*tmp;
 	uint64_t	cluster;
 	uint32_t	lfmd; /*  lowest free md page */
 	uint64_t	num_clusters;
@@ -2289,7 +2800,7 @@ blob_resize(struct spdk_blob *blob, uint64_t sz)
 	 */
 	if (sz > num_clusters && spdk_blob_is_thin_provisioned(blob) == false) {
 		spdk_spin_lock(&bs->used_lock);
-		if ((sz - num_clusters) > bs->num_free_clusters) {
+		if ((sz - num_clusters) > bs_num_free_clusters_locked(bs, sz - num_clusters)) {
 			rc = -ENOSPC;
 			goto out;
 		}
@@ -2305,18 +2816,22 @@ blob_resize(struct spdk_blob *blob, uint64_t sz)
 	}
 
 	if (sz > num_clusters) {
+		/* Thick provisioned blobs insert the new clusters below, which requires a flat map.
+		 * Growing a thin provisioned blob may make a sparse map worthwhile.
+		 */
+		rc = blob_clusters_set_sparse(blob, blob_clusters_want_sparse(blob, sz,
+					      blob->active.num_allocated_clusters));
+		if (rc != 0) {
+			goto out;
+		}
+
 		/* Expand the cluster array if necessary.
 		 * We only shrink the array when persisting.
 		 */
-		tmp = realloc(blob->active.clusters, sizeof(*blob->active.clusters) * sz);
-		if (sz > 0 && tmp == NULL) {
-			rc = -ENOMEM;
+		rc = blob_clusters_resize(&blob->active, sz);
+		if (rc != 0) {
 			goto out;
 		}
-		memset(tmp + blob->active.cluster_array_size, 0,
-		       sizeof(*blob->active.clusters) * (sz - blob->active.cluster_array_size));
-		blob->active.clusters = tmp;
-		blob->active.cluster_array_size = sz;
 
 		/* Expand the extents table, only if enough clusters were added */
 		if (new_num_ep > current_num_ep && blob->use_extent_table) {
@@ -2350,7 +2865,7 @@ blob_resize(struct spdk_blob *blob, uint64_t sz)
 
 	/* If we are shrinking the blob, we must adjust num_allocated_clusters */
 	for (i = sz; i < num_clusters; i++) {
-		if (blob->active.clusters[i] != 0) {
+		if (bs_blob_cluster_lba(&blob->active, i) != 0) {
 			blob->active.num_allocated_clusters--;
 		}
 	}
@@ -2898,10 +3413,8 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 		}
 	}
 
-	spdk_spin_lock(&blob->bs->used_lock);
-	rc = bs_allocate_cluster(blob, cluster_number, &ctx->new_cluster, &ctx->new_extent_page,
-				 false);
-	spdk_spin_unlock(&blob->bs->used_lock);
+	rc = bs_channel_allocate_cluster(ch, blob, cluster_number, &ctx->new_cluster,
+					 &ctx->new_extent_page);
 	if (rc != 0) {
 		spdk_free(ctx->buf);
 		free(ctx);
@@ -3665,10 +4178,27 @@ bs_channel_create(void *io_device, void *ctx_buf)
 		return -1;
 	}
 
+	if (bs->cluster_reserve_batch != 0) {
+		channel->reserved_clusters = calloc(bs->cluster_reserve_batch,
+						    sizeof(*channel->reserved_clusters));
+		if (!channel->reserved_clusters) {
+			SPDK_ERRLOG("Failed to allocate reserved clusters array\n");
+			spdk_free(channel->release_cluster_page);
+			spdk_free(channel->new_cluster_page);
+			free(channel->req_mem);
+			channel->dev->destroy_channel(channel->dev, channel->dev_channel);
+			return -1;
+		}
+	}
+
 	TAILQ_INIT(&channel->need_cluster_alloc);
 	TAILQ_INIT(&channel->queued_io);
 	RB_INIT(&channel->esnap_channels);
 
+	spdk_spin_lock(&bs->used_lock);
+	TAILQ_INSERT_TAIL(&bs->channels, channel, link);
+	spdk_spin_unlock(&bs->used_lock);
+
 	return 0;
 }
 
@@ -3692,6 +4222,12 @@ bs_channel_destroy(void *io_device, void *ctx_buf)
 
 	blob_esnap_destroy_bs_channel(channel);
 
+	spdk_spin_lock(&channel->bs->used_lock);
+	TAILQ_REMOVE(&channel->bs->channels, channel, link);
+	bs_channel_release_reserved_clusters_locked(channel);
+	spdk_spin_unlock(&channel->bs->used_lock);
+	free(channel->reserved_clusters);
+
 	free(channel->req_mem);
 	spdk_free(channel->new_cluster_page);
 	spdk_free(channel->release_cluster_page);
@@ -3863,6 +4399,7 @@ spdk_bs_opts_init(struct spdk_bs_opts *opts, size_t opts_size)
 	SET_FIELD(force_recover, false);
 	SET_FIELD(esnap_bs_dev_create, NULL);
 	SET_FIELD(esnap_ctx, NULL);
+	SET_FIELD(cluster_reserve_batch, SPDK_BLOB_OPTS_CLUSTER_RESERVE_BATCH);
 
 #undef FIELD_OK
 #undef SET_FIELD
@@ -3913,6 +4450,9 @@ struct spdk_bs_load_ctx {
 
 	bool					force_recover;
 
+	/* Channel cluster reservation batch to restore if the unload fails */
+	uint32_t				cluster_reserve_batch;
+
 	/* These fields are used in the spdk_bs_dump path. */
 	bool					dumping;
 	FILE					*fp;
@@ -4009,6 +4549,7 @@ bs_alloc(struct spdk_bs_dev *dev, struct spdk_bs_opts *opts, struct spdk_blob_st
 	bs_init_per_cluster_fields(bs);
 
 	bs->max_channel_ops = opts->max_channel_ops;
+	bs->cluster_reserve_batch = opts->cluster_reserve_batch;
 	bs->super_blob = SPDK_BLOBID_INVALID;
 	memcpy(&bs->bstype, &opts->bstype, sizeof(opts->bstype));
 	bs->esnap_bs_dev_create = opts->esnap_bs_dev_create;
@@ -4020,6 +4561,7 @@ bs_alloc(struct spdk_bs_dev *dev, struct spdk_bs_opts *opts, struct spdk_blob_st
 	bs->open_blobids = spdk_bit_array_create(0);
 
 	spdk_spin_init(&bs->used_lock);
+	TAILQ_INIT(&bs->channels);
 
 	spdk_io_device_register(bs, bs_channel_create, bs_channel_destroy,
 				sizeof(struct spdk_bs_channel), "blobstore");
@@ -4218,9 +4760,7 @@ bs_delete_corrupted_blob(void *cb_arg, int bserrno)
 	 * at this point. Let's clear both for snapshot now,
 	 * so that it won't be cleared for clone later when we remove snapshot.
 	 * Also set thin provision to pass data corruption check */
-	for (i = 0; i < ctx->blob->active.num_clusters; i++) {
-		ctx->blob->active.clusters[i] = 0;
-	}
+	blob_clusters_clear(&ctx->blob->active);
 	for (i = 0; i < ctx->blob->active.num_extent_pages; i++) {
 		ctx->blob->active.extent_pages[i] = 0;
 	}
@@ -5061,12 +5601,13 @@ bs_opts_copy(struct spdk_bs_opts *src, struct spdk_bs_opts *dst)
 	SET_FIELD(force_recover);
 	SET_FIELD(esnap_bs_dev_create);
 	SET_FIELD(esnap_ctx);
+	SET_FIELD(cluster_reserve_batch);
 
 	dst->opts_size = src->opts_size;
 
 	/* You should not remove this statement, but need to update the assert statement
 	 * if you add a new field, and also add a corresponding SET_FIELD statement */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_opts) == 88, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_opts) == 92, "Incorrect size");
 
 #undef FIELD_OK
 #undef SET_FIELD
@@ -5835,6 +6376,13 @@ bs_unload_finish(struct spdk_bs_load_ctx *ctx, int bserrno)
 	spdk_bs_sequence_t *seq = ctx->seq;
 	struct spdk_blob_store *bs = ctx->bs;
 
+	if (bserrno != 0) {
+		/* The blobstore stays loaded, let the channels reserve clusters again */
+		spdk_spin_lock(&bs->used_lock);
+		bs->cluster_reserve_batch = ctx->cluster_reserve_batch;
+		spdk_spin_unlock(&bs->used_lock);
+	}
+
 	spdk_free(ctx->super);
 	free(ctx);
 
@@ -5999,6 +6547,16 @@ spdk_bs_unload(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_a
 		return;
 	}
 
+	/*
+	 * Return the clusters reserved by all the channels before used clusters are persisted
+	 * and make sure no more are reserved.
+	 */
+	spdk_spin_lock(&bs->used_lock);
+	ctx->cluster_reserve_batch = bs->cluster_reserve_batch;
+	bs->cluster_reserve_batch = 0;
+	bs_reclaim_reserved_clusters(bs);
+	spdk_spin_unlock(&bs->used_lock);
+
 	/* Read super block */
 	bs_sequence_read_dev(ctx->seq, ctx->super, bs_page_to_lba(bs, 0),
 			     bs_byte_to_lba(bs, sizeof(*ctx->super)),
@@ -6154,7 +6712,8 @@ spdk_bs_get_io_unit_size(struct spdk_blob_store *bs)
 uint64_t
 spdk_bs_free_cluster_count(struct spdk_blob_store *bs)
 {
-	return bs->num_free_clusters;
+	/* Clusters reserved by the channels are not allocated to any blob yet */
+	return bs->num_free_clusters + __atomic_load_n(&bs->num_reserved_clusters, __ATOMIC_RELAXED);
 }
 
 uint64_t
@@ -6584,6 +7143,8 @@ static void
 bs_snapshot_swap_cluster_maps(struct spdk_blob *blob1, struct spdk_blob *blob2)
 {
 	uint64_t *cluster_temp;
+	uint64_t **cluster_chunks_temp;
+	size_t cluster_array_size_temp;
 	uint64_t num_allocated_clusters_temp;
 	uint32_t *extent_page_temp;
 
@@ -6591,6 +7152,14 @@ bs_snapshot_swap_cluster_maps(struct spdk_blob *blob1, struct spdk_blob *blob2)
 	blob1->active.clusters = blob2->active.clusters;
 	blob2->active.clusters = cluster_temp;
 
+	cluster_chunks_temp = blob1->active.cluster_chunks;
+	blob1->active.cluster_chunks = blob2->active.cluster_chunks;
+	blob2->active.cluster_chunks = cluster_chunks_temp;
+
+	cluster_array_size_temp = blob1->active.cluster_array_size;
+	blob1->active.cluster_array_size = blob2->active.cluster_array_size;
+	blob2->active.cluster_array_size = cluster_array_size_temp;
+
 	num_allocated_clusters_temp = blob1->active.num_allocated_clusters;
 	blob1->active.num_allocated_clusters = blob2->active.num_allocated_clusters;
 	blob2->active.num_allocated_clusters = num_allocated_clusters_temp;
@@ -6670,8 +7239,7 @@ bs_snapshot_newblob_sync_cpl(void *cb_arg, int bserrno)
 		 * Since I/O is frozen on origblob, not changes to zeroed out cluster map should have occurred.
 		 * Newblob needs to be reverted to thin_provisioned state at creation to properly close. */
 		blob_set_thin_provision(newblob);
-		assert(spdk_mem_all_zero(newblob->active.clusters,
-					 newblob->active.num_clusters * sizeof(*newblob->active.clusters)));
+		assert(blob_clusters_all_zero(&newblob->active));
 		assert(spdk_mem_all_zero(newblob->active.extent_pages,
 					 newblob->active.num_extent_pages * sizeof(*newblob->active.extent_pages)));
 
@@ -6804,8 +7372,7 @@ bs_snapshot_newblob_open_cpl(void *cb_arg, struct spdk_blob *_blob, int bserrno)
 
 	ctx->new.blob = newblob;
 	assert(spdk_blob_is_thin_provisioned(newblob));
-	assert(spdk_mem_all_zero(newblob->active.clusters,
-				 newblob->active.num_clusters * sizeof(*newblob->active.clusters)));
+	assert(blob_clusters_all_zero(&newblob->active));
 	assert(spdk_mem_all_zero(newblob->active.extent_pages,
 				 newblob->active.num_extent_pages * sizeof(*newblob->active.extent_pages)));
 
@@ -7117,7 +7684,7 @@ bs_cluster_needs_allocation(struct spdk_blob *blob, uint64_t cluster, bool alloc
 
 	assert(blob != NULL);
 
-	if (blob->active.clusters[cluster] != 0) {
+	if (bs_blob_cluster_lba(&blob->active, cluster) != 0) {
 		/* Cluster is already allocated */
 		return false;
 	}
@@ -7132,7 +7699,7 @@ bs_cluster_needs_allocation(struct spdk_blob *blob, uint64_t cluster, bool alloc
 	}
 
 	b = (struct spdk_blob_bs_dev *)blob->back_bs_dev;
-	return (allocate_all || b->blob->active.clusters[cluster] != 0);
+	return (allocate_all || bs_blob_cluster_lba(&b->blob->active, cluster) != 0);
 }
 
 static void
@@ -7183,7 +7750,7 @@ static void
 bs_inflate_blob_open_cpl(void *cb_arg, struct spdk_blob *_blob, int bserrno)
 {
 	struct spdk_clone_snapshot_ctx *ctx = (struct spdk_clone_snapshot_ctx *)cb_arg;
-	uint64_t clusters_needed;
+	uint64_t clusters_needed, free_clusters;
 	uint64_t i;
 
 	if (bserrno != 0) {
@@ -7241,7 +7808,10 @@ bs_inflate_blob_open_cpl(void *cb_arg, struct spdk_blob *_blob, int bserrno)
 		}
 	}
 
-	if (clusters_needed > _blob->bs->num_free_clusters) {
+	spdk_spin_lock(&_blob->bs->used_lock);
+	free_clusters = bs_num_free_clusters_locked(_blob->bs, clusters_needed);
+	spdk_spin_unlock(&_blob->bs->used_lock);
+	if (clusters_needed > free_clusters) {
 		/* Not enough free clusters. Cannot satisfy the request. */
 		bs_clone_snapshot_origblob_cleanup(ctx, -ENOSPC);
 		return;
@@ -7396,7 +7966,7 @@ bs_shallow_copy_cluster_find_next(void *cb_arg)
 	struct spdk_blob *_blob = ctx->blob;
 
 	while (ctx->cluster < _blob->active.num_clusters) {
-		if (_blob->active.clusters[ctx->cluster] != 0) {
+		if (bs_blob_cluster_lba(&_blob->active, ctx->cluster) != 0) {
 			break;
 		}
 
@@ -8190,7 +8760,7 @@ static void
 delete_snapshot_sync_clone_cpl(void *cb_arg, int bserrno)
 {
 	struct delete_snapshot_ctx *ctx = cb_arg;
-	uint64_t i;
+	uint64_t i, lba;
 
 	ctx->snapshot->md_ro = false;
 
@@ -8211,11 +8781,11 @@ delete_snapshot_sync_clone_cpl(void *cb_arg, int bserrno)
 
 	/* Clear cluster map entries for snapshot */
 	for (i = 0; i < ctx->snapshot->active.num_clusters && i < ctx->clone->active.num_clusters; i++) {
-		if (ctx->clone->active.clusters[i] == ctx->snapshot->active.clusters[i]) {
-			if (ctx->snapshot->active.clusters[i] != 0) {
-				ctx->snapshot->active.num_allocated_clusters--;
-			}
-			ctx->snapshot->active.clusters[i] = 0;
+		lba = bs_blob_cluster_lba(&ctx->snapshot->active, i);
+		if (lba != 0 && bs_blob_cluster_lba(&ctx->clone->active, i) == lba) {
+			ctx->snapshot->active.num_allocated_clusters--;
+			/* Clearing an allocated entry never fails */
+			blob_set_cluster_lba(&ctx->snapshot->active, i, 0);
 		}
 	}
 	for (i = 0; i < ctx->snapshot->active.num_extent_pages &&
@@ -8319,7 +8889,7 @@ static void
 delete_snapshot_sync_snapshot_xattr_cpl(void *cb_arg, int bserrno)
 {
 	struct delete_snapshot_ctx *ctx = cb_arg;
-	uint64_t i;
+	uint64_t i, lba;
 
 	/* Temporarily override md_ro flag for clone for MD modification */
 	ctx->clone_md_ro = ctx->clone->md_ro;
@@ -8332,13 +8902,23 @@ delete_snapshot_sync_snapshot_xattr_cpl(void *cb_arg, int bserrno)
 		return;
 	}
 
+	/* Make sure the clone map has room for all the clusters first, so that the copy can't
+	 * fail halfway through. */
+	for (i = 0; i < ctx->snapshot->active.num_clusters && i < ctx->clone->active.num_clusters; i++) {
+		if (bs_blob_cluster_lba(&ctx->snapshot->active, i) != 0 &&
+		    blob_cluster_lba_ptr(&ctx->clone->active, i) == NULL) {
+			ctx->bserrno = -ENOMEM;
+			delete_snapshot_cleanup_clone(ctx, 0);
+			return;
+		}
+	}
+
 	/* Copy snapshot map to clone map (only unallocated clusters in clone) */
 	for (i = 0; i < ctx->snapshot->active.num_clusters && i < ctx->clone->active.num_clusters; i++) {
-		if (ctx->clone->active.clusters[i] == 0) {
-			ctx->clone->active.clusters[i] = ctx->snapshot->active.clusters[i];
-			if (ctx->clone->active.clusters[i] != 0) {
-				ctx->clone->active.num_allocated_clusters++;
-			}
+		lba = bs_blob_cluster_lba(&ctx->snapshot->active, i);
+		if (lba != 0 && bs_blob_cluster_lba(&ctx->clone->active, i) == 0) {
+			*blob_cluster_lba_ptr(&ctx->clone->active, i) = lba;
+			ctx->clone->active.num_allocated_clusters++;
 		}
 	}
 	ctx->next_extent_page = 0;
@@ -9033,7 +9613,8 @@ blob_free_cluster_msg(void *arg)
 	struct spdk_blob_cluster_op_ctx *ctx = arg;
 	uint32_t *extent_page;
 
-	ctx->cluster = bs_lba_to_cluster(ctx->blob->bs, ctx->blob->active.clusters[ctx->cluster_num]);
+	ctx->cluster = bs_lba_to_cluster(ctx->blob->bs,
+					 bs_blob_cluster_lba(&ctx->blob->active, ctx->cluster_num));
 
 	/* There were concurrent unmaps to the same cluster, only release the cluster on the first one */
 	if (ctx->cluster == 0) {
@@ -9041,7 +9622,7 @@ blob_free_cluster_msg(void *arg)
 		return;
 	}
 
-	ctx->blob->active.clusters[ctx->cluster_num] = 0;
+	blob_set_cluster_lba(&ctx->blob->active, ctx->cluster_num, 0);
 	if (ctx->cluster != 0) {
 		ctx->blob->active.num_allocated_clusters--;
 	}
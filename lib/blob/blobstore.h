@@ -25,8 +25,20 @@
 #define SPDK_BLOB_OPTS_NUM_MD_PAGES UINT32_MAX
 #define SPDK_BLOB_OPTS_MAX_MD_OPS 32
 #define SPDK_BLOB_OPTS_DEFAULT_CHANNEL_OPS 512
+#define SPDK_BLOB_OPTS_CLUSTER_RESERVE_BATCH 16
+/* Channels reserve clusters only while there are this many times the batch size free clusters */
+#define SPDK_BS_CLUSTER_RESERVE_MIN_FREE_RATIO 64
 #define SPDK_BLOB_BLOBID_HIGH_BIT (1ULL << 32)
 
+/*
+ * Sparse cluster maps keep the cluster LBAs in chunks of this many entries, allocated only
+ * for the chunks that contain allocated clusters.
+ */
+#define SPDK_BLOB_CLUSTER_CHUNK_SHIFT 9
+#define SPDK_BLOB_CLUSTER_CHUNK_SIZE (1ULL << SPDK_BLOB_CLUSTER_CHUNK_SHIFT)
+/* Thin provisioned blobs with at least this many clusters may use a sparse cluster map */
+#define SPDK_BLOB_SPARSE_MIN_CLUSTERS (16 * SPDK_BLOB_CLUSTER_CHUNK_SIZE)
+
 struct spdk_xattr {
 	uint32_t	index;
 	uint16_t	value_len;
@@ -43,11 +55,19 @@ struct spdk_blob_mut_data {
 	uint64_t	num_clusters;
 
 	/* Array LBAs that are the beginning of a cluster, in
-	 * the order they appear in the blob.
+	 * the order they appear in the blob. Only used if
+	 * 'cluster_chunks' is NULL.
 	 */
 	uint64_t	*clusters;
 
-	/* The size of the clusters array. This is greater than or
+	/* Sparse alternative to 'clusters'. Chunk i holds the LBAs
+	 * of clusters starting at i * SPDK_BLOB_CLUSTER_CHUNK_SIZE
+	 * and is NULL if none of them is allocated. The table itself
+	 * is allocated even if the map is empty.
+	 */
+	uint64_t	**cluster_chunks;
+
+	/* The size of the cluster map. This is greater than or
 	 * equal to 'num_clusters'.
 	 */
 	size_t		cluster_array_size;
@@ -176,6 +196,10 @@ struct spdk_blob_store {
 	uint64_t			total_clusters;
 	uint64_t			total_data_clusters;
 	uint64_t			num_free_clusters;	/* Protected by used_lock */
+	/* Clusters claimed by the channels but not allocated yet, updated atomically */
+	uint64_t			num_reserved_clusters;
+	uint32_t			cluster_reserve_batch;
+	TAILQ_HEAD(, spdk_bs_channel)	channels;		/* Protected by used_lock */
 	uint64_t			pages_per_cluster;
 	uint64_t			io_units_per_cluster;
 	uint8_t				pages_per_cluster_shift;
@@ -224,6 +248,19 @@ struct spdk_bs_channel {
 	struct spdk_blob_md_page        *release_cluster_page;
 
 	RB_HEAD(blob_esnap_channel_tree, blob_esnap_channel) esnap_channels;
+
+	/*
+	 * Clusters claimed from the blobstore for allocation on this channel without taking
+	 * used_lock. The valid entries are described by reserved_range, which packs the index of
+	 * the first one and their count. The channel takes them from the front, while other
+	 * threads holding used_lock may take them all back when the blobstore runs out of space.
+	 */
+	uint32_t			*reserved_clusters;
+	uint64_t			reserved_range;
+	bool				reserve_clusters_pending;
+
+	/* Entry on the blobstore's list of channels, protected by used_lock */
+	TAILQ_ENTRY(spdk_bs_channel)	link;
 };
 
 /** operation type */
@@ -577,6 +614,25 @@ bs_page_to_blobid(uint64_t page_idx)
 	return SPDK_BLOB_BLOBID_HIGH_BIT | page_idx;
 }
 
+/* Look up the LBA of a cluster in the cluster map, 0 if it is not allocated. */
+static inline uint64_t
+bs_blob_cluster_lba(const struct spdk_blob_mut_data *data, uint64_t cluster_num)
+{
+	const uint64_t *chunk;
+
+	assert(cluster_num < data->cluster_array_size);
+	if (data->cluster_chunks == NULL) {
+		return data->clusters[cluster_num];
+	}
+
+	chunk = data->cluster_chunks[cluster_num >> SPDK_BLOB_CLUSTER_CHUNK_SHIFT];
+	if (chunk == NULL) {
+		return 0;
+	}
+
+	return chunk[cluster_num & (SPDK_BLOB_CLUSTER_CHUNK_SIZE - 1)];
+}
+
 /* Given an io unit offset into a blob, look up the LBA for the
  * start of that io unit.
  */
@@ -590,9 +646,9 @@ bs_blob_io_unit_to_lba(struct spdk_blob *blob, uint64_t io_unit)
 	shift = blob->bs->io_units_per_cluster_shift;
 	assert(io_unit < blob->active.num_clusters * io_units_per_cluster);
 	if (shift != 0) {
-		lba = blob->active.clusters[io_unit >> shift];
+		lba = bs_blob_cluster_lba(&blob->active, io_unit >> shift);
 	} else {
-		lba = blob->active.clusters[io_unit / io_units_per_cluster];
+		lba = bs_blob_cluster_lba(&blob->active, io_unit / io_units_per_cluster);
 	}
 	if (lba == 0) {
 		return 0;
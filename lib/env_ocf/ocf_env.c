@@ -9,6 +9,7 @@
 #include "spdk/crc32.h"
 #include "spdk/env.h"
 #include "spdk/log.h"
+#include "spdk/queue.h"
 
 /* Number of buffers for mempool
  * Need to be power of two - 1 for better memory utilization
@@ -104,6 +105,142 @@ env_allocator_destroy(env_allocator *allocator)
 		env_free(allocator);
 	}
 }
+/* *** LOCKS *** */
+
+/* Waiters double their spin up to this many pauses... */
+#define ENV_LOCK_BACKOFF_MAX	1024
+/* ...and start yielding the CPU after this many rounds of the longest spin */
+#define ENV_LOCK_YIELD_ROUNDS	64
+
+struct env_lock_thread {
+	struct env_lock_stats		stats[ENV_LOCK_TYPE_MAX];
+	TAILQ_ENTRY(env_lock_thread)	link;
+};
+
+__thread struct env_lock_stats *env_lock_thread_stats;
+
+/* Used by threads that failed to allocate their own statistics */
+static struct env_lock_stats g_env_lock_shared_stats[ENV_LOCK_TYPE_MAX];
+static TAILQ_HEAD(, env_lock_thread) g_env_lock_threads =
+	TAILQ_HEAD_INITIALIZER(g_env_lock_threads);
+static pthread_mutex_t g_env_lock_threads_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+struct env_lock_stats *
+env_lock_register_thread(void)
+{
+	struct env_lock_thread *thread;
+
+	/* Statistics outlive their thread, so the totals don't go down when a thread exits */
+	thread = calloc(1, sizeof(*thread));
+	if (thread == NULL) {
+		env_lock_thread_stats = g_env_lock_shared_stats;
+		return env_lock_thread_stats;
+	}
+
+	pthread_mutex_lock(&g_env_lock_threads_mutex);
+	TAILQ_INSERT_TAIL(&g_env_lock_threads, thread, link);
+	pthread_mutex_unlock(&g_env_lock_threads_mutex);
+
+	env_lock_thread_stats = thread->stats;
+	return env_lock_thread_stats;
+}
+
+static void
+env_lock_add_stats(struct env_lock_stats *total, const struct env_lock_stats *stats)
+{
+	total->shared += stats->shared;
+	total->exclusive += stats->exclusive;
+	total->contended += stats->contended;
+	total->wait_ticks += stats->wait_ticks;
+	total->hold_ticks += stats->hold_ticks;
+}
+
+void
+env_lock_get_stats(struct env_lock_stats stats[ENV_LOCK_TYPE_MAX])
+{
+	struct env_lock_thread *thread;
+	int i;
+
+	memset(stats, 0, sizeof(*stats) * ENV_LOCK_TYPE_MAX);
+
+	pthread_mutex_lock(&g_env_lock_threads_mutex);
+	TAILQ_FOREACH(thread, &g_env_lock_threads, link) {
+		for (i = 0; i < ENV_LOCK_TYPE_MAX; i++) {
+			env_lock_add_stats(&stats[i], &thread->stats[i]);
+		}
+	}
+	pthread_mutex_unlock(&g_env_lock_threads_mutex);
+
+	for (i = 0; i < ENV_LOCK_TYPE_MAX; i++) {
+		env_lock_add_stats(&stats[i], &g_env_lock_shared_stats[i]);
+	}
+}
+
+struct env_lock_backoff {
+	uint32_t spins;
+	uint32_t rounds;
+};
+
+static void
+env_lock_backoff(struct env_lock_backoff *backoff)
+{
+	uint32_t i;
+
+	if (backoff->rounds >= ENV_LOCK_YIELD_ROUNDS) {
+		/* The holder may have been preempted, let it run */
+		sched_yield();
+		return;
+	}
+
+	backoff->spins = spdk_min(spdk_max(backoff->spins * 2, 1), ENV_LOCK_BACKOFF_MAX);
+	if (backoff->spins == ENV_LOCK_BACKOFF_MAX) {
+		backoff->rounds++;
+	}
+
+	for (i = 0; i < backoff->spins; i++) {
+		spdk_pause();
+	}
+}
+
+static void
+env_lock_contended(enum env_lock_type type, uint64_t start_ticks)
+{
+	struct env_lock_stats *stats = env_lock_get_thread_stats(type);
+
+	stats->contended++;
+	stats->wait_ticks += spdk_get_ticks() - start_ticks;
+}
+
+void
+env_lock_read_wait(struct env_lock *l, enum env_lock_type type)
+{
+	struct env_lock_backoff backoff = {};
+	uint64_t start_ticks = spdk_get_ticks();
+
+	do {
+		env_lock_backoff(&backoff);
+	} while (!_env_lock_read_trylock(l));
+
+	env_lock_contended(type, start_ticks);
+}
+
+void
+env_lock_write_wait(struct env_lock *l, enum env_lock_type type)
+{
+	struct env_lock_backoff backoff = {};
+	uint64_t start_ticks = spdk_get_ticks();
+
+	do {
+		if (type == ENV_LOCK_RWLOCK) {
+			/* Keep new readers out until the current ones are done */
+			__atomic_fetch_or(&l->state, ENV_LOCK_WRITER_PENDING, __ATOMIC_RELAXED);
+		}
+		env_lock_backoff(&backoff);
+	} while (!_env_lock_write_trylock(l));
+
+	env_lock_contended(type, start_ticks);
+}
+
 /* *** CRC *** */
 
 uint32_t
@@ -181,22 +181,200 @@ void env_allocator_del(env_allocator *allocator, void *item);
 
 uint32_t env_allocator_item_count(env_allocator *allocator);
 
+/* *** LOCKS *** */
+
+/* OCF runs on reactor threads, so mutexes and reader-writer locks spin instead of sleeping in
+ * the kernel. Waiters back off exponentially and only yield the CPU after spinning for a while.
+ * Like the pthread locks they replace, rw semaphores prefer readers over waiting writers, as OCF
+ * takes them recursively for reading. A writer waiting for a rwlock marks it pending instead,
+ * which keeps new readers out, so that a steady stream of readers cannot starve it. */
+
+#define ENV_LOCK_WRITER		(1U << 31)
+#define ENV_LOCK_WRITER_PENDING	(1U << 30)
+#define ENV_LOCK_READERS_MASK	(ENV_LOCK_WRITER_PENDING - 1)
+
+enum env_lock_type {
+	ENV_LOCK_MUTEX,
+	ENV_LOCK_RWSEM,
+	ENV_LOCK_RWLOCK,
+	ENV_LOCK_TYPE_MAX,
+};
+
+struct env_lock_stats {
+	/* Shared and exclusive acquisitions */
+	uint64_t shared;
+	uint64_t exclusive;
+	/* Acquisitions that found the lock held and had to wait */
+	uint64_t contended;
+	/* Ticks spent waiting for the lock and holding it exclusively */
+	uint64_t wait_ticks;
+	uint64_t hold_ticks;
+};
+
+/* Statistics of the calling thread, indexed by enum env_lock_type */
+extern __thread struct env_lock_stats *env_lock_thread_stats;
+
+struct env_lock_stats *env_lock_register_thread(void);
+
+/* Sum of the statistics of all threads that took a lock */
+void env_lock_get_stats(struct env_lock_stats stats[ENV_LOCK_TYPE_MAX]);
+
+struct env_lock {
+	/* ENV_LOCK_WRITER when held exclusively, number of readers otherwise, with
+	 * ENV_LOCK_WRITER_PENDING set while a writer waits for a rwlock */
+	uint32_t state;
+	/* Tick count of the exclusive acquisition */
+	uint64_t lock_ticks;
+};
+
+void env_lock_read_wait(struct env_lock *l, enum env_lock_type type);
+void env_lock_write_wait(struct env_lock *l, enum env_lock_type type);
+
+static inline struct env_lock_stats *
+env_lock_get_thread_stats(enum env_lock_type type)
+{
+	struct env_lock_stats *stats = env_lock_thread_stats;
+
+	if (spdk_unlikely(stats == NULL)) {
+		stats = env_lock_register_thread();
+	}
+
+	return &stats[type];
+}
+
+static inline void
+env_lock_init(struct env_lock *l)
+{
+	__atomic_store_n(&l->state, 0, __ATOMIC_RELAXED);
+	l->lock_ticks = 0;
+}
+
+static inline bool
+env_lock_is_locked(struct env_lock *l)
+{
+	return (__atomic_load_n(&l->state, __ATOMIC_RELAXED) & ~ENV_LOCK_WRITER_PENDING) != 0;
+}
+
+static inline bool
+_env_lock_read_trylock(struct env_lock *l)
+{
+	uint32_t state = __atomic_load_n(&l->state, __ATOMIC_RELAXED);
+
+	do {
+		if (state & (ENV_LOCK_WRITER | ENV_LOCK_WRITER_PENDING)) {
+			return false;
+		}
+	} while (!__atomic_compare_exchange_n(&l->state, &state, state + 1, true,
+					      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+	return true;
+}
+
+static inline bool
+_env_lock_write_trylock(struct env_lock *l)
+{
+	uint32_t state = __atomic_load_n(&l->state, __ATOMIC_RELAXED);
+
+	/* Acquiring the lock clears the pending flag of the waiting writer */
+	do {
+		if (state & ~ENV_LOCK_WRITER_PENDING) {
+			return false;
+		}
+	} while (!__atomic_compare_exchange_n(&l->state, &state, ENV_LOCK_WRITER, true,
+					      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+	return true;
+}
+
+static inline void
+env_lock_read_locked(struct env_lock *l, enum env_lock_type type)
+{
+	env_lock_get_thread_stats(type)->shared++;
+}
+
+static inline void
+env_lock_write_locked(struct env_lock *l, enum env_lock_type type)
+{
+	env_lock_get_thread_stats(type)->exclusive++;
+	l->lock_ticks = spdk_get_ticks();
+}
+
+static inline void
+env_lock_read(struct env_lock *l, enum env_lock_type type)
+{
+	if (spdk_unlikely(!_env_lock_read_trylock(l))) {
+		env_lock_read_wait(l, type);
+	}
+
+	env_lock_read_locked(l, type);
+}
+
+static inline int
+env_lock_read_trylock(struct env_lock *l, enum env_lock_type type)
+{
+	if (!_env_lock_read_trylock(l)) {
+		return -OCF_ERR_NO_LOCK;
+	}
+
+	env_lock_read_locked(l, type);
+	return 0;
+}
+
+static inline void
+env_lock_read_unlock(struct env_lock *l)
+{
+	uint32_t state = __atomic_fetch_sub(&l->state, 1, __ATOMIC_RELEASE);
+
+	ENV_BUG_ON((state & ENV_LOCK_READERS_MASK) == 0);
+}
+
+static inline void
+env_lock_write(struct env_lock *l, enum env_lock_type type)
+{
+	if (spdk_unlikely(!_env_lock_write_trylock(l))) {
+		env_lock_write_wait(l, type);
+	}
+
+	env_lock_write_locked(l, type);
+}
+
+static inline int
+env_lock_write_trylock(struct env_lock *l, enum env_lock_type type)
+{
+	if (!_env_lock_write_trylock(l)) {
+		return -OCF_ERR_NO_LOCK;
+	}
+
+	env_lock_write_locked(l, type);
+	return 0;
+}
+
+static inline void
+env_lock_write_unlock(struct env_lock *l, enum env_lock_type type)
+{
+	env_lock_get_thread_stats(type)->hold_ticks += spdk_get_ticks() - l->lock_ticks;
+	/* Another writer may have marked the lock pending meanwhile, keep the flag */
+	ENV_BUG_ON((__atomic_fetch_and(&l->state, ~ENV_LOCK_WRITER, __ATOMIC_RELEASE) &
+		    ~ENV_LOCK_WRITER_PENDING) != ENV_LOCK_WRITER);
+}
+
 /* *** MUTEX *** */
 
 typedef struct {
-	pthread_mutex_t m;
+	struct env_lock lock;
 } env_mutex;
 
 static inline int
 env_mutex_init(env_mutex *mutex)
 {
-	return !!pthread_mutex_init(&mutex->m, NULL);
+	env_lock_init(&mutex->lock);
+	return 0;
 }
 
 static inline void
 env_mutex_lock(env_mutex *mutex)
 {
-	ENV_BUG_ON(pthread_mutex_lock(&mutex->m));
+	env_lock_write(&mutex->lock, ENV_LOCK_MUTEX);
 }
 
 static inline int
@@ -209,161 +387,197 @@ env_mutex_lock_interruptible(env_mutex *mutex)
 static inline int
 env_mutex_trylock(env_mutex *mutex)
 {
-	return pthread_mutex_trylock(&mutex->m) ? -OCF_ERR_NO_LOCK : 0;
+	return env_lock_write_trylock(&mutex->lock, ENV_LOCK_MUTEX);
 }
 
 static inline void
 env_mutex_unlock(env_mutex *mutex)
 {
-	ENV_BUG_ON(pthread_mutex_unlock(&mutex->m));
+	env_lock_write_unlock(&mutex->lock, ENV_LOCK_MUTEX);
 }
 
 static inline int
 env_mutex_is_locked(env_mutex *mutex)
 {
-	if (env_mutex_trylock(mutex) == 0) {
-		env_mutex_unlock(mutex);
-		return 0;
-	}
-
-	return 1;
+	return env_lock_is_locked(&mutex->lock);
 }
 
 static inline int
 env_mutex_destroy(env_mutex *mutex)
 {
-	if (pthread_mutex_destroy(&mutex->m)) {
-		return 1;
-	}
-
-	return 0;
+	return env_lock_is_locked(&mutex->lock);
 }
 
 /* *** RECURSIVE MUTEX *** */
 
-typedef env_mutex env_rmutex;
+typedef struct {
+	env_mutex mutex;
+	pthread_t owner;
+	uint32_t depth;
+} env_rmutex;
 
 static inline int
 env_rmutex_init(env_rmutex *rmutex)
 {
-	pthread_mutexattr_t attr;
-
-	pthread_mutexattr_init(&attr);
-	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
-	pthread_mutex_init(&rmutex->m, &attr);
+	env_mutex_init(&rmutex->mutex);
+	rmutex->owner = (pthread_t)0;
+	rmutex->depth = 0;
 
 	return 0;
 }
 
+/*
+ * Only the owner changes 'owner' and 'depth'. Other threads may read them concurrently, so the
+ * owner is published before the depth and cleared when the mutex is released. A stale owner
+ * is never the calling thread, which is all that is_owner() needs.
+ */
+static inline bool
+env_rmutex_is_owner(env_rmutex *rmutex)
+{
+	return __atomic_load_n(&rmutex->depth, __ATOMIC_ACQUIRE) != 0 &&
+	       pthread_equal(__atomic_load_n(&rmutex->owner, __ATOMIC_RELAXED), pthread_self());
+}
+
+static inline void
+env_rmutex_locked(env_rmutex *rmutex)
+{
+	__atomic_store_n(&rmutex->owner, pthread_self(), __ATOMIC_RELAXED);
+	__atomic_store_n(&rmutex->depth, 1, __ATOMIC_RELEASE);
+}
+
 static inline void
 env_rmutex_lock(env_rmutex *rmutex)
 {
-	env_mutex_lock(rmutex);
+	if (env_rmutex_is_owner(rmutex)) {
+		__atomic_store_n(&rmutex->depth, rmutex->depth + 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	env_mutex_lock(&rmutex->mutex);
+	env_rmutex_locked(rmutex);
 }
 
 static inline int
 env_rmutex_lock_interruptible(env_rmutex *rmutex)
 {
-	return env_mutex_lock_interruptible(rmutex);
+	env_rmutex_lock(rmutex);
+	return 0;
 }
 
 static inline int
 env_rmutex_trylock(env_rmutex *rmutex)
 {
-	return env_mutex_trylock(rmutex);
+	if (env_rmutex_is_owner(rmutex)) {
+		__atomic_store_n(&rmutex->depth, rmutex->depth + 1, __ATOMIC_RELAXED);
+		return 0;
+	}
+
+	if (env_mutex_trylock(&rmutex->mutex)) {
+		return -OCF_ERR_NO_LOCK;
+	}
+
+	env_rmutex_locked(rmutex);
+	return 0;
 }
 
 static inline void
 env_rmutex_unlock(env_rmutex *rmutex)
 {
-	env_mutex_unlock(rmutex);
+	ENV_BUG_ON(!env_rmutex_is_owner(rmutex));
+
+	if (rmutex->depth > 1) {
+		__atomic_store_n(&rmutex->depth, rmutex->depth - 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	__atomic_store_n(&rmutex->depth, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&rmutex->owner, (pthread_t)0, __ATOMIC_RELAXED);
+	env_mutex_unlock(&rmutex->mutex);
 }
 
 static inline int
 env_rmutex_is_locked(env_rmutex *rmutex)
 {
-	return env_mutex_is_locked(rmutex);
+	return env_mutex_is_locked(&rmutex->mutex);
 }
 
 static inline int
 env_rmutex_destroy(env_rmutex *rmutex)
 {
-	return env_mutex_destroy(rmutex);
+	return env_mutex_destroy(&rmutex->mutex);
 }
 
 /* *** RW SEMAPHORE *** */
 typedef struct {
-	pthread_rwlock_t lock;
+	struct env_lock lock;
 } env_rwsem;
 
 static inline int
 env_rwsem_init(env_rwsem *s)
 {
-	return !!pthread_rwlock_init(&s->lock, NULL);
+	env_lock_init(&s->lock);
+	return 0;
 }
 
 static inline void
 env_rwsem_up_read(env_rwsem *s)
 {
-	ENV_BUG_ON(pthread_rwlock_unlock(&s->lock));
+	env_lock_read_unlock(&s->lock);
 }
 
 static inline void
 env_rwsem_down_read(env_rwsem *s)
 {
-	ENV_BUG_ON(pthread_rwlock_rdlock(&s->lock));
+	env_lock_read(&s->lock, ENV_LOCK_RWSEM);
 }
 
 static inline int
 env_rwsem_down_read_trylock(env_rwsem *s)
 {
-	return pthread_rwlock_tryrdlock(&s->lock) ? -OCF_ERR_NO_LOCK : 0;
+	return env_lock_read_trylock(&s->lock, ENV_LOCK_RWSEM);
 }
 
 static inline void
 env_rwsem_up_write(env_rwsem *s)
 {
-	ENV_BUG_ON(pthread_rwlock_unlock(&s->lock));
+	env_lock_write_unlock(&s->lock, ENV_LOCK_RWSEM);
 }
 
 static inline void
 env_rwsem_down_write(env_rwsem *s)
 {
-	ENV_BUG_ON(pthread_rwlock_wrlock(&s->lock));
+	env_lock_write(&s->lock, ENV_LOCK_RWSEM);
 }
 
 static inline int
 env_rwsem_down_write_trylock(env_rwsem *s)
 {
-	return pthread_rwlock_trywrlock(&s->lock) ? -OCF_ERR_NO_LOCK : 0;
+	return env_lock_write_trylock(&s->lock, ENV_LOCK_RWSEM);
 }
 
 static inline int
 env_rwsem_is_locked(env_rwsem *s)
 {
-	if (env_rwsem_down_read_trylock(s) == 0) {
-		env_rwsem_up_read(s);
-		return 0;
-	}
-
-	return 1;
+	return env_lock_is_locked(&s->lock);
 }
 
 static inline int
 env_rwsem_down_read_interruptible(env_rwsem *s)
 {
-	return pthread_rwlock_rdlock(&s->lock);
+	env_rwsem_down_read(s);
+	return 0;
 }
 static inline int
 env_rwsem_down_write_interruptible(env_rwsem *s)
 {
-	return pthread_rwlock_wrlock(&s->lock);
+	env_rwsem_down_write(s);
+	return 0;
 }
 
 static inline int
 env_rwsem_destroy(env_rwsem *s)
 {
-	return pthread_rwlock_destroy(&s->lock);
+	return env_lock_is_locked(&s->lock);
 }
 
 /* *** ATOMIC VARIABLES *** */
@@ -631,43 +845,43 @@ env_spinlock_destroy(env_spinlock *l)
 /* *** RW LOCKS *** */
 
 typedef struct {
-	pthread_rwlock_t lock;
+	struct env_lock lock;
 } env_rwlock;
 
 static inline void
 env_rwlock_init(env_rwlock *l)
 {
-	ENV_BUG_ON(pthread_rwlock_init(&l->lock, NULL));
+	env_lock_init(&l->lock);
 }
 
 static inline void
 env_rwlock_read_lock(env_rwlock *l)
 {
-	ENV_BUG_ON(pthread_rwlock_rdlock(&l->lock));
+	env_lock_read(&l->lock, ENV_LOCK_RWLOCK);
 }
 
 static inline void
 env_rwlock_read_unlock(env_rwlock *l)
 {
-	ENV_BUG_ON(pthread_rwlock_unlock(&l->lock));
+	env_lock_read_unlock(&l->lock);
 }
 
 static inline void
 env_rwlock_write_lock(env_rwlock *l)
 {
-	ENV_BUG_ON(pthread_rwlock_wrlock(&l->lock));
+	env_lock_write(&l->lock, ENV_LOCK_RWLOCK);
 }
 
 static inline void
 env_rwlock_write_unlock(env_rwlock *l)
 {
-	ENV_BUG_ON(pthread_rwlock_unlock(&l->lock));
+	env_lock_write_unlock(&l->lock, ENV_LOCK_RWLOCK);
 }
 
 static inline void
 env_rwlock_destroy(env_rwlock *l)
 {
-	ENV_BUG_ON(pthread_rwlock_destroy(&l->lock));
+	ENV_BUG_ON(env_lock_is_locked(&l->lock));
 }
 
 static inline void
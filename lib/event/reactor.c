@@ -870,12 +870,14 @@ _reactors_scheduler_gather_metrics(void *arg1, void *arg2)
 			core_info->thread_infos[i].thread_id = spdk_thread_get_id(thread);
 			core_info->thread_infos[i].total_stats = lw_thread->total_stats;
 			core_info->thread_infos[i].current_stats = lw_thread->current_stats;
+			core_info->thread_infos[i].numa_id = spdk_thread_get_numa_id(thread);
 			core_info->threads_count++;
 			assert(core_info->threads_count <= reactor->thread_count);
 
 			spdk_trace_record(TRACE_SCHEDULER_THREAD_STATS, spdk_thread_get_trace_id(thread), 0, 0,
 					  lw_thread->current_stats.busy_tsc,
-					  lw_thread->current_stats.idle_tsc);
+					  lw_thread->current_stats.idle_tsc,
+					  (uint64_t)core_info->thread_infos[i].numa_id);
 
 			i++;
 		}
@@ -1654,7 +1656,8 @@ scheduler_trace(void)
 			OWNER_TYPE_THREAD, OBJECT_NONE, 0,
 			{
 				{ "busy", SPDK_TRACE_ARG_TYPE_INT, 8},
-				{ "idle", SPDK_TRACE_ARG_TYPE_INT, 8}
+				{ "idle", SPDK_TRACE_ARG_TYPE_INT, 8},
+				{ "numa", SPDK_TRACE_ARG_TYPE_INT, 4}
 			}
 		},
 		{
@@ -18,6 +18,8 @@
 #include "utils/ftl_md.h"
 #include "utils/ftl_defs.h"
 
+static void gc_group_update(struct ftl_band *band);
+
 static uint64_t
 ftl_band_tail_md_offset(const struct ftl_band *band)
 {
@@ -114,6 +116,7 @@ _ftl_band_set_closed_cb(struct ftl_band *band, bool valid)
 	assert(band->p2l_map.ref_cnt == 0);
 
 	TAILQ_INSERT_TAIL(&dev->shut_bands, band, queue_entry);
+	gc_group_update(band);
 }
 
 static void
@@ -487,69 +490,175 @@ is_band_relocateable(struct ftl_band *band)
 	return true;
 }
 
+static uint64_t
+gc_group_max_invalid(struct spdk_ftl_dev *dev)
+{
+	return dev->num_logical_bands_in_physical *
+	       (ftl_get_num_blocks_in_band(dev) - ftl_tail_md_num_blocks(dev));
+}
+
 static void
-get_band_phys_info(struct spdk_ftl_dev *dev, uint64_t phys_id,
-		   double *invalidity, double *wr_cnt)
+gc_group_reindex(struct spdk_ftl_dev *dev, struct ftl_gc_group *group)
 {
-	struct ftl_band *band;
-	uint64_t band_id = phys_id * dev->num_logical_bands_in_physical;
+	uint32_t bucket = FTL_GC_NUM_BUCKETS;
 
-	*wr_cnt = *invalidity = 0.0L;
-	for (; band_id < ftl_get_num_bands(dev); band_id++) {
-		band = &dev->bands[band_id];
+	if (group->invalid) {
+		bucket = group->invalid * FTL_GC_NUM_BUCKETS / (gc_group_max_invalid(dev) + 1);
+	}
 
-		if (phys_id != band->phys_id) {
-			break;
-		}
+	if (bucket == group->bucket) {
+		return;
+	}
 
-		*wr_cnt += band->md->wr_cnt;
+	if (group->bucket < FTL_GC_NUM_BUCKETS) {
+		TAILQ_REMOVE(&dev->gc.buckets[group->bucket], group, entry);
+	}
+	if (bucket < FTL_GC_NUM_BUCKETS) {
+		TAILQ_INSERT_TAIL(&dev->gc.buckets[bucket], group, entry);
+	}
+	group->bucket = bucket;
+}
+
+/* Recalculate the band's group after the band became, or stopped being, relocateable */
+static void
+gc_group_update(struct ftl_band *band)
+{
+	struct spdk_ftl_dev *dev = band->dev;
+	struct ftl_gc_group *group = &dev->gc.groups[band->phys_id];
+	uint64_t band_id = band->phys_id * dev->num_logical_bands_in_physical;
+	uint64_t end = band_id + dev->num_logical_bands_in_physical;
 
+	group->invalid = 0;
+	group->close_seq_id = 0;
+	for (; band_id < end; band_id++) {
+		band = &dev->bands[band_id];
 		if (!is_band_relocateable(band)) {
 			continue;
 		}
 
-		*invalidity += ftl_band_invalidity(band);
+		group->invalid += ftl_band_user_blocks(band) - band->p2l_map.num_valid;
+		group->close_seq_id = spdk_max(group->close_seq_id, band->md->close_seq_id);
 	}
 
-	*invalidity /= dev->num_logical_bands_in_physical;
-	*wr_cnt /= dev->num_logical_bands_in_physical;
+	gc_group_reindex(dev, group);
 }
 
-static bool
-band_cmp(double a_invalidity, double a_wr_cnt,
-	 double b_invalidity, double b_wr_cnt,
-	 uint64_t a_id, uint64_t b_id)
+void
+ftl_band_gc_invalidate(struct ftl_band *band)
 {
-	assert(a_id != FTL_BAND_PHYS_ID_INVALID);
-	assert(b_id != FTL_BAND_PHYS_ID_INVALID);
-	double diff = a_invalidity - b_invalidity;
-	if (diff < 0.0L) {
-		diff *= -1.0L;
+	struct ftl_gc_group *group;
+
+	if (!is_band_relocateable(band)) {
+		return;
 	}
 
-	/* Use the following metrics for picking bands for GC (in order):
-	 * - relative invalidity
-	 * - if invalidity is similar (within 10% points), then their write counts (how many times band was written to)
-	 * - if write count is equal, then pick based on their placement on base device (lower LBAs win)
-	 */
-	if (diff > 0.1L) {
-		return a_invalidity > b_invalidity;
+	group = &band->dev->gc.groups[band->phys_id];
+	group->invalid++;
+	gc_group_reindex(band->dev, group);
+}
+
+int
+ftl_band_gc_init(struct spdk_ftl_dev *dev)
+{
+	uint64_t i;
+
+	dev->gc.num_groups = ftl_get_num_bands(dev) / dev->num_logical_bands_in_physical;
+	dev->gc.groups = calloc(dev->gc.num_groups, sizeof(*dev->gc.groups));
+	if (!dev->gc.groups) {
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < FTL_GC_NUM_BUCKETS; i++) {
+		TAILQ_INIT(&dev->gc.buckets[i]);
+	}
+	for (i = 0; i < dev->gc.num_groups; i++) {
+		dev->gc.groups[i].bucket = FTL_GC_NUM_BUCKETS;
+	}
+
+	return 0;
+}
+
+void
+ftl_band_gc_deinit(struct spdk_ftl_dev *dev)
+{
+	free(dev->gc.groups);
+	dev->gc.groups = NULL;
+	dev->gc.num_groups = 0;
+}
+
+void
+ftl_band_gc_rebuild(struct spdk_ftl_dev *dev)
+{
+	uint64_t i;
+
+	for (i = 0; i < dev->gc.num_groups; i++) {
+		gc_group_update(&dev->bands[i * dev->num_logical_bands_in_physical]);
+	}
+}
+
+/* Benefit of reclaiming the group's invalid blocks, weighted by age, over the cost of reading
+ * and rewriting its valid ones
+ */
+static double
+gc_group_cost_benefit(struct spdk_ftl_dev *dev, const struct ftl_gc_group *group)
+{
+	uint64_t max_invalid = gc_group_max_invalid(dev);
+	uint64_t age = 1;
+
+	if (dev->sb->seq_id > group->close_seq_id) {
+		age += dev->sb->seq_id - group->close_seq_id;
+	}
+
+	return (double)group->invalid * age / (2 * max_invalid - group->invalid);
+}
+
+static uint64_t
+gc_select_group(struct spdk_ftl_dev *dev)
+{
+	struct ftl_gc_group *group, *victim = NULL;
+	double score, max_score = 0.0;
+	int bucket;
+
+	/* Only the head of each bucket is considered, keeping the selection O(buckets) */
+	for (bucket = FTL_GC_NUM_BUCKETS - 1; bucket >= 0; bucket--) {
+		group = TAILQ_FIRST(&dev->gc.buckets[bucket]);
+		if (!group) {
+			continue;
+		}
+
+		if (dev->gc.policy == FTL_GC_POLICY_GREEDY) {
+			victim = group;
+			break;
+		}
+
+		score = gc_group_cost_benefit(dev, group);
+		if (!victim || score > max_score) {
+			victim = group;
+			max_score = score;
+		}
 	}
 
-	if (a_wr_cnt != b_wr_cnt) {
-		return a_wr_cnt < b_wr_cnt;
+	if (!victim) {
+		return FTL_BAND_PHYS_ID_INVALID;
 	}
 
-	return a_id < b_id;
+	return victim - dev->gc.groups;
 }
 
 static void
 band_start_gc(struct spdk_ftl_dev *dev, struct ftl_band *band)
 {
+	uint64_t valid = band->p2l_map.num_valid;
+
 	ftl_bug(false == is_band_relocateable(band));
 
 	TAILQ_REMOVE(&dev->shut_bands, band, queue_entry);
 	band->reloc = true;
+	gc_group_update(band);
+
+	dev->stats.gc.bands++;
+	dev->stats.gc.valid_blocks += valid;
+	dev->stats.gc.invalid_blocks += ftl_band_user_blocks(band) - valid;
 
 	FTL_DEBUGLOG(dev, "Band to GC, id %u\n", band->id);
 }
@@ -588,11 +697,9 @@ ftl_band_reset_gc_iter(struct spdk_ftl_dev *dev)
 struct ftl_band *
 ftl_band_search_next_to_reloc(struct spdk_ftl_dev *dev)
 {
-	double invalidity, max_invalidity = 0.0L;
-	double wr_cnt, max_wr_cnt = 0.0L;
-	uint64_t phys_id = FTL_BAND_PHYS_ID_INVALID;
+	uint64_t phys_id;
 	struct ftl_band *band;
-	uint64_t i, band_count;
+	uint64_t band_count;
 	uint64_t phys_count;
 
 	band = gc_high_priority_band(dev);
@@ -618,26 +725,7 @@ ftl_band_search_next_to_reloc(struct spdk_ftl_dev *dev)
 		return band;
 	}
 
-	for (i = 0; i < band_count; i += phys_count) {
-		band = &dev->bands[i];
-
-		/* Calculate entire band physical group invalidity */
-		get_band_phys_info(dev, band->phys_id, &invalidity, &wr_cnt);
-
-		if (invalidity != 0.0L) {
-			if (phys_id == FTL_BAND_PHYS_ID_INVALID ||
-			    band_cmp(invalidity, wr_cnt, max_invalidity, max_wr_cnt,
-				     band->phys_id, phys_id)) {
-				max_wr_cnt = wr_cnt;
-				phys_id = band->phys_id;
-
-				if (invalidity > max_invalidity) {
-					max_invalidity = invalidity;
-				}
-			}
-		}
-	}
-
+	phys_id = gc_select_group(dev);
 	if (FTL_BAND_PHYS_ID_INVALID != phys_id) {
 		FTL_DEBUGLOG(dev, "Band physical id %"PRIu64" to GC\n", phys_id);
 		dev->sb_shm->gc_info.is_valid = 0;
@@ -160,6 +160,20 @@ struct ftl_band {
 	ftl_band_validate_md_cb		validate_cb;
 };
 
+/* Physical band group tracked by the GC victim index */
+struct ftl_gc_group {
+	/* Invalid blocks of the group's relocateable bands */
+	uint64_t			invalid;
+
+	/* Close sequence ID of the group's most recently closed relocateable band */
+	uint64_t			close_seq_id;
+
+	/* Bucket the group is linked on, FTL_GC_NUM_BUCKETS if it has no invalid blocks */
+	uint32_t			bucket;
+
+	TAILQ_ENTRY(ftl_gc_group)	entry;
+};
+
 
 uint64_t ftl_band_block_offset_from_addr(struct ftl_band *band, ftl_addr addr);
 ftl_addr ftl_band_addr_from_block_offset(struct ftl_band *band, uint64_t block_off);
@@ -183,6 +197,10 @@ int ftl_band_write_prep(struct ftl_band *band);
 size_t ftl_p2l_map_pool_elem_size(struct spdk_ftl_dev *dev);
 struct ftl_band *ftl_band_search_next_to_reloc(struct spdk_ftl_dev *dev);
 void ftl_band_init_gc_iter(struct spdk_ftl_dev *dev);
+int ftl_band_gc_init(struct spdk_ftl_dev *dev);
+void ftl_band_gc_deinit(struct spdk_ftl_dev *dev);
+void ftl_band_gc_rebuild(struct spdk_ftl_dev *dev);
+void ftl_band_gc_invalidate(struct ftl_band *band);
 ftl_addr ftl_band_p2l_map_addr(struct ftl_band *band);
 void ftl_valid_map_load_state(struct spdk_ftl_dev *dev);
 int ftl_bands_load_state(struct spdk_ftl_dev *dev);
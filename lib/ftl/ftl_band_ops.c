@@ -7,6 +7,7 @@
 #include "spdk/stdinc.h"
 #include "spdk/queue.h"
 #include "spdk/bdev_module.h"
+#include "spdk/nvme_spec.h"
 
 #include "ftl_core.h"
 #include "ftl_band.h"
@@ -37,6 +38,33 @@ write_rq_end(struct spdk_bdev_io *bdev_io, bool success, void *arg)
 	}
 }
 
+/* FDP placement handles used by the compaction and GC bands */
+#define FTL_FDP_PLACEMENT_HANDLE_COMPACTION	0
+#define FTL_FDP_PLACEMENT_HANDLE_GC		1
+
+static int
+ftl_band_rq_bdev_write_fdp(struct ftl_rq *rq)
+{
+	struct ftl_band *band = rq->io.band;
+	struct spdk_ftl_dev *dev = band->dev;
+	struct spdk_bdev_ext_io_opts opts = {
+		.size = sizeof(opts),
+	};
+
+	opts.nvme_cdw12.write.dtype = SPDK_NVME_DIRECTIVE_TYPE_DATA_PLACEMENT;
+	if (band->md->type == FTL_BAND_TYPE_GC) {
+		opts.nvme_cdw13.write.dspec = FTL_FDP_PLACEMENT_HANDLE_GC;
+	} else {
+		opts.nvme_cdw13.write.dspec = FTL_FDP_PLACEMENT_HANDLE_COMPACTION;
+	}
+
+	rq->io.iov.iov_base = rq->io_payload;
+	rq->io.iov.iov_len = rq->num_blocks * FTL_BLOCK_SIZE;
+
+	return spdk_bdev_writev_blocks_ext(dev->base_bdev_desc, dev->base_ioch, &rq->io.iov, 1,
+					   rq->io.addr, rq->num_blocks, write_rq_end, rq, &opts);
+}
+
 static void
 ftl_band_rq_bdev_write(void *_rq)
 {
@@ -45,9 +73,13 @@ ftl_band_rq_bdev_write(void *_rq)
 	struct spdk_ftl_dev *dev = band->dev;
 	int rc;
 
-	rc = spdk_bdev_write_blocks(dev->base_bdev_desc, dev->base_ioch,
-				    rq->io_payload, rq->io.addr, rq->num_blocks,
-				    write_rq_end, rq);
+	if (dev->fdp_placement) {
+		rc = ftl_band_rq_bdev_write_fdp(rq);
+	} else {
+		rc = spdk_bdev_write_blocks(dev->base_bdev_desc, dev->base_ioch,
+					    rq->io_payload, rq->io.addr, rq->num_blocks,
+					    write_rq_end, rq);
+	}
 
 	if (spdk_unlikely(rc)) {
 		if (rc == -ENOMEM) {
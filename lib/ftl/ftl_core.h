@@ -43,6 +43,32 @@ extern void *g_ftl_read_buf;
 
 struct ftl_layout_tracker_bdev;
 
+/*
+ * Thread the core thread splits work between by LBA range, such as the L2P rebuild during
+ * recovery. User IO, L2P, bands and NV cache chunks are only handled on the core thread.
+ */
+struct ftl_io_thread {
+	struct spdk_ftl_dev		*dev;
+
+	struct spdk_thread		*thread;
+};
+
+/* GC victim selection policy, set with the gc_policy property */
+enum ftl_gc_policy {
+	/* Band group with the most invalid blocks */
+	FTL_GC_POLICY_GREEDY,
+
+	/* Band group with the best ratio of invalid blocks and age to the cost of the move */
+	FTL_GC_POLICY_COST_BENEFIT,
+
+	FTL_GC_POLICY_MAX
+};
+
+/* Number of buckets the GC victim index sorts band groups into by invalid blocks */
+#define FTL_GC_NUM_BUCKETS 64
+
+struct ftl_gc_group;
+
 struct spdk_ftl_dev {
 	/* Configuration */
 	struct spdk_ftl_conf		conf;
@@ -148,6 +174,10 @@ struct spdk_ftl_dev {
 	/* Thread on which the poller is running */
 	struct spdk_thread		*core_thread;
 
+	/* Threads sharing work split by LBA range, one per additional core in the core mask */
+	struct ftl_io_thread		*io_threads;
+	uint32_t			num_io_threads;
+
 	/* IO channel to the FTL device, used for internal management operations
 	 * consuming FTL's external API
 	 */
@@ -181,8 +211,23 @@ struct spdk_ftl_dev {
 	/* Writer for GC IOs */
 	struct ftl_writer		writer_gc;
 
+	/* Write the bands of each writer to a separate FDP placement handle of the base device */
+	bool				fdp_placement;
+
 	uint32_t			num_logical_bands_in_physical;
 
+	/* GC victim index */
+	struct {
+		enum ftl_gc_policy		policy;
+
+		/* One group per physical band, indexed by phys_id */
+		struct ftl_gc_group		*groups;
+		uint64_t			num_groups;
+
+		/* Groups with invalid blocks, bucketed by their number */
+		TAILQ_HEAD(, ftl_gc_group)	buckets[FTL_GC_NUM_BUCKETS];
+	} gc;
+
 	/* Retry init sequence */
 	bool				init_retry;
 
@@ -209,6 +254,16 @@ struct spdk_ftl_dev {
 
 	/* FTL properties which can be configured by user */
 	struct ftl_properties			*properties;
+
+	/* Progress of the L2P rebuild after dirty shutdown, updated on the core thread */
+	struct {
+		struct spdk_ftl_recovery_progress	progress;
+		uint64_t				start_tsc;
+		uint64_t				end_tsc;
+	} recovery;
+
+	/* Entry on the list of all FTL devices */
+	TAILQ_ENTRY(spdk_ftl_dev)		link;
 };
 
 void ftl_apply_limits(struct spdk_ftl_dev *dev);
@@ -33,20 +33,75 @@ struct ftl_dev_free_ctx {
 	void				*cb_arg;
 };
 
+/* All allocated FTL devices, including the ones still being loaded */
+static TAILQ_HEAD(, spdk_ftl_dev) g_ftl_devs = TAILQ_HEAD_INITIALIZER(g_ftl_devs);
+static pthread_mutex_t g_ftl_devs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int
+init_io_thread(struct spdk_ftl_dev *dev, const struct spdk_cpuset *cpumask)
+{
+	struct ftl_io_thread *io_thread = &dev->io_threads[dev->num_io_threads];
+	char name[32];
+
+	snprintf(name, sizeof(name), "ftl_io_thread%"PRIu32, dev->num_io_threads);
+
+	io_thread->dev = dev;
+	io_thread->thread = spdk_thread_create(name, cpumask);
+	if (!io_thread->thread) {
+		FTL_ERRLOG(dev, "Cannot create IO thread for mask %s\n", dev->conf.core_mask);
+		return -ENOMEM;
+	}
+
+	dev->num_io_threads++;
+	return 0;
+}
+
 static int
 init_core_thread(struct spdk_ftl_dev *dev)
 {
-	struct spdk_cpuset cpumask = {};
+	struct spdk_cpuset cpumask = {}, thread_mask;
+	uint32_t cpu, num_cpus;
+	int rc;
 
 	/*
-	 * If core mask is provided create core thread on first cpu that match with the mask,
-	 * otherwise use current user thread
+	 * If core mask is provided create core thread on first cpu that match with the mask and
+	 * an IO thread on each of the remaining ones, otherwise use current user thread
 	 */
 	if (dev->conf.core_mask) {
 		if (spdk_cpuset_parse(&cpumask, dev->conf.core_mask)) {
 			return -EINVAL;
 		}
-		dev->core_thread = spdk_thread_create("ftl_core_thread", &cpumask);
+
+		num_cpus = spdk_cpuset_count(&cpumask);
+		if (num_cpus > 1) {
+			dev->io_threads = calloc(num_cpus - 1, sizeof(*dev->io_threads));
+			if (!dev->io_threads) {
+				return -ENOMEM;
+			}
+		}
+
+		for (cpu = 0; cpu < SPDK_CPUSET_SIZE; ++cpu) {
+			if (!spdk_cpuset_get_cpu(&cpumask, cpu)) {
+				continue;
+			}
+
+			spdk_cpuset_zero(&thread_mask);
+			spdk_cpuset_set_cpu(&thread_mask, cpu, true);
+
+			if (!dev->core_thread) {
+				dev->core_thread = spdk_thread_create("ftl_core_thread",
+								      &thread_mask);
+				if (!dev->core_thread) {
+					break;
+				}
+				continue;
+			}
+
+			rc = init_io_thread(dev, &thread_mask);
+			if (rc) {
+				return rc;
+			}
+		}
 	} else {
 		dev->core_thread = spdk_get_thread();
 	}
@@ -70,6 +125,16 @@ exit_thread(void *ctx)
 static void
 deinit_core_thread(struct spdk_ftl_dev *dev)
 {
+	uint32_t i;
+
+	for (i = 0; i < dev->num_io_threads; ++i) {
+		spdk_thread_send_msg(dev->io_threads[i].thread, exit_thread,
+				     dev->io_threads[i].thread);
+	}
+	free(dev->io_threads);
+	dev->io_threads = NULL;
+	dev->num_io_threads = 0;
+
 	if (dev->core_thread && dev->conf.core_mask) {
 		spdk_thread_send_msg(dev->core_thread, exit_thread,
 				     dev->core_thread);
@@ -77,6 +142,21 @@ deinit_core_thread(struct spdk_ftl_dev *dev)
 	}
 }
 
+static void
+dev_list_remove(struct spdk_ftl_dev *dev)
+{
+	struct spdk_ftl_dev *iter;
+
+	pthread_mutex_lock(&g_ftl_devs_lock);
+	TAILQ_FOREACH(iter, &g_ftl_devs, link) {
+		if (iter == dev) {
+			TAILQ_REMOVE(&g_ftl_devs, dev, link);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&g_ftl_devs_lock);
+}
+
 static void
 free_dev(struct spdk_ftl_dev *dev)
 {
@@ -84,6 +164,7 @@ free_dev(struct spdk_ftl_dev *dev)
 		return;
 	}
 
+	dev_list_remove(dev);
 	deinit_core_thread(dev);
 	spdk_ftl_conf_deinit(&dev->conf);
 	ftl_properties_deinit(dev);
@@ -128,6 +209,11 @@ allocate_dev(const struct spdk_ftl_conf *conf, int *error)
 	ftl_writer_init(dev, &dev->writer_user, SPDK_FTL_LIMIT_HIGH, FTL_BAND_TYPE_COMPACTION);
 	ftl_writer_init(dev, &dev->writer_gc, SPDK_FTL_LIMIT_CRIT, FTL_BAND_TYPE_GC);
 
+	/* Insert at the head, so a device retrying the startup hides the one it replaces */
+	pthread_mutex_lock(&g_ftl_devs_lock);
+	TAILQ_INSERT_HEAD(&g_ftl_devs, dev, link);
+	pthread_mutex_unlock(&g_ftl_devs_lock);
+
 	return dev;
 error:
 	free_dev(dev);
@@ -230,4 +316,40 @@ error:
 	return rc;
 }
 
+int
+spdk_ftl_get_recovery_progress(const char *name, struct spdk_ftl_recovery_progress *progress,
+			       size_t progress_size)
+{
+	struct spdk_ftl_recovery_progress current;
+	struct spdk_ftl_dev *dev;
+	uint64_t end_tsc;
+
+	pthread_mutex_lock(&g_ftl_devs_lock);
+	TAILQ_FOREACH(dev, &g_ftl_devs, link) {
+		if (!strcmp(dev->conf.name, name)) {
+			break;
+		}
+	}
+
+	if (!dev) {
+		pthread_mutex_unlock(&g_ftl_devs_lock);
+		return -ENODEV;
+	}
+
+	current = dev->recovery.progress;
+	if (current.state != SPDK_FTL_RECOVERY_STATE_NONE) {
+		end_tsc = dev->recovery.end_tsc;
+		if (current.state == SPDK_FTL_RECOVERY_STATE_RUNNING) {
+			end_tsc = spdk_get_ticks();
+		}
+		current.elapsed_us = (end_tsc - dev->recovery.start_tsc) * SPDK_SEC_TO_USEC /
+				     spdk_get_ticks_hz();
+	}
+	pthread_mutex_unlock(&g_ftl_devs_lock);
+
+	memcpy(progress, &current, spdk_min(progress_size, sizeof(current)));
+
+	return 0;
+}
+
 SPDK_LOG_REGISTER_COMPONENT(ftl_init)
@@ -236,6 +236,9 @@ struct ftl_rq {
 		/* Band to which IO is issued */
 		struct ftl_band *band;
 
+		/* Payload descriptor for extended writes */
+		struct iovec iov;
+
 		struct spdk_bdev_io_wait_entry bdev_io_wait;
 	} io;
 
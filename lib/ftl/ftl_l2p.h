@@ -28,11 +28,15 @@ struct ftl_l2p_pin_ctx {
 	uint64_t count;
 	ftl_l2p_pin_cb cb;
 	void *cb_ctx;
+	/* Pinned by GC or compaction, the lookup doesn't promote the L2P pages */
+	bool background;
 	TAILQ_ENTRY(ftl_l2p_pin_ctx) link;
 };
 
 void ftl_l2p_pin(struct spdk_ftl_dev *dev, uint64_t lba, uint64_t count, ftl_l2p_pin_cb cb,
 		 void *cb_ctx, struct ftl_l2p_pin_ctx *pin_ctx);
+void ftl_l2p_pin_background(struct spdk_ftl_dev *dev, uint64_t lba, uint64_t count,
+			    ftl_l2p_pin_cb cb, void *cb_ctx, struct ftl_l2p_pin_ctx *pin_ctx);
 void ftl_l2p_unpin(struct spdk_ftl_dev *dev, uint64_t lba, uint64_t count);
 void ftl_l2p_pin_skip(struct spdk_ftl_dev *dev, ftl_l2p_pin_cb cb, void *cb_ctx,
 		      struct ftl_l2p_pin_ctx *pin_ctx);
@@ -46,6 +46,8 @@ struct ftl_l2p_page {
 	uint64_t pin_ref_cnt;
 	struct ftl_l2p_cache_page_io_ctx ctx;
 	bool on_lru_list;
+	bool hot;		/* Page on the hot list, see struct ftl_l2p_cache */
+	bool referenced;	/* Page pinned by user IO since it was paged in */
 	void *page_buffer;
 	uint64_t ckpt_seq_id;
 	ftl_df_obj_id obj_id;
@@ -107,7 +109,29 @@ struct ftl_l2p_cache {
 	struct ftl_mempool *l2_ctx_pool;
 	struct ftl_md *l1_md;
 
-	TAILQ_HEAD(l2p_lru_list, ftl_l2p_page) lru_list;
+	/*
+	 * Resident pages are managed by the 2Q policy, so that a scan through cold LBAs (by user
+	 * IO, GC or compaction) doesn't flush the working set out of the cache. Pages paged in go
+	 * to the LRU ordered in_list and are evicted from there first, as long as it holds more
+	 * than in_max pages. Only pages paged in again shortly after being evicted from in_list,
+	 * i.e. ones remembered in the ghost queue, go to the hot_list. Lookups by GC and
+	 * compaction don't move pages between the lists.
+	 */
+	TAILQ_HEAD(l2p_lru_list, ftl_l2p_page) in_list;
+	struct l2p_lru_list hot_list;
+	uint64_t hot_cnt;
+	uint64_t in_max;
+
+	/* Page numbers recently evicted from in_list */
+	struct {
+		struct ftl_bitmap *map;
+		void *map_buf;
+		uint64_t *ring;
+		uint64_t max;
+		uint64_t cnt;
+		uint64_t pos;
+	} ghost;
+
 	/* TODO: A lot of / and % operations are done on this value, consider adding a shift based field and calculactions instead */
 	uint64_t lbas_in_page;
 	uint64_t num_pages;		/* num pages to hold the entire L2P */
@@ -181,13 +205,19 @@ ftl_l2p_cache_get_page_all_size(void)
 	return sizeof(struct ftl_l2p_page) + ftl_l2p_cache_get_l1_page_size();
 }
 
+static inline struct l2p_lru_list *
+ftl_l2p_cache_page_list(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
+{
+	return page->hot ? &cache->hot_list : &cache->in_list;
+}
+
 static void
 ftl_l2p_cache_lru_remove_page(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
 {
 	assert(page);
 	assert(page->on_lru_list);
 
-	TAILQ_REMOVE(&cache->lru_list, page, list_entry);
+	TAILQ_REMOVE(ftl_l2p_cache_page_list(cache, page), page, list_entry);
 	page->on_lru_list = false;
 }
 
@@ -197,20 +227,53 @@ ftl_l2p_cache_lru_add_page(struct ftl_l2p_cache *cache, struct ftl_l2p_page *pag
 	assert(page);
 	assert(!page->on_lru_list);
 
-	TAILQ_INSERT_HEAD(&cache->lru_list, page, list_entry);
+	if (page->hot || page->referenced) {
+		TAILQ_INSERT_HEAD(ftl_l2p_cache_page_list(cache, page), page, list_entry);
+	} else {
+		/* Paged in by GC or compaction only, make it the first one to evict */
+		TAILQ_INSERT_TAIL(&cache->in_list, page, list_entry);
+	}
 
 	page->on_lru_list = true;
 }
 
+static bool
+ftl_l2p_cache_ghost_hit(struct ftl_l2p_cache *cache, uint64_t page_no)
+{
+	if (!ftl_bitmap_get(cache->ghost.map, page_no)) {
+		return false;
+	}
+
+	ftl_bitmap_clear(cache->ghost.map, page_no);
+	return true;
+}
+
 static void
-ftl_l2p_cache_lru_promote_page(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
+ftl_l2p_cache_ghost_add(struct ftl_l2p_cache *cache, uint64_t page_no)
 {
-	if (!page->on_lru_list) {
-		return;
+	if (cache->ghost.cnt == cache->ghost.max) {
+		/*
+		 * Forget the oldest entry. If its page has been evicted again since, it's forgotten
+		 * earlier than it should, which only costs a missed promotion.
+		 */
+		ftl_bitmap_clear(cache->ghost.map, cache->ghost.ring[cache->ghost.pos]);
+	} else {
+		cache->ghost.cnt++;
 	}
 
-	ftl_l2p_cache_lru_remove_page(cache, page);
-	ftl_l2p_cache_lru_add_page(cache, page);
+	cache->ghost.ring[cache->ghost.pos] = page_no;
+	cache->ghost.pos = (cache->ghost.pos + 1) % cache->ghost.max;
+	ftl_bitmap_set(cache->ghost.map, page_no);
+}
+
+static void
+ftl_l2p_cache_page_admit(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page, bool background)
+{
+	/* Referenced again shortly after eviction, keep it with the hot pages */
+	if (!background && ftl_l2p_cache_ghost_hit(cache, page->page_no)) {
+		page->hot = true;
+		cache->hot_cnt++;
+	}
 }
 
 static inline void
@@ -233,19 +296,39 @@ ftl_l2p_cache_page_remove(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page
 
 	me[page->page_no].page_obj_id = FTL_DF_OBJ_ID_INVALID;
 	cache->l2_pgs_avail++;
+	if (page->hot) {
+		cache->hot_cnt--;
+	}
 	ftl_mempool_put(cache->l2_ctx_pool, page);
 }
 
-static inline struct ftl_l2p_page *
-ftl_l2p_cache_get_coldest_page(struct ftl_l2p_cache *cache)
+static void
+ftl_l2p_cache_page_evict(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
 {
-	return TAILQ_LAST(&cache->lru_list, l2p_lru_list);
+	/* Pages only looked up by GC or compaction aren't worth promoting if paged in again */
+	if (!page->hot && page->referenced) {
+		ftl_l2p_cache_ghost_add(cache, page->page_no);
+	}
+
+	cache->dev->stats.l2p_cache.evictions++;
+	ftl_l2p_cache_page_remove(cache, page);
 }
 
 static inline struct ftl_l2p_page *
-ftl_l2p_cache_get_hotter_page(struct ftl_l2p_page *page)
+ftl_l2p_cache_get_coldest_page(struct ftl_l2p_cache *cache)
 {
-	return TAILQ_PREV(page, l2p_lru_list, list_entry);
+	uint64_t resident = cache->l2_pgs_resident_max - cache->l2_pgs_avail;
+	struct ftl_l2p_page *page;
+
+	/* Keep the pages referenced once within in_max, unless there are no hot ones to evict */
+	page = TAILQ_LAST(&cache->hot_list, l2p_lru_list);
+	if (!page || resident - cache->hot_cnt > cache->in_max) {
+		if (!TAILQ_EMPTY(&cache->in_list)) {
+			page = TAILQ_LAST(&cache->in_list, l2p_lru_list);
+		}
+	}
+
+	return page;
 }
 
 static inline uint64_t
@@ -334,9 +417,18 @@ ftl_l2p_page_set_invalid(struct spdk_ftl_dev *dev, struct ftl_l2p_page *page)
 }
 
 static inline void
-ftl_l2p_cache_page_pin(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
+ftl_l2p_cache_page_pin(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page,
+		       struct ftl_l2p_pin_ctx *pin_ctx)
 {
 	page->pin_ref_cnt++;
+	/*
+	 * Pages pinned by GC or compaction aren't marked as referenced, so unpinning puts a page
+	 * paged in only by them at the tail of in_list and never moves a page to hot_list.
+	 */
+	if (!pin_ctx->background) {
+		page->referenced = true;
+	}
+
 	/* Pinned pages can't be evicted (since L2P sets/gets will be executed on it), so remove them from LRU */
 	if (page->on_lru_list) {
 		ftl_l2p_cache_lru_remove_page(cache, page);
@@ -459,7 +551,8 @@ ftl_l2p_cache_init(struct spdk_ftl_dev *dev)
 		       max_resident_size >> 20, dev->conf.l2p_dram_limit);
 
 	TAILQ_INIT(&cache->deferred_page_set_list);
-	TAILQ_INIT(&cache->lru_list);
+	TAILQ_INIT(&cache->in_list);
+	TAILQ_INIT(&cache->hot_list);
 
 	cache->l2_ctx_md = ftl_md_create(dev,
 					 spdk_divide_round_up(max_resident_pgs * SPDK_ALIGN_CEIL(sizeof(struct ftl_l2p_page), 64),
@@ -484,6 +577,23 @@ ftl_l2p_cache_init(struct spdk_ftl_dev *dev)
 	cache->evict_keep = spdk_divide_round_up(cache->num_pages * FTL_L2P_CACHE_PAGE_AVAIL_RATIO, 100);
 	cache->evict_keep = spdk_min(FTL_L2P_CACHE_PAGE_AVAIL_MAX, cache->evict_keep);
 
+	/* 2Q parameters, percentage of resident pages */
+#define FTL_L2P_CACHE_IN_RATIO                  25UL
+#define FTL_L2P_CACHE_GHOST_RATIO               50UL
+	cache->in_max = spdk_divide_round_up(max_resident_pgs * FTL_L2P_CACHE_IN_RATIO, 100);
+	cache->ghost.max = spdk_divide_round_up(max_resident_pgs * FTL_L2P_CACHE_GHOST_RATIO, 100);
+	cache->ghost.ring = calloc(cache->ghost.max, sizeof(*cache->ghost.ring));
+	cache->ghost.map_buf = calloc(1, ftl_bitmap_bits_to_size(cache->num_pages));
+	if (!cache->ghost.ring || !cache->ghost.map_buf) {
+		return -1;
+	}
+
+	cache->ghost.map = ftl_bitmap_create(cache->ghost.map_buf,
+					     ftl_bitmap_bits_to_size(cache->num_pages));
+	if (!cache->ghost.map) {
+		return -1;
+	}
+
 	if (!ftl_fast_startup(dev) && !ftl_fast_recovery(dev)) {
 		memset(cache->l2_mapping, (int)FTL_DF_OBJ_ID_INVALID, ftl_md_get_buffer_size(cache->l2_md));
 		ftl_mempool_initialize_ext(cache->l2_ctx_pool);
@@ -521,6 +631,13 @@ ftl_l2p_cache_deinit_l2(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache)
 
 	ftl_mempool_destroy(cache->page_sets_pool);
 	cache->page_sets_pool = NULL;
+
+	ftl_bitmap_destroy(cache->ghost.map);
+	cache->ghost.map = NULL;
+	free(cache->ghost.map_buf);
+	cache->ghost.map_buf = NULL;
+	free(cache->ghost.ring);
+	cache->ghost.ring = NULL;
 }
 
 static void
@@ -820,6 +937,9 @@ l2p_shm_restore_clean(struct spdk_ftl_dev *dev)
 		page->on_lru_list = 0;
 		memset(&page->ctx, 0, sizeof(page->ctx));
 
+		if (page->hot) {
+			cache->hot_cnt++;
+		}
 		ftl_l2p_cache_lru_add_page(cache, page);
 	}
 
@@ -868,6 +988,9 @@ l2p_shm_restore_dirty(struct spdk_ftl_dev *dev)
 		page->on_lru_list = 0;
 		memset(&page->ctx, 0, sizeof(page->ctx));
 
+		if (page->hot) {
+			cache->hot_cnt++;
+		}
 		ftl_l2p_cache_lru_add_page(cache, page);
 	}
 
@@ -1041,16 +1164,19 @@ ftl_l2p_cache_pin(struct spdk_ftl_dev *dev, struct ftl_l2p_pin_ctx *pin_ctx)
 				page_set->pinned_cnt++;
 				entry->pg_pin_issued = true;
 				entry->pg_pin_completed = true;
-				ftl_l2p_cache_page_pin(cache, page);
+				ftl_l2p_cache_page_pin(cache, page, pin_ctx);
+				dev->stats.l2p_cache.hits++;
 			} else {
 				/* The page is being loaded */
 				/* Queue the page pin entry to be executed on page in */
 				ftl_l2p_page_queue_wait_ctx(page, entry);
 				entry->pg_pin_issued = true;
+				dev->stats.l2p_cache.misses++;
 			}
 		} else {
 			/* The page is not in the cache, queue the page_set to page in */
 			defer_pin = true;
+			dev->stats.l2p_cache.misses++;
 		}
 	}
 
@@ -1101,7 +1227,6 @@ ftl_l2p_cache_get(struct spdk_ftl_dev *dev, uint64_t lba)
 		ftl_bitmap_clear(dev->trim_map, page->page_no);
 	}
 
-	ftl_l2p_cache_lru_promote_page(cache, page);
 	addr = ftl_l2p_cache_get_addr(dev, cache, page, lba);
 
 	return addr;
@@ -1124,7 +1249,6 @@ ftl_l2p_cache_set(struct spdk_ftl_dev *dev, uint64_t lba, ftl_addr addr)
 	}
 
 	page->updates++;
-	ftl_l2p_cache_lru_promote_page(cache, page);
 	ftl_l2p_cache_set_addr(dev, cache, page, lba, addr);
 }
 
@@ -1212,7 +1336,7 @@ page_in_io_complete(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache,
 		assert(false == pentry->pg_pin_completed);
 
 		if (success) {
-			ftl_l2p_cache_page_pin(cache, page);
+			ftl_l2p_cache_page_pin(cache, page, page_set->pin_ctx);
 			page_set->pinned_cnt++;
 			pentry->pg_pin_completed = true;
 		} else {
@@ -1300,10 +1424,11 @@ page_in(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache,
 		/* Page not allocated yet, do it */
 		page = page_allocate(cache, pentry->pg_no);
 		page_in = true;
+		ftl_l2p_cache_page_admit(cache, page, page_set->pin_ctx->background);
 	}
 
 	if (ftl_l2p_cache_page_is_pinnable(page)) {
-		ftl_l2p_cache_page_pin(cache, page);
+		ftl_l2p_cache_page_pin(cache, page, page_set->pin_ctx);
 		page_set->pinned_cnt++;
 		pentry->pg_pin_issued = true;
 		pentry->pg_pin_completed = true;
@@ -1366,28 +1491,19 @@ ftl_l2p_cache_process_page_sets(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *
 static struct ftl_l2p_page *
 eviction_get_page(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache)
 {
-	uint64_t i = 0;
-	struct ftl_l2p_page *page = ftl_l2p_cache_get_coldest_page(cache);
-
-	while (page) {
-		ftl_bug(L2P_CACHE_PAGE_READY != page->state);
-		ftl_bug(page->pin_ref_cnt);
-
-		if (ftl_l2p_cache_page_can_evict(page)) {
-			ftl_l2p_cache_lru_remove_page(cache, page);
-			return page;
-		}
-
-		/*
-		 * Practically only one iteration is needed to find a page. It is because
-		 * the rank of pages contains only ready and unpinned pages
-		 */
-		ftl_bug(++i > 1024);
+	struct ftl_l2p_page *page;
 
-		page = ftl_l2p_cache_get_hotter_page(page);
+	page = ftl_l2p_cache_get_coldest_page(cache);
+	if (!page) {
+		return NULL;
 	}
 
-	return NULL;
+	/* The lists contain only ready and unpinned pages, background pins included */
+	ftl_bug(L2P_CACHE_PAGE_READY != page->state);
+	ftl_bug(page->pin_ref_cnt);
+	ftl_l2p_cache_lru_remove_page(cache, page);
+
+	return page;
 }
 
 static void
@@ -1405,7 +1521,7 @@ page_out_io_complete(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache,
 	}
 
 	if (success && ftl_l2p_cache_page_can_remove(page)) {
-		ftl_l2p_cache_page_remove(cache, page);
+		ftl_l2p_cache_page_evict(cache, page);
 	} else {
 		if (!page->pin_ref_cnt) {
 			ftl_l2p_cache_lru_add_page(cache, page);
@@ -1499,7 +1615,7 @@ ftl_l2p_cache_process_eviction(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *c
 		page_out_io(dev, cache, page);
 	} else {
 		/* Page clean and we can remove it */
-		ftl_l2p_cache_page_remove(cache, page);
+		ftl_l2p_cache_page_evict(cache, page);
 	}
 }
 
@@ -1561,6 +1677,7 @@ ftl_l2p_lazy_trim_process(struct spdk_ftl_dev *dev)
 	pin_ctx->count = 1;
 	pin_ctx->cb = ftl_l2p_lazy_trim_process_cb;
 	pin_ctx->cb_ctx = pin_ctx;
+	pin_ctx->background = true;
 
 	ftl_l2p_cache_pin(dev, pin_ctx);
 }
@@ -332,9 +332,20 @@ ftl_nv_cache_init(struct spdk_ftl_dev *dev)
 		return -ENOMEM;
 	}
 
+	nv_cache->heat.num_pages = spdk_divide_round_up(dev->num_lbas,
+				   dev->layout.l2p.lbas_in_page);
+	nv_cache->heat.pages = calloc(nv_cache->heat.num_pages, sizeof(*nv_cache->heat.pages));
+	if (!nv_cache->heat.pages) {
+		return -ENOMEM;
+	}
+	nv_cache->heat.epoch_blocks = nv_cache->chunk_count * nv_cache->chunk_blocks;
+
 	ftl_nv_cache_init_update_limits(dev);
 	ftl_property_register(dev, "cache_device", NULL, 0, NULL, NULL, ftl_property_dump_cache_dev, NULL,
 			      NULL, true);
+	ftl_property_register_bool_rw(dev, "hot_cold_separation", &nv_cache->heat.enabled, "",
+				      "Place rarely overwritten data compacted from the cache on "
+				      "GC bands, apart from frequently overwritten data", false);
 
 	nv_cache->throttle.interval_tsc = FTL_NV_CACHE_THROTTLE_INTERVAL_MS *
 					  (spdk_get_ticks_hz() / 1000);
@@ -377,6 +388,8 @@ ftl_nv_cache_deinit(struct spdk_ftl_dev *dev)
 
 	free(nv_cache->chunks);
 	nv_cache->chunks = NULL;
+	free(nv_cache->heat.pages);
+	nv_cache->heat.pages = NULL;
 }
 
 static uint64_t
@@ -764,7 +777,8 @@ compaction_process_pin_lba(struct ftl_nv_cache_compactor *comp)
 		if (entry->lba == FTL_LBA_INVALID) {
 			ftl_l2p_pin_skip(dev, compaction_process_pin_lba_cb, comp, pin_ctx);
 		} else {
-			ftl_l2p_pin(dev, entry->lba, 1, compaction_process_pin_lba_cb, comp, pin_ctx);
+			ftl_l2p_pin_background(dev, entry->lba, 1, compaction_process_pin_lba_cb,
+					       comp, pin_ctx);
 		}
 	}
 }
@@ -1152,14 +1166,72 @@ compaction_process_ftl_done(struct ftl_rq *rq)
 	compactor_deactivate(compactor);
 }
 
+/* Number of overwrites of an L2P page within the last epochs after which its data is hot */
+#define FTL_NV_CACHE_HOT_UPDATES 2
+/* Epochs after which any overwrite counter has decayed to zero */
+#define FTL_NV_CACHE_HEAT_DECAY_EPOCHS 8
+
+static uint8_t
+heat_get_updates(struct ftl_nv_cache *nv_cache, uint64_t page)
+{
+	struct ftl_nv_cache_heat *heat = &nv_cache->heat.pages[page];
+	uint32_t age = nv_cache->heat.epoch - heat->epoch;
+
+	if (age) {
+		heat->updates = age < FTL_NV_CACHE_HEAT_DECAY_EPOCHS ? heat->updates >> age : 0;
+		heat->epoch = nv_cache->heat.epoch;
+	}
+
+	return heat->updates;
+}
+
+static void
+heat_update(struct spdk_ftl_dev *dev, struct ftl_io *io)
+{
+	struct ftl_nv_cache *nv_cache = &dev->nv_cache;
+	uint64_t page;
+	size_t i;
+
+	for (i = 0; i < io->num_blocks; ++i) {
+		/* Only overwrites count, data written once is cold */
+		if (io->map[i] == FTL_ADDR_INVALID) {
+			continue;
+		}
+
+		page = ftl_io_get_lba(io, i) / dev->layout.l2p.lbas_in_page;
+		if (heat_get_updates(nv_cache, page) < UINT8_MAX) {
+			nv_cache->heat.pages[page].updates++;
+		}
+	}
+
+	nv_cache->heat.epoch_written += io->num_blocks;
+	if (nv_cache->heat.epoch_written >= nv_cache->heat.epoch_blocks) {
+		nv_cache->heat.epoch_written = 0;
+		nv_cache->heat.epoch++;
+	}
+}
+
+static struct ftl_writer *
+compaction_get_writer(struct spdk_ftl_dev *dev, uint64_t num_hot, uint64_t num_blocks)
+{
+	/* Mostly cold requests go to the GC bands, unless band limits stop compaction */
+	if (dev->nv_cache.heat.enabled && num_hot * 2 < num_blocks &&
+	    dev->limit >= dev->writer_user.limit) {
+		return &dev->writer_gc;
+	}
+
+	return &dev->writer_user;
+}
+
 static void
 compaction_process_finish_read(struct ftl_nv_cache_compactor *compactor)
 {
 	struct ftl_rq *rq = compactor->rq;
 	struct spdk_ftl_dev *dev = rq->dev;
+	struct ftl_nv_cache *nv_cache = &dev->nv_cache;
 	struct ftl_rq_entry *entry;
 	ftl_addr current_addr;
-	uint64_t skip = 0;
+	uint64_t skip = 0, hot = 0;
 
 	FTL_RQ_ENTRY_LOOP(rq, entry, rq->iter.count) {
 		struct ftl_nv_cache_chunk *chunk = entry->owner.priv;
@@ -1175,6 +1247,11 @@ compaction_process_finish_read(struct ftl_nv_cache_compactor *compactor)
 		current_addr = ftl_l2p_get(dev, lba);
 		if (current_addr == entry->addr) {
 			entry->seq_id = chunk->md->seq_id;
+			if (nv_cache->heat.enabled &&
+			    heat_get_updates(nv_cache, lba / dev->layout.l2p.lbas_in_page) >=
+			    FTL_NV_CACHE_HOT_UPDATES) {
+				hot++;
+			}
 		} else {
 			/* This address already invalidated, just omit this block */
 			skip++;
@@ -1188,7 +1265,7 @@ compaction_process_finish_read(struct ftl_nv_cache_compactor *compactor)
 		/*
 		 * Request contains data to be placed on FTL, compact it
 		 */
-		ftl_writer_queue_rq(&dev->writer_user, rq);
+		ftl_writer_queue_rq(compaction_get_writer(dev, hot, rq->iter.count - skip), rq);
 	} else {
 		compactor_deactivate(compactor);
 	}
@@ -1260,6 +1337,10 @@ ftl_nv_cache_l2p_update(struct ftl_io *io)
 		ftl_l2p_update_cache(dev, ftl_io_get_lba(io, i), next_addr, io->map[i]);
 	}
 
+	if (dev->nv_cache.heat.enabled) {
+		heat_update(dev, io);
+	}
+
 	ftl_l2p_unpin(dev, io->lba, io->num_blocks);
 	ftl_nv_cache_submit_cb_done(io);
 }
@@ -2075,26 +2156,32 @@ is_chunk_count_valid(struct ftl_nv_cache *nv_cache)
 	return chunk_count == nv_cache->chunk_count;
 }
 
+void
+ftl_mngt_nv_cache_restore_l2p_done(struct ftl_mngt_process *mngt,
+				   struct ftl_nv_cache_chunk *chunk, int status)
+{
+	struct restore_chunk_md_ctx *ctx = ftl_mngt_get_step_ctx(mngt);
+
+	if (status) {
+		ctx->status = status;
+	}
+	ctx->qd--;
+	chunk_free_p2l_map(chunk);
+	ftl_mngt_continue_step(mngt);
+}
+
 static void
 walk_tail_md_cb(struct ftl_basic_rq *brq)
 {
 	struct ftl_mngt_process *mngt = brq->owner.priv;
 	struct ftl_nv_cache_chunk *chunk = brq->io.chunk;
 	struct restore_chunk_md_ctx *ctx = ftl_mngt_get_step_ctx(mngt);
-	int rc = 0;
 
 	if (brq->success) {
-		rc = ctx->cb(chunk, ctx->cb_ctx);
+		ctx->cb(chunk, mngt, ctx->cb_ctx);
 	} else {
-		rc = -EIO;
+		ftl_mngt_nv_cache_restore_l2p_done(mngt, chunk, -EIO);
 	}
-
-	if (rc) {
-		ctx->status = rc;
-	}
-	ctx->qd--;
-	chunk_free_p2l_map(chunk);
-	ftl_mngt_continue_step(mngt);
 }
 
 static void
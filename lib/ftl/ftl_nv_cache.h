@@ -141,6 +141,13 @@ struct ftl_nv_cache_compactor {
 	struct spdk_bdev_io_wait_entry bdev_io_wait;
 };
 
+/* Overwrite counter of an L2P page, halved each time the epoch advances */
+struct ftl_nv_cache_heat {
+	/* Wide enough for the epoch to never wrap around during the lifetime of the device */
+	uint32_t epoch;
+	uint8_t updates;
+};
+
 struct ftl_nv_cache {
 	/* Flag indicating halt request */
 	bool halt;
@@ -236,6 +243,20 @@ struct ftl_nv_cache {
 		uint64_t blocks_submitted;
 		uint64_t blocks_submitted_limit;
 	} throttle;
+
+	/* Hot/cold data separation during compaction */
+	struct {
+		/* Compact rarely overwritten data to GC bands (hot_cold_separation) */
+		bool enabled;
+
+		struct ftl_nv_cache_heat *pages;
+		uint64_t num_pages;
+
+		/* The epoch advances each time as many blocks as the cache holds are written */
+		uint32_t epoch;
+		uint64_t epoch_blocks;
+		uint64_t epoch_written;
+	} heat;
 };
 
 typedef void (*nvc_scrub_cb)(struct spdk_ftl_dev *dev, void *cb_ctx, int status);
@@ -293,11 +314,19 @@ void ftl_mngt_nv_cache_restore_chunk_state(struct spdk_ftl_dev *dev, struct ftl_
 
 void ftl_mngt_nv_cache_recover_open_chunk(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt);
 
-typedef int (*ftl_chunk_md_cb)(struct ftl_nv_cache_chunk *chunk, void *cntx);
+/*
+ * Called for each chunk with its P2L map read, must complete with
+ * ftl_mngt_nv_cache_restore_l2p_done() on the FTL core thread
+ */
+typedef void (*ftl_chunk_md_cb)(struct ftl_nv_cache_chunk *chunk, struct ftl_mngt_process *mngt,
+				void *cntx);
 
 void ftl_mngt_nv_cache_restore_l2p(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt,
 				   ftl_chunk_md_cb cb, void *cb_ctx);
 
+void ftl_mngt_nv_cache_restore_l2p_done(struct ftl_mngt_process *mngt,
+					struct ftl_nv_cache_chunk *chunk, int status);
+
 struct ftl_nv_cache_chunk *ftl_nv_cache_get_chunk_from_addr(struct spdk_ftl_dev *dev,
 		ftl_addr addr);
 
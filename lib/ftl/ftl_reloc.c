@@ -490,7 +490,8 @@ move_pin(struct ftl_reloc_move *mv)
 
 	for (i = 0; i < rq->num_blocks; i++) {
 		if (entry->lba != FTL_LBA_INVALID) {
-			ftl_l2p_pin(rq->dev, entry->lba, 1, move_pin_cb, mv, &entry->l2p_pin_ctx);
+			ftl_l2p_pin_background(rq->dev, entry->lba, 1, move_pin_cb, mv,
+					       &entry->l2p_pin_ctx);
 		} else {
 			ftl_l2p_pin_skip(rq->dev, move_pin_cb, mv, &entry->l2p_pin_ctx);
 		}
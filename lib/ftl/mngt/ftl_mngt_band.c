@@ -103,6 +103,7 @@ ftl_dev_init_bands_md(struct spdk_ftl_dev *dev)
 static void
 ftl_dev_deinit_bands(struct spdk_ftl_dev *dev)
 {
+	ftl_band_gc_deinit(dev);
 	free(dev->bands);
 }
 
@@ -162,7 +163,7 @@ ftl_mngt_deinit_bands_md(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt
  */
 #define BASE_BDEV_RECLAIM_UNIT_SIZE (72 * GiB)
 
-static void
+static int
 decorate_bands(struct spdk_ftl_dev *dev)
 {
 	struct ftl_band *band;
@@ -205,13 +206,18 @@ decorate_bands(struct spdk_ftl_dev *dev)
 	}
 
 	dev->num_logical_bands_in_physical = num_logical_in_phys;
+
+	return ftl_band_gc_init(dev);
 }
 
 void
 ftl_mngt_decorate_bands(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
 {
-	decorate_bands(dev);
-	ftl_mngt_next_step(mngt);
+	if (decorate_bands(dev)) {
+		ftl_mngt_fail_step(mngt);
+	} else {
+		ftl_mngt_next_step(mngt);
+	}
 }
 
 void
@@ -290,6 +296,7 @@ finalize_init_gc(struct spdk_ftl_dev *dev)
 	struct ftl_band *band;
 	uint64_t free_blocks, blocks_to_move;
 
+	ftl_band_gc_rebuild(dev);
 	ftl_band_init_gc_iter(dev);
 	dev->sb_shm->gc_info.band_id_high_prio = FTL_BAND_ID_INVALID;
 
@@ -345,6 +352,62 @@ ftl_property_dump_base_dev(struct spdk_ftl_dev *dev, const struct ftl_property *
 	spdk_json_write_array_end(w);
 }
 
+static const char *g_gc_policy_names[] = {
+	[FTL_GC_POLICY_GREEDY]		= "greedy",
+	[FTL_GC_POLICY_COST_BENEFIT]	= "cost_benefit",
+};
+SPDK_STATIC_ASSERT(SPDK_COUNTOF(g_gc_policy_names) == FTL_GC_POLICY_MAX, "Missing GC policy name");
+
+static void
+ftl_property_dump_gc_policy(struct spdk_ftl_dev *dev, const struct ftl_property *property,
+			    struct spdk_json_write_ctx *w)
+{
+	spdk_json_write_named_string(w, "value", g_gc_policy_names[dev->gc.policy]);
+}
+
+static int
+ftl_property_decode_gc_policy(struct spdk_ftl_dev *dev, struct ftl_property *property,
+			      const char *value, size_t value_size, void *output,
+			      size_t output_size)
+{
+	enum ftl_gc_policy *out = output;
+	int i;
+
+	if (sizeof(*out) != output_size) {
+		return -ENOBUFS;
+	}
+
+	if (strnlen(value, value_size) == value_size) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < FTL_GC_POLICY_MAX; i++) {
+		if (strcmp(value, g_gc_policy_names[i]) == 0) {
+			*out = i;
+			return 0;
+		}
+	}
+
+	return -EINVAL;
+}
+
+static void
+ftl_property_set_fdp_placement(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt,
+			       const struct ftl_property *property, void *new_value,
+			       size_t new_value_size)
+{
+	struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(dev->base_bdev_desc);
+	bool *enable = new_value;
+
+	if (*enable && !spdk_bdev_get_nvme_ctratt(bdev).bits.fdps) {
+		FTL_ERRLOG(dev, "Base device doesn't support flexible data placement\n");
+		ftl_mngt_fail_step(mngt);
+		return;
+	}
+
+	ftl_property_set_generic(dev, mngt, property, new_value, new_value_size);
+}
+
 void
 ftl_mngt_finalize_init_bands(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
 {
@@ -357,6 +420,15 @@ ftl_mngt_finalize_init_bands(struct spdk_ftl_dev *dev, struct ftl_mngt_process *
 	ftl_recover_max_seq(dev);
 	ftl_property_register(dev, "base_device", NULL, 0, NULL, NULL, ftl_property_dump_base_dev, NULL,
 			      NULL, true);
+	ftl_property_register(dev, "gc_policy", &dev->gc.policy, sizeof(dev->gc.policy), NULL,
+			      "GC victim selection policy, greedy or cost_benefit",
+			      ftl_property_dump_gc_policy, ftl_property_decode_gc_policy,
+			      ftl_property_set_generic, false);
+	ftl_property_register(dev, "fdp_placement", &dev->fdp_placement, sizeof(dev->fdp_placement),
+			      "", "Write compaction and GC bands to separate flexible data "
+			      "placement handles (0 and 1) of the base device",
+			      ftl_property_dump_bool, ftl_property_decode_bool,
+			      ftl_property_set_fdp_placement, false);
 
 	TAILQ_FOREACH_SAFE(band, &dev->free_bands, queue_entry, temp_band) {
 		band->md->df_p2l_map = FTL_DF_OBJ_ID_INVALID;
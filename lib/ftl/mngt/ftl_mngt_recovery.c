@@ -119,6 +119,11 @@ ftl_mngt_recovery_init(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
 	FTL_NOTICELOG(dev, "Recovery iterations: %"PRIu64"\n", iterations);
 	dev->sb->ckpt_seq_id = 0;
 
+	dev->recovery.progress.state = SPDK_FTL_RECOVERY_STATE_RUNNING;
+	dev->recovery.progress.iterations = iterations;
+	dev->recovery.progress.num_threads = spdk_max(dev->num_io_threads, 1);
+	dev->recovery.start_tsc = spdk_get_ticks();
+
 	/* Initialize region */
 	ctx->l2p_snippet.region = *ftl_layout_region_get(dev, FTL_LAYOUT_REGION_TYPE_L2P);
 	/* Limit blocks in region, it will be needed for ftl_md_set_region */
@@ -180,17 +185,52 @@ recovery_iteration_cb(struct spdk_ftl_dev *dev, void *_ctx, int status)
 	}
 }
 
+static uint64_t
+recovery_num_p2l_maps(struct spdk_ftl_dev *dev)
+{
+	struct ftl_nv_cache *nv_cache = &dev->nv_cache;
+	uint64_t i, num = 0;
+
+	for (i = 0; i < ftl_get_num_bands(dev); i++) {
+		if (FTL_BAND_STATE_FREE != dev->bands[i].md->state) {
+			num++;
+		}
+	}
+
+	for (i = 0; i < nv_cache->chunk_count; i++) {
+		if (nv_cache->chunks[i].recovery) {
+			num++;
+		}
+	}
+
+	return num;
+}
+
 static void
 ftl_mngt_recovery_run_iteration(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
 {
+	struct spdk_ftl_recovery_progress *progress = &dev->recovery.progress;
 	struct ftl_mngt_recovery_ctx *ctx = ftl_mngt_get_process_ctx(mngt);
+	uint64_t elapsed_ms;
 
 	if (ftl_fast_recovery(dev)) {
 		ftl_mngt_skip_step(mngt);
 		return;
 	}
 
+	if (0 == progress->iteration) {
+		/* Each iteration applies all the P2L maps to its part of L2P */
+		progress->p2l_maps_total = progress->iterations * recovery_num_p2l_maps(dev);
+	}
+
 	if (recovery_iter_done(dev, ctx)) {
+		dev->recovery.end_tsc = spdk_get_ticks();
+		progress->state = SPDK_FTL_RECOVERY_STATE_DONE;
+		elapsed_ms = (dev->recovery.end_tsc - dev->recovery.start_tsc) * 1000 /
+			     spdk_get_ticks_hz();
+		FTL_NOTICELOG(dev, "L2P recovered in %"PRIu64"ms, applied %"PRIu64" P2L maps on %"
+			      PRIu32" threads\n", elapsed_ms, progress->p2l_maps_done,
+			      progress->num_threads);
 		ftl_mngt_next_step(mngt);
 	} else {
 		ftl_mngt_process_execute(dev, &g_desc_recovery_iteration, recovery_iteration_cb, ctx);
@@ -369,6 +409,7 @@ ftl_mngt_recovery_iteration_load_l2p(struct spdk_ftl_dev *dev, struct ftl_mngt_p
 	struct ftl_layout_region *region = &ctx->l2p_snippet.region;
 
 	FTL_NOTICELOG(dev, "L2P recovery, iteration %u\n", ctx->iter.i);
+	dev->recovery.progress.iteration = ctx->iter.i;
 	FTL_NOTICELOG(dev, "Load L2P, blocks [%"PRIu64", %"PRIu64"), LBAs [%"PRIu64", %"PRIu64")\n",
 		      region->current.offset, region->current.offset + region->current.blocks,
 		      ctx->iter.lba_first, ctx->iter.lba_last);
@@ -392,59 +433,46 @@ ftl_mngt_recovery_iteration_save_l2p(struct spdk_ftl_dev *dev, struct ftl_mngt_p
 }
 
 static void
-restore_band_l2p_cb(struct ftl_band *band, void *cntx, enum ftl_md_status status)
+recovery_invalidate_p2l(struct ftl_band *band, uint64_t offset)
+{
+	/* Threads applying P2L maps of other LBA ranges may read the LBA at the same time */
+	__atomic_store_n(&band->p2l_map.band_map[offset].lba, FTL_LBA_INVALID, __ATOMIC_RELAXED);
+	band->p2l_map.band_map[offset].seq_id = 0;
+}
+
+static int
+restore_band_l2p(struct ftl_mngt_recovery_ctx *pctx, struct ftl_band *band, uint64_t lba_first,
+		 uint64_t lba_last)
 {
-	struct ftl_mngt_process *mngt = cntx;
-	struct ftl_mngt_recovery_ctx *pctx = ftl_mngt_get_caller_ctx(mngt);
-	struct band_md_ctx *sctx = ftl_mngt_get_step_ctx(mngt);
 	struct spdk_ftl_dev *dev = band->dev;
+	struct ftl_p2l_map_entry *band_map = band->p2l_map.band_map;
 	ftl_addr addr, curr_addr;
 	uint64_t i, lba, seq_id, num_blks_in_band;
-	uint32_t band_map_crc;
-	int rc = 0;
-
-	if (status != FTL_MD_SUCCESS) {
-		FTL_ERRLOG(dev, "L2P band restore error, failed to read P2L map\n");
-		rc = -EIO;
-		goto cleanup;
-	}
-
-	band_map_crc = spdk_crc32c_update(band->p2l_map.band_map,
-					  ftl_tail_md_num_blocks(band->dev) * FTL_BLOCK_SIZE, 0);
-
-	/* P2L map is only valid if the band state is closed */
-	if (FTL_BAND_STATE_CLOSED == band->md->state && band->md->p2l_map_checksum != band_map_crc) {
-		FTL_ERRLOG(dev, "L2P band restore error, inconsistent P2L map CRC\n");
-		ftl_stats_crc_error(dev, FTL_STATS_TYPE_MD_BASE);
-		rc = -EINVAL;
-		goto cleanup;
-	}
 
 	num_blks_in_band = ftl_get_num_blocks_in_band(dev);
 	for (i = 0; i < num_blks_in_band; ++i) {
 		uint64_t lba_off;
-		lba = band->p2l_map.band_map[i].lba;
-		seq_id = band->p2l_map.band_map[i].seq_id;
+		lba = __atomic_load_n(&band_map[i].lba, __ATOMIC_RELAXED);
 
 		if (lba == FTL_LBA_INVALID) {
 			continue;
 		}
 		if (lba >= dev->num_lbas) {
 			FTL_ERRLOG(dev, "L2P band restore ERROR, LBA out of range\n");
-			rc = -EINVAL;
-			break;
+			return -EINVAL;
 		}
-		if (lba < pctx->iter.lba_first || lba >= pctx->iter.lba_last) {
+		if (lba < lba_first || lba >= lba_last) {
 			continue;
 		}
 
+		/* Entries of the LBA are only modified by the thread owning its range */
+		seq_id = band_map[i].seq_id;
 		lba_off = lba - pctx->iter.lba_first;
 		if (seq_id < pctx->l2p_snippet.seq_id[lba_off]) {
 
 			/* Overlapped band/chunk has newer data - invalidate P2L map on open/full band  */
 			if (FTL_BAND_STATE_OPEN == band->md->state || FTL_BAND_STATE_FULL == band->md->state) {
-				addr = ftl_band_addr_from_block_offset(band, i);
-				ftl_band_set_p2l(band, FTL_LBA_INVALID, addr, 0);
+				recovery_invalidate_p2l(band, i);
 			}
 
 			/* Newer data already recovered */
@@ -461,9 +489,12 @@ restore_band_l2p_cb(struct ftl_band *band, void *cntx, enum ftl_md_status status
 
 			if (FTL_BAND_STATE_OPEN == curr_band->md->state || FTL_BAND_STATE_FULL == curr_band->md->state) {
 				size_t prev_offset = ftl_band_block_offset_from_addr(curr_band, curr_addr);
-				if (curr_band->p2l_map.band_map[prev_offset].lba == lba &&
-				    seq_id >= curr_band->p2l_map.band_map[prev_offset].seq_id) {
-					ftl_band_set_p2l(curr_band, FTL_LBA_INVALID, curr_addr, 0);
+				struct ftl_p2l_map_entry *prev;
+
+				prev = &curr_band->p2l_map.band_map[prev_offset];
+				if (__atomic_load_n(&prev->lba, __ATOMIC_RELAXED) == lba &&
+				    seq_id >= prev->seq_id) {
+					recovery_invalidate_p2l(curr_band, prev_offset);
 				}
 			}
 		}
@@ -472,45 +503,21 @@ restore_band_l2p_cb(struct ftl_band *band, void *cntx, enum ftl_md_status status
 		pctx->l2p_snippet.seq_id[lba_off] = seq_id;
 	}
 
-
-cleanup:
-	ftl_band_release_p2l_map(band);
-
-	sctx->qd--;
-	if (rc) {
-		sctx->status = rc;
-	}
-
-	ftl_mngt_continue_step(mngt);
-}
-
-static void
-ftl_mngt_recovery_iteration_restore_band_l2p(struct spdk_ftl_dev *dev,
-		struct ftl_mngt_process *mngt)
-{
-	ftl_mngt_recovery_walk_band_tail_md(dev, mngt, restore_band_l2p_cb);
+	return 0;
 }
 
 static int
-restore_chunk_l2p_cb(struct ftl_nv_cache_chunk *chunk, void *ctx)
+restore_chunk_l2p(struct ftl_mngt_recovery_ctx *pctx, struct ftl_nv_cache_chunk *chunk,
+		  uint64_t lba_first, uint64_t lba_last)
 {
-	struct ftl_mngt_recovery_ctx *pctx = ctx;
 	struct spdk_ftl_dev *dev;
 	struct ftl_nv_cache *nv_cache = chunk->nv_cache;
 	ftl_addr addr;
 	const uint64_t seq_id = chunk->md->seq_id;
 	uint64_t i, lba;
-	uint32_t chunk_map_crc;
 
 	dev = SPDK_CONTAINEROF(chunk->nv_cache, struct spdk_ftl_dev, nv_cache);
 
-	chunk_map_crc = spdk_crc32c_update(chunk->p2l_map.chunk_map,
-					   ftl_nv_cache_chunk_tail_md_num_blocks(chunk->nv_cache) * FTL_BLOCK_SIZE, 0);
-	if (chunk->md->p2l_map_checksum != chunk_map_crc) {
-		ftl_stats_crc_error(dev, FTL_STATS_TYPE_MD_NV_CACHE);
-		return -1;
-	}
-
 	for (i = 0; i < nv_cache->chunk_blocks; ++i) {
 		uint64_t lba_off;
 
@@ -521,9 +528,9 @@ restore_chunk_l2p_cb(struct ftl_nv_cache_chunk *chunk, void *ctx)
 		}
 		if (lba >= dev->num_lbas) {
 			FTL_ERRLOG(dev, "L2P Chunk restore ERROR, LBA out of range\n");
-			return -1;
+			return -EINVAL;
 		}
-		if (lba < pctx->iter.lba_first || lba >= pctx->iter.lba_last) {
+		if (lba < lba_first || lba >= lba_last) {
 			continue;
 		}
 
@@ -541,6 +548,194 @@ restore_chunk_l2p_cb(struct ftl_nv_cache_chunk *chunk, void *ctx)
 	return 0;
 }
 
+/*
+ * P2L map of a band or chunk is applied to the L2P snippet by all IO threads in parallel. Each
+ * thread walks the whole map, but only applies the entries of its own range of LBAs, so every
+ * L2P entry (and the P2L entries of open bands describing it) is modified by a single thread.
+ * Conflicts are still resolved by sequence IDs, independent of the order the maps are applied in.
+ */
+struct recovery_apply_ctx;
+
+struct recovery_apply_part {
+	struct recovery_apply_ctx	*actx;
+	uint64_t			lba_first;
+	uint64_t			lba_last;
+	int				status;
+};
+
+struct recovery_apply_ctx {
+	struct ftl_mngt_process		*mngt;
+	struct ftl_mngt_recovery_ctx	*pctx;
+
+	/* Either band or chunk, whose P2L map is applied */
+	struct ftl_band			*band;
+	struct ftl_nv_cache_chunk	*chunk;
+
+	uint32_t			remaining;
+	int				status;
+	struct recovery_apply_part	parts[];
+};
+
+static int
+recovery_apply_p2l_map(struct ftl_mngt_recovery_ctx *pctx, struct ftl_band *band,
+		       struct ftl_nv_cache_chunk *chunk, uint64_t lba_first, uint64_t lba_last)
+{
+	if (band) {
+		return restore_band_l2p(pctx, band, lba_first, lba_last);
+	} else {
+		return restore_chunk_l2p(pctx, chunk, lba_first, lba_last);
+	}
+}
+
+static void
+recovery_apply_done(struct ftl_mngt_process *mngt, struct ftl_band *band,
+		    struct ftl_nv_cache_chunk *chunk, int status)
+{
+	struct spdk_ftl_dev *dev = ftl_mngt_get_dev(mngt);
+	struct band_md_ctx *sctx;
+
+	dev->recovery.progress.p2l_maps_done++;
+
+	if (!band) {
+		ftl_mngt_nv_cache_restore_l2p_done(mngt, chunk, status);
+		return;
+	}
+
+	sctx = ftl_mngt_get_step_ctx(mngt);
+	ftl_band_release_p2l_map(band);
+
+	sctx->qd--;
+	if (status) {
+		sctx->status = status;
+	}
+
+	ftl_mngt_continue_step(mngt);
+}
+
+static void
+recovery_apply_part_done(void *_part)
+{
+	struct recovery_apply_part *part = _part;
+	struct recovery_apply_ctx *actx = part->actx;
+
+	if (part->status) {
+		actx->status = part->status;
+	}
+
+	assert(actx->remaining > 0);
+	if (--actx->remaining) {
+		return;
+	}
+
+	recovery_apply_done(actx->mngt, actx->band, actx->chunk, actx->status);
+	free(actx);
+}
+
+static void
+recovery_apply_part(void *_part)
+{
+	struct recovery_apply_part *part = _part;
+	struct recovery_apply_ctx *actx = part->actx;
+	struct spdk_ftl_dev *dev = ftl_mngt_get_dev(actx->mngt);
+
+	part->status = recovery_apply_p2l_map(actx->pctx, actx->band, actx->chunk,
+					      part->lba_first, part->lba_last);
+	spdk_thread_send_msg(dev->core_thread, recovery_apply_part_done, part);
+}
+
+static void
+recovery_apply(struct ftl_mngt_process *mngt, struct ftl_band *band,
+	       struct ftl_nv_cache_chunk *chunk)
+{
+	struct spdk_ftl_dev *dev = ftl_mngt_get_dev(mngt);
+	struct ftl_mngt_recovery_ctx *pctx = ftl_mngt_get_caller_ctx(mngt);
+	struct recovery_apply_ctx *actx = NULL;
+	struct recovery_apply_part *part;
+	uint64_t num_lbas = pctx->iter.lba_last - pctx->iter.lba_first;
+	uint32_t i, num_parts = dev->num_io_threads;
+	int rc;
+
+	if (num_parts) {
+		actx = calloc(1, sizeof(*actx) + num_parts * sizeof(actx->parts[0]));
+	}
+
+	if (!actx) {
+		/* No IO threads (or no memory for the context), apply the whole map right away */
+		rc = recovery_apply_p2l_map(pctx, band, chunk, pctx->iter.lba_first,
+					    pctx->iter.lba_last);
+		recovery_apply_done(mngt, band, chunk, rc);
+		return;
+	}
+
+	actx->mngt = mngt;
+	actx->pctx = pctx;
+	actx->band = band;
+	actx->chunk = chunk;
+	actx->remaining = num_parts;
+
+	for (i = 0; i < num_parts; i++) {
+		part = &actx->parts[i];
+		part->actx = actx;
+		part->lba_first = pctx->iter.lba_first + num_lbas * i / num_parts;
+		part->lba_last = pctx->iter.lba_first + num_lbas * (i + 1) / num_parts;
+
+		spdk_thread_send_msg(dev->io_threads[i].thread, recovery_apply_part, part);
+	}
+}
+
+static void
+restore_band_l2p_cb(struct ftl_band *band, void *cntx, enum ftl_md_status status)
+{
+	struct ftl_mngt_process *mngt = cntx;
+	struct spdk_ftl_dev *dev = band->dev;
+	uint32_t band_map_crc;
+
+	if (status != FTL_MD_SUCCESS) {
+		FTL_ERRLOG(dev, "L2P band restore error, failed to read P2L map\n");
+		recovery_apply_done(mngt, band, NULL, -EIO);
+		return;
+	}
+
+	band_map_crc = spdk_crc32c_update(band->p2l_map.band_map,
+					  ftl_tail_md_num_blocks(band->dev) * FTL_BLOCK_SIZE, 0);
+
+	/* P2L map is only valid if the band state is closed */
+	if (FTL_BAND_STATE_CLOSED == band->md->state && band->md->p2l_map_checksum != band_map_crc) {
+		FTL_ERRLOG(dev, "L2P band restore error, inconsistent P2L map CRC\n");
+		ftl_stats_crc_error(dev, FTL_STATS_TYPE_MD_BASE);
+		recovery_apply_done(mngt, band, NULL, -EINVAL);
+		return;
+	}
+
+	recovery_apply(mngt, band, NULL);
+}
+
+static void
+ftl_mngt_recovery_iteration_restore_band_l2p(struct spdk_ftl_dev *dev,
+		struct ftl_mngt_process *mngt)
+{
+	ftl_mngt_recovery_walk_band_tail_md(dev, mngt, restore_band_l2p_cb);
+}
+
+static void
+restore_chunk_l2p_cb(struct ftl_nv_cache_chunk *chunk, struct ftl_mngt_process *mngt, void *ctx)
+{
+	struct spdk_ftl_dev *dev;
+	uint32_t chunk_map_crc;
+
+	dev = SPDK_CONTAINEROF(chunk->nv_cache, struct spdk_ftl_dev, nv_cache);
+
+	chunk_map_crc = spdk_crc32c_update(chunk->p2l_map.chunk_map,
+					   ftl_nv_cache_chunk_tail_md_num_blocks(chunk->nv_cache) * FTL_BLOCK_SIZE, 0);
+	if (chunk->md->p2l_map_checksum != chunk_map_crc) {
+		ftl_stats_crc_error(dev, FTL_STATS_TYPE_MD_NV_CACHE);
+		recovery_apply_done(mngt, NULL, chunk, -EINVAL);
+		return;
+	}
+
+	recovery_apply(mngt, NULL, chunk);
+}
+
 static void
 ftl_mngt_recovery_iteration_restore_chunk_l2p(struct spdk_ftl_dev *dev,
 		struct ftl_mngt_process *mngt)
@@ -5192,6 +5192,8 @@ _nvmf_request_complete(void *ctx)
 		assert(sgroup != NULL);
 		if (spdk_likely(qpair->qid != 0)) {
 			qpair->group->stat.completed_nvme_io++;
+			qpair->group->stat.completed_nvme_bytes += req->length;
+			qpair->balance_io++;
 		} else if (req->cmd->nvme_cmd.opc == SPDK_NVME_OPC_ASYNC_EVENT_REQUEST) {
 			is_aer = true;
 		}
@@ -23,6 +23,16 @@ SPDK_LOG_REGISTER_COMPONENT(nvmf)
 
 #define SPDK_NVMF_DEFAULT_MAX_SUBSYSTEMS 1024
 
+/* Period of the poll group load sampling */
+#define NVMF_POLL_GROUP_LOAD_PERIOD_US		(100 * 1000)
+/* Consecutive overloaded samples after which a poll group migrates one of its qpairs */
+#define NVMF_POLL_GROUP_OVERLOAD_PERIODS	10
+/* Busy percentage added to poll groups on another NUMA node than the one of the qpair */
+#define NVMF_POLL_GROUP_REMOTE_NUMA_PENALTY	25
+/* Time given to a qpair to complete its outstanding commands before its migration is abandoned */
+#define NVMF_QPAIR_MIGRATE_TIMEOUT_US		(100 * 1000)
+#define NVMF_QPAIR_MIGRATE_POLL_US		10
+
 static TAILQ_HEAD(, spdk_nvmf_tgt) g_nvmf_tgts = TAILQ_HEAD_INITIALIZER(g_nvmf_tgts);
 
 spdk_nvmf_custom_discovery_filter g_custom_discovery_filter;
@@ -334,6 +344,10 @@ nvmf_tgt_cleanup_poll_group(struct spdk_nvmf_poll_group *group)
 		nvmf_transport_poll_group_destroy(tgroup);
 	}
 
+	spdk_poller_unregister(&group->load_poller);
+	spdk_poller_unregister(&group->migration.poller);
+	group->migration.qpair = NULL;
+
 	for (sid = 0; sid < group->num_sgroups; sid++) {
 		sgroup = &group->sgroups[sid];
 
@@ -401,6 +415,320 @@ nvmf_poll_group_add_transport(struct spdk_nvmf_poll_group *group,
 	return 0;
 }
 
+static bool
+nvmf_poll_group_is_local(struct spdk_nvmf_poll_group *group, int32_t numa_id)
+{
+	return numa_id == SPDK_ENV_NUMA_ID_ANY || group->load.numa_id == SPDK_ENV_NUMA_ID_ANY ||
+	       group->load.numa_id == numa_id;
+}
+
+uint32_t
+nvmf_poll_group_get_score(struct spdk_nvmf_poll_group *group, int32_t numa_id)
+{
+	uint32_t qpairs = group->stat.current_io_qpairs;
+	uint32_t new_qpairs = __atomic_load_n(&group->load.new_qpairs, __ATOMIC_RELAXED);
+	uint32_t score = group->load.busy_pct;
+
+	if (qpairs != 0) {
+		score = score * (qpairs + new_qpairs) / qpairs;
+	}
+
+	if (!nvmf_poll_group_is_local(group, numa_id)) {
+		score += NVMF_POLL_GROUP_REMOTE_NUMA_PENALTY;
+	}
+
+	return score;
+}
+
+int
+nvmf_poll_group_cmp_load(struct spdk_nvmf_poll_group *a, struct spdk_nvmf_poll_group *b,
+			 int32_t numa_id)
+{
+	uint32_t a_score, b_score, a_qpairs, b_qpairs, a_new, b_new;
+
+	a_score = nvmf_poll_group_get_score(a, numa_id);
+	b_score = nvmf_poll_group_get_score(b, numa_id);
+	if (a_score != b_score) {
+		return a_score < b_score ? -1 : 1;
+	}
+
+	/* Spread the qpairs evenly between poll groups that are equally (typically not) busy */
+	a_new = __atomic_load_n(&a->load.new_qpairs, __ATOMIC_RELAXED);
+	b_new = __atomic_load_n(&b->load.new_qpairs, __ATOMIC_RELAXED);
+	a_qpairs = a->stat.current_io_qpairs + a_new;
+	b_qpairs = b->stat.current_io_qpairs + b_new;
+	if (a_qpairs != b_qpairs) {
+		return a_qpairs < b_qpairs ? -1 : 1;
+	}
+
+	return 0;
+}
+
+static bool
+nvmf_qpair_is_migratable(struct spdk_nvmf_qpair *qpair)
+{
+	struct spdk_nvmf_ctrlr *ctrlr = qpair->ctrlr;
+
+	return !nvmf_qpair_is_admin_queue(qpair) && qpair->state == SPDK_NVMF_QPAIR_ENABLED &&
+	       qpair->transport->ops->poll_group_detach != NULL && ctrlr != NULL &&
+	       !ctrlr->in_destruct && !ctrlr->disconnect_in_progress;
+}
+
+static void
+nvmf_poll_group_attach_qpair(void *ctx)
+{
+	struct spdk_nvmf_qpair *qpair = ctx;
+	struct spdk_nvmf_poll_group *group = qpair->group;
+	struct spdk_nvmf_transport_poll_group *tgroup;
+	struct spdk_nvmf_ctrlr *ctrlr = qpair->ctrlr;
+	bool disconnect_deferred = qpair->disconnect_deferred;
+	int rc = -EINVAL;
+
+	qpair->migrating = false;
+	qpair->disconnect_deferred = false;
+	TAILQ_INSERT_TAIL(&group->qpairs, qpair, link);
+	spdk_thread_get_numa_ref(spdk_nvmf_qpair_get_numa_id(qpair));
+	group->stat.current_io_qpairs++;
+
+	tgroup = nvmf_get_transport_poll_group(group, qpair->transport);
+	if (tgroup != NULL) {
+		rc = nvmf_transport_poll_group_attach(tgroup, qpair);
+	}
+
+	if (rc != 0) {
+		SPDK_ERRLOG("Unable to attach qpair %u of ctrlr %u to poll group %s\n", qpair->qid,
+			    ctrlr->cntlid, spdk_thread_get_name(group->thread));
+		spdk_nvmf_qpair_disconnect(qpair);
+	} else if (disconnect_deferred || ctrlr->in_destruct || ctrlr->disconnect_in_progress ||
+		   group->sgroups[ctrlr->subsys->id].state == SPDK_NVMF_SUBSYSTEM_INACTIVE) {
+		/* The qpair may have been missed by the poll group iteration disconnecting it */
+		spdk_nvmf_qpair_disconnect(qpair);
+	}
+}
+
+static void
+nvmf_poll_group_migrate_done(struct spdk_nvmf_poll_group *group)
+{
+	spdk_poller_unregister(&group->migration.poller);
+	group->migration.qpair = NULL;
+	group->migration.dst = NULL;
+}
+
+static int
+nvmf_poll_group_migrate_poll(void *ctx)
+{
+	struct spdk_nvmf_poll_group *group = ctx;
+	struct spdk_nvmf_qpair *qpair = group->migration.qpair;
+	struct spdk_nvmf_poll_group *dst = group->migration.dst;
+	struct spdk_nvmf_transport_poll_group *tgroup;
+	int rc = -EAGAIN;
+
+	if (qpair->state != SPDK_NVMF_QPAIR_ENABLED) {
+		/* The qpair is being disconnected */
+		nvmf_poll_group_migrate_done(group);
+		return SPDK_POLLER_BUSY;
+	}
+
+	tgroup = nvmf_get_transport_poll_group(group, qpair->transport);
+	assert(tgroup != NULL);
+
+	if (!nvmf_qpair_is_migratable(qpair)) {
+		rc = -ECANCELED;
+	} else if (TAILQ_EMPTY(&qpair->outstanding) &&
+		   group->sgroups[qpair->ctrlr->subsys->id].state == SPDK_NVMF_SUBSYSTEM_ACTIVE) {
+		/* Requests queued by a paused subsystem aren't tracked in the outstanding list */
+		rc = nvmf_transport_poll_group_detach(tgroup, qpair);
+	}
+
+	if (rc == -EAGAIN && spdk_get_ticks() < group->migration.timeout_tsc) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	nvmf_poll_group_migrate_done(group);
+
+	if (rc != 0) {
+		SPDK_DEBUGLOG(nvmf, "Could not migrate qpair %u of ctrlr %u: %s\n", qpair->qid,
+			      qpair->ctrlr->cntlid, spdk_strerror(-rc));
+		/* Let the qpair resume in this poll group */
+		if (nvmf_transport_poll_group_attach(tgroup, qpair) != 0) {
+			spdk_nvmf_qpair_disconnect(qpair);
+		}
+		return SPDK_POLLER_BUSY;
+	}
+
+	SPDK_DEBUGLOG(nvmf, "Migrating qpair %u of ctrlr %u from %s to %s\n", qpair->qid,
+		      qpair->ctrlr->cntlid, spdk_thread_get_name(group->thread),
+		      spdk_thread_get_name(dst->thread));
+
+	TAILQ_REMOVE(&group->qpairs, qpair, link);
+	spdk_thread_put_numa_ref(spdk_nvmf_qpair_get_numa_id(qpair));
+	assert(group->stat.current_io_qpairs > 0);
+	group->stat.current_io_qpairs--;
+
+	/* Messages sent to the qpair's poll group from now on are processed by the new one.  Those
+	 * sent before the attach message is queued may still find the qpair detached, so it's
+	 * marked as migrating until it's attached. */
+	qpair->migrating = true;
+	qpair->group = dst;
+	spdk_thread_send_msg(dst->thread, nvmf_poll_group_attach_qpair, qpair);
+
+	return SPDK_POLLER_BUSY;
+}
+
+/*
+ * Select the qpair whose I/O is the closest to the share of the poll group's load that would
+ * even out the busy percentage of both poll groups.  Qpairs doing more I/O than the whole
+ * difference are skipped, as migrating them would only move the imbalance to the other group.
+ */
+static struct spdk_nvmf_qpair *
+nvmf_poll_group_select_migration(struct spdk_nvmf_poll_group *group, uint32_t gap)
+{
+	struct spdk_nvmf_qpair *qpair, *best = NULL;
+	uint64_t total_io = 0, max_io, target_io, distance, best_distance = UINT64_MAX;
+
+	TAILQ_FOREACH(qpair, &group->qpairs, link) {
+		if (nvmf_qpair_is_migratable(qpair)) {
+			total_io += qpair->balance_io;
+		}
+	}
+
+	max_io = total_io * gap / group->load.busy_pct;
+	target_io = max_io / 2;
+
+	TAILQ_FOREACH(qpair, &group->qpairs, link) {
+		if (!nvmf_qpair_is_migratable(qpair) || qpair->balance_io == 0 ||
+		    qpair->balance_io > max_io) {
+			continue;
+		}
+
+		distance = qpair->balance_io > target_io ? qpair->balance_io - target_io :
+			   target_io - qpair->balance_io;
+		if (distance < best_distance) {
+			best = qpair;
+			best_distance = distance;
+		}
+	}
+
+	return best;
+}
+
+static void
+nvmf_poll_group_balance(struct spdk_nvmf_poll_group *group)
+{
+	struct spdk_nvmf_tgt *tgt = group->tgt;
+	struct spdk_nvmf_poll_group *pg, *dst = NULL;
+	struct spdk_nvmf_qpair *qpair;
+	uint32_t dst_score;
+
+	if (group->migration.qpair != NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&tgt->mutex);
+	TAILQ_FOREACH(pg, &tgt->poll_groups, link) {
+		if (pg != group && (dst == NULL ||
+				    nvmf_poll_group_cmp_load(pg, dst, group->load.numa_id) < 0)) {
+			dst = pg;
+		}
+	}
+	pthread_mutex_unlock(&tgt->mutex);
+
+	dst_score = dst != NULL ? nvmf_poll_group_get_score(dst, group->load.numa_id) : 0;
+	if (dst == NULL || group->load.busy_pct < dst_score + tgt->qpair_balance_threshold) {
+		group->overload_periods = 0;
+		return;
+	}
+
+	if (group->overload_periods++ == 0) {
+		/* Start measuring the I/O of each qpair */
+		TAILQ_FOREACH(qpair, &group->qpairs, link) {
+			qpair->balance_io = 0;
+		}
+		return;
+	}
+
+	if (group->overload_periods < NVMF_POLL_GROUP_OVERLOAD_PERIODS) {
+		return;
+	}
+
+	group->overload_periods = 0;
+	qpair = nvmf_poll_group_select_migration(group, group->load.busy_pct - dst_score);
+	if (qpair == NULL) {
+		return;
+	}
+
+	group->migration.poller = SPDK_POLLER_REGISTER(nvmf_poll_group_migrate_poll, group,
+				  NVMF_QPAIR_MIGRATE_POLL_US);
+	if (group->migration.poller == NULL) {
+		SPDK_ERRLOG("Unable to register the qpair migration poller\n");
+		return;
+	}
+
+	group->migration.qpair = qpair;
+	group->migration.dst = dst;
+	group->migration.timeout_tsc = spdk_get_ticks() + NVMF_QPAIR_MIGRATE_TIMEOUT_US *
+				       spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+	__atomic_fetch_add(&dst->load.new_qpairs, 1, __ATOMIC_RELAXED);
+}
+
+static uint64_t
+nvmf_poll_group_get_rate(uint64_t count, uint64_t ticks)
+{
+	return (uint64_t)((double)count * spdk_get_ticks_hz() / ticks);
+}
+
+static int
+nvmf_poll_group_sample_load(void *ctx)
+{
+	struct spdk_nvmf_poll_group *group = ctx;
+	struct spdk_nvmf_poll_group_load *load = &group->load;
+	struct spdk_thread_stats stats;
+	uint64_t now, ticks, busy, idle;
+
+	now = spdk_get_ticks();
+	ticks = now - group->load_sample.tsc;
+	if (spdk_unlikely(ticks == 0) || spdk_thread_get_stats(&stats) != 0) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	busy = stats.busy_tsc - group->load_sample.busy_tsc;
+	idle = stats.idle_tsc - group->load_sample.idle_tsc;
+	load->busy_pct = busy + idle != 0 ? busy * 100 / (busy + idle) : 0;
+	load->iops = nvmf_poll_group_get_rate(group->stat.completed_nvme_io -
+					      group->load_sample.completed_nvme_io, ticks);
+	load->bytes_per_sec = nvmf_poll_group_get_rate(group->stat.completed_nvme_bytes -
+			      group->load_sample.completed_nvme_bytes, ticks);
+	/* The thread may have been moved to another core by the scheduler */
+	load->numa_id = spdk_env_get_numa_id(spdk_env_get_current_core());
+	__atomic_store_n(&load->new_qpairs, 0, __ATOMIC_RELAXED);
+
+	group->load_sample.tsc = now;
+	group->load_sample.busy_tsc = stats.busy_tsc;
+	group->load_sample.idle_tsc = stats.idle_tsc;
+	group->load_sample.completed_nvme_io = group->stat.completed_nvme_io;
+	group->load_sample.completed_nvme_bytes = group->stat.completed_nvme_bytes;
+
+	if (group->tgt->qpair_balance_threshold != 0) {
+		nvmf_poll_group_balance(group);
+	}
+
+	return SPDK_POLLER_IDLE;
+}
+
+static void
+nvmf_poll_group_init_load(struct spdk_nvmf_poll_group *group)
+{
+	struct spdk_thread_stats stats = {};
+
+	spdk_thread_get_stats(&stats);
+	group->load.numa_id = spdk_env_get_numa_id(spdk_env_get_current_core());
+	group->load_sample.tsc = spdk_get_ticks();
+	group->load_sample.busy_tsc = stats.busy_tsc;
+	group->load_sample.idle_tsc = stats.idle_tsc;
+	group->load_poller = SPDK_POLLER_REGISTER(nvmf_poll_group_sample_load, group,
+			     NVMF_POLL_GROUP_LOAD_PERIOD_US);
+}
+
 static int
 nvmf_tgt_create_poll_group(void *io_device, void *ctx_buf)
 {
@@ -448,6 +776,8 @@ nvmf_tgt_create_poll_group(void *io_device, void *ctx_buf)
 		}
 	}
 
+	nvmf_poll_group_init_load(group);
+
 	pthread_mutex_lock(&tgt->mutex);
 	tgt->num_poll_groups++;
 	TAILQ_INSERT_TAIL(&tgt->poll_groups, group, link);
@@ -555,6 +885,7 @@ spdk_nvmf_tgt_create(struct spdk_nvmf_target_opts *_opts)
 	tgt->discovery_genctr = 0;
 	tgt->dhchap_digests = opts.dhchap_digests;
 	tgt->dhchap_dhgroups = opts.dhchap_dhgroups;
+	tgt->qpair_balance_threshold = opts.qpair_balance_threshold;
 	TAILQ_INIT(&tgt->transports);
 	TAILQ_INIT(&tgt->poll_groups);
 	TAILQ_INIT(&tgt->referrals);
@@ -1357,6 +1688,7 @@ spdk_nvmf_tgt_new_qpair(struct spdk_nvmf_tgt *tgt, struct spdk_nvmf_qpair *qpair
 	pthread_mutex_lock(&group->mutex);
 	group->current_unassociated_qpairs++;
 	pthread_mutex_unlock(&group->mutex);
+	__atomic_fetch_add(&group->load.new_qpairs, 1, __ATOMIC_RELAXED);
 
 	spdk_thread_send_msg(group->thread, _nvmf_poll_group_add, ctx);
 }
@@ -1411,6 +1743,7 @@ spdk_nvmf_poll_group_add(struct spdk_nvmf_poll_group *group,
 	if (rc == 0) {
 		SPDK_DTRACE_PROBE2_TICKS(nvmf_poll_group_add_qpair, qpair, spdk_thread_get_id(group->thread));
 		TAILQ_INSERT_TAIL(&group->qpairs, qpair, link);
+		spdk_thread_get_numa_ref(spdk_nvmf_qpair_get_numa_id(qpair));
 		nvmf_qpair_set_state(qpair, SPDK_NVMF_QPAIR_CONNECTING);
 	}
 
@@ -1492,7 +1825,12 @@ spdk_nvmf_poll_group_remove(struct spdk_nvmf_qpair *qpair)
 		}
 	}
 
+	if (qpair->group->migration.qpair == qpair) {
+		nvmf_poll_group_migrate_done(qpair->group);
+	}
+
 	TAILQ_REMOVE(&qpair->group->qpairs, qpair, link);
+	spdk_thread_put_numa_ref(spdk_nvmf_qpair_get_numa_id(qpair));
 	qpair->group = NULL;
 }
 
@@ -1594,6 +1932,13 @@ spdk_nvmf_qpair_disconnect(struct spdk_nvmf_qpair *qpair)
 		return 0;
 	}
 
+	if (spdk_unlikely(qpair->migrating)) {
+		/* The qpair isn't in the poll group yet, disconnect it once it's attached */
+		qpair->disconnect_deferred = true;
+		__atomic_clear(&qpair->disconnect_started, __ATOMIC_RELAXED);
+		return 0;
+	}
+
 	SPDK_DTRACE_PROBE2_TICKS(nvmf_qpair_disconnect, qpair, spdk_thread_get_id(group->thread));
 	assert(spdk_nvmf_qpair_is_active(qpair));
 	nvmf_qpair_set_state(qpair, SPDK_NVMF_QPAIR_DEACTIVATING);
@@ -2076,6 +2421,11 @@ spdk_nvmf_poll_group_dump_stat(struct spdk_nvmf_poll_group *group, struct spdk_j
 	spdk_json_write_named_uint32(w, "current_io_qpairs", group->stat.current_io_qpairs);
 	spdk_json_write_named_uint64(w, "pending_bdev_io", group->stat.pending_bdev_io);
 	spdk_json_write_named_uint64(w, "completed_nvme_io", group->stat.completed_nvme_io);
+	spdk_json_write_named_uint64(w, "completed_nvme_bytes", group->stat.completed_nvme_bytes);
+	spdk_json_write_named_uint64(w, "load_iops", group->load.iops);
+	spdk_json_write_named_uint64(w, "load_bytes_per_sec", group->load.bytes_per_sec);
+	spdk_json_write_named_uint32(w, "load_busy_pct", group->load.busy_pct);
+	spdk_json_write_named_int32(w, "numa_id", group->load.numa_id);
 
 	spdk_json_write_named_array_begin(w, "transports");
 
@@ -116,6 +116,9 @@ struct spdk_nvmf_tgt {
 	uint32_t				dhchap_digests;
 	uint32_t				dhchap_dhgroups;
 
+	/* Busy percentage difference between poll groups migrating qpairs, 0 if disabled */
+	uint32_t				qpair_balance_threshold;
+
 	TAILQ_ENTRY(spdk_nvmf_tgt)		link;
 };
 
@@ -607,6 +610,21 @@ nvmf_qpair_is_admin_queue(struct spdk_nvmf_qpair *qpair)
 
 void nvmf_qpair_set_state(struct spdk_nvmf_qpair *qpair, enum spdk_nvmf_qpair_state state);
 
+/**
+ * Get the busy percentage a poll group is expected to reach once the qpairs placed on it since
+ * its last load sample load it like the ones it already has.  It's increased if the poll group
+ * isn't local to NUMA node numa_id.
+ */
+uint32_t nvmf_poll_group_get_score(struct spdk_nvmf_poll_group *group, int32_t numa_id);
+
+/**
+ * Compare the measured load of two poll groups to place a qpair local to NUMA node numa_id.
+ *
+ * \return negative if a is the better choice, positive if b is and 0 if both are equivalent.
+ */
+int nvmf_poll_group_cmp_load(struct spdk_nvmf_poll_group *a, struct spdk_nvmf_poll_group *b,
+			     int32_t numa_id);
+
 int nvmf_qpair_auth_init(struct spdk_nvmf_qpair *qpair);
 void nvmf_qpair_auth_destroy(struct spdk_nvmf_qpair *qpair);
 void nvmf_qpair_auth_dump(struct spdk_nvmf_qpair *qpair, struct spdk_json_write_ctx *w);
@@ -4245,18 +4245,23 @@ nvmf_rdma_get_optimal_poll_group(struct spdk_nvmf_qpair *qpair)
 		pg = &rtransport->conn_sched.next_admin_pg;
 	} else {
 		struct spdk_nvmf_rdma_poll_group *pg_min, *pg_start, *pg_current;
-		uint32_t min_value;
+		uint32_t min_value, min_score, score;
+		int32_t numa_id = spdk_nvmf_qpair_get_numa_id(qpair);
 
 		pg = &rtransport->conn_sched.next_io_pg;
 		pg_min = *pg;
 		pg_start = *pg;
 		pg_current = *pg;
 		min_value = nvmf_poll_group_get_io_qpair_count(pg_current->group.group);
+		min_score = nvmf_poll_group_get_score(pg_current->group.group, numa_id);
 
+		/* Prefer the least busy poll group, then the one with the fewest qpairs */
 		while (1) {
 			count = nvmf_poll_group_get_io_qpair_count(pg_current->group.group);
+			score = nvmf_poll_group_get_score(pg_current->group.group, numa_id);
 
-			if (count < min_value) {
+			if (score < min_score || (score == min_score && count < min_value)) {
+				min_score = score;
 				min_value = count;
 				pg_min = pg_current;
 			}
@@ -4266,7 +4271,7 @@ nvmf_rdma_get_optimal_poll_group(struct spdk_nvmf_qpair *qpair)
 				pg_current = TAILQ_FIRST(&rtransport->poll_groups);
 			}
 
-			if (pg_current == pg_start || min_value == 0) {
+			if (pg_current == pg_start || (min_score == 0 && min_value == 0)) {
 				break;
 			}
 		}
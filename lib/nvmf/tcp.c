@@ -329,6 +329,9 @@ struct spdk_nvmf_tcp_qpair {
 
 	TAILQ_ENTRY(spdk_nvmf_tcp_qpair)	link;
 	bool					pending_flush;
+
+	/* Stop receiving new commands to migrate the qpair to another poll group */
+	bool					detaching;
 };
 
 struct spdk_nvmf_tcp_control_msg {
@@ -382,8 +385,6 @@ struct spdk_nvmf_tcp_transport {
 	struct tcp_transport_opts               tcp_opts;
 	uint32_t				ack_timeout;
 
-	struct spdk_nvmf_tcp_poll_group		*next_pg;
-
 	struct spdk_poller			*accept_poller;
 	struct spdk_sock_group			*listen_sock_group;
 
@@ -1684,9 +1685,6 @@ nvmf_tcp_poll_group_create(struct spdk_nvmf_transport *transport,
 	}
 
 	TAILQ_INSERT_TAIL(&ttransport->poll_groups, tgroup, link);
-	if (ttransport->next_pg == NULL) {
-		ttransport->next_pg = tgroup;
-	}
 
 	if (spdk_interrupt_mode_is_enabled()) {
 		rc = SPDK_SOCK_GROUP_REGISTER_INTERRUPT(tgroup->sock_group,
@@ -1708,23 +1706,34 @@ static struct spdk_nvmf_transport_poll_group *
 nvmf_tcp_get_optimal_poll_group(struct spdk_nvmf_qpair *qpair)
 {
 	struct spdk_nvmf_tcp_transport *ttransport;
-	struct spdk_nvmf_tcp_poll_group **pg;
+	struct spdk_nvmf_tcp_poll_group *tgroup, *hint = NULL;
 	struct spdk_nvmf_tcp_qpair *tqpair;
-	struct spdk_sock_group *group = NULL, *hint = NULL;
+	struct spdk_sock_group *group = NULL;
+	int32_t numa_id;
 	int rc;
 
 	ttransport = SPDK_CONTAINEROF(qpair->transport, struct spdk_nvmf_tcp_transport, transport);
+	numa_id = spdk_nvmf_qpair_get_numa_id(qpair);
 
-	if (TAILQ_EMPTY(&ttransport->poll_groups)) {
-		return NULL;
+	/* Use the least loaded poll group, preferably on the NUMA node of the socket */
+	TAILQ_FOREACH(tgroup, &ttransport->poll_groups, link) {
+		/* The poll group may still be being created */
+		if (tgroup->group.group == NULL) {
+			continue;
+		}
+
+		if (hint == NULL ||
+		    nvmf_poll_group_cmp_load(tgroup->group.group, hint->group.group, numa_id) < 0) {
+			hint = tgroup;
+		}
 	}
 
-	pg = &ttransport->next_pg;
-	assert(*pg != NULL);
-	hint = (*pg)->sock_group;
+	if (hint == NULL) {
+		return NULL;
+	}
 
 	tqpair = SPDK_CONTAINEROF(qpair, struct spdk_nvmf_tcp_qpair, qpair);
-	rc = spdk_sock_get_optimal_sock_group(tqpair->sock, &group, hint);
+	rc = spdk_sock_get_optimal_sock_group(tqpair->sock, &group, hint->sock_group);
 	if (rc != 0) {
 		return NULL;
 	} else if (group != NULL) {
@@ -1732,19 +1741,13 @@ nvmf_tcp_get_optimal_poll_group(struct spdk_nvmf_qpair *qpair)
 		return spdk_sock_group_get_ctx(group);
 	}
 
-	/* The hint was used for optimal poll group, advance next_pg. */
-	*pg = TAILQ_NEXT(*pg, link);
-	if (*pg == NULL) {
-		*pg = TAILQ_FIRST(&ttransport->poll_groups);
-	}
-
-	return spdk_sock_group_get_ctx(hint);
+	return &hint->group;
 }
 
 static void
 nvmf_tcp_poll_group_destroy(struct spdk_nvmf_transport_poll_group *group)
 {
-	struct spdk_nvmf_tcp_poll_group *tgroup, *next_tgroup;
+	struct spdk_nvmf_tcp_poll_group *tgroup;
 	struct spdk_nvmf_tcp_transport *ttransport;
 
 	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_tcp_poll_group, group);
@@ -1767,14 +1770,7 @@ nvmf_tcp_poll_group_destroy(struct spdk_nvmf_transport_poll_group *group)
 
 	ttransport = SPDK_CONTAINEROF(tgroup->group.transport, struct spdk_nvmf_tcp_transport, transport);
 
-	next_tgroup = TAILQ_NEXT(tgroup, link);
 	TAILQ_REMOVE(&ttransport->poll_groups, tgroup, link);
-	if (next_tgroup == NULL) {
-		next_tgroup = TAILQ_FIRST(&ttransport->poll_groups);
-	}
-	if (ttransport->next_pg == tgroup) {
-		ttransport->next_pg = next_tgroup;
-	}
 
 	free(tgroup);
 }
@@ -2496,6 +2492,25 @@ err:
 	nvmf_tcp_send_c2h_term_req(tqpair, pdu, fes, error_offset);
 }
 
+/* Check if the requests received so far need more PDUs from the host to be executed */
+static bool
+nvmf_tcp_qpair_awaits_pdu(struct spdk_nvmf_tcp_qpair *tqpair)
+{
+	enum spdk_nvmf_tcp_req_state state;
+
+	if (tqpair->fused_first != NULL) {
+		return true;
+	}
+
+	for (state = TCP_REQUEST_STATE_NEW; state < TCP_REQUEST_STATE_READY_TO_EXECUTE; state++) {
+		if (tqpair->state_cntr[state] != 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 static int
 nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
 {
@@ -2520,6 +2535,10 @@ nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
 		switch (tqpair->recv_state) {
 		/* Wait for the common header  */
 		case NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_READY:
+			if (spdk_unlikely(tqpair->detaching) &&
+			    !nvmf_tcp_qpair_awaits_pdu(tqpair)) {
+				return NVME_TCP_PDU_IN_PROGRESS;
+			}
 			if (!pdu) {
 				pdu = SLIST_FIRST(&tqpair->tcp_pdu_free_queue);
 				if (spdk_unlikely(!pdu)) {
@@ -3497,6 +3516,91 @@ nvmf_tcp_poll_group_remove(struct spdk_nvmf_transport_poll_group *group,
 	return rc;
 }
 
+static int
+nvmf_tcp_poll_group_detach(struct spdk_nvmf_transport_poll_group *group,
+			   struct spdk_nvmf_qpair *qpair)
+{
+	struct spdk_nvmf_tcp_poll_group	*tgroup;
+	struct spdk_nvmf_tcp_qpair	*tqpair;
+	int				rc;
+
+	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_tcp_poll_group, group);
+	tqpair = SPDK_CONTAINEROF(qpair, struct spdk_nvmf_tcp_qpair, qpair);
+
+	assert(tqpair->group == tgroup);
+	if (tqpair->state != NVMF_TCP_QPAIR_STATE_RUNNING) {
+		return -EINVAL;
+	}
+
+	/* Stop receiving new commands, the qpair is detached once the ones it already received
+	 * are completed and their responses are written. */
+	tqpair->detaching = true;
+	if (tqpair->recv_state != NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_READY ||
+	    tqpair->qpair.queue_depth != 0 || tqpair->pending_flush ||
+	    tqpair->await_req_msg_pending) {
+		return -EAGAIN;
+	}
+
+	spdk_sock_flush(tqpair->sock);
+
+	rc = spdk_sock_group_remove_sock(tgroup->sock_group, tqpair->sock);
+	if (rc != 0) {
+		SPDK_ERRLOG("Could not remove sock from sock_group: %s (%d)\n",
+			    spdk_strerror(errno), errno);
+		return -errno;
+	}
+
+	SPDK_DEBUGLOG(nvmf_tcp, "detach tqpair=%p from the tgroup=%p\n", tqpair, tgroup);
+	TAILQ_REMOVE(&tgroup->qpairs, tqpair, link);
+	tqpair->group = NULL;
+
+	return 0;
+}
+
+static void
+nvmf_tcp_qpair_resume(void *arg)
+{
+	struct spdk_nvmf_tcp_qpair *tqpair = arg;
+
+	/* Process the commands received while the qpair was detaching */
+	if (tqpair->recv_state == NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_READY) {
+		nvmf_tcp_qpair_process(tqpair);
+	}
+}
+
+static int
+nvmf_tcp_poll_group_attach(struct spdk_nvmf_transport_poll_group *group,
+			   struct spdk_nvmf_qpair *qpair)
+{
+	struct spdk_nvmf_tcp_poll_group	*tgroup;
+	struct spdk_nvmf_tcp_qpair	*tqpair;
+	int				rc;
+
+	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_tcp_poll_group, group);
+	tqpair = SPDK_CONTAINEROF(qpair, struct spdk_nvmf_tcp_qpair, qpair);
+
+	if (tqpair->group == NULL) {
+		SPDK_DEBUGLOG(nvmf_tcp, "attach tqpair=%p to the tgroup=%p\n", tqpair, tgroup);
+		/* Add the qpair to the group even on failure, so that it's removed on disconnect */
+		tqpair->group = tgroup;
+		TAILQ_INSERT_TAIL(&tgroup->qpairs, tqpair, link);
+
+		rc = spdk_sock_group_add_sock(tgroup->sock_group, tqpair->sock,
+					      nvmf_tcp_sock_cb, tqpair);
+		if (rc != 0) {
+			SPDK_ERRLOG("Could not add sock to sock_group: %s (%d)\n",
+				    spdk_strerror(errno), errno);
+			return -errno;
+		}
+	}
+
+	assert(tqpair->group == tgroup);
+	tqpair->detaching = false;
+	spdk_thread_send_msg(spdk_get_thread(), nvmf_tcp_qpair_resume, tqpair);
+
+	return 0;
+}
+
 static int
 nvmf_tcp_req_complete(struct spdk_nvmf_request *req)
 {
@@ -3953,6 +4057,8 @@ const struct spdk_nvmf_transport_ops spdk_nvmf_transport_tcp = {
 	.poll_group_add = nvmf_tcp_poll_group_add,
 	.poll_group_remove = nvmf_tcp_poll_group_remove,
 	.poll_group_poll = nvmf_tcp_poll_group_poll,
+	.poll_group_detach = nvmf_tcp_poll_group_detach,
+	.poll_group_attach = nvmf_tcp_poll_group_attach,
 
 	.req_free = nvmf_tcp_req_free,
 	.req_complete = nvmf_tcp_req_complete,
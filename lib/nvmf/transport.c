@@ -774,6 +774,28 @@ nvmf_transport_poll_group_remove(struct spdk_nvmf_transport_poll_group *group,
 	return rc;
 }
 
+int
+nvmf_transport_poll_group_detach(struct spdk_nvmf_transport_poll_group *group,
+				 struct spdk_nvmf_qpair *qpair)
+{
+	assert(qpair->transport == group->transport);
+	if (group->transport->ops->poll_group_detach == NULL) {
+		return -ENOTSUP;
+	}
+
+	return group->transport->ops->poll_group_detach(group, qpair);
+}
+
+int
+nvmf_transport_poll_group_attach(struct spdk_nvmf_transport_poll_group *group,
+				 struct spdk_nvmf_qpair *qpair)
+{
+	assert(qpair->transport == group->transport);
+	assert(group->transport->ops->poll_group_attach != NULL);
+
+	return group->transport->ops->poll_group_attach(group, qpair);
+}
+
 int
 nvmf_transport_poll_group_poll(struct spdk_nvmf_transport_poll_group *group)
 {
@@ -32,6 +32,12 @@ int nvmf_transport_poll_group_add(struct spdk_nvmf_transport_poll_group *group,
 int nvmf_transport_poll_group_remove(struct spdk_nvmf_transport_poll_group *group,
 				     struct spdk_nvmf_qpair *qpair);
 
+int nvmf_transport_poll_group_detach(struct spdk_nvmf_transport_poll_group *group,
+				     struct spdk_nvmf_qpair *qpair);
+
+int nvmf_transport_poll_group_attach(struct spdk_nvmf_transport_poll_group *group,
+				     struct spdk_nvmf_qpair *qpair);
+
 int nvmf_transport_poll_group_poll(struct spdk_nvmf_transport_poll_group *group);
 
 int nvmf_transport_req_free(struct spdk_nvmf_request *req);
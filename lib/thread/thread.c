@@ -110,6 +110,7 @@ struct spdk_thread_post_poller_handler {
 };
 
 #define SPDK_THREAD_MAX_POST_POLLER_HANDLERS (4)
+#define SPDK_THREAD_MAX_NUMA_NODES (8)
 
 struct spdk_thread {
 	uint64_t			tsc_last;
@@ -166,6 +167,9 @@ struct spdk_thread {
 
 	uint8_t				reserved[6];
 
+	/* References on NUMA nodes taken by the resources this thread serves */
+	uint32_t			numa_refs[SPDK_THREAD_MAX_NUMA_NODES];
+
 	/* User context allocated at the end */
 	uint8_t				ctx[0];
 };
@@ -2046,6 +2050,59 @@ spdk_thread_get_trace_id(struct spdk_thread *thread)
 	return thread->trace_id;
 }
 
+void
+spdk_thread_get_numa_ref(int32_t numa_id)
+{
+	struct spdk_thread *thread = _get_thread();
+
+	if (spdk_unlikely(thread == NULL)) {
+		SPDK_ERRLOG("called from non-SPDK thread\n");
+		assert(false);
+		return;
+	}
+
+	if (numa_id < 0 || numa_id >= SPDK_THREAD_MAX_NUMA_NODES) {
+		return;
+	}
+
+	thread->numa_refs[numa_id]++;
+}
+
+void
+spdk_thread_put_numa_ref(int32_t numa_id)
+{
+	struct spdk_thread *thread = _get_thread();
+
+	if (spdk_unlikely(thread == NULL)) {
+		SPDK_ERRLOG("called from non-SPDK thread\n");
+		assert(false);
+		return;
+	}
+
+	if (numa_id < 0 || numa_id >= SPDK_THREAD_MAX_NUMA_NODES) {
+		return;
+	}
+
+	assert(thread->numa_refs[numa_id] > 0);
+	thread->numa_refs[numa_id]--;
+}
+
+int32_t
+spdk_thread_get_numa_id(struct spdk_thread *thread)
+{
+	int32_t i, numa_id = SPDK_ENV_NUMA_ID_ANY;
+	uint32_t refs = 0;
+
+	for (i = 0; i < SPDK_THREAD_MAX_NUMA_NODES; i++) {
+		if (thread->numa_refs[i] > refs) {
+			refs = thread->numa_refs[i];
+			numa_id = i;
+		}
+	}
+
+	return numa_id;
+}
+
 struct call_thread {
 	struct spdk_thread *cur_thread;
 	spdk_msg_fn fn;
@@ -135,6 +135,353 @@ spdk_xor_gen(void *dest, void **sources, uint32_t n, uint32_t len)
 	return do_xor_gen(dest, sources, n, len);
 }
 
+/*
+ * P+Q syndrome arithmetic in GF(2^8) with the generator polynomial 0x11d and generator g = 2,
+ * i.e. the same field as used by ISA-L and the Linux kernel RAID-6 code.
+ */
+#define SPDK_XOR_GF_POLY	0x11d
+/* g^i is only unique for i < 255, so this is the maximum number of sources for Q */
+#define SPDK_XOR_PQ_MAX_SRC	255
+
+static uint8_t g_gf_exp[2 * 255];
+static uint8_t g_gf_log[256];
+
+static void
+__attribute__((constructor))
+xor_gf_init(void)
+{
+	uint32_t x = 1;
+	uint32_t i;
+
+	for (i = 0; i < 255; i++) {
+		g_gf_exp[i] = x;
+		g_gf_exp[i + 255] = x;
+		g_gf_log[x] = i;
+		x <<= 1;
+		if (x & 0x100) {
+			x ^= SPDK_XOR_GF_POLY;
+		}
+	}
+}
+
+static inline uint8_t
+gf_mul(uint8_t a, uint8_t b)
+{
+	if (a == 0 || b == 0) {
+		return 0;
+	}
+
+	return g_gf_exp[g_gf_log[a] + g_gf_log[b]];
+}
+
+static inline uint8_t
+gf_inv(uint8_t a)
+{
+	assert(a != 0);
+
+	return g_gf_exp[255 - g_gf_log[a]];
+}
+
+static inline uint8_t
+gf_mul2(uint8_t a)
+{
+	return (a << 1) ^ ((a & 0x80) ? (SPDK_XOR_GF_POLY & 0xff) : 0);
+}
+
+/* Multiply each byte of a word by g = 2 */
+static inline uint64_t
+gf_mul2_word(uint64_t w)
+{
+	uint64_t mask = w & 0x8080808080808080ULL;
+
+	mask = (mask << 1) - (mask >> 7);
+
+	return ((w << 1) & 0xfefefefefefefefeULL) ^ (mask & 0x1d1d1d1d1d1d1d1dULL);
+}
+
+static inline void
+gf_mul_table_init(uint8_t *table, uint8_t c)
+{
+	uint32_t x;
+
+	for (x = 0; x < 256; x++) {
+		table[x] = gf_mul(c, x);
+	}
+}
+
+static inline uint64_t
+gf_mul_table_word(const uint8_t *table, uint64_t w)
+{
+	uint64_t r = 0;
+	uint32_t i;
+
+	for (i = 0; i < sizeof(w); i++) {
+		r |= (uint64_t)table[(w >> (i * 8)) & 0xff] << (i * 8);
+	}
+
+	return r;
+}
+
+/*
+ * Calculate P (the XOR) and Q (the sum of g^i * D_i) of the sources that are not marked as
+ * failed at the given offset. Failed sources are treated as zeros. The computation is done
+ * with Horner's scheme, starting from the last source.
+ */
+#define PQ_SYNDROME(type, mul2, sources, n, failed_a, failed_b, off, p, q)		\
+	do {									\
+		uint32_t _j = (n);						\
+		(p) = 0;							\
+		(q) = 0;							\
+		while (_j-- > 0) {						\
+			type _d = 0;						\
+			if (_j != (failed_a) && _j != (failed_b)) {		\
+				_d = ((type *)(sources)[_j])[off];		\
+			}							\
+			(p) ^= _d;						\
+			(q) = mul2(q) ^ _d;					\
+		}								\
+	} while (0)
+
+static void
+pq_gen_unaligned(void *p, void *q, void **sources, uint32_t n, uint32_t len)
+{
+	uint8_t pb, qb;
+	uint32_t i;
+
+	for (i = 0; i < len; i++) {
+		PQ_SYNDROME(uint8_t, gf_mul2, sources, n, UINT32_MAX, UINT32_MAX, i, pb, qb);
+		((uint8_t *)p)[i] = pb;
+		((uint8_t *)q)[i] = qb;
+	}
+}
+
+static void
+pq_gen_basic(void *p, void *q, void **sources, uint32_t n, uint32_t len)
+{
+	void *sources2[SPDK_XOR_PQ_MAX_SRC];
+	uint64_t pw, qw;
+	uint32_t shift;
+	uint32_t len_div, len_rem;
+	uint32_t i, j;
+
+	if (!buffers_aligned(p, sources, n, sizeof(uint64_t)) || !is_aligned(q, sizeof(uint64_t))) {
+		pq_gen_unaligned(p, q, sources, n, len);
+		return;
+	}
+
+	shift = spdk_u32log2(sizeof(uint64_t));
+	len_div = len >> shift;
+	len_rem = len_div << shift;
+
+	for (i = 0; i < len_div; i++) {
+		PQ_SYNDROME(uint64_t, gf_mul2_word, sources, n, UINT32_MAX, UINT32_MAX, i, pw, qw);
+		((uint64_t *)p)[i] = pw;
+		((uint64_t *)q)[i] = qw;
+	}
+
+	if (len_rem < len) {
+		for (j = 0; j < n; j++) {
+			sources2[j] = (uint8_t *)sources[j] + len_rem;
+		}
+
+		pq_gen_unaligned((uint8_t *)p + len_rem, (uint8_t *)q + len_rem, sources2, n,
+				 len - len_rem);
+	}
+}
+
+#ifdef SPDK_CONFIG_ISAL
+
+static int
+do_pq_gen(void *p, void *q, void **sources, uint32_t n, uint32_t len)
+{
+	if (buffers_aligned(p, sources, n, SPDK_XOR_BUF_ALIGN) &&
+	    is_aligned(q, SPDK_XOR_BUF_ALIGN) && (len % SPDK_XOR_BUF_ALIGN) == 0 &&
+	    len <= INT_MAX) {
+		void *buffers[SPDK_XOR_PQ_MAX_SRC + 2];
+
+		memcpy(buffers, sources, n * sizeof(buffers[0]));
+		buffers[n] = p;
+		buffers[n + 1] = q;
+
+		if (pq_gen(n + 2, len, buffers)) {
+			return -EINVAL;
+		}
+	} else {
+		pq_gen_basic(p, q, sources, n, len);
+	}
+
+	return 0;
+}
+
+#else
+
+static inline int
+do_pq_gen(void *p, void *q, void **sources, uint32_t n, uint32_t len)
+{
+	pq_gen_basic(p, q, sources, n, len);
+	return 0;
+}
+
+#endif
+
+int
+spdk_xor_gen_pq(void *p, void *q, void **sources, uint32_t n, uint32_t len)
+{
+	if (n < 2 || n > SPDK_XOR_PQ_MAX_SRC) {
+		return -EINVAL;
+	}
+
+	return do_pq_gen(p, q, sources, n, len);
+}
+
+struct pq_recover_ctx {
+	/* Indexes of the failed data buffers, UINT32_MAX if not failed */
+	uint32_t data_a;
+	uint32_t data_b;
+	bool p_failed;
+	bool q_failed;
+	/* Multiplication tables of the coefficients used to solve the failed data */
+	uint8_t table_p[256];
+	uint8_t table_q[256];
+};
+
+/*
+ * Given the syndromes of the surviving data (px, qx) and the stored P and Q, solve the failed
+ * data and regenerate the failed parity.
+ */
+#define PQ_RECOVER(type, mul2, mul_table, ctx, buffers, n, off)				\
+	do {										\
+		type _px, _qx, _da = 0, _db;						\
+		PQ_SYNDROME(type, mul2, buffers, n, (ctx)->data_a, (ctx)->data_b, off, _px, _qx); \
+		if ((ctx)->data_b != UINT32_MAX) {					\
+			type _pxy = _px ^ ((type *)(buffers)[n])[off];			\
+			type _qxy = _qx ^ ((type *)(buffers)[(n) + 1])[off];		\
+			_da = mul_table((ctx)->table_p, _pxy) ^ mul_table((ctx)->table_q, _qxy); \
+			_db = _pxy ^ _da;						\
+			((type *)(buffers)[(ctx)->data_b])[off] = _db;			\
+		} else if ((ctx)->data_a != UINT32_MAX) {				\
+			if ((ctx)->p_failed) {						\
+				_da = mul_table((ctx)->table_q,				\
+						_qx ^ ((type *)(buffers)[(n) + 1])[off]);	\
+				_px ^= _da;						\
+			} else {							\
+				_da = _px ^ ((type *)(buffers)[n])[off];		\
+				_qx ^= mul_table((ctx)->table_p, _da);			\
+			}								\
+		}									\
+		if ((ctx)->data_a != UINT32_MAX) {					\
+			((type *)(buffers)[(ctx)->data_a])[off] = _da;			\
+		}									\
+		if ((ctx)->p_failed) {							\
+			((type *)(buffers)[n])[off] = _px;				\
+		}									\
+		if ((ctx)->q_failed) {							\
+			((type *)(buffers)[(n) + 1])[off] = _qx;			\
+		}									\
+	} while (0)
+
+static inline uint8_t
+gf_mul_table_byte(const uint8_t *table, uint8_t b)
+{
+	return table[b];
+}
+
+static void
+pq_recover_unaligned(struct pq_recover_ctx *ctx, void **buffers, uint32_t n, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i < len; i++) {
+		PQ_RECOVER(uint8_t, gf_mul2, gf_mul_table_byte, ctx, buffers, n, i);
+	}
+}
+
+static void
+pq_recover_basic(struct pq_recover_ctx *ctx, void **buffers, uint32_t n, uint32_t len)
+{
+	void *buffers2[SPDK_XOR_PQ_MAX_SRC + 2];
+	uint32_t shift;
+	uint32_t len_div, len_rem;
+	uint32_t i, j;
+
+	if (!buffers_aligned(buffers[n + 1], buffers, n + 1, sizeof(uint64_t))) {
+		pq_recover_unaligned(ctx, buffers, n, len);
+		return;
+	}
+
+	shift = spdk_u32log2(sizeof(uint64_t));
+	len_div = len >> shift;
+	len_rem = len_div << shift;
+
+	for (i = 0; i < len_div; i++) {
+		PQ_RECOVER(uint64_t, gf_mul2_word, gf_mul_table_word, ctx, buffers, n, i);
+	}
+
+	if (len_rem < len) {
+		for (j = 0; j < n + 2; j++) {
+			buffers2[j] = (uint8_t *)buffers[j] + len_rem;
+		}
+
+		pq_recover_unaligned(ctx, buffers2, n, len - len_rem);
+	}
+}
+
+int
+spdk_xor_recover_pq(void **buffers, uint32_t n, uint32_t len, const uint32_t *failed,
+		    uint32_t num_failed)
+{
+	struct pq_recover_ctx ctx = {
+		.data_a = UINT32_MAX,
+		.data_b = UINT32_MAX,
+	};
+	uint32_t i;
+
+	if (n < 2 || n > SPDK_XOR_PQ_MAX_SRC || num_failed < 1 || num_failed > 2) {
+		return -EINVAL;
+	}
+
+	for (i = 0; i < num_failed; i++) {
+		if (failed[i] < n) {
+			if (ctx.data_a == UINT32_MAX) {
+				ctx.data_a = failed[i];
+			} else if (failed[i] != ctx.data_a) {
+				ctx.data_b = failed[i];
+			}
+		} else if (failed[i] == n) {
+			ctx.p_failed = true;
+		} else if (failed[i] == n + 1) {
+			ctx.q_failed = true;
+		} else {
+			return -EINVAL;
+		}
+	}
+
+	if (ctx.data_b != UINT32_MAX) {
+		/*
+		 * Both P and Q are available:
+		 * D_a = (Qxy + g^b * Pxy) / (g^a + g^b), D_b = Pxy + D_a
+		 */
+		uint8_t ga = g_gf_exp[ctx.data_a];
+		uint8_t gb = g_gf_exp[ctx.data_b];
+		uint8_t c = gf_inv(ga ^ gb);
+
+		gf_mul_table_init(ctx.table_p, gf_mul(gb, c));
+		gf_mul_table_init(ctx.table_q, c);
+	} else if (ctx.data_a != UINT32_MAX) {
+		if (ctx.p_failed) {
+			/* D_a = Qx / g^a */
+			gf_mul_table_init(ctx.table_q, gf_inv(g_gf_exp[ctx.data_a]));
+		} else {
+			/* D_a = Px, Q = Qx + g^a * D_a */
+			gf_mul_table_init(ctx.table_p, g_gf_exp[ctx.data_a]);
+		}
+	}
+
+	pq_recover_basic(&ctx, buffers, n, len);
+
+	return 0;
+}
+
 size_t
 spdk_xor_get_optimal_alignment(void)
 {
@@ -213,6 +213,7 @@ _rpc_bdev_ftl_get_stats(void *ctx, int rc)
 	struct spdk_jsonrpc_request *request = ftl_stats_ctx->request;
 	struct ftl_stats *stats = &ftl_stats_ctx->ftl_stats;
 	struct spdk_json_write_ctx *w;
+	uint64_t cmp_blocks, gc_blocks;
 
 	if (rc) {
 		free(ftl_stats_ctx);
@@ -273,6 +274,24 @@ _rpc_bdev_ftl_get_stats(void *ctx, int rc)
 		spdk_json_write_object_end(w);
 	}
 
+	/* Blocks written to the base device by compaction and GC per block written by compaction */
+	cmp_blocks = stats->entries[FTL_STATS_TYPE_CMP].write.blocks;
+	gc_blocks = stats->entries[FTL_STATS_TYPE_GC].write.blocks;
+
+	spdk_json_write_named_object_begin(w, "gc_victims");
+	spdk_json_write_named_uint64(w, "bands", stats->gc.bands);
+	spdk_json_write_named_uint64(w, "valid_blocks", stats->gc.valid_blocks);
+	spdk_json_write_named_uint64(w, "invalid_blocks", stats->gc.invalid_blocks);
+	spdk_json_write_named_double(w, "write_amplification", cmp_blocks ?
+				     (double)(cmp_blocks + gc_blocks) / cmp_blocks : 1.0);
+	spdk_json_write_object_end(w);
+
+	spdk_json_write_named_object_begin(w, "l2p_cache");
+	spdk_json_write_named_uint64(w, "hits", stats->l2p_cache.hits);
+	spdk_json_write_named_uint64(w, "misses", stats->l2p_cache.misses);
+	spdk_json_write_named_uint64(w, "evictions", stats->l2p_cache.evictions);
+	spdk_json_write_object_end(w);
+
 	spdk_json_write_object_end(w);
 	spdk_jsonrpc_end_result(request, w);
 	free(ftl_stats_ctx);
@@ -305,6 +324,65 @@ rpc_bdev_ftl_get_stats(struct spdk_jsonrpc_request *request,
 
 SPDK_RPC_REGISTER("bdev_ftl_get_stats", rpc_bdev_ftl_get_stats, SPDK_RPC_RUNTIME)
 
+static const char *
+rpc_ftl_recovery_state_name(enum spdk_ftl_recovery_state state)
+{
+	switch (state) {
+	case SPDK_FTL_RECOVERY_STATE_NONE:
+		return "none";
+	case SPDK_FTL_RECOVERY_STATE_RUNNING:
+		return "running";
+	case SPDK_FTL_RECOVERY_STATE_DONE:
+		return "done";
+	default:
+		assert(false);
+		return "unknown";
+	}
+}
+
+static void
+rpc_bdev_ftl_get_recovery_progress(struct spdk_jsonrpc_request *request,
+				   const struct spdk_json_val *params)
+{
+	struct rpc_ftl_basic_param attrs = {};
+	struct spdk_ftl_recovery_progress progress;
+	struct spdk_json_write_ctx *w;
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_ftl_basic_decoders, SPDK_COUNTOF(rpc_ftl_basic_decoders),
+				    &attrs)) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+		free(attrs.name);
+		return;
+	}
+
+	/* The FTL bdev is only registered after the recovery, look the device up by its name */
+	rc = spdk_ftl_get_recovery_progress(attrs.name, &progress, sizeof(progress));
+	if (rc) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		free(attrs.name);
+		return;
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "name", attrs.name);
+	spdk_json_write_named_string(w, "state", rpc_ftl_recovery_state_name(progress.state));
+	spdk_json_write_named_uint32(w, "iteration", progress.iteration);
+	spdk_json_write_named_uint32(w, "iterations", progress.iterations);
+	spdk_json_write_named_uint64(w, "p2l_maps_done", progress.p2l_maps_done);
+	spdk_json_write_named_uint64(w, "p2l_maps_total", progress.p2l_maps_total);
+	spdk_json_write_named_uint32(w, "num_threads", progress.num_threads);
+	spdk_json_write_named_uint64(w, "elapsed_us", progress.elapsed_us);
+	spdk_json_write_object_end(w);
+	spdk_jsonrpc_end_result(request, w);
+
+	free(attrs.name);
+}
+
+SPDK_RPC_REGISTER("bdev_ftl_get_recovery_progress", rpc_bdev_ftl_get_recovery_progress,
+		  SPDK_RPC_RUNTIME)
+
 static void
 rpc_bdev_ftl_get_properties_cb(void *ctx, int rc)
 {
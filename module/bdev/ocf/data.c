@@ -6,29 +6,57 @@
 #include <ocf/ocf.h>
 #include "spdk/bdev.h"
 #include "data.h"
+#include "mpool.h"
+
+/* Data descriptors allocated by OCF, with their iovec array right after the descriptor */
+static struct env_mpool *g_data_mpool;
+/* Iovec arrays describing the part of a request forwarded to a base bdev */
+static struct env_mpool *g_iovs_mpool;
+
+int
+vbdev_ocf_data_init(void)
+{
+	g_data_mpool = env_mpool_create(sizeof(struct bdev_ocf_data), sizeof(struct iovec),
+					ENV_MEM_NOIO, env_mpool_4, true, NULL, "ocf_data", false);
+	if (!g_data_mpool) {
+		return -ENOMEM;
+	}
+
+	g_iovs_mpool = env_mpool_create(0, sizeof(struct iovec), ENV_MEM_NOIO, env_mpool_16,
+					true, NULL, "ocf_iovs", false);
+	if (!g_iovs_mpool) {
+		env_mpool_destroy(g_data_mpool);
+		g_data_mpool = NULL;
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+void
+vbdev_ocf_data_cleanup(void)
+{
+	env_mpool_destroy(g_iovs_mpool);
+	env_mpool_destroy(g_data_mpool);
+	g_iovs_mpool = NULL;
+	g_data_mpool = NULL;
+}
 
 struct bdev_ocf_data *
 vbdev_ocf_data_alloc(uint32_t iovcnt)
 {
 	struct bdev_ocf_data *data;
 
-	data = env_malloc(sizeof(*data), ENV_MEM_NOIO);
+	data = env_mpool_new(g_data_mpool, iovcnt);
 	if (!data) {
 		return NULL;
 	}
 
+	data->iovs = iovcnt ? (struct iovec *)(data + 1) : NULL;
 	data->seek = 0;
-
-	if (iovcnt) {
-		data->iovs = env_malloc(sizeof(*data->iovs) * iovcnt, ENV_MEM_NOIO);
-		if (!data->iovs) {
-			env_free(data);
-			return NULL;
-		}
-	}
-
 	data->iovcnt = 0;
 	data->iovalloc = iovcnt;
+	data->invalidate_only = false;
 
 	return data;
 }
@@ -40,11 +68,19 @@ vbdev_ocf_data_free(struct bdev_ocf_data *data)
 		return;
 	}
 
-	if (data->iovalloc != 0) {
-		env_free(data->iovs);
-	}
+	env_mpool_del(g_data_mpool, data, data->iovalloc);
+}
 
-	env_free(data);
+struct iovec *
+vbdev_ocf_iovs_alloc(uint32_t iovcnt)
+{
+	return env_mpool_new(g_iovs_mpool, iovcnt);
+}
+
+void
+vbdev_ocf_iovs_free(struct iovec *iovs, uint32_t iovcnt)
+{
+	env_mpool_del(g_iovs_mpool, iovs, iovcnt);
 }
 
 void
@@ -79,6 +115,8 @@ vbdev_ocf_data_from_spdk_io(struct spdk_bdev_io *bdev_io)
 		break;
 	case SPDK_BDEV_IO_TYPE_FLUSH:
 	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_COPY:
 		break;
 	default:
 		SPDK_ERRLOG("Unsupported IO type %d\n", bdev_io->type);
@@ -89,6 +127,8 @@ vbdev_ocf_data_from_spdk_io(struct spdk_bdev_io *bdev_io)
 	data->iovs = bdev_io->u.bdev.iovs;
 	data->iovcnt = bdev_io->u.bdev.iovcnt;
 	data->size = bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen;
+	data->invalidate_only = bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE_ZEROES ||
+				bdev_io->type == SPDK_BDEV_IO_TYPE_COPY;
 
 	return data;
 }
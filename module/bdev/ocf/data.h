@@ -15,8 +15,14 @@ struct bdev_ocf_data {
 	int iovalloc;
 	uint32_t size;
 	uint32_t seek;
+	/* Discards of this data only invalidate the cache, they aren't forwarded to the core */
+	bool invalidate_only;
 };
 
+int vbdev_ocf_data_init(void);
+
+void vbdev_ocf_data_cleanup(void);
+
 struct bdev_ocf_data *vbdev_ocf_data_from_spdk_io(struct spdk_bdev_io *bdev_io);
 
 struct bdev_ocf_data *vbdev_ocf_data_alloc(uint32_t nvecs);
@@ -27,4 +33,9 @@ struct bdev_ocf_data *vbdev_ocf_data_from_iov(struct iovec *iovs);
 
 void vbdev_ocf_iovs_add(struct bdev_ocf_data *data, void *base, size_t len);
 
+/* Iovec arrays are taken from per-core cached pools, iovcnt must match on free */
+struct iovec *vbdev_ocf_iovs_alloc(uint32_t iovcnt);
+
+void vbdev_ocf_iovs_free(struct iovec *iovs, uint32_t iovcnt);
+
 #endif
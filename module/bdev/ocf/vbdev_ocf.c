@@ -19,6 +19,13 @@
 #include "spdk/log.h"
 #include "spdk/cpuset.h"
 
+/* Write zeroes and copy are split so the discard invalidating the cache stays within the 32-bit
+ * size of an OCF I/O */
+#define VBDEV_OCF_MAX_DISCARD_SIZE (1U << 30)
+
+/* Copy emulated through the cache moves the data in chunks of this size */
+#define VBDEV_OCF_COPY_CHUNK_SIZE SPDK_BDEV_LARGE_BUF_MAX_SIZE
+
 /* This namespace UUID was generated using uuid_generate() method. */
 #define BDEV_OCF_NAMESPACE_UUID "f92b7f49-f6c0-44c8-bd23-3205e8c3b6ad"
 
@@ -32,6 +39,18 @@ static TAILQ_HEAD(, examining_bdev) g_ocf_examining_bdevs_head
 
 static bool g_fini_started = false;
 
+/* Per I/O context of the exported bdev */
+struct vbdev_ocf_io {
+	/* Data of the OCF I/O, first so that vbdev_ocf_data_from_spdk_io() can use driver_ctx */
+	struct bdev_ocf_data	data;
+	/* The destination may have been modified, so the request can't be retried */
+	bool			dst_written;
+	/* Copy emulated through the cache */
+	int			copy_dir;
+	uint64_t		copied_blocks;
+	struct iovec		copy_iov;
+};
+
 /* Structure for keeping list of bdevs that are claimed but not used yet */
 struct examining_bdev {
 	struct spdk_bdev           *bdev;
@@ -541,16 +560,206 @@ vbdev_ocf_foreach(vbdev_ocf_foreach_fn fn, void *ctx)
 	}
 }
 
+static inline struct vbdev_ocf_io *
+vbdev_ocf_io_ctx(struct spdk_bdev_io *bdev_io)
+{
+	return (struct vbdev_ocf_io *)bdev_io->driver_ctx;
+}
+
+/* Retrying a request that already modified the destination could copy overwritten data */
+static void
+vbdev_ocf_io_complete_nomem(struct spdk_bdev_io *bdev_io)
+{
+	spdk_bdev_io_complete(bdev_io, vbdev_ocf_io_ctx(bdev_io)->dst_written ?
+			      SPDK_BDEV_IO_STATUS_FAILED : SPDK_BDEV_IO_STATUS_NOMEM);
+}
+
+/* The core is only up to date if the cache can't hold dirty data */
+static bool
+vbdev_ocf_core_is_clean(struct vbdev_ocf *vbdev)
+{
+	switch (ocf_cache_get_mode(vbdev->ocf_cache)) {
+	case ocf_cache_mode_wb:
+	case ocf_cache_mode_wo:
+		return false;
+	default:
+		return !ocf_mngt_cache_is_dirty(vbdev->ocf_cache);
+	}
+}
+
+static void io_handle(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io);
+
+static void
+vbdev_ocf_core_io_cb(struct spdk_bdev_io *core_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *bdev_io = cb_arg;
+
+	if (!success) {
+		spdk_bdev_io_complete_base_io_status(bdev_io, core_io);
+		spdk_bdev_free_io(core_io);
+		return;
+	}
+
+	/* Drop the lines a read miss may have cached from the core before it was written */
+	spdk_bdev_free_io(core_io);
+	io_handle(spdk_bdev_io_get_io_channel(bdev_io), bdev_io);
+}
+
+/*
+ * Write zeroes and copy go straight to the core, so that the cache isn't filled with zeroes or
+ * copied data, and then invalidate the destination range in cache with a discard. If the cache
+ * may hold dirty data, the range is also invalidated before, so that the cleaner doesn't write
+ * the old data over the new one. The discards aren't forwarded to the core.
+ */
+static void
+vbdev_ocf_submit_to_core(struct spdk_bdev_io *bdev_io)
+{
+	struct vbdev_ocf *vbdev = bdev_io->bdev->ctxt;
+	struct vbdev_ocf_qctx *qctx = spdk_io_channel_get_ctx(spdk_bdev_io_get_io_channel(bdev_io));
+	int rc;
+
+	vbdev_ocf_io_ctx(bdev_io)->dst_written = true;
+
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE_ZEROES) {
+		rc = spdk_bdev_write_zeroes_blocks(vbdev->core.desc, qctx->core_ch,
+						   bdev_io->u.bdev.offset_blocks,
+						   bdev_io->u.bdev.num_blocks,
+						   vbdev_ocf_core_io_cb, bdev_io);
+	} else {
+		rc = spdk_bdev_copy_blocks(vbdev->core.desc, qctx->core_ch,
+					   bdev_io->u.bdev.offset_blocks,
+					   bdev_io->u.bdev.copy.src_offset_blocks,
+					   bdev_io->u.bdev.num_blocks,
+					   vbdev_ocf_core_io_cb, bdev_io);
+	}
+
+	if (rc == -ENOMEM) {
+		/* Nothing was written yet */
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+	} else if (rc != 0) {
+		SPDK_ERRLOG("Submission to core failed with status=%d\n", rc);
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static void vbdev_ocf_copy_chunk(struct spdk_bdev_io *bdev_io);
+
+static void
+vbdev_ocf_copy_cb(ocf_io_t io, void *priv1, void *priv2, int error)
+{
+	struct spdk_bdev_io *bdev_io = priv1;
+	struct vbdev_ocf_io *io_ctx = vbdev_ocf_io_ctx(bdev_io);
+
+	ocf_io_put(io);
+
+	if (error == -OCF_ERR_NO_MEM) {
+		vbdev_ocf_io_complete_nomem(bdev_io);
+		return;
+	} else if (error != 0) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	if (io_ctx->copy_dir == OCF_READ) {
+		io_ctx->copy_dir = OCF_WRITE;
+	} else {
+		io_ctx->copied_blocks += io_ctx->copy_iov.iov_len / bdev_io->bdev->blocklen;
+		if (io_ctx->copied_blocks == bdev_io->u.bdev.num_blocks) {
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+			return;
+		}
+		io_ctx->copy_dir = OCF_READ;
+	}
+
+	vbdev_ocf_copy_chunk(bdev_io);
+}
+
+/*
+ * Copy with dirty data in the cache has to read the source through the cache. It's moved in
+ * chunks, back to front if the destination follows an overlapping source.
+ */
+static void
+vbdev_ocf_copy_chunk(struct spdk_bdev_io *bdev_io)
+{
+	struct vbdev_ocf *vbdev = bdev_io->bdev->ctxt;
+	struct vbdev_ocf_qctx *qctx = spdk_io_channel_get_ctx(spdk_bdev_io_get_io_channel(bdev_io));
+	struct vbdev_ocf_io *io_ctx = vbdev_ocf_io_ctx(bdev_io);
+	uint32_t blocklen = bdev_io->bdev->blocklen;
+	uint64_t num_blocks, offset_blocks;
+	ocf_io_t io;
+	int rc;
+
+	num_blocks = bdev_io->u.bdev.num_blocks - io_ctx->copied_blocks;
+	num_blocks = spdk_min(num_blocks, VBDEV_OCF_COPY_CHUNK_SIZE / blocklen);
+	if (bdev_io->u.bdev.offset_blocks > bdev_io->u.bdev.copy.src_offset_blocks) {
+		offset_blocks = bdev_io->u.bdev.num_blocks - io_ctx->copied_blocks - num_blocks;
+	} else {
+		offset_blocks = io_ctx->copied_blocks;
+	}
+	if (io_ctx->copy_dir == OCF_READ) {
+		offset_blocks += bdev_io->u.bdev.copy.src_offset_blocks;
+	} else {
+		offset_blocks += bdev_io->u.bdev.offset_blocks;
+		io_ctx->dst_written = true;
+	}
+
+	io_ctx->copy_iov.iov_base = bdev_io->u.bdev.iovs[0].iov_base;
+	io_ctx->copy_iov.iov_len = num_blocks * blocklen;
+	io_ctx->data.iovs = &io_ctx->copy_iov;
+	io_ctx->data.iovcnt = 1;
+	io_ctx->data.size = io_ctx->copy_iov.iov_len;
+	io_ctx->data.seek = 0;
+	io_ctx->data.invalidate_only = false;
+
+	io = ocf_volume_new_io(ocf_core_get_front_volume(vbdev->ocf_core), qctx->queue,
+			       offset_blocks * blocklen, io_ctx->copy_iov.iov_len,
+			       io_ctx->copy_dir, 0, 0);
+	if (!io) {
+		vbdev_ocf_io_complete_nomem(bdev_io);
+		return;
+	}
+
+	rc = ocf_io_set_data(io, &io_ctx->data, 0);
+	if (rc) {
+		ocf_io_put(io);
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	ocf_io_set_cmpl(io, bdev_io, NULL, vbdev_ocf_copy_cb);
+	ocf_core_submit_io(io);
+}
+
+static void
+vbdev_ocf_copy_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io,
+			  bool success)
+{
+	struct vbdev_ocf_io *io_ctx = vbdev_ocf_io_ctx(bdev_io);
+
+	if (!success) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	io_ctx->copy_dir = OCF_READ;
+	io_ctx->copied_blocks = 0;
+	vbdev_ocf_copy_chunk(bdev_io);
+}
+
 /* Called from OCF when SPDK_IO is completed */
 static void
 vbdev_ocf_io_submit_cb(ocf_io_t io, void *priv1, void *priv2, int error)
 {
 	struct spdk_bdev_io *bdev_io = priv1;
 
-	if (error == 0) {
+	if (error == 0 && (bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE_ZEROES ||
+			   bdev_io->type == SPDK_BDEV_IO_TYPE_COPY) &&
+	    !vbdev_ocf_io_ctx(bdev_io)->dst_written) {
+		vbdev_ocf_submit_to_core(bdev_io);
+	} else if (error == 0) {
 		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
 	} else if (error == -OCF_ERR_NO_MEM) {
-		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+		vbdev_ocf_io_complete_nomem(bdev_io);
 	} else {
 		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
 	}
@@ -571,10 +780,11 @@ io_submit_to_ocf(struct spdk_bdev_io *bdev_io, ocf_io_t io)
 		ocf_core_submit_flush(io);
 		return 0;
 	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_COPY:
 		ocf_core_submit_discard(io);
 		return 0;
 	case SPDK_BDEV_IO_TYPE_RESET:
-	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
 	default:
 		SPDK_ERRLOG("Unsupported IO type: %d\n", bdev_io->type);
 		return -EINVAL;
@@ -605,6 +815,8 @@ io_handle(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
 		dir = OCF_WRITE;
 		break;
 	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_COPY:
 		dir = OCF_WRITE;
 		break;
 	default:
@@ -649,7 +861,7 @@ fail:
 	}
 
 	if (err == -ENOMEM) {
-		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+		vbdev_ocf_io_complete_nomem(bdev_io);
 	} else {
 		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
 	}
@@ -671,6 +883,11 @@ vbdev_ocf_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io,
 static void
 vbdev_ocf_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
 {
+	struct vbdev_ocf *vbdev = bdev_io->bdev->ctxt;
+	uint64_t len;
+
+	vbdev_ocf_io_ctx(bdev_io)->dst_written = false;
+
 	switch (bdev_io->type) {
 	case SPDK_BDEV_IO_TYPE_READ:
 		/* User does not have to allocate io vectors for the request,
@@ -683,8 +900,20 @@ vbdev_ocf_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 	case SPDK_BDEV_IO_TYPE_UNMAP:
 		io_handle(ch, bdev_io);
 		break;
-	case SPDK_BDEV_IO_TYPE_RESET:
 	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_COPY:
+		/* The cache mode and dirtiness change at runtime, check them on each request */
+		if (vbdev_ocf_core_is_clean(vbdev)) {
+			vbdev_ocf_submit_to_core(bdev_io);
+		} else if (bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE_ZEROES) {
+			io_handle(ch, bdev_io);
+		} else {
+			len = bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen;
+			spdk_bdev_io_get_buf(bdev_io, vbdev_ocf_copy_get_buf_cb,
+					     spdk_min(len, VBDEV_OCF_COPY_CHUNK_SIZE));
+		}
+		break;
+	case SPDK_BDEV_IO_TYPE_RESET:
 	default:
 		SPDK_ERRLOG("Unknown I/O type %d\n", bdev_io->type);
 		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
@@ -704,8 +933,11 @@ vbdev_ocf_io_type_supported(void *opaque, enum spdk_bdev_io_type io_type)
 	case SPDK_BDEV_IO_TYPE_FLUSH:
 	case SPDK_BDEV_IO_TYPE_UNMAP:
 		return spdk_bdev_io_type_supported(vbdev->core.bdev, io_type);
-	case SPDK_BDEV_IO_TYPE_RESET:
 	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+	case SPDK_BDEV_IO_TYPE_COPY:
+		/* Copy is emulated through the cache while it may hold dirty data */
+		return spdk_bdev_io_type_supported(vbdev->core.bdev, io_type);
+	case SPDK_BDEV_IO_TYPE_RESET:
 	default:
 		return false;
 	}
@@ -930,6 +1162,8 @@ finish_register(struct vbdev_ocf *vbdev)
 	vbdev->exp_bdev.blocklen = vbdev->core.bdev->blocklen;
 	vbdev->exp_bdev.write_cache = vbdev->core.bdev->write_cache;
 	vbdev->exp_bdev.required_alignment = vbdev->core.bdev->required_alignment;
+	vbdev->exp_bdev.max_write_zeroes = VBDEV_OCF_MAX_DISCARD_SIZE / vbdev->exp_bdev.blocklen;
+	vbdev->exp_bdev.max_copy = VBDEV_OCF_MAX_DISCARD_SIZE / vbdev->exp_bdev.blocklen;
 
 	vbdev->exp_bdev.name = vbdev->name;
 	vbdev->exp_bdev.product_name = "SPDK OCF";
@@ -1313,8 +1547,15 @@ vbdev_ocf_init(void)
 {
 	int status;
 
+	status = vbdev_ocf_data_init();
+	if (status) {
+		SPDK_ERRLOG("OCF data pools initialization failed with=%d\n", status);
+		return status;
+	}
+
 	status = vbdev_ocf_ctx_init();
 	if (status) {
+		vbdev_ocf_data_cleanup();
 		SPDK_ERRLOG("OCF ctx initialization failed with=%d\n", status);
 		return status;
 	}
@@ -1322,6 +1563,7 @@ vbdev_ocf_init(void)
 	status = vbdev_ocf_volume_init();
 	if (status) {
 		vbdev_ocf_ctx_cleanup();
+		vbdev_ocf_data_cleanup();
 		SPDK_ERRLOG("OCF volume initialization failed with=%d\n", status);
 		return status;
 	}
@@ -1343,6 +1585,7 @@ vbdev_ocf_module_fini(void)
 
 	vbdev_ocf_volume_cleanup();
 	vbdev_ocf_ctx_cleanup();
+	vbdev_ocf_data_cleanup();
 }
 
 /* When base device gets unplugged this is called
@@ -1771,7 +2014,7 @@ vbdev_ocf_examine_disk(struct spdk_bdev *bdev)
 static int
 vbdev_ocf_get_ctx_size(void)
 {
-	return sizeof(struct bdev_ocf_data);
+	return sizeof(struct vbdev_ocf_io);
 }
 
 static void
@@ -6,6 +6,8 @@
 #include "vbdev_ocf.h"
 #include "stats.h"
 #include "utils.h"
+#include "ocf_env.h"
+#include "spdk/env.h"
 #include "spdk/log.h"
 #include "spdk/rpc.h"
 #include "spdk/string.h"
@@ -629,3 +631,44 @@ end:
 	free_rpc_bdev_ocf_name(&req);
 }
 SPDK_RPC_REGISTER("bdev_ocf_flush_status", rpc_bdev_ocf_flush_status, SPDK_RPC_RUNTIME)
+
+static const char *g_env_lock_type_names[ENV_LOCK_TYPE_MAX] = {
+	[ENV_LOCK_MUTEX] = "mutex",
+	[ENV_LOCK_RWSEM] = "rwsem",
+	[ENV_LOCK_RWLOCK] = "rwlock",
+};
+
+static void
+rpc_bdev_ocf_get_lock_stats(struct spdk_jsonrpc_request *request,
+			    const struct spdk_json_val *params)
+{
+	struct env_lock_stats stats[ENV_LOCK_TYPE_MAX];
+	struct spdk_json_write_ctx *w;
+	int i;
+
+	if (params != NULL) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 "bdev_ocf_get_lock_stats requires no parameters");
+		return;
+	}
+
+	env_lock_get_stats(stats);
+
+	w = spdk_jsonrpc_begin_result(request);
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_uint64(w, "tick_rate", spdk_get_ticks_hz());
+	for (i = 0; i < ENV_LOCK_TYPE_MAX; i++) {
+		spdk_json_write_named_object_begin(w, g_env_lock_type_names[i]);
+		spdk_json_write_named_uint64(w, "shared", stats[i].shared);
+		spdk_json_write_named_uint64(w, "exclusive", stats[i].exclusive);
+		spdk_json_write_named_uint64(w, "contended", stats[i].contended);
+		spdk_json_write_named_uint64(w, "wait_ticks", stats[i].wait_ticks);
+		spdk_json_write_named_uint64(w, "hold_ticks", stats[i].hold_ticks);
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_object_end(w);
+
+	spdk_jsonrpc_end_result(request, w);
+}
+SPDK_RPC_REGISTER("bdev_ocf_get_lock_stats", rpc_bdev_ocf_get_lock_stats, SPDK_RPC_RUNTIME)
@@ -70,9 +70,23 @@ get_starting_vec(struct iovec *iovs, int iovcnt, uint64_t *offset)
 	return -1;
 }
 
+static int
+get_cpy_vector_len(struct iovec *orig_vec, int orig_vec_len, size_t offset, size_t bytes)
+{
+	size_t len;
+	int i;
+
+	for (i = 0; i < orig_vec_len && bytes > 0; i++) {
+		len = MIN(bytes, orig_vec[i].iov_len - offset);
+		bytes -= len;
+		offset = 0;
+	}
+
+	return bytes == 0 ? i : -1;
+}
+
 static void
-initialize_cpy_vector(struct iovec *cpy_vec, int cpy_vec_len, struct iovec *orig_vec,
-		      int orig_vec_len,
+initialize_cpy_vector(struct iovec *cpy_vec, struct iovec *orig_vec,
 		      size_t offset, size_t bytes)
 {
 	void *curr_base;
@@ -114,7 +128,7 @@ vbdev_forward_io_cb(struct spdk_bdev_io *bdev_io, bool success, void *opaque)
 static void
 vbdev_forward_io_free_iovs_cb(struct spdk_bdev_io *bdev_io, bool success, void *opaque)
 {
-	env_free(bdev_io->u.bdev.iovs);
+	vbdev_ocf_iovs_free(bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt);
 	vbdev_forward_io_cb(bdev_io, success, opaque);
 }
 
@@ -171,20 +185,23 @@ vbdev_forward_io(ocf_volume_t volume, ocf_forward_token_t token,
 			return;
 		}
 
-		iovcnt = data->iovcnt - skip;
+		iovcnt = get_cpy_vector_len(&data->iovs[skip], data->iovcnt - skip, offset, bytes);
+		if (iovcnt < 0) {
+			SPDK_ERRLOG("Forwarded range bigger than data size\n");
+			ocf_forward_end(token, -OCF_ERR_IO);
+			return;
+		}
 
 		iovs_allocated = true;
 		cb = vbdev_forward_io_free_iovs_cb;
-		iovs = env_malloc(sizeof(*iovs) * iovcnt, ENV_MEM_NOIO);
+		iovs = vbdev_ocf_iovs_alloc(iovcnt);
 
 		if (!iovs) {
-			SPDK_ERRLOG("Allocation failed\n");
 			ocf_forward_end(token, -OCF_ERR_NO_MEM);
 			return;
 		}
 
-		initialize_cpy_vector(iovs, data->iovcnt, &data->iovs[skip],
-				      iovcnt, offset, bytes);
+		initialize_cpy_vector(iovs, &data->iovs[skip], offset, bytes);
 	}
 
 	if (dir == OCF_READ) {
@@ -199,7 +216,7 @@ vbdev_forward_io(ocf_volume_t volume, ocf_forward_token_t token,
 		SPDK_ERRLOG("Submission failed with status=%d\n", status);
 		/* Since callback is not called, we need to do it manually to free iovs */
 		if (iovs_allocated) {
-			env_free(iovs);
+			vbdev_ocf_iovs_free(iovs, iovcnt);
 		}
 		ocf_forward_end(token, (status == -ENOMEM) ? -OCF_ERR_NO_MEM : -OCF_ERR_IO);
 	}
@@ -237,9 +254,16 @@ vbdev_forward_discard(ocf_volume_t volume, ocf_forward_token_t token,
 	struct vbdev_ocf_base *base =
 		*((struct vbdev_ocf_base **)
 		  ocf_volume_get_priv(volume));
+	struct bdev_ocf_data *data = ocf_forward_get_data(token);
 	struct spdk_io_channel *ch;
 	int status = 0;
 
+	/* Write zeroes and copy are sent to the core by vbdev_ocf itself */
+	if (!base->is_cache && data != NULL && data->invalidate_only) {
+		ocf_forward_end(token, 0);
+		return;
+	}
+
 	ch = vbdev_forward_get_channel(volume, token);
 	if (unlikely(ch == NULL)) {
 		ocf_forward_end(token, -EFAULT);
@@ -20,6 +20,8 @@
 
 #define RAID_BDEV_PROCESS_WINDOW_SIZE_KB_DEFAULT	1024
 #define RAID_BDEV_PROCESS_MAX_BANDWIDTH_MB_SEC_DEFAULT	0
+#define RAID_BDEV_STRIPE_CACHE_SIZE_KB_DEFAULT		0
+#define RAID_BDEV_STRIPE_CACHE_FLUSH_DELAY_US_DEFAULT	1000
 
 static bool g_shutdown_started = false;
 
@@ -91,6 +93,8 @@ struct raid_process_finish_action {
 static struct spdk_raid_bdev_opts g_opts = {
 	.process_window_size_kb = RAID_BDEV_PROCESS_WINDOW_SIZE_KB_DEFAULT,
 	.process_max_bandwidth_mb_sec = RAID_BDEV_PROCESS_MAX_BANDWIDTH_MB_SEC_DEFAULT,
+	.stripe_cache_size_kb = RAID_BDEV_STRIPE_CACHE_SIZE_KB_DEFAULT,
+	.stripe_cache_flush_delay_us = RAID_BDEV_STRIPE_CACHE_FLUSH_DELAY_US_DEFAULT,
 };
 
 void
@@ -484,14 +488,29 @@ raid_bdev_module_stop_done(struct raid_bdev *raid_bdev)
 }
 
 static void
-_raid_bdev_destruct(void *ctxt)
+raid_bdev_module_suspend(struct raid_bdev *raid_bdev, bool drain, void (*cb_fn)(void *cb_ctx),
+			 void *cb_ctx)
 {
-	struct raid_bdev *raid_bdev = ctxt;
-	struct raid_base_bdev_info *base_info;
+	if (raid_bdev->module->suspend != NULL) {
+		raid_bdev->module->suspend(raid_bdev, drain, cb_fn, cb_ctx);
+	} else {
+		cb_fn(cb_ctx);
+	}
+}
 
-	SPDK_DEBUGLOG(bdev_raid, "raid_bdev_destruct\n");
+static void
+raid_bdev_module_resume(struct raid_bdev *raid_bdev, bool drain)
+{
+	if (raid_bdev->module->resume != NULL) {
+		raid_bdev->module->resume(raid_bdev, drain);
+	}
+}
 
-	assert(raid_bdev->process == NULL);
+static void
+raid_bdev_destruct_suspended(void *ctxt)
+{
+	struct raid_bdev *raid_bdev = ctxt;
+	struct raid_base_bdev_info *base_info;
 
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
 		/*
@@ -516,6 +535,19 @@ _raid_bdev_destruct(void *ctxt)
 	raid_bdev_module_stop_done(raid_bdev);
 }
 
+static void
+_raid_bdev_destruct(void *ctxt)
+{
+	struct raid_bdev *raid_bdev = ctxt;
+
+	SPDK_DEBUGLOG(bdev_raid, "raid_bdev_destruct\n");
+
+	assert(raid_bdev->process == NULL);
+
+	/* Let the module write back its cached data while the base bdevs are still open */
+	raid_bdev_module_suspend(raid_bdev, true, raid_bdev_destruct_suspended, raid_bdev);
+}
+
 static int
 raid_bdev_destruct(void *ctx)
 {
@@ -1021,6 +1053,9 @@ _raid_bdev_io_type_supported(struct raid_bdev *raid_bdev, enum spdk_bdev_io_type
 
 	if (io_type == SPDK_BDEV_IO_TYPE_FLUSH ||
 	    io_type == SPDK_BDEV_IO_TYPE_UNMAP) {
+		if (raid_bdev->module->io_type_supported != NULL) {
+			return raid_bdev->module->io_type_supported(raid_bdev, io_type);
+		}
 		if (raid_bdev->module->submit_null_payload_request == NULL) {
 			return false;
 		}
@@ -1100,6 +1135,18 @@ raid_bdev_write_info_json(struct raid_bdev *raid_bdev, struct spdk_json_write_ct
 	spdk_json_write_named_uint32(w, "strip_size_kb", raid_bdev->strip_size_kb);
 	spdk_json_write_named_string(w, "state", raid_bdev_state_to_str(raid_bdev->state));
 	spdk_json_write_named_string(w, "raid_level", raid_bdev_level_to_str(raid_bdev->level));
+	if (raid_bdev->level == RAID10) {
+		spdk_json_write_named_uint32(w, "num_copies", raid_bdev->num_copies);
+		spdk_json_write_named_string(w, "layout", raid_bdev_layout_to_str(raid_bdev->layout));
+	}
+	if (raid_bdev->level == RAID1) {
+		spdk_json_write_named_string(w, "read_policy",
+					     raid_bdev_read_policy_to_str(raid_bdev->read_policy));
+		if (raid_bdev->read_policy == RAID_READ_POLICY_PREFERRED) {
+			spdk_json_write_named_uint32(w, "read_preferred_slot",
+						     raid_bdev->read_preferred_slot);
+		}
+	}
 	spdk_json_write_named_bool(w, "superblock", raid_bdev->superblock_enabled);
 	spdk_json_write_named_uint32(w, "num_base_bdevs", raid_bdev->num_base_bdevs);
 	spdk_json_write_named_uint32(w, "num_base_bdevs_discovered", raid_bdev->num_base_bdevs_discovered);
@@ -1119,6 +1166,10 @@ raid_bdev_write_info_json(struct raid_bdev *raid_bdev, struct spdk_json_write_ct
 		spdk_json_write_object_end(w);
 		spdk_json_write_object_end(w);
 	}
+	if (raid_bdev->module->dump_info_json != NULL &&
+	    raid_bdev->state == RAID_BDEV_STATE_ONLINE) {
+		raid_bdev->module->dump_info_json(raid_bdev, w);
+	}
 	spdk_json_write_name(w, "base_bdevs_list");
 	spdk_json_write_array_begin(w);
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
@@ -1196,6 +1247,26 @@ raid_bdev_write_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *
 		spdk_json_write_named_uint32(w, "strip_size_kb", raid_bdev->strip_size_kb);
 	}
 	spdk_json_write_named_string(w, "raid_level", raid_bdev_level_to_str(raid_bdev->level));
+	if (raid_bdev->level == RAID10) {
+		spdk_json_write_named_uint32(w, "num_copies", raid_bdev->num_copies);
+		spdk_json_write_named_string(w, "layout", raid_bdev_layout_to_str(raid_bdev->layout));
+	}
+	if (raid_bdev->read_policy != RAID_READ_POLICY_LEAST_OUTSTANDING) {
+		spdk_json_write_named_string(w, "read_policy",
+					     raid_bdev_read_policy_to_str(raid_bdev->read_policy));
+	}
+	if (raid_bdev->read_policy == RAID_READ_POLICY_PREFERRED) {
+		base_info = &raid_bdev->base_bdev_info[raid_bdev->read_preferred_slot];
+		if (base_info->name) {
+			spdk_json_write_named_string(w, "read_preferred_member", base_info->name);
+		} else {
+			char str[32];
+
+			snprintf(str, sizeof(str), "removed_base_bdev_%u",
+				 raid_bdev->read_preferred_slot);
+			spdk_json_write_named_string(w, "read_preferred_member", str);
+		}
+	}
 
 	spdk_json_write_named_array_begin(w, "base_bdevs");
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
@@ -1305,10 +1376,28 @@ static struct {
 	{ "1", RAID1 },
 	{ "raid5f", RAID5F },
 	{ "5f", RAID5F },
+	{ "raid6", RAID6 },
+	{ "6", RAID6 },
+	{ "raid10", RAID10 },
+	{ "10", RAID10 },
 	{ "concat", CONCAT },
 	{ }
 };
 
+static const char *g_raid_layout_names[] = {
+	[RAID_LAYOUT_NEAR]	= "near",
+	[RAID_LAYOUT_FAR]	= "far",
+	NULL
+};
+
+static const char *g_raid_read_policy_names[] = {
+	[RAID_READ_POLICY_LEAST_OUTSTANDING]	= "least_outstanding",
+	[RAID_READ_POLICY_LATENCY]		= "latency",
+	[RAID_READ_POLICY_SEQUENTIAL]		= "sequential",
+	[RAID_READ_POLICY_PREFERRED]		= "preferred",
+	NULL
+};
+
 const char *g_raid_state_names[] = {
 	[RAID_BDEV_STATE_ONLINE]	= "online",
 	[RAID_BDEV_STATE_CONFIGURING]	= "configuring",
@@ -1324,6 +1413,8 @@ static const char *g_raid_process_type_names[] = {
 
 /* We have to use the typedef in the function declaration to appease astyle. */
 typedef enum raid_level raid_level_t;
+typedef enum raid_layout raid_layout_t;
+typedef enum raid_read_policy raid_read_policy_t;
 typedef enum raid_bdev_state raid_bdev_state_t;
 
 raid_level_t
@@ -1356,6 +1447,58 @@ raid_bdev_level_to_str(enum raid_level level)
 	return "";
 }
 
+raid_layout_t
+raid_bdev_str_to_layout(const char *str)
+{
+	unsigned int i;
+
+	assert(str != NULL);
+
+	for (i = 0; g_raid_layout_names[i] != NULL; i++) {
+		if (strcasecmp(g_raid_layout_names[i], str) == 0) {
+			return i;
+		}
+	}
+
+	return INVALID_RAID_LAYOUT;
+}
+
+const char *
+raid_bdev_layout_to_str(enum raid_layout layout)
+{
+	if (layout < 0 || layout >= (int)SPDK_COUNTOF(g_raid_layout_names) - 1) {
+		return "";
+	}
+
+	return g_raid_layout_names[layout];
+}
+
+raid_read_policy_t
+raid_bdev_str_to_read_policy(const char *str)
+{
+	unsigned int i;
+
+	assert(str != NULL);
+
+	for (i = 0; g_raid_read_policy_names[i] != NULL; i++) {
+		if (strcasecmp(g_raid_read_policy_names[i], str) == 0) {
+			return i;
+		}
+	}
+
+	return INVALID_RAID_READ_POLICY;
+}
+
+const char *
+raid_bdev_read_policy_to_str(enum raid_read_policy policy)
+{
+	if (policy < 0 || policy >= (int)SPDK_COUNTOF(g_raid_read_policy_names) - 1) {
+		return "";
+	}
+
+	return g_raid_read_policy_names[policy];
+}
+
 raid_bdev_state_t
 raid_bdev_str_to_state(const char *str)
 {
@@ -1451,6 +1594,9 @@ raid_bdev_opts_config_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_named_uint32(w, "process_window_size_kb", g_opts.process_window_size_kb);
 	spdk_json_write_named_uint32(w, "process_max_bandwidth_mb_sec",
 				     g_opts.process_max_bandwidth_mb_sec);
+	spdk_json_write_named_uint32(w, "stripe_cache_size_kb", g_opts.stripe_cache_size_kb);
+	spdk_json_write_named_uint32(w, "stripe_cache_flush_delay_us",
+				     g_opts.stripe_cache_flush_delay_us);
 	spdk_json_write_object_end(w);
 
 	spdk_json_write_object_end(w);
@@ -1510,7 +1656,8 @@ raid_bdev_init(void)
 
 static int
 _raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
-		  enum raid_level level, bool superblock_enabled, const struct spdk_uuid *uuid,
+		  enum raid_level level, uint8_t num_copies, enum raid_layout layout,
+		  bool superblock_enabled, const struct spdk_uuid *uuid,
 		  struct raid_bdev **raid_bdev_out)
 {
 	struct raid_bdev *raid_bdev;
@@ -1539,6 +1686,24 @@ _raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
 		return -EINVAL;
 	}
 
+	if (level == RAID10) {
+		if (num_copies == 0) {
+			num_copies = 2;
+		}
+		if (num_copies < 2 || num_copies > num_base_bdevs) {
+			SPDK_ERRLOG("Invalid number of copies %u for %u base bdevs\n", num_copies, num_base_bdevs);
+			return -EINVAL;
+		}
+		if (layout != RAID_LAYOUT_NEAR && layout != RAID_LAYOUT_FAR) {
+			SPDK_ERRLOG("Invalid raid10 layout %d\n", layout);
+			return -EINVAL;
+		}
+	} else if (num_copies != 0 || layout != RAID_LAYOUT_NEAR) {
+		SPDK_ERRLOG("Number of copies and layout are not supported by %s\n",
+			    raid_bdev_level_to_str(level));
+		return -EINVAL;
+	}
+
 	module = raid_bdev_module_find(level);
 	if (module == NULL) {
 		SPDK_ERRLOG("Unsupported raid level '%d'\n", level);
@@ -1575,6 +1740,11 @@ _raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
 		return -EINVAL;
 	};
 
+	if (level == RAID10) {
+		/* any num_copies - 1 base bdevs can be lost without losing data */
+		min_operational = num_base_bdevs - num_copies + 1;
+	}
+
 	if (min_operational == 0 || min_operational > num_base_bdevs) {
 		SPDK_ERRLOG("Wrong constraint value for raid level '%s'.\n",
 			    raid_bdev_level_to_str(module->level));
@@ -1608,6 +1778,8 @@ _raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
 	raid_bdev->strip_size_kb = strip_size;
 	raid_bdev->state = RAID_BDEV_STATE_CONFIGURING;
 	raid_bdev->level = level;
+	raid_bdev->num_copies = num_copies;
+	raid_bdev->layout = layout;
 	raid_bdev->min_base_bdevs_operational = min_operational;
 	raid_bdev->superblock_enabled = superblock_enabled;
 
@@ -1642,6 +1814,8 @@ _raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
  * strip_size - strip size in KB
  * num_base_bdevs - number of base bdevs
  * level - raid level
+ * num_copies - number of copies of each strip (raid10 only, 0 for default)
+ * layout - placement of the copies (raid10 only)
  * superblock_enabled - true if raid should have superblock
  * uuid - uuid to set for the bdev
  * raid_bdev_out - the created raid bdev
@@ -1651,7 +1825,8 @@ _raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
  */
 int
 raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
-		 enum raid_level level, bool superblock_enabled, const struct spdk_uuid *uuid,
+		 enum raid_level level, uint8_t num_copies, enum raid_layout layout,
+		 bool superblock_enabled, const struct spdk_uuid *uuid,
 		 struct raid_bdev **raid_bdev_out)
 {
 	struct raid_bdev *raid_bdev;
@@ -1659,8 +1834,8 @@ raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
 
 	assert(uuid != NULL);
 
-	rc = _raid_bdev_create(name, strip_size, num_base_bdevs, level, superblock_enabled, uuid,
-			       &raid_bdev);
+	rc = _raid_bdev_create(name, strip_size, num_base_bdevs, level, num_copies, layout,
+			       superblock_enabled, uuid, &raid_bdev);
 	if (rc != 0) {
 		return rc;
 	}
@@ -1677,6 +1852,46 @@ raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
 	return 0;
 }
 
+/*
+ * brief:
+ * raid_bdev_set_read_policy sets the policy used to select the base bdev for reads
+ * params:
+ * raid_bdev - pointer to raid bdev
+ * policy - read policy
+ * preferred_slot - slot of the base bdev to read from, used only by RAID_READ_POLICY_PREFERRED
+ * returns:
+ * 0 - success
+ * non zero - failure
+ */
+int
+raid_bdev_set_read_policy(struct raid_bdev *raid_bdev, enum raid_read_policy policy,
+			  uint8_t preferred_slot)
+{
+	if (policy < RAID_READ_POLICY_LEAST_OUTSTANDING || policy > RAID_READ_POLICY_PREFERRED) {
+		SPDK_ERRLOG("Invalid read policy %d\n", policy);
+		return -EINVAL;
+	}
+
+	if (policy != RAID_READ_POLICY_LEAST_OUTSTANDING && raid_bdev->level != RAID1) {
+		SPDK_ERRLOG("Read policy %s is not supported by %s\n",
+			    raid_bdev_read_policy_to_str(policy),
+			    raid_bdev_level_to_str(raid_bdev->level));
+		return -EINVAL;
+	}
+
+	if (policy == RAID_READ_POLICY_PREFERRED && preferred_slot >= raid_bdev->num_base_bdevs) {
+		SPDK_ERRLOG("Invalid preferred base bdev slot %u\n", preferred_slot);
+		return -EINVAL;
+	} else if (policy != RAID_READ_POLICY_PREFERRED) {
+		preferred_slot = 0;
+	}
+
+	raid_bdev->read_policy = policy;
+	raid_bdev->read_preferred_slot = preferred_slot;
+
+	return 0;
+}
+
 static void
 _raid_bdev_unregistering_cont(void *ctx)
 {
@@ -1983,6 +2198,7 @@ raid_bdev_remove_base_bdev_on_unquiesced(void *ctx, int status)
 			    raid_bdev->bdev.name, spdk_strerror(-status));
 	}
 
+	raid_bdev_module_resume(raid_bdev, false);
 	raid_bdev_remove_base_bdev_done(base_info, status);
 }
 
@@ -2062,6 +2278,7 @@ raid_bdev_remove_base_bdev_write_sb_cb(int status, struct raid_bdev *raid_bdev,
 	if (status != 0) {
 		SPDK_ERRLOG("Failed to write raid bdev '%s' superblock: %s\n",
 			    raid_bdev->bdev.name, spdk_strerror(-status));
+		raid_bdev_module_resume(raid_bdev, false);
 		raid_bdev_remove_base_bdev_done(base_info, status);
 		return;
 	}
@@ -2070,18 +2287,11 @@ raid_bdev_remove_base_bdev_write_sb_cb(int status, struct raid_bdev *raid_bdev,
 }
 
 static void
-raid_bdev_remove_base_bdev_on_quiesced(void *ctx, int status)
+raid_bdev_remove_base_bdev_suspended(void *ctx)
 {
 	struct raid_base_bdev_info *base_info = ctx;
 	struct raid_bdev *raid_bdev = base_info->raid_bdev;
 
-	if (status != 0) {
-		SPDK_ERRLOG("Failed to quiesce raid bdev %s: %s\n",
-			    raid_bdev->bdev.name, spdk_strerror(-status));
-		raid_bdev_remove_base_bdev_done(base_info, status);
-		return;
-	}
-
 	if (raid_bdev->sb) {
 		struct raid_bdev_superblock *sb = raid_bdev->sb;
 		uint8_t slot = raid_bdev_base_bdev_slot(base_info);
@@ -2107,6 +2317,23 @@ raid_bdev_remove_base_bdev_on_quiesced(void *ctx, int status)
 	raid_bdev_remove_base_bdev_cont(base_info);
 }
 
+static void
+raid_bdev_remove_base_bdev_on_quiesced(void *ctx, int status)
+{
+	struct raid_base_bdev_info *base_info = ctx;
+	struct raid_bdev *raid_bdev = base_info->raid_bdev;
+
+	if (status != 0) {
+		SPDK_ERRLOG("Failed to quiesce raid bdev %s: %s\n",
+			    raid_bdev->bdev.name, spdk_strerror(-status));
+		raid_bdev_remove_base_bdev_done(base_info, status);
+		return;
+	}
+
+	/* Stop the module's own base bdev I/O before the channels are reconfigured */
+	raid_bdev_module_suspend(raid_bdev, false, raid_bdev_remove_base_bdev_suspended, base_info);
+}
+
 static int
 raid_bdev_remove_base_bdev_quiesce(struct raid_base_bdev_info *base_info)
 {
@@ -2631,6 +2858,8 @@ __raid_bdev_process_finish(struct spdk_io_channel_iter *i, int status)
 {
 	struct raid_bdev_process *process = spdk_io_channel_iter_get_ctx(i);
 
+	raid_bdev_module_resume(process->raid_bdev, true);
+
 	spdk_thread_send_msg(process->thread, raid_bdev_process_finish_done, process);
 }
 
@@ -2991,6 +3220,8 @@ raid_bdev_channels_abort_start_process_done(struct spdk_io_channel_iter *i, int
 {
 	struct raid_bdev_process *process = spdk_io_channel_iter_get_ctx(i);
 
+	raid_bdev_module_resume(process->raid_bdev, true);
+
 	_raid_bdev_remove_base_bdev(process->target, NULL, NULL);
 	raid_bdev_process_free(process);
 
@@ -3063,6 +3294,15 @@ raid_bdev_channel_start_process(struct spdk_io_channel_iter *i)
 	spdk_for_each_channel_continue(i, rc);
 }
 
+static void
+raid_bdev_process_start_suspended(void *ctx)
+{
+	struct raid_bdev_process *process = ctx;
+
+	spdk_for_each_channel(process->raid_bdev, raid_bdev_channel_start_process, process,
+			      raid_bdev_channels_start_process_done);
+}
+
 static void
 raid_bdev_process_start(struct raid_bdev_process *process)
 {
@@ -3070,8 +3310,11 @@ raid_bdev_process_start(struct raid_bdev_process *process)
 
 	assert(raid_bdev->module->submit_process_request != NULL);
 
-	spdk_for_each_channel(raid_bdev, raid_bdev_channel_start_process, process,
-			      raid_bdev_channels_start_process_done);
+	/*
+	 * The process reads the base bdevs directly, so any data cached by the module must be
+	 * written back first.
+	 */
+	raid_bdev_module_suspend(raid_bdev, true, raid_bdev_process_start_suspended, process);
 }
 
 static void
@@ -3561,11 +3804,17 @@ raid_bdev_create_from_sb(const struct raid_bdev_superblock *sb, struct raid_bdev
 	int rc;
 
 	rc = _raid_bdev_create(sb->name, (sb->strip_size * sb->block_size) / 1024, sb->num_base_bdevs,
-			       sb->level, true, &sb->uuid, &raid_bdev);
+			       sb->level, sb->num_copies, sb->layout, true, &sb->uuid, &raid_bdev);
 	if (rc != 0) {
 		return rc;
 	}
 
+	rc = raid_bdev_set_read_policy(raid_bdev, sb->read_policy, sb->read_preferred_slot);
+	if (rc != 0) {
+		raid_bdev_free(raid_bdev);
+		return rc;
+	}
+
 	rc = raid_bdev_alloc_superblock(raid_bdev, sb->block_size);
 	if (rc != 0) {
 		raid_bdev_free(raid_bdev);
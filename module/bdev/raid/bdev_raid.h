@@ -15,10 +15,36 @@ enum raid_level {
 	INVALID_RAID_LEVEL	= -1,
 	RAID0			= 0,
 	RAID1			= 1,
+	RAID6			= 6,
+	RAID10			= 10,
 	RAID5F			= 95, /* 0x5f */
 	CONCAT			= 99,
 };
 
+/*
+ * Placement of the data copies for raid levels storing multiple copies of each strip
+ */
+enum raid_layout {
+	INVALID_RAID_LAYOUT	= -1,
+	RAID_LAYOUT_NEAR	= 0,
+	RAID_LAYOUT_FAR		= 1,
+};
+
+/*
+ * Policy used to select the base bdev to read from for raid levels with mirrored data
+ */
+enum raid_read_policy {
+	INVALID_RAID_READ_POLICY		= -1,
+	/* base bdev with the fewest outstanding read blocks */
+	RAID_READ_POLICY_LEAST_OUTSTANDING	= 0,
+	/* base bdev with the lowest expected latency, based on the average of past reads */
+	RAID_READ_POLICY_LATENCY		= 1,
+	/* base bdev that served the previous adjacent read, to keep sequential streams together */
+	RAID_READ_POLICY_SEQUENTIAL		= 2,
+	/* always the preferred base bdev, if it is available */
+	RAID_READ_POLICY_PREFERRED		= 3,
+};
+
 /*
  * Raid state describes the state of the raid. This raid bdev can be either in
  * configured list or configuring list
@@ -225,6 +251,18 @@ struct raid_bdev {
 	/* Raid Level of this raid bdev */
 	enum raid_level			level;
 
+	/* number of copies of each strip, used by raid10 */
+	uint8_t				num_copies;
+
+	/* placement of the copies, used by raid10 */
+	enum raid_layout		layout;
+
+	/* read policy, used by raid1 */
+	enum raid_read_policy		read_policy;
+
+	/* slot of the base bdev to read from with RAID_READ_POLICY_PREFERRED */
+	uint8_t				read_preferred_slot;
+
 	/* Set to true if destroy of this raid bdev is started. */
 	bool				destroy_started;
 
@@ -263,7 +301,8 @@ extern struct raid_all_tailq		g_raid_bdev_list;
 typedef void (*raid_bdev_destruct_cb)(void *cb_ctx, int rc);
 
 int raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
-		     enum raid_level level, bool superblock, const struct spdk_uuid *uuid,
+		     enum raid_level level, uint8_t num_copies, enum raid_layout layout,
+		     bool superblock, const struct spdk_uuid *uuid,
 		     struct raid_bdev **raid_bdev_out);
 void raid_bdev_delete(struct raid_bdev *raid_bdev, raid_bdev_destruct_cb cb_fn, void *cb_ctx);
 int raid_bdev_add_base_bdev(struct raid_bdev *raid_bdev, const char *name,
@@ -271,6 +310,12 @@ int raid_bdev_add_base_bdev(struct raid_bdev *raid_bdev, const char *name,
 struct raid_bdev *raid_bdev_find_by_name(const char *name);
 enum raid_level raid_bdev_str_to_level(const char *str);
 const char *raid_bdev_level_to_str(enum raid_level level);
+enum raid_layout raid_bdev_str_to_layout(const char *str);
+const char *raid_bdev_layout_to_str(enum raid_layout layout);
+enum raid_read_policy raid_bdev_str_to_read_policy(const char *str);
+const char *raid_bdev_read_policy_to_str(enum raid_read_policy policy);
+int raid_bdev_set_read_policy(struct raid_bdev *raid_bdev, enum raid_read_policy policy,
+			      uint8_t preferred_slot);
 enum raid_bdev_state raid_bdev_str_to_state(const char *str);
 const char *raid_bdev_state_to_str(enum raid_bdev_state state);
 const char *raid_bdev_process_to_str(enum raid_process_type value);
@@ -349,6 +394,30 @@ struct raid_bdev_module {
 	int (*submit_process_request)(struct raid_bdev_process_request *process_req,
 				      struct raid_bdev_io_channel *raid_ch);
 
+	/*
+	 * Called to check if FLUSH or UNMAP is supported by the raid bdev. Optional. If not set,
+	 * these are supported if submit_null_payload_request is set and all the base bdevs
+	 * support them.
+	 */
+	bool (*io_type_supported)(struct raid_bdev *raid_bdev, enum spdk_bdev_io_type io_type);
+
+	/*
+	 * Called on the app thread before the I/O channels of the raid bdev are reconfigured,
+	 * i.e. before a base bdev is removed or a background process is started, and before the
+	 * raid bdev is destructed. A module that submits I/O to the base bdevs on its own, not
+	 * on behalf of a raid_bdev_io, must stop doing so until resume() is called and call
+	 * cb_fn when all such I/O has completed. If drain is true, any data cached by the module
+	 * must be written back first. Optional.
+	 */
+	void (*suspend)(struct raid_bdev *raid_bdev, bool drain, void (*cb_fn)(void *cb_ctx),
+			void *cb_ctx);
+
+	/* Called to undo suspend() with the same drain value. Optional. */
+	void (*resume)(struct raid_bdev *raid_bdev, bool drain);
+
+	/* Called to write module specific info of the raid bdev to JSON. Optional. */
+	void (*dump_info_json)(struct raid_bdev *raid_bdev, struct spdk_json_write_ctx *w);
+
 	TAILQ_ENTRY(raid_bdev_module) link;
 };
 
@@ -468,7 +537,7 @@ raid_bdev_flush_blocks(struct raid_base_bdev_info *base_info, struct spdk_io_cha
  */
 
 #define RAID_BDEV_SB_VERSION_MAJOR	1
-#define RAID_BDEV_SB_VERSION_MINOR	0
+#define RAID_BDEV_SB_VERSION_MINOR	1
 
 #define RAID_BDEV_SB_NAME_SIZE		64
 
@@ -530,8 +599,16 @@ struct raid_bdev_superblock {
 	uint64_t		seq_number;
 	/* number of raid base devices */
 	uint8_t			num_base_bdevs;
+	/* number of copies of each strip (raid10) */
+	uint8_t			num_copies;
+	/* placement of the copies (raid10) */
+	uint8_t			layout;
+	/* read policy (raid1) */
+	uint8_t			read_policy;
+	/* slot of the preferred base bdev for reads (raid1) */
+	uint8_t			read_preferred_slot;
 
-	uint8_t			reserved[118];
+	uint8_t			reserved[114];
 
 	/* size of the base bdevs array */
 	uint8_t			base_bdevs_size;
@@ -561,6 +638,10 @@ struct spdk_raid_bdev_opts {
 	uint32_t process_window_size_kb;
 	/* Maximum bandwidth in MiB to process per second */
 	uint32_t process_max_bandwidth_mb_sec;
+	/* Size of the write-back stripe cache of each raid5f bdev in KiB, 0 disables the cache */
+	uint32_t stripe_cache_size_kb;
+	/* Time in microseconds after which partially written stripes are flushed from the cache */
+	uint32_t stripe_cache_flush_delay_us;
 };
 
 void raid_bdev_get_opts(struct spdk_raid_bdev_opts *opts);
@@ -137,6 +137,18 @@ struct rpc_bdev_raid_create {
 
 	/* If set, information about raid bdev will be stored in superblock on each base bdev */
 	bool                                 superblock_enabled;
+
+	/* Number of copies of each strip (raid10) */
+	uint8_t                              num_copies;
+
+	/* Placement of the copies (raid10) */
+	enum raid_layout                     layout;
+
+	/* Policy for selecting the base bdev to read from (raid1) */
+	enum raid_read_policy                read_policy;
+
+	/* Base bdev to read from with the preferred read policy (raid1) */
+	char                                 *read_preferred_member;
 };
 
 /*
@@ -163,6 +175,54 @@ decode_raid_level(const struct spdk_json_val *val, void *out)
 	return ret;
 }
 
+/*
+ * Decoder function for RPC bdev_raid_create to decode raid10 layout
+ */
+static int
+decode_raid_layout(const struct spdk_json_val *val, void *out)
+{
+	int ret;
+	char *str = NULL;
+	enum raid_layout layout;
+
+	ret = spdk_json_decode_string(val, &str);
+	if (ret == 0 && str != NULL) {
+		layout = raid_bdev_str_to_layout(str);
+		if (layout == INVALID_RAID_LAYOUT) {
+			ret = -EINVAL;
+		} else {
+			*(enum raid_layout *)out = layout;
+		}
+	}
+
+	free(str);
+	return ret;
+}
+
+/*
+ * Decoder function for RPC bdev_raid_create to decode raid1 read policy
+ */
+static int
+decode_raid_read_policy(const struct spdk_json_val *val, void *out)
+{
+	int ret;
+	char *str = NULL;
+	enum raid_read_policy policy;
+
+	ret = spdk_json_decode_string(val, &str);
+	if (ret == 0 && str != NULL) {
+		policy = raid_bdev_str_to_read_policy(str);
+		if (policy == INVALID_RAID_READ_POLICY) {
+			ret = -EINVAL;
+		} else {
+			*(enum raid_read_policy *)out = policy;
+		}
+	}
+
+	free(str);
+	return ret;
+}
+
 /*
  * Decoder function for RPC bdev_raid_create to decode base bdevs list
  */
@@ -184,6 +244,11 @@ static const struct spdk_json_object_decoder rpc_bdev_raid_create_decoders[] = {
 	{"base_bdevs", offsetof(struct rpc_bdev_raid_create, base_bdevs), decode_base_bdevs},
 	{"uuid", offsetof(struct rpc_bdev_raid_create, uuid), spdk_json_decode_uuid, true},
 	{"superblock", offsetof(struct rpc_bdev_raid_create, superblock_enabled), spdk_json_decode_bool, true},
+	{"num_copies", offsetof(struct rpc_bdev_raid_create, num_copies), spdk_json_decode_uint8, true},
+	{"layout", offsetof(struct rpc_bdev_raid_create, layout), decode_raid_layout, true},
+	{"read_policy", offsetof(struct rpc_bdev_raid_create, read_policy), decode_raid_read_policy, true},
+	{"read_preferred_member", offsetof(struct rpc_bdev_raid_create, read_preferred_member),
+	 spdk_json_decode_string, true},
 };
 
 struct rpc_bdev_raid_create_ctx {
@@ -207,6 +272,7 @@ free_rpc_bdev_raid_create_ctx(struct rpc_bdev_raid_create_ctx *ctx)
 	req = &ctx->req;
 
 	free(req->name);
+	free(req->read_preferred_member);
 	for (i = 0; i < req->base_bdevs.num_base_bdevs; i++) {
 		free(req->base_bdevs.base_bdevs[i]);
 	}
@@ -261,6 +327,7 @@ rpc_bdev_raid_create(struct spdk_jsonrpc_request *request,
 	size_t				i;
 	struct rpc_bdev_raid_create_ctx *ctx;
 	uint8_t				num_base_bdevs;
+	uint8_t				preferred_slot = 0;
 
 	ctx = calloc(1, sizeof(*ctx));
 	if (ctx == NULL) {
@@ -287,9 +354,45 @@ rpc_bdev_raid_create(struct spdk_jsonrpc_request *request,
 		}
 	}
 
+	if (req->read_preferred_member != NULL) {
+		if (req->read_policy != RAID_READ_POLICY_PREFERRED) {
+			spdk_jsonrpc_send_error_response(request, -EINVAL,
+							 "read_preferred_member requires the preferred read policy");
+			goto cleanup;
+		}
+		for (i = 0; i < num_base_bdevs; i++) {
+			const char *base_bdev_name = req->base_bdevs.base_bdevs[i];
+
+			if (strcmp(base_bdev_name, req->read_preferred_member) == 0) {
+				break;
+			}
+		}
+		if (i == num_base_bdevs) {
+			spdk_jsonrpc_send_error_response_fmt(request, -EINVAL,
+							     "Preferred member %s is not a base bdev of %s",
+							     req->read_preferred_member, req->name);
+			goto cleanup;
+		}
+		preferred_slot = i;
+	} else if (req->read_policy == RAID_READ_POLICY_PREFERRED) {
+		spdk_jsonrpc_send_error_response(request, -EINVAL,
+						 "The preferred read policy requires read_preferred_member");
+		goto cleanup;
+	}
+
 	rc = raid_bdev_create(req->name, req->strip_size_kb, num_base_bdevs,
-			      req->level, req->superblock_enabled, &req->uuid, &raid_bdev);
+			      req->level, req->num_copies, req->layout, req->superblock_enabled,
+			      &req->uuid, &raid_bdev);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response_fmt(request, rc,
+						     "Failed to create RAID bdev %s: %s",
+						     req->name, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	rc = raid_bdev_set_read_policy(raid_bdev, req->read_policy, preferred_slot);
 	if (rc != 0) {
+		raid_bdev_delete(raid_bdev, NULL, NULL);
 		spdk_jsonrpc_send_error_response_fmt(request, rc,
 						     "Failed to create RAID bdev %s: %s",
 						     req->name, spdk_strerror(-rc));
@@ -608,6 +711,8 @@ SPDK_RPC_REGISTER("bdev_raid_remove_base_bdev", rpc_bdev_raid_remove_base_bdev,
 static const struct spdk_json_object_decoder rpc_bdev_raid_set_options_decoders[] = {
 	{"process_window_size_kb", offsetof(struct spdk_raid_bdev_opts, process_window_size_kb), spdk_json_decode_uint32, true},
 	{"process_max_bandwidth_mb_sec", offsetof(struct spdk_raid_bdev_opts, process_max_bandwidth_mb_sec), spdk_json_decode_uint32, true},
+	{"stripe_cache_size_kb", offsetof(struct spdk_raid_bdev_opts, stripe_cache_size_kb), spdk_json_decode_uint32, true},
+	{"stripe_cache_flush_delay_us", offsetof(struct spdk_raid_bdev_opts, stripe_cache_flush_delay_us), spdk_json_decode_uint32, true},
 };
 
 static void
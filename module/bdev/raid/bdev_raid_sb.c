@@ -77,6 +77,10 @@ raid_bdev_init_superblock(struct raid_bdev *raid_bdev)
 	sb->block_size = spdk_bdev_get_data_block_size(&raid_bdev->bdev);
 	sb->level = raid_bdev->level;
 	sb->strip_size = raid_bdev->strip_size;
+	sb->num_copies = raid_bdev->num_copies;
+	sb->layout = raid_bdev->layout;
+	sb->read_policy = raid_bdev->read_policy;
+	sb->read_preferred_slot = raid_bdev->read_preferred_slot;
 	/* TODO: sb->state */
 	sb->num_base_bdevs = sb->base_bdevs_size = raid_bdev->num_base_bdevs;
 	sb->length = sizeof(*sb) + sizeof(*sb_base_bdev) * sb->base_bdevs_size;
@@ -5,27 +5,92 @@
 
 #include "bdev_raid.h"
 
+#include "spdk/env.h"
+#include "spdk/json.h"
 #include "spdk/likely.h"
 #include "spdk/log.h"
 
+/* Weight of a new sample in the read latency moving average is 1/2^RAID1_LATENCY_EWMA_SHIFT */
+#define RAID1_LATENCY_EWMA_SHIFT 3
+
+/*
+ * With the latency read policy, a base bdev that was not selected for this many reads on a
+ * channel is selected once to refresh its latency estimate.
+ */
+#define RAID1_LATENCY_PROBE_INTERVAL 1024
+
+struct raid1_read_stats {
+	/* Number of successfully completed reads */
+	uint64_t reads;
+	/* Number of blocks read successfully */
+	uint64_t blocks;
+	/* Number of reads that started where the previous read on the same base bdev ended */
+	uint64_t sequential_reads;
+	/* Sum of the latencies of the successfully completed reads, in ticks */
+	uint64_t latency_ticks;
+};
+
 struct raid1_info {
 	/* The parent raid bdev */
 	struct raid_bdev *raid_bdev;
+
+	/* Protects the channel list and the stats of the destroyed channels */
+	struct spdk_spinlock lock;
+
+	/* IO channels of this raid bdev, used to report the read statistics */
+	TAILQ_HEAD(, raid1_io_channel) channels;
+
+	/* Per-base_bdev read statistics of the destroyed channels */
+	struct raid1_read_stats *stats;
+};
+
+struct raid1_base_channel {
+	/* Number of blocks of the outstanding reads */
+	uint64_t read_blocks_outstanding;
+
+	/* Number of outstanding reads */
+	uint64_t reads_outstanding;
+
+	/* Offset following the last read submitted to this base bdev */
+	uint64_t read_offset_next;
+
+	/* Moving average of the read latency, in ticks */
+	uint64_t read_latency_ewma;
+
+	/* Value of the channel's read sequence number when this base bdev was last selected */
+	uint64_t read_seq_last;
+
+	struct raid1_read_stats stats;
 };
 
 struct raid1_io_channel {
-	/* Array of per-base_bdev counters of outstanding read blocks on this channel */
-	uint64_t read_blocks_outstanding[0];
+	struct raid1_info *r1info;
+
+	TAILQ_ENTRY(raid1_io_channel) link;
+
+	/* Number of reads submitted on this channel */
+	uint64_t read_seq;
+
+	/* Array of per-base_bdev read state on this channel */
+	struct raid1_base_channel base[0];
 };
 
 static void
 raid1_channel_inc_read_counters(struct raid_bdev_io_channel *raid_ch, uint8_t idx,
-				uint64_t num_blocks)
+				uint64_t offset_blocks, uint64_t num_blocks)
 {
 	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	struct raid1_base_channel *base = &raid1_ch->base[idx];
+
+	assert(base->read_blocks_outstanding <= UINT64_MAX - num_blocks);
+	base->read_blocks_outstanding += num_blocks;
+	base->reads_outstanding++;
 
-	assert(raid1_ch->read_blocks_outstanding[idx] <= UINT64_MAX - num_blocks);
-	raid1_ch->read_blocks_outstanding[idx] += num_blocks;
+	if (base->read_offset_next == offset_blocks) {
+		base->stats.sequential_reads++;
+	}
+	base->read_offset_next = offset_blocks + num_blocks;
+	base->read_seq_last = ++raid1_ch->read_seq;
 }
 
 static void
@@ -33,9 +98,32 @@ raid1_channel_dec_read_counters(struct raid_bdev_io_channel *raid_ch, uint8_t id
 				uint64_t num_blocks)
 {
 	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	struct raid1_base_channel *base = &raid1_ch->base[idx];
+
+	assert(base->read_blocks_outstanding >= num_blocks);
+	base->read_blocks_outstanding -= num_blocks;
+	assert(base->reads_outstanding > 0);
+	base->reads_outstanding--;
+}
+
+static void
+raid1_channel_update_read_latency(struct raid_bdev_io_channel *raid_ch, uint8_t idx,
+				  uint64_t num_blocks, uint64_t latency_ticks)
+{
+	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	struct raid1_base_channel *base = &raid1_ch->base[idx];
+
+	if (base->read_latency_ewma == 0) {
+		base->read_latency_ewma = latency_ticks;
+	} else {
+		base->read_latency_ewma = base->read_latency_ewma -
+					  (base->read_latency_ewma >> RAID1_LATENCY_EWMA_SHIFT) +
+					  (latency_ticks >> RAID1_LATENCY_EWMA_SHIFT);
+	}
 
-	assert(raid1_ch->read_blocks_outstanding[idx] >= num_blocks);
-	raid1_ch->read_blocks_outstanding[idx] -= num_blocks;
+	base->stats.reads++;
+	base->stats.blocks += num_blocks;
+	base->stats.latency_ticks += latency_ticks;
 }
 
 static void
@@ -191,6 +279,7 @@ static void
 raid1_read_bdev_io_completion(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 {
 	struct raid_bdev_io *raid_io = cb_arg;
+	uint64_t latency_ticks = spdk_get_ticks() - spdk_bdev_io_get_submit_tsc(bdev_io);
 
 	spdk_bdev_free_io(bdev_io);
 
@@ -203,6 +292,9 @@ raid1_read_bdev_io_completion(struct spdk_bdev_io *bdev_io, bool success, void *
 		return;
 	}
 
+	raid1_channel_update_read_latency(raid_io->raid_ch, raid_io->base_bdev_io_submitted,
+					  raid_io->num_blocks, latency_ticks);
+
 	raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_SUCCESS);
 }
 
@@ -217,7 +309,8 @@ _raid1_submit_rw_request(void *_raid_io)
 }
 
 static uint8_t
-raid1_channel_next_read_base_bdev(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch)
+raid1_channel_least_outstanding_base_bdev(struct raid_bdev *raid_bdev,
+		struct raid_bdev_io_channel *raid_ch)
 {
 	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
 	uint64_t read_blocks_min = UINT64_MAX;
@@ -226,8 +319,42 @@ raid1_channel_next_read_base_bdev(struct raid_bdev *raid_bdev, struct raid_bdev_
 
 	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
 		if (raid_bdev_channel_get_base_channel(raid_ch, i) != NULL &&
-		    raid1_ch->read_blocks_outstanding[i] < read_blocks_min) {
-			read_blocks_min = raid1_ch->read_blocks_outstanding[i];
+		    raid1_ch->base[i].read_blocks_outstanding < read_blocks_min) {
+			read_blocks_min = raid1_ch->base[i].read_blocks_outstanding;
+			idx = i;
+		}
+	}
+
+	return idx;
+}
+
+static uint8_t
+raid1_channel_lowest_latency_base_bdev(struct raid_bdev *raid_bdev,
+				       struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	struct raid1_base_channel *base;
+	uint64_t latency, latency_min = UINT64_MAX;
+	uint64_t read_blocks_min = UINT64_MAX;
+	uint8_t idx = UINT8_MAX;
+	uint8_t i;
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		if (raid_bdev_channel_get_base_channel(raid_ch, i) == NULL) {
+			continue;
+		}
+		base = &raid1_ch->base[i];
+
+		if (raid1_ch->read_seq - base->read_seq_last > RAID1_LATENCY_PROBE_INTERVAL) {
+			return i;
+		}
+
+		/* Expected latency of a read queued behind the ones already outstanding */
+		latency = base->read_latency_ewma * (base->reads_outstanding + 1);
+		if (latency < latency_min ||
+		    (latency == latency_min && base->read_blocks_outstanding < read_blocks_min)) {
+			latency_min = latency;
+			read_blocks_min = base->read_blocks_outstanding;
 			idx = i;
 		}
 	}
@@ -235,6 +362,45 @@ raid1_channel_next_read_base_bdev(struct raid_bdev *raid_bdev, struct raid_bdev_
 	return idx;
 }
 
+static uint8_t
+raid1_channel_sequential_base_bdev(struct raid_bdev *raid_bdev,
+				   struct raid_bdev_io_channel *raid_ch, uint64_t offset_blocks)
+{
+	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	uint8_t i;
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		if (raid_bdev_channel_get_base_channel(raid_ch, i) != NULL &&
+		    raid1_ch->base[i].read_offset_next == offset_blocks) {
+			return i;
+		}
+	}
+
+	return raid1_channel_least_outstanding_base_bdev(raid_bdev, raid_ch);
+}
+
+static uint8_t
+raid1_channel_next_read_base_bdev(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch,
+				  uint64_t offset_blocks)
+{
+	uint8_t idx;
+
+	switch (raid_bdev->read_policy) {
+	case RAID_READ_POLICY_LATENCY:
+		return raid1_channel_lowest_latency_base_bdev(raid_bdev, raid_ch);
+	case RAID_READ_POLICY_SEQUENTIAL:
+		return raid1_channel_sequential_base_bdev(raid_bdev, raid_ch, offset_blocks);
+	case RAID_READ_POLICY_PREFERRED:
+		idx = raid_bdev->read_preferred_slot;
+		if (raid_bdev_channel_get_base_channel(raid_ch, idx) != NULL) {
+			return idx;
+		}
+		/* fall through */
+	default:
+		return raid1_channel_least_outstanding_base_bdev(raid_bdev, raid_ch);
+	}
+}
+
 static int
 raid1_submit_read_request(struct raid_bdev_io *raid_io)
 {
@@ -246,7 +412,7 @@ raid1_submit_read_request(struct raid_bdev_io *raid_io)
 	uint8_t idx;
 	int ret;
 
-	idx = raid1_channel_next_read_base_bdev(raid_bdev, raid_ch);
+	idx = raid1_channel_next_read_base_bdev(raid_bdev, raid_ch, raid_io->offset_blocks);
 	if (spdk_unlikely(idx == UINT8_MAX)) {
 		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
 		return 0;
@@ -261,7 +427,8 @@ raid1_submit_read_request(struct raid_bdev_io *raid_io)
 					 raid1_read_bdev_io_completion, raid_io, &io_opts);
 
 	if (spdk_likely(ret == 0)) {
-		raid1_channel_inc_read_counters(raid_ch, idx, raid_io->num_blocks);
+		raid1_channel_inc_read_counters(raid_ch, idx, raid_io->offset_blocks,
+						raid_io->num_blocks);
 		raid_io->base_bdev_io_submitted = idx;
 	} else if (spdk_unlikely(ret == -ENOMEM)) {
 		raid_bdev_queue_io_wait(raid_io, spdk_bdev_desc_get_bdev(base_info->desc),
@@ -432,17 +599,57 @@ raid1_submit_null_payload_request(struct raid_bdev_io *raid_io)
 	assert(raid_io->base_bdev_io_submitted != 0);
 }
 
+static void
+raid1_read_stats_add(struct raid1_read_stats *stats, const struct raid1_read_stats *other)
+{
+	stats->reads += other->reads;
+	stats->blocks += other->blocks;
+	stats->sequential_reads += other->sequential_reads;
+	stats->latency_ticks += other->latency_ticks;
+}
+
 static void
 raid1_ioch_destroy(void *io_device, void *ctx_buf)
 {
+	struct raid1_info *r1info = io_device;
+	struct raid1_io_channel *raid1_ch = ctx_buf;
+	uint8_t i;
+
+	spdk_spin_lock(&r1info->lock);
+	TAILQ_REMOVE(&r1info->channels, raid1_ch, link);
+	for (i = 0; i < r1info->raid_bdev->num_base_bdevs; i++) {
+		raid1_read_stats_add(&r1info->stats[i], &raid1_ch->base[i].stats);
+	}
+	spdk_spin_unlock(&r1info->lock);
 }
 
 static int
 raid1_ioch_create(void *io_device, void *ctx_buf)
 {
+	struct raid1_info *r1info = io_device;
+	struct raid1_io_channel *raid1_ch = ctx_buf;
+	uint8_t i;
+
+	raid1_ch->r1info = r1info;
+	for (i = 0; i < r1info->raid_bdev->num_base_bdevs; i++) {
+		raid1_ch->base[i].read_offset_next = UINT64_MAX;
+	}
+
+	spdk_spin_lock(&r1info->lock);
+	TAILQ_INSERT_TAIL(&r1info->channels, raid1_ch, link);
+	spdk_spin_unlock(&r1info->lock);
+
 	return 0;
 }
 
+static void
+raid1_info_free(struct raid1_info *r1info)
+{
+	spdk_spin_destroy(&r1info->lock);
+	free(r1info->stats);
+	free(r1info);
+}
+
 static void
 raid1_io_device_unregister_done(void *io_device)
 {
@@ -450,7 +657,7 @@ raid1_io_device_unregister_done(void *io_device)
 
 	raid_bdev_module_stop_done(r1info->raid_bdev);
 
-	free(r1info);
+	raid1_info_free(r1info);
 }
 
 static int
@@ -467,6 +674,15 @@ raid1_start(struct raid_bdev *raid_bdev)
 		return -ENOMEM;
 	}
 	r1info->raid_bdev = raid_bdev;
+	spdk_spin_init(&r1info->lock);
+	TAILQ_INIT(&r1info->channels);
+
+	r1info->stats = calloc(raid_bdev->num_base_bdevs, sizeof(*r1info->stats));
+	if (!r1info->stats) {
+		SPDK_ERRLOG("Failed to allocate RAID1 read statistics\n");
+		raid1_info_free(r1info);
+		return -ENOMEM;
+	}
 
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
 		min_blockcnt = spdk_min(min_blockcnt, base_info->data_size);
@@ -481,7 +697,8 @@ raid1_start(struct raid_bdev *raid_bdev)
 
 	snprintf(name, sizeof(name), "raid1_%s", raid_bdev->bdev.name);
 	spdk_io_device_register(r1info, raid1_ioch_create, raid1_ioch_destroy,
-				sizeof(struct raid1_io_channel) + raid_bdev->num_base_bdevs * sizeof(uint64_t),
+				sizeof(struct raid1_io_channel) +
+				raid_bdev->num_base_bdevs * sizeof(struct raid1_base_channel),
 				name);
 
 	return 0;
@@ -616,6 +833,45 @@ raid1_resize(struct raid_bdev *raid_bdev)
 	return true;
 }
 
+static void
+raid1_dump_info_json(struct raid_bdev *raid_bdev, struct spdk_json_write_ctx *w)
+{
+	struct raid1_info *r1info = raid_bdev->module_private;
+	struct raid1_io_channel *raid1_ch;
+	struct raid1_read_stats stats;
+	struct raid_base_bdev_info *base_info;
+	uint64_t ticks_hz = spdk_get_ticks_hz();
+	uint8_t i;
+
+	spdk_json_write_named_array_begin(w, "read_stats");
+	spdk_spin_lock(&r1info->lock);
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		base_info = &raid_bdev->base_bdev_info[i];
+
+		/* The counters of the active channels are read without synchronization */
+		stats = r1info->stats[i];
+		TAILQ_FOREACH(raid1_ch, &r1info->channels, link) {
+			raid1_read_stats_add(&stats, &raid1_ch->base[i].stats);
+		}
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_name(w, "name");
+		if (base_info->name) {
+			spdk_json_write_string(w, base_info->name);
+		} else {
+			spdk_json_write_null(w);
+		}
+		spdk_json_write_named_uint64(w, "reads", stats.reads);
+		spdk_json_write_named_uint64(w, "blocks", stats.blocks);
+		spdk_json_write_named_uint64(w, "sequential_reads", stats.sequential_reads);
+		spdk_json_write_named_uint64(w, "avg_latency_us", stats.reads == 0 ? 0 :
+					     stats.latency_ticks / stats.reads * SPDK_SEC_TO_USEC / ticks_hz);
+		spdk_json_write_object_end(w);
+	}
+	spdk_spin_unlock(&r1info->lock);
+	spdk_json_write_array_end(w);
+}
+
 static struct raid_bdev_module g_raid1_module = {
 	.level = RAID1,
 	.base_bdevs_min = 2,
@@ -628,6 +884,7 @@ static struct raid_bdev_module g_raid1_module = {
 	.get_io_channel = raid1_get_io_channel,
 	.submit_process_request = raid1_submit_process_request,
 	.resize = raid1_resize,
+	.dump_info_json = raid1_dump_info_json,
 };
 RAID_MODULE_REGISTER(&g_raid1_module)
 
@@ -0,0 +1,897 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "bdev_raid.h"
+
+#include "spdk/likely.h"
+#include "spdk/log.h"
+#include "spdk/thread.h"
+#include "spdk/util.h"
+
+/*
+ * RAID10 stores num_copies copies of every strip on distinct base bdevs. Two layouts are
+ * supported:
+ *
+ * near - the copies of a strip are placed next to each other, i.e. the copy k of strip s
+ *        is at position s * num_copies + k, where positions are laid out row by row across
+ *        the base bdevs.
+ * far  - every base bdev is split into num_copies sections. The copy k of strip s is placed
+ *        in section k using the raid0 layout rotated by k base bdevs.
+ */
+
+struct raid10_info {
+	/* The parent raid bdev */
+	struct raid_bdev *raid_bdev;
+
+	/* Number of strips in a single section of a base bdev (far layout) */
+	uint64_t section_strips;
+};
+
+struct raid10_base_bdev_stats {
+	/* Number of outstanding read blocks on this channel */
+	uint64_t read_blocks_outstanding;
+
+	/* Offset on the base bdev right after the last read submitted on this channel */
+	uint64_t read_offset_next;
+};
+
+struct raid10_io_channel {
+	/* Per-base_bdev read statistics */
+	struct raid10_base_bdev_stats base[0];
+};
+
+/* The range of data strips covered by an I/O */
+struct raid10_io_range {
+	uint64_t start_strip;
+	uint64_t end_strip;
+	uint64_t start_offset_in_strip;
+	uint64_t end_offset_in_strip;
+};
+
+static inline void
+raid10_strip_copy_location(const struct raid_bdev *raid_bdev, uint64_t strip, uint8_t copy,
+			   uint8_t *disk_idx, uint64_t *disk_strip)
+{
+	const struct raid10_info *r10info = raid_bdev->module_private;
+	uint64_t pos;
+
+	if (raid_bdev->layout == RAID_LAYOUT_NEAR) {
+		pos = strip * raid_bdev->num_copies + copy;
+		*disk_idx = pos % raid_bdev->num_base_bdevs;
+		*disk_strip = pos / raid_bdev->num_base_bdevs;
+	} else {
+		*disk_idx = (strip + copy) % raid_bdev->num_base_bdevs;
+		*disk_strip = copy * r10info->section_strips + strip / raid_bdev->num_base_bdevs;
+	}
+}
+
+static inline void
+raid10_io_copy_location(struct raid_bdev_io *raid_io, uint8_t copy, uint8_t *disk_idx,
+			uint64_t *pd_lba)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	uint64_t strip = raid_io->offset_blocks >> raid_bdev->strip_size_shift;
+	uint64_t disk_strip;
+
+	raid10_strip_copy_location(raid_bdev, strip, copy, disk_idx, &disk_strip);
+	*pd_lba = (disk_strip << raid_bdev->strip_size_shift) +
+		  (raid_io->offset_blocks & (raid_bdev->strip_size - 1));
+}
+
+static void
+raid10_init_ext_io_opts(struct spdk_bdev_ext_io_opts *opts, struct raid_bdev_io *raid_io)
+{
+	memset(opts, 0, sizeof(*opts));
+	opts->size = sizeof(*opts);
+	opts->memory_domain = raid_io->memory_domain;
+	opts->memory_domain_ctx = raid_io->memory_domain_ctx;
+	opts->metadata = raid_io->md_buf;
+}
+
+static void
+raid10_write_bdev_io_completion(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+
+	if (!success) {
+		struct raid_base_bdev_info *base_info;
+
+		base_info = raid_bdev_channel_get_base_info(raid_io->raid_ch, bdev_io->bdev);
+		if (base_info) {
+			raid_bdev_fail_base_bdev(base_info);
+		}
+	}
+
+	spdk_bdev_free_io(bdev_io);
+
+	raid_bdev_io_complete_part(raid_io, 1, success ?
+				   SPDK_BDEV_IO_STATUS_SUCCESS :
+				   SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static struct raid_base_bdev_info *
+raid10_get_read_io_base_bdev(struct raid_bdev_io *raid_io)
+{
+	uint8_t disk_idx;
+	uint64_t pd_lba;
+
+	assert(raid_io->type == SPDK_BDEV_IO_TYPE_READ);
+	raid10_io_copy_location(raid_io, raid_io->base_bdev_io_submitted, &disk_idx, &pd_lba);
+
+	return &raid_io->raid_bdev->base_bdev_info[disk_idx];
+}
+
+static void
+raid10_correct_read_error_completion(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		struct raid_base_bdev_info *base_info = raid10_get_read_io_base_bdev(raid_io);
+
+		/* Writing to the bdev that had the read error failed so fail the base bdev
+		 * but complete the raid_io successfully. */
+		raid_bdev_fail_base_bdev(base_info);
+	}
+
+	raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+}
+
+static void
+raid10_correct_read_error(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct spdk_bdev_ext_io_opts io_opts;
+	struct raid_base_bdev_info *base_info;
+	struct spdk_io_channel *base_ch;
+	uint8_t disk_idx;
+	uint64_t pd_lba;
+	int ret;
+
+	raid10_io_copy_location(raid_io, raid_io->base_bdev_io_submitted, &disk_idx, &pd_lba);
+	base_info = &raid_bdev->base_bdev_info[disk_idx];
+	base_ch = raid_bdev_channel_get_base_channel(raid_io->raid_ch, disk_idx);
+	assert(base_ch != NULL);
+
+	raid10_init_ext_io_opts(&io_opts, raid_io);
+	ret = raid_bdev_writev_blocks_ext(base_info, base_ch, raid_io->iovs, raid_io->iovcnt,
+					  pd_lba, raid_io->num_blocks,
+					  raid10_correct_read_error_completion, raid_io, &io_opts);
+	if (spdk_unlikely(ret != 0)) {
+		if (ret == -ENOMEM) {
+			raid_bdev_queue_io_wait(raid_io, spdk_bdev_desc_get_bdev(base_info->desc),
+						base_ch, raid10_correct_read_error);
+		} else {
+			raid_bdev_fail_base_bdev(base_info);
+			raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+		}
+	}
+}
+
+static void raid10_read_other_copy(void *_raid_io);
+
+static void
+raid10_read_other_completion(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		assert(raid_io->base_bdev_io_remaining > 0);
+		raid_io->base_bdev_io_remaining--;
+		raid10_read_other_copy(raid_io);
+		return;
+	}
+
+	/* try to correct the read error by writing data read from the other copy */
+	raid10_correct_read_error(raid_io);
+}
+
+static void
+raid10_read_other_copy(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct spdk_bdev_ext_io_opts io_opts;
+	struct raid_base_bdev_info *base_info;
+	struct spdk_io_channel *base_ch;
+	uint8_t copy, disk_idx;
+	uint64_t pd_lba;
+	int ret;
+
+	for (copy = raid_bdev->num_copies - raid_io->base_bdev_io_remaining;
+	     copy < raid_bdev->num_copies; copy++) {
+		raid10_io_copy_location(raid_io, copy, &disk_idx, &pd_lba);
+		base_info = &raid_bdev->base_bdev_info[disk_idx];
+		base_ch = raid_bdev_channel_get_base_channel(raid_io->raid_ch, disk_idx);
+
+		if (base_ch == NULL || copy == raid_io->base_bdev_io_submitted) {
+			raid_io->base_bdev_io_remaining--;
+			continue;
+		}
+
+		raid10_init_ext_io_opts(&io_opts, raid_io);
+		ret = raid_bdev_readv_blocks_ext(base_info, base_ch, raid_io->iovs, raid_io->iovcnt,
+						 pd_lba, raid_io->num_blocks,
+						 raid10_read_other_completion, raid_io, &io_opts);
+		if (spdk_unlikely(ret != 0)) {
+			if (ret == -ENOMEM) {
+				raid_bdev_queue_io_wait(raid_io, spdk_bdev_desc_get_bdev(base_info->desc),
+							base_ch, raid10_read_other_copy);
+			} else {
+				break;
+			}
+		}
+		return;
+	}
+
+	base_info = raid10_get_read_io_base_bdev(raid_io);
+	raid_bdev_fail_base_bdev(base_info);
+
+	raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void
+raid10_read_bdev_io_completion(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+	struct raid10_io_channel *r10ch = raid_bdev_channel_get_module_ctx(raid_io->raid_ch);
+	struct raid10_base_bdev_stats *stats;
+	uint8_t disk_idx;
+	uint64_t pd_lba;
+
+	spdk_bdev_free_io(bdev_io);
+
+	raid10_io_copy_location(raid_io, raid_io->base_bdev_io_submitted, &disk_idx, &pd_lba);
+	stats = &r10ch->base[disk_idx];
+	assert(stats->read_blocks_outstanding >= raid_io->num_blocks);
+	stats->read_blocks_outstanding -= raid_io->num_blocks;
+
+	if (!success) {
+		raid_io->base_bdev_io_remaining = raid_io->raid_bdev->num_copies;
+		raid10_read_other_copy(raid_io);
+		return;
+	}
+
+	raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+}
+
+static void raid10_submit_rw_request(struct raid_bdev_io *raid_io);
+
+static void
+_raid10_submit_rw_request(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+
+	raid10_submit_rw_request(raid_io);
+}
+
+static inline uint64_t
+raid10_offset_distance(uint64_t a, uint64_t b)
+{
+	return a > b ? a - b : b - a;
+}
+
+/*
+ * Select the copy to read from. The copy on the base bdev with the fewest outstanding read
+ * blocks is preferred. Ties are broken by the distance from the end of the last read
+ * submitted to that base bdev, which favors sequential access to each base bdev.
+ */
+static uint8_t
+raid10_channel_next_read_copy(struct raid_bdev_io *raid_io)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid10_io_channel *r10ch = raid_bdev_channel_get_module_ctx(raid_io->raid_ch);
+	uint64_t read_blocks_min = UINT64_MAX;
+	uint64_t distance_min = UINT64_MAX;
+	uint64_t pd_lba, distance;
+	uint8_t copy = UINT8_MAX;
+	uint8_t i, disk_idx;
+
+	for (i = 0; i < raid_bdev->num_copies; i++) {
+		struct raid10_base_bdev_stats *stats;
+
+		raid10_io_copy_location(raid_io, i, &disk_idx, &pd_lba);
+		if (raid_bdev_channel_get_base_channel(raid_io->raid_ch, disk_idx) == NULL) {
+			continue;
+		}
+
+		stats = &r10ch->base[disk_idx];
+		distance = raid10_offset_distance(stats->read_offset_next, pd_lba);
+		if (stats->read_blocks_outstanding < read_blocks_min ||
+		    (stats->read_blocks_outstanding == read_blocks_min && distance < distance_min)) {
+			read_blocks_min = stats->read_blocks_outstanding;
+			distance_min = distance;
+			copy = i;
+		}
+	}
+
+	return copy;
+}
+
+static int
+raid10_submit_read_request(struct raid_bdev_io *raid_io)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid_bdev_io_channel *raid_ch = raid_io->raid_ch;
+	struct raid10_io_channel *r10ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	struct spdk_bdev_ext_io_opts io_opts;
+	struct raid_base_bdev_info *base_info;
+	struct spdk_io_channel *base_ch;
+	uint8_t copy, disk_idx;
+	uint64_t pd_lba;
+	int ret;
+
+	copy = raid10_channel_next_read_copy(raid_io);
+	if (spdk_unlikely(copy == UINT8_MAX)) {
+		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return 0;
+	}
+
+	raid10_io_copy_location(raid_io, copy, &disk_idx, &pd_lba);
+	base_info = &raid_bdev->base_bdev_info[disk_idx];
+	base_ch = raid_bdev_channel_get_base_channel(raid_ch, disk_idx);
+
+	raid10_init_ext_io_opts(&io_opts, raid_io);
+	ret = raid_bdev_readv_blocks_ext(base_info, base_ch, raid_io->iovs, raid_io->iovcnt,
+					 pd_lba, raid_io->num_blocks,
+					 raid10_read_bdev_io_completion, raid_io, &io_opts);
+
+	if (spdk_likely(ret == 0)) {
+		r10ch->base[disk_idx].read_blocks_outstanding += raid_io->num_blocks;
+		r10ch->base[disk_idx].read_offset_next = pd_lba + raid_io->num_blocks;
+		raid_io->base_bdev_io_submitted = copy;
+	} else if (spdk_unlikely(ret == -ENOMEM)) {
+		raid_bdev_queue_io_wait(raid_io, spdk_bdev_desc_get_bdev(base_info->desc),
+					base_ch, _raid10_submit_rw_request);
+		return 0;
+	}
+
+	return ret;
+}
+
+static int
+raid10_submit_write_request(struct raid_bdev_io *raid_io)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct spdk_bdev_ext_io_opts io_opts;
+	struct raid_base_bdev_info *base_info;
+	struct spdk_io_channel *base_ch;
+	uint8_t copy, disk_idx;
+	uint64_t pd_lba;
+	uint64_t base_bdev_io_not_submitted;
+	int ret = 0;
+
+	if (raid_io->base_bdev_io_submitted == 0) {
+		raid_io->base_bdev_io_remaining = raid_bdev->num_copies;
+		raid_bdev_io_set_default_status(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+	}
+
+	raid10_init_ext_io_opts(&io_opts, raid_io);
+	for (copy = raid_io->base_bdev_io_submitted; copy < raid_bdev->num_copies; copy++) {
+		raid10_io_copy_location(raid_io, copy, &disk_idx, &pd_lba);
+		base_info = &raid_bdev->base_bdev_info[disk_idx];
+		base_ch = raid_bdev_channel_get_base_channel(raid_io->raid_ch, disk_idx);
+
+		if (base_ch == NULL) {
+			/* skip a missing base bdev's copy */
+			raid_io->base_bdev_io_submitted++;
+			raid_bdev_io_complete_part(raid_io, 1, SPDK_BDEV_IO_STATUS_FAILED);
+			continue;
+		}
+
+		ret = raid_bdev_writev_blocks_ext(base_info, base_ch, raid_io->iovs, raid_io->iovcnt,
+						  pd_lba, raid_io->num_blocks,
+						  raid10_write_bdev_io_completion, raid_io, &io_opts);
+		if (spdk_unlikely(ret != 0)) {
+			if (spdk_unlikely(ret == -ENOMEM)) {
+				raid_bdev_queue_io_wait(raid_io, spdk_bdev_desc_get_bdev(base_info->desc),
+							base_ch, _raid10_submit_rw_request);
+				return 0;
+			}
+
+			base_bdev_io_not_submitted = raid_bdev->num_copies -
+						     raid_io->base_bdev_io_submitted;
+			raid_bdev_io_complete_part(raid_io, base_bdev_io_not_submitted,
+						   SPDK_BDEV_IO_STATUS_FAILED);
+			return 0;
+		}
+
+		raid_io->base_bdev_io_submitted++;
+	}
+
+	return ret;
+}
+
+static void
+raid10_submit_rw_request(struct raid_bdev_io *raid_io)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	int ret;
+
+	if (spdk_unlikely((raid_io->offset_blocks >> raid_bdev->strip_size_shift) !=
+			  ((raid_io->offset_blocks + raid_io->num_blocks - 1) >> raid_bdev->strip_size_shift))) {
+		assert(false);
+		SPDK_ERRLOG("I/O spans strip boundary!\n");
+		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	switch (raid_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		ret = raid10_submit_read_request(raid_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		ret = raid10_submit_write_request(raid_io);
+		break;
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	if (spdk_unlikely(ret != 0)) {
+		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static void
+raid10_get_io_range(struct raid10_io_range *io_range, struct raid_bdev *raid_bdev,
+		    uint64_t offset_blocks, uint64_t num_blocks)
+{
+	uint64_t end_blocks = offset_blocks + num_blocks - 1;
+
+	assert(num_blocks > 0);
+	io_range->start_strip = offset_blocks >> raid_bdev->strip_size_shift;
+	io_range->end_strip = end_blocks >> raid_bdev->strip_size_shift;
+	io_range->start_offset_in_strip = offset_blocks & (raid_bdev->strip_size - 1);
+	io_range->end_offset_in_strip = end_blocks & (raid_bdev->strip_size - 1);
+}
+
+/*
+ * Find the region of a base bdev covered by a range of strips. With the near layout, all
+ * copies of the range stored on the base bdev form a single contiguous region, so copy is
+ * ignored. With the far layout, each copy is stored in a separate section of the base bdev
+ * and the region of the specified copy is returned.
+ */
+static bool
+raid10_split_io_range(struct raid10_io_range *io_range, struct raid_bdev *raid_bdev,
+		      uint8_t disk_idx, uint8_t copy, uint64_t *_offset_in_disk,
+		      uint64_t *_nblocks_in_disk)
+{
+	struct raid10_info *r10info = raid_bdev->module_private;
+	uint8_t num_base_bdevs = raid_bdev->num_base_bdevs;
+	uint64_t pos_per_strip, pos_begin, pos_end, first_pos, last_pos;
+	uint64_t disk_strip_base, residue;
+	uint64_t start_offset_in_disk, end_offset_in_disk;
+
+	if (raid_bdev->layout == RAID_LAYOUT_NEAR) {
+		pos_per_strip = raid_bdev->num_copies;
+		residue = disk_idx;
+		disk_strip_base = 0;
+	} else {
+		pos_per_strip = 1;
+		residue = (disk_idx + num_base_bdevs - copy) % num_base_bdevs;
+		disk_strip_base = copy * r10info->section_strips;
+	}
+
+	pos_begin = io_range->start_strip * pos_per_strip;
+	pos_end = io_range->end_strip * pos_per_strip + pos_per_strip - 1;
+
+	/* The first and last positions in the range stored on this base bdev */
+	first_pos = pos_begin + (residue + num_base_bdevs - pos_begin % num_base_bdevs) % num_base_bdevs;
+	if (first_pos > pos_end) {
+		return false;
+	}
+	last_pos = pos_end - (pos_end % num_base_bdevs + num_base_bdevs - residue) % num_base_bdevs;
+	assert(last_pos >= first_pos);
+
+	start_offset_in_disk = (disk_strip_base + first_pos / num_base_bdevs) * raid_bdev->strip_size;
+	if (first_pos / pos_per_strip == io_range->start_strip) {
+		start_offset_in_disk += io_range->start_offset_in_strip;
+	}
+
+	end_offset_in_disk = (disk_strip_base + last_pos / num_base_bdevs) * raid_bdev->strip_size;
+	if (last_pos / pos_per_strip == io_range->end_strip) {
+		end_offset_in_disk += io_range->end_offset_in_strip;
+	} else {
+		end_offset_in_disk += raid_bdev->strip_size - 1;
+	}
+
+	*_offset_in_disk = start_offset_in_disk;
+	*_nblocks_in_disk = end_offset_in_disk - start_offset_in_disk + 1;
+
+	return true;
+}
+
+static inline uint8_t
+raid10_disk_regions_num(struct raid_bdev *raid_bdev)
+{
+	return raid_bdev->layout == RAID_LAYOUT_NEAR ? 1 : raid_bdev->num_copies;
+}
+
+static uint64_t
+raid10_null_payload_request_regions(struct raid_bdev_io *raid_io)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid10_io_range io_range;
+	uint64_t offset_in_disk, nblocks_in_disk;
+	uint64_t count = 0;
+	uint8_t disk_idx, copy;
+
+	raid10_get_io_range(&io_range, raid_bdev, raid_io->offset_blocks, raid_io->num_blocks);
+
+	for (disk_idx = 0; disk_idx < raid_bdev->num_base_bdevs; disk_idx++) {
+		for (copy = 0; copy < raid10_disk_regions_num(raid_bdev); copy++) {
+			if (raid10_split_io_range(&io_range, raid_bdev, disk_idx, copy,
+						  &offset_in_disk, &nblocks_in_disk)) {
+				count++;
+			}
+		}
+	}
+
+	return count;
+}
+
+static void raid10_submit_null_payload_request(struct raid_bdev_io *raid_io);
+
+static void
+_raid10_submit_null_payload_request(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+
+	raid10_submit_null_payload_request(raid_io);
+}
+
+static void
+raid10_null_payload_request_io_completion(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	raid10_write_bdev_io_completion(bdev_io, success, cb_arg);
+}
+
+/*
+ * Submit UNMAP or FLUSH to every base bdev region covered by the request. Progress is tracked
+ * per base bdev in base_bdev_io_submitted. If a submission fails with -ENOMEM part way
+ * through a base bdev's regions, all of its regions are submitted again on retry, so the
+ * already submitted ones are accounted for in base_bdev_io_remaining once more.
+ */
+static void
+raid10_submit_null_payload_request(struct raid_bdev_io *raid_io)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid10_io_range io_range;
+	struct raid_base_bdev_info *base_info;
+	struct spdk_io_channel *base_ch;
+	uint64_t offset_in_disk, nblocks_in_disk;
+	uint8_t disk_idx, copy, disk_submitted;
+	int ret;
+
+	if (raid_io->base_bdev_io_submitted == 0 && raid_io->base_bdev_io_remaining == 0) {
+		raid_io->base_bdev_io_remaining = raid10_null_payload_request_regions(raid_io);
+		raid_bdev_io_set_default_status(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+	}
+
+	raid10_get_io_range(&io_range, raid_bdev, raid_io->offset_blocks, raid_io->num_blocks);
+
+	for (disk_idx = raid_io->base_bdev_io_submitted; disk_idx < raid_bdev->num_base_bdevs;
+	     disk_idx++) {
+		base_info = &raid_bdev->base_bdev_info[disk_idx];
+		base_ch = raid_bdev_channel_get_base_channel(raid_io->raid_ch, disk_idx);
+		disk_submitted = 0;
+
+		for (copy = 0; copy < raid10_disk_regions_num(raid_bdev); copy++) {
+			if (!raid10_split_io_range(&io_range, raid_bdev, disk_idx, copy,
+						   &offset_in_disk, &nblocks_in_disk)) {
+				continue;
+			}
+
+			if (base_ch == NULL) {
+				/* skip a missing base bdev's region */
+				raid_bdev_io_complete_part(raid_io, 1, SPDK_BDEV_IO_STATUS_FAILED);
+				continue;
+			}
+
+			switch (raid_io->type) {
+			case SPDK_BDEV_IO_TYPE_UNMAP:
+				ret = raid_bdev_unmap_blocks(base_info, base_ch,
+							     offset_in_disk, nblocks_in_disk,
+							     raid10_null_payload_request_io_completion, raid_io);
+				break;
+
+			case SPDK_BDEV_IO_TYPE_FLUSH:
+				ret = raid_bdev_flush_blocks(base_info, base_ch,
+							     offset_in_disk, nblocks_in_disk,
+							     raid10_null_payload_request_io_completion, raid_io);
+				break;
+
+			default:
+				SPDK_ERRLOG("submit request, invalid io type with null payload %u\n", raid_io->type);
+				assert(false);
+				ret = -EIO;
+			}
+
+			if (spdk_unlikely(ret != 0)) {
+				if (spdk_unlikely(ret == -ENOMEM)) {
+					raid_io->base_bdev_io_remaining += disk_submitted;
+					raid_bdev_queue_io_wait(raid_io, spdk_bdev_desc_get_bdev(base_info->desc),
+								base_ch, _raid10_submit_null_payload_request);
+					return;
+				}
+
+				SPDK_ERRLOG("bdev io submit error not due to ENOMEM, it should not happen\n");
+				assert(false);
+				raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+				return;
+			}
+
+			disk_submitted++;
+		}
+
+		raid_io->base_bdev_io_submitted++;
+	}
+}
+
+static void
+raid10_ioch_destroy(void *io_device, void *ctx_buf)
+{
+}
+
+static int
+raid10_ioch_create(void *io_device, void *ctx_buf)
+{
+	return 0;
+}
+
+static void
+raid10_io_device_unregister_done(void *io_device)
+{
+	struct raid10_info *r10info = io_device;
+
+	raid_bdev_module_stop_done(r10info->raid_bdev);
+
+	free(r10info);
+}
+
+static int
+raid10_start(struct raid_bdev *raid_bdev)
+{
+	uint64_t min_blockcnt = UINT64_MAX;
+	uint64_t disk_strips, total_strips;
+	struct raid_base_bdev_info *base_info;
+	struct raid10_info *r10info;
+	char name[256];
+
+	if (raid_bdev->num_copies < 2 || raid_bdev->num_copies > raid_bdev->num_base_bdevs) {
+		SPDK_ERRLOG("Invalid number of copies %u for %u base bdevs\n", raid_bdev->num_copies,
+			    raid_bdev->num_base_bdevs);
+		return -EINVAL;
+	}
+
+	r10info = calloc(1, sizeof(*r10info));
+	if (!r10info) {
+		SPDK_ERRLOG("Failed to allocate RAID10 info device structure\n");
+		return -ENOMEM;
+	}
+	r10info->raid_bdev = raid_bdev;
+
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		min_blockcnt = spdk_min(min_blockcnt, base_info->data_size);
+	}
+
+	disk_strips = min_blockcnt >> raid_bdev->strip_size_shift;
+	if (raid_bdev->layout == RAID_LAYOUT_NEAR) {
+		total_strips = disk_strips * raid_bdev->num_base_bdevs / raid_bdev->num_copies;
+	} else {
+		r10info->section_strips = disk_strips / raid_bdev->num_copies;
+		disk_strips = r10info->section_strips * raid_bdev->num_copies;
+		total_strips = r10info->section_strips * raid_bdev->num_base_bdevs;
+	}
+
+	if (total_strips == 0) {
+		SPDK_ERRLOG("Base bdevs are too small for the raid10 layout\n");
+		free(r10info);
+		return -EINVAL;
+	}
+
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		base_info->data_size = disk_strips << raid_bdev->strip_size_shift;
+	}
+
+	SPDK_DEBUGLOG(bdev_raid10, "min blockcount %" PRIu64 ", num copies %u, layout %s\n",
+		      min_blockcnt, raid_bdev->num_copies, raid_bdev_layout_to_str(raid_bdev->layout));
+
+	raid_bdev->bdev.blockcnt = total_strips << raid_bdev->strip_size_shift;
+	raid_bdev->bdev.optimal_io_boundary = raid_bdev->strip_size;
+	raid_bdev->bdev.split_on_optimal_io_boundary = true;
+	raid_bdev->module_private = r10info;
+
+	snprintf(name, sizeof(name), "raid10_%s", raid_bdev->bdev.name);
+	spdk_io_device_register(r10info, raid10_ioch_create, raid10_ioch_destroy,
+				sizeof(struct raid10_io_channel) +
+				raid_bdev->num_base_bdevs * sizeof(struct raid10_base_bdev_stats),
+				name);
+
+	return 0;
+}
+
+static bool
+raid10_stop(struct raid_bdev *raid_bdev)
+{
+	struct raid10_info *r10info = raid_bdev->module_private;
+
+	spdk_io_device_unregister(r10info, raid10_io_device_unregister_done);
+
+	return false;
+}
+
+static struct spdk_io_channel *
+raid10_get_io_channel(struct raid_bdev *raid_bdev)
+{
+	struct raid10_info *r10info = raid_bdev->module_private;
+
+	return spdk_get_io_channel(r10info);
+}
+
+static void
+raid10_process_write_completed(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_process_request *process_req = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	raid_bdev_process_request_complete(process_req, success ? 0 : -EIO);
+}
+
+static bool
+raid10_strip_target_location(struct raid_bdev *raid_bdev, uint64_t strip,
+			     struct raid_base_bdev_info *target, uint64_t *disk_strip)
+{
+	uint8_t target_idx = raid_bdev_base_bdev_slot(target);
+	uint8_t copy, disk_idx;
+
+	for (copy = 0; copy < raid_bdev->num_copies; copy++) {
+		raid10_strip_copy_location(raid_bdev, strip, copy, &disk_idx, disk_strip);
+		if (disk_idx == target_idx) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void raid10_process_submit_write(struct raid_bdev_process_request *process_req);
+
+static void
+_raid10_process_submit_write(void *ctx)
+{
+	struct raid_bdev_process_request *process_req = ctx;
+
+	raid10_process_submit_write(process_req);
+}
+
+static void
+raid10_process_submit_write(struct raid_bdev_process_request *process_req)
+{
+	struct raid_bdev_io *raid_io = &process_req->raid_io;
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct spdk_bdev_ext_io_opts io_opts;
+	uint64_t strip = raid_io->offset_blocks >> raid_bdev->strip_size_shift;
+	uint64_t disk_strip, pd_lba;
+	int ret;
+
+	if (!raid10_strip_target_location(raid_bdev, strip, process_req->target, &disk_strip)) {
+		assert(false);
+		raid_bdev_process_request_complete(process_req, -EINVAL);
+		return;
+	}
+	pd_lba = (disk_strip << raid_bdev->strip_size_shift) +
+		 (raid_io->offset_blocks & (raid_bdev->strip_size - 1));
+
+	raid10_init_ext_io_opts(&io_opts, raid_io);
+	ret = raid_bdev_writev_blocks_ext(process_req->target, process_req->target_ch,
+					  raid_io->iovs, raid_io->iovcnt,
+					  pd_lba, raid_io->num_blocks,
+					  raid10_process_write_completed, process_req, &io_opts);
+	if (spdk_unlikely(ret != 0)) {
+		if (ret == -ENOMEM) {
+			raid_bdev_queue_io_wait(raid_io, spdk_bdev_desc_get_bdev(process_req->target->desc),
+						process_req->target_ch, _raid10_process_submit_write);
+		} else {
+			raid_bdev_process_request_complete(process_req, ret);
+		}
+	}
+}
+
+static void
+raid10_process_read_completed(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
+{
+	struct raid_bdev_process_request *process_req = SPDK_CONTAINEROF(raid_io,
+			struct raid_bdev_process_request, raid_io);
+
+	if (status != SPDK_BDEV_IO_STATUS_SUCCESS) {
+		raid_bdev_process_request_complete(process_req, -EIO);
+		return;
+	}
+
+	raid10_process_submit_write(process_req);
+}
+
+static void
+raid10_process_request_skip_done(void *ctx)
+{
+	struct raid_bdev_process_request *process_req = ctx;
+
+	raid_bdev_process_request_complete(process_req, 0);
+}
+
+/*
+ * A process request covers the range up to the end of the first strip with a copy on the
+ * target base bdev. Only that strip is copied - the strips before it have no copies on the
+ * target and are skipped.
+ */
+static int
+raid10_submit_process_request(struct raid_bdev_process_request *process_req,
+			      struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid_bdev_io *raid_io = &process_req->raid_io;
+	struct raid_bdev *raid_bdev = process_req->target->raid_bdev;
+	uint64_t offset_end = process_req->offset_blocks + process_req->num_blocks;
+	uint64_t strip = process_req->offset_blocks >> raid_bdev->strip_size_shift;
+	uint64_t strip_offset, disk_strip, offset_blocks, num_blocks;
+	int ret;
+
+	for (strip_offset = strip << raid_bdev->strip_size_shift; strip_offset < offset_end;
+	     strip++, strip_offset += raid_bdev->strip_size) {
+		if (raid10_strip_target_location(raid_bdev, strip, process_req->target, &disk_strip)) {
+			break;
+		}
+	}
+
+	if (strip_offset >= offset_end) {
+		/* no copies on the target in this range */
+		ret = spdk_thread_send_msg(spdk_get_thread(), raid10_process_request_skip_done, process_req);
+		if (spdk_unlikely(ret != 0)) {
+			return ret;
+		}
+		return process_req->num_blocks;
+	}
+
+	offset_blocks = spdk_max(process_req->offset_blocks, strip_offset);
+	num_blocks = spdk_min(offset_end, strip_offset + raid_bdev->strip_size) - offset_blocks;
+
+	process_req->iov.iov_len = num_blocks * raid_bdev->bdev.blocklen;
+	raid_bdev_io_init(raid_io, raid_ch, SPDK_BDEV_IO_TYPE_READ, offset_blocks, num_blocks,
+			  &process_req->iov, 1, process_req->md_buf, NULL, NULL);
+	raid_io->completion_cb = raid10_process_read_completed;
+
+	ret = raid10_submit_read_request(raid_io);
+	if (spdk_likely(ret == 0)) {
+		return offset_blocks + num_blocks - process_req->offset_blocks;
+	} else if (ret < 0) {
+		return ret;
+	} else {
+		return -EINVAL;
+	}
+}
+
+static struct raid_bdev_module g_raid10_module = {
+	.level = RAID10,
+	.base_bdevs_min = 2,
+	/* the actual value depends on the number of copies, see _raid_bdev_create() */
+	.base_bdevs_constraint = {CONSTRAINT_MAX_BASE_BDEVS_REMOVED, 1},
+	.memory_domains_supported = true,
+	.start = raid10_start,
+	.stop = raid10_stop,
+	.submit_rw_request = raid10_submit_rw_request,
+	.submit_null_payload_request = raid10_submit_null_payload_request,
+	.get_io_channel = raid10_get_io_channel,
+	.submit_process_request = raid10_submit_process_request,
+};
+RAID_MODULE_REGISTER(&g_raid10_module)
+
+SPDK_LOG_REGISTER_COMPONENT(bdev_raid10)
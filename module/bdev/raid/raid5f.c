@@ -12,10 +12,18 @@
 #include "spdk/likely.h"
 #include "spdk/log.h"
 #include "spdk/accel.h"
+#include "spdk/bit_array.h"
 
-/* Maximum concurrent full stripe writes per io channel */
+/* Maximum concurrent stripe requests of each type per io channel */
 #define RAID5F_MAX_STRIPES 32
 
+/* Number of hash buckets for stripe locks */
+#define RAID5F_STRIPE_LOCK_BUCKETS 64
+
+/* Bounds of the stripe cache poller period */
+#define RAID5F_CACHE_POLL_PERIOD_MIN_US 10
+#define RAID5F_CACHE_POLL_PERIOD_MAX_US 1000
+
 struct chunk {
 	/* Corresponds to base_bdev index */
 	uint8_t index;
@@ -31,6 +39,28 @@ struct chunk {
 
 	/* Pointer to buffer with I/O metadata */
 	void *md_buf;
+
+	/* Buffer for the chunk's previous contents, used by partial stripe requests */
+	void *buf;
+
+	/* Range of blocks within the strip covered by the raid_io of a partial stripe request */
+	uint64_t data_offset;
+	uint64_t data_blocks;
+
+	/* Part of iovs describing the raid_io data */
+	struct iovec *data_iovs;
+	int data_iovcnt;
+
+	/* Iovec of buf corresponding to the rows affected by a partial stripe request */
+	struct iovec buf_iov;
+
+	/* Base bdev I/O of the current phase of a partial stripe request */
+	struct {
+		uint64_t offset_blocks;
+		uint64_t num_blocks;
+		struct iovec *iovs;
+		int iovcnt;
+	} req;
 };
 
 struct stripe_request;
@@ -40,6 +70,7 @@ struct stripe_request {
 	enum stripe_request_type {
 		STRIPE_REQ_WRITE,
 		STRIPE_REQ_RECONSTRUCT,
+		STRIPE_REQ_PARTIAL,
 	} type;
 
 	struct raid5f_io_channel *r5ch;
@@ -74,9 +105,42 @@ struct stripe_request {
 
 			/* Offset from chunk start */
 			uint64_t chunk_offset;
+
+			/* Completion callback of the raid_io, restored when the chunk reads are done */
+			raid_bdev_io_completion_cb completion_cb;
 		} reconstruct;
+
+		struct {
+			/* Buffer for the new stripe parity */
+			void *parity_buf;
+
+			/* Iovec of parity_buf corresponding to the affected rows */
+			struct iovec parity_iov;
+
+			/* Range of blocks within the strips (rows) affected by the request */
+			uint64_t first_row;
+			uint64_t num_rows;
+
+			/* Chunk of a base bdev missing from a degraded array */
+			struct chunk *missing_chunk;
+
+			/* Progress of the current I/O phase */
+			enum spdk_bdev_io_type io_type;
+			uint8_t submitted;
+			uint8_t remaining;
+			int status;
+			stripe_req_xor_cb phase_cb;
+		} partial;
 	};
 
+	/* Set if the request holds the lock of its stripe */
+	bool stripe_locked;
+
+	/* Requests waiting for this request to release the stripe lock */
+	TAILQ_HEAD(, stripe_request) lock_waiters;
+
+	TAILQ_ENTRY(stripe_request) lock_link;
+
 	/* Array of iovec iterators for each chunk */
 	struct spdk_ioviter *chunk_iov_iters;
 
@@ -87,6 +151,7 @@ struct stripe_request {
 	void **chunk_xor_md_buffers;
 
 	struct {
+		uint8_t n_src;
 		size_t len;
 		size_t remaining;
 		size_t remaining_md;
@@ -100,6 +165,129 @@ struct stripe_request {
 	struct chunk chunks[0];
 };
 
+struct raid5f_cache;
+
+struct raid5f_cache_entry {
+	struct raid5f_cache *cache;
+
+	enum raid5f_cache_entry_state {
+		RAID5F_CACHE_ENTRY_FREE,
+		RAID5F_CACHE_ENTRY_DIRTY,
+		RAID5F_CACHE_ENTRY_FLUSHING,
+	} state;
+
+	/* The cached stripe */
+	uint64_t stripe_index;
+
+	/* Buffer for the stripe data, laid out as in the raid bdev */
+	void *buf;
+
+	/* Blocks of the stripe holding data not written back yet */
+	struct spdk_bit_array *valid;
+	uint64_t num_valid;
+
+	/* Number of requests copying data to or from buf */
+	uint32_t refs;
+
+	/* Allocation sequence number */
+	uint64_t seq;
+
+	/* Time after which the entry is written back */
+	uint64_t flush_tsc;
+
+	/* Requests waiting for the write back to complete */
+	TAILQ_HEAD(, spdk_bdev_io_wait_entry) waiters;
+
+	/* Write back of the valid blocks, one contiguous range at a time */
+	struct {
+		bool submitted;
+		uint64_t offset;
+		uint64_t num_blocks;
+		struct iovec iov;
+		int status;
+		/* Used to submit the writes to the module. Don't reorder. */
+		struct spdk_bdev_io bdev_io;
+		struct raid_bdev_io raid_io;
+	} flush;
+
+	TAILQ_ENTRY(raid5f_cache_entry) hash_link;
+	TAILQ_ENTRY(raid5f_cache_entry) link;
+	TAILQ_ENTRY(raid5f_cache_entry) flush_link;
+};
+
+/*
+ * Write-back cache of partially written stripes, shared by all the io channels. Partial stripe
+ * writes are copied to the cache and completed immediately. A cached stripe is written back when
+ * it becomes full, which turns a read-modify-write into a single full stripe write, or when the
+ * flush delay expires.
+ */
+struct raid5f_cache {
+	struct raid5f_info *r5f_info;
+
+	/* Protects the entries, the counters and the stats */
+	struct spdk_spinlock lock;
+
+	struct raid5f_cache_entry *entries;
+	uint32_t num_entries;
+
+	/* Memory of the entry buffers */
+	void *buf;
+
+	/* Entries in use, hashed by stripe index */
+	TAILQ_HEAD(raid5f_cache_bucket, raid5f_cache_entry) *hash;
+	uint32_t hash_mask;
+
+	TAILQ_HEAD(, raid5f_cache_entry) free_entries;
+
+	/* Entries in use, in the order of allocation */
+	TAILQ_HEAD(, raid5f_cache_entry) used_entries;
+	uint32_t num_used;
+
+	/* Entries to write back */
+	TAILQ_HEAD(, raid5f_cache_entry) flush_queue;
+	uint32_t flushes_outstanding;
+
+	/* Write back errors not reported to a FLUSH request yet */
+	uint32_t flush_errors_pending;
+
+	uint64_t seq;
+	uint64_t flush_delay_tsc;
+
+	/* No new entries are allocated while suspended and no write backs started while paused */
+	uint32_t suspended;
+	uint32_t paused;
+
+	/* Pending suspend callbacks, indexed by drain */
+	struct {
+		void (*cb_fn)(void *cb_ctx);
+		void *cb_ctx;
+	} suspend_cb[2];
+
+	/* FLUSH requests waiting for the write back of the preceding writes */
+	TAILQ_HEAD(, spdk_bdev_io_wait_entry) flush_waiters;
+
+	bool kick_pending;
+
+	/* Thread where the entries are written back */
+	struct spdk_thread *thread;
+	struct spdk_poller *poller;
+
+	/* Raid bdev io channel used for the write backs */
+	struct spdk_io_channel *ch;
+
+	struct {
+		uint64_t writes_cached;
+		uint64_t writes_coalesced;
+		uint64_t writes_bypassed;
+		uint64_t writes_delayed;
+		uint64_t read_hits;
+		uint64_t read_partial_hits;
+		uint64_t full_stripe_flushes;
+		uint64_t partial_stripe_flushes;
+		uint64_t flush_errors;
+	} stats;
+};
+
 struct raid5f_info {
 	/* The parent raid bdev */
 	struct raid_bdev *raid_bdev;
@@ -115,6 +303,18 @@ struct raid5f_info {
 
 	/* block length bit shift for optimized calculation, only valid when no interleaved md */
 	uint32_t blocklen_shift;
+
+	/* Set if writes not covering a full stripe are supported */
+	bool partial_stripe_writes;
+
+	/* Stripes locked by write requests, hashed by stripe index */
+	struct raid5f_stripe_lock_bucket {
+		struct spdk_spinlock lock;
+		TAILQ_HEAD(, stripe_request) locked;
+	} stripe_locks[RAID5F_STRIPE_LOCK_BUCKETS];
+
+	/* Write-back stripe cache, NULL if disabled */
+	struct raid5f_cache *cache;
 };
 
 struct raid5f_io_channel {
@@ -122,6 +322,7 @@ struct raid5f_io_channel {
 	struct {
 		TAILQ_HEAD(, stripe_request) write;
 		TAILQ_HEAD(, stripe_request) reconstruct;
+		TAILQ_HEAD(, stripe_request) partial;
 	} free_stripe_requests;
 
 	/* accel_fw channel */
@@ -175,13 +376,97 @@ raid5f_stripe_parity_chunk_index(const struct raid_bdev *raid_bdev, uint64_t str
 	return raid5f_stripe_data_chunks_num(raid_bdev) - stripe_index % raid_bdev->num_base_bdevs;
 }
 
+/* Maximum number of iovec arrays (sources and destination) of a stripe request xor */
+static inline uint16_t
+raid5f_xor_iovs_max(const struct raid_bdev *raid_bdev)
+{
+	return 2 * raid_bdev->num_base_bdevs;
+}
+
+static inline struct raid5f_stripe_lock_bucket *
+raid5f_stripe_lock_bucket(struct stripe_request *stripe_req)
+{
+	struct raid5f_info *r5f_info = raid5f_ch_to_r5f_info(stripe_req->r5ch);
+
+	return &r5f_info->stripe_locks[stripe_req->stripe_index % RAID5F_STRIPE_LOCK_BUCKETS];
+}
+
+static void raid5f_stripe_request_locked(void *_stripe_req);
+
+/*
+ * Stripe locks serialize requests to the same stripe, which may be submitted on different
+ * threads, so that reads reconstructing data or reading partial stripes never observe a
+ * stripe with its parity only partially updated. Returns true if the lock was acquired.
+ * Otherwise, the request is queued behind the current lock owner and
+ * raid5f_stripe_request_locked() is called on the request's thread when the lock is
+ * handed over to it.
+ */
+static bool
+raid5f_stripe_lock(struct stripe_request *stripe_req)
+{
+	struct raid5f_stripe_lock_bucket *bucket = raid5f_stripe_lock_bucket(stripe_req);
+	struct stripe_request *owner;
+
+	assert(!stripe_req->stripe_locked);
+
+	spdk_spin_lock(&bucket->lock);
+	TAILQ_FOREACH(owner, &bucket->locked, lock_link) {
+		if (owner->stripe_index == stripe_req->stripe_index) {
+			break;
+		}
+	}
+
+	if (owner != NULL) {
+		TAILQ_INSERT_TAIL(&owner->lock_waiters, stripe_req, link);
+	} else {
+		TAILQ_INSERT_TAIL(&bucket->locked, stripe_req, lock_link);
+		stripe_req->stripe_locked = true;
+	}
+	spdk_spin_unlock(&bucket->lock);
+
+	return owner == NULL;
+}
+
+static void
+raid5f_stripe_unlock(struct stripe_request *stripe_req)
+{
+	struct raid5f_stripe_lock_bucket *bucket = raid5f_stripe_lock_bucket(stripe_req);
+	struct stripe_request *next;
+
+	assert(stripe_req->stripe_locked);
+
+	spdk_spin_lock(&bucket->lock);
+	TAILQ_REMOVE(&bucket->locked, stripe_req, lock_link);
+	stripe_req->stripe_locked = false;
+
+	next = TAILQ_FIRST(&stripe_req->lock_waiters);
+	if (next != NULL) {
+		TAILQ_REMOVE(&stripe_req->lock_waiters, next, link);
+		TAILQ_CONCAT(&next->lock_waiters, &stripe_req->lock_waiters, link);
+		TAILQ_INSERT_TAIL(&bucket->locked, next, lock_link);
+		next->stripe_locked = true;
+	}
+	spdk_spin_unlock(&bucket->lock);
+
+	if (next != NULL) {
+		spdk_thread_send_msg(spdk_io_channel_get_thread(spdk_io_channel_from_ctx(next->r5ch)),
+				     raid5f_stripe_request_locked, next);
+	}
+}
+
 static inline void
 raid5f_stripe_request_release(struct stripe_request *stripe_req)
 {
+	if (stripe_req->stripe_locked) {
+		raid5f_stripe_unlock(stripe_req);
+	}
+
 	if (spdk_likely(stripe_req->type == STRIPE_REQ_WRITE)) {
 		TAILQ_INSERT_HEAD(&stripe_req->r5ch->free_stripe_requests.write, stripe_req, link);
 	} else if (stripe_req->type == STRIPE_REQ_RECONSTRUCT) {
 		TAILQ_INSERT_HEAD(&stripe_req->r5ch->free_stripe_requests.reconstruct, stripe_req, link);
+	} else if (stripe_req->type == STRIPE_REQ_PARTIAL) {
+		TAILQ_INSERT_HEAD(&stripe_req->r5ch->free_stripe_requests.partial, stripe_req, link);
 	} else {
 		assert(false);
 	}
@@ -251,9 +536,7 @@ static void
 raid5f_xor_stripe_continue(struct stripe_request *stripe_req)
 {
 	struct raid5f_io_channel *r5ch = stripe_req->r5ch;
-	struct raid_bdev_io *raid_io = stripe_req->raid_io;
-	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
-	uint8_t n_src = raid5f_stripe_data_chunks_num(raid_bdev);
+	uint8_t n_src = stripe_req->xor.n_src;
 	int ret;
 
 	assert(stripe_req->xor.len > 0);
@@ -306,6 +589,7 @@ raid5f_xor_stripe(struct stripe_request *stripe_req, stripe_req_xor_cb cb)
 	r5ch->chunk_xor_iovs[c] = dest_chunk->iovs;
 	r5ch->chunk_xor_iovcnt[c] = dest_chunk->iovcnt;
 
+	stripe_req->xor.n_src = c;
 	stripe_req->xor.len = spdk_ioviter_firstv(stripe_req->chunk_iov_iters,
 			      raid_bdev->num_base_bdevs,
 			      r5ch->chunk_xor_iovs,
@@ -347,6 +631,31 @@ raid5f_xor_stripe(struct stripe_request *stripe_req, stripe_req_xor_cb cb)
 	raid5f_xor_stripe_continue(stripe_req);
 }
 
+/*
+ * Calculate the xor of n_src source iovec arrays into the destination iovec array. The
+ * arrays must be set in the channel's chunk_xor_iovs/chunk_xor_iovcnt, with the
+ * destination at index n_src.
+ */
+static void
+raid5f_xor_iovs(struct stripe_request *stripe_req, uint8_t n_src, size_t len, stripe_req_xor_cb cb)
+{
+	struct raid5f_io_channel *r5ch = stripe_req->r5ch;
+
+	assert(cb != NULL);
+
+	stripe_req->xor.n_src = n_src;
+	stripe_req->xor.len = spdk_ioviter_firstv(stripe_req->chunk_iov_iters, n_src + 1,
+			      r5ch->chunk_xor_iovs,
+			      r5ch->chunk_xor_iovcnt,
+			      stripe_req->chunk_xor_buffers);
+	stripe_req->xor.remaining = len;
+	stripe_req->xor.remaining_md = 0;
+	stripe_req->xor.status = 0;
+	stripe_req->xor.cb = cb;
+
+	raid5f_xor_stripe_continue(stripe_req);
+}
+
 static void
 raid5f_xor_stripe_retry(struct stripe_request *stripe_req)
 {
@@ -375,6 +684,29 @@ raid5f_stripe_request_chunk_read_complete(struct stripe_request *stripe_req,
 	raid_bdev_io_complete_part(raid_io, 1, status);
 }
 
+static void
+raid5f_partial_phase_complete_part(struct stripe_request *stripe_req, uint8_t completed, int status)
+{
+	assert(stripe_req->partial.remaining >= completed);
+	stripe_req->partial.remaining -= completed;
+
+	if (status != 0) {
+		stripe_req->partial.status = status;
+	}
+
+	if (stripe_req->partial.remaining == 0) {
+		stripe_req->partial.phase_cb(stripe_req, stripe_req->partial.status);
+	}
+}
+
+static void
+raid5f_stripe_request_chunk_partial_complete(struct stripe_request *stripe_req,
+		enum spdk_bdev_io_status status)
+{
+	raid5f_partial_phase_complete_part(stripe_req, 1,
+					   status == SPDK_BDEV_IO_STATUS_SUCCESS ? 0 : -EIO);
+}
+
 static void
 raid5f_chunk_complete_bdev_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
 {
@@ -389,6 +721,8 @@ raid5f_chunk_complete_bdev_io(struct spdk_bdev_io *bdev_io, bool success, void *
 		raid5f_stripe_request_chunk_write_complete(stripe_req, status);
 	} else if (stripe_req->type == STRIPE_REQ_RECONSTRUCT) {
 		raid5f_stripe_request_chunk_read_complete(stripe_req, status);
+	} else if (stripe_req->type == STRIPE_REQ_PARTIAL) {
+		raid5f_stripe_request_chunk_partial_complete(stripe_req, status);
 	} else {
 		assert(false);
 	}
@@ -615,6 +949,18 @@ raid5f_stripe_write_request_xor_done(struct stripe_request *stripe_req, int stat
 	}
 }
 
+static void
+raid5f_stripe_write_request_start(struct stripe_request *stripe_req)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+
+	if (raid_bdev_channel_get_base_channel(raid_io->raid_ch, stripe_req->parity_chunk->index) != NULL) {
+		raid5f_xor_stripe(stripe_req, raid5f_stripe_write_request_xor_done);
+	} else {
+		raid5f_stripe_write_request_xor_done(stripe_req, 0);
+	}
+}
+
 static int
 raid5f_submit_write_request(struct raid_bdev_io *raid_io, uint64_t stripe_index)
 {
@@ -640,189 +986,1595 @@ raid5f_submit_write_request(struct raid_bdev_io *raid_io, uint64_t stripe_index)
 	raid_io->module_private = stripe_req;
 	raid_io->base_bdev_io_remaining = raid_bdev->num_base_bdevs;
 
-	if (raid_bdev_channel_get_base_channel(raid_io->raid_ch, stripe_req->parity_chunk->index) != NULL) {
-		raid5f_xor_stripe(stripe_req, raid5f_stripe_write_request_xor_done);
-	} else {
-		raid5f_stripe_write_request_xor_done(stripe_req, 0);
+	if (raid5f_stripe_lock(stripe_req)) {
+		raid5f_stripe_write_request_start(stripe_req);
 	}
 
 	return 0;
 }
 
 static void
-raid5f_chunk_read_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+raid5f_partial_submit_chunks(struct stripe_request *stripe_req);
+
+static void
+raid5f_partial_chunk_submit_retry(void *_raid_io)
 {
-	struct raid_bdev_io *raid_io = cb_arg;
+	struct raid_bdev_io *raid_io = _raid_io;
+	struct stripe_request *stripe_req = raid_io->module_private;
 
-	spdk_bdev_free_io(bdev_io);
+	raid5f_partial_submit_chunks(stripe_req);
+}
 
-	raid_bdev_io_complete(raid_io, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
-			      SPDK_BDEV_IO_STATUS_FAILED);
+static int
+raid5f_partial_chunk_submit(struct chunk *chunk)
+{
+	struct stripe_request *stripe_req = raid5f_chunk_stripe_req(chunk);
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid_base_bdev_info *base_info = &raid_bdev->base_bdev_info[chunk->index];
+	struct spdk_io_channel *base_ch = raid_bdev_channel_get_base_channel(raid_io->raid_ch,
+					  chunk->index);
+	uint64_t base_offset_blocks = (stripe_req->stripe_index << raid_bdev->strip_size_shift) +
+				      chunk->req.offset_blocks;
+	struct spdk_bdev_ext_io_opts io_opts;
+	int ret;
+
+	if (chunk->req.num_blocks == 0 || base_ch == NULL) {
+		stripe_req->partial.submitted++;
+		raid5f_partial_phase_complete_part(stripe_req, 1, 0);
+		return 0;
+	}
+
+	raid5f_init_ext_io_opts(&io_opts, raid_io);
+
+	if (stripe_req->partial.io_type == SPDK_BDEV_IO_TYPE_READ) {
+		ret = raid_bdev_readv_blocks_ext(base_info, base_ch, chunk->req.iovs, chunk->req.iovcnt,
+						 base_offset_blocks, chunk->req.num_blocks,
+						 raid5f_chunk_complete_bdev_io, chunk, &io_opts);
+	} else {
+		ret = raid_bdev_writev_blocks_ext(base_info, base_ch, chunk->req.iovs, chunk->req.iovcnt,
+						  base_offset_blocks, chunk->req.num_blocks,
+						  raid5f_chunk_complete_bdev_io, chunk, &io_opts);
+	}
+
+	if (spdk_unlikely(ret)) {
+		if (ret == -ENOMEM) {
+			raid_bdev_queue_io_wait(raid_io, spdk_bdev_desc_get_bdev(base_info->desc),
+						base_ch, raid5f_partial_chunk_submit_retry);
+		} else {
+			/* Implicitly complete the chunks not yet submitted as failed */
+			raid5f_partial_phase_complete_part(stripe_req,
+							   raid_bdev->num_base_bdevs - stripe_req->partial.submitted, ret);
+		}
+		return ret;
+	}
+
+	stripe_req->partial.submitted++;
+
+	return 0;
 }
 
-static void raid5f_submit_rw_request(struct raid_bdev_io *raid_io);
+static void
+raid5f_partial_submit_chunks(struct stripe_request *stripe_req)
+{
+	struct raid_bdev *raid_bdev = stripe_req->raid_io->raid_bdev;
+	uint8_t i;
+
+	/*
+	 * The phase callback can only be called by the last chunk, so the loop ends before a
+	 * potential next phase modifies the request.
+	 */
+	for (i = stripe_req->partial.submitted; i < raid_bdev->num_base_bdevs; i++) {
+		if (spdk_unlikely(raid5f_partial_chunk_submit(&stripe_req->chunks[i]) != 0)) {
+			break;
+		}
+	}
+}
 
 static void
-_raid5f_submit_rw_request(void *_raid_io)
+raid5f_partial_submit_phase(struct stripe_request *stripe_req, enum spdk_bdev_io_type io_type,
+			    stripe_req_xor_cb cb)
 {
-	struct raid_bdev_io *raid_io = _raid_io;
+	struct raid_bdev *raid_bdev = stripe_req->raid_io->raid_bdev;
 
-	raid5f_submit_rw_request(raid_io);
+	stripe_req->partial.io_type = io_type;
+	stripe_req->partial.submitted = 0;
+	stripe_req->partial.remaining = raid_bdev->num_base_bdevs;
+	stripe_req->partial.status = 0;
+	stripe_req->partial.phase_cb = cb;
+
+	raid5f_partial_submit_chunks(stripe_req);
+}
+
+static inline void
+raid5f_chunk_set_req(struct chunk *chunk, uint64_t offset_blocks, uint64_t num_blocks,
+		     struct iovec *iovs, int iovcnt)
+{
+	chunk->req.offset_blocks = offset_blocks;
+	chunk->req.num_blocks = num_blocks;
+	chunk->req.iovs = iovs;
+	chunk->req.iovcnt = iovcnt;
+}
+
+static inline void
+raid5f_chunk_set_req_buf(struct chunk *chunk)
+{
+	struct stripe_request *stripe_req = raid5f_chunk_stripe_req(chunk);
+
+	raid5f_chunk_set_req(chunk, stripe_req->partial.first_row, stripe_req->partial.num_rows,
+			     &chunk->buf_iov, 1);
+}
+
+static inline void
+raid5f_chunk_set_req_data(struct chunk *chunk)
+{
+	raid5f_chunk_set_req(chunk, chunk->data_offset, chunk->data_blocks, chunk->data_iovs,
+			     chunk->data_iovcnt);
 }
 
 static void
-raid5f_stripe_request_reconstruct_xor_done(struct stripe_request *stripe_req, int status)
+raid5f_partial_request_complete(struct stripe_request *stripe_req, int status)
 {
 	struct raid_bdev_io *raid_io = stripe_req->raid_io;
 
 	raid5f_stripe_request_release(stripe_req);
 
-	raid_bdev_io_complete(raid_io,
-			      status == 0 ? SPDK_BDEV_IO_STATUS_SUCCESS : SPDK_BDEV_IO_STATUS_FAILED);
+	raid_bdev_io_complete(raid_io, status == 0 ? SPDK_BDEV_IO_STATUS_SUCCESS :
+			      SPDK_BDEV_IO_STATUS_FAILED);
 }
 
 static void
-raid5f_reconstruct_reads_completed_cb(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
+raid5f_partial_write_submit(struct stripe_request *stripe_req, int status)
 {
-	struct stripe_request *stripe_req = raid_io->module_private;
-
-	raid_io->completion_cb = NULL;
+	struct chunk *chunk;
 
-	if (status != SPDK_BDEV_IO_STATUS_SUCCESS) {
-		stripe_req->xor.cb(stripe_req, -EIO);
+	if (status != 0) {
+		raid5f_partial_request_complete(stripe_req, status);
 		return;
 	}
 
-	raid5f_xor_stripe(stripe_req, stripe_req->xor.cb);
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		raid5f_chunk_set_req_data(chunk);
+	}
+
+	raid5f_chunk_set_req(stripe_req->parity_chunk, stripe_req->partial.first_row,
+			     stripe_req->partial.num_rows, &stripe_req->partial.parity_iov, 1);
+
+	raid5f_partial_submit_phase(stripe_req, SPDK_BDEV_IO_TYPE_WRITE, raid5f_partial_request_complete);
 }
 
-static int
-raid5f_submit_reconstruct_read(struct raid_bdev_io *raid_io, uint64_t stripe_index,
-			       uint8_t chunk_idx, uint64_t chunk_offset, stripe_req_xor_cb cb)
+static inline size_t
+raid5f_partial_rows_len(struct stripe_request *stripe_req)
 {
-	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
-	struct raid5f_io_channel *r5ch = raid_bdev_channel_get_module_ctx(raid_io->raid_ch);
-	void *raid_io_md = raid_io->md_buf;
-	struct stripe_request *stripe_req;
+	return stripe_req->partial.num_rows * stripe_req->raid_io->raid_bdev->bdev.blocklen;
+}
+
+static inline void
+raid5f_xor_iovs_set(struct raid5f_io_channel *r5ch, uint8_t idx, struct iovec *iovs, int iovcnt)
+{
+	r5ch->chunk_xor_iovs[idx] = iovs;
+	r5ch->chunk_xor_iovcnt[idx] = iovcnt;
+}
+
+/*
+ * Read-modify-write: new parity = old parity ^ old data ^ new data of the written chunks.
+ */
+static void
+raid5f_partial_write_rmw_reads_done(struct stripe_request *stripe_req, int status)
+{
+	struct raid5f_io_channel *r5ch = stripe_req->r5ch;
 	struct chunk *chunk;
-	int buf_idx;
+	uint8_t c = 0;
 
-	assert(cb != NULL);
+	if (status != 0) {
+		raid5f_partial_request_complete(stripe_req, status);
+		return;
+	}
 
-	stripe_req = TAILQ_FIRST(&r5ch->free_stripe_requests.reconstruct);
-	if (!stripe_req) {
-		return -ENOMEM;
+	raid5f_xor_iovs_set(r5ch, c++, &stripe_req->parity_chunk->buf_iov, 1);
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		if (chunk->data_blocks > 0) {
+			raid5f_xor_iovs_set(r5ch, c++, &chunk->buf_iov, 1);
+			raid5f_xor_iovs_set(r5ch, c++, chunk->iovs, chunk->iovcnt);
+		}
 	}
+	raid5f_xor_iovs_set(r5ch, c, &stripe_req->partial.parity_iov, 1);
 
-	raid5f_stripe_request_init(stripe_req, raid_io, stripe_index);
+	raid5f_xor_iovs(stripe_req, c, raid5f_partial_rows_len(stripe_req), raid5f_partial_write_submit);
+}
 
-	stripe_req->reconstruct.chunk = &stripe_req->chunks[chunk_idx];
-	stripe_req->reconstruct.chunk_offset = chunk_offset;
-	stripe_req->xor.cb = cb;
-	buf_idx = 0;
+/*
+ * Reconstruct-write: new parity = xor of the new contents of all data chunks.
+ */
+static void
+raid5f_partial_write_rcw_reads_done(struct stripe_request *stripe_req, int status)
+{
+	struct raid5f_io_channel *r5ch = stripe_req->r5ch;
+	struct chunk *chunk;
+	uint8_t c = 0;
+
+	if (status != 0) {
+		raid5f_partial_request_complete(stripe_req, status);
+		return;
+	}
+
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		if (chunk->data_blocks > 0) {
+			raid5f_xor_iovs_set(r5ch, c++, chunk->iovs, chunk->iovcnt);
+		} else {
+			raid5f_xor_iovs_set(r5ch, c++, &chunk->buf_iov, 1);
+		}
+	}
+	raid5f_xor_iovs_set(r5ch, c, &stripe_req->partial.parity_iov, 1);
+
+	raid5f_xor_iovs(stripe_req, c, raid5f_partial_rows_len(stripe_req), raid5f_partial_write_submit);
+}
+
+/*
+ * Reconstruct the previous contents of the affected rows of the missing chunk into its buffer.
+ */
+static void
+raid5f_partial_reconstruct_missing_chunk(struct stripe_request *stripe_req, stripe_req_xor_cb cb)
+{
+	struct raid5f_io_channel *r5ch = stripe_req->r5ch;
+	struct chunk *missing_chunk = stripe_req->partial.missing_chunk;
+	struct chunk *chunk;
+	uint8_t c = 0;
+
+	FOR_EACH_CHUNK(stripe_req, chunk) {
+		if (chunk != missing_chunk) {
+			raid5f_xor_iovs_set(r5ch, c++, &chunk->buf_iov, 1);
+		}
+	}
+	raid5f_xor_iovs_set(r5ch, c, &missing_chunk->buf_iov, 1);
+
+	raid5f_xor_iovs(stripe_req, c, raid5f_partial_rows_len(stripe_req), cb);
+}
+
+static void
+raid5f_partial_write_reconstruct_reads_done(struct stripe_request *stripe_req, int status)
+{
+	if (status != 0) {
+		raid5f_partial_request_complete(stripe_req, status);
+		return;
+	}
+
+	raid5f_partial_reconstruct_missing_chunk(stripe_req, raid5f_partial_write_rcw_reads_done);
+}
+
+static void
+raid5f_partial_write_start(struct stripe_request *stripe_req)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	struct raid5f_info *r5f_info = raid_io->raid_bdev->module_private;
+	struct chunk *missing_chunk = stripe_req->partial.missing_chunk;
+	uint64_t first_row = stripe_req->partial.first_row;
+	uint64_t end_row = first_row + stripe_req->partial.num_rows;
+	stripe_req_xor_cb reads_done_cb;
+	struct chunk *chunk;
+	uint8_t data_chunks = 0;
+	bool rmw;
+
+	if (missing_chunk == stripe_req->parity_chunk) {
+		/* Parity can't be updated, only the data is written */
+		raid5f_partial_write_submit(stripe_req, 0);
+		return;
+	}
+
+	FOR_EACH_CHUNK(stripe_req, chunk) {
+		chunk->req.num_blocks = 0;
+		if (chunk->data_blocks > 0) {
+			data_chunks++;
+		}
+	}
+
+	if (1 + 2 * data_chunks > UINT8_MAX) {
+		/* Too many xor sources for read-modify-write */
+		rmw = false;
+	} else if (missing_chunk != NULL) {
+		/* Read-modify-write can only be used if the missing chunk is not written */
+		rmw = missing_chunk->data_blocks == 0;
+	} else {
+		/* Read the fewer blocks: old data and parity or the rest of the stripe */
+		rmw = raid_io->num_blocks <= r5f_info->stripe_blocks / 2;
+	}
+
+	if (rmw) {
+		FOR_EACH_CHUNK(stripe_req, chunk) {
+			if (chunk == stripe_req->parity_chunk || chunk->data_blocks > 0) {
+				raid5f_chunk_set_req_buf(chunk);
+			}
+		}
+		reads_done_cb = raid5f_partial_write_rmw_reads_done;
+	} else if (missing_chunk != NULL && missing_chunk->data_blocks < stripe_req->partial.num_rows) {
+		/*
+		 * The missing chunk is partially written, its remaining previous contents
+		 * must be reconstructed from all the other chunks.
+		 */
+		FOR_EACH_CHUNK(stripe_req, chunk) {
+			raid5f_chunk_set_req_buf(chunk);
+		}
+		reads_done_cb = raid5f_partial_write_reconstruct_reads_done;
+	} else {
+		/*
+		 * Read the affected rows of the chunks which are not written and the parts of
+		 * the written chunks not covered by the raid_io. Due to the contiguity of the
+		 * raid_io, there is at most one such part per chunk.
+		 */
+		FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+			if (chunk->data_blocks == 0) {
+				raid5f_chunk_set_req_buf(chunk);
+			} else if (chunk->data_offset > first_row) {
+				assert(chunk->data_offset + chunk->data_blocks == end_row);
+				raid5f_chunk_set_req(chunk, first_row, chunk->data_offset - first_row,
+						     &chunk->iovs[0], 1);
+			} else if (chunk->data_offset + chunk->data_blocks < end_row) {
+				raid5f_chunk_set_req(chunk, chunk->data_offset + chunk->data_blocks,
+						     end_row - chunk->data_offset - chunk->data_blocks,
+						     &chunk->iovs[chunk->iovcnt - 1], 1);
+			}
+		}
+		reads_done_cb = raid5f_partial_write_rcw_reads_done;
+	}
+
+	raid5f_partial_submit_phase(stripe_req, SPDK_BDEV_IO_TYPE_READ, reads_done_cb);
+}
+
+static void
+raid5f_partial_read_reconstruct_done(struct stripe_request *stripe_req, int status)
+{
+	uint32_t blocklen = stripe_req->raid_io->raid_bdev->bdev.blocklen;
+	struct chunk *chunk;
+	struct iovec iov;
+
+	if (status == 0) {
+		FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+			if (chunk->data_blocks > 0) {
+				iov.iov_base = chunk->buf + chunk->data_offset * blocklen;
+				iov.iov_len = chunk->data_blocks * blocklen;
+				spdk_iovcpy(&iov, 1, chunk->data_iovs, chunk->data_iovcnt);
+			}
+		}
+	}
+
+	raid5f_partial_request_complete(stripe_req, status);
+}
+
+static void
+raid5f_partial_read_reconstruct_reads_done(struct stripe_request *stripe_req, int status)
+{
+	if (status != 0) {
+		raid5f_partial_request_complete(stripe_req, status);
+		return;
+	}
+
+	raid5f_partial_reconstruct_missing_chunk(stripe_req, raid5f_partial_read_reconstruct_done);
+}
+
+static void
+raid5f_partial_read_start(struct stripe_request *stripe_req)
+{
+	struct chunk *missing_chunk = stripe_req->partial.missing_chunk;
+	struct chunk *chunk;
+
+	if (missing_chunk != NULL && missing_chunk->data_blocks > 0) {
+		FOR_EACH_CHUNK(stripe_req, chunk) {
+			if (chunk != missing_chunk) {
+				raid5f_chunk_set_req_buf(chunk);
+			} else {
+				chunk->req.num_blocks = 0;
+			}
+		}
+		raid5f_partial_submit_phase(stripe_req, SPDK_BDEV_IO_TYPE_READ,
+					    raid5f_partial_read_reconstruct_reads_done);
+	} else {
+		FOR_EACH_CHUNK(stripe_req, chunk) {
+			raid5f_chunk_set_req_data(chunk);
+		}
+		raid5f_partial_submit_phase(stripe_req, SPDK_BDEV_IO_TYPE_READ,
+					    raid5f_partial_request_complete);
+	}
+}
+
+static void
+raid5f_partial_start(struct stripe_request *stripe_req)
+{
+	if (stripe_req->raid_io->type == SPDK_BDEV_IO_TYPE_WRITE) {
+		raid5f_partial_write_start(stripe_req);
+	} else {
+		raid5f_partial_read_start(stripe_req);
+	}
+}
+
+/*
+ * Map the data range of the chunk to the raid_io iovecs. For writes, the regions of the
+ * chunk's buffer holding the previous contents of the remaining affected rows are placed
+ * around them, so that the iovecs describe the new contents of all the affected rows.
+ */
+static int
+raid5f_partial_chunk_map_iovecs(struct chunk *chunk, size_t raid_io_offset, bool with_buf)
+{
+	struct stripe_request *stripe_req = raid5f_chunk_stripe_req(chunk);
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	uint32_t blocklen = raid_io->raid_bdev->bdev.blocklen;
+	uint64_t data_end = chunk->data_offset + chunk->data_blocks;
+	size_t pre_len = 0, post_len = 0;
+	size_t remaining, iov_offset;
+	struct iovec *iov;
+	int iovcnt = 0;
+	int iov_idx, i;
+	int ret;
+
+	if (with_buf) {
+		pre_len = (chunk->data_offset - stripe_req->partial.first_row) * blocklen;
+		post_len = (stripe_req->partial.first_row + stripe_req->partial.num_rows - data_end) *
+			   blocklen;
+	}
+
+	iov_offset = raid_io_offset;
+	for (iov_idx = 0; iov_offset >= raid_io->iovs[iov_idx].iov_len; iov_idx++) {
+		iov_offset -= raid_io->iovs[iov_idx].iov_len;
+		assert(iov_idx + 1 < raid_io->iovcnt);
+	}
+
+	remaining = chunk->data_blocks * blocklen + iov_offset;
+	for (i = iov_idx; remaining > 0; i++) {
+		assert(i < raid_io->iovcnt);
+		remaining -= spdk_min(remaining, raid_io->iovs[i].iov_len);
+		iovcnt++;
+	}
+
+	ret = raid5f_chunk_set_iovcnt(chunk, iovcnt + (pre_len > 0) + (post_len > 0));
+	if (ret) {
+		return ret;
+	}
+
+	iov = chunk->iovs;
+	if (pre_len > 0) {
+		iov->iov_base = chunk->buf + stripe_req->partial.first_row * blocklen;
+		iov->iov_len = pre_len;
+		iov++;
+	}
+
+	chunk->data_iovs = iov;
+	chunk->data_iovcnt = iovcnt;
+
+	remaining = chunk->data_blocks * blocklen;
+	for (i = iov_idx; remaining > 0; i++) {
+		iov->iov_base = raid_io->iovs[i].iov_base + iov_offset;
+		iov->iov_len = spdk_min(remaining, raid_io->iovs[i].iov_len - iov_offset);
+		remaining -= iov->iov_len;
+		iov_offset = 0;
+		iov++;
+	}
+
+	if (post_len > 0) {
+		iov->iov_base = chunk->buf + data_end * blocklen;
+		iov->iov_len = post_len;
+	}
+
+	return 0;
+}
+
+/*
+ * Handle a request not covering a full stripe - a write or a read spanning multiple chunks.
+ * The stripe is locked for both. Writes update the parity using read-modify-write or
+ * reconstruct-write, depending on which requires reading fewer blocks.
+ */
+static int
+raid5f_submit_partial_request(struct raid_bdev_io *raid_io, uint64_t stripe_index,
+			      uint64_t stripe_offset)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid5f_io_channel *r5ch = raid_bdev_channel_get_module_ctx(raid_io->raid_ch);
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	uint64_t stripe_end = stripe_offset + raid_io->num_blocks;
+	bool write = raid_io->type == SPDK_BDEV_IO_TYPE_WRITE;
+	struct stripe_request *stripe_req;
+	struct chunk *chunk;
+	uint64_t chunk_start = 0;
+	int ret;
+
+	stripe_req = TAILQ_FIRST(&r5ch->free_stripe_requests.partial);
+	if (!stripe_req) {
+		return -ENOMEM;
+	}
+
+	raid5f_stripe_request_init(stripe_req, raid_io, stripe_index);
+
+	stripe_req->partial.missing_chunk = NULL;
+	FOR_EACH_CHUNK(stripe_req, chunk) {
+		chunk->data_offset = 0;
+		chunk->data_blocks = 0;
+		chunk->data_iovcnt = 0;
+		chunk->req.num_blocks = 0;
+		if (raid_bdev_channel_get_base_channel(raid_io->raid_ch, chunk->index) == NULL) {
+			stripe_req->partial.missing_chunk = chunk;
+		}
+	}
+
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		uint64_t chunk_end = chunk_start + raid_bdev->strip_size;
+
+		if (stripe_offset < chunk_end && stripe_end > chunk_start) {
+			chunk->data_offset = spdk_max(stripe_offset, chunk_start) - chunk_start;
+			chunk->data_blocks = spdk_min(stripe_end, chunk_end) - chunk_start -
+					     chunk->data_offset;
+		}
+		chunk_start = chunk_end;
+	}
+
+	if (stripe_end - stripe_offset <= raid_bdev->strip_size &&
+	    (stripe_offset >> raid_bdev->strip_size_shift) ==
+	    ((stripe_end - 1) >> raid_bdev->strip_size_shift)) {
+		stripe_req->partial.first_row = stripe_offset & (raid_bdev->strip_size - 1);
+		stripe_req->partial.num_rows = raid_io->num_blocks;
+	} else {
+		stripe_req->partial.first_row = 0;
+		stripe_req->partial.num_rows = raid_bdev->strip_size;
+	}
+
+	chunk_start = 0;
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		if (chunk->data_blocks > 0) {
+			size_t raid_io_offset = (chunk_start + chunk->data_offset - stripe_offset) * blocklen;
+
+			ret = raid5f_partial_chunk_map_iovecs(chunk, raid_io_offset, write);
+			if (spdk_unlikely(ret)) {
+				return ret;
+			}
+		}
+		chunk_start += raid_bdev->strip_size;
+	}
+
+	FOR_EACH_CHUNK(stripe_req, chunk) {
+		chunk->buf_iov.iov_base = chunk->buf + stripe_req->partial.first_row * blocklen;
+		chunk->buf_iov.iov_len = stripe_req->partial.num_rows * blocklen;
+	}
+
+	stripe_req->partial.parity_iov.iov_base = stripe_req->partial.parity_buf +
+			stripe_req->partial.first_row * blocklen;
+	stripe_req->partial.parity_iov.iov_len = stripe_req->partial.num_rows * blocklen;
+
+	TAILQ_REMOVE(&r5ch->free_stripe_requests.partial, stripe_req, link);
+
+	raid_io->module_private = stripe_req;
+
+	if (raid5f_stripe_lock(stripe_req)) {
+		raid5f_partial_start(stripe_req);
+	}
+
+	return 0;
+}
+
+static void
+raid5f_stripe_request_locked(void *_stripe_req)
+{
+	struct stripe_request *stripe_req = _stripe_req;
+
+	if (stripe_req->type == STRIPE_REQ_WRITE) {
+		raid5f_stripe_write_request_start(stripe_req);
+	} else if (stripe_req->type == STRIPE_REQ_RECONSTRUCT) {
+		raid5f_stripe_request_submit_chunks(stripe_req);
+	} else {
+		raid5f_partial_start(stripe_req);
+	}
+}
+
+static void
+raid5f_chunk_read_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	raid_bdev_io_complete(raid_io, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+			      SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void raid5f_submit_stripe_rw_request(struct raid_bdev_io *raid_io);
+
+static void
+_raid5f_submit_stripe_rw_request(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+
+	raid5f_submit_stripe_rw_request(raid_io);
+}
+
+static void
+raid5f_stripe_request_reconstruct_xor_done(struct stripe_request *stripe_req, int status)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+
+	raid5f_stripe_request_release(stripe_req);
+
+	raid_bdev_io_complete(raid_io,
+			      status == 0 ? SPDK_BDEV_IO_STATUS_SUCCESS : SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void
+raid5f_reconstruct_reads_completed_cb(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
+{
+	struct stripe_request *stripe_req = raid_io->module_private;
+
+	raid_io->completion_cb = stripe_req->reconstruct.completion_cb;
+
+	if (status != SPDK_BDEV_IO_STATUS_SUCCESS) {
+		stripe_req->xor.cb(stripe_req, -EIO);
+		return;
+	}
+
+	raid5f_xor_stripe(stripe_req, stripe_req->xor.cb);
+}
+
+static int
+raid5f_submit_reconstruct_read(struct raid_bdev_io *raid_io, uint64_t stripe_index,
+			       uint8_t chunk_idx, uint64_t chunk_offset, stripe_req_xor_cb cb)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid5f_io_channel *r5ch = raid_bdev_channel_get_module_ctx(raid_io->raid_ch);
+	void *raid_io_md = raid_io->md_buf;
+	struct stripe_request *stripe_req;
+	struct chunk *chunk;
+	int buf_idx;
+
+	assert(cb != NULL);
+
+	stripe_req = TAILQ_FIRST(&r5ch->free_stripe_requests.reconstruct);
+	if (!stripe_req) {
+		return -ENOMEM;
+	}
+
+	raid5f_stripe_request_init(stripe_req, raid_io, stripe_index);
+
+	stripe_req->reconstruct.chunk = &stripe_req->chunks[chunk_idx];
+	stripe_req->reconstruct.chunk_offset = chunk_offset;
+	stripe_req->xor.cb = cb;
+	buf_idx = 0;
+
+	FOR_EACH_CHUNK(stripe_req, chunk) {
+		if (chunk == stripe_req->reconstruct.chunk) {
+			int i;
+			int ret;
+
+			ret = raid5f_chunk_set_iovcnt(chunk, raid_io->iovcnt);
+			if (ret) {
+				return ret;
+			}
+
+			for (i = 0; i < raid_io->iovcnt; i++) {
+				chunk->iovs[i] = raid_io->iovs[i];
+			}
+
+			chunk->md_buf = raid_io_md;
+		} else {
+			struct iovec *iov = &chunk->iovs[0];
+
+			iov->iov_base = stripe_req->reconstruct.chunk_buffers[buf_idx];
+			iov->iov_len = raid_io->num_blocks * raid_bdev->bdev.blocklen;
+			chunk->iovcnt = 1;
+
+			if (raid_io_md) {
+				chunk->md_buf = stripe_req->reconstruct.chunk_md_buffers[buf_idx];
+			}
+
+			buf_idx++;
+		}
+	}
+
+	raid_io->module_private = stripe_req;
+	raid_io->base_bdev_io_remaining = raid_bdev->num_base_bdevs;
+	stripe_req->reconstruct.completion_cb = raid_io->completion_cb;
+	raid_io->completion_cb = raid5f_reconstruct_reads_completed_cb;
+
+	TAILQ_REMOVE(&r5ch->free_stripe_requests.reconstruct, stripe_req, link);
+
+	if (raid5f_stripe_lock(stripe_req)) {
+		raid5f_stripe_request_submit_chunks(stripe_req);
+	}
+
+	return 0;
+}
+
+static int
+raid5f_submit_read_request(struct raid_bdev_io *raid_io, uint64_t stripe_index,
+			   uint64_t stripe_offset)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	uint8_t chunk_data_idx = stripe_offset >> raid_bdev->strip_size_shift;
+	uint8_t p_idx = raid5f_stripe_parity_chunk_index(raid_bdev, stripe_index);
+	uint8_t chunk_idx = chunk_data_idx < p_idx ? chunk_data_idx : chunk_data_idx + 1;
+	struct raid_base_bdev_info *base_info = &raid_bdev->base_bdev_info[chunk_idx];
+	struct spdk_io_channel *base_ch = raid_bdev_channel_get_base_channel(raid_io->raid_ch, chunk_idx);
+	uint64_t chunk_offset = stripe_offset - (chunk_data_idx << raid_bdev->strip_size_shift);
+	uint64_t base_offset_blocks = (stripe_index << raid_bdev->strip_size_shift) + chunk_offset;
+	struct spdk_bdev_ext_io_opts io_opts;
+	int ret;
+
+	raid5f_init_ext_io_opts(&io_opts, raid_io);
+	if (base_ch == NULL) {
+		return raid5f_submit_reconstruct_read(raid_io, stripe_index, chunk_idx, chunk_offset,
+						      raid5f_stripe_request_reconstruct_xor_done);
+	}
+
+	ret = raid_bdev_readv_blocks_ext(base_info, base_ch, raid_io->iovs, raid_io->iovcnt,
+					 base_offset_blocks, raid_io->num_blocks,
+					 raid5f_chunk_read_complete, raid_io, &io_opts);
+	if (spdk_unlikely(ret == -ENOMEM)) {
+		raid_bdev_queue_io_wait(raid_io, spdk_bdev_desc_get_bdev(base_info->desc),
+					base_ch, _raid5f_submit_stripe_rw_request);
+		return 0;
+	}
+
+	return ret;
+}
+
+static void
+raid5f_submit_stripe_rw_request(struct raid_bdev_io *raid_io)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid5f_info *r5f_info = raid_bdev->module_private;
+	uint64_t stripe_index = raid_io->offset_blocks / r5f_info->stripe_blocks;
+	uint64_t stripe_offset = raid_io->offset_blocks % r5f_info->stripe_blocks;
+	int ret;
+
+	switch (raid_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		if ((stripe_offset >> raid_bdev->strip_size_shift) ==
+		    ((stripe_offset + raid_io->num_blocks - 1) >> raid_bdev->strip_size_shift)) {
+			ret = raid5f_submit_read_request(raid_io, stripe_index, stripe_offset);
+		} else {
+			assert(r5f_info->partial_stripe_writes);
+			ret = raid5f_submit_partial_request(raid_io, stripe_index, stripe_offset);
+		}
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		if (stripe_offset == 0 && raid_io->num_blocks == r5f_info->stripe_blocks) {
+			ret = raid5f_submit_write_request(raid_io, stripe_index);
+		} else {
+			assert(r5f_info->partial_stripe_writes);
+			ret = raid5f_submit_partial_request(raid_io, stripe_index, stripe_offset);
+		}
+		break;
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	if (spdk_unlikely(ret)) {
+		raid_bdev_io_complete(raid_io, ret == -ENOMEM ? SPDK_BDEV_IO_STATUS_NOMEM :
+				      SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static inline struct raid5f_cache_bucket *
+raid5f_cache_bucket(struct raid5f_cache *cache, uint64_t stripe_index)
+{
+	return &cache->hash[stripe_index & cache->hash_mask];
+}
+
+static struct raid5f_cache_entry *
+raid5f_cache_lookup(struct raid5f_cache *cache, uint64_t stripe_index)
+{
+	struct raid5f_cache_entry *entry;
+
+	TAILQ_FOREACH(entry, raid5f_cache_bucket(cache, stripe_index), hash_link) {
+		if (entry->stripe_index == stripe_index) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+static struct raid5f_cache_entry *
+raid5f_cache_entry_alloc(struct raid5f_cache *cache, uint64_t stripe_index)
+{
+	struct raid5f_cache_entry *entry;
+
+	entry = TAILQ_FIRST(&cache->free_entries);
+	if (entry == NULL) {
+		return NULL;
+	}
+	TAILQ_REMOVE(&cache->free_entries, entry, link);
+
+	assert(entry->state == RAID5F_CACHE_ENTRY_FREE);
+	assert(entry->refs == 0);
+	assert(TAILQ_EMPTY(&entry->waiters));
+
+	entry->state = RAID5F_CACHE_ENTRY_DIRTY;
+	entry->stripe_index = stripe_index;
+	entry->seq = ++cache->seq;
+	entry->flush_tsc = spdk_get_ticks() + cache->flush_delay_tsc;
+	spdk_bit_array_clear_mask(entry->valid);
+	entry->num_valid = 0;
+
+	TAILQ_INSERT_TAIL(raid5f_cache_bucket(cache, stripe_index), entry, hash_link);
+	TAILQ_INSERT_TAIL(&cache->used_entries, entry, link);
+	cache->num_used++;
+
+	return entry;
+}
+
+/* Queue the entry for write back. Must be called with the cache lock held. */
+static void
+raid5f_cache_entry_queue_flush(struct raid5f_cache_entry *entry)
+{
+	if (entry->state == RAID5F_CACHE_ENTRY_DIRTY) {
+		entry->state = RAID5F_CACHE_ENTRY_FLUSHING;
+		TAILQ_INSERT_TAIL(&entry->cache->flush_queue, entry, flush_link);
+	}
+}
+
+/*
+ * Drop a reference to the entry. Returns true if the entry's write back can be started now.
+ * Must be called with the cache lock held.
+ */
+static bool
+raid5f_cache_entry_put(struct raid5f_cache_entry *entry)
+{
+	assert(entry->refs > 0);
+	entry->refs--;
+
+	return entry->refs == 0 && entry->state == RAID5F_CACHE_ENTRY_FLUSHING;
+}
+
+static void raid5f_cache_flush_entries(struct raid5f_cache *cache);
+
+static void
+_raid5f_cache_flush_entries(void *ctx)
+{
+	struct raid5f_cache *cache = ctx;
+
+	raid5f_cache_flush_entries(cache);
+}
+
+/* Start writing back the queued entries on the cache thread */
+static void
+raid5f_cache_kick(struct raid5f_cache *cache)
+{
+	bool kick;
+
+	spdk_spin_lock(&cache->lock);
+	kick = !cache->kick_pending;
+	cache->kick_pending = true;
+	spdk_spin_unlock(&cache->lock);
+
+	if (kick) {
+		spdk_thread_send_msg(cache->thread, _raid5f_cache_flush_entries, cache);
+	}
+}
+
+static void raid5f_submit_rw_request(struct raid_bdev_io *raid_io);
+
+static void
+raid5f_cache_resubmit_io(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+
+	raid5f_submit_rw_request(raid_io);
+}
+
+static void
+raid5f_cache_wake_waiters(struct raid5f_cache *cache, void *_waiters)
+{
+	TAILQ_HEAD(, spdk_bdev_io_wait_entry) *waiters = _waiters;
+	struct spdk_bdev_io_wait_entry *waiter;
+	struct raid_bdev_io *raid_io;
+
+	while ((waiter = TAILQ_FIRST(waiters)) != NULL) {
+		TAILQ_REMOVE(waiters, waiter, link);
+		raid_io = waiter->cb_arg;
+		spdk_thread_send_msg(spdk_io_channel_get_thread(spdk_io_channel_from_ctx(raid_io->raid_ch)),
+				     waiter->cb_fn, waiter->cb_arg);
+	}
+}
+
+static void
+raid5f_cache_suspend_check(struct raid5f_cache *cache)
+{
+	void (*cb_fn)(void *cb_ctx);
+	void *cb_ctx;
+	int drain;
+
+	assert(spdk_get_thread() == cache->thread);
+
+	for (drain = 0; drain < 2; drain++) {
+		cb_fn = cache->suspend_cb[drain].cb_fn;
+		cb_ctx = cache->suspend_cb[drain].cb_ctx;
+
+		spdk_spin_lock(&cache->lock);
+		if (cb_fn == NULL || cache->flushes_outstanding > 0 || (drain && cache->num_used > 0)) {
+			cb_fn = NULL;
+		}
+		spdk_spin_unlock(&cache->lock);
+
+		if (cb_fn == NULL) {
+			continue;
+		}
+
+		cache->suspend_cb[drain].cb_fn = NULL;
+		cache->suspend_cb[drain].cb_ctx = NULL;
+
+		/* Nothing is left to write back, release the channel until resumed */
+		if (drain && cache->ch != NULL) {
+			spdk_put_io_channel(cache->ch);
+			cache->ch = NULL;
+		}
+
+		spdk_thread_send_msg(cache->thread, cb_fn, cb_ctx);
+	}
+}
+
+static void
+raid5f_cache_entry_flush_done(struct raid5f_cache_entry *entry)
+{
+	struct raid5f_cache *cache = entry->cache;
+	struct raid_bdev *raid_bdev = cache->r5f_info->raid_bdev;
+	TAILQ_HEAD(, spdk_bdev_io_wait_entry) waiters = TAILQ_HEAD_INITIALIZER(waiters);
+	TAILQ_HEAD(, spdk_bdev_io_wait_entry) flush_waiters = TAILQ_HEAD_INITIALIZER(flush_waiters);
+	struct spdk_bdev_io_wait_entry *waiter, *tmp;
+	struct raid5f_cache_entry *oldest;
+	struct raid_bdev_io *raid_io;
+
+	if (entry->flush.status != 0) {
+		SPDK_ERRLOG("Failed to write back stripe %" PRIu64 " of raid bdev %s: %s\n",
+			    entry->stripe_index, raid_bdev->bdev.name, spdk_strerror(-entry->flush.status));
+	}
+
+	spdk_spin_lock(&cache->lock);
+	if (entry->flush.status != 0) {
+		cache->stats.flush_errors++;
+		cache->flush_errors_pending++;
+	}
+
+	assert(entry->refs == 0);
+	TAILQ_REMOVE(raid5f_cache_bucket(cache, entry->stripe_index), entry, hash_link);
+	TAILQ_REMOVE(&cache->used_entries, entry, link);
+	cache->num_used--;
+	entry->state = RAID5F_CACHE_ENTRY_FREE;
+	entry->flush.submitted = false;
+	TAILQ_CONCAT(&waiters, &entry->waiters, link);
+	TAILQ_INSERT_HEAD(&cache->free_entries, entry, link);
+
+	assert(cache->flushes_outstanding > 0);
+	cache->flushes_outstanding--;
+
+	/* Wake the FLUSH requests waiting only for entries allocated before them */
+	oldest = TAILQ_FIRST(&cache->used_entries);
+	TAILQ_FOREACH_SAFE(waiter, &cache->flush_waiters, link, tmp) {
+		raid_io = waiter->cb_arg;
+		if (oldest == NULL || oldest->seq > (uintptr_t)raid_io->module_private) {
+			TAILQ_REMOVE(&cache->flush_waiters, waiter, link);
+			TAILQ_INSERT_TAIL(&flush_waiters, waiter, link);
+		}
+	}
+	spdk_spin_unlock(&cache->lock);
+
+	raid5f_cache_wake_waiters(cache, &waiters);
+	raid5f_cache_wake_waiters(cache, &flush_waiters);
+
+	raid5f_cache_suspend_check(cache);
+	raid5f_cache_flush_entries(cache);
+}
+
+static void raid5f_cache_flush_write_complete(struct raid_bdev_io *raid_io,
+		enum spdk_bdev_io_status status);
+
+/* Write back the next contiguous range of valid blocks of the entry */
+static void
+raid5f_cache_entry_flush_continue(struct raid5f_cache_entry *entry)
+{
+	struct raid5f_cache *cache = entry->cache;
+	struct raid5f_info *r5f_info = cache->r5f_info;
+	uint32_t blocklen = r5f_info->raid_bdev->bdev.blocklen;
+	struct raid_bdev_io *raid_io = &entry->flush.raid_io;
+	uint32_t start, end;
+
+	if (entry->flush.status != 0) {
+		raid5f_cache_entry_flush_done(entry);
+		return;
+	}
+
+	start = spdk_bit_array_find_first_set(entry->valid, entry->flush.offset);
+	if (start == UINT32_MAX) {
+		raid5f_cache_entry_flush_done(entry);
+		return;
+	}
+
+	end = spdk_bit_array_find_first_clear(entry->valid, start);
+	if (end == UINT32_MAX) {
+		end = r5f_info->stripe_blocks;
+	}
+
+	entry->flush.offset = start;
+	entry->flush.num_blocks = end - start;
+	entry->flush.iov.iov_base = entry->buf + (size_t)start * blocklen;
+	entry->flush.iov.iov_len = (size_t)(end - start) * blocklen;
+
+	raid_bdev_io_init(raid_io, spdk_io_channel_get_ctx(cache->ch), SPDK_BDEV_IO_TYPE_WRITE,
+			  entry->stripe_index * r5f_info->stripe_blocks + start, end - start,
+			  &entry->flush.iov, 1, NULL, NULL, NULL);
+	raid_io->completion_cb = raid5f_cache_flush_write_complete;
+
+	raid5f_submit_stripe_rw_request(raid_io);
+}
+
+static void
+_raid5f_cache_entry_flush_continue(void *_entry)
+{
+	struct raid5f_cache_entry *entry = _entry;
+
+	raid5f_cache_entry_flush_continue(entry);
+}
+
+static void
+raid5f_cache_flush_write_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
+{
+	struct raid5f_cache_entry *entry = SPDK_CONTAINEROF(raid_io, struct raid5f_cache_entry,
+					   flush.raid_io);
+
+	if (status == SPDK_BDEV_IO_STATUS_NOMEM) {
+		spdk_thread_send_msg(spdk_get_thread(), _raid5f_cache_entry_flush_continue, entry);
+		return;
+	}
+
+	if (status == SPDK_BDEV_IO_STATUS_SUCCESS) {
+		entry->flush.offset += entry->flush.num_blocks;
+	} else {
+		entry->flush.status = -EIO;
+	}
+
+	raid5f_cache_entry_flush_continue(entry);
+}
+
+static void
+raid5f_cache_entry_flush_start(struct raid5f_cache_entry *entry)
+{
+	struct raid5f_cache *cache = entry->cache;
+
+	entry->flush.offset = 0;
+	entry->flush.status = cache->ch != NULL ? 0 : -ENODEV;
+
+	raid5f_cache_entry_flush_continue(entry);
+}
+
+static void
+raid5f_cache_flush_entries(struct raid5f_cache *cache)
+{
+	struct raid_bdev *raid_bdev = cache->r5f_info->raid_bdev;
+	TAILQ_HEAD(, raid5f_cache_entry) entries = TAILQ_HEAD_INITIALIZER(entries);
+	struct raid5f_cache_entry *entry, *tmp;
+
+	bool paused;
+	uint32_t num_used;
+
+	assert(spdk_get_thread() == cache->thread);
+
+	spdk_spin_lock(&cache->lock);
+	cache->kick_pending = false;
+	paused = cache->paused > 0;
+	num_used = cache->num_used;
+	spdk_spin_unlock(&cache->lock);
+
+	if (paused) {
+		return;
+	}
+
+	/*
+	 * Get the channel as soon as there is something cached. If it can't be obtained, the raid
+	 * bdev is going away and the cached data is lost.
+	 */
+	if (cache->ch == NULL && num_used > 0 && raid_bdev->state == RAID_BDEV_STATE_ONLINE) {
+		cache->ch = spdk_get_io_channel(raid_bdev);
+	}
+
+	spdk_spin_lock(&cache->lock);
+	TAILQ_FOREACH_SAFE(entry, &cache->flush_queue, flush_link, tmp) {
+		if (cache->flushes_outstanding == RAID5F_MAX_STRIPES) {
+			break;
+		}
+
+		if (entry->refs > 0) {
+			continue;
+		}
+
+		TAILQ_REMOVE(&cache->flush_queue, entry, flush_link);
+		TAILQ_INSERT_TAIL(&entries, entry, flush_link);
+		entry->flush.submitted = true;
+		cache->flushes_outstanding++;
+
+		if (entry->num_valid == cache->r5f_info->stripe_blocks) {
+			cache->stats.full_stripe_flushes++;
+		} else {
+			cache->stats.partial_stripe_flushes++;
+		}
+	}
+	spdk_spin_unlock(&cache->lock);
+
+	TAILQ_FOREACH_SAFE(entry, &entries, flush_link, tmp) {
+		TAILQ_REMOVE(&entries, entry, flush_link);
+		raid5f_cache_entry_flush_start(entry);
+	}
+}
+
+static int
+raid5f_cache_poll(void *ctx)
+{
+	struct raid5f_cache *cache = ctx;
+	struct raid5f_cache_entry *entry;
+	uint64_t now = spdk_get_ticks();
+	bool flush;
+
+	spdk_spin_lock(&cache->lock);
+	TAILQ_FOREACH(entry, &cache->used_entries, link) {
+		if (entry->flush_tsc > now) {
+			break;
+		}
+		raid5f_cache_entry_queue_flush(entry);
+	}
+	flush = !TAILQ_EMPTY(&cache->flush_queue) || (cache->ch == NULL && cache->num_used > 0);
+	spdk_spin_unlock(&cache->lock);
+
+	if (!flush) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	raid5f_cache_flush_entries(cache);
+
+	return SPDK_POLLER_BUSY;
+}
+
+/*
+ * Copy a partial stripe write to the cache. Returns false if the write must be submitted to the
+ * base bdevs instead.
+ */
+static bool
+raid5f_cache_submit_write(struct raid5f_cache *cache, struct raid_bdev_io *raid_io,
+			  uint64_t stripe_index, uint64_t stripe_offset)
+{
+	struct raid5f_info *r5f_info = cache->r5f_info;
+	uint32_t blocklen = r5f_info->raid_bdev->bdev.blocklen;
+	struct raid5f_cache_entry *entry, *oldest;
+	bool kick = false;
+	uint64_t i;
+
+	spdk_spin_lock(&cache->lock);
+	entry = raid5f_cache_lookup(cache, stripe_index);
+	if (entry == NULL) {
+		/* Full stripe writes don't need the cache unless they overlap with cached data */
+		if (raid_io->num_blocks == r5f_info->stripe_blocks || cache->suspended > 0) {
+			spdk_spin_unlock(&cache->lock);
+			return false;
+		}
+
+		entry = raid5f_cache_entry_alloc(cache, stripe_index);
+		if (entry == NULL) {
+			/* Make room for the following writes */
+			TAILQ_FOREACH(oldest, &cache->used_entries, link) {
+				if (oldest->state == RAID5F_CACHE_ENTRY_DIRTY) {
+					raid5f_cache_entry_queue_flush(oldest);
+					kick = oldest->refs == 0;
+					break;
+				}
+			}
+			cache->stats.writes_bypassed++;
+			spdk_spin_unlock(&cache->lock);
+
+			if (kick) {
+				raid5f_cache_kick(cache);
+			}
+			return false;
+		}
+
+		cache->stats.writes_cached++;
+		kick = cache->ch == NULL;
+	} else if (entry->flush.submitted) {
+		/* The buffer is being written back, retry when it's done */
+		raid_io->waitq_entry.cb_fn = raid5f_cache_resubmit_io;
+		raid_io->waitq_entry.cb_arg = raid_io;
+		TAILQ_INSERT_TAIL(&entry->waiters, &raid_io->waitq_entry, link);
+		cache->stats.writes_delayed++;
+		spdk_spin_unlock(&cache->lock);
+		return true;
+	} else {
+		cache->stats.writes_coalesced++;
+	}
+	entry->refs++;
+	spdk_spin_unlock(&cache->lock);
+
+	spdk_copy_iovs_to_buf(entry->buf + stripe_offset * blocklen, raid_io->num_blocks * blocklen,
+			      raid_io->iovs, raid_io->iovcnt);
+
+	spdk_spin_lock(&cache->lock);
+	for (i = stripe_offset; i < stripe_offset + raid_io->num_blocks; i++) {
+		if (!spdk_bit_array_get(entry->valid, i)) {
+			spdk_bit_array_set(entry->valid, i);
+			entry->num_valid++;
+		}
+	}
+	if (entry->num_valid == r5f_info->stripe_blocks) {
+		raid5f_cache_entry_queue_flush(entry);
+	}
+	kick |= raid5f_cache_entry_put(entry);
+	spdk_spin_unlock(&cache->lock);
+
+	raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	if (kick) {
+		raid5f_cache_kick(cache);
+	}
+
+	return true;
+}
+
+/* Copy len bytes from buf to the iovecs, starting at offset bytes into the iovecs */
+static void
+raid5f_copy_buf_to_iovs_offset(struct iovec *iovs, int iovcnt, size_t offset, void *buf,
+			       size_t len)
+{
+	size_t n;
+	int i;
+
+	for (i = 0; i < iovcnt && len > 0; i++) {
+		if (offset >= iovs[i].iov_len) {
+			offset -= iovs[i].iov_len;
+			continue;
+		}
 
-	FOR_EACH_CHUNK(stripe_req, chunk) {
-		if (chunk == stripe_req->reconstruct.chunk) {
-			int i;
-			int ret;
+		n = spdk_min(len, iovs[i].iov_len - offset);
+		memcpy(iovs[i].iov_base + offset, buf, n);
+		buf += n;
+		len -= n;
+		offset = 0;
+	}
+}
 
-			ret = raid5f_chunk_set_iovcnt(chunk, raid_io->iovcnt);
-			if (ret) {
-				return ret;
-			}
+/* Overlay the cached blocks on the data read from the base bdevs */
+static void
+raid5f_cache_read_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
+{
+	struct raid5f_info *r5f_info = raid_io->raid_bdev->module_private;
+	struct raid5f_cache *cache = r5f_info->cache;
+	uint32_t blocklen = raid_io->raid_bdev->bdev.blocklen;
+	uint64_t stripe_index = raid_io->offset_blocks / r5f_info->stripe_blocks;
+	uint64_t io_start = raid_io->offset_blocks % r5f_info->stripe_blocks;
+	uint64_t io_end = io_start + raid_io->num_blocks;
+	struct raid5f_cache_entry *entry;
+	uint32_t start, end;
+	bool kick;
 
-			for (i = 0; i < raid_io->iovcnt; i++) {
-				chunk->iovs[i] = raid_io->iovs[i];
-			}
+	raid_io->completion_cb = NULL;
 
-			chunk->md_buf = raid_io_md;
-		} else {
-			struct iovec *iov = &chunk->iovs[0];
+	spdk_spin_lock(&cache->lock);
+	entry = raid5f_cache_lookup(cache, stripe_index);
+	spdk_spin_unlock(&cache->lock);
 
-			iov->iov_base = stripe_req->reconstruct.chunk_buffers[buf_idx];
-			iov->iov_len = raid_io->num_blocks * raid_bdev->bdev.blocklen;
-			chunk->iovcnt = 1;
+	/* The reference taken at submission keeps the entry from being written back and freed */
+	assert(entry != NULL && entry->refs > 0);
 
-			if (raid_io_md) {
-				chunk->md_buf = stripe_req->reconstruct.chunk_md_buffers[buf_idx];
-			}
+	start = io_start;
+	while (status == SPDK_BDEV_IO_STATUS_SUCCESS) {
+		spdk_spin_lock(&cache->lock);
+		start = spdk_bit_array_find_first_set(entry->valid, start);
+		end = start < io_end ? spdk_bit_array_find_first_clear(entry->valid, start) : 0;
+		spdk_spin_unlock(&cache->lock);
 
-			buf_idx++;
+		if (start >= io_end) {
+			break;
 		}
-	}
+		end = spdk_min(end, io_end);
 
-	raid_io->module_private = stripe_req;
-	raid_io->base_bdev_io_remaining = raid_bdev->num_base_bdevs;
-	raid_io->completion_cb = raid5f_reconstruct_reads_completed_cb;
+		raid5f_copy_buf_to_iovs_offset(raid_io->iovs, raid_io->iovcnt,
+					       (start - io_start) * blocklen,
+					       entry->buf + (size_t)start * blocklen,
+					       (size_t)(end - start) * blocklen);
+		start = end;
+	}
 
-	TAILQ_REMOVE(&r5ch->free_stripe_requests.reconstruct, stripe_req, link);
+	spdk_spin_lock(&cache->lock);
+	kick = raid5f_cache_entry_put(entry);
+	spdk_spin_unlock(&cache->lock);
 
-	raid5f_stripe_request_submit_chunks(stripe_req);
+	raid_bdev_io_complete(raid_io, status);
 
-	return 0;
+	if (kick) {
+		raid5f_cache_kick(cache);
+	}
 }
 
-static int
-raid5f_submit_read_request(struct raid_bdev_io *raid_io, uint64_t stripe_index,
-			   uint64_t stripe_offset)
+/*
+ * Serve a read from the cache. Returns false if the read must be submitted to the base bdevs.
+ * If only a part of the range is cached, the cached blocks are copied over the data read from
+ * the base bdevs on completion.
+ */
+static bool
+raid5f_cache_submit_read(struct raid5f_cache *cache, struct raid_bdev_io *raid_io,
+			 uint64_t stripe_index, uint64_t stripe_offset)
 {
-	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
-	uint8_t chunk_data_idx = stripe_offset >> raid_bdev->strip_size_shift;
-	uint8_t p_idx = raid5f_stripe_parity_chunk_index(raid_bdev, stripe_index);
-	uint8_t chunk_idx = chunk_data_idx < p_idx ? chunk_data_idx : chunk_data_idx + 1;
-	struct raid_base_bdev_info *base_info = &raid_bdev->base_bdev_info[chunk_idx];
-	struct spdk_io_channel *base_ch = raid_bdev_channel_get_base_channel(raid_io->raid_ch, chunk_idx);
-	uint64_t chunk_offset = stripe_offset - (chunk_data_idx << raid_bdev->strip_size_shift);
-	uint64_t base_offset_blocks = (stripe_index << raid_bdev->strip_size_shift) + chunk_offset;
-	struct spdk_bdev_ext_io_opts io_opts;
-	int ret;
+	uint32_t blocklen = cache->r5f_info->raid_bdev->bdev.blocklen;
+	uint64_t stripe_end = stripe_offset + raid_io->num_blocks;
+	struct raid5f_cache_entry *entry;
+	bool full_hit, kick;
+
+	spdk_spin_lock(&cache->lock);
+	entry = raid5f_cache_lookup(cache, stripe_index);
+	if (entry == NULL || spdk_bit_array_find_first_set(entry->valid, stripe_offset) >= stripe_end) {
+		spdk_spin_unlock(&cache->lock);
+		return false;
+	}
 
-	raid5f_init_ext_io_opts(&io_opts, raid_io);
-	if (base_ch == NULL) {
-		return raid5f_submit_reconstruct_read(raid_io, stripe_index, chunk_idx, chunk_offset,
-						      raid5f_stripe_request_reconstruct_xor_done);
+	if (entry->flush.submitted) {
+		raid_io->waitq_entry.cb_fn = raid5f_cache_resubmit_io;
+		raid_io->waitq_entry.cb_arg = raid_io;
+		TAILQ_INSERT_TAIL(&entry->waiters, &raid_io->waitq_entry, link);
+		spdk_spin_unlock(&cache->lock);
+		return true;
 	}
 
-	ret = raid_bdev_readv_blocks_ext(base_info, base_ch, raid_io->iovs, raid_io->iovcnt,
-					 base_offset_blocks, raid_io->num_blocks,
-					 raid5f_chunk_read_complete, raid_io, &io_opts);
-	if (spdk_unlikely(ret == -ENOMEM)) {
-		raid_bdev_queue_io_wait(raid_io, spdk_bdev_desc_get_bdev(base_info->desc),
-					base_ch, _raid5f_submit_rw_request);
-		return 0;
+	full_hit = spdk_bit_array_find_first_clear(entry->valid, stripe_offset) >= stripe_end;
+	if (full_hit) {
+		cache->stats.read_hits++;
+	} else {
+		cache->stats.read_partial_hits++;
 	}
+	entry->refs++;
+	spdk_spin_unlock(&cache->lock);
 
-	return ret;
+	if (!full_hit) {
+		raid_io->completion_cb = raid5f_cache_read_complete;
+		return false;
+	}
+
+	spdk_copy_buf_to_iovs(raid_io->iovs, raid_io->iovcnt, entry->buf + stripe_offset * blocklen,
+			      raid_io->num_blocks * blocklen);
+
+	spdk_spin_lock(&cache->lock);
+	kick = raid5f_cache_entry_put(entry);
+	spdk_spin_unlock(&cache->lock);
+
+	raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	if (kick) {
+		raid5f_cache_kick(cache);
+	}
+
+	return true;
 }
 
 static void
 raid5f_submit_rw_request(struct raid_bdev_io *raid_io)
 {
-	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
-	struct raid5f_info *r5f_info = raid_bdev->module_private;
+	struct raid5f_info *r5f_info = raid_io->raid_bdev->module_private;
+	struct raid5f_cache *cache = r5f_info->cache;
 	uint64_t stripe_index = raid_io->offset_blocks / r5f_info->stripe_blocks;
 	uint64_t stripe_offset = raid_io->offset_blocks % r5f_info->stripe_blocks;
+	bool done = false;
+
+	if (cache != NULL) {
+		if (raid_io->type == SPDK_BDEV_IO_TYPE_WRITE) {
+			done = raid5f_cache_submit_write(cache, raid_io, stripe_index, stripe_offset);
+		} else if (raid_io->type == SPDK_BDEV_IO_TYPE_READ) {
+			done = raid5f_cache_submit_read(cache, raid_io, stripe_index, stripe_offset);
+		}
+	}
+
+	if (!done) {
+		raid5f_submit_stripe_rw_request(raid_io);
+	}
+}
+
+static void
+raid5f_flush_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	raid_bdev_io_complete_part(raid_io, 1, success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+				   SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void raid5f_submit_flush_request(struct raid_bdev_io *raid_io);
+
+static void
+_raid5f_submit_flush_request(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+
+	raid5f_submit_flush_request(raid_io);
+}
+
+/* Forward the FLUSH to the base bdevs after the cached data has been written back */
+static void
+raid5f_submit_flush_request(struct raid_bdev_io *raid_io)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid5f_info *r5f_info = raid_bdev->module_private;
+	struct raid5f_cache *cache = r5f_info->cache;
+	uint64_t start_stripe = raid_io->offset_blocks / r5f_info->stripe_blocks;
+	uint64_t end_stripe = spdk_divide_round_up(raid_io->offset_blocks + raid_io->num_blocks,
+				  r5f_info->stripe_blocks);
+	struct raid_base_bdev_info *base_info;
+	struct spdk_io_channel *base_ch;
+	uint32_t errors;
 	int ret;
 
-	switch (raid_io->type) {
-	case SPDK_BDEV_IO_TYPE_READ:
-		assert(raid_io->num_blocks <= raid_bdev->strip_size);
-		ret = raid5f_submit_read_request(raid_io, stripe_index, stripe_offset);
-		break;
-	case SPDK_BDEV_IO_TYPE_WRITE:
-		assert(stripe_offset == 0);
-		assert(raid_io->num_blocks == r5f_info->stripe_blocks);
-		ret = raid5f_submit_write_request(raid_io, stripe_index);
-		break;
-	default:
-		ret = -EINVAL;
-		break;
+	if (raid_io->base_bdev_io_remaining == 0) {
+		spdk_spin_lock(&cache->lock);
+		errors = cache->flush_errors_pending;
+		cache->flush_errors_pending = 0;
+		spdk_spin_unlock(&cache->lock);
+
+		if (errors > 0 || end_stripe == start_stripe) {
+			raid_bdev_io_complete(raid_io, errors > 0 ? SPDK_BDEV_IO_STATUS_FAILED :
+					      SPDK_BDEV_IO_STATUS_SUCCESS);
+			return;
+		}
+
+		raid_io->base_bdev_io_remaining = raid_bdev->num_base_bdevs;
 	}
 
-	if (spdk_unlikely(ret)) {
-		raid_bdev_io_complete(raid_io, ret == -ENOMEM ? SPDK_BDEV_IO_STATUS_NOMEM :
-				      SPDK_BDEV_IO_STATUS_FAILED);
+	for (; raid_io->base_bdev_io_submitted < raid_bdev->num_base_bdevs;
+	     raid_io->base_bdev_io_submitted++) {
+		uint8_t idx = raid_io->base_bdev_io_submitted;
+
+		base_info = &raid_bdev->base_bdev_info[idx];
+		base_ch = raid_bdev_channel_get_base_channel(raid_io->raid_ch, idx);
+
+		if (base_ch == NULL ||
+		    !spdk_bdev_io_type_supported(spdk_bdev_desc_get_bdev(base_info->desc),
+						 SPDK_BDEV_IO_TYPE_FLUSH)) {
+			if (raid_bdev_io_complete_part(raid_io, 1, SPDK_BDEV_IO_STATUS_SUCCESS)) {
+				return;
+			}
+			continue;
+		}
+
+		ret = raid_bdev_flush_blocks(base_info, base_ch,
+					     start_stripe << raid_bdev->strip_size_shift,
+					     (end_stripe - start_stripe) << raid_bdev->strip_size_shift,
+					     raid5f_flush_complete, raid_io);
+		if (spdk_unlikely(ret == -ENOMEM)) {
+			raid_bdev_queue_io_wait(raid_io, spdk_bdev_desc_get_bdev(base_info->desc),
+						base_ch, _raid5f_submit_flush_request);
+			return;
+		} else if (spdk_unlikely(ret != 0)) {
+			SPDK_ERRLOG("bdev io submit error not due to ENOMEM, it should not happen\n");
+			assert(false);
+			raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+			return;
+		}
+	}
+}
+
+/*
+ * FLUSH is supported only with the stripe cache. It completes when all the data written before
+ * it has been written back to the base bdevs and flushed by them.
+ */
+static void
+raid5f_submit_null_payload_request(struct raid_bdev_io *raid_io)
+{
+	struct raid5f_info *r5f_info = raid_io->raid_bdev->module_private;
+	struct raid5f_cache *cache = r5f_info->cache;
+	struct raid5f_cache_entry *entry;
+	bool wait;
+
+	assert(raid_io->type == SPDK_BDEV_IO_TYPE_FLUSH);
+	assert(cache != NULL);
+
+	spdk_spin_lock(&cache->lock);
+	TAILQ_FOREACH(entry, &cache->used_entries, link) {
+		raid5f_cache_entry_queue_flush(entry);
+	}
+
+	wait = !TAILQ_EMPTY(&cache->used_entries);
+	if (wait) {
+		raid_io->module_private = (void *)(uintptr_t)cache->seq;
+		raid_io->waitq_entry.cb_fn = _raid5f_submit_flush_request;
+		raid_io->waitq_entry.cb_arg = raid_io;
+		TAILQ_INSERT_TAIL(&cache->flush_waiters, &raid_io->waitq_entry, link);
+	}
+	spdk_spin_unlock(&cache->lock);
+
+	if (wait) {
+		raid5f_cache_kick(cache);
+	} else {
+		raid5f_submit_flush_request(raid_io);
+	}
+}
+
+static bool
+raid5f_io_type_supported(struct raid_bdev *raid_bdev, enum spdk_bdev_io_type io_type)
+{
+	struct raid5f_info *r5f_info = raid_bdev->module_private;
+
+	return io_type == SPDK_BDEV_IO_TYPE_FLUSH && r5f_info->cache != NULL;
+}
+
+static void
+raid5f_suspend(struct raid_bdev *raid_bdev, bool drain, void (*cb_fn)(void *cb_ctx), void *cb_ctx)
+{
+	struct raid5f_info *r5f_info = raid_bdev->module_private;
+	struct raid5f_cache *cache = r5f_info->cache;
+	struct raid5f_cache_entry *entry;
+
+	if (cache == NULL) {
+		cb_fn(cb_ctx);
+		return;
+	}
+
+	assert(spdk_get_thread() == cache->thread);
+	assert(cache->suspend_cb[drain].cb_fn == NULL);
+
+	cache->suspend_cb[drain].cb_fn = cb_fn;
+	cache->suspend_cb[drain].cb_ctx = cb_ctx;
+
+	spdk_spin_lock(&cache->lock);
+	cache->suspended++;
+	if (drain) {
+		TAILQ_FOREACH(entry, &cache->used_entries, link) {
+			raid5f_cache_entry_queue_flush(entry);
+		}
+	} else {
+		cache->paused++;
+	}
+	spdk_spin_unlock(&cache->lock);
+
+	raid5f_cache_flush_entries(cache);
+	raid5f_cache_suspend_check(cache);
+}
+
+static void
+raid5f_resume(struct raid_bdev *raid_bdev, bool drain)
+{
+	struct raid5f_info *r5f_info = raid_bdev->module_private;
+	struct raid5f_cache *cache = r5f_info->cache;
+
+	if (cache == NULL) {
+		return;
+	}
+
+	assert(spdk_get_thread() == cache->thread);
+
+	spdk_spin_lock(&cache->lock);
+	assert(cache->suspended > 0);
+	cache->suspended--;
+	if (!drain) {
+		assert(cache->paused > 0);
+		cache->paused--;
+	}
+	spdk_spin_unlock(&cache->lock);
+
+	raid5f_cache_flush_entries(cache);
+}
+
+static void
+raid5f_dump_info_json(struct raid_bdev *raid_bdev, struct spdk_json_write_ctx *w)
+{
+	struct raid5f_info *r5f_info = raid_bdev->module_private;
+	struct raid5f_cache *cache = r5f_info->cache;
+
+	if (cache == NULL) {
+		return;
 	}
+
+	spdk_spin_lock(&cache->lock);
+	spdk_json_write_named_object_begin(w, "stripe_cache");
+	spdk_json_write_named_uint32(w, "capacity_stripes", cache->num_entries);
+	spdk_json_write_named_uint32(w, "cached_stripes", cache->num_used);
+	spdk_json_write_named_uint64(w, "writes_cached", cache->stats.writes_cached);
+	spdk_json_write_named_uint64(w, "writes_coalesced", cache->stats.writes_coalesced);
+	spdk_json_write_named_uint64(w, "writes_bypassed", cache->stats.writes_bypassed);
+	spdk_json_write_named_uint64(w, "writes_delayed", cache->stats.writes_delayed);
+	spdk_json_write_named_uint64(w, "read_hits", cache->stats.read_hits);
+	spdk_json_write_named_uint64(w, "read_partial_hits", cache->stats.read_partial_hits);
+	spdk_json_write_named_uint64(w, "full_stripe_flushes", cache->stats.full_stripe_flushes);
+	spdk_json_write_named_uint64(w, "partial_stripe_flushes", cache->stats.partial_stripe_flushes);
+	spdk_json_write_named_uint64(w, "flush_errors", cache->stats.flush_errors);
+	spdk_json_write_object_end(w);
+	spdk_spin_unlock(&cache->lock);
 }
 
 static void
@@ -855,6 +2607,11 @@ raid5f_stripe_request_free(struct stripe_request *stripe_req)
 			}
 			free(stripe_req->reconstruct.chunk_md_buffers);
 		}
+	} else if (stripe_req->type == STRIPE_REQ_PARTIAL) {
+		FOR_EACH_CHUNK(stripe_req, chunk) {
+			spdk_dma_free(chunk->buf);
+		}
+		spdk_dma_free(stripe_req->partial.parity_buf);
 	} else {
 		assert(false);
 	}
@@ -875,6 +2632,7 @@ raid5f_stripe_request_alloc(struct raid5f_io_channel *r5ch, enum stripe_request_
 	struct stripe_request *stripe_req;
 	struct chunk *chunk;
 	size_t chunk_len;
+	uint16_t xor_iovs_num;
 
 	stripe_req = calloc(1, sizeof(*stripe_req) + sizeof(*chunk) * raid_bdev->num_base_bdevs);
 	if (!stripe_req) {
@@ -883,6 +2641,7 @@ raid5f_stripe_request_alloc(struct raid5f_io_channel *r5ch, enum stripe_request_
 
 	stripe_req->r5ch = r5ch;
 	stripe_req->type = type;
+	TAILQ_INIT(&stripe_req->lock_waiters);
 
 	FOR_EACH_CHUNK(stripe_req, chunk) {
 		chunk->index = chunk - stripe_req->chunks;
@@ -940,18 +2699,33 @@ raid5f_stripe_request_alloc(struct raid5f_io_channel *r5ch, enum stripe_request_
 				stripe_req->reconstruct.chunk_md_buffers[i] = buf;
 			}
 		}
+	} else if (type == STRIPE_REQ_PARTIAL) {
+		FOR_EACH_CHUNK(stripe_req, chunk) {
+			chunk->buf = spdk_dma_malloc(chunk_len, r5f_info->buf_alignment, NULL);
+			if (!chunk->buf) {
+				goto err;
+			}
+		}
+
+		stripe_req->partial.parity_buf = spdk_dma_malloc(chunk_len, r5f_info->buf_alignment, NULL);
+		if (!stripe_req->partial.parity_buf) {
+			goto err;
+		}
 	} else {
 		assert(false);
 		return NULL;
 	}
 
-	stripe_req->chunk_iov_iters = malloc(SPDK_IOVITER_SIZE(raid_bdev->num_base_bdevs));
+	/* Read-modify-write xors both the old and the new data of each written chunk */
+	xor_iovs_num = type == STRIPE_REQ_PARTIAL ? raid5f_xor_iovs_max(raid_bdev) :
+		       raid_bdev->num_base_bdevs;
+
+	stripe_req->chunk_iov_iters = malloc(SPDK_IOVITER_SIZE(xor_iovs_num));
 	if (!stripe_req->chunk_iov_iters) {
 		goto err;
 	}
 
-	stripe_req->chunk_xor_buffers = calloc(raid_bdev->num_base_bdevs,
-					       sizeof(stripe_req->chunk_xor_buffers[0]));
+	stripe_req->chunk_xor_buffers = calloc(xor_iovs_num, sizeof(stripe_req->chunk_xor_buffers[0]));
 	if (!stripe_req->chunk_xor_buffers) {
 		goto err;
 	}
@@ -986,6 +2760,11 @@ raid5f_ioch_destroy(void *io_device, void *ctx_buf)
 		raid5f_stripe_request_free(stripe_req);
 	}
 
+	while ((stripe_req = TAILQ_FIRST(&r5ch->free_stripe_requests.partial))) {
+		TAILQ_REMOVE(&r5ch->free_stripe_requests.partial, stripe_req, link);
+		raid5f_stripe_request_free(stripe_req);
+	}
+
 	if (r5ch->accel_ch) {
 		spdk_put_io_channel(r5ch->accel_ch);
 	}
@@ -1005,6 +2784,7 @@ raid5f_ioch_create(void *io_device, void *ctx_buf)
 
 	TAILQ_INIT(&r5ch->free_stripe_requests.write);
 	TAILQ_INIT(&r5ch->free_stripe_requests.reconstruct);
+	TAILQ_INIT(&r5ch->free_stripe_requests.partial);
 	TAILQ_INIT(&r5ch->xor_retry_queue);
 
 	for (i = 0; i < RAID5F_MAX_STRIPES; i++) {
@@ -1025,18 +2805,27 @@ raid5f_ioch_create(void *io_device, void *ctx_buf)
 		TAILQ_INSERT_HEAD(&r5ch->free_stripe_requests.reconstruct, stripe_req, link);
 	}
 
+	for (i = 0; r5f_info->partial_stripe_writes && i < RAID5F_MAX_STRIPES; i++) {
+		stripe_req = raid5f_stripe_request_alloc(r5ch, STRIPE_REQ_PARTIAL);
+		if (!stripe_req) {
+			goto err;
+		}
+
+		TAILQ_INSERT_HEAD(&r5ch->free_stripe_requests.partial, stripe_req, link);
+	}
+
 	r5ch->accel_ch = spdk_accel_get_io_channel();
 	if (!r5ch->accel_ch) {
 		SPDK_ERRLOG("Failed to get accel framework's IO channel\n");
 		goto err;
 	}
 
-	r5ch->chunk_xor_iovs = calloc(raid_bdev->num_base_bdevs, sizeof(*r5ch->chunk_xor_iovs));
+	r5ch->chunk_xor_iovs = calloc(raid5f_xor_iovs_max(raid_bdev), sizeof(*r5ch->chunk_xor_iovs));
 	if (!r5ch->chunk_xor_iovs) {
 		goto err;
 	}
 
-	r5ch->chunk_xor_iovcnt = calloc(raid_bdev->num_base_bdevs, sizeof(*r5ch->chunk_xor_iovcnt));
+	r5ch->chunk_xor_iovcnt = calloc(raid5f_xor_iovs_max(raid_bdev), sizeof(*r5ch->chunk_xor_iovcnt));
 	if (!r5ch->chunk_xor_iovcnt) {
 		goto err;
 	}
@@ -1048,6 +2837,100 @@ err:
 	return -ENOMEM;
 }
 
+static void
+raid5f_cache_free(struct raid5f_cache *cache)
+{
+	uint32_t i;
+
+	if (cache->entries != NULL) {
+		for (i = 0; i < cache->num_entries; i++) {
+			spdk_bit_array_free(&cache->entries[i].valid);
+		}
+		free(cache->entries);
+	}
+
+	free(cache->hash);
+	spdk_dma_free(cache->buf);
+	spdk_spin_destroy(&cache->lock);
+	free(cache);
+}
+
+static int
+raid5f_cache_create(struct raid5f_info *r5f_info, const struct spdk_raid_bdev_opts *opts)
+{
+	struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
+	size_t stripe_size = r5f_info->stripe_blocks * raid_bdev->bdev.blocklen;
+	uint64_t num_entries = (uint64_t)opts->stripe_cache_size_kb * 1024 / stripe_size;
+	uint64_t period_us;
+	struct raid5f_cache *cache;
+	struct raid5f_cache_entry *entry;
+	uint32_t i;
+
+	if (num_entries == 0) {
+		SPDK_ERRLOG("Stripe cache size %" PRIu32 " KiB is less than the stripe size of "
+			    "raid bdev %s (%zu KiB)\n", opts->stripe_cache_size_kb, raid_bdev->bdev.name,
+			    stripe_size / 1024);
+		return -EINVAL;
+	}
+
+	cache = calloc(1, sizeof(*cache));
+	if (!cache) {
+		return -ENOMEM;
+	}
+
+	cache->r5f_info = r5f_info;
+	spdk_spin_init(&cache->lock);
+	TAILQ_INIT(&cache->free_entries);
+	TAILQ_INIT(&cache->used_entries);
+	TAILQ_INIT(&cache->flush_queue);
+	TAILQ_INIT(&cache->flush_waiters);
+
+	/* Keep the entry count reasonable for absurdly large settings */
+	cache->num_entries = spdk_min(num_entries, UINT16_MAX);
+	cache->hash_mask = spdk_align32pow2(cache->num_entries) - 1;
+
+	cache->hash = calloc(cache->hash_mask + 1, sizeof(*cache->hash));
+	cache->entries = calloc(cache->num_entries, sizeof(*cache->entries));
+	cache->buf = spdk_dma_malloc(cache->num_entries * stripe_size, r5f_info->buf_alignment, NULL);
+	if (!cache->hash || !cache->entries || !cache->buf) {
+		goto err;
+	}
+
+	for (i = 0; i <= cache->hash_mask; i++) {
+		TAILQ_INIT(&cache->hash[i]);
+	}
+
+	for (i = 0; i < cache->num_entries; i++) {
+		entry = &cache->entries[i];
+		entry->cache = cache;
+		entry->buf = cache->buf + i * stripe_size;
+		entry->valid = spdk_bit_array_create(r5f_info->stripe_blocks);
+		if (!entry->valid) {
+			goto err;
+		}
+		TAILQ_INIT(&entry->waiters);
+		TAILQ_INSERT_TAIL(&cache->free_entries, entry, link);
+	}
+
+	cache->flush_delay_tsc = opts->stripe_cache_flush_delay_us * spdk_get_ticks_hz() /
+				 SPDK_SEC_TO_USEC;
+	cache->thread = spdk_get_thread();
+
+	period_us = spdk_max(RAID5F_CACHE_POLL_PERIOD_MIN_US,
+			     spdk_min(opts->stripe_cache_flush_delay_us / 2, RAID5F_CACHE_POLL_PERIOD_MAX_US));
+	cache->poller = SPDK_POLLER_REGISTER(raid5f_cache_poll, cache, period_us);
+	if (!cache->poller) {
+		goto err;
+	}
+
+	r5f_info->cache = cache;
+
+	return 0;
+err:
+	raid5f_cache_free(cache);
+	return -ENOMEM;
+}
+
 static int
 raid5f_start(struct raid_bdev *raid_bdev)
 {
@@ -1056,7 +2939,9 @@ raid5f_start(struct raid_bdev *raid_bdev)
 	struct raid_base_bdev_info *base_info;
 	struct spdk_bdev *base_bdev;
 	struct raid5f_info *r5f_info;
+	struct spdk_raid_bdev_opts opts;
 	size_t alignment = 0;
+	int i, ret;
 
 	r5f_info = calloc(1, sizeof(*r5f_info));
 	if (!r5f_info) {
@@ -1087,10 +2972,44 @@ raid5f_start(struct raid_bdev *raid_bdev)
 	}
 
 	raid_bdev->bdev.blockcnt = r5f_info->stripe_blocks * r5f_info->total_stripes;
-	raid_bdev->bdev.optimal_io_boundary = raid_bdev->strip_size;
 	raid_bdev->bdev.split_on_optimal_io_boundary = true;
-	raid_bdev->bdev.write_unit_size = r5f_info->stripe_blocks;
-	raid_bdev->bdev.split_on_write_unit = true;
+
+	/*
+	 * Partial stripe writes are not supported with separate metadata, in which case
+	 * the writes must cover whole stripes.
+	 */
+	r5f_info->partial_stripe_writes = raid_bdev->bdev.md_len == 0 || raid_bdev->bdev.md_interleave;
+	if (r5f_info->partial_stripe_writes) {
+		raid_bdev->bdev.write_unit_size = 1;
+		raid_bdev->bdev.optimal_io_boundary = r5f_info->stripe_blocks;
+		raid_bdev->bdev.split_on_write_unit = false;
+	} else {
+		raid_bdev->bdev.write_unit_size = r5f_info->stripe_blocks;
+		raid_bdev->bdev.optimal_io_boundary = raid_bdev->strip_size;
+		raid_bdev->bdev.split_on_write_unit = true;
+	}
+
+	raid_bdev_get_opts(&opts);
+	if (opts.stripe_cache_size_kb > 0) {
+		if (r5f_info->partial_stripe_writes) {
+			ret = raid5f_cache_create(r5f_info, &opts);
+			if (ret) {
+				SPDK_ERRLOG("Failed to create stripe cache for raid bdev %s: %s\n",
+					    raid_bdev->bdev.name, spdk_strerror(-ret));
+				free(r5f_info);
+				return ret;
+			}
+			raid_bdev->bdev.write_cache = 1;
+		} else {
+			SPDK_WARNLOG("Stripe cache is not supported on raid bdev %s with separate metadata\n",
+				     raid_bdev->bdev.name);
+		}
+	}
+
+	for (i = 0; i < RAID5F_STRIPE_LOCK_BUCKETS; i++) {
+		spdk_spin_init(&r5f_info->stripe_locks[i].lock);
+		TAILQ_INIT(&r5f_info->stripe_locks[i].locked);
+	}
 
 	raid_bdev->module_private = r5f_info;
 
@@ -1104,9 +3023,19 @@ static void
 raid5f_io_device_unregister_done(void *io_device)
 {
 	struct raid5f_info *r5f_info = io_device;
+	int i;
 
 	raid_bdev_module_stop_done(r5f_info->raid_bdev);
 
+	for (i = 0; i < RAID5F_STRIPE_LOCK_BUCKETS; i++) {
+		assert(TAILQ_EMPTY(&r5f_info->stripe_locks[i].locked));
+		spdk_spin_destroy(&r5f_info->stripe_locks[i].lock);
+	}
+
+	if (r5f_info->cache != NULL) {
+		raid5f_cache_free(r5f_info->cache);
+	}
+
 	free(r5f_info);
 }
 
@@ -1114,6 +3043,15 @@ static bool
 raid5f_stop(struct raid_bdev *raid_bdev)
 {
 	struct raid5f_info *r5f_info = raid_bdev->module_private;
+	struct raid5f_cache *cache = r5f_info->cache;
+
+	if (cache != NULL) {
+		spdk_poller_unregister(&cache->poller);
+		if (cache->ch != NULL) {
+			spdk_put_io_channel(cache->ch);
+			cache->ch = NULL;
+		}
+	}
 
 	spdk_io_device_unregister(r5f_info, raid5f_io_device_unregister_done);
 
@@ -1234,7 +3172,12 @@ static struct raid_bdev_module g_raid5f_module = {
 	.stop = raid5f_stop,
 	.submit_rw_request = raid5f_submit_rw_request,
 	.get_io_channel = raid5f_get_io_channel,
+	.submit_null_payload_request = raid5f_submit_null_payload_request,
 	.submit_process_request = raid5f_submit_process_request,
+	.io_type_supported = raid5f_io_type_supported,
+	.suspend = raid5f_suspend,
+	.resume = raid5f_resume,
+	.dump_info_json = raid5f_dump_info_json,
 };
 RAID_MODULE_REGISTER(&g_raid5f_module)
 
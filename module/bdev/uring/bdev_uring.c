@@ -19,8 +19,13 @@
 #include "spdk/file.h"
 
 #include "spdk/log.h"
+#include "spdk/nvme_spec.h"
+#include "spdk/bdev_zone.h"
+#include "spdk_internal/assert.h"
 #include "spdk_internal/uring.h"
 
+#include <linux/nvme_ioctl.h>
+
 #ifdef SPDK_CONFIG_URING_ZNS
 #include <linux/blkzoned.h>
 #define SECTOR_SHIFT 9
@@ -32,21 +37,59 @@ struct bdev_uring_zoned_dev {
 	uint32_t		lba_shift;
 };
 
+/* Each thread keeps a separate ring for each combination of the setup flags below, as these
+ * cannot be mixed within a single ring. */
+#define BDEV_URING_RING_IOPOLL	(1 << 0)
+#define BDEV_URING_RING_SQPOLL	(1 << 1)
+/* Big SQEs/CQEs needed by NVMe passthrough commands */
+#define BDEV_URING_RING_NVME	(1 << 2)
+#define BDEV_URING_NUM_RINGS	8
+
+struct bdev_uring_ring {
+	uint64_t				io_inflight;
+	uint64_t				io_pending;
+	bool					initialized;
+	bool					files_registered;
+	bool					buffers_registered;
+	struct io_uring				uring;
+	TAILQ_ENTRY(bdev_uring_ring)		link;
+};
+
 struct bdev_uring_io_channel {
 	struct bdev_uring_group_channel		*group_ch;
+	struct bdev_uring_ring			*ring;
 };
 
 struct bdev_uring_group_channel {
-	uint64_t				io_inflight;
-	uint64_t				io_pending;
 	struct spdk_poller			*poller;
-	struct io_uring				uring;
+	struct bdev_uring_ring			rings[BDEV_URING_NUM_RINGS];
 };
 
 struct bdev_uring_task {
 	uint64_t			len;
 	struct bdev_uring_io_channel	*ch;
 	TAILQ_ENTRY(bdev_uring_task)	link;
+	/* Submitted as an NVMe passthrough command */
+	bool				nvme_cmd;
+	union {
+		struct spdk_nvme_dsm_range	dsm_range;
+		struct {
+			struct spdk_nvme_zns_zone_report	*buf;
+			uint32_t				size;
+			uint32_t				handled_zones;
+		} zone_report;
+	};
+};
+
+/* NVMe namespace accessed through its generic char device (/dev/ngXnY) */
+struct bdev_uring_nvme {
+	/* 0 if the bdev isn't backed by an NVMe generic char device */
+	uint32_t		nsid;
+	uint32_t		max_xfer_size;
+	bool			compare;
+	bool			write_zeroes;
+	bool			dsm;
+	bool			flush;
 };
 
 struct bdev_uring {
@@ -54,6 +97,11 @@ struct bdev_uring {
 	struct bdev_uring_zoned_dev	zd;
 	char			*filename;
 	int			fd;
+	/* Index in the rings' registered file tables, -1 if files aren't registered */
+	int			file_index;
+	bool			fixed_buffers;
+	uint32_t		ring_flags;
+	struct bdev_uring_nvme	nvme;
 	TAILQ_ENTRY(bdev_uring)  link;
 };
 
@@ -64,6 +112,30 @@ static TAILQ_HEAD(, bdev_uring) g_uring_bdev_head = TAILQ_HEAD_INITIALIZER(g_uri
 
 #define SPDK_URING_QUEUE_DEPTH 512
 #define MAX_EVENTS_PER_POLL 32
+#define SPDK_URING_MAX_REGISTERED_FILES 256
+#define SPDK_URING_MAX_FIXED_BUFFERS 1024
+/* The kernel doesn't allow registering buffers larger than 1GiB */
+#define SPDK_URING_MAX_FIXED_BUFFER_SIZE (1ULL << 30)
+#define SPDK_URING_SQ_THREAD_IDLE_MS 1000
+/* Used for NVMe passthrough if the kernel's limits can't be read from sysfs */
+#define SPDK_URING_NVME_DEFAULT_MAX_XFER_SIZE (128 * 1024)
+#define SPDK_URING_NVME_DEFAULT_MAX_SEGMENTS 127
+
+/* Registered file slots are shared by all rings, so each bdev uses the same slot everywhere */
+static struct bdev_uring *g_uring_files[SPDK_URING_MAX_REGISTERED_FILES];
+
+/* SPDK memory registered as fixed buffers.  The memory map translates an address to the
+ * index of its buffer + 1 and is updated from memory (un)registration notifications, which can
+ * happen on any thread, hence the mutex protecting the buffer table and the list of rings. */
+static struct {
+	pthread_mutex_t				mutex;
+	struct spdk_mem_map			*map;
+	struct iovec				iovs[SPDK_URING_MAX_FIXED_BUFFERS];
+	TAILQ_HEAD(, bdev_uring_ring)		rings;
+} g_uring_bufs = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+	.rings = TAILQ_HEAD_INITIALIZER(g_uring_bufs.rings),
+};
 
 static int
 bdev_uring_get_ctx_size(void)
@@ -102,6 +174,55 @@ bdev_uring_open(struct bdev_uring *bdev)
 	return 0;
 }
 
+static int
+bdev_uring_nvme_identify(struct bdev_uring *uring, uint8_t cns, uint32_t nsid, uint8_t csi,
+			 void *buf)
+{
+	struct nvme_admin_cmd cmd = {};
+	int rc;
+
+	cmd.opcode = SPDK_NVME_OPC_IDENTIFY;
+	cmd.nsid = nsid;
+	cmd.addr = (uint64_t)buf;
+	cmd.data_len = SPDK_NVME_IDENTIFY_BUFLEN;
+	cmd.cdw10 = cns;
+	cmd.cdw11 = (uint32_t)csi << 24;
+
+	rc = ioctl(uring->fd, NVME_IOCTL_ADMIN_CMD, &cmd);
+	if (rc < 0) {
+		rc = -errno;
+		SPDK_ERRLOG("Identify (CNS %#x) failed (file: %s): %s\n", cns, uring->filename,
+			    spdk_strerror(-rc));
+		return rc;
+	} else if (rc > 0) {
+		SPDK_ERRLOG("Identify (CNS %#x) failed (file: %s): NVMe status %#x\n", cns,
+			    uring->filename, rc);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static int
+bdev_uring_nvme_get_num_blocks(struct bdev_uring *uring, uint64_t *num_blocks)
+{
+	struct spdk_nvme_ns_data *nsdata;
+	int rc;
+
+	nsdata = calloc(1, SPDK_NVME_IDENTIFY_BUFLEN);
+	if (nsdata == NULL) {
+		return -ENOMEM;
+	}
+
+	rc = bdev_uring_nvme_identify(uring, SPDK_NVME_IDENTIFY_NS, uring->nvme.nsid, 0, nsdata);
+	if (rc == 0) {
+		*num_blocks = nsdata->nsze;
+	}
+
+	free(nsdata);
+	return rc;
+}
+
 static void
 dummy_bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev, void *ctx)
 {
@@ -128,8 +249,15 @@ bdev_uring_rescan(const char *name)
 	}
 
 	uring = SPDK_CONTAINEROF(bdev, struct bdev_uring, bdev);
-	uring_size = spdk_fd_get_size(uring->fd);
-	blockcnt = uring_size / bdev->blocklen;
+	if (uring->nvme.nsid != 0) {
+		rc = bdev_uring_nvme_get_num_blocks(uring, &blockcnt);
+		if (rc != 0) {
+			goto exit;
+		}
+	} else {
+		uring_size = spdk_fd_get_size(uring->fd);
+		blockcnt = uring_size / bdev->blocklen;
+	}
 
 	if (bdev->blockcnt != blockcnt) {
 		SPDK_NOTICELOG("URING device is resized: bdev name %s, old block count %" PRIu64
@@ -172,30 +300,75 @@ bdev_uring_close(struct bdev_uring *bdev)
 	return 0;
 }
 
+static int
+bdev_uring_buf_index(void *buf, uint64_t len)
+{
+	uint64_t size = len;
+	uint64_t translation;
+
+	translation = spdk_mem_map_translate(g_uring_bufs.map, (uint64_t)buf, &size);
+	if (translation == 0 || size < len) {
+		return -1;
+	}
+
+	return translation - 1;
+}
+
+static void
+bdev_uring_prep_rw(struct bdev_uring *uring, struct io_uring_sqe *sqe, bool write,
+		   struct iovec *iov, int iovcnt, uint64_t nbytes, uint64_t offset)
+{
+	int fd = uring->file_index >= 0 ? uring->file_index : uring->fd;
+	int buf_index = -1;
+
+	if (uring->fixed_buffers && iovcnt == 1) {
+		buf_index = bdev_uring_buf_index(iov->iov_base, nbytes);
+	}
+
+	if (buf_index >= 0) {
+		if (write) {
+			io_uring_prep_write_fixed(sqe, fd, iov->iov_base, nbytes, offset, buf_index);
+		} else {
+			io_uring_prep_read_fixed(sqe, fd, iov->iov_base, nbytes, offset, buf_index);
+		}
+	} else {
+		if (write) {
+			io_uring_prep_writev(sqe, fd, iov, iovcnt, offset);
+		} else {
+			io_uring_prep_readv(sqe, fd, iov, iovcnt, offset);
+		}
+	}
+
+	if (uring->file_index >= 0) {
+		io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+	}
+}
+
 static int64_t
 bdev_uring_readv(struct bdev_uring *uring, struct spdk_io_channel *ch,
 		 struct bdev_uring_task *uring_task,
 		 struct iovec *iov, int iovcnt, uint64_t nbytes, uint64_t offset)
 {
 	struct bdev_uring_io_channel *uring_ch = spdk_io_channel_get_ctx(ch);
-	struct bdev_uring_group_channel *group_ch = uring_ch->group_ch;
+	struct bdev_uring_ring *ring = uring_ch->ring;
 	struct io_uring_sqe *sqe;
 
-	sqe = io_uring_get_sqe(&group_ch->uring);
+	sqe = io_uring_get_sqe(&ring->uring);
 	if (!sqe) {
 		SPDK_DEBUGLOG(uring, "get sqe failed as out of resource\n");
 		return -ENOMEM;
 	}
 
-	io_uring_prep_readv(sqe, uring->fd, iov, iovcnt, offset);
+	bdev_uring_prep_rw(uring, sqe, false, iov, iovcnt, nbytes, offset);
 	io_uring_sqe_set_data(sqe, uring_task);
 	uring_task->len = nbytes;
 	uring_task->ch = uring_ch;
+	uring_task->nvme_cmd = false;
 
 	SPDK_DEBUGLOG(uring, "read %d iovs size %lu to off: %#lx\n",
 		      iovcnt, nbytes, offset);
 
-	group_ch->io_pending++;
+	ring->io_pending++;
 	return nbytes;
 }
 
@@ -205,24 +378,25 @@ bdev_uring_writev(struct bdev_uring *uring, struct spdk_io_channel *ch,
 		  struct iovec *iov, int iovcnt, size_t nbytes, uint64_t offset)
 {
 	struct bdev_uring_io_channel *uring_ch = spdk_io_channel_get_ctx(ch);
-	struct bdev_uring_group_channel *group_ch = uring_ch->group_ch;
+	struct bdev_uring_ring *ring = uring_ch->ring;
 	struct io_uring_sqe *sqe;
 
-	sqe = io_uring_get_sqe(&group_ch->uring);
+	sqe = io_uring_get_sqe(&ring->uring);
 	if (!sqe) {
 		SPDK_DEBUGLOG(uring, "get sqe failed as out of resource\n");
 		return -ENOMEM;
 	}
 
-	io_uring_prep_writev(sqe, uring->fd, iov, iovcnt, offset);
+	bdev_uring_prep_rw(uring, sqe, true, iov, iovcnt, nbytes, offset);
 	io_uring_sqe_set_data(sqe, uring_task);
 	uring_task->len = nbytes;
 	uring_task->ch = uring_ch;
+	uring_task->nvme_cmd = false;
 
 	SPDK_DEBUGLOG(uring, "write %d iovs size %lu from off: %#lx\n",
 		      iovcnt, nbytes, offset);
 
-	group_ch->io_pending++;
+	ring->io_pending++;
 	return nbytes;
 }
 
@@ -242,573 +416,1610 @@ bdev_uring_destruct(void *ctx)
 	return rc;
 }
 
-static int
-bdev_uring_reap(struct io_uring *ring, int max)
+static inline bool
+bdev_uring_is_nvme(struct bdev_uring *uring)
 {
-	int i, count, ret;
-	struct io_uring_cqe *cqe;
-	struct bdev_uring_task *uring_task;
-	enum spdk_bdev_io_status status;
-
-	count = 0;
-	for (i = 0; i < max; i++) {
-		ret = io_uring_peek_cqe(ring, &cqe);
-		if (ret != 0) {
-			assert(ret == -EAGAIN || ret == -EWOULDBLOCK);
-			return count;
-		}
+	return uring->nvme.nsid != 0;
+}
 
-		assert(cqe != NULL);
+/* Prepare an SQE for an NVMe passthrough command and return the command to fill in */
+static struct nvme_uring_cmd *
+bdev_uring_nvme_get_cmd(struct bdev_uring_ring *ring, struct bdev_uring *uring,
+			struct bdev_uring_task *task, uint8_t opc, bool vectored)
+{
+	struct io_uring_sqe *sqe;
+	struct nvme_uring_cmd *cmd;
 
-		uring_task = (struct bdev_uring_task *)cqe->user_data;
-		if (spdk_unlikely(cqe->res != (signed)uring_task->len)) {
-			if (cqe->res == -EAGAIN || cqe->res == -EWOULDBLOCK) {
-				status = SPDK_BDEV_IO_STATUS_NOMEM;
-			} else {
-				SPDK_ERRLOG("I/O failed with error %d\n", cqe->res);
-				status = SPDK_BDEV_IO_STATUS_FAILED;
-			}
-		} else {
-			status = SPDK_BDEV_IO_STATUS_SUCCESS;
-		}
+	sqe = io_uring_get_sqe(&ring->uring);
+	if (!sqe) {
+		SPDK_DEBUGLOG(uring, "get sqe failed as out of resource\n");
+		return NULL;
+	}
 
-		uring_task->ch->group_ch->io_inflight--;
-		io_uring_cqe_seen(ring, cqe);
-		spdk_bdev_io_complete(spdk_bdev_io_from_ctx(uring_task), status);
-		count++;
+	/* The ring uses 128B SQEs, the command is stored in the second half of the SQE */
+	memset(sqe, 0, 2 * sizeof(*sqe));
+	sqe->opcode = IORING_OP_URING_CMD;
+	if (uring->file_index >= 0) {
+		sqe->fd = uring->file_index;
+		sqe->flags = IOSQE_FIXED_FILE;
+	} else {
+		sqe->fd = uring->fd;
 	}
+	/* cmd_op shares the offset field, use it for compatibility with older liburing */
+	sqe->off = vectored ? NVME_URING_CMD_IO_VEC : NVME_URING_CMD_IO;
+	io_uring_sqe_set_data(sqe, task);
 
-	return count;
+	cmd = (struct nvme_uring_cmd *)&sqe->addr3;
+	cmd->opcode = opc;
+	cmd->nsid = uring->nvme.nsid;
+
+	task->nvme_cmd = true;
+	task->len = 0;
+	ring->io_pending++;
+
+	return cmd;
+}
+
+static inline void
+bdev_uring_nvme_set_lba(struct nvme_uring_cmd *cmd, uint64_t lba, uint32_t num_blocks)
+{
+	cmd->cdw10 = (uint32_t)lba;
+	cmd->cdw11 = (uint32_t)(lba >> 32);
+	cmd->cdw12 = num_blocks - 1;
 }
 
 static int
-bdev_uring_group_poll(void *arg)
+bdev_uring_nvme_rw(struct bdev_uring_ring *ring, struct bdev_uring *uring,
+		   struct spdk_bdev_io *bdev_io, uint8_t opc)
 {
-	struct bdev_uring_group_channel *group_ch = arg;
-	int to_complete, to_submit;
-	int count, ret;
+	struct bdev_uring_task *task = (struct bdev_uring_task *)bdev_io->driver_ctx;
+	struct iovec *iovs = bdev_io->u.bdev.iovs;
+	int iovcnt = bdev_io->u.bdev.iovcnt;
+	struct nvme_uring_cmd *cmd;
+	struct io_uring_sqe *sqe;
+	int buf_index = -1;
 
-	to_submit = group_ch->io_pending;
+	cmd = bdev_uring_nvme_get_cmd(ring, uring, task, opc, iovcnt > 1);
+	if (cmd == NULL) {
+		return -ENOMEM;
+	}
 
-	if (to_submit > 0) {
-		/* If there are I/O to submit, use io_uring_submit here.
-		 * It will automatically call spdk_io_uring_enter appropriately. */
-		ret = io_uring_submit(&group_ch->uring);
-		if (ret < 0) {
-			return SPDK_POLLER_BUSY;
+	if (iovcnt == 1) {
+		cmd->addr = (uint64_t)iovs[0].iov_base;
+		cmd->data_len = bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen;
+		if (uring->fixed_buffers) {
+			buf_index = bdev_uring_buf_index(iovs[0].iov_base, cmd->data_len);
 		}
-
-		group_ch->io_pending = 0;
-		group_ch->io_inflight += to_submit;
+	} else {
+		cmd->addr = (uint64_t)iovs;
+		cmd->data_len = iovcnt;
 	}
 
-	to_complete = group_ch->io_inflight;
-	count = 0;
-	if (to_complete > 0) {
-		count = bdev_uring_reap(&group_ch->uring, to_complete);
+	if (buf_index >= 0) {
+		sqe = SPDK_CONTAINEROF((void *)cmd, struct io_uring_sqe, addr3);
+		sqe->uring_cmd_flags = IORING_URING_CMD_FIXED;
+		sqe->buf_index = buf_index;
 	}
 
-	if (count + to_submit > 0) {
-		return SPDK_POLLER_BUSY;
-	} else {
-		return SPDK_POLLER_IDLE;
+	if (bdev_io->u.bdev.md_buf != NULL) {
+		cmd->metadata = (uint64_t)bdev_io->u.bdev.md_buf;
+		cmd->metadata_len = bdev_io->u.bdev.num_blocks * bdev_io->bdev->md_len;
 	}
+
+	bdev_uring_nvme_set_lba(cmd, bdev_io->u.bdev.offset_blocks, bdev_io->u.bdev.num_blocks);
+
+	return 0;
 }
 
-static void
-bdev_uring_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io,
-		      bool success)
+static int
+bdev_uring_nvme_write_zeroes(struct bdev_uring_ring *ring, struct bdev_uring *uring,
+			     struct spdk_bdev_io *bdev_io)
 {
-	int64_t ret = 0;
+	struct bdev_uring_task *task = (struct bdev_uring_task *)bdev_io->driver_ctx;
+	struct nvme_uring_cmd *cmd;
 
-	if (!success) {
-		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
-		return;
+	cmd = bdev_uring_nvme_get_cmd(ring, uring, task, SPDK_NVME_OPC_WRITE_ZEROES, false);
+	if (cmd == NULL) {
+		return -ENOMEM;
 	}
 
-	switch (bdev_io->type) {
-	case SPDK_BDEV_IO_TYPE_READ:
-		ret = bdev_uring_readv((struct bdev_uring *)bdev_io->bdev->ctxt,
-				       ch,
-				       (struct bdev_uring_task *)bdev_io->driver_ctx,
-				       bdev_io->u.bdev.iovs,
-				       bdev_io->u.bdev.iovcnt,
-				       bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen,
-				       bdev_io->u.bdev.offset_blocks * bdev_io->bdev->blocklen);
-		break;
-	case SPDK_BDEV_IO_TYPE_WRITE:
-		ret = bdev_uring_writev((struct bdev_uring *)bdev_io->bdev->ctxt,
-					ch,
-					(struct bdev_uring_task *)bdev_io->driver_ctx,
-					bdev_io->u.bdev.iovs,
-					bdev_io->u.bdev.iovcnt,
-					bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen,
-					bdev_io->u.bdev.offset_blocks * bdev_io->bdev->blocklen);
-		break;
-	default:
-		SPDK_ERRLOG("Wrong io type\n");
-		break;
-	}
+	bdev_uring_nvme_set_lba(cmd, bdev_io->u.bdev.offset_blocks, bdev_io->u.bdev.num_blocks);
 
-	if (ret == -ENOMEM) {
-		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
-	}
+	return 0;
 }
 
-#ifdef SPDK_CONFIG_URING_ZNS
 static int
-bdev_uring_fill_zone_type(struct spdk_bdev_zone_info *zone_info, struct blk_zone *zones_rep)
+bdev_uring_nvme_unmap(struct bdev_uring_ring *ring, struct bdev_uring *uring,
+		      struct spdk_bdev_io *bdev_io)
 {
-	switch (zones_rep->type) {
-	case BLK_ZONE_TYPE_CONVENTIONAL:
-		zone_info->type = SPDK_BDEV_ZONE_TYPE_CNV;
-		break;
-	case BLK_ZONE_TYPE_SEQWRITE_REQ:
-		zone_info->type = SPDK_BDEV_ZONE_TYPE_SEQWR;
-		break;
-	case BLK_ZONE_TYPE_SEQWRITE_PREF:
-		zone_info->type = SPDK_BDEV_ZONE_TYPE_SEQWP;
-		break;
-	default:
-		SPDK_ERRLOG("Invalid zone type: %#x in zone report\n", zones_rep->type);
-		return -EIO;
+	struct bdev_uring_task *task = (struct bdev_uring_task *)bdev_io->driver_ctx;
+	struct nvme_uring_cmd *cmd;
+
+	/* max_unmap and max_unmap_segments make sure a single range is enough */
+	assert(bdev_io->u.bdev.num_blocks <= SPDK_NVME_DATASET_MANAGEMENT_RANGE_MAX_BLOCKS);
+
+	cmd = bdev_uring_nvme_get_cmd(ring, uring, task, SPDK_NVME_OPC_DATASET_MANAGEMENT, false);
+	if (cmd == NULL) {
+		return -ENOMEM;
 	}
+
+	memset(&task->dsm_range, 0, sizeof(task->dsm_range));
+	task->dsm_range.starting_lba = bdev_io->u.bdev.offset_blocks;
+	task->dsm_range.length = bdev_io->u.bdev.num_blocks;
+
+	cmd->addr = (uint64_t)&task->dsm_range;
+	cmd->data_len = sizeof(task->dsm_range);
+	cmd->cdw10 = 0;
+	cmd->cdw11 = SPDK_NVME_DSM_ATTR_DEALLOCATE;
+
 	return 0;
 }
 
 static int
-bdev_uring_fill_zone_state(struct spdk_bdev_zone_info *zone_info, struct blk_zone *zones_rep)
+bdev_uring_nvme_flush(struct bdev_uring_ring *ring, struct bdev_uring *uring,
+		      struct spdk_bdev_io *bdev_io)
 {
-	switch (zones_rep->cond) {
-	case BLK_ZONE_COND_EMPTY:
-		zone_info->state = SPDK_BDEV_ZONE_STATE_EMPTY;
-		break;
-	case BLK_ZONE_COND_IMP_OPEN:
-		zone_info->state = SPDK_BDEV_ZONE_STATE_IMP_OPEN;
-		break;
-	case BLK_ZONE_COND_EXP_OPEN:
-		zone_info->state = SPDK_BDEV_ZONE_STATE_EXP_OPEN;
-		break;
-	case BLK_ZONE_COND_CLOSED:
-		zone_info->state = SPDK_BDEV_ZONE_STATE_CLOSED;
-		break;
-	case BLK_ZONE_COND_READONLY:
-		zone_info->state = SPDK_BDEV_ZONE_STATE_READ_ONLY;
-		break;
-	case BLK_ZONE_COND_FULL:
-		zone_info->state = SPDK_BDEV_ZONE_STATE_FULL;
-		break;
-	case BLK_ZONE_COND_OFFLINE:
-		zone_info->state = SPDK_BDEV_ZONE_STATE_OFFLINE;
-		break;
-	case BLK_ZONE_COND_NOT_WP:
-		zone_info->state = SPDK_BDEV_ZONE_STATE_NOT_WP;
-		break;
-	default:
-		SPDK_ERRLOG("Invalid zone state: %#x in zone report\n", zones_rep->cond);
-		return -EIO;
+	struct bdev_uring_task *task = (struct bdev_uring_task *)bdev_io->driver_ctx;
+
+	if (bdev_uring_nvme_get_cmd(ring, uring, task, SPDK_NVME_OPC_FLUSH, false) == NULL) {
+		return -ENOMEM;
 	}
+
 	return 0;
 }
 
 static int
-bdev_uring_zone_management_op(struct spdk_bdev_io *bdev_io)
+bdev_uring_nvme_zone_management(struct bdev_uring_ring *ring, struct bdev_uring *uring,
+				struct spdk_bdev_io *bdev_io)
 {
-	struct bdev_uring *uring;
-	struct blk_zone_range range;
-	long unsigned zone_mgmt_op;
-	uint64_t zone_id = bdev_io->u.zone_mgmt.zone_id;
-
-	uring = (struct bdev_uring *)bdev_io->bdev->ctxt;
+	struct bdev_uring_task *task = (struct bdev_uring_task *)bdev_io->driver_ctx;
+	struct nvme_uring_cmd *cmd;
+	uint32_t zsa;
 
 	switch (bdev_io->u.zone_mgmt.zone_action) {
 	case SPDK_BDEV_ZONE_RESET:
-		zone_mgmt_op = BLKRESETZONE;
+		zsa = SPDK_NVME_ZONE_RESET;
 		break;
 	case SPDK_BDEV_ZONE_OPEN:
-		zone_mgmt_op = BLKOPENZONE;
+		zsa = SPDK_NVME_ZONE_OPEN;
 		break;
 	case SPDK_BDEV_ZONE_CLOSE:
-		zone_mgmt_op = BLKCLOSEZONE;
+		zsa = SPDK_NVME_ZONE_CLOSE;
 		break;
 	case SPDK_BDEV_ZONE_FINISH:
-		zone_mgmt_op = BLKFINISHZONE;
+		zsa = SPDK_NVME_ZONE_FINISH;
+		break;
+	case SPDK_BDEV_ZONE_OFFLINE:
+		zsa = SPDK_NVME_ZONE_OFFLINE;
 		break;
 	default:
 		return -EINVAL;
 	}
 
-	range.sector = (zone_id << uring->zd.lba_shift);
-	range.nr_sectors = (uring->bdev.zone_size << uring->zd.lba_shift);
-
-	if (ioctl(uring->fd, zone_mgmt_op, &range)) {
-		SPDK_ERRLOG("Ioctl BLKXXXZONE(%#x) failed errno: %d(%s)\n",
-			    bdev_io->u.zone_mgmt.zone_action, errno, strerror(errno));
-		return -EINVAL;
+	cmd = bdev_uring_nvme_get_cmd(ring, uring, task, SPDK_NVME_OPC_ZONE_MGMT_SEND, false);
+	if (cmd == NULL) {
+		return -ENOMEM;
 	}
 
-	spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+	cmd->cdw10 = (uint32_t)bdev_io->u.zone_mgmt.zone_id;
+	cmd->cdw11 = (uint32_t)(bdev_io->u.zone_mgmt.zone_id >> 32);
+	cmd->cdw13 = zsa;
 
 	return 0;
 }
 
 static int
-bdev_uring_zone_get_info(struct spdk_bdev_io *bdev_io)
+bdev_uring_nvme_zone_report(struct bdev_uring_ring *ring, struct bdev_uring *uring,
+			    struct bdev_uring_task *task, uint64_t zone_id)
 {
-	struct bdev_uring *uring;
-	struct blk_zone *zones;
-	struct blk_zone_report *rep;
-	struct spdk_bdev_zone_info *zone_info = bdev_io->u.zone_mgmt.buf;
-	size_t repsize;
-	uint32_t i, shift;
-	uint32_t num_zones = bdev_io->u.zone_mgmt.num_zones;
-	uint64_t zone_id = bdev_io->u.zone_mgmt.zone_id;
-
-	uring = (struct bdev_uring *)bdev_io->bdev->ctxt;
-	shift = uring->zd.lba_shift;
+	struct nvme_uring_cmd *cmd;
 
-	if ((num_zones > uring->zd.num_zones) || !num_zones) {
-		return -EINVAL;
-	}
-
-	repsize = sizeof(struct blk_zone_report) + (sizeof(struct blk_zone) * num_zones);
-	rep = (struct blk_zone_report *)malloc(repsize);
-	if (!rep) {
+	cmd = bdev_uring_nvme_get_cmd(ring, uring, task, SPDK_NVME_OPC_ZONE_MGMT_RECV, false);
+	if (cmd == NULL) {
 		return -ENOMEM;
 	}
 
-	zones = (struct blk_zone *)(rep + 1);
+	memset(task->zone_report.buf, 0, task->zone_report.size);
+	cmd->addr = (uint64_t)task->zone_report.buf;
+	cmd->data_len = task->zone_report.size;
+	cmd->cdw10 = (uint32_t)zone_id;
+	cmd->cdw11 = (uint32_t)(zone_id >> 32);
+	cmd->cdw12 = task->zone_report.size / sizeof(uint32_t) - 1;
+	/* Partial report, so that nr_zones only counts the zones in the buffer */
+	cmd->cdw13 = SPDK_NVME_ZONE_REPORT | (SPDK_NVME_ZRA_LIST_ALL << 8) | (1u << 16);
 
-	while (num_zones && ((zone_id >> uring->zd.zone_shift) <= num_zones)) {
-		memset(rep, 0, repsize);
-		rep->sector = zone_id;
-		rep->nr_zones = num_zones;
+	return 0;
+}
 
-		if (ioctl(uring->fd, BLKREPORTZONE, rep)) {
-			SPDK_ERRLOG("Ioctl BLKREPORTZONE failed errno: %d(%s)\n",
-				    errno, strerror(errno));
-			free(rep);
-			return -EINVAL;
-		}
+static int
+bdev_uring_nvme_get_zone_info(struct bdev_uring_ring *ring, struct bdev_uring *uring,
+			      struct spdk_bdev_io *bdev_io)
+{
+	struct bdev_uring_task *task = (struct bdev_uring_task *)bdev_io->driver_ctx;
+	struct spdk_nvme_zns_zone_report *report;
+	uint32_t num_zones, max_zones;
+	int rc;
 
-		if (!rep->nr_zones) {
-			break;
-		}
+	max_zones = (uring->nvme.max_xfer_size - sizeof(*report)) / sizeof(report->descs[0]);
+	num_zones = spdk_min(bdev_io->u.zone_mgmt.num_zones, max_zones);
+	if (num_zones == 0) {
+		return -EINVAL;
+	}
 
-		for (i = 0; i < rep->nr_zones; i++) {
-			zone_info->zone_id = ((zones + i)->start >> shift);
-			zone_info->write_pointer = ((zones + i)->wp >> shift);
-			zone_info->capacity = ((zones + i)->capacity >> shift);
+	task->zone_report.size = sizeof(*report) + num_zones * sizeof(report->descs[0]);
+	task->zone_report.buf = calloc(1, task->zone_report.size);
+	if (task->zone_report.buf == NULL) {
+		return -ENOMEM;
+	}
+	task->zone_report.handled_zones = 0;
 
-			bdev_uring_fill_zone_state(zone_info, zones + i);
-			bdev_uring_fill_zone_type(zone_info, zones + i);
+	rc = bdev_uring_nvme_zone_report(ring, uring, task, bdev_io->u.zone_mgmt.zone_id);
+	if (rc != 0) {
+		free(task->zone_report.buf);
+	}
 
-			zone_id = ((zones + i)->start + (zones + i)->len) >> shift;
-			zone_info++;
-			num_zones--;
-		}
+	return rc;
+}
+
+static int
+bdev_uring_nvme_fill_zone_info(struct spdk_bdev_zone_info *info,
+			       const struct spdk_nvme_zns_zone_desc *desc)
+{
+	if (desc->zt != SPDK_NVME_ZONE_TYPE_SEQWR) {
+		SPDK_ERRLOG("Invalid zone type: %#x in zone report\n", desc->zt);
+		return -EIO;
 	}
+	info->type = SPDK_BDEV_ZONE_TYPE_SEQWR;
+
+	switch (desc->zs) {
+	case SPDK_NVME_ZONE_STATE_EMPTY:
+		info->state = SPDK_BDEV_ZONE_STATE_EMPTY;
+		break;
+	case SPDK_NVME_ZONE_STATE_IOPEN:
+		info->state = SPDK_BDEV_ZONE_STATE_IMP_OPEN;
+		break;
+	case SPDK_NVME_ZONE_STATE_EOPEN:
+		info->state = SPDK_BDEV_ZONE_STATE_EXP_OPEN;
+		break;
+	case SPDK_NVME_ZONE_STATE_CLOSED:
+		info->state = SPDK_BDEV_ZONE_STATE_CLOSED;
+		break;
+	case SPDK_NVME_ZONE_STATE_RONLY:
+		info->state = SPDK_BDEV_ZONE_STATE_READ_ONLY;
+		break;
+	case SPDK_NVME_ZONE_STATE_FULL:
+		info->state = SPDK_BDEV_ZONE_STATE_FULL;
+		break;
+	case SPDK_NVME_ZONE_STATE_OFFLINE:
+		info->state = SPDK_BDEV_ZONE_STATE_OFFLINE;
+		break;
+	default:
+		SPDK_ERRLOG("Invalid zone state: %#x in zone report\n", desc->zs);
+		return -EIO;
+	}
+
+	info->zone_id = desc->zslba;
+	info->write_pointer = desc->wp;
+	info->capacity = desc->zcap;
 
-	spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
-	free(rep);
 	return 0;
 }
 
-static int
-bdev_uring_check_zoned_support(struct bdev_uring *uring, const char *name, const char *filename)
+static enum spdk_bdev_io_status
+bdev_uring_nvme_zone_report_done(struct bdev_uring_ring *ring, struct bdev_uring *uring,
+				 struct spdk_bdev_io *bdev_io)
 {
-	char *filename_dup = NULL, *base;
-	char *str = NULL;
-	uint32_t val;
-	uint32_t zinfo;
-	int retval = -1;
-	struct stat sb;
-	char resolved_path[PATH_MAX], *rp;
-	char *sysfs_path = NULL;
+	struct bdev_uring_task *task = (struct bdev_uring_task *)bdev_io->driver_ctx;
+	struct spdk_nvme_zns_zone_report *report = task->zone_report.buf;
+	struct spdk_bdev_zone_info *info = bdev_io->u.zone_mgmt.buf;
+	uint32_t num_zones = bdev_io->u.zone_mgmt.num_zones;
+	uint64_t i, zone_id = 0;
 
-	uring->bdev.zoned = false;
+	for (i = 0; i < report->nr_zones && task->zone_report.handled_zones < num_zones; i++) {
+		if (bdev_uring_nvme_fill_zone_info(&info[task->zone_report.handled_zones],
+						   &report->descs[i]) != 0) {
+			return SPDK_BDEV_IO_STATUS_FAILED;
+		}
+		zone_id = report->descs[i].zslba + uring->bdev.zone_size;
+		task->zone_report.handled_zones++;
+	}
 
-	/* Follow symlink */
-	if ((rp = realpath(filename, resolved_path))) {
-		filename = rp;
+	if (task->zone_report.handled_zones == num_zones) {
+		return SPDK_BDEV_IO_STATUS_SUCCESS;
 	}
 
-	/* Perform check on block devices only */
-	if (stat(filename, &sb) == 0 && !S_ISBLK(sb.st_mode)) {
-		return 0;
+	if (report->nr_zones == 0 || zone_id >= uring->bdev.blockcnt) {
+		return SPDK_BDEV_IO_STATUS_FAILED;
 	}
 
-	/* strdup() because basename() may modify the passed parameter */
-	filename_dup = strdup(filename);
-	if (filename_dup == NULL) {
-		SPDK_ERRLOG("Could not duplicate string %s\n", filename);
-		return -1;
+	if (bdev_uring_nvme_zone_report(ring, uring, task, zone_id) != 0) {
+		return SPDK_BDEV_IO_STATUS_NOMEM;
 	}
 
-	base = basename(filename_dup);
-	sysfs_path = spdk_sprintf_alloc("/sys/block/%s/queue/zoned", base);
-	retval = spdk_read_sysfs_attribute(&str, "%s", sysfs_path);
-	/* Check if this is a zoned block device */
-	if (retval < 0) {
-		SPDK_ERRLOG("Unable to open file %s. errno: %d\n", sysfs_path, retval);
-	} else if (strcmp(str, "host-aware") == 0 || strcmp(str, "host-managed") == 0) {
-		/* Only host-aware & host-managed zns devices */
-		uring->bdev.zoned = true;
+	/* Not done yet */
+	return SPDK_BDEV_IO_STATUS_PENDING;
+}
 
-		if (ioctl(uring->fd, BLKGETNRZONES, &zinfo)) {
-			SPDK_ERRLOG("ioctl BLKNRZONES failed %d (%s)\n", errno, strerror(errno));
-			goto err_ret;
+static void
+bdev_uring_nvme_complete(struct bdev_uring_ring *ring, struct bdev_uring_task *task,
+			 int res, uint64_t result)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(task);
+	struct bdev_uring *uring = bdev_io->bdev->ctxt;
+	enum spdk_bdev_io_status status;
+
+	if (spdk_unlikely(res < 0)) {
+		if (res == -EAGAIN || res == -EWOULDBLOCK) {
+			status = SPDK_BDEV_IO_STATUS_NOMEM;
+		} else {
+			SPDK_ERRLOG("NVMe passthrough command failed with error %d\n", res);
+			status = SPDK_BDEV_IO_STATUS_FAILED;
 		}
-		uring->zd.num_zones = zinfo;
+	} else if (spdk_unlikely(res > 0)) {
+		/* Status field of the completion: SC in bits 7:0, SCT in bits 10:8 */
+		if (bdev_io->type == SPDK_BDEV_IO_TYPE_GET_ZONE_INFO) {
+			free(task->zone_report.buf);
+		}
+		spdk_bdev_io_complete_nvme_status(bdev_io, 0, (res >> 8) & 0x7, res & 0xff);
+		return;
+	} else {
+		status = SPDK_BDEV_IO_STATUS_SUCCESS;
+		switch (bdev_io->type) {
+		case SPDK_BDEV_IO_TYPE_ZONE_APPEND:
+			bdev_io->u.bdev.offset_blocks = result;
+			break;
+		case SPDK_BDEV_IO_TYPE_GET_ZONE_INFO:
+			status = bdev_uring_nvme_zone_report_done(ring, uring, bdev_io);
+			if (status == SPDK_BDEV_IO_STATUS_PENDING) {
+				return;
+			}
+			break;
+		default:
+			break;
+		}
+	}
 
-		if (ioctl(uring->fd, BLKGETZONESZ, &zinfo)) {
-			SPDK_ERRLOG("ioctl BLKGETZONESZ failed %d (%s)\n", errno, strerror(errno));
-			goto err_ret;
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_GET_ZONE_INFO) {
+		free(task->zone_report.buf);
+	}
+	spdk_bdev_io_complete(bdev_io, status);
+}
+
+static int
+bdev_uring_reap(struct bdev_uring_ring *ring, int max)
+{
+	int i, count, ret;
+	struct io_uring_cqe *cqe;
+	struct bdev_uring_task *uring_task;
+	enum spdk_bdev_io_status status;
+	uint64_t result;
+
+	count = 0;
+	for (i = 0; i < max; i++) {
+		/* With IOPOLL, this enters the kernel to poll for completions */
+		ret = io_uring_peek_cqe(&ring->uring, &cqe);
+		if (ret != 0) {
+			assert(ret == -EAGAIN || ret == -EWOULDBLOCK);
+			return count;
 		}
 
-		uring->zd.lba_shift = uring->bdev.required_alignment - SECTOR_SHIFT;
-		uring->bdev.zone_size = (zinfo >> uring->zd.lba_shift);
-		uring->zd.zone_shift = spdk_u32log2(zinfo >> uring->zd.lba_shift);
+		assert(cqe != NULL);
 
-		retval = spdk_read_sysfs_attribute_uint32(&val, "/sys/block/%s/queue/max_open_zones", base);
-		if (retval < 0) {
-			SPDK_ERRLOG("Failed to get max open zones %d (%s)\n", retval, strerror(-retval));
-			goto err_ret;
+		uring_task = (struct bdev_uring_task *)cqe->user_data;
+		if (uring_task->nvme_cmd) {
+			/* NVMe status is returned in res, command's result in the big CQE */
+			ret = cqe->res;
+			result = cqe->big_cqe[0];
+			ring->io_inflight--;
+			io_uring_cqe_seen(&ring->uring, cqe);
+			bdev_uring_nvme_complete(ring, uring_task, ret, result);
+			count++;
+			continue;
 		}
-		uring->bdev.max_open_zones = uring->bdev.optimal_open_zones = val;
 
-		retval = spdk_read_sysfs_attribute_uint32(&val, "/sys/block/%s/queue/max_active_zones", base);
-		if (retval < 0) {
-			SPDK_ERRLOG("Failed to get max active zones %d (%s)\n", retval, strerror(-retval));
-			goto err_ret;
+		if (spdk_unlikely(cqe->res != (signed)uring_task->len)) {
+			if (cqe->res == -EAGAIN || cqe->res == -EWOULDBLOCK) {
+				status = SPDK_BDEV_IO_STATUS_NOMEM;
+			} else {
+				SPDK_ERRLOG("I/O failed with error %d\n", cqe->res);
+				status = SPDK_BDEV_IO_STATUS_FAILED;
+			}
+		} else {
+			status = SPDK_BDEV_IO_STATUS_SUCCESS;
 		}
-		uring->bdev.max_active_zones = val;
-		retval = 0;
-	} else {
-		retval = 0;        /* queue/zoned=none */
+
+		ring->io_inflight--;
+		io_uring_cqe_seen(&ring->uring, cqe);
+		spdk_bdev_io_complete(spdk_bdev_io_from_ctx(uring_task), status);
+		count++;
 	}
-err_ret:
-	free(str);
-	free(sysfs_path);
-	free(filename_dup);
-	return retval;
+
+	return count;
 }
-#else
-/* No support for zoned devices */
+
 static int
-bdev_uring_zone_management_op(struct spdk_bdev_io *bdev_io)
+bdev_uring_ring_poll(struct bdev_uring_ring *ring)
 {
-	return -1;
+	int to_complete, to_submit;
+	int count, ret;
+
+	to_submit = ring->io_pending;
+
+	if (to_submit > 0) {
+		/* If there are I/O to submit, use io_uring_submit here.
+		 * It will automatically call spdk_io_uring_enter appropriately
+		 * (or only wake up the kernel thread if SQPOLL is used). */
+		ret = io_uring_submit(&ring->uring);
+		if (ret < 0) {
+			return 1;
+		}
+
+		ring->io_pending = 0;
+		ring->io_inflight += to_submit;
+	}
+
+	to_complete = ring->io_inflight;
+	count = 0;
+	if (to_complete > 0) {
+		count = bdev_uring_reap(ring, to_complete);
+	}
+
+	return count + to_submit;
 }
 
 static int
-bdev_uring_zone_get_info(struct spdk_bdev_io *bdev_io)
+bdev_uring_group_poll(void *arg)
 {
-	return -1;
+	struct bdev_uring_group_channel *group_ch = arg;
+	int i, count = 0;
+
+	for (i = 0; i < BDEV_URING_NUM_RINGS; i++) {
+		if (group_ch->rings[i].initialized) {
+			count += bdev_uring_ring_poll(&group_ch->rings[i]);
+		}
+	}
+
+	if (count > 0) {
+		return SPDK_POLLER_BUSY;
+	} else {
+		return SPDK_POLLER_IDLE;
+	}
 }
 
-static int
-bdev_uring_check_zoned_support(struct bdev_uring *uring, const char *name, const char *filename)
+static void
+bdev_uring_nvme_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
 {
-	return 0;
+	struct bdev_uring_io_channel *uring_ch = spdk_io_channel_get_ctx(ch);
+	struct bdev_uring *uring = bdev_io->bdev->ctxt;
+	uint8_t opc;
+	int rc;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		opc = SPDK_NVME_OPC_READ;
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		opc = SPDK_NVME_OPC_WRITE;
+		break;
+	case SPDK_BDEV_IO_TYPE_COMPARE:
+		opc = SPDK_NVME_OPC_COMPARE;
+		break;
+	case SPDK_BDEV_IO_TYPE_ZONE_APPEND:
+		opc = SPDK_NVME_OPC_ZONE_APPEND;
+		break;
+	default:
+		SPDK_ERRLOG("Wrong io type\n");
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	rc = bdev_uring_nvme_rw(uring_ch->ring, uring, bdev_io, opc);
+	if (rc == -ENOMEM) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+	}
 }
-#endif
 
-static int
-_bdev_uring_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+static void
+bdev_uring_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io,
+		      bool success)
 {
+	int64_t ret = 0;
+
+	if (!success) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	if (bdev_uring_is_nvme(bdev_io->bdev->ctxt)) {
+		bdev_uring_nvme_get_buf_cb(ch, bdev_io);
+		return;
+	}
 
 	switch (bdev_io->type) {
-	case SPDK_BDEV_IO_TYPE_GET_ZONE_INFO:
-		return bdev_uring_zone_get_info(bdev_io);
-	case SPDK_BDEV_IO_TYPE_ZONE_MANAGEMENT:
-		return bdev_uring_zone_management_op(bdev_io);
-	/* Read and write operations must be performed on buffers aligned to
-	 * bdev->required_alignment. If user specified unaligned buffers,
-	 * get the aligned buffer from the pool by calling spdk_bdev_io_get_buf. */
 	case SPDK_BDEV_IO_TYPE_READ:
+		ret = bdev_uring_readv((struct bdev_uring *)bdev_io->bdev->ctxt,
+				       ch,
+				       (struct bdev_uring_task *)bdev_io->driver_ctx,
+				       bdev_io->u.bdev.iovs,
+				       bdev_io->u.bdev.iovcnt,
+				       bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen,
+				       bdev_io->u.bdev.offset_blocks * bdev_io->bdev->blocklen);
+		break;
 	case SPDK_BDEV_IO_TYPE_WRITE:
-		spdk_bdev_io_get_buf(bdev_io, bdev_uring_get_buf_cb,
-				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
-		return 0;
-	default:
-		return -1;
+		ret = bdev_uring_writev((struct bdev_uring *)bdev_io->bdev->ctxt,
+					ch,
+					(struct bdev_uring_task *)bdev_io->driver_ctx,
+					bdev_io->u.bdev.iovs,
+					bdev_io->u.bdev.iovcnt,
+					bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen,
+					bdev_io->u.bdev.offset_blocks * bdev_io->bdev->blocklen);
+		break;
+	default:
+		SPDK_ERRLOG("Wrong io type\n");
+		break;
+	}
+
+	if (ret == -ENOMEM) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+	}
+}
+
+#ifdef SPDK_CONFIG_URING_ZNS
+static int
+bdev_uring_fill_zone_type(struct spdk_bdev_zone_info *zone_info, struct blk_zone *zones_rep)
+{
+	switch (zones_rep->type) {
+	case BLK_ZONE_TYPE_CONVENTIONAL:
+		zone_info->type = SPDK_BDEV_ZONE_TYPE_CNV;
+		break;
+	case BLK_ZONE_TYPE_SEQWRITE_REQ:
+		zone_info->type = SPDK_BDEV_ZONE_TYPE_SEQWR;
+		break;
+	case BLK_ZONE_TYPE_SEQWRITE_PREF:
+		zone_info->type = SPDK_BDEV_ZONE_TYPE_SEQWP;
+		break;
+	default:
+		SPDK_ERRLOG("Invalid zone type: %#x in zone report\n", zones_rep->type);
+		return -EIO;
+	}
+	return 0;
+}
+
+static int
+bdev_uring_fill_zone_state(struct spdk_bdev_zone_info *zone_info, struct blk_zone *zones_rep)
+{
+	switch (zones_rep->cond) {
+	case BLK_ZONE_COND_EMPTY:
+		zone_info->state = SPDK_BDEV_ZONE_STATE_EMPTY;
+		break;
+	case BLK_ZONE_COND_IMP_OPEN:
+		zone_info->state = SPDK_BDEV_ZONE_STATE_IMP_OPEN;
+		break;
+	case BLK_ZONE_COND_EXP_OPEN:
+		zone_info->state = SPDK_BDEV_ZONE_STATE_EXP_OPEN;
+		break;
+	case BLK_ZONE_COND_CLOSED:
+		zone_info->state = SPDK_BDEV_ZONE_STATE_CLOSED;
+		break;
+	case BLK_ZONE_COND_READONLY:
+		zone_info->state = SPDK_BDEV_ZONE_STATE_READ_ONLY;
+		break;
+	case BLK_ZONE_COND_FULL:
+		zone_info->state = SPDK_BDEV_ZONE_STATE_FULL;
+		break;
+	case BLK_ZONE_COND_OFFLINE:
+		zone_info->state = SPDK_BDEV_ZONE_STATE_OFFLINE;
+		break;
+	case BLK_ZONE_COND_NOT_WP:
+		zone_info->state = SPDK_BDEV_ZONE_STATE_NOT_WP;
+		break;
+	default:
+		SPDK_ERRLOG("Invalid zone state: %#x in zone report\n", zones_rep->cond);
+		return -EIO;
+	}
+	return 0;
+}
+
+static int
+bdev_uring_zone_management_op(struct spdk_bdev_io *bdev_io)
+{
+	struct bdev_uring *uring;
+	struct blk_zone_range range;
+	long unsigned zone_mgmt_op;
+	uint64_t zone_id = bdev_io->u.zone_mgmt.zone_id;
+
+	uring = (struct bdev_uring *)bdev_io->bdev->ctxt;
+
+	switch (bdev_io->u.zone_mgmt.zone_action) {
+	case SPDK_BDEV_ZONE_RESET:
+		zone_mgmt_op = BLKRESETZONE;
+		break;
+	case SPDK_BDEV_ZONE_OPEN:
+		zone_mgmt_op = BLKOPENZONE;
+		break;
+	case SPDK_BDEV_ZONE_CLOSE:
+		zone_mgmt_op = BLKCLOSEZONE;
+		break;
+	case SPDK_BDEV_ZONE_FINISH:
+		zone_mgmt_op = BLKFINISHZONE;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	range.sector = (zone_id << uring->zd.lba_shift);
+	range.nr_sectors = (uring->bdev.zone_size << uring->zd.lba_shift);
+
+	if (ioctl(uring->fd, zone_mgmt_op, &range)) {
+		SPDK_ERRLOG("Ioctl BLKXXXZONE(%#x) failed errno: %d(%s)\n",
+			    bdev_io->u.zone_mgmt.zone_action, errno, strerror(errno));
+		return -EINVAL;
+	}
+
+	spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	return 0;
+}
+
+static int
+bdev_uring_zone_get_info(struct spdk_bdev_io *bdev_io)
+{
+	struct bdev_uring *uring;
+	struct blk_zone *zones;
+	struct blk_zone_report *rep;
+	struct spdk_bdev_zone_info *zone_info = bdev_io->u.zone_mgmt.buf;
+	size_t repsize;
+	uint32_t i, shift;
+	uint32_t num_zones = bdev_io->u.zone_mgmt.num_zones;
+	uint64_t zone_id = bdev_io->u.zone_mgmt.zone_id;
+
+	uring = (struct bdev_uring *)bdev_io->bdev->ctxt;
+	shift = uring->zd.lba_shift;
+
+	if ((num_zones > uring->zd.num_zones) || !num_zones) {
+		return -EINVAL;
+	}
+
+	repsize = sizeof(struct blk_zone_report) + (sizeof(struct blk_zone) * num_zones);
+	rep = (struct blk_zone_report *)malloc(repsize);
+	if (!rep) {
+		return -ENOMEM;
+	}
+
+	zones = (struct blk_zone *)(rep + 1);
+
+	while (num_zones && ((zone_id >> uring->zd.zone_shift) <= num_zones)) {
+		memset(rep, 0, repsize);
+		rep->sector = zone_id;
+		rep->nr_zones = num_zones;
+
+		if (ioctl(uring->fd, BLKREPORTZONE, rep)) {
+			SPDK_ERRLOG("Ioctl BLKREPORTZONE failed errno: %d(%s)\n",
+				    errno, strerror(errno));
+			free(rep);
+			return -EINVAL;
+		}
+
+		if (!rep->nr_zones) {
+			break;
+		}
+
+		for (i = 0; i < rep->nr_zones; i++) {
+			zone_info->zone_id = ((zones + i)->start >> shift);
+			zone_info->write_pointer = ((zones + i)->wp >> shift);
+			zone_info->capacity = ((zones + i)->capacity >> shift);
+
+			bdev_uring_fill_zone_state(zone_info, zones + i);
+			bdev_uring_fill_zone_type(zone_info, zones + i);
+
+			zone_id = ((zones + i)->start + (zones + i)->len) >> shift;
+			zone_info++;
+			num_zones--;
+		}
+	}
+
+	spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+	free(rep);
+	return 0;
+}
+
+static int
+bdev_uring_check_zoned_support(struct bdev_uring *uring, const char *name, const char *filename)
+{
+	char *filename_dup = NULL, *base;
+	char *str = NULL;
+	uint32_t val;
+	uint32_t zinfo;
+	int retval = -1;
+	struct stat sb;
+	char resolved_path[PATH_MAX], *rp;
+	char *sysfs_path = NULL;
+
+	uring->bdev.zoned = false;
+
+	/* Follow symlink */
+	if ((rp = realpath(filename, resolved_path))) {
+		filename = rp;
+	}
+
+	/* Perform check on block devices only */
+	if (stat(filename, &sb) == 0 && !S_ISBLK(sb.st_mode)) {
+		return 0;
+	}
+
+	/* strdup() because basename() may modify the passed parameter */
+	filename_dup = strdup(filename);
+	if (filename_dup == NULL) {
+		SPDK_ERRLOG("Could not duplicate string %s\n", filename);
+		return -1;
+	}
+
+	base = basename(filename_dup);
+	sysfs_path = spdk_sprintf_alloc("/sys/block/%s/queue/zoned", base);
+	retval = spdk_read_sysfs_attribute(&str, "%s", sysfs_path);
+	/* Check if this is a zoned block device */
+	if (retval < 0) {
+		SPDK_ERRLOG("Unable to open file %s. errno: %d\n", sysfs_path, retval);
+	} else if (strcmp(str, "host-aware") == 0 || strcmp(str, "host-managed") == 0) {
+		/* Only host-aware & host-managed zns devices */
+		uring->bdev.zoned = true;
+
+		if (ioctl(uring->fd, BLKGETNRZONES, &zinfo)) {
+			SPDK_ERRLOG("ioctl BLKNRZONES failed %d (%s)\n", errno, strerror(errno));
+			goto err_ret;
+		}
+		uring->zd.num_zones = zinfo;
+
+		if (ioctl(uring->fd, BLKGETZONESZ, &zinfo)) {
+			SPDK_ERRLOG("ioctl BLKGETZONESZ failed %d (%s)\n", errno, strerror(errno));
+			goto err_ret;
+		}
+
+		uring->zd.lba_shift = uring->bdev.required_alignment - SECTOR_SHIFT;
+		uring->bdev.zone_size = (zinfo >> uring->zd.lba_shift);
+		uring->zd.zone_shift = spdk_u32log2(zinfo >> uring->zd.lba_shift);
+
+		retval = spdk_read_sysfs_attribute_uint32(&val, "/sys/block/%s/queue/max_open_zones", base);
+		if (retval < 0) {
+			SPDK_ERRLOG("Failed to get max open zones %d (%s)\n", retval, strerror(-retval));
+			goto err_ret;
+		}
+		uring->bdev.max_open_zones = uring->bdev.optimal_open_zones = val;
+
+		retval = spdk_read_sysfs_attribute_uint32(&val, "/sys/block/%s/queue/max_active_zones", base);
+		if (retval < 0) {
+			SPDK_ERRLOG("Failed to get max active zones %d (%s)\n", retval, strerror(-retval));
+			goto err_ret;
+		}
+		uring->bdev.max_active_zones = val;
+		retval = 0;
+	} else {
+		retval = 0;        /* queue/zoned=none */
+	}
+err_ret:
+	free(str);
+	free(sysfs_path);
+	free(filename_dup);
+	return retval;
+}
+#else
+/* No support for zoned devices */
+static int
+bdev_uring_zone_management_op(struct spdk_bdev_io *bdev_io)
+{
+	return -1;
+}
+
+static int
+bdev_uring_zone_get_info(struct spdk_bdev_io *bdev_io)
+{
+	return -1;
+}
+
+static int
+bdev_uring_check_zoned_support(struct bdev_uring *uring, const char *name, const char *filename)
+{
+	return 0;
+}
+#endif
+
+static int
+bdev_uring_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	struct bdev_uring_io_channel *uring_ch = spdk_io_channel_get_ctx(ch);
+	struct bdev_uring *uring = bdev_io->bdev->ctxt;
+	int rc;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_COMPARE:
+	case SPDK_BDEV_IO_TYPE_ZONE_APPEND:
+		spdk_bdev_io_get_buf(bdev_io, bdev_uring_get_buf_cb,
+				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
+		return 0;
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		rc = bdev_uring_nvme_write_zeroes(uring_ch->ring, uring, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		rc = bdev_uring_nvme_unmap(uring_ch->ring, uring, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		rc = bdev_uring_nvme_flush(uring_ch->ring, uring, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_ZONE_MANAGEMENT:
+		rc = bdev_uring_nvme_zone_management(uring_ch->ring, uring, bdev_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_GET_ZONE_INFO:
+		rc = bdev_uring_nvme_get_zone_info(uring_ch->ring, uring, bdev_io);
+		break;
+	default:
+		return -1;
+	}
+
+	if (rc == -ENOMEM) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+		return 0;
+	}
+
+	return rc;
+}
+
+static int
+_bdev_uring_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	if (bdev_uring_is_nvme(bdev_io->bdev->ctxt)) {
+		return bdev_uring_nvme_submit_request(ch, bdev_io);
+	}
+
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_GET_ZONE_INFO:
+		return bdev_uring_zone_get_info(bdev_io);
+	case SPDK_BDEV_IO_TYPE_ZONE_MANAGEMENT:
+		return bdev_uring_zone_management_op(bdev_io);
+	/* Read and write operations must be performed on buffers aligned to
+	 * bdev->required_alignment. If user specified unaligned buffers,
+	 * get the aligned buffer from the pool by calling spdk_bdev_io_get_buf. */
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		spdk_bdev_io_get_buf(bdev_io, bdev_uring_get_buf_cb,
+				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
+		return 0;
+	default:
+		return -1;
+	}
+}
+
+static void
+bdev_uring_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	if (_bdev_uring_submit_request(ch, bdev_io) < 0) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+	}
+}
+
+static bool
+bdev_uring_nvme_io_type_supported(struct bdev_uring *uring, enum spdk_bdev_io_type io_type)
+{
+	switch (io_type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		return true;
+	case SPDK_BDEV_IO_TYPE_COMPARE:
+		/* Compare-and-write is emulated by the bdev layer using compare and write */
+		return uring->nvme.compare;
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		return uring->nvme.write_zeroes;
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		return uring->nvme.dsm;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		return uring->nvme.flush;
+	case SPDK_BDEV_IO_TYPE_ZONE_APPEND:
+	case SPDK_BDEV_IO_TYPE_GET_ZONE_INFO:
+	case SPDK_BDEV_IO_TYPE_ZONE_MANAGEMENT:
+		return uring->bdev.zoned;
+	default:
+		return false;
+	}
+}
+
+static bool
+bdev_uring_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
+{
+	struct bdev_uring *uring = ctx;
+
+	if (bdev_uring_is_nvme(uring)) {
+		return bdev_uring_nvme_io_type_supported(uring, io_type);
+	}
+
+	switch (io_type) {
+#ifdef SPDK_CONFIG_URING_ZNS
+	case SPDK_BDEV_IO_TYPE_GET_ZONE_INFO:
+	case SPDK_BDEV_IO_TYPE_ZONE_MANAGEMENT:
+#endif
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static int
+bdev_uring_ring_init(struct bdev_uring_ring *ring, uint32_t flags)
+{
+	struct io_uring_params params = {};
+	int rc;
+
+	if (flags & BDEV_URING_RING_IOPOLL) {
+		params.flags |= IORING_SETUP_IOPOLL;
+	}
+	if (flags & BDEV_URING_RING_SQPOLL) {
+		params.flags |= IORING_SETUP_SQPOLL;
+		params.sq_thread_idle = SPDK_URING_SQ_THREAD_IDLE_MS;
+	}
+	if (flags & BDEV_URING_RING_NVME) {
+		params.flags |= IORING_SETUP_SQE128 | IORING_SETUP_CQE32;
+	}
+
+	rc = io_uring_queue_init_params(SPDK_URING_QUEUE_DEPTH, &ring->uring, &params);
+	if (rc < 0) {
+		SPDK_ERRLOG("uring I/O context setup failure (flags: %#x): %s\n",
+			    params.flags, spdk_strerror(-rc));
+		return rc;
+	}
+
+	ring->initialized = true;
+
+	return 0;
+}
+
+static int
+bdev_uring_ring_register_files(struct bdev_uring_ring *ring)
+{
+	int fds[SPDK_URING_MAX_REGISTERED_FILES];
+	int i, rc;
+
+	/* Start with an empty table, the files are added as channels are created */
+	for (i = 0; i < SPDK_URING_MAX_REGISTERED_FILES; i++) {
+		fds[i] = -1;
+	}
+
+	rc = io_uring_register_files(&ring->uring, fds, SPDK_URING_MAX_REGISTERED_FILES);
+	if (rc < 0) {
+		SPDK_ERRLOG("Failed to register uring files: %s\n", spdk_strerror(-rc));
+		return rc;
+	}
+
+	ring->files_registered = true;
+
+	return 0;
+}
+
+static int
+bdev_uring_ring_register_buffers(struct bdev_uring_ring *ring)
+{
+	int rc;
+
+	pthread_mutex_lock(&g_uring_bufs.mutex);
+	rc = io_uring_register_buffers_sparse(&ring->uring, SPDK_URING_MAX_FIXED_BUFFERS);
+	if (rc < 0) {
+		SPDK_ERRLOG("Failed to register uring buffers: %s\n", spdk_strerror(-rc));
+		goto out;
+	}
+
+	rc = io_uring_register_buffers_update_tag(&ring->uring, 0, g_uring_bufs.iovs, NULL,
+			SPDK_URING_MAX_FIXED_BUFFERS);
+	if (rc < 0) {
+		SPDK_ERRLOG("Failed to update uring buffers: %s\n", spdk_strerror(-rc));
+		io_uring_unregister_buffers(&ring->uring);
+		goto out;
+	}
+
+	TAILQ_INSERT_TAIL(&g_uring_bufs.rings, ring, link);
+	ring->buffers_registered = true;
+	rc = 0;
+out:
+	pthread_mutex_unlock(&g_uring_bufs.mutex);
+	return rc;
+}
+
+static void
+bdev_uring_ring_fini(struct bdev_uring_ring *ring)
+{
+	if (!ring->initialized) {
+		return;
+	}
+
+	if (ring->buffers_registered) {
+		pthread_mutex_lock(&g_uring_bufs.mutex);
+		TAILQ_REMOVE(&g_uring_bufs.rings, ring, link);
+		pthread_mutex_unlock(&g_uring_bufs.mutex);
+	}
+
+	/* This also drops the registered files and buffers */
+	io_uring_queue_exit(&ring->uring);
+	ring->initialized = false;
+	ring->files_registered = false;
+	ring->buffers_registered = false;
+}
+
+static int
+bdev_uring_create_cb(void *io_device, void *ctx_buf)
+{
+	struct bdev_uring *uring = io_device;
+	struct bdev_uring_io_channel *ch = ctx_buf;
+	struct bdev_uring_ring *ring;
+	int rc;
+
+	ch->group_ch = spdk_io_channel_get_ctx(spdk_get_io_channel(&uring_if));
+	ring = &ch->group_ch->rings[uring->ring_flags];
+
+	if (!ring->initialized) {
+		rc = bdev_uring_ring_init(ring, uring->ring_flags);
+		if (rc != 0) {
+			goto err;
+		}
+	}
+
+	if (uring->fixed_buffers && !ring->buffers_registered) {
+		rc = bdev_uring_ring_register_buffers(ring);
+		if (rc != 0) {
+			goto err;
+		}
+	}
+
+	if (uring->file_index >= 0) {
+		if (!ring->files_registered) {
+			rc = bdev_uring_ring_register_files(ring);
+			if (rc != 0) {
+				goto err;
+			}
+		}
+
+		rc = io_uring_register_files_update(&ring->uring, uring->file_index, &uring->fd, 1);
+		if (rc < 0) {
+			SPDK_ERRLOG("Failed to register file %s: %s\n", uring->filename,
+				    spdk_strerror(-rc));
+			goto err;
+		}
+	}
+
+	ch->ring = ring;
+
+	return 0;
+err:
+	spdk_put_io_channel(spdk_io_channel_from_ctx(ch->group_ch));
+	return rc;
+}
+
+static void
+bdev_uring_destroy_cb(void *io_device, void *ctx_buf)
+{
+	struct bdev_uring *uring = io_device;
+	struct bdev_uring_io_channel *ch = ctx_buf;
+	int fd = -1;
+
+	if (uring->file_index >= 0) {
+		io_uring_register_files_update(&ch->ring->uring, uring->file_index, &fd, 1);
+	}
+
+	spdk_put_io_channel(spdk_io_channel_from_ctx(ch->group_ch));
+}
+
+static struct spdk_io_channel *
+bdev_uring_get_io_channel(void *ctx)
+{
+	struct bdev_uring *uring = ctx;
+
+	return spdk_get_io_channel(uring);
+}
+
+static int
+bdev_uring_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
+{
+	struct bdev_uring *uring = ctx;
+
+	spdk_json_write_named_object_begin(w, "uring");
+
+	spdk_json_write_named_string(w, "filename", uring->filename);
+	spdk_json_write_named_bool(w, "nvme_passthru", uring->nvme.nsid != 0);
+	spdk_json_write_named_bool(w, "registered_files", uring->file_index >= 0);
+	spdk_json_write_named_bool(w, "fixed_buffers", uring->fixed_buffers);
+	spdk_json_write_named_bool(w, "iopoll", uring->ring_flags & BDEV_URING_RING_IOPOLL);
+	spdk_json_write_named_bool(w, "sqpoll", uring->ring_flags & BDEV_URING_RING_SQPOLL);
+
+	spdk_json_write_object_end(w);
+
+	return 0;
+}
+
+static void
+bdev_uring_write_json_config(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
+{
+	struct bdev_uring *uring = bdev->ctxt;
+	char uuid_str[SPDK_UUID_STRING_LEN];
+
+	spdk_json_write_object_begin(w);
+
+	spdk_json_write_named_string(w, "method", "bdev_uring_create");
+
+	spdk_json_write_named_object_begin(w, "params");
+	spdk_json_write_named_string(w, "name", bdev->name);
+	spdk_json_write_named_uint32(w, "block_size", bdev->blocklen);
+	spdk_json_write_named_string(w, "filename", uring->filename);
+	spdk_uuid_fmt_lower(uuid_str, sizeof(uuid_str), &bdev->uuid);
+	spdk_json_write_named_string(w, "uuid", uuid_str);
+	spdk_json_write_named_bool(w, "registered_files", uring->file_index >= 0);
+	spdk_json_write_named_bool(w, "fixed_buffers", uring->fixed_buffers);
+	spdk_json_write_named_bool(w, "iopoll", uring->ring_flags & BDEV_URING_RING_IOPOLL);
+	spdk_json_write_named_bool(w, "sqpoll", uring->ring_flags & BDEV_URING_RING_SQPOLL);
+	spdk_json_write_object_end(w);
+
+	spdk_json_write_object_end(w);
+}
+
+static const struct spdk_bdev_fn_table uring_fn_table = {
+	.destruct		= bdev_uring_destruct,
+	.submit_request		= bdev_uring_submit_request,
+	.io_type_supported	= bdev_uring_io_type_supported,
+	.get_io_channel		= bdev_uring_get_io_channel,
+	.dump_info_json		= bdev_uring_dump_info_json,
+	.write_config_json	= bdev_uring_write_json_config,
+};
+
+static void
+uring_free_bdev(struct bdev_uring *uring)
+{
+	if (uring == NULL) {
+		return;
+	}
+	if (uring->file_index >= 0) {
+		g_uring_files[uring->file_index] = NULL;
+	}
+	free(uring->filename);
+	free(uring->bdev.name);
+	free(uring);
+}
+
+static int
+bdev_uring_group_create_cb(void *io_device, void *ctx_buf)
+{
+	struct bdev_uring_group_channel *ch = ctx_buf;
+
+	/* The rings are set up on first use, as only the bdevs know which setup flags they need.
+	 * IORING_SETUP_IOPOLL isn't used by default, as it's only supported by local devices
+	 * with poll queues, not by devices attached from a remote target. */
+	ch->poller = SPDK_POLLER_REGISTER(bdev_uring_group_poll, ch, 0);
+	return 0;
+}
+
+static void
+bdev_uring_group_destroy_cb(void *io_device, void *ctx_buf)
+{
+	struct bdev_uring_group_channel *ch = ctx_buf;
+	int i;
+
+	for (i = 0; i < BDEV_URING_NUM_RINGS; i++) {
+		bdev_uring_ring_fini(&ch->rings[i]);
+	}
+
+	spdk_poller_unregister(&ch->poller);
+}
+
+/* Propagate the change of a fixed buffer slot to all rings using fixed buffers */
+static int
+bdev_uring_bufs_update_rings(uint32_t index)
+{
+	struct bdev_uring_ring *ring;
+	struct iovec empty = {};
+	int rc;
+
+	TAILQ_FOREACH(ring, &g_uring_bufs.rings, link) {
+		rc = io_uring_register_buffers_update_tag(&ring->uring, index,
+				&g_uring_bufs.iovs[index], NULL, 1);
+		if (rc < 0) {
+			SPDK_ERRLOG("Failed to update uring buffer %" PRIu32 ": %s\n", index,
+				    spdk_strerror(-rc));
+			TAILQ_FOREACH(ring, &g_uring_bufs.rings, link) {
+				io_uring_register_buffers_update_tag(&ring->uring, index, &empty,
+								     NULL, 1);
+			}
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+static void
+bdev_uring_bufs_add(struct spdk_mem_map *map, uint64_t vaddr, uint64_t size)
+{
+	struct iovec *iov;
+	uint64_t len;
+	uint32_t index = 0;
+
+	while (size > 0) {
+		len = spdk_min(size, SPDK_URING_MAX_FIXED_BUFFER_SIZE);
+		for (; index < SPDK_URING_MAX_FIXED_BUFFERS; index++) {
+			if (g_uring_bufs.iovs[index].iov_base == NULL) {
+				break;
+			}
+		}
+
+		if (index == SPDK_URING_MAX_FIXED_BUFFERS) {
+			/* Not fatal, I/O to this memory simply won't use fixed buffers */
+			SPDK_NOTICELOG("Out of uring fixed buffers, memory %#" PRIx64 "-%#" PRIx64
+				       " won't be registered\n", vaddr, vaddr + size);
+			return;
+		}
+
+		iov = &g_uring_bufs.iovs[index];
+		iov->iov_base = (void *)vaddr;
+		iov->iov_len = len;
+		if (bdev_uring_bufs_update_rings(index) != 0) {
+			iov->iov_base = NULL;
+			iov->iov_len = 0;
+			return;
+		}
+
+		spdk_mem_map_set_translation(map, vaddr, len, index + 1);
+		vaddr += len;
+		size -= len;
+	}
+}
+
+static void
+bdev_uring_bufs_remove(struct spdk_mem_map *map, uint64_t vaddr, uint64_t size)
+{
+	struct iovec *iov;
+	uint64_t translation, len, end = vaddr + size;
+	uint64_t buf_start, buf_end;
+
+	while (vaddr < end) {
+		len = end - vaddr;
+		translation = spdk_mem_map_translate(map, vaddr, &len);
+		if (translation == 0) {
+			vaddr += len;
+			continue;
+		}
+
+		iov = &g_uring_bufs.iovs[translation - 1];
+		buf_start = (uint64_t)iov->iov_base;
+		buf_end = buf_start + iov->iov_len;
+		spdk_mem_map_clear_translation(map, buf_start, iov->iov_len);
+		iov->iov_base = NULL;
+		iov->iov_len = 0;
+		bdev_uring_bufs_update_rings(translation - 1);
+
+		/* Keep the parts of the buffer that are still registered */
+		if (buf_start < vaddr) {
+			bdev_uring_bufs_add(map, buf_start, vaddr - buf_start);
+		}
+		if (buf_end > end) {
+			bdev_uring_bufs_add(map, end, buf_end - end);
+		}
+
+		vaddr = spdk_min(buf_end, end);
 	}
 }
 
-static void
-bdev_uring_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+static int
+bdev_uring_mem_notify(void *cb_ctx, struct spdk_mem_map *map,
+		      enum spdk_mem_map_notify_action action,
+		      void *vaddr, size_t size)
 {
-	if (_bdev_uring_submit_request(ch, bdev_io) < 0) {
-		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+	pthread_mutex_lock(&g_uring_bufs.mutex);
+	switch (action) {
+	case SPDK_MEM_MAP_NOTIFY_REGISTER:
+		bdev_uring_bufs_add(map, (uint64_t)vaddr, size);
+		break;
+	case SPDK_MEM_MAP_NOTIFY_UNREGISTER:
+		bdev_uring_bufs_remove(map, (uint64_t)vaddr, size);
+		break;
+	default:
+		SPDK_UNREACHABLE();
 	}
+	pthread_mutex_unlock(&g_uring_bufs.mutex);
+
+	/* Never fail the registration, I/O to memory that isn't a fixed buffer still works */
+	return 0;
 }
 
-static bool
-bdev_uring_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
+static int
+bdev_uring_mem_check_contiguous(uint64_t translation_1, uint64_t translation_2)
 {
-	switch (io_type) {
-#ifdef SPDK_CONFIG_URING_ZNS
-	case SPDK_BDEV_IO_TYPE_GET_ZONE_INFO:
-	case SPDK_BDEV_IO_TYPE_ZONE_MANAGEMENT:
-#endif
-	case SPDK_BDEV_IO_TYPE_READ:
-	case SPDK_BDEV_IO_TYPE_WRITE:
-		return true;
-	default:
-		return false;
-	}
+	/* Pages of the same buffer translate to the same index */
+	return translation_1 == translation_2;
 }
 
+static const struct spdk_mem_map_ops g_uring_mem_map_ops = {
+	.notify_cb = bdev_uring_mem_notify,
+	.are_contiguous = bdev_uring_mem_check_contiguous,
+};
+
 static int
-bdev_uring_create_cb(void *io_device, void *ctx_buf)
+bdev_uring_bufs_init(void)
 {
-	struct bdev_uring_io_channel *ch = ctx_buf;
+	if (g_uring_bufs.map != NULL) {
+		return 0;
+	}
 
-	ch->group_ch = spdk_io_channel_get_ctx(spdk_get_io_channel(&uring_if));
+	g_uring_bufs.map = spdk_mem_map_alloc(0, &g_uring_mem_map_ops, NULL);
+	if (g_uring_bufs.map == NULL) {
+		SPDK_ERRLOG("Failed to allocate uring fixed buffers memory map\n");
+		return -ENOMEM;
+	}
 
 	return 0;
 }
 
-static void
-bdev_uring_destroy_cb(void *io_device, void *ctx_buf)
+static int
+bdev_uring_alloc_file_index(struct bdev_uring *uring)
 {
-	struct bdev_uring_io_channel *ch = ctx_buf;
-
-	spdk_put_io_channel(spdk_io_channel_from_ctx(ch->group_ch));
-}
+	int i;
 
-static struct spdk_io_channel *
-bdev_uring_get_io_channel(void *ctx)
-{
-	struct bdev_uring *uring = ctx;
+	for (i = 0; i < SPDK_URING_MAX_REGISTERED_FILES; i++) {
+		if (g_uring_files[i] == NULL) {
+			g_uring_files[i] = uring;
+			return i;
+		}
+	}
 
-	return spdk_get_io_channel(uring);
+	return -ENOSPC;
 }
 
+/* Get the name of the device's directory in /sys/block */
 static int
-bdev_uring_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
+bdev_uring_get_sysfs_name(struct bdev_uring *uring, char *name, size_t size)
 {
-	struct bdev_uring *uring = ctx;
+	char resolved_path[PATH_MAX], *filename;
+	char *filename_dup, *base;
+	uint32_t ctrlr_id, ns_id;
+	int rc = 0;
 
-	spdk_json_write_named_object_begin(w, "uring");
+	filename = realpath(uring->filename, resolved_path);
+	if (filename == NULL) {
+		filename = uring->filename;
+	}
 
-	spdk_json_write_named_string(w, "filename", uring->filename);
+	/* strdup() because basename() may modify the passed parameter */
+	filename_dup = strdup(filename);
+	if (filename_dup == NULL) {
+		return -ENOMEM;
+	}
 
-	spdk_json_write_object_end(w);
+	base = basename(filename_dup);
+	if (uring->nvme.nsid != 0) {
+		/* The generic char device ngXnY shares its queue with the block device nvmeXnY */
+		if (sscanf(base, "ng%" SCNu32 "n%" SCNu32, &ctrlr_id, &ns_id) != 2) {
+			rc = -ENODEV;
+		} else {
+			snprintf(name, size, "nvme%" PRIu32 "n%" PRIu32, ctrlr_id, ns_id);
+		}
+	} else {
+		snprintf(name, size, "%s", base);
+	}
 
-	return 0;
+	free(filename_dup);
+	return rc;
 }
 
-static void
-bdev_uring_write_json_config(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
+static int
+bdev_uring_check_iopoll_support(struct bdev_uring *uring)
 {
-	struct bdev_uring *uring = bdev->ctxt;
-	char uuid_str[SPDK_UUID_STRING_LEN];
-
-	spdk_json_write_object_begin(w);
+	char name[NAME_MAX + 1];
+	struct stat sb;
+	uint32_t val = 0;
+	int rc;
 
-	spdk_json_write_named_string(w, "method", "bdev_uring_create");
+	/* Polled I/O only works with O_DIRECT on block devices with poll queues, or with NVMe
+	 * passthrough commands on the generic char devices of such block devices */
+	if (uring->nvme.nsid == 0 &&
+	    (!(fcntl(uring->fd, F_GETFL) & O_DIRECT) || fstat(uring->fd, &sb) != 0 ||
+	     !S_ISBLK(sb.st_mode))) {
+		SPDK_ERRLOG("IOPOLL requires a block device opened with O_DIRECT (file: %s)\n",
+			    uring->filename);
+		return -ENOTSUP;
+	}
 
-	spdk_json_write_named_object_begin(w, "params");
-	spdk_json_write_named_string(w, "name", bdev->name);
-	spdk_json_write_named_uint32(w, "block_size", bdev->blocklen);
-	spdk_json_write_named_string(w, "filename", uring->filename);
-	spdk_uuid_fmt_lower(uuid_str, sizeof(uuid_str), &bdev->uuid);
-	spdk_json_write_named_string(w, "uuid", uuid_str);
-	spdk_json_write_object_end(w);
+	rc = bdev_uring_get_sysfs_name(uring, name, sizeof(name));
+	if (rc == 0) {
+		rc = spdk_read_sysfs_attribute_uint32(&val, "/sys/block/%s/queue/io_poll", name);
+	}
+	if (rc < 0 || val == 0) {
+		SPDK_ERRLOG("Device %s doesn't support polled I/O, check if poll queues are enabled "
+			    "(e.g. the nvme.poll_queues module parameter)\n", uring->filename);
+		return -ENOTSUP;
+	}
 
-	spdk_json_write_object_end(w);
+	return 0;
 }
 
-static const struct spdk_bdev_fn_table uring_fn_table = {
-	.destruct		= bdev_uring_destruct,
-	.submit_request		= bdev_uring_submit_request,
-	.io_type_supported	= bdev_uring_io_type_supported,
-	.get_io_channel		= bdev_uring_get_io_channel,
-	.dump_info_json		= bdev_uring_dump_info_json,
-	.write_config_json	= bdev_uring_write_json_config,
-};
-
-static void
-uring_free_bdev(struct bdev_uring *uring)
+static uint8_t
+bdev_uring_nvme_get_csi(struct bdev_uring *uring, void *buf)
 {
-	if (uring == NULL) {
-		return;
+	struct spdk_nvme_ns_id_desc *desc;
+	size_t offset = 0;
+
+	/* Not all controllers report the descriptors, assume NVM command set if they don't */
+	if (bdev_uring_nvme_identify(uring, SPDK_NVME_IDENTIFY_NS_ID_DESCRIPTOR_LIST,
+				     uring->nvme.nsid, 0, buf) != 0) {
+		return SPDK_NVME_CSI_NVM;
 	}
-	free(uring->filename);
-	free(uring->bdev.name);
-	free(uring);
+
+	while (offset + sizeof(*desc) < SPDK_NVME_IDENTIFY_BUFLEN) {
+		desc = (struct spdk_nvme_ns_id_desc *)((uint8_t *)buf + offset);
+		if (desc->nidl == 0) {
+			break;
+		}
+		if (desc->nidt == SPDK_NVME_NIDT_CSI) {
+			return desc->nid[0];
+		}
+		offset += sizeof(*desc) + desc->nidl;
+	}
+
+	return SPDK_NVME_CSI_NVM;
 }
 
 static int
-bdev_uring_group_create_cb(void *io_device, void *ctx_buf)
+bdev_uring_nvme_setup_zoned(struct bdev_uring *uring, uint32_t format, void *buf)
 {
-	struct bdev_uring_group_channel *ch = ctx_buf;
+	struct spdk_nvme_zns_ns_data *zns_nsdata = buf;
+	struct spdk_nvme_zns_ctrlr_data *zns_cdata = buf;
+	struct spdk_bdev *bdev = &uring->bdev;
+	int rc;
 
-	/* Do not use IORING_SETUP_IOPOLL until the Linux kernel can support not only
-	 * local devices but also devices attached from remote target */
-	if (io_uring_queue_init(SPDK_URING_QUEUE_DEPTH, &ch->uring, 0) < 0) {
-		SPDK_ERRLOG("uring I/O context setup failure\n");
-		return -1;
+	rc = bdev_uring_nvme_identify(uring, SPDK_NVME_IDENTIFY_NS_IOCS, uring->nvme.nsid,
+				      SPDK_NVME_CSI_ZNS, zns_nsdata);
+	if (rc != 0) {
+		return rc;
+	}
+
+	bdev->zoned = true;
+	bdev->zone_size = zns_nsdata->lbafe[format].zsze;
+	/* 0's based values, 0xffffffff (no limit) wraps to 0 */
+	bdev->max_open_zones = zns_nsdata->mor + 1;
+	bdev->max_active_zones = zns_nsdata->mar + 1;
+	bdev->optimal_open_zones = bdev->max_open_zones;
+
+	rc = bdev_uring_nvme_identify(uring, SPDK_NVME_IDENTIFY_CTRLR_IOCS, 0, SPDK_NVME_CSI_ZNS,
+				      zns_cdata);
+	if (rc != 0) {
+		return rc;
+	}
+
+	/* Like MDTS, ZASL is in units of the minimum memory page size, assume 4KiB */
+	if (zns_cdata->zasl != 0) {
+		bdev->max_zone_append_size = spdk_min((1ULL << zns_cdata->zasl) * 4096,
+						      uring->nvme.max_xfer_size) / bdev->blocklen;
+	} else {
+		bdev->max_zone_append_size = uring->nvme.max_xfer_size / bdev->blocklen;
 	}
 
-	ch->poller = SPDK_POLLER_REGISTER(bdev_uring_group_poll, ch, 0);
 	return 0;
 }
 
-static void
-bdev_uring_group_destroy_cb(void *io_device, void *ctx_buf)
+/* Set up a bdev backed by an NVMe generic char device, accessed with passthrough commands */
+static int
+bdev_uring_nvme_setup(struct bdev_uring *uring, uint32_t block_size)
 {
-	struct bdev_uring_group_channel *ch = ctx_buf;
+	struct spdk_bdev *bdev = &uring->bdev;
+	struct spdk_nvme_ctrlr_data *cdata;
+	struct spdk_nvme_ns_data *nsdata;
+	char name[NAME_MAX + 1];
+	uint32_t format, val;
+	uint8_t mdts;
+	void *buf;
+	int nsid, rc;
+
+	nsid = ioctl(uring->fd, NVME_IOCTL_ID);
+	if (nsid <= 0) {
+		SPDK_ERRLOG("%s is not an NVMe generic char device\n", uring->filename);
+		return -ENODEV;
+	}
+	uring->nvme.nsid = nsid;
 
-	io_uring_queue_exit(&ch->uring);
+	buf = calloc(1, SPDK_NVME_IDENTIFY_BUFLEN);
+	if (buf == NULL) {
+		return -ENOMEM;
+	}
 
-	spdk_poller_unregister(&ch->poller);
-}
+	cdata = buf;
+	rc = bdev_uring_nvme_identify(uring, SPDK_NVME_IDENTIFY_CTRLR, 0, 0, cdata);
+	if (rc != 0) {
+		goto out;
+	}
 
-struct spdk_bdev *
-create_uring_bdev(const struct bdev_uring_opts *opts)
-{
-	struct bdev_uring *uring;
-	uint32_t detected_block_size;
-	uint64_t bdev_size;
-	int rc;
-	uint32_t block_size = opts->block_size;
+	uring->nvme.compare = cdata->oncs.nvmcmps;
+	uring->nvme.write_zeroes = cdata->oncs.nvmwzsv;
+	uring->nvme.dsm = cdata->oncs.nvmdsmsv;
+	uring->nvme.flush = cdata->vwc.present;
+	bdev->write_cache = cdata->vwc.present;
+	mdts = cdata->mdts;
 
-	uring = calloc(1, sizeof(*uring));
-	if (!uring) {
-		SPDK_ERRLOG("Unable to allocate enough memory for uring backend\n");
-		return NULL;
+	nsdata = buf;
+	rc = bdev_uring_nvme_identify(uring, SPDK_NVME_IDENTIFY_NS, nsid, 0, nsdata);
+	if (rc != 0) {
+		goto out;
 	}
 
-	uring->filename = strdup(opts->filename);
-	if (!uring->filename) {
-		goto error_return;
+	format = nsdata->flbas.format;
+	if (nsdata->nlbaf > 16) {
+		format |= nsdata->flbas.msb_format << 4;
 	}
 
-	if (bdev_uring_open(uring)) {
-		SPDK_ERRLOG("Unable to open file %s. fd: %d errno: %d\n", opts->filename, uring->fd, errno);
-		goto error_return;
+	if (nsdata->dps.pit != 0) {
+		SPDK_ERRLOG("Namespaces formatted with protection information aren't supported "
+			    "(file: %s)\n", uring->filename);
+		rc = -ENOTSUP;
+		goto out;
 	}
 
-	bdev_size = spdk_fd_get_size(uring->fd);
+	bdev->blocklen = 1u << nsdata->lbaf[format].lbads;
+	bdev->required_alignment = nsdata->lbaf[format].lbads;
+	bdev->md_len = nsdata->lbaf[format].ms;
+	if (nsdata->flbas.extended) {
+		bdev->blocklen += bdev->md_len;
+		bdev->md_interleave = true;
+	}
+	bdev->blockcnt = nsdata->nsze;
 
-	uring->bdev.name = strdup(opts->name);
-	if (!uring->bdev.name) {
-		goto error_return;
+	if (block_size != 0 && block_size != bdev->blocklen) {
+		SPDK_ERRLOG("Specified block size %" PRIu32 " does not match namespace's "
+			    "block size %" PRIu32 "\n", block_size, bdev->blocklen);
+		rc = -EINVAL;
+		goto out;
 	}
-	uring->bdev.product_name = "URING bdev";
-	uring->bdev.module = &uring_if;
 
-	uring->bdev.write_cache = 0;
+	/* Passthrough commands can't be split by the kernel, so its limits apply as is */
+	if (bdev_uring_get_sysfs_name(uring, name, sizeof(name)) == 0 &&
+	    spdk_read_sysfs_attribute_uint32(&val, "/sys/block/%s/queue/max_hw_sectors_kb",
+					     name) == 0) {
+		uring->nvme.max_xfer_size = val * 1024;
+		if (spdk_read_sysfs_attribute_uint32(&val, "/sys/block/%s/queue/max_segments",
+						     name) == 0) {
+			bdev->max_num_segments = val;
+		}
+	} else if (mdts != 0) {
+		uring->nvme.max_xfer_size = spdk_min((1ULL << mdts) * 4096, UINT32_MAX / 2 + 1);
+	} else {
+		uring->nvme.max_xfer_size = SPDK_URING_NVME_DEFAULT_MAX_XFER_SIZE;
+	}
+	if (bdev->max_num_segments == 0) {
+		bdev->max_num_segments = SPDK_URING_NVME_DEFAULT_MAX_SEGMENTS;
+	}
+
+	bdev->max_rw_size = uring->nvme.max_xfer_size / bdev->blocklen;
+	/* Number of logical blocks is a 0's based 16-bit value */
+	bdev->max_write_zeroes = UINT16_MAX + 1;
+	bdev->max_unmap = SPDK_NVME_DATASET_MANAGEMENT_RANGE_MAX_BLOCKS;
+	bdev->max_unmap_segments = 1;
+
+	if (bdev_uring_nvme_get_csi(uring, buf) == SPDK_NVME_CSI_ZNS) {
+		rc = bdev_uring_nvme_setup_zoned(uring, format, buf);
+	}
+out:
+	free(buf);
+	return rc;
+}
+
+static int
+bdev_uring_setup_blkdev(struct bdev_uring *uring, uint32_t block_size)
+{
+	uint32_t detected_block_size;
+	uint64_t bdev_size;
+	int rc;
+
+	bdev_size = spdk_fd_get_size(uring->fd);
 
 	detected_block_size = spdk_fd_get_blocklen(uring->fd);
 	if (block_size == 0) {
 		/* User did not specify block size - use autodetected block size. */
 		if (detected_block_size == 0) {
 			SPDK_ERRLOG("Block size could not be auto-detected\n");
-			goto error_return;
+			return -EINVAL;
 		}
 		block_size = detected_block_size;
 	} else {
@@ -816,7 +2027,7 @@ create_uring_bdev(const struct bdev_uring_opts *opts)
 			SPDK_ERRLOG("Specified block size %" PRIu32 " is smaller than "
 				    "auto-detected block size %" PRIu32 "\n",
 				    block_size, detected_block_size);
-			goto error_return;
+			return -EINVAL;
 		} else if (detected_block_size != 0 && block_size != detected_block_size) {
 			SPDK_WARNLOG("Specified block size %" PRIu32 " does not match "
 				     "auto-detected block size %" PRIu32 "\n",
@@ -826,29 +2037,108 @@ create_uring_bdev(const struct bdev_uring_opts *opts)
 
 	if (block_size < 512) {
 		SPDK_ERRLOG("Invalid block size %" PRIu32 " (must be at least 512).\n", block_size);
-		goto error_return;
+		return -EINVAL;
 	}
 
 	if (!spdk_u32_is_pow2(block_size)) {
 		SPDK_ERRLOG("Invalid block size %" PRIu32 " (must be a power of 2.)\n", block_size);
-		goto error_return;
+		return -EINVAL;
 	}
 
 	uring->bdev.blocklen = block_size;
 	uring->bdev.required_alignment = spdk_u32log2(block_size);
 
-	rc = bdev_uring_check_zoned_support(uring, opts->name, opts->filename);
+	rc = bdev_uring_check_zoned_support(uring, uring->bdev.name, uring->filename);
 	if (rc) {
-		goto error_return;
+		return -EINVAL;
 	}
 
 	if (bdev_size % uring->bdev.blocklen != 0) {
 		SPDK_ERRLOG("Disk size %" PRIu64 " is not a multiple of block size %" PRIu32 "\n",
 			    bdev_size, uring->bdev.blocklen);
-		goto error_return;
+		return -EINVAL;
 	}
 
 	uring->bdev.blockcnt = bdev_size / uring->bdev.blocklen;
+
+	return 0;
+}
+
+struct spdk_bdev *
+create_uring_bdev(const struct bdev_uring_opts *opts)
+{
+	struct bdev_uring *uring;
+	struct stat sb;
+	int rc;
+	uint32_t block_size = opts->block_size;
+
+	uring = calloc(1, sizeof(*uring));
+	if (!uring) {
+		SPDK_ERRLOG("Unable to allocate enough memory for uring backend\n");
+		return NULL;
+	}
+
+	uring->file_index = -1;
+	uring->filename = strdup(opts->filename);
+	if (!uring->filename) {
+		goto error_return;
+	}
+
+	if (bdev_uring_open(uring)) {
+		SPDK_ERRLOG("Unable to open file %s. fd: %d errno: %d\n", opts->filename, uring->fd, errno);
+		goto error_return;
+	}
+
+	if (opts->registered_files) {
+		rc = bdev_uring_alloc_file_index(uring);
+		if (rc < 0) {
+			SPDK_ERRLOG("Too many uring bdevs with registered files (max %d)\n",
+				    SPDK_URING_MAX_REGISTERED_FILES);
+			goto error_return;
+		}
+		uring->file_index = rc;
+	}
+
+	if (opts->fixed_buffers) {
+		if (bdev_uring_bufs_init() != 0) {
+			goto error_return;
+		}
+		uring->fixed_buffers = true;
+	}
+
+	uring->bdev.name = strdup(opts->name);
+	if (!uring->bdev.name) {
+		goto error_return;
+	}
+	uring->bdev.product_name = "URING bdev";
+	uring->bdev.module = &uring_if;
+
+	uring->bdev.write_cache = 0;
+
+	if (fstat(uring->fd, &sb) == 0 && S_ISCHR(sb.st_mode)) {
+		rc = bdev_uring_nvme_setup(uring, block_size);
+		if (rc != 0) {
+			goto error_return;
+		}
+		uring->ring_flags |= BDEV_URING_RING_NVME;
+	} else {
+		rc = bdev_uring_setup_blkdev(uring, block_size);
+		if (rc != 0) {
+			goto error_return;
+		}
+	}
+
+	if (opts->iopoll) {
+		if (bdev_uring_check_iopoll_support(uring) != 0) {
+			goto error_return;
+		}
+		uring->ring_flags |= BDEV_URING_RING_IOPOLL;
+	}
+
+	if (opts->sqpoll) {
+		uring->ring_flags |= BDEV_URING_RING_SQPOLL;
+	}
+
 	uring->bdev.ctxt = uring;
 
 	uring->bdev.fn_table = &uring_fn_table;
@@ -922,6 +2212,7 @@ static void
 bdev_uring_fini(void)
 {
 	spdk_io_device_unregister(&uring_if, NULL);
+	spdk_mem_map_free(&g_uring_bufs.map);
 }
 
 SPDK_LOG_REGISTER_COMPONENT(uring)
@@ -20,6 +20,14 @@ struct bdev_uring_opts {
 	const char *filename;
 	uint32_t block_size;
 	struct spdk_uuid uuid;
+	/* Submit I/O through the ring's registered file table */
+	bool registered_files;
+	/* Use READ_FIXED/WRITE_FIXED for buffers within registered SPDK memory */
+	bool fixed_buffers;
+	/* Poll for completions instead of relying on interrupts (requires poll queues) */
+	bool iopoll;
+	/* Let a kernel thread poll the submission queue */
+	bool sqpoll;
 };
 
 struct spdk_bdev *create_uring_bdev(const struct bdev_uring_opts *opts);
@@ -15,6 +15,10 @@ struct rpc_create_uring {
 	char *filename;
 	uint32_t block_size;
 	struct spdk_uuid uuid;
+	bool registered_files;
+	bool fixed_buffers;
+	bool iopoll;
+	bool sqpoll;
 };
 
 /* Free the allocated memory resource after the RPC handling. */
@@ -31,6 +35,16 @@ static const struct spdk_json_object_decoder rpc_bdev_uring_create_decoders[] =
 	{"filename", offsetof(struct rpc_create_uring, filename), spdk_json_decode_string},
 	{"block_size", offsetof(struct rpc_create_uring, block_size), spdk_json_decode_uint32, true},
 	{"uuid", offsetof(struct rpc_create_uring, uuid), spdk_json_decode_uuid, true},
+	{
+		"registered_files", offsetof(struct rpc_create_uring, registered_files),
+		spdk_json_decode_bool, true
+	},
+	{
+		"fixed_buffers", offsetof(struct rpc_create_uring, fixed_buffers),
+		spdk_json_decode_bool, true
+	},
+	{"iopoll", offsetof(struct rpc_create_uring, iopoll), spdk_json_decode_bool, true},
+	{"sqpoll", offsetof(struct rpc_create_uring, sqpoll), spdk_json_decode_bool, true},
 };
 
 /* Decode the parameters for this RPC method and properly create the uring
@@ -58,6 +72,10 @@ rpc_bdev_uring_create(struct spdk_jsonrpc_request *request,
 	opts.filename = req.filename;
 	opts.name = req.name;
 	opts.uuid = req.uuid;
+	opts.registered_files = req.registered_files;
+	opts.fixed_buffers = req.fixed_buffers;
+	opts.iopoll = req.iopoll;
+	opts.sqpoll = req.sqpoll;
 
 	bdev = create_uring_bdev(&opts);
 	if (!bdev) {
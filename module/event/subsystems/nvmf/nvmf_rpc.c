@@ -240,6 +240,7 @@ static const struct spdk_json_object_decoder rpc_nvmf_set_config_decoders[] = {
 	{"discovery_filter", offsetof(struct spdk_nvmf_tgt_conf, opts.discovery_filter), decode_discovery_filter, true},
 	{"dhchap_digests", offsetof(struct spdk_nvmf_tgt_conf, opts.dhchap_digests), decode_digest_array, true},
 	{"dhchap_dhgroups", offsetof(struct spdk_nvmf_tgt_conf, opts.dhchap_dhgroups), decode_dhgroup_array, true},
+	{"qpair_balance_threshold", offsetof(struct spdk_nvmf_tgt_conf, opts.qpair_balance_threshold), spdk_json_decode_uint32, true},
 };
 
 static void
@@ -260,6 +261,12 @@ rpc_nvmf_set_config(struct spdk_jsonrpc_request *request,
 		}
 	}
 
+	if (conf.opts.qpair_balance_threshold > 100) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 "qpair_balance_threshold must be a percentage");
+		return;
+	}
+
 	memcpy(&g_spdk_nvmf_tgt_conf, &conf, sizeof(conf));
 
 	spdk_jsonrpc_send_bool_response(request, true);
@@ -47,7 +47,7 @@ struct nvmf_tgt_poll_group {
 
 struct spdk_nvmf_tgt_conf g_spdk_nvmf_tgt_conf = {
 	.opts = {
-		.size = SPDK_SIZEOF(&g_spdk_nvmf_tgt_conf.opts, dhchap_dhgroups),
+		.size = SPDK_SIZEOF(&g_spdk_nvmf_tgt_conf.opts, qpair_balance_threshold),
 		.name = "nvmf_tgt",
 		.max_subsystems = 0,
 		.crdt = { 0, 0, 0 },
@@ -927,6 +927,8 @@ nvmf_subsystem_write_config_json(struct spdk_json_write_ctx *w)
 		}
 	}
 	spdk_json_write_array_end(w);
+	spdk_json_write_named_uint32(w, "qpair_balance_threshold",
+				     g_spdk_nvmf_tgt_conf.opts.qpair_balance_threshold);
 	spdk_json_write_object_end(w);
 	spdk_json_write_object_end(w);
 
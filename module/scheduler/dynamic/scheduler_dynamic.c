@@ -20,6 +20,7 @@ struct core_stats {
 	uint64_t busy;
 	uint64_t idle;
 	uint32_t thread_count;
+	int32_t numa_id;
 	bool isolated;
 };
 
@@ -28,6 +29,12 @@ static struct core_stats *g_cores;
 uint8_t g_scheduler_load_limit = 20;
 uint8_t g_scheduler_core_limit = 80;
 uint8_t g_scheduler_core_busy = 95;
+bool g_scheduler_numa_affinity = true;
+
+/* Placement of active threads with a NUMA affinity */
+static uint64_t g_numa_local_moves;
+static uint64_t g_numa_remote_moves;
+static uint32_t g_numa_remote_threads;
 
 static uint8_t
 _busy_pct(uint64_t busy, uint64_t idle)
@@ -177,6 +184,16 @@ _is_core_at_limit(uint32_t core_id)
 	return true;
 }
 
+static bool
+_is_core_in_numa(uint32_t core_id, int32_t numa_id)
+{
+	int32_t core_numa_id = g_cores[core_id].numa_id;
+
+	/* Threads and cores without a known NUMA node match any node. */
+	return numa_id == SPDK_ENV_NUMA_ID_ANY || core_numa_id == SPDK_ENV_NUMA_ID_ANY ||
+	       core_numa_id == numa_id;
+}
+
 static bool
 _can_core_fit_thread(struct spdk_scheduler_thread_info *thread_info, uint32_t dst_core)
 {
@@ -212,8 +229,11 @@ _can_core_fit_thread(struct spdk_scheduler_thread_info *thread_info, uint32_t ds
 	return _busy_pct(new_busy_tsc, new_idle_tsc) < g_scheduler_core_limit;
 }
 
+/* Find the best core of the NUMA node for the thread.  If the thread is not on a core of the
+ * node and none of them can fit it, the current core is returned.
+ */
 static uint32_t
-_find_optimal_core(struct spdk_scheduler_thread_info *thread_info)
+_find_optimal_core_in_numa(struct spdk_scheduler_thread_info *thread_info, int32_t numa_id)
 {
 	uint32_t i;
 	uint32_t current_lcore = thread_info->lcore;
@@ -221,6 +241,7 @@ _find_optimal_core(struct spdk_scheduler_thread_info *thread_info)
 	struct spdk_thread *thread;
 	struct spdk_cpuset *cpumask;
 	bool core_at_limit = _is_core_at_limit(current_lcore);
+	bool current_in_numa = _is_core_in_numa(current_lcore, numa_id);
 
 	thread = spdk_thread_get_by_id(thread_info->thread_id);
 	if (thread == NULL) {
@@ -240,6 +261,11 @@ _find_optimal_core(struct spdk_scheduler_thread_info *thread_info)
 			continue;
 		}
 
+		/* Skip cores of other NUMA nodes. */
+		if (!_is_core_in_numa(i, numa_id)) {
+			continue;
+		}
+
 		/* Search for least busy core. */
 		if (g_cores[i].busy < g_cores[least_busy_lcore].busy) {
 			least_busy_lcore = i;
@@ -249,7 +275,10 @@ _find_optimal_core(struct spdk_scheduler_thread_info *thread_info)
 		if (!_can_core_fit_thread(thread_info, i) || i == current_lcore) {
 			continue;
 		}
-		if (i == g_main_lcore) {
+		if (!current_in_numa) {
+			/* Thread runs away from its NUMA node, any core of the node is better. */
+			return i;
+		} else if (i == g_main_lcore) {
 			/* First consider g_main_lcore, consolidate threads on main lcore if possible. */
 			return i;
 		} else if (i < current_lcore && current_lcore != g_main_lcore) {
@@ -263,7 +292,7 @@ _find_optimal_core(struct spdk_scheduler_thread_info *thread_info)
 
 	/* For cores over the limit, place the thread on least busy core
 	 * to balance threads. */
-	if (core_at_limit) {
+	if (core_at_limit && current_in_numa) {
 		return least_busy_lcore;
 	}
 
@@ -271,10 +300,30 @@ _find_optimal_core(struct spdk_scheduler_thread_info *thread_info)
 	return current_lcore;
 }
 
+static uint32_t
+_find_optimal_core(struct spdk_scheduler_thread_info *thread_info)
+{
+	uint32_t target_lcore;
+
+	if (g_scheduler_numa_affinity && thread_info->numa_id != SPDK_ENV_NUMA_ID_ANY) {
+		/* Keep the thread on the NUMA node of the resources it serves, unless no core
+		 * of that node can fit it. */
+		target_lcore = _find_optimal_core_in_numa(thread_info, thread_info->numa_id);
+		if (_is_core_in_numa(target_lcore, thread_info->numa_id)) {
+			return target_lcore;
+		}
+	}
+
+	return _find_optimal_core_in_numa(thread_info, SPDK_ENV_NUMA_ID_ANY);
+}
+
 static int
 init(void)
 {
 	g_main_lcore = spdk_scheduler_get_scheduling_lcore();
+	g_numa_local_moves = 0;
+	g_numa_remote_moves = 0;
+	g_numa_remote_threads = 0;
 
 	if (spdk_governor_set("dpdk_governor") != 0) {
 		SPDK_NOTICELOG("Unable to initialize dpdk governor\n");
@@ -318,6 +367,16 @@ _balance_active(struct spdk_scheduler_thread_info *thread_info)
 
 	/* This thread is active. */
 	target_lcore = _find_optimal_core(thread_info);
+	if (thread_info->numa_id != SPDK_ENV_NUMA_ID_ANY) {
+		if (!_is_core_in_numa(target_lcore, thread_info->numa_id)) {
+			g_numa_remote_threads++;
+			if (target_lcore != thread_info->lcore) {
+				g_numa_remote_moves++;
+			}
+		} else if (target_lcore != thread_info->lcore) {
+			g_numa_local_moves++;
+		}
+	}
 	_move_thread(thread_info, target_lcore);
 }
 
@@ -339,9 +398,11 @@ balance(struct spdk_scheduler_core_info *cores_info, uint32_t cores_count)
 		g_cores[i].busy = cores_info[i].current_busy_tsc;
 		g_cores[i].idle = cores_info[i].current_idle_tsc;
 		g_cores[i].isolated = cores_info[i].isolated;
+		g_cores[i].numa_id = spdk_env_get_numa_id(i);
 		SPDK_DTRACE_PROBE2(dynsched_core_info, i, &cores_info[i]);
 	}
 	main_core = &g_cores[g_main_lcore];
+	g_numa_remote_threads = 0;
 
 	/* Distribute threads in two passes, to make sure updated core stats are considered on each pass.
 	 * 1) Move all idle threads to main core. */
@@ -399,12 +460,17 @@ struct json_scheduler_opts {
 	uint8_t load_limit;
 	uint8_t core_limit;
 	uint8_t core_busy;
+	bool numa_affinity;
 };
 
 static const struct spdk_json_object_decoder sched_decoders[] = {
 	{"load_limit", offsetof(struct json_scheduler_opts, load_limit), spdk_json_decode_uint8, true},
 	{"core_limit", offsetof(struct json_scheduler_opts, core_limit), spdk_json_decode_uint8, true},
 	{"core_busy", offsetof(struct json_scheduler_opts, core_busy), spdk_json_decode_uint8, true},
+	{
+		"numa_affinity", offsetof(struct json_scheduler_opts, numa_affinity),
+		spdk_json_decode_bool, true
+	},
 };
 
 static int
@@ -415,6 +481,7 @@ set_opts(const struct spdk_json_val *opts)
 	scheduler_opts.load_limit = g_scheduler_load_limit;
 	scheduler_opts.core_limit = g_scheduler_core_limit;
 	scheduler_opts.core_busy = g_scheduler_core_busy;
+	scheduler_opts.numa_affinity = g_scheduler_numa_affinity;
 
 	if (opts != NULL) {
 		if (spdk_json_decode_object_relaxed(opts, sched_decoders,
@@ -430,6 +497,9 @@ set_opts(const struct spdk_json_val *opts)
 	g_scheduler_core_limit = scheduler_opts.core_limit;
 	SPDK_NOTICELOG("Setting scheduler core busy to %d\n", scheduler_opts.core_busy);
 	g_scheduler_core_busy = scheduler_opts.core_busy;
+	SPDK_NOTICELOG("Setting scheduler NUMA affinity to %s\n",
+		       scheduler_opts.numa_affinity ? "enabled" : "disabled");
+	g_scheduler_numa_affinity = scheduler_opts.numa_affinity;
 
 	return 0;
 }
@@ -440,6 +510,12 @@ get_opts(struct spdk_json_write_ctx *ctx)
 	spdk_json_write_named_uint8(ctx, "load_limit", g_scheduler_load_limit);
 	spdk_json_write_named_uint8(ctx, "core_limit", g_scheduler_core_limit);
 	spdk_json_write_named_uint8(ctx, "core_busy", g_scheduler_core_busy);
+	spdk_json_write_named_bool(ctx, "numa_affinity", g_scheduler_numa_affinity);
+	spdk_json_write_named_object_begin(ctx, "numa_stats");
+	spdk_json_write_named_uint64(ctx, "local_moves", g_numa_local_moves);
+	spdk_json_write_named_uint64(ctx, "remote_moves", g_numa_remote_moves);
+	spdk_json_write_named_uint32(ctx, "remote_threads", g_numa_remote_threads);
+	spdk_json_write_object_end(ctx);
 }
 
 static struct spdk_scheduler scheduler_dynamic = {
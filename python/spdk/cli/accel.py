@@ -84,6 +84,28 @@ def add_parser(subparsers):
     p.add_argument('--buf-count', type=int, help='Maximum number of buffers per IO channel')
     p.set_defaults(func=accel_set_options)
 
+    def accel_sw_set_options(args):
+        args.client.accel_sw_set_options(num_workers=args.num_workers,
+                                         cpumask=args.cpumask)
+
+    p = subparsers.add_parser('accel_sw_set_options',
+                              help='Set software accel module\'s options')
+    p.add_argument('-n', '--num-workers', type=int, required=True,
+                   help='Number of worker threads used to offload large operations')
+    p.add_argument('-m', '--cpumask', help='CPU mask the worker threads are allowed to run on')
+    p.set_defaults(func=accel_sw_set_options)
+
+    def accel_sw_set_offload_threshold(args):
+        args.client.accel_sw_set_offload_threshold(opname=args.opname,
+                                                   threshold=args.threshold)
+
+    p = subparsers.add_parser('accel_sw_set_offload_threshold',
+                              help='Set the minimum size of an operation offloaded to software '
+                              'accel module\'s worker threads')
+    p.add_argument('opname', help='Operation name')
+    p.add_argument('threshold', type=int, help='Threshold in bytes (0 disables offload)')
+    p.set_defaults(func=accel_sw_set_offload_threshold)
+
     def accel_get_stats(args):
         print_dict(args.client.accel_get_stats())
 
@@ -69,6 +69,7 @@ def add_parser(subparsers):
                                         load_limit=args.load_limit,
                                         core_limit=args.core_limit,
                                         core_busy=args.core_busy,
+                                        numa_affinity=args.numa_affinity,
                                         mappings=args.mappings)
 
     p = subparsers.add_parser(
@@ -78,6 +79,8 @@ def add_parser(subparsers):
     p.add_argument('--load-limit', help="Scheduler load limit. Reserved for dynamic scheduler", type=int)
     p.add_argument('--core-limit', help="Scheduler core limit. Reserved for dynamic scheduler", type=int)
     p.add_argument('--core-busy', help="Scheduler core busy limit. Reserved for dynamic scheduler", type=int)
+    p.add_argument('--numa-affinity', action=argparse.BooleanOptionalAction,
+                   help="Keep threads on the NUMA node of the resources they serve. Reserved for dynamic scheduler")
     p.add_argument('--mappings', help="Comma-separated list of thread:core mappings. Reserved for static scheduler")
     p.set_defaults(func=framework_set_scheduler)
 
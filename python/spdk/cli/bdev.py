@@ -189,6 +189,12 @@ def add_parser(subparsers):
     p.add_argument('name', help='Name of OCF bdev')
     p.set_defaults(func=bdev_ocf_flush_status)
 
+    def bdev_ocf_get_lock_stats(args):
+        print_json(args.client.bdev_ocf_get_lock_stats())
+    p = subparsers.add_parser('bdev_ocf_get_lock_stats',
+                              help='Get acquisition and contention statistics of OCF locks')
+    p.set_defaults(func=bdev_ocf_get_lock_stats)
+
     def bdev_malloc_create(args):
         num_blocks = (args.total_size * 1024 * 1024) // args.block_size
         print_json(args.client.bdev_malloc_create(
@@ -332,13 +338,25 @@ def add_parser(subparsers):
                                               filename=args.filename,
                                               name=args.name,
                                               block_size=args.block_size,
-                                              uuid=args.uuid))
+                                              uuid=args.uuid,
+                                              registered_files=args.registered_files,
+                                              fixed_buffers=args.fixed_buffers,
+                                              iopoll=args.iopoll,
+                                              sqpoll=args.sqpoll))
 
     p = subparsers.add_parser('bdev_uring_create', help='Create a bdev with io_uring backend')
     p.add_argument('filename', help='Path to device or file (ex: /dev/nvme0n1)')
     p.add_argument('name', help='bdev name')
     p.add_argument('block_size', help='Block size for this bdev', type=int, nargs='?')
     p.add_argument('-u', '--uuid', help="UUID of the bdev")
+    p.add_argument('-r', '--registered-files', action='store_true',
+                   help='Submit I/O through the registered file table')
+    p.add_argument('-f', '--fixed-buffers', action='store_true',
+                   help='Use fixed buffers for I/O to registered SPDK memory')
+    p.add_argument('-p', '--iopoll', action='store_true',
+                   help='Poll for completions (requires O_DIRECT and device poll queues)')
+    p.add_argument('-s', '--sqpoll', action='store_true',
+                   help='Use a kernel thread to poll the submission queue')
     p.set_defaults(func=bdev_uring_create)
 
     def bdev_uring_rescan(args):
@@ -1132,6 +1150,78 @@ def add_parser(subparsers):
                    type=int)
     p.set_defaults(func=bdev_set_qos_limit)
 
+    def bdev_qos_group_create(args):
+        args.client.bdev_qos_group_create(
+                                       name=args.name,
+                                       rw_ios_per_sec=args.rw_ios_per_sec,
+                                       rw_mbytes_per_sec=args.rw_mbytes_per_sec,
+                                       r_mbytes_per_sec=args.r_mbytes_per_sec,
+                                       w_mbytes_per_sec=args.w_mbytes_per_sec,
+                                       latency_target_us=args.latency_target_us)
+
+    p = subparsers.add_parser('bdev_qos_group_create',
+                              help='Create a QoS group sharing rate limits across blockdevs')
+    p.add_argument('name', help='QoS group name. Example: tenant0')
+    p.add_argument('--rw-ios-per-sec',
+                   help='R/W IOs per second limit of the group (example: 100000). 0 means unlimited.',
+                   type=int)
+    p.add_argument('--rw-mbytes-per-sec',
+                   help="R/W megabytes per second limit of the group (example: 1000). 0 means unlimited.",
+                   type=int)
+    p.add_argument('--r-mbytes-per-sec',
+                   help="Read megabytes per second limit of the group (example: 500). 0 means unlimited.",
+                   type=int)
+    p.add_argument('--w-mbytes-per-sec',
+                   help="Write megabytes per second limit of the group (example: 500). 0 means unlimited.",
+                   type=int)
+    p.add_argument('--latency-target-us',
+                   help="p99 latency target in microseconds. The group's limits are lowered while it's exceeded.",
+                   type=int)
+    p.set_defaults(func=bdev_qos_group_create)
+
+    def bdev_qos_group_delete(args):
+        args.client.bdev_qos_group_delete(name=args.name)
+
+    p = subparsers.add_parser('bdev_qos_group_delete', help='Delete an empty QoS group')
+    p.add_argument('name', help='QoS group name')
+    p.set_defaults(func=bdev_qos_group_delete)
+
+    def bdev_qos_group_add_bdev(args):
+        args.client.bdev_qos_group_add_bdev(
+                                         group=args.group,
+                                         name=args.name,
+                                         weight=args.weight,
+                                         min_rw_ios_per_sec=args.min_rw_ios_per_sec,
+                                         min_rw_mbytes_per_sec=args.min_rw_mbytes_per_sec,
+                                         min_r_mbytes_per_sec=args.min_r_mbytes_per_sec,
+                                         min_w_mbytes_per_sec=args.min_w_mbytes_per_sec)
+
+    p = subparsers.add_parser('bdev_qos_group_add_bdev', help='Add a blockdev to a QoS group')
+    p.add_argument('group', help='QoS group name')
+    p.add_argument('name', help='Blockdev name. Example: Malloc0')
+    p.add_argument('-w', '--weight', help="Weight of the blockdev's share of the group's limits (default: 1)",
+                   type=int)
+    p.add_argument('--min-rw-ios-per-sec', help='Guaranteed R/W IOs per second', type=int)
+    p.add_argument('--min-rw-mbytes-per-sec', help='Guaranteed R/W megabytes per second', type=int)
+    p.add_argument('--min-r-mbytes-per-sec', help='Guaranteed Read megabytes per second', type=int)
+    p.add_argument('--min-w-mbytes-per-sec', help='Guaranteed Write megabytes per second', type=int)
+    p.set_defaults(func=bdev_qos_group_add_bdev)
+
+    def bdev_qos_group_remove_bdev(args):
+        args.client.bdev_qos_group_remove_bdev(group=args.group, name=args.name)
+
+    p = subparsers.add_parser('bdev_qos_group_remove_bdev', help='Remove a blockdev from a QoS group')
+    p.add_argument('group', help='QoS group name')
+    p.add_argument('name', help='Blockdev name. Example: Malloc0')
+    p.set_defaults(func=bdev_qos_group_remove_bdev)
+
+    def bdev_qos_get_groups(args):
+        print_dict(args.client.bdev_qos_get_groups())
+
+    p = subparsers.add_parser('bdev_qos_get_groups',
+                              help='Display QoS groups with the limits assigned to their blockdevs')
+    p.set_defaults(func=bdev_qos_get_groups)
+
     def bdev_error_inject_error(args):
         args.client.bdev_error_inject_error(
                                          name=args.name,
@@ -1185,7 +1275,9 @@ def add_parser(subparsers):
     def bdev_raid_set_options(args):
         args.client.bdev_raid_set_options(
                                        process_window_size_kb=args.process_window_size_kb,
-                                       process_max_bandwidth_mb_sec=args.process_max_bandwidth_mb_sec)
+                                       process_max_bandwidth_mb_sec=args.process_max_bandwidth_mb_sec,
+                                       stripe_cache_size_kb=args.stripe_cache_size_kb,
+                                       stripe_cache_flush_delay_us=args.stripe_cache_flush_delay_us)
 
     p = subparsers.add_parser('bdev_raid_set_options',
                               help='Set options for bdev raid.')
@@ -1193,6 +1285,10 @@ def add_parser(subparsers):
                    help="Background process (e.g. rebuild) window size in KiB")
     p.add_argument('-b', '--process-max-bandwidth-mb-sec', type=int,
                    help="Background process (e.g. rebuild) maximum bandwidth in MiB/Sec")
+    p.add_argument('-c', '--stripe-cache-size-kb', type=int,
+                   help="raid5f write-back stripe cache size in KiB, 0 disables the cache")
+    p.add_argument('-d', '--stripe-cache-flush-delay-us', type=int,
+                   help="Time in microseconds a partially written stripe may stay in the cache")
 
     p.set_defaults(func=bdev_raid_set_options)
 
@@ -1220,15 +1316,24 @@ def add_parser(subparsers):
                                   raid_level=args.raid_level,
                                   base_bdevs=base_bdevs,
                                   uuid=args.uuid,
-                                  superblock=args.superblock)
+                                  superblock=args.superblock,
+                                  num_copies=args.num_copies,
+                                  layout=args.layout,
+                                  read_policy=args.read_policy,
+                                  read_preferred_member=args.read_preferred_member)
     p = subparsers.add_parser('bdev_raid_create', help='Create new raid bdev')
     p.add_argument('-n', '--name', help='raid bdev name', required=True)
     p.add_argument('-z', '--strip-size-kb', help='strip size in KB', type=int)
-    p.add_argument('-r', '--raid-level', help='raid level, raid0, raid1 and a special level concat are supported', required=True)
+    p.add_argument('-r', '--raid-level', help='raid level, raid0, raid1, raid5f, raid6, raid10 and a special level concat are supported', required=True)
     p.add_argument('-b', '--base-bdevs', help='base bdevs name, whitespace separated list in quotes', required=True)
     p.add_argument('--uuid', help='UUID for this raid bdev')
     p.add_argument('-s', '--superblock', help='information about raid bdev will be stored in superblock on each base bdev, '
                                               'disabled by default due to backward compatibility', action='store_true')
+    p.add_argument('--num-copies', help='number of copies of each strip (raid10 only, default 2)', type=int)
+    p.add_argument('--layout', help='placement of the copies (raid10 only)', choices=['near', 'far'])
+    p.add_argument('--read-policy', help='base bdev selection for reads (raid1 only)',
+                   choices=['least_outstanding', 'latency', 'sequential', 'preferred'])
+    p.add_argument('--read-preferred-member', help='base bdev to read from with the preferred read policy')
     p.set_defaults(func=bdev_raid_create)
 
     def bdev_raid_delete(args):
@@ -1300,8 +1405,9 @@ def add_parser(subparsers):
                    ' to user (optional); default 20', type=int)
     p.add_argument('--l2p-dram-limit', help='l2p size that could reside in DRAM (optional); default 2048',
                    type=int)
-    p.add_argument('--core-mask', help='CPU core mask - which cores will be used for ftl core thread, '
-                   'by default core thread will be set to the main application core (optional)')
+    p.add_argument('--core-mask', help='CPU core mask - ftl core thread runs on the first core, IO threads on '
+                   'the remaining ones, by default core thread will be set to the main application core '
+                   '(optional)')
     p.add_argument('-f', '--fast-shutdown', help="Enable fast shutdown", action='store_true')
     p.set_defaults(func=bdev_ftl_create)
 
@@ -1327,8 +1433,9 @@ def add_parser(subparsers):
                    ' to user (optional); default 20', type=int)
     p.add_argument('--l2p-dram-limit', help='l2p size that could reside in DRAM (optional); default 2048',
                    type=int)
-    p.add_argument('--core-mask', help='CPU core mask - which cores will be used for ftl core thread, '
-                   'by default core thread will be set to the main application core (optional)')
+    p.add_argument('--core-mask', help='CPU core mask - ftl core thread runs on the first core, IO threads on '
+                   'the remaining ones, by default core thread will be set to the main application core '
+                   '(optional)')
     p.add_argument('-f', '--fast-shutdown', help="Enable fast shutdown", action='store_true')
     p.set_defaults(func=bdev_ftl_load)
 
@@ -1366,6 +1473,14 @@ def add_parser(subparsers):
     p.add_argument('-b', '--name', help="Name of the bdev", required=True)
     p.set_defaults(func=bdev_ftl_get_stats)
 
+    def bdev_ftl_get_recovery_progress(args):
+        print_dict(args.client.bdev_ftl_get_recovery_progress(name=args.name))
+
+    p = subparsers.add_parser('bdev_ftl_get_recovery_progress',
+                              help='Print progress of FTL dirty shutdown recovery')
+    p.add_argument('-b', '--name', help="Name of the bdev", required=True)
+    p.set_defaults(func=bdev_ftl_get_recovery_progress)
+
     def bdev_ftl_get_properties(args):
         print_dict(args.client.bdev_ftl_get_properties(name=args.name))
 
@@ -39,7 +39,8 @@ def add_parser(subparsers):
                                     poll_groups_mask=args.poll_groups_mask,
                                     discovery_filter=args.discovery_filter,
                                     dhchap_digests=args.dhchap_digests,
-                                    dhchap_dhgroups=args.dhchap_dhgroups)
+                                    dhchap_dhgroups=args.dhchap_dhgroups,
+                                    qpair_balance_threshold=args.qpair_balance_threshold)
 
     p = subparsers.add_parser('nvmf_set_config', help='Set NVMf target config')
     p.add_argument('-p', '--passthru-admin-cmds', dest='admin_cmd_passthru', help="""Comma-separated list of admin commands to be passthru
@@ -54,6 +55,8 @@ def add_parser(subparsers):
                    type=lambda d: d.split(','))
     p.add_argument('--dhchap-dhgroups', help='Comma-separated list of allowed DH-HMAC-CHAP DH groups',
                    type=lambda d: d.split(','))
+    p.add_argument('--qpair-balance-threshold', help="""Difference in busy percentage between poll groups
+                   above which qpairs are migrated from the busiest one (0 disables migration)""", type=int)
     p.set_defaults(func=nvmf_set_config)
 
     def nvmf_create_transport(args):
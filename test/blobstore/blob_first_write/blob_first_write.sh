@@ -0,0 +1,71 @@
+#!/usr/bin/env bash
+#  SPDX-License-Identifier: BSD-3-Clause
+#  Copyright (C) 2026 Intel Corporation.
+#  All rights reserved.
+#
+# Measure how first writes to thin provisioned lvols scale with the number of cores.
+# Every write is cluster sized, so each of them allocates a new cluster in the blobstore.
+testdir=$(readlink -f "$(dirname "$0")")
+rootdir=$(readlink -f "$testdir/../../..")
+
+source "$rootdir/test/common/autotest_common.sh"
+
+bdevperf="$_examples_dir/bdevperf"
+aio_file="$testdir/aio.bdev"
+aio_size_mb=4096
+cluster_sz=65536
+run_time=${BLOB_FIRST_WRITE_TIME:-2}
+
+function cleanup() {
+	rm -f "$testdir/bdevperf.json"
+	rm -f "$aio_file"
+}
+
+# Create an empty lvstore with one thin provisioned lvol per core
+function setup_lvols() {
+	local num_lvols=$1 lvol_size_mb i
+
+	rm -f "$aio_file"
+	truncate -s "${aio_size_mb}M" "$aio_file"
+	lvol_size_mb=$(((aio_size_mb - 64) / num_lvols))
+
+	"$rootdir/test/app/bdev_svc/bdev_svc" &
+	bdev_svc_pid=$!
+	waitforlisten "$bdev_svc_pid"
+
+	$rpc_py bdev_aio_create "$aio_file" aio0 4096
+	$rpc_py bdev_lvol_create_lvstore -c "$cluster_sz" --clear-method none aio0 lvs0
+	for ((i = 0; i < num_lvols; i++)); do
+		$rpc_py bdev_lvol_create -t -l lvs0 "lvol$i" "$lvol_size_mb"
+	done
+	$rpc_py save_config > "$testdir/bdevperf.json"
+
+	killprocess "$bdev_svc_pid"
+}
+
+function run_first_write() {
+	local num_cores=$1 cpumask iops
+
+	setup_lvols "$num_cores"
+	cpumask=$(printf "0x%x" $(((1 << num_cores) - 1)))
+
+	# Without -C every lvol gets a single job and the jobs are spread over the cores
+	iops=$($bdevperf --json "$testdir/bdevperf.json" -m "$cpumask" -q 32 -o "$cluster_sz" \
+		-w write -t "$run_time" | sed -n 's/.*Total *: *\([0-9.]*\).*/\1/p')
+	[[ -n $iops ]]
+
+	echo "first write: cores=$num_cores IOPS=$iops"
+}
+
+trap 'cleanup; exit 1' SIGINT SIGTERM EXIT
+
+max_cores=$(nproc)
+for num_cores in 1 2 4 8; do
+	if ((num_cores > max_cores)); then
+		break
+	fi
+	run_first_write "$num_cores"
+done
+
+trap - SIGINT SIGTERM EXIT
+cleanup
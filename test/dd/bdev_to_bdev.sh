@@ -37,6 +37,33 @@ offset_magic() {
 	done
 }
 
+threads_copy() {
+	local magic_check
+	local offset=128 # * bs, past the copied range
+
+	# Copy within the same bdev, offloaded to the controller if it supports copy
+	"${DD_APP[@]}" \
+		-m 0x3 \
+		--ib="$bdev0" \
+		--ob="$bdev0" \
+		--count="$count" \
+		--seek="$offset" \
+		--bs="$bs" \
+		--threads=2 \
+		--json <(gen_conf)
+
+	"${DD_APP[@]}" \
+		--ib="$bdev0" \
+		--of="$test_file1" \
+		--count=1 \
+		--skip="$offset" \
+		--bs="$bs" \
+		--json <(gen_conf)
+
+	read -rn${#magic} magic_check < "$test_file1"
+	[[ $magic_check == "$magic" ]]
+}
+
 cleanup() {
 	# Zero up to 64M on input|output bdev
 	clear_nvme "$bdev0" "" $((0x400000 + ${#magic}))
@@ -113,3 +140,4 @@ run_test "dd_copy_to_out_bdev" \
 count=$(((test_file0_size / bs) + 1))
 
 run_test "dd_offset_magic" offset_magic
+run_test "dd_threads_copy" threads_copy
@@ -79,4 +79,6 @@ run_test "ftl_upgrade_shutdown" $testdir/upgrade_shutdown.sh $device $nv_cache
 
 if [[ $RUN_NIGHTLY -eq 1 ]]; then
 	run_test "ftl_restore_fast" $testdir/restore.sh -f -c $nv_cache $device
+	run_test "ftl_waf" $testdir/waf.sh $device $nv_cache
+	run_test "ftl_recovery_time" $testdir/recovery_time.sh $device $nv_cache
 fi
@@ -0,0 +1,109 @@
+#!/usr/bin/env bash
+#  SPDX-License-Identifier: BSD-3-Clause
+#  Copyright (C) 2026 Intel Corporation.
+#  All rights reserved.
+#
+testdir=$(readlink -f $(dirname $0))
+rootdir=$(readlink -f $testdir/../..)
+source $rootdir/test/common/autotest_common.sh
+source $testdir/common.sh
+
+device=$1
+cache_device=$2
+rpc_py=$rootdir/scripts/rpc.py
+spdk_dd="$SPDK_BIN_DIR/spdk_dd"
+timeout=600
+core_mask=0xf
+
+block_size=4096
+# Blocks written before the dirty shutdown, the more bands and chunks the longer the recovery
+data_size=${FTL_RECOVERY_DATA_SIZE:-$((4 * 1024 * 1024))}
+
+recovery_kill() {
+	rm -f $testdir/config/ftl_base.json
+
+	killprocess $svcpid || true
+	rmmod nbd || true
+	remove_shm
+}
+
+start_target() {
+	"$SPDK_BIN_DIR/spdk_tgt" -m $core_mask "$@" &
+	svcpid=$!
+	waitforlisten $svcpid
+}
+
+kill_target() {
+	# Dirty shutdown, drop the shared memory too so the whole L2P needs to be rebuilt
+	kill -9 $svcpid
+	wait $svcpid || true
+	remove_shm
+}
+
+measure_recovery() {
+	local ftl_core_mask=$1 load_pid progress state
+
+	start_target --json $testdir/config/ftl_base.json
+
+	$rpc_py -t $timeout bdev_ftl_load -b ftl0 -d $split_bdev -c $nv_cache -u $uuid \
+		--l2p-dram-limit $l2p_dram_size_mb ${ftl_core_mask:+--core-mask $ftl_core_mask} &
+	load_pid=$!
+
+	# The device isn't there until bdev_ftl_load allocates it
+	state=none
+	while kill -0 $load_pid 2> /dev/null; do
+		if progress=$($rpc_py bdev_ftl_get_recovery_progress -b ftl0 2> /dev/null); then
+			state=$(jq -r '.state' <<< "$progress")
+			jq -r '"\(.state): iteration \(.iteration)/\(.iterations), P2L maps \(.p2l_maps_done)/\(.p2l_maps_total), \(.elapsed_us)us"' <<< "$progress"
+		fi
+		sleep 0.5
+	done
+	wait $load_pid
+
+	progress=$($rpc_py bdev_ftl_get_recovery_progress -b ftl0)
+	jq -e '.state == "done" and .p2l_maps_done == .p2l_maps_total' <<< "$progress"
+	elapsed_us=$(jq -r '.elapsed_us' <<< "$progress")
+	num_threads=$(jq -r '.num_threads' <<< "$progress")
+
+	kill_target
+}
+
+trap "recovery_kill; exit 1" SIGINT SIGTERM EXIT
+
+start_target
+split_bdev=$(create_base_bdev nvme0 $device $((1024 * 101)))
+nv_cache=$(create_nv_cache_bdev nvc0 $cache_device $split_bdev)
+
+(
+	echo '{"subsystems": ['
+	$rpc_py save_subsystem_config -n bdev
+	echo ']}'
+) > $testdir/config/ftl_base.json
+
+# Limit the L2P DRAM, so the rebuild takes more than one iteration
+l2p_dram_size_mb=$(($(get_bdev_size $split_bdev) * 5 / 100 / 1024))
+$rpc_py -t $timeout bdev_ftl_create -b ftl0 -d $split_bdev -c $nv_cache \
+	--l2p-dram-limit $l2p_dram_size_mb
+uuid=$($rpc_py bdev_get_bdevs -b ftl0 | jq -r '.[0].uuid')
+
+modprobe nbd
+$rpc_py nbd_start_disk ftl0 /dev/nbd0
+waitfornbd nbd0
+$spdk_dd -m 0x2 --if=/dev/urandom --of=/dev/nbd0 --bs=$block_size --count=$data_size \
+	--oflag=direct
+sync /dev/nbd0
+$rpc_py nbd_stop_disk /dev/nbd0
+
+kill_target
+
+# Recovery on the core thread only, then with the P2L maps applied by the IO threads
+measure_recovery ""
+elapsed_us_single=$elapsed_us
+measure_recovery $core_mask
+elapsed_us_multi=$elapsed_us
+
+echo "FTL dirty shutdown recovery, 1 thread: ${elapsed_us_single}us," \
+	"$num_threads threads: ${elapsed_us_multi}us"
+
+trap - SIGINT SIGTERM EXIT
+recovery_kill
@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+#  SPDX-License-Identifier: BSD-3-Clause
+#  Copyright (C) 2026 Intel Corporation.
+#  All rights reserved.
+#
+testdir=$(readlink -f $(dirname $0))
+rootdir=$(readlink -f $testdir/../..)
+source $rootdir/test/common/autotest_common.sh
+source $testdir/common.sh
+
+device=$1
+cache_device=$2
+rpc_py=$rootdir/scripts/rpc.py
+timeout=240
+# Needs to overwrite the device a few times for GC to kick in
+run_time=${FTL_WAF_RUN_TIME:-600}
+
+measure_waf() {
+	local separation=$1 stats
+
+	$rpc_py -t $timeout bdev_ftl_create -b ftl0 -d $split_bdev -c $nv_cache
+	$rpc_py bdev_ftl_set_property -b ftl0 -p hot_cold_separation -v $separation
+
+	$rootdir/examples/bdev/bdevperf/bdevperf.py -t $((run_time + timeout)) perform_tests \
+		-q 128 -w randwrite -t $run_time -o 4096
+
+	stats=$($rpc_py bdev_ftl_get_stats -b ftl0)
+	$rpc_py bdev_ftl_delete -b ftl0
+
+	# Sanity check only, the result depends on the workload and the drive
+	jq -e '.gc_victims.write_amplification >= 1' <<< "$stats"
+	waf=$(jq -r '.gc_victims.write_amplification' <<< "$stats")
+}
+
+# Zipfian random writes, most of the overwrites hit a small part of the LBAs
+"$rootdir/build/examples/bdevperf" -z -T ftl0 -F 1.2 &
+bdevperf_pid=$!
+
+trap 'killprocess $bdevperf_pid; exit 1' SIGINT SIGTERM EXIT
+waitforlisten $bdevperf_pid
+split_bdev=$(create_base_bdev nvme0 $device $((1024 * 20)))
+nv_cache=$(create_nv_cache_bdev nvc0 $cache_device $split_bdev)
+
+measure_waf false
+waf_mixed=$waf
+measure_waf true
+waf_separated=$waf
+
+echo "FTL WAF, hot and cold data mixed: $waf_mixed, separated: $waf_separated"
+
+killprocess $bdevperf_pid
+trap - SIGINT SIGTERM EXIT
+
+remove_shm
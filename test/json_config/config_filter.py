@@ -44,6 +44,7 @@ def filter_methods(do_remove_global_rpcs):
         'accel_crypto_key_create',
         'accel_assign_opc',
         'accel_set_options',
+        'accel_sw_set_options',
         'dpdk_cryptodev_scan_accel_module',
         'dpdk_cryptodev_set_driver',
         'virtio_blk_create_transport',
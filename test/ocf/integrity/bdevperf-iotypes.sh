@@ -12,4 +12,5 @@ bdevperf=$rootdir/build/examples/bdevperf
 source "$curdir/mallocs.conf"
 $bdevperf --json <(gen_malloc_ocf_json) -q 128 -o 4096 -t 4 -w flush
 $bdevperf --json <(gen_malloc_ocf_json) -q 128 -o 4096 -t 4 -w unmap
+$bdevperf --json <(gen_malloc_ocf_json) -q 128 -o 4096 -t 4 -w write_zeroes
 $bdevperf --json <(gen_malloc_ocf_json) -q 128 -o 4096 -t 4 -w write
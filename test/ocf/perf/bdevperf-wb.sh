@@ -0,0 +1,62 @@
+#!/usr/bin/env bash
+#  SPDX-License-Identifier: BSD-3-Clause
+#  Copyright (C) 2026 Intel Corporation
+#  All rights reserved.
+#
+
+# Measures a write-back cache vbdev with bdevperf. Pass several bdevperf binaries, e.g. built
+# before and after a change, to compare them:
+#   bdevperf-wb.sh build/examples/bdevperf /tmp/spdk-base/build/examples/bdevperf
+curdir=$(dirname $(readlink -f "${BASH_SOURCE[0]}"))
+rootdir=$(readlink -f $curdir/../../..)
+source $rootdir/test/common/autotest_common.sh
+
+bdevperfs=("$@")
+((${#bdevperfs[@]} > 0)) || bdevperfs=("$rootdir/build/examples/bdevperf")
+
+core_mask=${CORE_MASK:-0xf}
+run_time=${RUN_TIME:-10}
+io_sizes=(4096 65536 262144)
+
+gen_malloc_ocf_wb_json() {
+	jq . <<- JSON
+		{
+		  "subsystems": [
+		    {
+		      "subsystem": "bdev",
+		      "config": [
+		        {
+		          "method": "bdev_malloc_create",
+		          "params": { "name": "Malloc0", "num_blocks": 262144, "block_size": 4096 }
+		        },
+		        {
+		          "method": "bdev_malloc_create",
+		          "params": { "name": "Malloc1", "num_blocks": 524288, "block_size": 4096 }
+		        },
+		        {
+		          "method": "bdev_ocf_create",
+		          "params": {
+		            "name": "MalCache",
+		            "mode": "wb",
+		            "cache_bdev_name": "Malloc0",
+		            "core_bdev_name": "Malloc1"
+		          }
+		        },
+		        {
+		          "method": "bdev_wait_for_examine"
+		        }
+		      ]
+		    }
+		  ]
+		}
+	JSON
+}
+
+for bdevperf in "${bdevperfs[@]}"; do
+	for io_size in "${io_sizes[@]}"; do
+		# Sizes above the 128k max I/O size of the OCF volume are forwarded in parts
+		result=$($bdevperf --json <(gen_malloc_ocf_wb_json) -m "$core_mask" -C -q 128 \
+			-o "$io_size" -w randrw -M 70 -t "$run_time" | awk '/Total/ {print $3, $4}')
+		printf '%s io_size=%d: %s IOPS %s MiB/s\n' "$bdevperf" "$io_size" $result
+	done
+done
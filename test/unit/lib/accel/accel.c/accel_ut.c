@@ -575,6 +575,113 @@ test_spdk_accel_submit_xor(void)
 	CU_ASSERT(expected_accel_task == &task);
 }
 
+static void
+test_sw_accel_offload(void)
+{
+	const uint64_t nbytes = TEST_SUBMIT_SIZE;
+	uint8_t dst[TEST_SUBMIT_SIZE] = {0};
+	uint8_t src[TEST_SUBMIT_SIZE];
+	struct sw_accel_worker worker = {};
+	struct sw_accel_task sw_task = {};
+	struct spdk_accel_task_aux_data task_aux;
+	struct spdk_accel_task *task = &sw_task.task;
+	int rc;
+
+	memset(src, 0xa5, sizeof(src));
+	STAILQ_INIT(&g_accel_ch->task_pool);
+	SLIST_INIT(&g_accel_ch->task_aux_data_pool);
+
+	worker.ring = spdk_ring_create(SPDK_RING_TYPE_MP_SC, ACCEL_SW_WORKER_RING_SIZE,
+				       SPDK_ENV_NUMA_ID_ANY);
+	SPDK_CU_ASSERT_FATAL(worker.ring != NULL);
+	worker.ch = calloc(1, sizeof(struct spdk_io_channel) + sizeof(struct sw_accel_io_channel));
+	SPDK_CU_ASSERT_FATAL(worker.ch != NULL);
+	worker.running = true;
+	g_sw_workers = &worker;
+	g_sw_num_workers = 1;
+	g_sw_num_running_workers = 1;
+
+	/* Unsupported opcodes can't have a threshold */
+	rc = accel_sw_set_offload_threshold(SPDK_ACCEL_OPC_LAST, nbytes);
+	CU_ASSERT(rc == -EINVAL);
+
+	/* Copies are executed inline by default */
+	task->accel_ch = g_accel_ch;
+	STAILQ_INSERT_TAIL(&g_accel_ch->task_pool, task, link);
+	SLIST_INSERT_HEAD(&g_accel_ch->task_aux_data_pool, &task_aux, link);
+	rc = spdk_accel_submit_copy(g_ch, dst, src, nbytes, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(memcmp(dst, src, nbytes) == 0);
+	CU_ASSERT(g_sw_ch->num_offloaded == 0);
+	CU_ASSERT(STAILQ_FIRST(&g_sw_ch->tasks_to_complete) == task);
+	STAILQ_REMOVE_HEAD(&g_sw_ch->tasks_to_complete, link);
+
+	/* Operations smaller than the threshold are still executed inline */
+	rc = accel_sw_set_offload_threshold(SPDK_ACCEL_OPC_COPY, nbytes + 1);
+	CU_ASSERT(rc == 0);
+	memset(dst, 0, sizeof(dst));
+	STAILQ_INSERT_TAIL(&g_accel_ch->task_pool, task, link);
+	SLIST_INSERT_HEAD(&g_accel_ch->task_aux_data_pool, &task_aux, link);
+	rc = spdk_accel_submit_copy(g_ch, dst, src, nbytes, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(memcmp(dst, src, nbytes) == 0);
+	CU_ASSERT(g_sw_ch->num_offloaded == 0);
+	CU_ASSERT(STAILQ_FIRST(&g_sw_ch->tasks_to_complete) == task);
+	STAILQ_REMOVE_HEAD(&g_sw_ch->tasks_to_complete, link);
+
+	/* Once the threshold is reached, the operation is executed by the worker */
+	rc = accel_sw_set_offload_threshold(SPDK_ACCEL_OPC_COPY, nbytes);
+	CU_ASSERT(rc == 0);
+	memset(dst, 0, sizeof(dst));
+	STAILQ_INSERT_TAIL(&g_accel_ch->task_pool, task, link);
+	SLIST_INSERT_HEAD(&g_accel_ch->task_aux_data_pool, &task_aux, link);
+	rc = spdk_accel_submit_copy(g_ch, dst, src, nbytes, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(memcmp(dst, src, nbytes) != 0);
+	CU_ASSERT(g_sw_ch->num_offloaded == 1);
+	CU_ASSERT(sw_task.sw_ch == g_sw_ch);
+	CU_ASSERT(STAILQ_EMPTY(&g_sw_ch->tasks_to_complete));
+	CU_ASSERT(spdk_ring_count(worker.ring) == 1);
+
+	rc = sw_accel_worker_poll(&worker);
+	CU_ASSERT(rc == SPDK_POLLER_BUSY);
+	CU_ASSERT(memcmp(dst, src, nbytes) == 0);
+	CU_ASSERT(spdk_ring_count(worker.ring) == 0);
+	CU_ASSERT(spdk_ring_count(g_sw_ch->offload_completions) == 1);
+	rc = sw_accel_worker_poll(&worker);
+	CU_ASSERT(rc == SPDK_POLLER_IDLE);
+
+	/* The completion is picked up by the submitting channel */
+	sw_accel_offload_complete(g_sw_ch);
+	CU_ASSERT(g_sw_ch->num_offloaded == 0);
+	CU_ASSERT(task->status == 0);
+	CU_ASSERT(STAILQ_FIRST(&g_sw_ch->tasks_to_complete) == task);
+	STAILQ_REMOVE_HEAD(&g_sw_ch->tasks_to_complete, link);
+
+	/* Stopped workers are skipped */
+	worker.running = false;
+	memset(dst, 0, sizeof(dst));
+	STAILQ_INSERT_TAIL(&g_accel_ch->task_pool, task, link);
+	SLIST_INSERT_HEAD(&g_accel_ch->task_aux_data_pool, &task_aux, link);
+	rc = spdk_accel_submit_copy(g_ch, dst, src, nbytes, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(memcmp(dst, src, nbytes) == 0);
+	CU_ASSERT(g_sw_ch->num_offloaded == 0);
+	CU_ASSERT(STAILQ_FIRST(&g_sw_ch->tasks_to_complete) == task);
+	STAILQ_REMOVE_HEAD(&g_sw_ch->tasks_to_complete, link);
+
+	rc = accel_sw_set_offload_threshold(SPDK_ACCEL_OPC_COPY,
+					    g_sw_default_offload_threshold[SPDK_ACCEL_OPC_COPY]);
+	CU_ASSERT(rc == 0);
+	g_sw_workers = NULL;
+	g_sw_num_workers = 0;
+	g_sw_num_running_workers = 0;
+	spdk_ring_free(g_sw_ch->offload_completions);
+	g_sw_ch->offload_completions = NULL;
+	spdk_ring_free(worker.ring);
+	free(worker.ch);
+}
+
 static void
 test_spdk_accel_module_find_by_name(void)
 {
@@ -4450,6 +4557,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_spdk_accel_submit_crc32cv);
 	CU_ADD_TEST(suite, test_spdk_accel_submit_copy_crc32c);
 	CU_ADD_TEST(suite, test_spdk_accel_submit_xor);
+	CU_ADD_TEST(suite, test_sw_accel_offload);
 	CU_ADD_TEST(suite, test_spdk_accel_module_find_by_name);
 	CU_ADD_TEST(suite, test_spdk_accel_module_register);
 
@@ -1267,6 +1267,332 @@ io_during_qos_queue(void)
 	teardown_test();
 }
 
+static void
+qos_channel_quota(void)
+{
+	struct spdk_io_channel *io_ch[2];
+	struct spdk_bdev_channel *bdev_ch[2];
+	struct spdk_bdev_qos_limit *limit;
+	struct spdk_bdev *bdev;
+	enum spdk_bdev_io_status status[9];
+	int i, rc;
+
+	setup_test();
+	MOCK_SET(spdk_get_ticks, 0);
+
+	/* Enable QoS */
+	bdev = &g_bdev.bdev;
+	bdev->internal.qos = calloc(1, sizeof(*bdev->internal.qos));
+	SPDK_CU_ASSERT_FATAL(bdev->internal.qos != NULL);
+
+	/* 16000 read/write I/O per second, or 16 per millisecond */
+	limit = &bdev->internal.qos->rate_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT];
+	limit->limit = 16000;
+
+	g_get_io_channel = true;
+
+	/* Create channels */
+	set_thread(0);
+	io_ch[0] = spdk_bdev_get_io_channel(g_desc);
+	bdev_ch[0] = spdk_io_channel_get_ctx(io_ch[0]);
+	CU_ASSERT(bdev_ch[0]->flags == BDEV_CH_QOS_ENABLED);
+
+	set_thread(1);
+	io_ch[1] = spdk_bdev_get_io_channel(g_desc);
+	bdev_ch[1] = spdk_io_channel_get_ctx(io_ch[1]);
+	CU_ASSERT(bdev_ch[1]->flags == BDEV_CH_QOS_ENABLED);
+
+	/* With two channels, each one takes 1/8 of the timeslice's quota at once */
+	CU_ASSERT(bdev->internal.qos->num_channels == 2);
+	CU_ASSERT(limit->borrow_size == 2);
+
+	/* The first I/O takes a batch of quota, the second one uses what's left of it */
+	set_thread(0);
+	for (i = 0; i < 2; i++) {
+		status[i] = SPDK_BDEV_IO_STATUS_PENDING;
+		rc = spdk_bdev_read_blocks(g_desc, io_ch[0], NULL, 0, 1, io_during_io_done,
+					   &status[i]);
+		CU_ASSERT(rc == 0);
+		CU_ASSERT(limit->remaining_this_timeslice == 14);
+	}
+	CU_ASSERT(bdev_ch[0]->qos_quota[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] == 0);
+
+	/* The other channel takes its own batches */
+	set_thread(1);
+	for (i = 0; i < 8; i++) {
+		status[i] = SPDK_BDEV_IO_STATUS_PENDING;
+		rc = spdk_bdev_read_blocks(g_desc, io_ch[1], NULL, 0, 1, io_during_io_done,
+					   &status[i]);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(limit->remaining_this_timeslice == 6);
+	CU_ASSERT(bdev_ch[1]->qos_quota[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] == 0);
+
+	/* Take the rest of the quota from thread 0, the next I/O has to be queued */
+	set_thread(0);
+	for (i = 0; i < 6; i++) {
+		status[i] = SPDK_BDEV_IO_STATUS_PENDING;
+		rc = spdk_bdev_read_blocks(g_desc, io_ch[0], NULL, 0, 1, io_during_io_done,
+					   &status[i]);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(TAILQ_EMPTY(&bdev_ch[0]->qos_queued_io));
+	CU_ASSERT(bdev_ch[0]->qos_quota[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] == 0);
+	status[8] = SPDK_BDEV_IO_STATUS_PENDING;
+	rc = spdk_bdev_read_blocks(g_desc, io_ch[0], NULL, 0, 1, io_during_io_done, &status[8]);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(!TAILQ_EMPTY(&bdev_ch[0]->qos_queued_io));
+	CU_ASSERT(bdev->internal.qos->io_queued == true);
+
+	poll_threads();
+	set_thread(1);
+	stub_complete_io(g_bdev.io_target, 0);
+	set_thread(0);
+	stub_complete_io(g_bdev.io_target, 0);
+	poll_threads();
+	CU_ASSERT(status[8] == SPDK_BDEV_IO_STATUS_PENDING);
+
+	/* Advance in time by a millisecond, the queued I/O is resubmitted by the poller */
+	spdk_delay_us(1000);
+	poll_threads();
+	CU_ASSERT(TAILQ_EMPTY(&bdev_ch[0]->qos_queued_io));
+	CU_ASSERT(bdev->internal.qos->io_queued == false);
+	stub_complete_io(g_bdev.io_target, 0);
+	poll_threads();
+	CU_ASSERT(status[8] == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(limit->remaining_this_timeslice == 14);
+	CU_ASSERT(bdev_ch[0]->qos_quota[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] == 1);
+
+	/* The quota left on the channel is given back once the next timeslice starts */
+	spdk_delay_us(1000);
+	poll_threads();
+	status[0] = SPDK_BDEV_IO_STATUS_PENDING;
+	rc = spdk_bdev_read_blocks(g_desc, io_ch[0], NULL, 0, 1, io_during_io_done, &status[0]);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(limit->remaining_this_timeslice == 15);
+	CU_ASSERT(bdev_ch[0]->qos_quota[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] == 1);
+	stub_complete_io(g_bdev.io_target, 0);
+	poll_threads();
+	CU_ASSERT(status[0] == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	/* Once a channel is gone, the other one takes bigger batches */
+	set_thread(1);
+	spdk_put_io_channel(io_ch[1]);
+	poll_threads();
+	CU_ASSERT(bdev->internal.qos->num_channels == 1);
+	CU_ASSERT(limit->borrow_size == 4);
+
+	/* Tear down the channels */
+	set_thread(0);
+	spdk_put_io_channel(io_ch[0]);
+	poll_threads();
+
+	teardown_test();
+}
+
+static void
+qos_rate_io_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	uint64_t *completed = cb_arg;
+
+	CU_ASSERT(success);
+	(*completed)++;
+	spdk_bdev_free_io(bdev_io);
+}
+
+static void
+qos_channel_quota_rate(void)
+{
+	struct spdk_io_channel *io_ch[BDEV_UT_NUM_THREADS];
+	struct spdk_bdev_channel *bdev_ch[BDEV_UT_NUM_THREADS];
+	struct spdk_bdev_qos_limit *limit;
+	struct spdk_bdev *bdev;
+	uint64_t completed = 0;
+	int i, ms, rc;
+
+	setup_test();
+	MOCK_SET(spdk_get_ticks, 0);
+
+	/* Enable QoS, 48000 read/write I/O per second, or 48 per millisecond */
+	bdev = &g_bdev.bdev;
+	bdev->internal.qos = calloc(1, sizeof(*bdev->internal.qos));
+	SPDK_CU_ASSERT_FATAL(bdev->internal.qos != NULL);
+	limit = &bdev->internal.qos->rate_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT];
+	limit->limit = 48000;
+
+	g_get_io_channel = true;
+
+	for (i = 0; i < BDEV_UT_NUM_THREADS; i++) {
+		set_thread(i);
+		io_ch[i] = spdk_bdev_get_io_channel(g_desc);
+		bdev_ch[i] = spdk_io_channel_get_ctx(io_ch[i]);
+		CU_ASSERT(bdev_ch[i]->flags == BDEV_CH_QOS_ENABLED);
+	}
+	CU_ASSERT(limit->borrow_size == 4);
+
+	/*
+	 * All channels but the last one submit a single I/O per millisecond, leaving most of the
+	 * quota they take unused. The last one submits as many as the quota allows.
+	 */
+	for (ms = 0; ms < 100; ms++) {
+		for (i = 0; i < BDEV_UT_NUM_THREADS - 1; i++) {
+			set_thread(i);
+			rc = spdk_bdev_read_blocks(g_desc, io_ch[i], NULL, 0, 1, qos_rate_io_done,
+						   &completed);
+			CU_ASSERT(rc == 0);
+		}
+
+		i = BDEV_UT_NUM_THREADS - 1;
+		set_thread(i);
+		while (TAILQ_EMPTY(&bdev_ch[i]->qos_queued_io)) {
+			rc = spdk_bdev_read_blocks(g_desc, io_ch[i], NULL, 0, 1, qos_rate_io_done,
+						   &completed);
+			CU_ASSERT(rc == 0);
+		}
+
+		for (i = 0; i < BDEV_UT_NUM_THREADS; i++) {
+			set_thread(i);
+			stub_complete_io(g_bdev.io_target, 0);
+		}
+		poll_threads();
+
+		spdk_delay_us(1000);
+		poll_threads();
+	}
+
+	/* The quota left unused by the channels isn't lost, so the configured rate is reached */
+	CU_ASSERT(completed >= 48 * 99);
+	CU_ASSERT(completed <= 48 * 100);
+
+	for (i = 0; i < BDEV_UT_NUM_THREADS; i++) {
+		set_thread(i);
+		stub_complete_io(g_bdev.io_target, 0);
+		poll_threads();
+		spdk_put_io_channel(io_ch[i]);
+	}
+	poll_threads();
+
+	teardown_test();
+}
+
+static void
+qos_group_done(void *cb_arg, int status)
+{
+	*(int *)cb_arg = status;
+}
+
+static uint64_t
+qos_group_iops_limit(struct spdk_bdev *bdev)
+{
+	return bdev->internal.qos->rate_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT].group_limit;
+}
+
+static void
+qos_group(void)
+{
+	struct ut_bdev *second_bdev;
+	struct spdk_bdev_desc *second_desc = NULL;
+	struct spdk_bdev *bdev[2];
+	uint64_t limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES] = {};
+	uint64_t min_limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES] = {};
+	int rc, status;
+
+	setup_test();
+
+	second_bdev = calloc(1, sizeof(*second_bdev));
+	SPDK_CU_ASSERT_FATAL(second_bdev != NULL);
+	register_bdev(second_bdev, "ut_bdev2", g_bdev.io_target);
+	spdk_bdev_open_ext("ut_bdev2", true, _bdev_event_cb, NULL, &second_desc);
+	SPDK_CU_ASSERT_FATAL(second_desc != NULL);
+	bdev[0] = &g_bdev.bdev;
+	bdev[1] = &second_bdev->bdev;
+
+	/* A group needs at least one limit */
+	rc = spdk_bdev_qos_group_create("group0", limits, 0);
+	CU_ASSERT(rc == -EINVAL);
+
+	limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] = 10000;
+	rc = spdk_bdev_qos_group_create("group0", limits, 0);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_qos_group_create("group0", limits, 0);
+	CU_ASSERT(rc == -EEXIST);
+
+	/* The bdevs start with their fair share at the time they're added */
+	status = 1;
+	spdk_bdev_qos_group_add_bdev("group0", "ut_bdev", 1, NULL, qos_group_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	SPDK_CU_ASSERT_FATAL(bdev[0]->internal.qos != NULL);
+	CU_ASSERT(qos_group_iops_limit(bdev[0]) == 10000);
+
+	/* The guaranteed rates can't exceed the group's limits */
+	min_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] = 11000;
+	status = 1;
+	spdk_bdev_qos_group_add_bdev("group0", "ut_bdev2", 3, min_limits, qos_group_done, &status);
+	poll_threads();
+	CU_ASSERT(status == -EINVAL);
+	CU_ASSERT(bdev[1]->internal.qos == NULL);
+
+	min_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT] = 1000;
+	status = 1;
+	spdk_bdev_qos_group_add_bdev("group0", "ut_bdev2", 3, min_limits, qos_group_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	SPDK_CU_ASSERT_FATAL(bdev[1]->internal.qos != NULL);
+	CU_ASSERT(qos_group_iops_limit(bdev[1]) == 7500);
+
+	/* A bdev can only be in one group */
+	rc = spdk_bdev_qos_group_create("group1", limits, 100);
+	CU_ASSERT(rc == 0);
+	status = 1;
+	spdk_bdev_qos_group_add_bdev("group1", "ut_bdev2", 1, NULL, qos_group_done, &status);
+	poll_threads();
+	CU_ASSERT(status == -EEXIST);
+	rc = spdk_bdev_qos_group_delete("group1");
+	CU_ASSERT(rc == 0);
+
+	/* Nobody uses its share, only the guaranteed rate is kept aside and the rest is split
+	 * by weight.
+	 */
+	spdk_delay_us(10000);
+	poll_threads();
+	CU_ASSERT(qos_group_iops_limit(bdev[0]) == 2250);
+	CU_ASSERT(qos_group_iops_limit(bdev[1]) == 7750);
+
+	/* The first bdev had its I/O queued, so it gets all but the second one's guarantee */
+	bdev[0]->internal.qos->throttled++;
+	spdk_delay_us(10000);
+	poll_threads();
+	CU_ASSERT(qos_group_iops_limit(bdev[0]) == 9000);
+	CU_ASSERT(qos_group_iops_limit(bdev[1]) == 1000);
+
+	/* Both want more than they get, so the rest is split by weight on top of the guarantee */
+	bdev[0]->internal.qos->throttled++;
+	bdev[1]->internal.qos->throttled++;
+	spdk_delay_us(10000);
+	poll_threads();
+	CU_ASSERT(qos_group_iops_limit(bdev[0]) == 2250);
+	CU_ASSERT(qos_group_iops_limit(bdev[1]) == 7750);
+
+	/* A group with bdevs can't be deleted */
+	rc = spdk_bdev_qos_group_delete("group0");
+	CU_ASSERT(rc == -EBUSY);
+
+	/* Removing the bdev disables QoS as it has no limits of its own */
+	status = 1;
+	spdk_bdev_qos_group_remove_bdev("group0", "ut_bdev2", qos_group_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	CU_ASSERT(bdev[1]->internal.qos == NULL);
+
+	spdk_bdev_close(second_desc);
+	unregister_bdev(second_bdev);
+	free(second_bdev);
+
+	/* The bdev is removed from the group when it's unregistered */
+	teardown_test();
+}
+
 static void
 io_during_qos_reset(void)
 {
@@ -3029,6 +3355,9 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, reset_completions);
 	CU_ADD_TEST(suite, io_during_qos_queue);
 	CU_ADD_TEST(suite, io_during_qos_reset);
+	CU_ADD_TEST(suite, qos_channel_quota);
+	CU_ADD_TEST(suite, qos_channel_quota_rate);
+	CU_ADD_TEST(suite, qos_group);
 	CU_ADD_TEST(suite, enomem);
 	CU_ADD_TEST(suite, enomem_multi_bdev);
 	CU_ADD_TEST(suite, enomem_multi_bdev_unregister);
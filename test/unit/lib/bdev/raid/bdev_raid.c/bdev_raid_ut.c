@@ -156,6 +156,7 @@ DEFINE_STUB_V(spdk_jsonrpc_send_bool_response, (struct spdk_jsonrpc_request *req
 		bool value));
 DEFINE_STUB(spdk_json_decode_string, int, (const struct spdk_json_val *val, void *out), 0);
 DEFINE_STUB(spdk_json_decode_uint32, int, (const struct spdk_json_val *val, void *out), 0);
+DEFINE_STUB(spdk_json_decode_uint8, int, (const struct spdk_json_val *val, void *out), 0);
 DEFINE_STUB(spdk_json_decode_uuid, int, (const struct spdk_json_val *val, void *out), 0);
 DEFINE_STUB(spdk_json_decode_array, int, (const struct spdk_json_val *values,
 		spdk_json_decode_fn decode_func,
@@ -534,6 +535,13 @@ spdk_json_decode_object(const struct spdk_json_val *values,
 		_out->strip_size_kb = req->strip_size_kb;
 		_out->level = req->level;
 		_out->superblock_enabled = req->superblock_enabled;
+		_out->num_copies = req->num_copies;
+		_out->layout = req->layout;
+		_out->read_policy = req->read_policy;
+		if (req->read_preferred_member != NULL) {
+			_out->read_preferred_member = strdup(req->read_preferred_member);
+			SPDK_CU_ASSERT_FATAL(_out->read_preferred_member != NULL);
+		}
 		_out->base_bdevs.num_base_bdevs = req->base_bdevs.num_base_bdevs;
 		for (i = 0; i < req->base_bdevs.num_base_bdevs; i++) {
 			_out->base_bdevs.base_bdevs[i] = strdup(req->base_bdevs.base_bdevs[i]);
@@ -838,6 +846,10 @@ create_test_req(struct rpc_bdev_raid_create *r, const char *raid_name,
 	r->strip_size_kb = (g_strip_size * g_block_len) / 1024;
 	r->level = 123;
 	r->superblock_enabled = superblock_enabled;
+	r->num_copies = 0;
+	r->layout = RAID_LAYOUT_NEAR;
+	r->read_policy = RAID_READ_POLICY_LEAST_OUTSTANDING;
+	r->read_preferred_member = NULL;
 	r->base_bdevs.num_base_bdevs = g_max_base_drives;
 	for (i = 0; i < g_max_base_drives; i++, bbdev_idx++) {
 		snprintf(name, 16, "%s%u%s", "Nvme", bbdev_idx, "n1");
@@ -870,6 +882,7 @@ free_test_req(struct rpc_bdev_raid_create *r)
 	uint8_t i;
 
 	free(r->name);
+	free(r->read_preferred_member);
 	for (i = 0; i < r->base_bdevs.num_base_bdevs; i++) {
 		free(r->base_bdevs.base_bdevs[i]);
 	}
@@ -987,6 +1000,29 @@ test_create_raid_invalid_args(void)
 	free_test_req(&req);
 	verify_raid_bdev_present("raid1", false);
 
+	/* read policies other than the default are not supported by the test raid level */
+	create_raid_bdev_create_req(&req, "raid1", 0, false, 0, false);
+	req.read_policy = RAID_READ_POLICY_LATENCY;
+	rpc_bdev_raid_create(NULL, NULL);
+	CU_ASSERT(g_rpc_err == 1);
+	free_test_req(&req);
+	verify_raid_bdev_present("raid1", false);
+
+	create_raid_bdev_create_req(&req, "raid1", 0, false, 0, false);
+	req.read_policy = RAID_READ_POLICY_PREFERRED;
+	rpc_bdev_raid_create(NULL, NULL);
+	CU_ASSERT(g_rpc_err == 1);
+	free_test_req(&req);
+	verify_raid_bdev_present("raid1", false);
+
+	create_raid_bdev_create_req(&req, "raid1", 0, false, 0, false);
+	req.read_preferred_member = strdup("Nvme0n1");
+	SPDK_CU_ASSERT_FATAL(req.read_preferred_member != NULL);
+	rpc_bdev_raid_create(NULL, NULL);
+	CU_ASSERT(g_rpc_err == 1);
+	free_test_req(&req);
+	verify_raid_bdev_present("raid1", false);
+
 	create_raid_bdev_create_req(&req, "raid1", 0, false, 0, false);
 	rpc_bdev_raid_create(NULL, NULL);
 	CU_ASSERT(g_rpc_err == 0);
@@ -1334,6 +1370,15 @@ test_raid_level_conversions(void)
 	CU_ASSERT(raid_str != NULL && strlen(raid_str) == 0);
 	raid_str = raid_bdev_level_to_str(RAID0);
 	CU_ASSERT(raid_str != NULL && strcmp(raid_str, "raid0") == 0);
+
+	CU_ASSERT(raid_bdev_str_to_read_policy("abcd123") == INVALID_RAID_READ_POLICY);
+	CU_ASSERT(raid_bdev_str_to_read_policy("latency") == RAID_READ_POLICY_LATENCY);
+	CU_ASSERT(raid_bdev_str_to_read_policy("Sequential") == RAID_READ_POLICY_SEQUENTIAL);
+
+	raid_str = raid_bdev_read_policy_to_str(INVALID_RAID_READ_POLICY);
+	CU_ASSERT(raid_str != NULL && strlen(raid_str) == 0);
+	raid_str = raid_bdev_read_policy_to_str(RAID_READ_POLICY_PREFERRED);
+	CU_ASSERT(raid_str != NULL && strcmp(raid_str, "preferred") == 0);
 }
 
 static void
@@ -35,6 +35,8 @@ struct raid_params {
 	uint32_t base_bdev_blocklen;
 	uint32_t strip_size;
 	enum raid_params_md_type md_type;
+	uint8_t num_copies;
+	enum raid_layout layout;
 };
 
 int raid_test_params_alloc(size_t count);
@@ -112,6 +114,8 @@ raid_test_create_raid_bdev(struct raid_params *params, struct raid_bdev_module *
 	raid_bdev->module = module;
 	raid_bdev->level = module->level;
 	raid_bdev->num_base_bdevs = params->num_base_bdevs;
+	raid_bdev->num_copies = params->num_copies;
+	raid_bdev->layout = params->layout;
 
 	switch (raid_bdev->module->base_bdevs_constraint.type) {
 	case CONSTRAINT_MAX_BASE_BDEVS_REMOVED:
@@ -31,6 +31,7 @@ DEFINE_STUB_V(raid_bdev_io_init, (struct raid_bdev_io *raid_io,
 DEFINE_STUB(raid_bdev_remap_dix_reftag, int, (void *md_buf, uint64_t num_blocks,
 		struct spdk_bdev *bdev, uint32_t remapped_offset), -1);
 DEFINE_STUB(spdk_bdev_notify_blockcnt_change, int, (struct spdk_bdev *bdev, uint64_t size), 0);
+DEFINE_STUB(spdk_bdev_io_get_submit_tsc, uint64_t, (struct spdk_bdev_io *bdev_io), 0);
 DEFINE_STUB(spdk_bdev_flush_blocks, int, (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 		uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb,
 		void *cb_arg), 0);
@@ -223,8 +224,8 @@ _test_raid1_read_balancing(struct raid_bdev *raid_bdev, struct raid_bdev_io_chan
 	}
 
 	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
-		CU_ASSERT(raid1_ch->read_blocks_outstanding[i] == n * small_io_blocks);
-		raid1_ch->read_blocks_outstanding[i] = 0;
+		CU_ASSERT(raid1_ch->base[i].read_blocks_outstanding == n * small_io_blocks);
+		raid1_ch->base[i].read_blocks_outstanding = 0;
 	}
 
 	/*
@@ -246,7 +247,7 @@ _test_raid1_read_balancing(struct raid_bdev *raid_bdev, struct raid_bdev_io_chan
 	}
 
 	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
-		CU_ASSERT(raid1_ch->read_blocks_outstanding[i] == big_io_blocks);
+		CU_ASSERT(raid1_ch->base[i].read_blocks_outstanding == big_io_blocks);
 	}
 
 	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, small_io_blocks);
@@ -446,7 +447,7 @@ _test_raid1_read_error(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel
 	/* read from base bdev #1 fails, read from #0 succeeds */
 	base_info->is_failed = false;
 	base_info = &raid_bdev->base_bdev_info[1];
-	raid1_ch->read_blocks_outstanding[0] = 123;
+	raid1_ch->base[0].read_blocks_outstanding = 123;
 	g_io_status = SPDK_BDEV_IO_STATUS_PENDING;
 	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 64);
 	raid1_submit_read_request(raid_io);
@@ -508,6 +509,118 @@ test_raid1_read_error(void)
 	run_for_each_raid1_config(_test_raid1_read_error);
 }
 
+static void
+_test_raid1_read_policy(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid1_info *r1_info = raid_bdev->module_private;
+	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	struct spdk_bdev_io bdev_io = {};
+	struct raid_bdev_io *raid_io;
+	uint8_t last = raid_bdev->num_base_bdevs - 1;
+	uint8_t i, idx;
+	int n;
+
+	/* preferred - all reads go to the preferred base bdev while it is available */
+	raid_bdev->read_policy = RAID_READ_POLICY_PREFERRED;
+	raid_bdev->read_preferred_slot = last;
+	for (n = 0; n < 4; n++) {
+		raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 8);
+		raid1_submit_read_request(raid_io);
+		CU_ASSERT(raid_io->base_bdev_io_submitted == last);
+		put_raid_io(raid_io);
+	}
+	CU_ASSERT(raid1_ch->base[last].read_blocks_outstanding == 32);
+	raid1_ch->base[last].read_blocks_outstanding = 0;
+	raid1_ch->base[last].reads_outstanding = 0;
+
+	raid_ch->_base_channels[last] = NULL;
+	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 8);
+	raid1_submit_read_request(raid_io);
+	CU_ASSERT(raid_io->base_bdev_io_submitted == 0);
+	put_raid_io(raid_io);
+	raid_ch->_base_channels[last] = (void *)1;
+	raid1_ch->base[0].read_blocks_outstanding = 0;
+	raid1_ch->base[0].reads_outstanding = 0;
+
+	/* sequential - a read adjacent to the previous one stays on the same base bdev */
+	raid_bdev->read_policy = RAID_READ_POLICY_SEQUENTIAL;
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		raid1_ch->base[i].read_offset_next = UINT64_MAX;
+	}
+	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 8);
+	raid_io->offset_blocks = 1000;
+	raid1_submit_read_request(raid_io);
+	idx = raid_io->base_bdev_io_submitted;
+	put_raid_io(raid_io);
+	for (n = 1; n < 8; n++) {
+		raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 8);
+		raid_io->offset_blocks = 1000 + n * 8;
+		raid1_submit_read_request(raid_io);
+		CU_ASSERT(raid_io->base_bdev_io_submitted == idx);
+		put_raid_io(raid_io);
+	}
+	CU_ASSERT(raid1_ch->base[idx].stats.sequential_reads == 7);
+
+	/* a non-adjacent read goes to the least loaded base bdev */
+	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 8);
+	raid_io->offset_blocks = 0;
+	raid1_submit_read_request(raid_io);
+	CU_ASSERT(raid_io->base_bdev_io_submitted != idx);
+	put_raid_io(raid_io);
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		raid1_ch->base[i].read_blocks_outstanding = 0;
+		raid1_ch->base[i].reads_outstanding = 0;
+	}
+
+	/* latency - reads go to the base bdev with the lowest latency */
+	raid_bdev->read_policy = RAID_READ_POLICY_LATENCY;
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		raid1_ch->base[i].read_latency_ewma = i == last ? 10 : 100;
+		raid1_ch->base[i].read_seq_last = raid1_ch->read_seq;
+	}
+
+	/* the fast base bdev takes reads until its queue makes it as slow as the others */
+	for (n = 0; n < 9; n++) {
+		raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 8);
+		raid1_submit_read_request(raid_io);
+		CU_ASSERT(raid_io->base_bdev_io_submitted == last);
+		put_raid_io(raid_io);
+	}
+	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 8);
+	raid1_submit_read_request(raid_io);
+	CU_ASSERT(raid_io->base_bdev_io_submitted != last);
+	idx = raid_io->base_bdev_io_submitted;
+
+	/* a completion updates the latency estimate */
+	ut_spdk_get_ticks = 1000;
+	MOCK_SET(spdk_bdev_io_get_submit_tsc, 500);
+	raid1_read_bdev_io_completion(&bdev_io, true, raid_io);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(raid1_ch->base[idx].read_latency_ewma == 100 - (100 >> RAID1_LATENCY_EWMA_SHIFT) +
+		  (500 >> RAID1_LATENCY_EWMA_SHIFT));
+	CU_ASSERT(raid1_ch->base[idx].stats.reads == 1);
+	CU_ASSERT(raid1_ch->base[idx].stats.latency_ticks == 500);
+	MOCK_CLEAR(spdk_bdev_io_get_submit_tsc);
+	ut_spdk_get_ticks = 0;
+
+	/* a base bdev not selected for a long time is probed */
+	raid1_ch->base[0].read_seq_last = raid1_ch->read_seq - RAID1_LATENCY_PROBE_INTERVAL - 1;
+	raid1_ch->base[0].read_latency_ewma = UINT32_MAX;
+	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 8);
+	raid1_submit_read_request(raid_io);
+	CU_ASSERT(raid_io->base_bdev_io_submitted == 0);
+	put_raid_io(raid_io);
+
+	raid_bdev->read_policy = RAID_READ_POLICY_LEAST_OUTSTANDING;
+}
+
+static void
+test_raid1_read_policy(void)
+{
+	run_for_each_raid1_config(_test_raid1_read_policy);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -521,6 +634,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_raid1_read_balancing);
 	CU_ADD_TEST(suite, test_raid1_write_error);
 	CU_ADD_TEST(suite, test_raid1_read_error);
+	CU_ADD_TEST(suite, test_raid1_read_policy);
 
 	allocate_threads(1);
 	set_thread(0);
@@ -0,0 +1,841 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "spdk/env.h"
+
+#include "common/lib/ut_multithread.c"
+
+#include "bdev/raid/raid10.c"
+#include "../common.c"
+
+#define MAX_BASE_BDEVS 5
+
+DEFINE_STUB_V(raid_bdev_module_list_add, (struct raid_bdev_module *raid_module));
+DEFINE_STUB_V(raid_bdev_module_stop_done, (struct raid_bdev *raid_bdev));
+DEFINE_STUB_V(raid_bdev_queue_io_wait, (struct raid_bdev_io *raid_io, struct spdk_bdev *bdev,
+					struct spdk_io_channel *ch, spdk_bdev_io_wait_cb cb_fn));
+DEFINE_STUB(raid_bdev_remap_dix_reftag, int, (void *md_buf, uint64_t num_blocks,
+		struct spdk_bdev *bdev, uint32_t remapped_offset), -1);
+DEFINE_STUB(raid_bdev_layout_to_str, const char *, (enum raid_layout layout), "");
+
+/* Contents of the simulated base bdevs */
+static void *g_disks[MAX_BASE_BDEVS];
+/* Fail the next read submitted to the base bdev */
+static bool g_fail_read[MAX_BASE_BDEVS];
+static uint32_t g_reads_submitted[MAX_BASE_BDEVS];
+static uint32_t g_writes_submitted[MAX_BASE_BDEVS];
+
+struct test_bdev_io {
+	struct spdk_bdev_io bdev_io;
+	bool success;
+	spdk_bdev_io_completion_cb cb;
+	void *cb_arg;
+	TAILQ_ENTRY(test_bdev_io) link;
+};
+
+static TAILQ_HEAD(, test_bdev_io) g_bdev_io_queue = TAILQ_HEAD_INITIALIZER(g_bdev_io_queue);
+
+struct test_raid_bdev_io {
+	struct raid_bdev_io raid_io;
+	bool completed;
+	enum spdk_bdev_io_status status;
+};
+
+static int g_process_status;
+static bool g_process_completed;
+
+void
+raid_bdev_process_request_complete(struct raid_bdev_process_request *process_req, int status)
+{
+	CU_ASSERT(!g_process_completed);
+	g_process_completed = true;
+	g_process_status = status;
+}
+
+void
+raid_bdev_fail_base_bdev(struct raid_base_bdev_info *base_info)
+{
+	base_info->is_failed = true;
+}
+
+void
+raid_bdev_io_init(struct raid_bdev_io *raid_io, struct raid_bdev_io_channel *raid_ch,
+		  enum spdk_bdev_io_type type, uint64_t offset_blocks,
+		  uint64_t num_blocks, struct iovec *iovs, int iovcnt, void *md_buf,
+		  struct spdk_memory_domain *memory_domain, void *memory_domain_ctx)
+{
+	struct raid_bdev *raid_bdev = spdk_io_channel_get_io_device(spdk_io_channel_from_ctx(raid_ch));
+
+	raid_test_bdev_io_init(raid_io, raid_bdev, raid_ch, type, offset_blocks, num_blocks, iovs,
+			       iovcnt, md_buf);
+}
+
+void
+raid_test_bdev_io_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
+{
+	struct test_raid_bdev_io *test_io = SPDK_CONTAINEROF(raid_io, struct test_raid_bdev_io, raid_io);
+
+	CU_ASSERT(!test_io->completed);
+	test_io->completed = true;
+	test_io->status = status;
+}
+
+void
+spdk_bdev_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(SPDK_CONTAINEROF(bdev_io, struct test_bdev_io, bdev_io));
+}
+
+static void
+queue_io_completion(struct spdk_bdev *bdev, bool success, spdk_bdev_io_completion_cb cb,
+		    void *cb_arg)
+{
+	struct test_bdev_io *test_io;
+
+	test_io = calloc(1, sizeof(*test_io));
+	SPDK_CU_ASSERT_FATAL(test_io != NULL);
+	test_io->bdev_io.bdev = bdev;
+	test_io->success = success;
+	test_io->cb = cb;
+	test_io->cb_arg = cb_arg;
+	TAILQ_INSERT_TAIL(&g_bdev_io_queue, test_io, link);
+}
+
+static void *
+disk_buf(struct spdk_bdev_desc *desc, uint64_t offset_blocks, uint64_t num_blocks, uint8_t *idx)
+{
+	struct spdk_bdev *bdev = desc->bdev;
+	struct raid_base_bdev_info *base_info = bdev->ctxt;
+
+	SPDK_CU_ASSERT_FATAL(offset_blocks + num_blocks <= base_info->data_size);
+	*idx = raid_bdev_base_bdev_slot(base_info);
+
+	return g_disks[*idx] + offset_blocks * bdev->blocklen;
+}
+
+int
+spdk_bdev_readv_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			   struct iovec *iov, int iovcnt, uint64_t offset_blocks,
+			   uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg,
+			   struct spdk_bdev_ext_io_opts *opts)
+{
+	struct iovec disk_iov;
+	uint8_t idx;
+	bool success;
+
+	CU_ASSERT(ch != NULL);
+
+	disk_iov.iov_base = disk_buf(desc, offset_blocks, num_blocks, &idx);
+	disk_iov.iov_len = num_blocks * desc->bdev->blocklen;
+
+	success = !g_fail_read[idx];
+	g_fail_read[idx] = false;
+	if (success) {
+		spdk_iovcpy(&disk_iov, 1, iov, iovcnt);
+	}
+	g_reads_submitted[idx]++;
+
+	queue_io_completion(desc->bdev, success, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_writev_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			    struct iovec *iov, int iovcnt, uint64_t offset_blocks,
+			    uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg,
+			    struct spdk_bdev_ext_io_opts *opts)
+{
+	struct iovec disk_iov;
+	uint8_t idx;
+
+	CU_ASSERT(ch != NULL);
+
+	disk_iov.iov_base = disk_buf(desc, offset_blocks, num_blocks, &idx);
+	disk_iov.iov_len = num_blocks * desc->bdev->blocklen;
+
+	spdk_iovcpy(iov, iovcnt, &disk_iov, 1);
+	g_writes_submitted[idx]++;
+
+	queue_io_completion(desc->bdev, true, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_unmap_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	uint8_t idx;
+
+	CU_ASSERT(ch != NULL);
+
+	memset(disk_buf(desc, offset_blocks, num_blocks, &idx), 0, num_blocks * desc->bdev->blocklen);
+
+	queue_io_completion(desc->bdev, true, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_flush_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	uint8_t idx;
+
+	CU_ASSERT(ch != NULL);
+
+	disk_buf(desc, offset_blocks, num_blocks, &idx);
+
+	queue_io_completion(desc->bdev, true, cb, cb_arg);
+
+	return 0;
+}
+
+static void
+process_io_completions(void)
+{
+	struct test_bdev_io *test_io;
+
+	while ((test_io = TAILQ_FIRST(&g_bdev_io_queue))) {
+		TAILQ_REMOVE(&g_bdev_io_queue, test_io, link);
+		test_io->cb(&test_io->bdev_io, test_io->success, test_io->cb_arg);
+	}
+}
+
+static int
+test_suite_init(void)
+{
+	uint8_t num_base_bdevs_values[] = { 2, 3, 4, 5 };
+	uint8_t num_copies_values[] = { 2, 3 };
+	enum raid_layout layout_values[] = { RAID_LAYOUT_NEAR, RAID_LAYOUT_FAR };
+	uint32_t base_bdev_blocklen_values[] = { 512, 4096 };
+	uint8_t *num_base_bdevs;
+	uint8_t *num_copies;
+	enum raid_layout *layout;
+	uint32_t *base_bdev_blocklen;
+	uint64_t params_count;
+	int rc;
+
+	params_count = SPDK_COUNTOF(num_base_bdevs_values) *
+		       SPDK_COUNTOF(num_copies_values) *
+		       SPDK_COUNTOF(layout_values) *
+		       SPDK_COUNTOF(base_bdev_blocklen_values);
+	rc = raid_test_params_alloc(params_count);
+	if (rc) {
+		return rc;
+	}
+
+	ARRAY_FOR_EACH(num_base_bdevs_values, num_base_bdevs) {
+		ARRAY_FOR_EACH(num_copies_values, num_copies) {
+			ARRAY_FOR_EACH(layout_values, layout) {
+				ARRAY_FOR_EACH(base_bdev_blocklen_values, base_bdev_blocklen) {
+					struct raid_params params = {
+						.num_base_bdevs = *num_base_bdevs,
+						/* not a multiple of the strip size or number of copies */
+						.base_bdev_blockcnt = 103,
+						.base_bdev_blocklen = *base_bdev_blocklen,
+						.strip_size = 4 * 1024 / *base_bdev_blocklen,
+						.num_copies = *num_copies,
+						.layout = *layout,
+					};
+
+					if (*num_copies > *num_base_bdevs) {
+						continue;
+					}
+					raid_test_params_add(&params);
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
+static int
+test_suite_cleanup(void)
+{
+	raid_test_params_free();
+	return 0;
+}
+
+static int
+test_raid_ch_create(void *io_device, void *ctx_buf)
+{
+	struct raid_bdev_io_channel *raid_ch = raid_test_create_io_channel(io_device);
+
+	memcpy(ctx_buf, raid_ch, sizeof(*raid_ch));
+	free(raid_ch);
+
+	return 0;
+}
+
+static void
+test_raid_ch_destroy(void *io_device, void *ctx_buf)
+{
+	struct raid_bdev_io_channel *raid_ch = ctx_buf;
+
+	free(raid_ch->_base_channels);
+	spdk_put_io_channel(raid_ch->_module_channel);
+}
+
+struct test_raid10 {
+	struct raid_bdev *raid_bdev;
+	struct spdk_io_channel *ch;
+	struct raid_bdev_io_channel *raid_ch;
+	uint32_t blocklen;
+	/* Expected contents of the raid bdev */
+	void *data;
+};
+
+static void
+create_raid10(struct test_raid10 *t, struct raid_params *params)
+{
+	struct raid_bdev *raid_bdev = raid_test_create_raid_bdev(params, &g_raid10_module);
+	uint8_t i;
+
+	SPDK_CU_ASSERT_FATAL(raid10_start(raid_bdev) == 0);
+
+	memset(t, 0, sizeof(*t));
+	t->raid_bdev = raid_bdev;
+	t->blocklen = raid_bdev->bdev.blocklen;
+
+	spdk_io_device_register(raid_bdev, test_raid_ch_create, test_raid_ch_destroy,
+				sizeof(struct raid_bdev_io_channel), NULL);
+	t->ch = spdk_get_io_channel(raid_bdev);
+	SPDK_CU_ASSERT_FATAL(t->ch != NULL);
+	t->raid_ch = spdk_io_channel_get_ctx(t->ch);
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		g_disks[i] = calloc(params->base_bdev_blockcnt, t->blocklen);
+		SPDK_CU_ASSERT_FATAL(g_disks[i] != NULL);
+	}
+
+	t->data = calloc(raid_bdev->bdev.blockcnt, t->blocklen);
+	SPDK_CU_ASSERT_FATAL(t->data != NULL);
+
+	memset(g_fail_read, 0, sizeof(g_fail_read));
+	memset(g_reads_submitted, 0, sizeof(g_reads_submitted));
+	memset(g_writes_submitted, 0, sizeof(g_writes_submitted));
+}
+
+static void
+delete_raid10(struct test_raid10 *t)
+{
+	struct raid_bdev *raid_bdev = t->raid_bdev;
+	uint8_t i;
+
+	spdk_put_io_channel(t->ch);
+	poll_threads();
+
+	raid10_stop(raid_bdev);
+	spdk_io_device_unregister(raid_bdev, NULL);
+	poll_threads();
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		free(g_disks[i]);
+		g_disks[i] = NULL;
+	}
+
+	free(t->data);
+
+	raid_test_delete_raid_bdev(raid_bdev);
+}
+
+static void
+set_base_channel(struct test_raid10 *t, uint8_t idx, bool present)
+{
+	t->raid_ch->_base_channels[idx] = present ? (void *)1 : NULL;
+}
+
+static enum spdk_bdev_io_status
+submit_io(struct test_raid10 *t, enum spdk_bdev_io_type type, uint64_t offset_blocks,
+	  uint64_t num_blocks, void *buf)
+{
+	struct test_raid_bdev_io test_io = {};
+	struct iovec iov = {
+		.iov_base = buf,
+		.iov_len = num_blocks * t->blocklen,
+	};
+
+	raid_test_bdev_io_init(&test_io.raid_io, t->raid_bdev, t->raid_ch, type, offset_blocks,
+			       num_blocks, &iov, 1, NULL);
+
+	if (type == SPDK_BDEV_IO_TYPE_READ || type == SPDK_BDEV_IO_TYPE_WRITE) {
+		raid10_submit_rw_request(&test_io.raid_io);
+	} else {
+		raid10_submit_null_payload_request(&test_io.raid_io);
+	}
+	process_io_completions();
+
+	CU_ASSERT(test_io.completed);
+
+	return test_io.status;
+}
+
+static void *
+strip_copy_buf(struct test_raid10 *t, uint64_t strip, uint8_t copy, uint8_t *disk_idx)
+{
+	struct raid_bdev *raid_bdev = t->raid_bdev;
+	uint64_t disk_strip;
+
+	raid10_strip_copy_location(raid_bdev, strip, copy, disk_idx, &disk_strip);
+
+	return g_disks[*disk_idx] + disk_strip * raid_bdev->strip_size * t->blocklen;
+}
+
+static uint64_t
+num_strips(struct test_raid10 *t)
+{
+	return t->raid_bdev->bdev.blockcnt / t->raid_bdev->strip_size;
+}
+
+/* Write random data to every strip of the raid bdev */
+static void
+write_strips(struct test_raid10 *t)
+{
+	struct raid_bdev *raid_bdev = t->raid_bdev;
+	size_t strip_len = raid_bdev->strip_size * t->blocklen;
+	uint64_t strip, i;
+
+	for (i = 0; i < raid_bdev->bdev.blockcnt * t->blocklen; i++) {
+		((uint8_t *)t->data)[i] = rand();
+	}
+
+	for (strip = 0; strip < num_strips(t); strip++) {
+		CU_ASSERT(submit_io(t, SPDK_BDEV_IO_TYPE_WRITE, strip * raid_bdev->strip_size,
+				    raid_bdev->strip_size, t->data + strip * strip_len) ==
+			  SPDK_BDEV_IO_STATUS_SUCCESS);
+	}
+}
+
+/* Check that every copy of every strip on the base bdevs matches the expected data */
+static void
+verify_copies(struct test_raid10 *t, int skip_disk)
+{
+	struct raid_bdev *raid_bdev = t->raid_bdev;
+	size_t strip_len = raid_bdev->strip_size * t->blocklen;
+	uint64_t strip;
+	uint8_t copy, disk_idx;
+	void *buf;
+
+	for (strip = 0; strip < num_strips(t); strip++) {
+		for (copy = 0; copy < raid_bdev->num_copies; copy++) {
+			buf = strip_copy_buf(t, strip, copy, &disk_idx);
+			if (disk_idx == skip_disk) {
+				continue;
+			}
+			CU_ASSERT(memcmp(buf, t->data + strip * strip_len, strip_len) == 0);
+		}
+	}
+}
+
+static void
+verify_reads(struct test_raid10 *t)
+{
+	struct raid_bdev *raid_bdev = t->raid_bdev;
+	size_t strip_len = raid_bdev->strip_size * t->blocklen;
+	uint64_t strip;
+	void *buf;
+
+	buf = malloc(strip_len);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+
+	for (strip = 0; strip < num_strips(t); strip++) {
+		memset(buf, 0xee, strip_len);
+		CU_ASSERT(submit_io(t, SPDK_BDEV_IO_TYPE_READ, strip * raid_bdev->strip_size,
+				    raid_bdev->strip_size, buf) == SPDK_BDEV_IO_STATUS_SUCCESS);
+		CU_ASSERT(memcmp(buf, t->data + strip * strip_len, strip_len) == 0);
+	}
+
+	free(buf);
+}
+
+static void
+test_raid10_start(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct raid_bdev *raid_bdev = raid_test_create_raid_bdev(params, &g_raid10_module);
+		uint64_t disk_strips = params->base_bdev_blockcnt / params->strip_size;
+		uint64_t total_strips;
+		struct raid_base_bdev_info *base_info;
+
+		SPDK_CU_ASSERT_FATAL(raid10_start(raid_bdev) == 0);
+
+		if (params->layout == RAID_LAYOUT_NEAR) {
+			total_strips = disk_strips * params->num_base_bdevs / params->num_copies;
+		} else {
+			disk_strips -= disk_strips % params->num_copies;
+			total_strips = disk_strips / params->num_copies * params->num_base_bdevs;
+		}
+
+		CU_ASSERT_EQUAL(raid_bdev->bdev.blockcnt, total_strips * params->strip_size);
+		CU_ASSERT_EQUAL(raid_bdev->bdev.optimal_io_boundary, params->strip_size);
+		CU_ASSERT_TRUE(raid_bdev->bdev.split_on_optimal_io_boundary);
+
+		RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+			CU_ASSERT_EQUAL(base_info->data_size, disk_strips * params->strip_size);
+		}
+
+		raid10_stop(raid_bdev);
+		raid_test_delete_raid_bdev(raid_bdev);
+	}
+
+	/* more copies than base bdevs */
+	params = &g_params[0];
+	{
+		struct raid_bdev *raid_bdev = raid_test_create_raid_bdev(params, &g_raid10_module);
+
+		raid_bdev->num_copies = raid_bdev->num_base_bdevs + 1;
+		CU_ASSERT(raid10_start(raid_bdev) == -EINVAL);
+		raid_test_delete_raid_bdev(raid_bdev);
+	}
+}
+
+static void
+test_raid10_layout(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct test_raid10 t;
+		uint64_t disk_strips, strip, disk_strip;
+		uint8_t copy, disk_idx, i;
+		uint8_t *used;
+
+		create_raid10(&t, params);
+		disk_strips = t.raid_bdev->base_bdev_info[0].data_size / params->strip_size;
+
+		used = calloc(params->num_base_bdevs * disk_strips, 1);
+		SPDK_CU_ASSERT_FATAL(used != NULL);
+
+		/* every copy must be stored on a separate base bdev and no disk strip can be shared */
+		for (strip = 0; strip < num_strips(&t); strip++) {
+			bool disk_used[MAX_BASE_BDEVS] = {};
+
+			for (copy = 0; copy < params->num_copies; copy++) {
+				raid10_strip_copy_location(t.raid_bdev, strip, copy, &disk_idx, &disk_strip);
+				SPDK_CU_ASSERT_FATAL(disk_idx < params->num_base_bdevs);
+				SPDK_CU_ASSERT_FATAL(disk_strip < disk_strips);
+				CU_ASSERT(!disk_used[disk_idx]);
+				disk_used[disk_idx] = true;
+				CU_ASSERT(used[disk_idx * disk_strips + disk_strip] == 0);
+				used[disk_idx * disk_strips + disk_strip] = 1;
+			}
+		}
+
+		/* the capacity is evenly distributed */
+		for (i = 0; i < params->num_base_bdevs; i++) {
+			uint64_t n = 0;
+
+			for (disk_strip = 0; disk_strip < disk_strips; disk_strip++) {
+				n += used[i * disk_strips + disk_strip];
+			}
+			CU_ASSERT(n + 1 >= num_strips(&t) * params->num_copies / params->num_base_bdevs);
+		}
+
+		free(used);
+		delete_raid10(&t);
+	}
+}
+
+static void
+test_raid10_write_read(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct test_raid10 t;
+		struct test_raid_bdev_io test_io[3] = {};
+		struct iovec iov[3];
+		uint32_t reads = 0;
+		uint8_t copy, disk_idx, i;
+
+		create_raid10(&t, params);
+
+		write_strips(&t);
+		verify_copies(&t, -1);
+
+		for (i = 0; i < params->num_base_bdevs; i++) {
+			CU_ASSERT(g_writes_submitted[i] > 0);
+		}
+		verify_reads(&t);
+
+		/* every read is submitted to a single base bdev */
+		for (i = 0; i < params->num_base_bdevs; i++) {
+			reads += g_reads_submitted[i];
+		}
+		CU_ASSERT(reads == num_strips(&t));
+
+		/* concurrent reads of the same strip are spread across the copies */
+		memset(g_reads_submitted, 0, sizeof(g_reads_submitted));
+		for (copy = 0; copy < params->num_copies; copy++) {
+			iov[copy].iov_base = malloc(params->strip_size * t.blocklen);
+			iov[copy].iov_len = params->strip_size * t.blocklen;
+			SPDK_CU_ASSERT_FATAL(iov[copy].iov_base != NULL);
+			raid_test_bdev_io_init(&test_io[copy].raid_io, t.raid_bdev, t.raid_ch,
+					       SPDK_BDEV_IO_TYPE_READ, 0, params->strip_size, &iov[copy], 1, NULL);
+			raid10_submit_rw_request(&test_io[copy].raid_io);
+		}
+		for (copy = 0; copy < params->num_copies; copy++) {
+			strip_copy_buf(&t, 0, copy, &disk_idx);
+			CU_ASSERT(g_reads_submitted[disk_idx] == 1);
+		}
+		process_io_completions();
+		for (copy = 0; copy < params->num_copies; copy++) {
+			CU_ASSERT(test_io[copy].completed);
+			CU_ASSERT(test_io[copy].status == SPDK_BDEV_IO_STATUS_SUCCESS);
+			CU_ASSERT(memcmp(iov[copy].iov_base, t.data, iov[copy].iov_len) == 0);
+			free(iov[copy].iov_base);
+		}
+
+		delete_raid10(&t);
+	}
+}
+
+static void
+test_raid10_degraded(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct test_raid10 t;
+		uint8_t a, b;
+
+		create_raid10(&t, params);
+		write_strips(&t);
+
+		/* read with any num_copies - 1 base bdevs missing */
+		for (a = 0; a < params->num_base_bdevs; a++) {
+			for (b = a; b < params->num_base_bdevs; b++) {
+				if (b != a && params->num_copies < 3) {
+					continue;
+				}
+				set_base_channel(&t, a, false);
+				set_base_channel(&t, b, false);
+
+				verify_reads(&t);
+
+				set_base_channel(&t, a, true);
+				set_base_channel(&t, b, true);
+			}
+		}
+
+		/* write with a missing base bdev */
+		set_base_channel(&t, 0, false);
+		write_strips(&t);
+		verify_copies(&t, 0);
+		verify_reads(&t);
+		set_base_channel(&t, 0, true);
+
+		delete_raid10(&t);
+	}
+}
+
+static void
+test_raid10_read_error(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct test_raid10 t;
+		uint32_t writes_submitted[MAX_BASE_BDEVS];
+		uint32_t writes;
+		size_t strip_len;
+		uint8_t copy, disk_idx, i;
+		bool read_failed;
+		void *buf, *copy_buf, *expected;
+		uint64_t strip;
+
+		create_raid10(&t, params);
+		strip_len = params->strip_size * t.blocklen;
+		write_strips(&t);
+
+		buf = malloc(strip_len);
+		SPDK_CU_ASSERT_FATAL(buf != NULL);
+
+		for (strip = 0; strip < num_strips(&t); strip++) {
+			expected = t.data + strip * strip_len;
+
+			/* corrupt all copies but the last one and fail reads from them */
+			for (copy = 0; copy < params->num_copies - 1; copy++) {
+				copy_buf = strip_copy_buf(&t, strip, copy, &disk_idx);
+				memset(copy_buf, 0, strip_len);
+				g_fail_read[disk_idx] = true;
+			}
+			memcpy(writes_submitted, g_writes_submitted, sizeof(writes_submitted));
+
+			CU_ASSERT(submit_io(&t, SPDK_BDEV_IO_TYPE_READ, strip * params->strip_size,
+					    params->strip_size, buf) == SPDK_BDEV_IO_STATUS_SUCCESS);
+			CU_ASSERT(memcmp(buf, expected, strip_len) == 0);
+
+			/* if the first read failed, the copy it was submitted to has been corrected */
+			read_failed = false;
+			writes = 0;
+			for (copy = 0; copy < params->num_copies - 1; copy++) {
+				copy_buf = strip_copy_buf(&t, strip, copy, &disk_idx);
+				if (g_fail_read[disk_idx]) {
+					g_fail_read[disk_idx] = false;
+				} else {
+					read_failed = true;
+				}
+				if (g_writes_submitted[disk_idx] != writes_submitted[disk_idx]) {
+					CU_ASSERT(memcmp(copy_buf, expected, strip_len) == 0);
+				}
+				memcpy(copy_buf, expected, strip_len);
+			}
+			for (i = 0; i < params->num_base_bdevs; i++) {
+				writes += g_writes_submitted[i] - writes_submitted[i];
+				CU_ASSERT(!t.raid_bdev->base_bdev_info[i].is_failed);
+			}
+			CU_ASSERT(writes == (read_failed ? 1 : 0));
+		}
+
+		/* fail reads from all copies */
+		for (copy = 0; copy < params->num_copies; copy++) {
+			strip_copy_buf(&t, 0, copy, &disk_idx);
+			g_fail_read[disk_idx] = true;
+		}
+		CU_ASSERT(submit_io(&t, SPDK_BDEV_IO_TYPE_READ, 0, params->strip_size, buf) ==
+			  SPDK_BDEV_IO_STATUS_FAILED);
+		for (copy = 0; copy < params->num_copies; copy++) {
+			strip_copy_buf(&t, 0, copy, &disk_idx);
+			CU_ASSERT(!g_fail_read[disk_idx]);
+		}
+
+		free(buf);
+		delete_raid10(&t);
+	}
+}
+
+static void
+test_raid10_unmap(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct test_raid10 t;
+		uint64_t blockcnt, offset, num_blocks;
+		int i;
+
+		create_raid10(&t, params);
+		blockcnt = t.raid_bdev->bdev.blockcnt;
+
+		for (i = 0; i < 32; i++) {
+			write_strips(&t);
+
+			offset = rand() % blockcnt;
+			num_blocks = 1 + rand() % (blockcnt - offset);
+			if (i == 0) {
+				offset = 0;
+				num_blocks = blockcnt;
+			}
+
+			memset(t.data + offset * t.blocklen, 0, num_blocks * t.blocklen);
+			CU_ASSERT(submit_io(&t, SPDK_BDEV_IO_TYPE_UNMAP, offset, num_blocks, NULL) ==
+				  SPDK_BDEV_IO_STATUS_SUCCESS);
+			verify_copies(&t, -1);
+
+			CU_ASSERT(submit_io(&t, SPDK_BDEV_IO_TYPE_FLUSH, offset, num_blocks, NULL) ==
+				  SPDK_BDEV_IO_STATUS_SUCCESS);
+		}
+
+		delete_raid10(&t);
+	}
+}
+
+static void
+test_raid10_rebuild(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct raid_bdev_process_request process_req = {};
+		struct test_raid10 t;
+		uint64_t blockcnt, offset;
+		uint32_t window_sizes[] = { 1, 3, 64 };
+		uint32_t *window_size;
+		size_t disk_len;
+		uint8_t target;
+		int ret;
+
+		create_raid10(&t, params);
+		blockcnt = t.raid_bdev->bdev.blockcnt;
+		disk_len = t.raid_bdev->base_bdev_info[0].data_size * t.blocklen;
+		write_strips(&t);
+
+		process_req.iov.iov_base = malloc(64 * t.blocklen);
+		SPDK_CU_ASSERT_FATAL(process_req.iov.iov_base != NULL);
+
+		for (target = 0; target < params->num_base_bdevs; target++) {
+			ARRAY_FOR_EACH(window_sizes, window_size) {
+				memset(g_disks[target], 0xaa, disk_len);
+				set_base_channel(&t, target, false);
+
+				process_req.target = &t.raid_bdev->base_bdev_info[target];
+				process_req.target_ch = (void *)1;
+
+				for (offset = 0; offset < blockcnt; offset += ret) {
+					process_req.offset_blocks = offset;
+					process_req.num_blocks = spdk_min(*window_size, blockcnt - offset);
+					process_req.iov.iov_len = process_req.num_blocks * t.blocklen;
+					g_process_completed = false;
+					g_process_status = -1;
+
+					ret = raid10_submit_process_request(&process_req, t.raid_ch);
+					SPDK_CU_ASSERT_FATAL(ret > 0);
+					SPDK_CU_ASSERT_FATAL(ret <= (int)process_req.num_blocks);
+					process_req.num_blocks = ret;
+
+					process_io_completions();
+					poll_threads();
+
+					CU_ASSERT(g_process_completed);
+					CU_ASSERT(g_process_status == 0);
+				}
+
+				verify_copies(&t, -1);
+				set_base_channel(&t, target, true);
+			}
+		}
+
+		free(process_req.iov.iov_base);
+		delete_raid10(&t);
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("raid10", test_suite_init, test_suite_cleanup);
+	CU_ADD_TEST(suite, test_raid10_start);
+	CU_ADD_TEST(suite, test_raid10_layout);
+	CU_ADD_TEST(suite, test_raid10_write_read);
+	CU_ADD_TEST(suite, test_raid10_degraded);
+	CU_ADD_TEST(suite, test_raid10_read_error);
+	CU_ADD_TEST(suite, test_raid10_unmap);
+	CU_ADD_TEST(suite, test_raid10_rebuild);
+
+	allocate_threads(1);
+	set_thread(0);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	free_threads();
+
+	return num_failures;
+}
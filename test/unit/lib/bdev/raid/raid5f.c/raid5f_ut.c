@@ -23,13 +23,30 @@ DEFINE_STUB(accel_channel_create, int, (void *io_device, void *ctx_buf), 0);
 DEFINE_STUB_V(accel_channel_destroy, (void *io_device, void *ctx_buf));
 DEFINE_STUB_V(raid_bdev_process_request_complete, (struct raid_bdev_process_request *process_req,
 		int status));
-DEFINE_STUB_V(raid_bdev_io_init, (struct raid_bdev_io *raid_io,
-				  struct raid_bdev_io_channel *raid_ch,
-				  enum spdk_bdev_io_type type, uint64_t offset_blocks,
-				  uint64_t num_blocks, struct iovec *iovs, int iovcnt, void *md_buf,
-				  struct spdk_memory_domain *memory_domain, void *memory_domain_ctx));
 DEFINE_STUB(raid_bdev_remap_dix_reftag, int, (void *md_buf, uint64_t num_blocks,
 		struct spdk_bdev *bdev, uint32_t remapped_offset), -1);
+DEFINE_STUB(spdk_bdev_io_type_supported, bool, (struct spdk_bdev *bdev,
+		enum spdk_bdev_io_type io_type), true);
+
+static struct spdk_raid_bdev_opts g_test_raid_opts;
+
+void
+raid_bdev_get_opts(struct spdk_raid_bdev_opts *opts)
+{
+	*opts = g_test_raid_opts;
+}
+
+void
+raid_bdev_io_init(struct raid_bdev_io *raid_io, struct raid_bdev_io_channel *raid_ch,
+		  enum spdk_bdev_io_type type, uint64_t offset_blocks,
+		  uint64_t num_blocks, struct iovec *iovs, int iovcnt, void *md_buf,
+		  struct spdk_memory_domain *memory_domain, void *memory_domain_ctx)
+{
+	struct raid_bdev *raid_bdev = spdk_io_channel_get_io_device(spdk_io_channel_from_ctx(raid_ch));
+
+	raid_test_bdev_io_init(raid_io, raid_bdev, raid_ch, type, offset_blocks, num_blocks, iovs,
+			       iovcnt, md_buf);
+}
 
 struct spdk_io_channel *
 spdk_accel_get_io_channel(void)
@@ -148,6 +165,7 @@ static void
 test_setup(void)
 {
 	g_test_degraded = false;
+	memset(&g_test_raid_opts, 0, sizeof(g_test_raid_opts));
 }
 
 static struct raid5f_info *
@@ -187,9 +205,19 @@ test_raid5f_start(void)
 		CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.blockcnt,
 				(params->base_bdev_blockcnt - params->base_bdev_blockcnt % params->strip_size) *
 				(params->num_base_bdevs - 1));
-		CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.optimal_io_boundary, params->strip_size);
 		CU_ASSERT_TRUE(r5f_info->raid_bdev->bdev.split_on_optimal_io_boundary);
-		CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.write_unit_size, r5f_info->stripe_blocks);
+		if (params->md_type == RAID_PARAMS_MD_SEPARATE) {
+			CU_ASSERT_FALSE(r5f_info->partial_stripe_writes);
+			CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.write_unit_size,
+					r5f_info->stripe_blocks);
+			CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.optimal_io_boundary, params->strip_size);
+			CU_ASSERT_TRUE(r5f_info->raid_bdev->bdev.split_on_write_unit);
+		} else {
+			CU_ASSERT_TRUE(r5f_info->partial_stripe_writes);
+			CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.write_unit_size, 1);
+			CU_ASSERT_EQUAL(r5f_info->raid_bdev->bdev.optimal_io_boundary, r5f_info->stripe_blocks);
+			CU_ASSERT_FALSE(r5f_info->raid_bdev->bdev.split_on_write_unit);
+		}
 
 		delete_raid5f(r5f_info);
 	}
@@ -224,6 +252,8 @@ struct raid_io_info {
 	size_t parity_md_buf_size;
 	void *degraded_buf;
 	void *degraded_md_buf;
+	/* Contents of the stripe's strips on the base bdevs, used by partial stripe requests */
+	void *strips_buf;
 	enum spdk_bdev_io_status status;
 	TAILQ_HEAD(, spdk_bdev_io) bdev_io_queue;
 	TAILQ_HEAD(, spdk_bdev_io_wait_entry) bdev_io_wait_queue;
@@ -242,6 +272,26 @@ struct test_raid_bdev_io {
 	void *buf_md;
 };
 
+/* Used by the stripe cache write backs, which are not submitted with get_raid_io() */
+static struct raid_io_info *g_cache_io_info;
+
+static inline bool
+raid_io_is_cache_flush(struct raid_bdev_io *raid_io)
+{
+	return raid_io->completion_cb == raid5f_cache_flush_write_complete;
+}
+
+static struct raid_io_info *
+stripe_req_io_info(struct stripe_request *stripe_req)
+{
+	if (raid_io_is_cache_flush(stripe_req->raid_io)) {
+		SPDK_CU_ASSERT_FATAL(g_cache_io_info != NULL);
+		return g_cache_io_info;
+	}
+
+	return SPDK_CONTAINEROF(stripe_req->raid_io, struct test_raid_bdev_io, raid_io)->io_info;
+}
+
 void
 raid_bdev_queue_io_wait(struct raid_bdev_io *raid_io, struct spdk_bdev *bdev,
 			struct spdk_io_channel *ch, spdk_bdev_io_wait_cb cb_fn)
@@ -397,6 +447,34 @@ process_io_completions(struct raid_io_info *io_info)
 	}
 }
 
+static int
+submit_partial_stripe_io(struct chunk *chunk, bool write, struct spdk_bdev_desc *desc,
+			 struct iovec *iov, int iovcnt, uint64_t offset_blocks, uint64_t num_blocks,
+			 spdk_bdev_io_completion_cb cb)
+{
+	struct stripe_request *stripe_req = raid5f_chunk_stripe_req(chunk);
+	struct raid_io_info *io_info = stripe_req_io_info(stripe_req);
+	struct raid_bdev *raid_bdev = io_info->r5f_info->raid_bdev;
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	struct iovec strip;
+
+	SPDK_CU_ASSERT_FATAL(io_info->strips_buf != NULL);
+	CU_ASSERT(offset_blocks >> raid_bdev->strip_size_shift == stripe_req->stripe_index);
+	CU_ASSERT(raid_bdev_channel_get_base_channel(io_info->raid_ch, chunk->index) != NULL);
+
+	strip.iov_base = io_info->strips_buf + chunk->index * raid_bdev->strip_size * blocklen +
+			 (offset_blocks % raid_bdev->strip_size) * blocklen;
+	strip.iov_len = num_blocks * blocklen;
+
+	if (write) {
+		spdk_iovcpy(iov, iovcnt, &strip, 1);
+	} else {
+		spdk_iovcpy(&strip, 1, iov, iovcnt);
+	}
+
+	return submit_io(io_info, desc, cb, chunk);
+}
+
 int
 spdk_bdev_writev_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 				struct iovec *iov, int iovcnt, void *md_buf,
@@ -417,6 +495,11 @@ spdk_bdev_writev_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_chan
 	SPDK_CU_ASSERT_FATAL(cb == raid5f_chunk_complete_bdev_io);
 
 	stripe_req = raid5f_chunk_stripe_req(chunk);
+	if (stripe_req->type == STRIPE_REQ_PARTIAL || raid_io_is_cache_flush(stripe_req->raid_io)) {
+		return submit_partial_stripe_io(chunk, true, desc, iov, iovcnt, offset_blocks, num_blocks,
+						cb);
+	}
+
 	test_raid_bdev_io = SPDK_CONTAINEROF(stripe_req->raid_io, struct test_raid_bdev_io, raid_io);
 	io_info = test_raid_bdev_io->io_info;
 	r5f_info = io_info->r5f_info;
@@ -468,6 +551,11 @@ spdk_bdev_readv_blocks_degraded(struct spdk_bdev_desc *desc, struct spdk_io_chan
 	SPDK_CU_ASSERT_FATAL(cb == raid5f_chunk_complete_bdev_io);
 
 	stripe_req = raid5f_chunk_stripe_req(chunk);
+	if (stripe_req->type == STRIPE_REQ_PARTIAL) {
+		return submit_partial_stripe_io(chunk, false, desc, iov, iovcnt, offset_blocks, num_blocks,
+						cb);
+	}
+
 	test_raid_bdev_io = SPDK_CONTAINEROF(stripe_req->raid_io, struct test_raid_bdev_io, raid_io);
 	io_info = test_raid_bdev_io->io_info;
 	raid_bdev = io_info->r5f_info->raid_bdev;
@@ -573,6 +661,20 @@ spdk_bdev_readv_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *
 					      num_blocks, cb, cb_arg);
 }
 
+int
+spdk_bdev_flush_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+	struct test_raid_bdev_io *test_raid_bdev_io = SPDK_CONTAINEROF(raid_io, struct test_raid_bdev_io,
+			raid_io);
+
+	SPDK_CU_ASSERT_FATAL(cb == raid5f_flush_complete);
+
+	return submit_io(test_raid_bdev_io->io_info, desc, cb, cb_arg);
+}
+
 static void
 xor_block(uint8_t *a, uint8_t *b, size_t size)
 {
@@ -676,6 +778,7 @@ deinit_io_info(struct raid_io_info *io_info)
 	free(io_info->reference_md_parity);
 	free(io_info->degraded_buf);
 	free(io_info->degraded_md_buf);
+	free(io_info->strips_buf);
 }
 
 static void
@@ -1115,6 +1218,444 @@ test_raid5f_submit_read_request_degraded(void)
 	run_for_each_raid5f_config(__test_raid5f_submit_read_request);
 }
 
+static void *
+strip_ptr(struct raid_io_info *io_info, uint8_t chunk_idx)
+{
+	struct raid_bdev *raid_bdev = io_info->r5f_info->raid_bdev;
+
+	return io_info->strips_buf + chunk_idx * raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+}
+
+static uint8_t
+data_chunk_index(struct raid_io_info *io_info, uint8_t data_chunk_idx)
+{
+	uint8_t p_idx = raid5f_stripe_parity_chunk_index(io_info->r5f_info->raid_bdev,
+			io_info->stripe_index);
+
+	return data_chunk_idx < p_idx ? data_chunk_idx : data_chunk_idx + 1;
+}
+
+/*
+ * Fill the simulated strips with the stripe data and its parity. Returns the stripe data,
+ * as it is laid out in the raid bdev.
+ */
+static void *
+io_info_setup_strips(struct raid_io_info *io_info)
+{
+	struct raid5f_info *r5f_info = io_info->r5f_info;
+	struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
+	size_t strip_len = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	uint8_t p_idx = raid5f_stripe_parity_chunk_index(raid_bdev, io_info->stripe_index);
+	void *stripe_data;
+	uint64_t block;
+	uint8_t i;
+
+	stripe_data = malloc(r5f_info->stripe_blocks * raid_bdev->bdev.blocklen);
+	SPDK_CU_ASSERT_FATAL(stripe_data != NULL);
+
+	memset(stripe_data, 0x5a, r5f_info->stripe_blocks * raid_bdev->bdev.blocklen);
+	for (block = 0; block < r5f_info->stripe_blocks; block++) {
+		*((uint64_t *)(stripe_data + block * raid_bdev->bdev.blocklen)) = ~block;
+	}
+
+	io_info->strips_buf = calloc(raid_bdev->num_base_bdevs, strip_len);
+	SPDK_CU_ASSERT_FATAL(io_info->strips_buf != NULL);
+
+	for (i = 0; i < raid5f_stripe_data_chunks_num(raid_bdev); i++) {
+		memcpy(strip_ptr(io_info, data_chunk_index(io_info, i)), stripe_data + i * strip_len,
+		       strip_len);
+		xor_block(strip_ptr(io_info, p_idx), stripe_data + i * strip_len, strip_len);
+	}
+
+	return stripe_data;
+}
+
+/* Verify the simulated strips, except the ones of the missing base bdevs */
+static void
+io_info_verify_strips(struct raid_io_info *io_info, void *stripe_data)
+{
+	struct raid_bdev *raid_bdev = io_info->r5f_info->raid_bdev;
+	size_t strip_len = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	uint8_t p_idx = raid5f_stripe_parity_chunk_index(raid_bdev, io_info->stripe_index);
+	void *parity;
+	uint8_t i;
+
+	parity = calloc(1, strip_len);
+	SPDK_CU_ASSERT_FATAL(parity != NULL);
+
+	for (i = 0; i < raid5f_stripe_data_chunks_num(raid_bdev); i++) {
+		uint8_t chunk_idx = data_chunk_index(io_info, i);
+
+		xor_block(parity, stripe_data + i * strip_len, strip_len);
+
+		if (raid_bdev_channel_get_base_channel(io_info->raid_ch, chunk_idx) != NULL) {
+			CU_ASSERT(memcmp(strip_ptr(io_info, chunk_idx), stripe_data + i * strip_len,
+					 strip_len) == 0);
+		}
+	}
+
+	if (raid_bdev_channel_get_base_channel(io_info->raid_ch, p_idx) != NULL) {
+		CU_ASSERT(memcmp(strip_ptr(io_info, p_idx), parity, strip_len) == 0);
+	}
+
+	free(parity);
+}
+
+static void
+run_partial_stripe_requests(struct raid_io_info **io_infos, int num)
+{
+	bool pending;
+	int i, n;
+
+	for (n = 0; n < 100; n++) {
+		poll_threads();
+
+		pending = false;
+		for (i = 0; i < num; i++) {
+			process_io_completions(io_infos[i]);
+			pending |= io_infos[i]->status == SPDK_BDEV_IO_STATUS_PENDING;
+		}
+
+		if (!pending) {
+			break;
+		}
+	}
+
+	CU_ASSERT(!pending);
+}
+
+static void
+test_raid5f_submit_partial_request(struct raid5f_info *r5f_info, struct raid_bdev_io_channel *raid_ch,
+				   enum spdk_bdev_io_type io_type, uint64_t stripe_index,
+				   uint64_t stripe_offset_blocks, uint64_t num_blocks)
+{
+	struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	struct raid_io_info io_info, *io_infos[] = { &io_info };
+	void *stripe_data;
+
+	init_io_info(&io_info, r5f_info, raid_ch, io_type, stripe_index, stripe_offset_blocks, num_blocks);
+
+	stripe_data = io_info_setup_strips(&io_info);
+
+	if (io_type == SPDK_BDEV_IO_TYPE_WRITE) {
+		memcpy(stripe_data + stripe_offset_blocks * blocklen, io_info.src_buf, io_info.buf_size);
+	} else if (g_test_degraded) {
+		memset(strip_ptr(&io_info, 0), 0xcd, raid_bdev->strip_size * blocklen);
+	}
+
+	raid5f_submit_rw_request(get_raid_io(&io_info));
+
+	run_partial_stripe_requests(io_infos, 1);
+
+	CU_ASSERT(io_info.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	if (io_type == SPDK_BDEV_IO_TYPE_WRITE) {
+		io_info_verify_strips(&io_info, stripe_data);
+	} else {
+		CU_ASSERT(memcmp(io_info.dest_buf, stripe_data + stripe_offset_blocks * blocklen,
+				 io_info.buf_size) == 0);
+	}
+
+	free(stripe_data);
+	deinit_io_info(&io_info);
+}
+
+static void
+__test_raid5f_submit_partial_stripe_request(struct raid_bdev *raid_bdev,
+		struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid5f_info *r5f_info = raid_bdev->module_private;
+	uint64_t strip_size = raid_bdev->strip_size;
+	uint64_t stripe_blocks = r5f_info->stripe_blocks;
+	struct {
+		uint64_t offset;
+		uint64_t num_blocks;
+	} *req, reqs[] = {
+		{ 0, 1 },
+		{ stripe_blocks - 1, 1 },
+		{ 0, strip_size },
+		{ strip_size, strip_size },
+		{ strip_size - 1, 2 },
+		{ strip_size / 2, strip_size },
+		{ strip_size / 2, stripe_blocks - strip_size },
+		{ 0, stripe_blocks - 1 },
+		{ 1, stripe_blocks - 1 },
+		{ 1, stripe_blocks - 2 },
+	};
+	uint64_t stripe_index;
+
+	if (!r5f_info->partial_stripe_writes) {
+		return;
+	}
+
+	RAID5F_TEST_FOR_EACH_STRIPE(raid_bdev, stripe_index) {
+		ARRAY_FOR_EACH(reqs, req) {
+			if (req->num_blocks == 0 || req->num_blocks >= stripe_blocks ||
+			    req->offset + req->num_blocks > stripe_blocks) {
+				continue;
+			}
+
+			test_raid5f_submit_partial_request(r5f_info, raid_ch, SPDK_BDEV_IO_TYPE_WRITE,
+							   stripe_index, req->offset, req->num_blocks);
+
+			/* Reads within a single strip don't use partial stripe requests */
+			if (req->offset / strip_size != (req->offset + req->num_blocks - 1) / strip_size) {
+				test_raid5f_submit_partial_request(r5f_info, raid_ch, SPDK_BDEV_IO_TYPE_READ,
+								   stripe_index, req->offset, req->num_blocks);
+			}
+		}
+	}
+}
+static void
+test_raid5f_submit_partial_stripe_request(void)
+{
+	run_for_each_raid5f_config(__test_raid5f_submit_partial_stripe_request);
+}
+
+static void
+test_raid5f_submit_partial_stripe_request_degraded(void)
+{
+	g_test_degraded = true;
+	run_for_each_raid5f_config(__test_raid5f_submit_partial_stripe_request);
+}
+
+static void
+__test_raid5f_stripe_lock(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid5f_info *r5f_info = raid_bdev->module_private;
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	struct raid_io_info io_info1, io_info2, io_info3;
+	struct raid_io_info *io_infos[] = { &io_info1, &io_info2, &io_info3 };
+	struct raid_bdev_io *raid_io1, *raid_io2, *raid_io3;
+	struct stripe_request *stripe_req1, *stripe_req2, *stripe_req3;
+	uint64_t num_blocks = raid_bdev->strip_size + 1;
+	void *stripe_data;
+
+	if (!r5f_info->partial_stripe_writes || num_blocks >= r5f_info->stripe_blocks) {
+		return;
+	}
+
+	init_io_info(&io_info1, r5f_info, raid_ch, SPDK_BDEV_IO_TYPE_WRITE, 0, 0, num_blocks);
+	init_io_info(&io_info2, r5f_info, raid_ch, SPDK_BDEV_IO_TYPE_WRITE, 0, 1, num_blocks);
+	memset(io_info2.src_buf, 0x33, io_info2.buf_size);
+	/* Partial stripe reads take the stripe lock too and see both writes */
+	init_io_info(&io_info3, r5f_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 0, 0, num_blocks);
+
+	stripe_data = io_info_setup_strips(&io_info1);
+	io_info2.strips_buf = io_info1.strips_buf;
+	io_info3.strips_buf = io_info1.strips_buf;
+
+	memcpy(stripe_data, io_info1.src_buf, io_info1.buf_size);
+	memcpy(stripe_data + blocklen, io_info2.src_buf, io_info2.buf_size);
+
+	raid_io1 = get_raid_io(&io_info1);
+	raid_io2 = get_raid_io(&io_info2);
+	raid_io3 = get_raid_io(&io_info3);
+
+	raid5f_submit_rw_request(raid_io1);
+	raid5f_submit_rw_request(raid_io2);
+	raid5f_submit_rw_request(raid_io3);
+
+	stripe_req1 = raid_io1->module_private;
+	stripe_req2 = raid_io2->module_private;
+	stripe_req3 = raid_io3->module_private;
+	CU_ASSERT(stripe_req1->stripe_locked);
+	CU_ASSERT(!stripe_req2->stripe_locked);
+	CU_ASSERT(!stripe_req3->stripe_locked);
+	CU_ASSERT(TAILQ_FIRST(&stripe_req1->lock_waiters) == stripe_req2);
+	CU_ASSERT(TAILQ_NEXT(stripe_req2, link) == stripe_req3);
+	CU_ASSERT(TAILQ_EMPTY(&io_info2.bdev_io_queue));
+	CU_ASSERT(TAILQ_EMPTY(&io_info3.bdev_io_queue));
+
+	run_partial_stripe_requests(io_infos, 3);
+
+	CU_ASSERT(io_info1.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(io_info2.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(io_info3.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	io_info_verify_strips(&io_info1, stripe_data);
+	CU_ASSERT(memcmp(io_info3.dest_buf, stripe_data, io_info3.buf_size) == 0);
+
+	io_info2.strips_buf = NULL;
+	io_info3.strips_buf = NULL;
+	free(stripe_data);
+	deinit_io_info(&io_info1);
+	deinit_io_info(&io_info2);
+	deinit_io_info(&io_info3);
+}
+static void
+test_raid5f_stripe_lock(void)
+{
+	run_for_each_raid5f_config(__test_raid5f_stripe_lock);
+}
+
+static int
+test_raid_ch_create(void *io_device, void *ctx_buf)
+{
+	struct raid_bdev_io_channel *raid_ch = raid_test_create_io_channel(io_device);
+
+	memcpy(ctx_buf, raid_ch, sizeof(*raid_ch));
+	free(raid_ch);
+
+	return 0;
+}
+
+static void
+test_raid_ch_destroy(void *io_device, void *ctx_buf)
+{
+	struct raid_bdev_io_channel *raid_ch = ctx_buf;
+
+	free(raid_ch->_base_channels);
+	spdk_put_io_channel(raid_ch->_module_channel);
+}
+
+static void
+run_stripe_cache_requests(struct raid5f_cache *cache, struct raid_io_info **io_infos, int num)
+{
+	int n;
+
+	for (n = 0; n < 100 && cache->num_used > 0; n++) {
+		poll_threads();
+		process_io_completions(g_cache_io_info);
+	}
+
+	CU_ASSERT(cache->num_used == 0);
+
+	run_partial_stripe_requests(io_infos, num);
+}
+
+static void
+test_raid5f_stripe_cache(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct raid5f_info *r5f_info;
+		struct raid_bdev *raid_bdev;
+		struct raid5f_cache *cache;
+		struct spdk_io_channel *ch;
+		struct raid_bdev_io_channel *raid_ch;
+		struct raid_io_info cache_io_info, io_info, flush_io_info;
+		struct raid_io_info *io_infos[] = { &io_info }, *flush_io_infos[] = { &flush_io_info };
+		uint64_t strip_size = params->strip_size;
+		uint32_t blocklen;
+		size_t stripe_len;
+		void *stripe_data, *expected;
+		uint8_t i;
+
+		if (params->md_type == RAID_PARAMS_MD_SEPARATE) {
+			continue;
+		}
+
+		blocklen = params->base_bdev_blocklen +
+			   (params->md_type == RAID_PARAMS_MD_INTERLEAVED ? 16 : 0);
+		stripe_len = strip_size * (params->num_base_bdevs - 1) * blocklen;
+		g_test_raid_opts.stripe_cache_size_kb = spdk_divide_round_up(2 * stripe_len, 1024);
+		g_test_raid_opts.stripe_cache_flush_delay_us = 1000000;
+
+		r5f_info = create_raid5f(params);
+		raid_bdev = r5f_info->raid_bdev;
+		cache = r5f_info->cache;
+		SPDK_CU_ASSERT_FATAL(cache != NULL);
+		CU_ASSERT(cache->num_entries >= 2);
+		CU_ASSERT(raid_bdev->bdev.write_cache == 1);
+		CU_ASSERT(raid5f_io_type_supported(raid_bdev, SPDK_BDEV_IO_TYPE_FLUSH));
+		CU_ASSERT(!raid5f_io_type_supported(raid_bdev, SPDK_BDEV_IO_TYPE_UNMAP));
+
+		raid_bdev->state = RAID_BDEV_STATE_ONLINE;
+		spdk_io_device_register(raid_bdev, test_raid_ch_create, test_raid_ch_destroy,
+					sizeof(struct raid_bdev_io_channel), NULL);
+		ch = spdk_get_io_channel(raid_bdev);
+		SPDK_CU_ASSERT_FATAL(ch != NULL);
+		raid_ch = spdk_io_channel_get_ctx(ch);
+
+		/* Simulated base bdevs, written by the cache write backs */
+		init_io_info(&cache_io_info, r5f_info, raid_ch, SPDK_BDEV_IO_TYPE_WRITE, 0, 0, 1);
+		cache_io_info.status = SPDK_BDEV_IO_STATUS_SUCCESS;
+		stripe_data = io_info_setup_strips(&cache_io_info);
+		g_cache_io_info = &cache_io_info;
+
+		expected = malloc(stripe_len);
+		SPDK_CU_ASSERT_FATAL(expected != NULL);
+		memcpy(expected, stripe_data, stripe_len);
+
+		/* Strip sized writes are absorbed and coalesced into a single full stripe write */
+		for (i = 0; i < raid5f_stripe_data_chunks_num(raid_bdev); i++) {
+			init_io_info(&io_info, r5f_info, raid_ch, SPDK_BDEV_IO_TYPE_WRITE, 0, i * strip_size,
+				     strip_size);
+			memset(io_info.src_buf, 0x10 + i, io_info.buf_size);
+			memcpy(expected + i * strip_size * blocklen, io_info.src_buf, io_info.buf_size);
+
+			raid5f_submit_rw_request(get_raid_io(&io_info));
+			CU_ASSERT(io_info.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+			deinit_io_info(&io_info);
+
+			if (i + 1 < raid5f_stripe_data_chunks_num(raid_bdev)) {
+				poll_threads();
+				CU_ASSERT(TAILQ_EMPTY(&cache_io_info.bdev_io_queue));
+				CU_ASSERT(cache->num_used == 1);
+			}
+		}
+
+		run_stripe_cache_requests(cache, NULL, 0);
+		io_info_verify_strips(&cache_io_info, expected);
+		CU_ASSERT(cache->stats.writes_cached == 1);
+		CU_ASSERT(cache->stats.writes_coalesced == raid5f_stripe_data_chunks_num(raid_bdev) - 1U);
+		CU_ASSERT(cache->stats.full_stripe_flushes == 1);
+		CU_ASSERT(cache->stats.partial_stripe_flushes == 0);
+
+		/* A read of cached data is served from the cache */
+		init_io_info(&io_info, r5f_info, raid_ch, SPDK_BDEV_IO_TYPE_WRITE, 0, 0, 1);
+		memset(io_info.src_buf, 0x77, io_info.buf_size);
+		memcpy(expected, io_info.src_buf, io_info.buf_size);
+		raid5f_submit_rw_request(get_raid_io(&io_info));
+		CU_ASSERT(io_info.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+		deinit_io_info(&io_info);
+
+		init_io_info(&io_info, r5f_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 0, 0, 1);
+		raid5f_submit_rw_request(get_raid_io(&io_info));
+		CU_ASSERT(io_info.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+		CU_ASSERT(TAILQ_EMPTY(&io_info.bdev_io_queue));
+		CU_ASSERT(memcmp(io_info.dest_buf, expected, io_info.buf_size) == 0);
+		CU_ASSERT(cache->stats.read_hits == 1);
+		deinit_io_info(&io_info);
+
+		/* A partially cached read gets the cached blocks over the data from the base bdevs */
+		if (strip_size > 1) {
+			init_io_info(&io_info, r5f_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 0, 0, 2);
+			memcpy(io_info.src_buf, expected, io_info.buf_size);
+			memset(io_info.src_buf, 0xee, blocklen);
+			raid5f_submit_rw_request(get_raid_io(&io_info));
+			run_partial_stripe_requests(io_infos, 1);
+			CU_ASSERT(io_info.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+			CU_ASSERT(memcmp(io_info.dest_buf, expected, io_info.buf_size) == 0);
+			CU_ASSERT(cache->stats.read_partial_hits == 1);
+			deinit_io_info(&io_info);
+		}
+
+		/* FLUSH writes back the cached data and is forwarded to the base bdevs */
+		init_io_info(&flush_io_info, r5f_info, raid_ch, SPDK_BDEV_IO_TYPE_FLUSH, 0, 0,
+			     r5f_info->stripe_blocks);
+		raid5f_submit_null_payload_request(get_raid_io(&flush_io_info));
+		CU_ASSERT(flush_io_info.status == SPDK_BDEV_IO_STATUS_PENDING);
+		run_stripe_cache_requests(cache, flush_io_infos, 1);
+		CU_ASSERT(flush_io_info.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+		io_info_verify_strips(&cache_io_info, expected);
+		CU_ASSERT(cache->stats.partial_stripe_flushes == 1);
+		deinit_io_info(&flush_io_info);
+
+		g_cache_io_info = NULL;
+		free(expected);
+		free(stripe_data);
+		deinit_io_info(&cache_io_info);
+
+		spdk_put_io_channel(ch);
+		raid5f_stop(raid_bdev);
+		spdk_io_device_unregister(raid_bdev, NULL);
+		poll_threads();
+		raid_test_delete_raid_bdev(raid_bdev);
+	}
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1133,6 +1674,10 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_raid5f_chunk_write_error_with_enomem);
 	CU_ADD_TEST(suite, test_raid5f_submit_full_stripe_write_request_degraded);
 	CU_ADD_TEST(suite, test_raid5f_submit_read_request_degraded);
+	CU_ADD_TEST(suite, test_raid5f_submit_partial_stripe_request);
+	CU_ADD_TEST(suite, test_raid5f_submit_partial_stripe_request_degraded);
+	CU_ADD_TEST(suite, test_raid5f_stripe_lock);
+	CU_ADD_TEST(suite, test_raid5f_stripe_cache);
 
 	allocate_threads(1);
 	set_thread(0);
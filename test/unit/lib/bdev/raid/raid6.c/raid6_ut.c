@@ -0,0 +1,640 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_internal/cunit.h"
+#include "spdk/env.h"
+#include "spdk/xor.h"
+
+#include "common/lib/ut_multithread.c"
+
+#include "bdev/raid/raid6.c"
+#include "../common.c"
+
+#define MAX_BASE_BDEVS 6
+
+DEFINE_STUB_V(raid_bdev_module_list_add, (struct raid_bdev_module *raid_module));
+DEFINE_STUB(spdk_bdev_get_buf_align, size_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB_V(raid_bdev_module_stop_done, (struct raid_bdev *raid_bdev));
+DEFINE_STUB_V(raid_bdev_queue_io_wait, (struct raid_bdev_io *raid_io, struct spdk_bdev *bdev,
+					struct spdk_io_channel *ch, spdk_bdev_io_wait_cb cb_fn));
+DEFINE_STUB(raid_bdev_remap_dix_reftag, int, (void *md_buf, uint64_t num_blocks,
+		struct spdk_bdev *bdev, uint32_t remapped_offset), -1);
+
+/* Contents of the simulated base bdevs */
+struct test_disk {
+	void *buf;
+	void *md_buf;
+};
+
+static struct test_disk g_disks[MAX_BASE_BDEVS];
+
+struct test_bdev_io {
+	struct spdk_bdev_io bdev_io;
+	bool success;
+	spdk_bdev_io_completion_cb cb;
+	void *cb_arg;
+	TAILQ_ENTRY(test_bdev_io) link;
+};
+
+static TAILQ_HEAD(, test_bdev_io) g_bdev_io_queue = TAILQ_HEAD_INITIALIZER(g_bdev_io_queue);
+static uint32_t g_bdev_io_submitted[MAX_BASE_BDEVS];
+
+struct test_raid_bdev_io {
+	struct raid_bdev_io raid_io;
+	bool completed;
+	enum spdk_bdev_io_status status;
+};
+
+static int g_process_status;
+static bool g_process_completed;
+
+void
+raid_bdev_process_request_complete(struct raid_bdev_process_request *process_req, int status)
+{
+	g_process_completed = true;
+	g_process_status = status;
+}
+
+void
+raid_bdev_io_init(struct raid_bdev_io *raid_io, struct raid_bdev_io_channel *raid_ch,
+		  enum spdk_bdev_io_type type, uint64_t offset_blocks,
+		  uint64_t num_blocks, struct iovec *iovs, int iovcnt, void *md_buf,
+		  struct spdk_memory_domain *memory_domain, void *memory_domain_ctx)
+{
+	struct raid_bdev *raid_bdev = spdk_io_channel_get_io_device(spdk_io_channel_from_ctx(raid_ch));
+
+	raid_test_bdev_io_init(raid_io, raid_bdev, raid_ch, type, offset_blocks, num_blocks, iovs,
+			       iovcnt, md_buf);
+}
+
+void
+raid_test_bdev_io_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
+{
+	struct test_raid_bdev_io *test_io = SPDK_CONTAINEROF(raid_io, struct test_raid_bdev_io, raid_io);
+
+	CU_ASSERT(!test_io->completed);
+	test_io->completed = true;
+	test_io->status = status;
+}
+
+void
+spdk_bdev_free_io(struct spdk_bdev_io *bdev_io)
+{
+	free(SPDK_CONTAINEROF(bdev_io, struct test_bdev_io, bdev_io));
+}
+
+static int
+submit_io(struct spdk_bdev_desc *desc, struct iovec *iov, int iovcnt, void *md_buf,
+	  uint64_t offset_blocks, uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg,
+	  bool write)
+{
+	struct spdk_bdev *bdev = desc->bdev;
+	struct raid_base_bdev_info *base_info = bdev->ctxt;
+	uint8_t idx = raid_bdev_base_bdev_slot(base_info);
+	struct test_disk *disk = &g_disks[idx];
+	struct iovec disk_iov;
+	struct test_bdev_io *test_io;
+
+	SPDK_CU_ASSERT_FATAL(offset_blocks + num_blocks <= bdev->blockcnt);
+
+	disk_iov.iov_base = disk->buf + offset_blocks * bdev->blocklen;
+	disk_iov.iov_len = num_blocks * bdev->blocklen;
+
+	if (write) {
+		spdk_iovcpy(iov, iovcnt, &disk_iov, 1);
+	} else {
+		spdk_iovcpy(&disk_iov, 1, iov, iovcnt);
+	}
+
+	if (bdev->md_len != 0 && !bdev->md_interleave) {
+		SPDK_CU_ASSERT_FATAL(md_buf != NULL);
+		if (write) {
+			memcpy(disk->md_buf + offset_blocks * bdev->md_len, md_buf, num_blocks * bdev->md_len);
+		} else {
+			memcpy(md_buf, disk->md_buf + offset_blocks * bdev->md_len, num_blocks * bdev->md_len);
+		}
+	}
+
+	test_io = calloc(1, sizeof(*test_io));
+	SPDK_CU_ASSERT_FATAL(test_io != NULL);
+	test_io->success = true;
+	test_io->cb = cb;
+	test_io->cb_arg = cb_arg;
+	TAILQ_INSERT_TAIL(&g_bdev_io_queue, test_io, link);
+	g_bdev_io_submitted[idx]++;
+
+	return 0;
+}
+
+int
+spdk_bdev_readv_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			   struct iovec *iov, int iovcnt, uint64_t offset_blocks,
+			   uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg,
+			   struct spdk_bdev_ext_io_opts *opts)
+{
+	CU_ASSERT(ch != NULL);
+
+	return submit_io(desc, iov, iovcnt, opts->metadata, offset_blocks, num_blocks, cb, cb_arg,
+			 false);
+}
+
+int
+spdk_bdev_writev_blocks_ext(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			    struct iovec *iov, int iovcnt, uint64_t offset_blocks,
+			    uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg,
+			    struct spdk_bdev_ext_io_opts *opts)
+{
+	CU_ASSERT(ch != NULL);
+
+	return submit_io(desc, iov, iovcnt, opts->metadata, offset_blocks, num_blocks, cb, cb_arg,
+			 true);
+}
+
+static void
+process_io_completions(void)
+{
+	struct test_bdev_io *test_io;
+
+	while ((test_io = TAILQ_FIRST(&g_bdev_io_queue))) {
+		TAILQ_REMOVE(&g_bdev_io_queue, test_io, link);
+		test_io->cb(&test_io->bdev_io, test_io->success, test_io->cb_arg);
+	}
+}
+
+static int
+test_suite_init(void)
+{
+	uint8_t num_base_bdevs_values[] = { 4, 5, 6 };
+	uint32_t base_bdev_blocklen_values[] = { 512, 4096 };
+	uint32_t strip_size_kb_values[] = { 4, 64 };
+	enum raid_params_md_type md_type_values[] = { RAID_PARAMS_MD_NONE, RAID_PARAMS_MD_SEPARATE, RAID_PARAMS_MD_INTERLEAVED };
+	uint8_t *num_base_bdevs;
+	uint32_t *base_bdev_blocklen;
+	uint32_t *strip_size_kb;
+	enum raid_params_md_type *md_type;
+	uint64_t params_count;
+	int rc;
+
+	params_count = SPDK_COUNTOF(num_base_bdevs_values) *
+		       SPDK_COUNTOF(base_bdev_blocklen_values) *
+		       SPDK_COUNTOF(strip_size_kb_values) *
+		       SPDK_COUNTOF(md_type_values);
+	rc = raid_test_params_alloc(params_count);
+	if (rc) {
+		return rc;
+	}
+
+	ARRAY_FOR_EACH(num_base_bdevs_values, num_base_bdevs) {
+		ARRAY_FOR_EACH(base_bdev_blocklen_values, base_bdev_blocklen) {
+			ARRAY_FOR_EACH(strip_size_kb_values, strip_size_kb) {
+				ARRAY_FOR_EACH(md_type_values, md_type) {
+					struct raid_params params = {
+						.num_base_bdevs = *num_base_bdevs,
+						.base_bdev_blockcnt = 512,
+						.base_bdev_blocklen = *base_bdev_blocklen,
+						.strip_size = *strip_size_kb * 1024 / *base_bdev_blocklen,
+						.md_type = *md_type,
+					};
+					raid_test_params_add(&params);
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
+static int
+test_suite_cleanup(void)
+{
+	raid_test_params_free();
+	return 0;
+}
+
+static int
+test_raid_ch_create(void *io_device, void *ctx_buf)
+{
+	struct raid_bdev_io_channel *raid_ch = raid_test_create_io_channel(io_device);
+
+	memcpy(ctx_buf, raid_ch, sizeof(*raid_ch));
+	free(raid_ch);
+
+	return 0;
+}
+
+static void
+test_raid_ch_destroy(void *io_device, void *ctx_buf)
+{
+	struct raid_bdev_io_channel *raid_ch = ctx_buf;
+
+	free(raid_ch->_base_channels);
+	spdk_put_io_channel(raid_ch->_module_channel);
+}
+
+struct test_raid6 {
+	struct raid_bdev *raid_bdev;
+	struct raid6_info *r6_info;
+	struct spdk_io_channel *ch;
+	struct raid_bdev_io_channel *raid_ch;
+	uint32_t blocklen;
+	uint32_t md_len;
+	uint64_t num_stripes;
+	/* Data written to the raid bdev */
+	void *data;
+	void *md;
+};
+
+static void
+create_raid6(struct test_raid6 *t, struct raid_params *params)
+{
+	struct raid_bdev *raid_bdev = raid_test_create_raid_bdev(params, &g_raid6_module);
+	uint8_t i;
+
+	SPDK_CU_ASSERT_FATAL(raid6_start(raid_bdev) == 0);
+
+	memset(t, 0, sizeof(*t));
+	t->raid_bdev = raid_bdev;
+	t->r6_info = raid_bdev->module_private;
+	t->blocklen = raid_bdev->bdev.blocklen;
+	t->md_len = raid_bdev->bdev.md_interleave ? 0 : raid_bdev->bdev.md_len;
+
+	spdk_io_device_register(raid_bdev, test_raid_ch_create, test_raid_ch_destroy,
+				sizeof(struct raid_bdev_io_channel), NULL);
+	t->ch = spdk_get_io_channel(raid_bdev);
+	SPDK_CU_ASSERT_FATAL(t->ch != NULL);
+	t->raid_ch = spdk_io_channel_get_ctx(t->ch);
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		g_disks[i].buf = calloc(params->base_bdev_blockcnt, t->blocklen);
+		SPDK_CU_ASSERT_FATAL(g_disks[i].buf != NULL);
+		if (t->md_len != 0) {
+			g_disks[i].md_buf = calloc(params->base_bdev_blockcnt, t->md_len);
+			SPDK_CU_ASSERT_FATAL(g_disks[i].md_buf != NULL);
+		}
+	}
+
+	/* Use at least as many stripes as needed to place the parity on each base bdev */
+	t->num_stripes = spdk_min(t->r6_info->total_stripes, raid_bdev->num_base_bdevs + 1U);
+
+	t->data = malloc(t->num_stripes * t->r6_info->stripe_blocks * t->blocklen);
+	SPDK_CU_ASSERT_FATAL(t->data != NULL);
+	if (t->md_len != 0) {
+		t->md = malloc(t->num_stripes * t->r6_info->stripe_blocks * t->md_len);
+		SPDK_CU_ASSERT_FATAL(t->md != NULL);
+	}
+}
+
+static void
+delete_raid6(struct test_raid6 *t)
+{
+	struct raid_bdev *raid_bdev = t->raid_bdev;
+	uint8_t i;
+
+	spdk_put_io_channel(t->ch);
+	poll_threads();
+
+	raid6_stop(raid_bdev);
+	spdk_io_device_unregister(raid_bdev, NULL);
+	poll_threads();
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		free(g_disks[i].buf);
+		free(g_disks[i].md_buf);
+		g_disks[i].buf = NULL;
+		g_disks[i].md_buf = NULL;
+	}
+
+	free(t->data);
+	free(t->md);
+
+	raid_test_delete_raid_bdev(raid_bdev);
+}
+
+static void
+set_base_channel(struct test_raid6 *t, uint8_t idx, bool present)
+{
+	t->raid_ch->_base_channels[idx] = present ? (void *)1 : NULL;
+}
+
+static enum spdk_bdev_io_status
+submit_rw(struct test_raid6 *t, enum spdk_bdev_io_type type, uint64_t offset_blocks,
+	  uint64_t num_blocks, void *buf, void *md_buf)
+{
+	struct test_raid_bdev_io test_io = {};
+	struct iovec iovs[3];
+	size_t len = num_blocks * t->blocklen;
+	size_t iov_len = len / SPDK_COUNTOF(iovs);
+	int i;
+
+	/* Split the buffer into a few iovecs to exercise the iovec mapping */
+	for (i = 0; i < (int)SPDK_COUNTOF(iovs); i++) {
+		iovs[i].iov_base = buf + i * iov_len;
+		iovs[i].iov_len = iov_len;
+	}
+	iovs[SPDK_COUNTOF(iovs) - 1].iov_len += len % SPDK_COUNTOF(iovs);
+
+	raid_test_bdev_io_init(&test_io.raid_io, t->raid_bdev, t->raid_ch, type, offset_blocks,
+			       num_blocks, iovs, SPDK_COUNTOF(iovs), md_buf);
+
+	raid6_submit_rw_request(&test_io.raid_io);
+	process_io_completions();
+
+	CU_ASSERT(test_io.completed);
+
+	return test_io.status;
+}
+
+static void
+write_stripes(struct test_raid6 *t)
+{
+	uint64_t stripe_blocks = t->r6_info->stripe_blocks;
+	uint64_t stripe, i;
+
+	for (i = 0; i < t->num_stripes * stripe_blocks * t->blocklen; i++) {
+		((uint8_t *)t->data)[i] = rand();
+	}
+	for (i = 0; t->md != NULL && i < t->num_stripes * stripe_blocks * t->md_len; i++) {
+		((uint8_t *)t->md)[i] = rand();
+	}
+
+	for (stripe = 0; stripe < t->num_stripes; stripe++) {
+		CU_ASSERT(submit_rw(t, SPDK_BDEV_IO_TYPE_WRITE, stripe * stripe_blocks, stripe_blocks,
+				    t->data + stripe * stripe_blocks * t->blocklen,
+				    t->md ? t->md + stripe * stripe_blocks * t->md_len : NULL) ==
+			  SPDK_BDEV_IO_STATUS_SUCCESS);
+	}
+}
+
+/* Read each strip of the written stripes and compare with the written data */
+static void
+verify_strips(struct test_raid6 *t, uint64_t num_blocks, uint64_t strip_offset)
+{
+	struct raid_bdev *raid_bdev = t->raid_bdev;
+	uint64_t strip_size = raid_bdev->strip_size;
+	uint64_t num_strips = t->num_stripes * raid6_stripe_data_chunks_num(raid_bdev);
+	void *buf, *md_buf = NULL;
+	uint64_t strip, offset;
+
+	buf = malloc(num_blocks * t->blocklen);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+	if (t->md_len != 0) {
+		md_buf = malloc(num_blocks * t->md_len);
+		SPDK_CU_ASSERT_FATAL(md_buf != NULL);
+	}
+
+	for (strip = 0; strip < num_strips; strip++) {
+		offset = strip * strip_size + strip_offset;
+
+		memset(buf, 0xee, num_blocks * t->blocklen);
+		CU_ASSERT(submit_rw(t, SPDK_BDEV_IO_TYPE_READ, offset, num_blocks, buf, md_buf) ==
+			  SPDK_BDEV_IO_STATUS_SUCCESS);
+		CU_ASSERT(memcmp(buf, t->data + offset * t->blocklen, num_blocks * t->blocklen) == 0);
+		if (md_buf != NULL) {
+			CU_ASSERT(memcmp(md_buf, t->md + offset * t->md_len, num_blocks * t->md_len) == 0);
+		}
+	}
+
+	free(buf);
+	free(md_buf);
+}
+
+static void
+verify_parity(struct test_raid6 *t)
+{
+	struct raid_bdev *raid_bdev = t->raid_bdev;
+	uint8_t n = raid6_stripe_data_chunks_num(raid_bdev);
+	size_t strip_len = raid_bdev->strip_size * t->blocklen;
+	size_t strip_md_len = raid_bdev->strip_size * t->md_len;
+	void *sources[MAX_BASE_BDEVS];
+	void *p, *q;
+	uint64_t stripe;
+	uint8_t i, idx;
+
+	p = malloc(strip_len);
+	q = malloc(strip_len);
+	SPDK_CU_ASSERT_FATAL(p != NULL && q != NULL);
+
+	for (stripe = 0; stripe < t->num_stripes; stripe++) {
+		uint64_t disk_offset = stripe * raid_bdev->strip_size;
+		uint8_t p_idx = raid6_stripe_p_chunk_index(raid_bdev, stripe);
+		uint8_t q_idx = raid6_stripe_q_chunk_index(raid_bdev, stripe);
+
+		CU_ASSERT(p_idx != q_idx);
+
+		for (i = 0; i < n; i++) {
+			idx = raid6_stripe_data_chunk_index(raid_bdev, stripe, i);
+			CU_ASSERT(idx != p_idx && idx != q_idx);
+			sources[i] = g_disks[idx].buf + disk_offset * t->blocklen;
+			CU_ASSERT(memcmp(sources[i], t->data + (stripe * n + i) * strip_len, strip_len) == 0);
+		}
+
+		SPDK_CU_ASSERT_FATAL(spdk_xor_gen_pq(p, q, sources, n, strip_len) == 0);
+		CU_ASSERT(memcmp(p, g_disks[p_idx].buf + disk_offset * t->blocklen, strip_len) == 0);
+		CU_ASSERT(memcmp(q, g_disks[q_idx].buf + disk_offset * t->blocklen, strip_len) == 0);
+
+		if (strip_md_len != 0) {
+			for (i = 0; i < n; i++) {
+				idx = raid6_stripe_data_chunk_index(raid_bdev, stripe, i);
+				sources[i] = g_disks[idx].md_buf + disk_offset * t->md_len;
+			}
+
+			SPDK_CU_ASSERT_FATAL(spdk_xor_gen_pq(p, q, sources, n, strip_md_len) == 0);
+			CU_ASSERT(memcmp(p, g_disks[p_idx].md_buf + disk_offset * t->md_len, strip_md_len) == 0);
+			CU_ASSERT(memcmp(q, g_disks[q_idx].md_buf + disk_offset * t->md_len, strip_md_len) == 0);
+		}
+	}
+
+	free(p);
+	free(q);
+}
+
+static void
+test_raid6_start(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct raid_bdev *raid_bdev = raid_test_create_raid_bdev(params, &g_raid6_module);
+		struct raid6_info *r6_info;
+
+		SPDK_CU_ASSERT_FATAL(raid6_start(raid_bdev) == 0);
+		r6_info = raid_bdev->module_private;
+
+		CU_ASSERT_EQUAL(r6_info->stripe_blocks, params->strip_size * (params->num_base_bdevs - 2));
+		CU_ASSERT_EQUAL(r6_info->total_stripes, params->base_bdev_blockcnt / params->strip_size);
+		CU_ASSERT_EQUAL(raid_bdev->bdev.blockcnt,
+				(params->base_bdev_blockcnt - params->base_bdev_blockcnt % params->strip_size) *
+				(params->num_base_bdevs - 2));
+		CU_ASSERT_EQUAL(raid_bdev->bdev.optimal_io_boundary, params->strip_size);
+		CU_ASSERT_TRUE(raid_bdev->bdev.split_on_optimal_io_boundary);
+		CU_ASSERT_EQUAL(raid_bdev->bdev.write_unit_size, r6_info->stripe_blocks);
+		CU_ASSERT_TRUE(raid_bdev->bdev.split_on_write_unit);
+
+		raid6_stop(raid_bdev);
+		raid_test_delete_raid_bdev(raid_bdev);
+	}
+}
+
+static void
+test_raid6_write_read(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct test_raid6 t;
+
+		create_raid6(&t, params);
+
+		write_stripes(&t);
+		verify_parity(&t);
+
+		memset(g_bdev_io_submitted, 0, sizeof(g_bdev_io_submitted));
+		verify_strips(&t, params->strip_size, 0);
+		/* every strip read is served by a single base bdev I/O */
+		CU_ASSERT(g_bdev_io_submitted[0] + g_bdev_io_submitted[1] + g_bdev_io_submitted[2] +
+			  g_bdev_io_submitted[3] + g_bdev_io_submitted[4] + g_bdev_io_submitted[5] ==
+			  t.num_stripes * raid6_stripe_data_chunks_num(t.raid_bdev));
+
+		if (params->strip_size > 1) {
+			verify_strips(&t, 1, params->strip_size - 1);
+		}
+
+		delete_raid6(&t);
+	}
+}
+
+static void
+test_raid6_degraded(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct test_raid6 t;
+		uint8_t a, b;
+
+		create_raid6(&t, params);
+
+		write_stripes(&t);
+
+		/* Read with every combination of one or two missing base bdevs */
+		for (a = 0; a < params->num_base_bdevs; a++) {
+			for (b = a; b < params->num_base_bdevs; b++) {
+				set_base_channel(&t, a, false);
+				set_base_channel(&t, b, false);
+
+				verify_strips(&t, params->strip_size, 0);
+				if (params->strip_size > 1) {
+					verify_strips(&t, 1, params->strip_size - 1);
+				}
+
+				set_base_channel(&t, a, true);
+				set_base_channel(&t, b, true);
+			}
+		}
+
+		/* Write with two missing base bdevs and read the data back */
+		set_base_channel(&t, 0, false);
+		set_base_channel(&t, params->num_base_bdevs - 1, false);
+		write_stripes(&t);
+		verify_strips(&t, params->strip_size, 0);
+
+		delete_raid6(&t);
+	}
+}
+
+static void
+test_raid6_rebuild(void)
+{
+	struct raid_params *params;
+
+	RAID_PARAMS_FOR_EACH(params) {
+		struct raid_bdev_process_request process_req = {};
+		struct test_raid6 t;
+		uint64_t stripe_blocks;
+		size_t disk_len;
+		void *expected;
+		uint8_t target, missing;
+		uint64_t stripe;
+		int ret;
+
+		create_raid6(&t, params);
+		stripe_blocks = t.r6_info->stripe_blocks;
+
+		write_stripes(&t);
+
+		process_req.iov.iov_base = malloc(params->strip_size * t.blocklen);
+		SPDK_CU_ASSERT_FATAL(process_req.iov.iov_base != NULL);
+		if (t.md_len != 0) {
+			process_req.md_buf = malloc(params->strip_size * t.md_len);
+			SPDK_CU_ASSERT_FATAL(process_req.md_buf != NULL);
+		}
+
+		disk_len = t.num_stripes * params->strip_size * t.blocklen;
+		expected = malloc(disk_len);
+		SPDK_CU_ASSERT_FATAL(expected != NULL);
+
+		/* Rebuild each base bdev while another one is missing */
+		for (target = 0; target < params->num_base_bdevs; target++) {
+			missing = (target + 1) % params->num_base_bdevs;
+
+			memcpy(expected, g_disks[target].buf, disk_len);
+			memset(g_disks[target].buf, 0, disk_len);
+			set_base_channel(&t, missing, false);
+
+			process_req.target = &t.raid_bdev->base_bdev_info[target];
+			process_req.target_ch = (void *)1;
+
+			for (stripe = 0; stripe < t.num_stripes; stripe++) {
+				process_req.offset_blocks = stripe * stripe_blocks;
+				process_req.num_blocks = stripe_blocks;
+				g_process_completed = false;
+				g_process_status = -1;
+
+				ret = raid6_submit_process_request(&process_req, t.raid_ch);
+				CU_ASSERT(ret == (int)stripe_blocks);
+				process_io_completions();
+
+				CU_ASSERT(g_process_completed);
+				CU_ASSERT(g_process_status == 0);
+			}
+
+			CU_ASSERT(memcmp(expected, g_disks[target].buf, disk_len) == 0);
+
+			set_base_channel(&t, missing, true);
+		}
+
+		free(expected);
+		free(process_req.iov.iov_base);
+		free(process_req.md_buf);
+
+		delete_raid6(&t);
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("raid6", test_suite_init, test_suite_cleanup);
+	CU_ADD_TEST(suite, test_raid6_start);
+	CU_ADD_TEST(suite, test_raid6_write_read);
+	CU_ADD_TEST(suite, test_raid6_degraded);
+	CU_ADD_TEST(suite, test_raid6_rebuild);
+
+	allocate_threads(1);
+	set_thread(0);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	free_threads();
+
+	return num_failures;
+}
@@ -4601,6 +4601,438 @@ blob_thin_prov_rw(void)
 	g_blobid = 0;
 }
 
+static void
+ut_blob_write_cluster(struct spdk_blob *blob, struct spdk_io_channel *ch, uint64_t cluster)
+{
+	uint8_t payload_write[BLOCKLEN];
+	uint64_t io_units_per_cluster;
+
+	io_units_per_cluster = spdk_bs_get_cluster_size(blob->bs) / spdk_bs_get_io_unit_size(blob->bs);
+	memset(payload_write, 0xE5, sizeof(payload_write));
+
+	/* The channel is used from thread 1, so that it isn't shared with the metadata channel */
+	g_bserrno = -1;
+	set_thread(1);
+	spdk_blob_io_write(blob, ch, payload_write, cluster * io_units_per_cluster, 1,
+			   blob_op_complete, NULL);
+	set_thread(0);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+}
+
+static struct spdk_io_channel *
+ut_bs_alloc_io_channel_thread1(struct spdk_blob_store *bs)
+{
+	struct spdk_io_channel *ch;
+
+	set_thread(1);
+	ch = spdk_bs_alloc_io_channel(bs);
+	set_thread(0);
+
+	return ch;
+}
+
+static void
+ut_bs_free_io_channel_thread1(struct spdk_io_channel *ch)
+{
+	set_thread(1);
+	spdk_bs_free_io_channel(ch);
+	set_thread(0);
+	poll_threads();
+}
+
+static void
+blob_thin_prov_reserve_clusters(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *ch;
+	struct spdk_bs_channel *bs_ch;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts bs_opts;
+	struct spdk_blob_opts opts;
+	spdk_blob_id blobid;
+	uint64_t free_clusters;
+	const uint32_t CLUSTER_SZ = g_phys_blocklen * 4;
+	uint32_t i;
+
+	/* Use small clusters, so that there are enough free clusters to reserve from */
+	dev = init_dev();
+	spdk_bs_opts_init(&bs_opts, sizeof(bs_opts));
+	CU_ASSERT(bs_opts.cluster_reserve_batch == SPDK_BLOB_OPTS_CLUSTER_RESERVE_BATCH);
+	bs_opts.cluster_sz = CLUSTER_SZ;
+	bs_opts.cluster_reserve_batch = 8;
+
+	spdk_bs_init(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	SPDK_CU_ASSERT_FATAL(free_clusters >= 8 * SPDK_BS_CLUSTER_RESERVE_MIN_FREE_RATIO);
+
+	ch = ut_bs_alloc_io_channel_thread1(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	bs_ch = spdk_io_channel_get_ctx(ch);
+	CU_ASSERT(bs_channel_num_reserved_clusters(bs_ch) == 0);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = 32;
+
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+
+	/* Each first write takes a single cluster, the reserved ones are still reported as free */
+	for (i = 0; i < 16; i++) {
+		ut_blob_write_cluster(blob, ch, i);
+		CU_ASSERT(free_clusters - (i + 1) == spdk_bs_free_cluster_count(bs));
+		CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == i + 1);
+
+		/* The pool is refilled in the background once it drops below half */
+		CU_ASSERT(bs_channel_num_reserved_clusters(bs_ch) >= 8 / 2);
+		CU_ASSERT(bs_channel_num_reserved_clusters(bs_ch) <= 8);
+		CU_ASSERT(bs->num_reserved_clusters == bs_channel_num_reserved_clusters(bs_ch));
+		CU_ASSERT(bs->num_free_clusters + bs->num_reserved_clusters ==
+			  free_clusters - (i + 1));
+	}
+
+	/* Freeing the channel returns the reserved clusters */
+	ut_bs_free_io_channel_thread1(ch);
+	CU_ASSERT(bs->num_reserved_clusters == 0);
+	CU_ASSERT(bs->num_free_clusters == free_clusters - 16);
+
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	/* Only clusters allocated to the blob are persisted as used */
+	ut_bs_reload(&bs, &bs_opts);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 16);
+
+	ch = ut_bs_alloc_io_channel_thread1(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+
+	ut_blob_write_cluster(blob, ch, 16);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 17);
+	CU_ASSERT(bs->num_reserved_clusters != 0);
+
+	/* Reserved clusters were never recorded in the metadata, so recovery frees them */
+	ut_bs_free_io_channel_thread1(ch);
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	ut_bs_dirty_load(&bs, &bs_opts);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 17);
+
+	/* With reservation disabled clusters are allocated directly from the blobstore */
+	bs_opts.cluster_reserve_batch = 0;
+	ut_bs_reload(&bs, &bs_opts);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 17);
+
+	ch = ut_bs_alloc_io_channel_thread1(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	bs_ch = spdk_io_channel_get_ctx(ch);
+	CU_ASSERT(bs_ch->reserved_clusters == NULL);
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+
+	ut_blob_write_cluster(blob, ch, 17);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 18);
+	CU_ASSERT(bs->num_reserved_clusters == 0);
+
+	ut_bs_free_io_channel_thread1(ch);
+	ut_blob_close_and_delete(bs, blob);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters);
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+	g_blob = NULL;
+	g_blobid = 0;
+}
+
+static void
+blob_thin_prov_reserve_clusters_reclaim(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_blob *thin_blob, *thick_blob;
+	struct spdk_io_channel *ch, *md_ch;
+	struct spdk_bs_channel *bs_ch;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts bs_opts;
+	struct spdk_blob_opts opts;
+	uint64_t free_clusters;
+
+	dev = init_dev();
+	spdk_bs_opts_init(&bs_opts, sizeof(bs_opts));
+	bs_opts.cluster_sz = g_phys_blocklen * 4;
+	bs_opts.cluster_reserve_batch = 8;
+
+	spdk_bs_init(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+	free_clusters = spdk_bs_free_cluster_count(bs);
+
+	ch = ut_bs_alloc_io_channel_thread1(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	bs_ch = spdk_io_channel_get_ctx(ch);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = 4;
+	thin_blob = ut_blob_create_and_open(bs, &opts);
+
+	ut_blob_write_cluster(thin_blob, ch, 0);
+	CU_ASSERT(bs_channel_num_reserved_clusters(bs_ch) != 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 1);
+
+	/* Space held by the channel's reservation is taken back for a thick provisioned blob */
+	ut_spdk_blob_opts_init(&opts);
+	opts.num_clusters = free_clusters - 1;
+	thick_blob = ut_blob_create_and_open(bs, &opts);
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(thick_blob) == free_clusters - 1);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == 0);
+	CU_ASSERT(bs_channel_num_reserved_clusters(bs_ch) == 0);
+	CU_ASSERT(bs->num_reserved_clusters == 0);
+
+	/* Deleting it makes enough room for the channel to reserve again */
+	ut_blob_close_and_delete(bs, thick_blob);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 1);
+
+	ut_blob_write_cluster(thin_blob, ch, 1);
+	CU_ASSERT(bs_channel_num_reserved_clusters(bs_ch) != 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 2);
+
+	/* Resizing the thin blob to thick provisioned takes the reservation back too */
+	ut_blob_close_and_delete(bs, thin_blob);
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = free_clusters;
+	thin_blob = ut_blob_create_and_open(bs, &opts);
+	ut_blob_write_cluster(thin_blob, ch, 0);
+	CU_ASSERT(bs_channel_num_reserved_clusters(bs_ch) != 0);
+
+	md_ch = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(md_ch != NULL);
+	spdk_bs_inflate_blob(bs, md_ch, spdk_blob_get_id(thin_blob), blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(thin_blob) == free_clusters);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == 0);
+	CU_ASSERT(bs->num_reserved_clusters == 0);
+	spdk_bs_free_io_channel(md_ch);
+	poll_threads();
+
+	ut_blob_close_and_delete(bs, thin_blob);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters);
+
+	/* Unload returns the reservations of all the channels, not only the metadata one */
+	thin_blob = ut_blob_create_and_open(bs, &opts);
+	ut_blob_write_cluster(thin_blob, ch, 0);
+	CU_ASSERT(bs_channel_num_reserved_clusters(bs_ch) != 0);
+	spdk_blob_close(thin_blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	/* An unload that fails to start leaves the reservations alone */
+	MOCK_SET(spdk_zmalloc, NULL);
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	MOCK_CLEAR(spdk_zmalloc);
+	CU_ASSERT(g_bserrno == -ENOMEM);
+	CU_ASSERT(bs->cluster_reserve_batch == 8);
+	CU_ASSERT(bs_channel_num_reserved_clusters(bs_ch) != 0);
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(bs->num_reserved_clusters == 0);
+	ut_bs_free_io_channel_thread1(ch);
+	CU_ASSERT(g_bserrno == 0);
+
+	dev = init_dev();
+	spdk_bs_load(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 1);
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+	g_blob = NULL;
+	g_blobid = 0;
+}
+
+static uint64_t
+ut_blob_num_cluster_chunks(struct spdk_blob *blob)
+{
+	uint64_t i, count = 0;
+
+	SPDK_CU_ASSERT_FATAL(blob->active.cluster_chunks != NULL);
+	for (i = 0; i < spdk_divide_round_up(blob->active.cluster_array_size,
+					     SPDK_BLOB_CLUSTER_CHUNK_SIZE); i++) {
+		if (blob->active.cluster_chunks[i] != NULL) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static void
+blob_thin_prov_sparse_clusters(void)
+{
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_blob *blob, *snapshot;
+	struct spdk_io_channel *ch;
+	struct spdk_blob_opts opts;
+	spdk_blob_id blobid, snapshotid;
+	uint64_t free_clusters, io_units_per_cluster;
+	const uint64_t num_clusters = SPDK_BLOB_SPARSE_MIN_CLUSTERS * 2;
+	const uint64_t last_cluster = num_clusters - 1;
+	uint8_t payload_write[BLOCKLEN], payload_read[BLOCKLEN];
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	io_units_per_cluster = spdk_bs_get_cluster_size(bs) / spdk_bs_get_io_unit_size(bs);
+
+	ch = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+
+	/* Thin provisioned blob larger than the blobstore, so that it uses a sparse cluster map */
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = num_clusters;
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+	CU_ASSERT(blob->active.clusters == NULL);
+	CU_ASSERT(ut_blob_num_cluster_chunks(blob) == 0);
+	CU_ASSERT(blob->clean.clusters == NULL);
+	CU_ASSERT(blob->clean.cluster_chunks != NULL);
+
+	/* Only the chunks with allocated clusters take memory */
+	memset(payload_write, 0xE5, sizeof(payload_write));
+	spdk_blob_io_write(blob, ch, payload_write, 0, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	spdk_blob_io_write(blob, ch, payload_write, last_cluster * io_units_per_cluster, 1,
+			   blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 2);
+	CU_ASSERT(free_clusters - 2 == spdk_bs_free_cluster_count(bs));
+	CU_ASSERT(ut_blob_num_cluster_chunks(blob) == 2);
+	CU_ASSERT(bs_blob_cluster_lba(&blob->active, 0) != 0);
+	CU_ASSERT(bs_blob_cluster_lba(&blob->active, 1) == 0);
+	CU_ASSERT(bs_blob_cluster_lba(&blob->active, last_cluster) != 0);
+
+	/* The map stays sparse when the blob is loaded again */
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	spdk_bs_free_io_channel(ch);
+	poll_threads();
+
+	ut_bs_reload(&bs, NULL);
+	CU_ASSERT(free_clusters - 2 == spdk_bs_free_cluster_count(bs));
+
+	ch = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+	CU_ASSERT(spdk_blob_get_num_clusters(blob) == num_clusters);
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 2);
+	CU_ASSERT(ut_blob_num_cluster_chunks(blob) == 2);
+	CU_ASSERT(blob->active.clusters == NULL);
+	CU_ASSERT(blob->clean.clusters == NULL);
+	CU_ASSERT(blob->clean.cluster_chunks != NULL);
+
+	memset(payload_read, 0, sizeof(payload_read));
+	spdk_blob_io_read(blob, ch, payload_read, last_cluster * io_units_per_cluster, 1,
+			  blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload_write, payload_read, sizeof(payload_read)) == 0);
+
+	/* Deleting the snapshot moves its clusters back to the clone's sparse map */
+	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	snapshotid = g_blobid;
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 0);
+
+	spdk_bs_open_blob(bs, snapshotid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	snapshot = g_blob;
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(snapshot) == 2);
+	CU_ASSERT(ut_blob_num_cluster_chunks(snapshot) == 2);
+	spdk_blob_close(snapshot, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	spdk_bs_delete_blob(bs, snapshotid, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 2);
+	CU_ASSERT(bs_blob_cluster_lba(&blob->active, last_cluster) != 0);
+	CU_ASSERT(free_clusters - 2 == spdk_bs_free_cluster_count(bs));
+
+	/* Shrinking releases the truncated clusters and small maps become flat again */
+	spdk_blob_resize(blob, 10, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	spdk_blob_sync_md(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(blob->active.cluster_chunks == NULL);
+	CU_ASSERT(blob->active.cluster_array_size == 10);
+	CU_ASSERT(blob->clean.cluster_chunks == NULL);
+	CU_ASSERT(blob->clean.cluster_array_size == 10);
+	CU_ASSERT(spdk_blob_get_num_allocated_clusters(blob) == 1);
+	CU_ASSERT(free_clusters - 1 == spdk_bs_free_cluster_count(bs));
+
+	/* Growing a thin provisioned blob makes the map sparse without allocating the clusters */
+	spdk_blob_resize(blob, num_clusters, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(blob->active.clusters == NULL);
+	CU_ASSERT(ut_blob_num_cluster_chunks(blob) == 1);
+	CU_ASSERT(bs_blob_cluster_lba(&blob->active, 0) != 0);
+	CU_ASSERT(bs_blob_cluster_lba(&blob->active, last_cluster) == 0);
+	spdk_blob_sync_md(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(blob->clean.clusters == NULL);
+	CU_ASSERT(blob->clean.cluster_chunks != NULL);
+	CU_ASSERT(bs_blob_cluster_lba(&blob->clean, 0) != 0);
+
+	spdk_bs_free_io_channel(ch);
+	poll_threads();
+	ut_blob_close_and_delete(bs, blob);
+	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+}
+
 static void
 blob_thin_prov_write_count_io(void)
 {
@@ -10310,6 +10742,9 @@ main(int argc, char **argv)
 		CU_ADD_TEST(suite_bs, blob_insert_cluster_msg_test);
 		CU_ADD_TEST(suite_bs, blob_thin_prov_rw);
 		CU_ADD_TEST(suite, blob_thin_prov_write_count_io);
+		CU_ADD_TEST(suite, blob_thin_prov_reserve_clusters);
+		CU_ADD_TEST(suite, blob_thin_prov_reserve_clusters_reclaim);
+		CU_ADD_TEST(suite_bs, blob_thin_prov_sparse_clusters);
 		CU_ADD_TEST(suite, blob_thin_prov_unmap_cluster);
 		CU_ADD_TEST(suite_bs, blob_thin_prov_rle);
 		CU_ADD_TEST(suite_bs, blob_thin_prov_rw_iov);
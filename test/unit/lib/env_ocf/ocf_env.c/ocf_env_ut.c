@@ -0,0 +1,263 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk_internal/mock.h"
+
+#include "common/lib/test_env.c"
+#include "env_ocf/ocf_env.c"
+
+DEFINE_STUB_V(spdk_pause, (void));
+
+#define UT_STRESS_THREADS	4
+#define UT_STRESS_ITERATIONS	100000
+
+static void *
+ut_rwlock_writer(void *arg)
+{
+	env_rwlock *rwlock = arg;
+
+	env_rwlock_write_lock(rwlock);
+	env_rwlock_write_unlock(rwlock);
+
+	return NULL;
+}
+
+static void
+ut_wait_for_state(struct env_lock *l, uint32_t flag)
+{
+	while (!(__atomic_load_n(&l->state, __ATOMIC_RELAXED) & flag)) {
+		spdk_pause();
+	}
+}
+
+static void
+test_rwlock_writer_pending(void)
+{
+	env_rwlock rwlock;
+	env_rwsem rwsem;
+	pthread_t thread;
+
+	env_rwlock_init(&rwlock);
+
+	/* A waiting writer keeps new readers of a rwlock out */
+	env_rwlock_read_lock(&rwlock);
+	SPDK_CU_ASSERT_FATAL(pthread_create(&thread, NULL, ut_rwlock_writer, &rwlock) == 0);
+	ut_wait_for_state(&rwlock.lock, ENV_LOCK_WRITER_PENDING);
+	CU_ASSERT(env_lock_read_trylock(&rwlock.lock, ENV_LOCK_RWLOCK) == -OCF_ERR_NO_LOCK);
+	CU_ASSERT(env_lock_write_trylock(&rwlock.lock, ENV_LOCK_RWLOCK) == -OCF_ERR_NO_LOCK);
+	env_rwlock_read_unlock(&rwlock);
+
+	/* The writer clears the flag once it gets the lock */
+	pthread_join(thread, NULL);
+	CU_ASSERT(rwlock.lock.state == 0);
+	CU_ASSERT(!env_lock_is_locked(&rwlock.lock));
+
+	/* A pending writer alone doesn't make the lock held, and is preserved on unlock */
+	rwlock.lock.state = ENV_LOCK_WRITER_PENDING;
+	CU_ASSERT(!env_lock_is_locked(&rwlock.lock));
+	env_rwlock_write_lock(&rwlock);
+	CU_ASSERT(rwlock.lock.state == ENV_LOCK_WRITER);
+	__atomic_fetch_or(&rwlock.lock.state, ENV_LOCK_WRITER_PENDING, __ATOMIC_RELAXED);
+	env_rwlock_write_unlock(&rwlock);
+	CU_ASSERT(rwlock.lock.state == ENV_LOCK_WRITER_PENDING);
+	rwlock.lock.state = 0;
+	env_rwlock_destroy(&rwlock);
+
+	/* Readers of rw semaphores are still preferred, OCF takes them recursively */
+	env_rwsem_init(&rwsem);
+	env_rwsem_down_read(&rwsem);
+	CU_ASSERT(env_rwsem_down_write_trylock(&rwsem) == -OCF_ERR_NO_LOCK);
+	CU_ASSERT(env_rwsem_down_read_trylock(&rwsem) == 0);
+	env_rwsem_up_read(&rwsem);
+	env_rwsem_up_read(&rwsem);
+	CU_ASSERT(env_rwsem_down_write_trylock(&rwsem) == 0);
+	CU_ASSERT(env_rwsem_down_read_trylock(&rwsem) == -OCF_ERR_NO_LOCK);
+	env_rwsem_up_write(&rwsem);
+	CU_ASSERT(env_rwsem_destroy(&rwsem) == 0);
+}
+
+static void *
+ut_rmutex_trylock(void *arg)
+{
+	env_rmutex *rmutex = arg;
+
+	if (env_rmutex_is_owner(rmutex)) {
+		return (void *)(intptr_t)-EINVAL;
+	}
+
+	if (env_rmutex_trylock(rmutex) != 0) {
+		return (void *)(intptr_t)-EBUSY;
+	}
+
+	env_rmutex_unlock(rmutex);
+	return NULL;
+}
+
+static void
+test_rmutex(void)
+{
+	env_rmutex rmutex;
+	pthread_t thread;
+	void *rc;
+
+	env_rmutex_init(&rmutex);
+	CU_ASSERT(!env_rmutex_is_owner(&rmutex));
+
+	env_rmutex_lock(&rmutex);
+	CU_ASSERT(env_rmutex_trylock(&rmutex) == 0);
+	env_rmutex_lock(&rmutex);
+	CU_ASSERT(env_rmutex_is_owner(&rmutex));
+	CU_ASSERT(rmutex.depth == 3);
+
+	/* Other threads are neither the owner nor able to take the mutex */
+	SPDK_CU_ASSERT_FATAL(pthread_create(&thread, NULL, ut_rmutex_trylock, &rmutex) == 0);
+	pthread_join(thread, &rc);
+	CU_ASSERT(rc == (void *)(intptr_t)-EBUSY);
+
+	env_rmutex_unlock(&rmutex);
+	env_rmutex_unlock(&rmutex);
+	CU_ASSERT(env_rmutex_is_locked(&rmutex));
+	env_rmutex_unlock(&rmutex);
+	CU_ASSERT(!env_rmutex_is_locked(&rmutex));
+	CU_ASSERT(!env_rmutex_is_owner(&rmutex));
+	CU_ASSERT(rmutex.depth == 0);
+	CU_ASSERT(pthread_equal(rmutex.owner, (pthread_t)0));
+
+	SPDK_CU_ASSERT_FATAL(pthread_create(&thread, NULL, ut_rmutex_trylock, &rmutex) == 0);
+	pthread_join(thread, &rc);
+	CU_ASSERT(rc == NULL);
+
+	CU_ASSERT(env_rmutex_destroy(&rmutex) == 0);
+}
+
+struct ut_stress_ctx {
+	env_mutex	mutex;
+	env_rmutex	rmutex;
+	env_rwsem	rwsem;
+	env_rwlock	rwlock;
+	/* Each pair is only updated under the exclusive lock, readers check it is consistent */
+	uint64_t	mutex_count;
+	uint64_t	rmutex_count;
+	uint64_t	rwsem_count[2];
+	uint64_t	rwlock_count[2];
+	uint64_t	inconsistent;
+};
+
+static void *
+ut_stress_thread(void *arg)
+{
+	struct ut_stress_ctx *ctx = arg;
+	int i;
+
+	for (i = 0; i < UT_STRESS_ITERATIONS; i++) {
+		env_mutex_lock(&ctx->mutex);
+		ctx->mutex_count++;
+		env_mutex_unlock(&ctx->mutex);
+
+		env_rmutex_lock(&ctx->rmutex);
+		env_rmutex_lock(&ctx->rmutex);
+		ctx->rmutex_count++;
+		env_rmutex_unlock(&ctx->rmutex);
+		env_rmutex_unlock(&ctx->rmutex);
+
+		if (i % 4 == 0) {
+			env_rwsem_down_write(&ctx->rwsem);
+			ctx->rwsem_count[0]++;
+			ctx->rwsem_count[1]++;
+			env_rwsem_up_write(&ctx->rwsem);
+
+			env_rwlock_write_lock(&ctx->rwlock);
+			ctx->rwlock_count[0]++;
+			ctx->rwlock_count[1]++;
+			env_rwlock_write_unlock(&ctx->rwlock);
+		} else {
+			env_rwsem_down_read(&ctx->rwsem);
+			if (ctx->rwsem_count[0] != ctx->rwsem_count[1]) {
+				__atomic_fetch_add(&ctx->inconsistent, 1, __ATOMIC_RELAXED);
+			}
+			env_rwsem_up_read(&ctx->rwsem);
+
+			env_rwlock_read_lock(&ctx->rwlock);
+			if (ctx->rwlock_count[0] != ctx->rwlock_count[1]) {
+				__atomic_fetch_add(&ctx->inconsistent, 1, __ATOMIC_RELAXED);
+			}
+			env_rwlock_read_unlock(&ctx->rwlock);
+		}
+	}
+
+	return NULL;
+}
+
+static void
+test_lock_stress(void)
+{
+	struct env_lock_stats before[ENV_LOCK_TYPE_MAX], after[ENV_LOCK_TYPE_MAX];
+	struct ut_stress_ctx ctx = {};
+	pthread_t threads[UT_STRESS_THREADS];
+	uint64_t num_writes = UT_STRESS_THREADS * spdk_divide_round_up(UT_STRESS_ITERATIONS, 4);
+	uint64_t total = UT_STRESS_THREADS * UT_STRESS_ITERATIONS;
+	int i, rc;
+
+	env_mutex_init(&ctx.mutex);
+	env_rmutex_init(&ctx.rmutex);
+	env_rwsem_init(&ctx.rwsem);
+	env_rwlock_init(&ctx.rwlock);
+	env_lock_get_stats(before);
+
+	for (i = 0; i < UT_STRESS_THREADS; i++) {
+		rc = pthread_create(&threads[i], NULL, ut_stress_thread, &ctx);
+		SPDK_CU_ASSERT_FATAL(rc == 0);
+	}
+	for (i = 0; i < UT_STRESS_THREADS; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	CU_ASSERT(ctx.mutex_count == total);
+	CU_ASSERT(ctx.rmutex_count == total);
+	CU_ASSERT(ctx.rwsem_count[0] == num_writes);
+	CU_ASSERT(ctx.rwlock_count[0] == num_writes);
+	CU_ASSERT(ctx.inconsistent == 0);
+
+	CU_ASSERT(!env_mutex_is_locked(&ctx.mutex));
+	CU_ASSERT(!env_rmutex_is_locked(&ctx.rmutex));
+	CU_ASSERT(!env_rwsem_is_locked(&ctx.rwsem));
+	CU_ASSERT(!env_lock_is_locked(&ctx.rwlock.lock));
+	CU_ASSERT(ctx.rwlock.lock.state == 0);
+
+	/* The recursive mutex only takes the underlying mutex for the outermost lock */
+	env_lock_get_stats(after);
+	CU_ASSERT(after[ENV_LOCK_MUTEX].exclusive - before[ENV_LOCK_MUTEX].exclusive ==
+		  2 * total);
+	CU_ASSERT(after[ENV_LOCK_RWSEM].exclusive - before[ENV_LOCK_RWSEM].exclusive ==
+		  num_writes);
+	CU_ASSERT(after[ENV_LOCK_RWSEM].shared - before[ENV_LOCK_RWSEM].shared ==
+		  total - num_writes);
+	CU_ASSERT(after[ENV_LOCK_RWLOCK].exclusive - before[ENV_LOCK_RWLOCK].exclusive ==
+		  num_writes);
+	CU_ASSERT(after[ENV_LOCK_RWLOCK].shared - before[ENV_LOCK_RWLOCK].shared ==
+		  total - num_writes);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("ocf_env", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_rwlock_writer_pending);
+	CU_ADD_TEST(suite, test_rmutex);
+	CU_ADD_TEST(suite, test_lock_stress);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+	return num_failures;
+}
@@ -722,6 +722,118 @@ test_scheduler(void)
 	free_cores();
 }
 
+static void
+test_scheduler_numa(void)
+{
+	struct spdk_scheduler_thread_info thread_info = {};
+	struct spdk_cpuset cpuset = {};
+	struct spdk_reactor *reactor;
+	struct spdk_thread *thread;
+	int i;
+
+	MOCK_SET(spdk_env_get_current_core, 0);
+
+	allocate_cores(3);
+
+	CU_ASSERT(spdk_reactors_init(SPDK_DEFAULT_MSG_MEMPOOL_SIZE) == 0);
+
+	spdk_scheduler_set("dynamic");
+
+	for (i = 0; i < 3; i++) {
+		spdk_cpuset_set_cpu(&g_reactor_core_mask, i, true);
+		spdk_cpuset_set_cpu(&cpuset, i, true);
+	}
+	g_next_core = 0;
+
+	thread = spdk_thread_create(NULL, &cpuset);
+	SPDK_CU_ASSERT_FATAL(thread != NULL);
+
+	for (i = 0; i < 3; i++) {
+		reactor = spdk_reactor_get(i);
+		CU_ASSERT(reactor != NULL);
+		MOCK_SET(spdk_env_get_current_core, i);
+		event_queue_run_batch(reactor);
+	}
+	MOCK_SET(spdk_env_get_current_core, 0);
+
+	/* The thread takes the NUMA node it holds the most references on */
+	spdk_set_thread(thread);
+	CU_ASSERT(spdk_thread_get_numa_id(thread) == SPDK_ENV_NUMA_ID_ANY);
+	spdk_thread_get_numa_ref(1);
+	spdk_thread_get_numa_ref(0);
+	spdk_thread_get_numa_ref(1);
+	spdk_thread_get_numa_ref(SPDK_ENV_NUMA_ID_ANY);
+	CU_ASSERT(spdk_thread_get_numa_id(thread) == 1);
+	spdk_thread_put_numa_ref(1);
+	spdk_thread_put_numa_ref(1);
+	CU_ASSERT(spdk_thread_get_numa_id(thread) == 0);
+	spdk_thread_put_numa_ref(0);
+	spdk_thread_put_numa_ref(SPDK_ENV_NUMA_ID_ANY);
+	CU_ASSERT(spdk_thread_get_numa_id(thread) == SPDK_ENV_NUMA_ID_ANY);
+	spdk_set_thread(NULL);
+
+	/* Main core 0 is over the limit, cores 1 and 2 can fit the thread.
+	 * Cores 0 and 1 are on NUMA node 0, core 2 is on node 1. */
+	for (i = 0; i < 3; i++) {
+		g_cores[i].busy = 10;
+		g_cores[i].idle = 90;
+		g_cores[i].thread_count = 1;
+		g_cores[i].isolated = false;
+		g_cores[i].numa_id = i < 2 ? 0 : 1;
+	}
+	g_cores[0].busy = 90;
+	g_cores[0].idle = 10;
+	g_cores[0].thread_count = 2;
+
+	thread_info.lcore = 0;
+	thread_info.thread_id = spdk_thread_get_id(thread);
+	thread_info.current_stats.busy_tsc = 30;
+	thread_info.current_stats.idle_tsc = 70;
+
+	/* Without an affinity the lowest core that fits is picked */
+	thread_info.numa_id = SPDK_ENV_NUMA_ID_ANY;
+	CU_ASSERT(_find_optimal_core(&thread_info) == 1);
+
+	/* A core of the thread's node is preferred */
+	thread_info.numa_id = 1;
+	CU_ASSERT(_find_optimal_core(&thread_info) == 2);
+
+	g_scheduler_numa_affinity = false;
+	CU_ASSERT(_find_optimal_core(&thread_info) == 1);
+	g_scheduler_numa_affinity = true;
+
+	/* A thread on its node isn't consolidated onto a lower core of another node */
+	thread_info.lcore = 2;
+	CU_ASSERT(_find_optimal_core(&thread_info) == 2);
+	thread_info.numa_id = SPDK_ENV_NUMA_ID_ANY;
+	CU_ASSERT(_find_optimal_core(&thread_info) == 1);
+
+	/* When no core of the node fits, the thread goes to another node */
+	g_cores[2].busy = 80;
+	g_cores[2].idle = 20;
+	thread_info.lcore = 0;
+	thread_info.numa_id = 1;
+	CU_ASSERT(_find_optimal_core(&thread_info) == 1);
+
+	g_reactor_state = SPDK_REACTOR_STATE_INITIALIZED;
+
+	spdk_set_thread(thread);
+	spdk_thread_exit(thread);
+	for (i = 0; i < 3; i++) {
+		reactor = spdk_reactor_get(i);
+		CU_ASSERT(reactor != NULL);
+		reactor_run(reactor);
+	}
+
+	spdk_set_thread(NULL);
+
+	MOCK_CLEAR(spdk_env_get_current_core);
+
+	spdk_reactors_fini();
+
+	free_cores();
+}
+
 static void
 test_bind_thread(void)
 {
@@ -1243,6 +1355,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_for_each_reactor);
 	CU_ADD_TEST(suite, test_reactor_stats);
 	CU_ADD_TEST(suite, test_scheduler);
+	CU_ADD_TEST(suite, test_scheduler_numa);
 #ifndef __FreeBSD__
 	/* governor is only supported on Linux, so don't run this specific unit test on FreeBSD */
 	CU_ADD_TEST(suite, test_governor);
@@ -197,17 +197,28 @@ ftl_bitmap_clear(struct ftl_bitmap *bitmap, uint64_t bit)
 static void
 setup_band(void)
 {
+	uint64_t i;
 	int rc;
 
 	g_dev = test_init_ftl_dev(&g_geo);
 	g_band = test_init_ftl_band(g_dev, TEST_BAND_IDX, ftl_get_num_blocks_in_band(g_dev));
 	rc = ftl_band_alloc_p2l_map(g_band);
 	CU_ASSERT_EQUAL_FATAL(rc, 0);
+
+	/* Every band is its own physical group */
+	for (i = 0; i < g_dev->num_bands; i++) {
+		g_dev->bands[i].dev = g_dev;
+		g_dev->bands[i].phys_id = i;
+	}
+	g_dev->num_logical_bands_in_physical = 1;
+	rc = ftl_band_gc_init(g_dev);
+	CU_ASSERT_EQUAL_FATAL(rc, 0);
 }
 
 static void
 cleanup_band(void)
 {
+	ftl_band_gc_deinit(g_dev);
 	ftl_band_release_p2l_map(g_band);
 	test_free_ftl_band(g_band);
 	test_free_ftl_dev(g_dev);
@@ -385,6 +396,63 @@ test_next_xfer_addr(void)
 	cleanup_band();
 }
 
+static void
+test_gc_select(void)
+{
+	struct ftl_superblock sb = {};
+	struct ftl_band *old_band;
+	uint64_t user_blocks;
+
+	setup_band();
+	g_dev->sb = &sb;
+	user_blocks = ftl_band_user_blocks(g_band);
+
+	/* An old band with half of its blocks invalid and a recent one with three quarters */
+	old_band = &g_dev->bands[TEST_BAND_IDX / 2];
+	old_band->md->state = FTL_BAND_STATE_CLOSED;
+	old_band->md->close_seq_id = 1;
+	old_band->p2l_map.num_valid = user_blocks / 2;
+	g_band->md->close_seq_id = 100;
+	g_band->p2l_map.num_valid = user_blocks / 4;
+	sb.seq_id = 101;
+
+	ftl_band_gc_rebuild(g_dev);
+	CU_ASSERT_EQUAL(g_dev->gc.groups[old_band->phys_id].invalid, user_blocks - user_blocks / 2);
+	CU_ASSERT_EQUAL(g_dev->gc.groups[g_band->phys_id].invalid, user_blocks - user_blocks / 4);
+	CU_ASSERT_EQUAL(g_dev->gc.groups[0].bucket, FTL_GC_NUM_BUCKETS);
+
+	/* Greedy picks the most invalid group, cost-benefit prefers the old one */
+	g_dev->gc.policy = FTL_GC_POLICY_GREEDY;
+	CU_ASSERT_EQUAL(gc_select_group(g_dev), g_band->phys_id);
+	g_dev->gc.policy = FTL_GC_POLICY_COST_BENEFIT;
+	CU_ASSERT_EQUAL(gc_select_group(g_dev), old_band->phys_id);
+
+	/* Invalidating blocks moves the group to higher buckets */
+	old_band->p2l_map.num_valid = 0;
+	ftl_band_gc_invalidate(old_band);
+	CU_ASSERT_EQUAL(g_dev->gc.groups[old_band->phys_id].invalid,
+			user_blocks - user_blocks / 2 + 1);
+	ftl_band_gc_rebuild(g_dev);
+	CU_ASSERT_EQUAL(g_dev->gc.groups[old_band->phys_id].invalid, user_blocks);
+	g_dev->gc.policy = FTL_GC_POLICY_GREEDY;
+	CU_ASSERT_EQUAL(gc_select_group(g_dev), old_band->phys_id);
+
+	/* Bands under relocation aren't candidates anymore */
+	old_band->reloc = true;
+	gc_group_update(old_band);
+	CU_ASSERT_EQUAL(g_dev->gc.groups[old_band->phys_id].bucket, FTL_GC_NUM_BUCKETS);
+	CU_ASSERT_EQUAL(gc_select_group(g_dev), g_band->phys_id);
+	g_band->reloc = true;
+	gc_group_update(g_band);
+	CU_ASSERT_EQUAL(gc_select_group(g_dev), FTL_BAND_PHYS_ID_INVALID);
+
+	old_band->md->state = FTL_BAND_STATE_FREE;
+	g_band->reloc = false;
+	g_band->p2l_map.num_valid = 0;
+	g_dev->sb = NULL;
+	cleanup_band();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -402,6 +470,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_band_set_addr);
 	CU_ADD_TEST(suite, test_invalidate_addr);
 	CU_ADD_TEST(suite, test_next_xfer_addr);
+	CU_ADD_TEST(suite, test_gc_select);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
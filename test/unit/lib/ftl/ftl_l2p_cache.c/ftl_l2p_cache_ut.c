@@ -0,0 +1,265 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "spdk_internal/mock.h"
+#include "common/lib/test_env.c"
+
+#include "ftl/ftl_l2p_cache.c"
+#include "ftl/utils/ftl_bitmap.c"
+
+#define UT_RESIDENT_PAGES	8
+#define UT_NUM_PAGES		64
+
+DEFINE_STUB_V(ftl_mempool_put, (struct ftl_mempool *mpool, void *element));
+
+static struct spdk_ftl_dev g_dev;
+static struct ftl_l2p_cache g_cache;
+static struct ftl_l2p_l1_map_entry g_l2_mapping[UT_NUM_PAGES];
+static struct ftl_l2p_page g_pages[UT_NUM_PAGES];
+
+static void
+setup_cache(void)
+{
+	struct ftl_l2p_cache *cache = &g_cache;
+	uint64_t i;
+
+	memset(&g_dev, 0, sizeof(g_dev));
+	memset(cache, 0, sizeof(*cache));
+	memset(g_pages, 0, sizeof(g_pages));
+	for (i = 0; i < UT_NUM_PAGES; i++) {
+		g_l2_mapping[i].page_obj_id = FTL_DF_OBJ_ID_INVALID;
+	}
+
+	cache->dev = &g_dev;
+	cache->l2_mapping = g_l2_mapping;
+	cache->num_pages = UT_NUM_PAGES;
+	cache->l2_pgs_resident_max = UT_RESIDENT_PAGES;
+	cache->l2_pgs_avail = UT_RESIDENT_PAGES;
+	TAILQ_INIT(&cache->in_list);
+	TAILQ_INIT(&cache->hot_list);
+
+	/* 2 pages referenced once, 4 ghost entries */
+	cache->in_max = spdk_divide_round_up(UT_RESIDENT_PAGES * FTL_L2P_CACHE_IN_RATIO, 100);
+	cache->ghost.max = spdk_divide_round_up(UT_RESIDENT_PAGES * FTL_L2P_CACHE_GHOST_RATIO, 100);
+	cache->ghost.ring = calloc(cache->ghost.max, sizeof(*cache->ghost.ring));
+	cache->ghost.map_buf = calloc(1, ftl_bitmap_bits_to_size(UT_NUM_PAGES));
+	SPDK_CU_ASSERT_FATAL(cache->ghost.ring != NULL && cache->ghost.map_buf != NULL);
+	cache->ghost.map = ftl_bitmap_create(cache->ghost.map_buf,
+					     ftl_bitmap_bits_to_size(UT_NUM_PAGES));
+	SPDK_CU_ASSERT_FATAL(cache->ghost.map != NULL);
+}
+
+static void
+cleanup_cache(void)
+{
+	ftl_bitmap_destroy(g_cache.ghost.map);
+	free(g_cache.ghost.map_buf);
+	free(g_cache.ghost.ring);
+}
+
+static bool
+page_is_resident(uint64_t page_no)
+{
+	return g_l2_mapping[page_no].page_obj_id != FTL_DF_OBJ_ID_INVALID;
+}
+
+static uint64_t
+evict_page(void)
+{
+	struct ftl_l2p_page *page = eviction_get_page(&g_dev, &g_cache);
+
+	SPDK_CU_ASSERT_FATAL(page != NULL);
+	CU_ASSERT(!page->on_lru_list);
+	ftl_l2p_cache_page_evict(&g_cache, page);
+
+	return page->page_no;
+}
+
+static void
+lookup_page(uint64_t page_no, bool background)
+{
+	struct ftl_l2p_pin_ctx pin_ctx = { .background = background };
+	struct ftl_l2p_page *page = &g_pages[page_no];
+
+	SPDK_CU_ASSERT_FATAL(page_is_resident(page_no));
+	ftl_l2p_cache_page_pin(&g_cache, page, &pin_ctx);
+	CU_ASSERT(!page->on_lru_list);
+	ftl_l2p_cache_page_unpin(&g_cache, page);
+	CU_ASSERT(page->on_lru_list);
+}
+
+/* Page in the page as done by page_in(), evicting one first if the cache is full */
+static void
+ut_page_in(uint64_t page_no, bool background)
+{
+	struct ftl_l2p_page *page = &g_pages[page_no];
+
+	SPDK_CU_ASSERT_FATAL(!page_is_resident(page_no));
+	if (!g_cache.l2_pgs_avail) {
+		evict_page();
+	}
+
+	memset(page, 0, sizeof(*page));
+	TAILQ_INIT(&page->ppe_list);
+	page->page_no = page_no;
+	page->obj_id = page_no;
+	page->state = L2P_CACHE_PAGE_READY;
+	g_cache.l2_pgs_avail--;
+	ftl_l2p_cache_page_insert(&g_cache, page);
+	ftl_l2p_cache_page_admit(&g_cache, page, background);
+
+	lookup_page(page_no, background);
+}
+
+static void
+test_ghost_promotion(void)
+{
+	struct ftl_l2p_cache *cache = &g_cache;
+	uint64_t i;
+
+	setup_cache();
+
+	for (i = 0; i < 3; i++) {
+		ut_page_in(i, false);
+	}
+
+	/* Repeated lookups while referenced once don't promote */
+	lookup_page(0, false);
+	lookup_page(0, false);
+	CU_ASSERT(!g_pages[0].hot);
+	CU_ASSERT(cache->hot_cnt == 0);
+
+	/* Least recently used first, evicted pages are remembered */
+	CU_ASSERT(evict_page() == 1);
+	CU_ASSERT(evict_page() == 2);
+	CU_ASSERT(cache->ghost.cnt == 2);
+
+	/* Paged in again while remembered, the page goes to hot_list */
+	ut_page_in(1, false);
+	CU_ASSERT(g_pages[1].hot);
+	CU_ASSERT(cache->hot_cnt == 1);
+	CU_ASSERT(TAILQ_FIRST(&cache->hot_list) == &g_pages[1]);
+	CU_ASSERT(!ftl_bitmap_get(cache->ghost.map, 1));
+
+	/* Background lookups don't promote, neither from the ghost queue nor on eviction */
+	ut_page_in(2, true);
+	CU_ASSERT(!g_pages[2].hot);
+	CU_ASSERT(!g_pages[2].referenced);
+	CU_ASSERT(ftl_bitmap_get(cache->ghost.map, 2));
+	ut_page_in(3, false);
+	CU_ASSERT(evict_page() == 2);
+	CU_ASSERT(cache->ghost.cnt == 2);
+
+	/* A hot page evicted isn't remembered */
+	CU_ASSERT(evict_page() == 1);
+	CU_ASSERT(cache->hot_cnt == 0);
+	CU_ASSERT(cache->ghost.cnt == 2);
+	CU_ASSERT(evict_page() == 0);
+	CU_ASSERT(evict_page() == 3);
+	CU_ASSERT(cache->ghost.cnt == cache->ghost.max);
+	CU_ASSERT(cache->l2_pgs_avail == UT_RESIDENT_PAGES);
+	CU_ASSERT(g_dev.stats.l2p_cache.evictions == 6);
+
+	/* The oldest entries are forgotten once the ghost queue is full */
+	for (i = 10; i < 12; i++) {
+		ut_page_in(i, false);
+		CU_ASSERT(evict_page() == i);
+	}
+	CU_ASSERT(!ftl_bitmap_get(cache->ghost.map, 2));
+	ut_page_in(2, false);
+	CU_ASSERT(!g_pages[2].hot);
+
+	cleanup_cache();
+}
+
+static void
+test_scan_resistance(void)
+{
+	struct ftl_l2p_cache *cache = &g_cache;
+	struct ftl_l2p_pin_ctx gc_pin_ctx = { .background = true }, user_pin_ctx = {};
+	struct ftl_l2p_page *page;
+	uint64_t i, hot_cnt = 3;
+
+	setup_cache();
+	for (i = 0; i < hot_cnt; i++) {
+		ut_page_in(i, false);
+	}
+	for (i = 0; i < hot_cnt; i++) {
+		CU_ASSERT(evict_page() == i);
+	}
+	for (i = 0; i < hot_cnt; i++) {
+		ut_page_in(i, false);
+		CU_ASSERT(g_pages[i].hot);
+	}
+
+	/* A scan by user IO goes through in_list only */
+	for (i = 20; i < 40; i++) {
+		ut_page_in(i, false);
+		lookup_page(i, false);
+	}
+	CU_ASSERT(cache->hot_cnt == hot_cnt);
+	for (i = 0; i < hot_cnt; i++) {
+		CU_ASSERT(page_is_resident(i));
+	}
+	CU_ASSERT(page_is_resident(38) && page_is_resident(39));
+
+	/* Pages paged in by GC are the first ones to evict, so a GC scan takes a single page */
+	lookup_page(0, true);
+	for (i = 40; i < 60; i++) {
+		ut_page_in(i, true);
+	}
+	CU_ASSERT(cache->hot_cnt == hot_cnt);
+	for (i = 0; i < hot_cnt; i++) {
+		CU_ASSERT(page_is_resident(i));
+	}
+	for (i = 36; i < 40; i++) {
+		CU_ASSERT(page_is_resident(i));
+	}
+	CU_ASSERT(!page_is_resident(58));
+	CU_ASSERT(evict_page() == 59);
+	CU_ASSERT(evict_page() == 36);
+
+	/* Pinned pages are kept off the lists, so eviction doesn't walk them */
+	ftl_l2p_cache_page_pin(cache, &g_pages[0], &gc_pin_ctx);
+	ftl_l2p_cache_page_pin(cache, &g_pages[1], &user_pin_ctx);
+	CU_ASSERT(!g_pages[0].on_lru_list && !g_pages[1].on_lru_list);
+	while ((page = eviction_get_page(&g_dev, cache))) {
+		CU_ASSERT(page != &g_pages[0] && page != &g_pages[1]);
+		ftl_l2p_cache_page_evict(cache, page);
+	}
+	CU_ASSERT(cache->l2_pgs_avail == UT_RESIDENT_PAGES - 2);
+	CU_ASSERT(TAILQ_EMPTY(&cache->hot_list) && TAILQ_EMPTY(&cache->in_list));
+
+	/* Unpinned, they are back on hot_list */
+	ftl_l2p_cache_page_unpin(cache, &g_pages[0]);
+	ftl_l2p_cache_page_unpin(cache, &g_pages[1]);
+	CU_ASSERT(TAILQ_FIRST(&cache->hot_list) == &g_pages[1]);
+	CU_ASSERT(TAILQ_LAST(&cache->hot_list, l2p_lru_list) == &g_pages[0]);
+	CU_ASSERT(TAILQ_EMPTY(&cache->in_list));
+
+	cleanup_cache();
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("ftl_l2p_cache_suite", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_ghost_promotion);
+	CU_ADD_TEST(suite, test_scan_resistance);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -0,0 +1,159 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2026 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "common/lib/test_env.c"
+
+#include "ftl/ftl_nv_cache.c"
+
+#define UT_LBAS_IN_PAGE	4
+#define UT_NUM_PAGES	4
+
+static struct spdk_ftl_dev g_dev;
+
+uint64_t
+ftl_io_get_lba(const struct ftl_io *io, size_t offset)
+{
+	CU_ASSERT(offset < io->num_blocks);
+	return io->lba + offset;
+}
+
+static void
+setup_heat(void)
+{
+	struct ftl_nv_cache *nv_cache = &g_dev.nv_cache;
+
+	memset(&g_dev, 0, sizeof(g_dev));
+	g_dev.layout.l2p.lbas_in_page = UT_LBAS_IN_PAGE;
+	nv_cache->heat.enabled = true;
+	nv_cache->heat.num_pages = UT_NUM_PAGES;
+	nv_cache->heat.pages = calloc(UT_NUM_PAGES, sizeof(*nv_cache->heat.pages));
+	SPDK_CU_ASSERT_FATAL(nv_cache->heat.pages != NULL);
+	nv_cache->heat.epoch_blocks = UT_LBAS_IN_PAGE * UT_NUM_PAGES;
+}
+
+static void
+cleanup_heat(void)
+{
+	free(g_dev.nv_cache.heat.pages);
+	g_dev.nv_cache.heat.pages = NULL;
+}
+
+static void
+write_page(uint64_t page, bool overwrite)
+{
+	ftl_addr map[UT_LBAS_IN_PAGE];
+	struct ftl_io io = {
+		.lba = page * UT_LBAS_IN_PAGE,
+		.num_blocks = UT_LBAS_IN_PAGE,
+		.map = map,
+	};
+	size_t i;
+
+	for (i = 0; i < UT_LBAS_IN_PAGE; i++) {
+		map[i] = overwrite ? i : FTL_ADDR_INVALID;
+	}
+
+	heat_update(&g_dev, &io);
+}
+
+static void
+test_heat_update(void)
+{
+	struct ftl_nv_cache *nv_cache = &g_dev.nv_cache;
+
+	setup_heat();
+
+	/* Only overwrites make the data hot */
+	write_page(0, false);
+	CU_ASSERT(heat_get_updates(nv_cache, 0) == 0);
+	write_page(1, true);
+	CU_ASSERT(heat_get_updates(nv_cache, 1) == UT_LBAS_IN_PAGE);
+	CU_ASSERT(heat_get_updates(nv_cache, 1) >= FTL_NV_CACHE_HOT_UPDATES);
+	CU_ASSERT(nv_cache->heat.epoch == 0);
+
+	/* The epoch advances once as many blocks as the cache holds are written */
+	write_page(2, false);
+	write_page(3, false);
+	CU_ASSERT(nv_cache->heat.epoch == 1);
+	CU_ASSERT(nv_cache->heat.epoch_written == 0);
+
+	/* The counter saturates instead of wrapping around */
+	nv_cache->heat.pages[1].updates = UINT8_MAX - 1;
+	nv_cache->heat.pages[1].epoch = nv_cache->heat.epoch;
+	write_page(1, true);
+	CU_ASSERT(heat_get_updates(nv_cache, 1) == UINT8_MAX);
+
+	cleanup_heat();
+}
+
+static void
+test_heat_decay(void)
+{
+	struct ftl_nv_cache *nv_cache = &g_dev.nv_cache;
+	struct ftl_nv_cache_heat *heat;
+	uint32_t age;
+
+	setup_heat();
+	heat = &nv_cache->heat.pages[0];
+
+	/* The counter is halved for every epoch that passed since the page was last seen */
+	heat->updates = 128;
+	for (age = 1; age < FTL_NV_CACHE_HEAT_DECAY_EPOCHS; age++) {
+		nv_cache->heat.epoch++;
+		CU_ASSERT(heat_get_updates(nv_cache, 0) == 128 >> age);
+		CU_ASSERT(heat->epoch == nv_cache->heat.epoch);
+	}
+
+	/* Skipping several epochs at once decays it the same way */
+	heat->updates = 128;
+	nv_cache->heat.epoch += 3;
+	CU_ASSERT(heat_get_updates(nv_cache, 0) == 16);
+
+	/* Anything at or past the decay horizon is cold */
+	heat->updates = UINT8_MAX;
+	nv_cache->heat.epoch += FTL_NV_CACHE_HEAT_DECAY_EPOCHS;
+	CU_ASSERT(heat_get_updates(nv_cache, 0) == 0);
+
+	/* A page not seen for a multiple of 256 epochs doesn't come back hot */
+	heat->updates = UINT8_MAX;
+	nv_cache->heat.epoch += 256;
+	CU_ASSERT(heat_get_updates(nv_cache, 0) == 0);
+
+	heat->updates = UINT8_MAX;
+	nv_cache->heat.epoch += 65536;
+	CU_ASSERT(heat_get_updates(nv_cache, 0) == 0);
+
+	/* The decay is unaffected by the epoch wrapping around */
+	nv_cache->heat.epoch = UINT32_MAX;
+	CU_ASSERT(heat_get_updates(nv_cache, 0) == 0);
+	heat->updates = 128;
+	nv_cache->heat.epoch += 2;
+	CU_ASSERT(nv_cache->heat.epoch == 1);
+	CU_ASSERT(heat_get_updates(nv_cache, 0) == 32);
+
+	cleanup_heat();
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("ftl_nv_cache_suite", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_heat_update);
+	CU_ADD_TEST(suite, test_heat_decay);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
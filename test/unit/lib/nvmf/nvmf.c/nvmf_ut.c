@@ -119,6 +119,24 @@ DEFINE_STUB(spdk_key_get_name, const char *, (struct spdk_key *k), NULL);
 DEFINE_STUB(nvmf_qpair_auth_init, int, (struct spdk_nvmf_qpair *q), 0);
 DEFINE_STUB_V(nvmf_qpair_auth_destroy, (struct spdk_nvmf_qpair *q));
 DEFINE_STUB_V(nvmf_tgt_stop_mdns_prr, (struct spdk_nvmf_tgt *tgt));
+DEFINE_STUB(nvmf_transport_poll_group_detach, int, (struct spdk_nvmf_transport_poll_group *group,
+		struct spdk_nvmf_qpair *qpair), 0);
+
+static struct spdk_nvmf_transport_poll_group *g_attach_tgroup;
+
+int
+nvmf_transport_poll_group_attach(struct spdk_nvmf_transport_poll_group *group,
+				 struct spdk_nvmf_qpair *qpair)
+{
+	g_attach_tgroup = group;
+	return 0;
+}
+
+static int
+ut_poll_group_detach(struct spdk_nvmf_transport_poll_group *group, struct spdk_nvmf_qpair *qpair)
+{
+	return 0;
+}
 
 struct spdk_io_channel {
 	struct spdk_thread		*thread;
@@ -220,6 +238,201 @@ test_nvmf_tgt_create_poll_group(void)
 	MOCK_CLEAR(spdk_bdev_get_io_channel);
 }
 
+static void
+test_nvmf_poll_group_load(void)
+{
+	struct spdk_nvmf_poll_group group[2] = {};
+
+	group[0].load.numa_id = 0;
+	group[1].load.numa_id = 1;
+
+	/* Idle poll groups are compared by their number of qpairs */
+	group[0].stat.current_io_qpairs = 2;
+	group[1].stat.current_io_qpairs = 1;
+	CU_ASSERT(nvmf_poll_group_cmp_load(&group[0], &group[1], SPDK_ENV_NUMA_ID_ANY) > 0);
+	group[1].load.new_qpairs = 1;
+	CU_ASSERT(nvmf_poll_group_cmp_load(&group[0], &group[1], SPDK_ENV_NUMA_ID_ANY) == 0);
+
+	/* The busy percentage is projected on the qpairs placed since the last sample */
+	group[0].load.busy_pct = 40;
+	group[1].load.busy_pct = 30;
+	CU_ASSERT(nvmf_poll_group_get_score(&group[0], SPDK_ENV_NUMA_ID_ANY) == 40);
+	CU_ASSERT(nvmf_poll_group_get_score(&group[1], SPDK_ENV_NUMA_ID_ANY) == 60);
+	CU_ASSERT(nvmf_poll_group_cmp_load(&group[0], &group[1], SPDK_ENV_NUMA_ID_ANY) < 0);
+
+	/* Poll groups on another NUMA node are used only if they're much less busy */
+	group[1].load.new_qpairs = 0;
+	CU_ASSERT(nvmf_poll_group_cmp_load(&group[0], &group[1], SPDK_ENV_NUMA_ID_ANY) > 0);
+	CU_ASSERT(nvmf_poll_group_cmp_load(&group[0], &group[1], 0) < 0);
+	CU_ASSERT(nvmf_poll_group_cmp_load(&group[0], &group[1], 1) > 0);
+	group[1].load.busy_pct = 10;
+	CU_ASSERT(nvmf_poll_group_cmp_load(&group[0], &group[1], 0) > 0);
+
+	/* Poll groups whose NUMA node is unknown are local to all qpairs */
+	group[1].load.busy_pct = 30;
+	group[1].load.numa_id = SPDK_ENV_NUMA_ID_ANY;
+	CU_ASSERT(nvmf_poll_group_cmp_load(&group[0], &group[1], 0) > 0);
+}
+
+static void
+test_nvmf_poll_group_migrate_qpair(void)
+{
+	struct spdk_thread *thread[2];
+	struct spdk_nvmf_tgt tgt = {};
+	struct spdk_nvmf_transport_ops ops = { .poll_group_detach = ut_poll_group_detach };
+	struct spdk_nvmf_transport transport = { .ops = &ops };
+	struct spdk_nvmf_transport_poll_group tgroup[2] = {};
+	struct spdk_nvmf_subsystem_poll_group sgroup[2] = {};
+	struct spdk_nvmf_poll_group group[2] = {};
+	struct spdk_nvmf_subsystem subsystem = {};
+	struct spdk_nvmf_ctrlr ctrlr = { .subsys = &subsystem };
+	struct spdk_nvmf_qpair qpair[4] = {};
+	uint32_t balance_io[4] = { 0, 50, 150, 5000 };
+	int i;
+
+	thread[0] = spdk_thread_create(NULL, NULL);
+	thread[1] = spdk_thread_create(NULL, NULL);
+	SPDK_CU_ASSERT_FATAL(thread[0] != NULL && thread[1] != NULL);
+
+	TAILQ_INIT(&tgt.poll_groups);
+	pthread_mutex_init(&tgt.mutex, NULL);
+	tgt.qpair_balance_threshold = 20;
+
+	for (i = 0; i < 2; i++) {
+		group[i].thread = thread[i];
+		group[i].tgt = &tgt;
+		group[i].sgroups = &sgroup[i];
+		group[i].num_sgroups = 1;
+		sgroup[i].state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+		TAILQ_INIT(&group[i].tgroups);
+		TAILQ_INIT(&group[i].qpairs);
+		tgroup[i].transport = &transport;
+		tgroup[i].group = &group[i];
+		TAILQ_INSERT_TAIL(&group[i].tgroups, &tgroup[i], link);
+		TAILQ_INSERT_TAIL(&tgt.poll_groups, &group[i], link);
+	}
+
+	/* An admin qpair and three I/O qpairs on the first poll group */
+	for (i = 0; i < 4; i++) {
+		qpair[i].qid = i;
+		qpair[i].state = SPDK_NVMF_QPAIR_ENABLED;
+		qpair[i].transport = &transport;
+		qpair[i].ctrlr = &ctrlr;
+		qpair[i].group = &group[0];
+		TAILQ_INIT(&qpair[i].outstanding);
+		TAILQ_INSERT_TAIL(&group[0].qpairs, &qpair[i], link);
+	}
+	group[0].stat.current_admin_qpairs = 1;
+	group[0].stat.current_io_qpairs = 3;
+
+	spdk_set_thread(thread[0]);
+
+	/* Balanced poll groups don't migrate qpairs */
+	group[0].load.busy_pct = 40;
+	group[1].load.busy_pct = 30;
+	for (i = 0; i < NVMF_POLL_GROUP_OVERLOAD_PERIODS; i++) {
+		nvmf_poll_group_balance(&group[0]);
+	}
+	CU_ASSERT(group[0].overload_periods == 0);
+	CU_ASSERT(group[0].migration.qpair == NULL);
+
+	/* Overloaded poll groups start measuring the I/O of their qpairs */
+	group[0].load.busy_pct = 90;
+	group[1].load.busy_pct = 10;
+	nvmf_poll_group_balance(&group[0]);
+	CU_ASSERT(group[0].overload_periods == 1);
+	for (i = 0; i < 4; i++) {
+		qpair[i].balance_io = balance_io[i];
+	}
+
+	/* Once the overload persists, the qpair getting both poll groups the closest to the same
+	 * load is migrated.  The last qpair does more I/O than the whole difference. */
+	for (i = 1; i < NVMF_POLL_GROUP_OVERLOAD_PERIODS - 1; i++) {
+		nvmf_poll_group_balance(&group[0]);
+		CU_ASSERT(group[0].migration.qpair == NULL);
+	}
+	nvmf_poll_group_balance(&group[0]);
+	CU_ASSERT(group[0].overload_periods == 0);
+	CU_ASSERT(group[0].migration.qpair == &qpair[2]);
+	CU_ASSERT(group[0].migration.dst == &group[1]);
+	CU_ASSERT(group[0].migration.poller != NULL);
+	CU_ASSERT(group[1].load.new_qpairs == 1);
+
+	/* The qpair stays in its poll group while it's busy */
+	MOCK_SET(nvmf_transport_poll_group_detach, -EAGAIN);
+	nvmf_poll_group_migrate_poll(&group[0]);
+	CU_ASSERT(group[0].migration.qpair == &qpair[2]);
+	CU_ASSERT(qpair[2].group == &group[0]);
+
+	/* Once detached, it's attached to the other poll group on its thread */
+	MOCK_SET(nvmf_transport_poll_group_detach, 0);
+	nvmf_poll_group_migrate_poll(&group[0]);
+	CU_ASSERT(group[0].migration.qpair == NULL);
+	CU_ASSERT(group[0].migration.poller == NULL);
+	CU_ASSERT(qpair[2].group == &group[1]);
+	CU_ASSERT(group[0].stat.current_io_qpairs == 2);
+	CU_ASSERT(g_attach_tgroup == NULL);
+
+	spdk_set_thread(thread[1]);
+	spdk_thread_poll(thread[1], 0, 0);
+	CU_ASSERT(g_attach_tgroup == &tgroup[1]);
+	CU_ASSERT(TAILQ_FIRST(&group[1].qpairs) == &qpair[2]);
+	CU_ASSERT(group[1].stat.current_io_qpairs == 1);
+
+	/* A qpair that doesn't quiesce in time resumes in its poll group */
+	spdk_set_thread(thread[0]);
+	g_attach_tgroup = NULL;
+	MOCK_SET(nvmf_transport_poll_group_detach, -EAGAIN);
+	group[0].migration.qpair = &qpair[1];
+	group[0].migration.dst = &group[1];
+	group[0].migration.timeout_tsc = 0;
+	nvmf_poll_group_migrate_poll(&group[0]);
+	CU_ASSERT(group[0].migration.qpair == NULL);
+	CU_ASSERT(g_attach_tgroup == &tgroup[0]);
+	CU_ASSERT(qpair[1].group == &group[0]);
+	CU_ASSERT(group[0].stat.current_io_qpairs == 2);
+
+	/* A qpair disconnected before it's attached to its new poll group is disconnected
+	 * once it's attached */
+	MOCK_SET(nvmf_transport_poll_group_detach, 0);
+	qpair[1].connect_received = true;
+	group[0].migration.qpair = &qpair[1];
+	group[0].migration.dst = &group[1];
+	group[0].migration.timeout_tsc = UINT64_MAX;
+	nvmf_poll_group_migrate_poll(&group[0]);
+	CU_ASSERT(qpair[1].group == &group[1]);
+	CU_ASSERT(qpair[1].migrating);
+	CU_ASSERT(group[0].stat.current_io_qpairs == 1);
+
+	spdk_set_thread(thread[1]);
+	CU_ASSERT(spdk_nvmf_qpair_disconnect(&qpair[1]) == 0);
+	CU_ASSERT(qpair[1].state == SPDK_NVMF_QPAIR_ENABLED);
+	CU_ASSERT(qpair[1].disconnect_deferred);
+	CU_ASSERT(!qpair[1].disconnect_started);
+	CU_ASSERT(TAILQ_FIRST(&group[1].qpairs) == &qpair[2]);
+	CU_ASSERT(TAILQ_NEXT(&qpair[2], link) == NULL);
+
+	spdk_thread_poll(thread[1], 0, 0);
+	CU_ASSERT(!qpair[1].migrating);
+	CU_ASSERT(!qpair[1].disconnect_deferred);
+	CU_ASSERT(qpair[1].state == SPDK_NVMF_QPAIR_ERROR);
+	CU_ASSERT(qpair[1].group == NULL);
+	CU_ASSERT(TAILQ_FIRST(&group[1].qpairs) == &qpair[2]);
+	CU_ASSERT(TAILQ_NEXT(&qpair[2], link) == NULL);
+	CU_ASSERT(group[1].stat.current_io_qpairs == 1);
+	MOCK_CLEAR(nvmf_transport_poll_group_detach);
+
+	for (i = 0; i < 2; i++) {
+		spdk_set_thread(thread[i]);
+		spdk_thread_exit(thread[i]);
+		while (!spdk_thread_is_exited(thread[i])) {
+			spdk_thread_poll(thread[i], 0, 0);
+		}
+		spdk_thread_destroy(thread[i]);
+	}
+	pthread_mutex_destroy(&tgt.mutex);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -231,6 +444,8 @@ main(int argc, char **argv)
 	suite = CU_add_suite("nvmf", NULL, NULL);
 
 	CU_ADD_TEST(suite, test_nvmf_tgt_create_poll_group);
+	CU_ADD_TEST(suite, test_nvmf_poll_group_load);
+	CU_ADD_TEST(suite, test_nvmf_poll_group_migrate_qpair);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
@@ -213,6 +213,9 @@ DEFINE_STUB(spdk_sock_group_get_ctx,
 	    (struct spdk_sock_group *group),
 	    NULL);
 
+DEFINE_STUB(nvmf_poll_group_cmp_load, int, (struct spdk_nvmf_poll_group *a,
+		struct spdk_nvmf_poll_group *b, int32_t numa_id), 0);
+
 DEFINE_STUB_V(nvmf_ns_reservation_request, (void *ctx));
 
 DEFINE_STUB_V(spdk_nvme_trid_populate_transport, (struct spdk_nvme_transport_id *trid,
@@ -97,6 +97,169 @@ test_xor_gen(void)
 	free(ref);
 }
 
+static uint8_t
+ref_gf_mul(uint8_t a, uint8_t b)
+{
+	uint8_t r = 0;
+
+	while (b) {
+		if (b & 1) {
+			r ^= a;
+		}
+		a = (a << 1) ^ ((a & 0x80) ? 0x1d : 0);
+		b >>= 1;
+	}
+
+	return r;
+}
+
+static void
+ref_pq_gen(uint8_t *p, uint8_t *q, void **sources, uint32_t n, uint32_t len)
+{
+	uint8_t g = 1;
+	uint32_t i, j;
+
+	memset(p, 0, len);
+	memset(q, 0, len);
+
+	for (i = 0; i < n; i++) {
+		for (j = 0; j < len; j++) {
+			p[j] ^= ((uint8_t *)sources[i])[j];
+			q[j] ^= ref_gf_mul(g, ((uint8_t *)sources[i])[j]);
+		}
+		g = ref_gf_mul(g, 2);
+	}
+}
+
+static void
+test_xor_gen_pq(void)
+{
+	void *bufs[BUF_COUNT + 1];
+	void *bufs2[SRC_BUF_COUNT];
+	uint8_t *ref_p, *ref_q, *p, *q;
+	int ret;
+	size_t i, j;
+
+	for (i = 0; i < BUF_COUNT + 1; i++) {
+		ret = posix_memalign(&bufs[i], spdk_xor_get_optimal_alignment(), BUF_SIZE);
+		SPDK_CU_ASSERT_FATAL(ret == 0);
+
+		for (j = 0; j < BUF_SIZE; j++) {
+			((uint8_t *)bufs[i])[j] = rand();
+		}
+	}
+	p = bufs[SRC_BUF_COUNT];
+	q = bufs[BUF_COUNT];
+
+	ref_p = malloc(BUF_SIZE);
+	SPDK_CU_ASSERT_FATAL(ref_p != NULL);
+	ref_q = malloc(BUF_SIZE);
+	SPDK_CU_ASSERT_FATAL(ref_q != NULL);
+
+	ref_pq_gen(ref_p, ref_q, bufs, SRC_BUF_COUNT, BUF_SIZE);
+
+	ret = spdk_xor_gen_pq(p, q, bufs, SRC_BUF_COUNT, BUF_SIZE);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(memcmp(ref_p, p, BUF_SIZE) == 0);
+	CU_ASSERT(memcmp(ref_q, q, BUF_SIZE) == 0);
+
+	/* len not multiple of alignment */
+	memset(p, 0xba, BUF_SIZE);
+	memset(q, 0xba, BUF_SIZE);
+	ret = spdk_xor_gen_pq(p, q, bufs, SRC_BUF_COUNT, BUF_SIZE - 1);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(memcmp(ref_p, p, BUF_SIZE - 1) == 0);
+	CU_ASSERT(memcmp(ref_q, q, BUF_SIZE - 1) == 0);
+
+	/* unaligned buffer */
+	memcpy(bufs2, bufs, sizeof(bufs2));
+	bufs2[1] += 1;
+	bufs2[2] += 2;
+	bufs2[3] += 3;
+
+	ref_pq_gen(ref_p, ref_q, bufs2, SRC_BUF_COUNT, BUF_SIZE - SRC_BUF_COUNT);
+
+	ret = spdk_xor_gen_pq(p, q, bufs2, SRC_BUF_COUNT, BUF_SIZE - SRC_BUF_COUNT);
+	CU_ASSERT(ret == 0);
+	CU_ASSERT(memcmp(ref_p, p, BUF_SIZE - SRC_BUF_COUNT) == 0);
+	CU_ASSERT(memcmp(ref_q, q, BUF_SIZE - SRC_BUF_COUNT) == 0);
+
+	/* invalid number of sources */
+	ret = spdk_xor_gen_pq(p, q, bufs, 1, BUF_SIZE);
+	CU_ASSERT(ret == -EINVAL);
+
+	for (i = 0; i < BUF_COUNT + 1; i++) {
+		free(bufs[i]);
+	}
+	free(ref_p);
+	free(ref_q);
+}
+
+static void
+test_xor_recover_pq(void)
+{
+	void *bufs[BUF_COUNT + 1];
+	void *ref[BUF_COUNT + 1];
+	uint32_t failed[2];
+	uint32_t a, b;
+	uint32_t len;
+	int ret;
+	size_t i, j;
+
+	for (i = 0; i < BUF_COUNT + 1; i++) {
+		ret = posix_memalign(&bufs[i], spdk_xor_get_optimal_alignment(), BUF_SIZE);
+		SPDK_CU_ASSERT_FATAL(ret == 0);
+		ref[i] = malloc(BUF_SIZE);
+		SPDK_CU_ASSERT_FATAL(ref[i] != NULL);
+
+		for (j = 0; j < BUF_SIZE; j++) {
+			((uint8_t *)bufs[i])[j] = rand();
+		}
+	}
+
+	ret = spdk_xor_gen_pq(bufs[SRC_BUF_COUNT], bufs[BUF_COUNT], bufs, SRC_BUF_COUNT, BUF_SIZE);
+	SPDK_CU_ASSERT_FATAL(ret == 0);
+
+	for (i = 0; i < BUF_COUNT + 1; i++) {
+		memcpy(ref[i], bufs[i], BUF_SIZE);
+	}
+
+	/* every combination of one or two failed buffers, data or parity, also with a length not
+	 * multiple of the word size */
+	for (len = BUF_SIZE - 1; len <= BUF_SIZE; len++) {
+		for (a = 0; a < BUF_COUNT + 1; a++) {
+			for (b = a; b < BUF_COUNT + 1; b++) {
+				failed[0] = a;
+				failed[1] = b;
+
+				memset(bufs[a], 0xba, BUF_SIZE);
+				memset(bufs[b], 0xba, BUF_SIZE);
+
+				ret = spdk_xor_recover_pq(bufs, SRC_BUF_COUNT, len, failed, a == b ? 1 : 2);
+				CU_ASSERT(ret == 0);
+				CU_ASSERT(memcmp(bufs[a], ref[a], len) == 0);
+				CU_ASSERT(memcmp(bufs[b], ref[b], len) == 0);
+
+				memcpy(bufs[a], ref[a], BUF_SIZE);
+				memcpy(bufs[b], ref[b], BUF_SIZE);
+			}
+		}
+	}
+
+	/* invalid parameters */
+	failed[0] = BUF_COUNT + 1;
+	ret = spdk_xor_recover_pq(bufs, SRC_BUF_COUNT, BUF_SIZE, failed, 1);
+	CU_ASSERT(ret == -EINVAL);
+	failed[0] = 0;
+	ret = spdk_xor_recover_pq(bufs, SRC_BUF_COUNT, BUF_SIZE, failed, 3);
+	CU_ASSERT(ret == -EINVAL);
+
+	for (i = 0; i < BUF_COUNT + 1; i++) {
+		free(bufs[i]);
+		free(ref[i]);
+	}
+}
+
 int
 main(int argc, char **argv)
 {
@@ -108,6 +271,8 @@ main(int argc, char **argv)
 	suite = CU_add_suite("xor", NULL, NULL);
 
 	CU_ADD_TEST(suite, test_xor_gen);
+	CU_ADD_TEST(suite, test_xor_gen_pq);
+	CU_ADD_TEST(suite, test_xor_recover_pq);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
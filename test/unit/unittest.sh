@@ -24,6 +24,8 @@ function unittest_bdev() {
 	$valgrind $testdir/lib/bdev/raid/concat.c/concat_ut
 	$valgrind $testdir/lib/bdev/raid/raid0.c/raid0_ut
 	$valgrind $testdir/lib/bdev/raid/raid1.c/raid1_ut
+	$valgrind $testdir/lib/bdev/raid/raid6.c/raid6_ut
+	$valgrind $testdir/lib/bdev/raid/raid10.c/raid10_ut
 	$valgrind $testdir/lib/bdev/bdev_zone.c/bdev_zone_ut
 	$valgrind $testdir/lib/bdev/gpt/gpt.c/gpt_ut
 	$valgrind $testdir/lib/bdev/part.c/part_ut
@@ -57,6 +59,8 @@ function unittest_ftl() {
 	$valgrind $testdir/lib/ftl/ftl_sb/ftl_sb_ut
 	$valgrind $testdir/lib/ftl/ftl_layout_upgrade/ftl_layout_upgrade_ut
 	$valgrind $testdir/lib/ftl/ftl_p2l.c/ftl_p2l_ut
+	$valgrind $testdir/lib/ftl/ftl_nv_cache.c/ftl_nv_cache_ut
+	$valgrind $testdir/lib/ftl/ftl_l2p_cache.c/ftl_l2p_cache_ut
 }
 
 function unittest_iscsi() {
@@ -202,6 +206,10 @@ if [[ $CONFIG_RAID5F == y ]]; then
 	run_test "unittest_bdev_raid5f" $valgrind $testdir/lib/bdev/raid/raid5f.c/raid5f_ut
 fi
 
+if [[ $CONFIG_OCF == y ]]; then
+	run_test "unittest_env_ocf" $valgrind $testdir/lib/env_ocf/ocf_env.c/ocf_env_ut
+fi
+
 run_test "unittest_blob" unittest_blob
 run_test "unittest_event" unittest_event
 if [ $(uname -s) = Linux ]; then